@@ -459,6 +459,11 @@ public:
     std::vector<double> ComputeDouble(const std::vector<double>& inputData);
     std::vector<float> ComputeFloat(const std::vector<float>& inputData);
 
+    // Batched version of the above: inputs and outputs are stored one sample after another. Requires the
+    // map to be compiled with the `predictBatch` option.
+    std::vector<double> ComputeBatchDouble(const std::vector<double>& inputData);
+    std::vector<float> ComputeBatchFloat(const std::vector<float>& inputData);
+
 private:
     template <typename ElementType>
     ell::api::CallbackForwarder<ElementType, ElementType>& GetCallbackForwarder();
@@ -486,6 +491,9 @@ struct MapCompilerOptions
 {
     bool useBlas = true;
     bool profile = false;
+    bool predictBatch = false;
+    bool lazyJit = false;
+    int optimizerThreads = 1;
 };
 
 //
@@ -494,6 +502,13 @@ struct MapCompilerOptions
 struct ModelOptimizerOptions
 {
     bool fuseLinearFunctionNodes = true;
+    bool fuseElementwiseNodes = true;
+    bool foldAffineLayers = true;
+    bool fuseLayerEpilogues = true;
+    bool assignMemoryLayouts = true;
+    bool fuseDepthwisePointwiseConvolutions = true;
+    bool evaluateForestsWithBitVectors = false;
+    bool blockBinaryConvolutionFilters = true;
 };
 
 } // namespace ELL_API
@@ -181,6 +181,8 @@ class ConvolutionMethod:
     simple = ConvolutionMethod_simple
     winograd = ConvolutionMethod_winograd
     unrolled = ConvolutionMethod_unrolled
+    blocked = ConvolutionMethod_blocked
+    depthwise = ConvolutionMethod_depthwise
 
 # Remove flat defines so callers only see the class above
 del ConvolutionMethod_automatic
@@ -188,6 +190,8 @@ del ConvolutionMethod_diagonal
 del ConvolutionMethod_simple
 del ConvolutionMethod_winograd
 del ConvolutionMethod_unrolled
+del ConvolutionMethod_blocked
+del ConvolutionMethod_depthwise
 
 # Python friendly class for EpsilonSummand
 class EpsilonSummand:
@@ -844,9 +844,19 @@ CompiledMap Map::Compile(const std::string& targetDevice,
     settings.sinkFunctionName = sinkFunctionName;
     settings.compilerSettings.targetDevice.deviceName = targetDevice;
     settings.compilerSettings.useBlas = compilerSettings.useBlas;
+    settings.predictBatch = compilerSettings.predictBatch;
+    settings.lazyJit = compilerSettings.lazyJit;
+    settings.compilerSettings.optimizerThreads = compilerSettings.optimizerThreads;
 
     ell::model::ModelOptimizerOptions optimizerOptions;
     optimizerOptions["fuseLinearFunctionNodes"] = optimizerSettings.fuseLinearFunctionNodes;
+    optimizerOptions["fuseElementwiseNodes"] = optimizerSettings.fuseElementwiseNodes;
+    optimizerOptions["foldAffineLayers"] = optimizerSettings.foldAffineLayers;
+    optimizerOptions["fuseLayerEpilogues"] = optimizerSettings.fuseLayerEpilogues;
+    optimizerOptions["assignMemoryLayouts"] = optimizerSettings.assignMemoryLayouts;
+    optimizerOptions["fuseDepthwisePointwiseConvolutions"] = optimizerSettings.fuseDepthwisePointwiseConvolutions;
+    optimizerOptions["evaluateForestsWithBitVectors"] = optimizerSettings.evaluateForestsWithBitVectors;
+    optimizerOptions["blockBinaryConvolutionFilters"] = optimizerSettings.blockBinaryConvolutionFilters;
 
     auto compiler = std::make_shared<ell::model::IRMapCompiler>(settings, optimizerOptions);
 
@@ -918,6 +928,24 @@ std::vector<float> CompiledMap::ComputeFloat(const std::vector<float>& inputData
     return {};
 }
 
+std::vector<double> CompiledMap::ComputeBatchDouble(const std::vector<double>& inputData)
+{
+    if (_map != nullptr)
+    {
+        return _map->ComputeBatch<double>(inputData);
+    }
+    return {};
+}
+
+std::vector<float> CompiledMap::ComputeBatchFloat(const std::vector<float>& inputData)
+{
+    if (_map != nullptr)
+    {
+        return _map->ComputeBatch<float>(inputData);
+    }
+    return {};
+}
+
 void CompiledMap::WriteIR(const std::string& filePath)
 {
     if (_map != nullptr)
@@ -71,7 +71,7 @@ Map ProtoNNPredictor::GetMap() const
 
     // add the predictor node, taking input from the input node
     model::PortElements<double> inputElements(inputNode->output);
-    auto predictorNode = model.AddNode<nodes::ProtoNNPredictorNode>(inputElements, predictor);
+    auto predictorNode = model.AddNode<nodes::ProtoNNPredictorNode<double>>(inputElements, predictor);
 
     // add an output node taking input from the predictor node.
     auto outputNode = model.AddNode<model::OutputNode<double>>(predictorNode->output);
@@ -71,6 +71,6 @@ namespace common
     /// <param name="parameters"> trainer arguments. </param>
     ///
     /// <returns> A unique_ptr to a protoNN trainer. </returns>
-    std::unique_ptr<trainers::ITrainer<predictors::ProtoNNPredictor>> MakeProtoNNTrainer(const trainers::ProtoNNTrainerParameters& parameters);
+    std::unique_ptr<trainers::ITrainer<predictors::ProtoNNPredictor<double>>> MakeProtoNNTrainer(const trainers::ProtoNNTrainerParameters& parameters);
 } // namespace common
 } // namespace ell
@@ -37,8 +37,14 @@ namespace common
         // ELL codegen options
         bool profile = false;
         bool optimize = true;
+        int optimizerThreads = 1;
+        emitters::MathFunctionImplementation mathFunctions = emitters::MathFunctionImplementation::library;
         bool useBlas = false;
         bool debug = false;
+        bool reentrant = false;
+        bool planPortMemory = true;
+        bool predictBatch = false;
+        bool lazyJit = false;
         utilities::Optional<bool> positionIndependentCode = false; // for generating -fPIC object code
 
         // potentially per-node options:
@@ -50,8 +56,16 @@ namespace common
 
         // optimization options (configurable per-node)
         bool fuseLinearOperations = true;
+        bool fuseElementwiseOperations = true;
+        bool foldAffineLayers = true;
+        bool fuseLayerEpilogues = true;
+        bool assignMemoryLayouts = true;
         bool optimizeReorderDataNodes = true;
-        PreferredConvolutionMethod convolutionMethod = PreferredConvolutionMethod::automatic; // known methods: auto, unrolled, simple, diagonal, winograd
+        PreferredConvolutionMethod convolutionMethod = PreferredConvolutionMethod::automatic; // known methods: auto, unrolled, simple, diagonal, winograd, blocked, depthwise
+        int winogradTileSize = 2; // known sizes: 2, 4, 6
+        bool fuseDepthwisePointwiseConvolutions = true;
+        bool evaluateForestsWithBitVectors = false;
+        bool blockBinaryConvolutionFilters = true;
 
         // raw options to store in metadata
         std::vector<std::string> modelOptions; // in format "<option-name>,<option-value-string>"
@@ -19,6 +19,7 @@
 #include <nodes/include/ActivationFunctions.h>
 #include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BinaryPredicateNode.h>
+#include <nodes/include/BlockedConvolutionNode.h>
 #include <nodes/include/BroadcastFunctionNode.h>
 #include <nodes/include/BroadcastOperationNodes.h>
 #include <nodes/include/BufferNode.h>
@@ -27,12 +28,15 @@
 #include <nodes/include/DCTNode.h>
 #include <nodes/include/DTWDistanceNode.h>
 #include <nodes/include/DelayNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
 #include <nodes/include/DiagonalConvolutionNode.h>
 #include <nodes/include/DotProductNode.h>
 #include <nodes/include/ExtremalValueNode.h>
 #include <nodes/include/FFTNode.h>
 #include <nodes/include/FilterBankNode.h>
+#include <nodes/include/FlatForestPredictorNode.h>
 #include <nodes/include/ForestPredictorNode.h>
+#include <nodes/include/FusedElementwiseNode.h>
 #include <nodes/include/GRUNode.h>
 #include <nodes/include/HammingWindowNode.h>
 #include <nodes/include/IIRFilterNode.h>
@@ -62,6 +66,7 @@
 #include <predictors/include/ForestPredictor.h>
 #include <predictors/include/LinearPredictor.h>
 #include <predictors/include/NeuralNetworkPredictor.h>
+#include <predictors/include/ProtoNNPredictor.h>
 #include <predictors/include/SingleElementThresholdPredictor.h>
 
 #include <predictors/neural/include/HardSigmoidActivation.h>
@@ -105,15 +110,20 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastUnaryOperationNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastBinaryOperationNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastTernaryOperationNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::BlockedConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BufferNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ConcatenationNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ConstantNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DelayNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::DepthwiseConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DiagonalConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DiagonalConvolutionComputeNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DotProductNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DTWDistanceNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::FFTNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FusedElementwiseNode<ElementType, float>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FusedElementwiseNode<ElementType, double>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FusedElementwiseNode<ElementType, int>>();
         context.GetTypeFactory().AddType<model::Node, nodes::GRUNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::HammingWindowNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::L2NormSquaredNode<ElementType>>();
@@ -254,12 +264,22 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::MultiplexerNode<float, int>>();
         context.GetTypeFactory().AddType<model::Node, nodes::MultiplexerNode<double, int>>();
 
-        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNPredictorNode>();
+        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNLabelScoresNode<float>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNLabelScoresNode<double>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNPredictorNode<float>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNPredictorNode<double>>();
+        context.GetTypeFactory().AddType<utilities::IArchivable, predictors::ProtoNNPredictor<float>>();
+        context.GetTypeFactory().AddType<utilities::IArchivable, predictors::ProtoNNPredictor<double>>();
+
+        // Map the ProtoNN type names from before the predictor was templated to the double versions, for compatibility reasons.
+        context.GetTypeFactory().AddType<model::Node, nodes::ProtoNNPredictorNode<double>>("ProtoNNPredictorNode");
+        context.GetTypeFactory().AddType<utilities::IArchivable, predictors::ProtoNNPredictor<double>>("ProtoNNPredictor");
 
         context.GetTypeFactory().AddType<model::Node, nodes::ReinterpretLayoutNode<int>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ReinterpretLayoutNode<bool>>();
 
         context.GetTypeFactory().AddType<model::Node, nodes::SimpleForestPredictorNode>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FlatForestPredictorNode>();
 
         context.GetTypeFactory().AddType<model::Node, nodes::SingleElementThresholdNode>();
 
@@ -137,7 +137,7 @@ namespace common
         }
     }
 
-    std::unique_ptr<trainers::ITrainer<predictors::ProtoNNPredictor>> MakeProtoNNTrainer(const trainers::ProtoNNTrainerParameters& parameters)
+    std::unique_ptr<trainers::ITrainer<predictors::ProtoNNPredictor<double>>> MakeProtoNNTrainer(const trainers::ProtoNNTrainerParameters& parameters)
     {
         return trainers::MakeProtoNNTrainer(parameters);
     }
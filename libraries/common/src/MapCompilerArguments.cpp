@@ -41,6 +41,34 @@ namespace common
             "Emit profiling code",
             false);
 
+        parser.AddOption(
+            reentrant,
+            "reentrant",
+            "",
+            "Keep mutable model state in per-instance blocks created with <module>_CreateInstance, so one module can be evaluated from several threads",
+            false);
+
+        parser.AddOption(
+            planPortMemory,
+            "planPortMemory",
+            "",
+            "Pack intermediate port buffers into a shared arena based on their live ranges (disable to give every port its own buffer when debugging)",
+            true);
+
+        parser.AddOption(
+            predictBatch,
+            "predictBatch",
+            "",
+            "Also emit a <function>Batch(context, count, inputs, outputs) function that evaluates a batch of samples in one call",
+            false);
+
+        parser.AddOption(
+            lazyJit,
+            "lazyJit",
+            "",
+            "When running the map with the JIT, compile each node's function when it is first called (or in the background) instead of compiling the whole map up front",
+            false);
+
         parser.AddOption(
             optimize,
             "optimize",
@@ -48,6 +76,23 @@ namespace common
             "Optimize output code",
             true);
 
+        parser.AddOption(
+            optimizerThreads,
+            "optimizerThreads",
+            "",
+            "Number of threads to optimize the output code on [0 == one per core]",
+            1);
+
+        parser.AddOption(
+            mathFunctions,
+            "mathFunctions",
+            "",
+            "How to compute exp, log, tanh and sigmoid: by calling the C runtime library, or with inline polynomial approximations that can be vectorized",
+            { { "library", emitters::MathFunctionImplementation::library },
+              { "accurate", emitters::MathFunctionImplementation::accurate },
+              { "fast", emitters::MathFunctionImplementation::fast } },
+            "library");
+
         parser.AddOption(
             useBlas,
             "blas",
@@ -62,6 +107,34 @@ namespace common
             "Fuse sequences of linear operations with constant coefficients into a single operation",
             true);
 
+        parser.AddOption(
+            fuseElementwiseOperations,
+            "fuseElementwiseOps",
+            "",
+            "Fuse chains of elementwise operations (broadcast functions, unary operations, operations with a constant operand, activations and casts) into a single loop",
+            true);
+
+        parser.AddOption(
+            foldAffineLayers,
+            "foldAffineLayers",
+            "",
+            "Fold batch normalization, scaling and bias layers into the weights of the preceding convolutional or fully-connected layer",
+            true);
+
+        parser.AddOption(
+            fuseLayerEpilogues,
+            "fuseLayerEpilogues",
+            "",
+            "Apply bias and activation layers (ReLU, leaky ReLU, parametric ReLU, hard sigmoid) as the preceding convolutional or fully-connected layer writes its output",
+            true);
+
+        parser.AddOption(
+            assignMemoryLayouts,
+            "assignMemoryLayouts",
+            "",
+            "Choose the dimension order of elementwise nodes to minimize the data copied by reordering nodes",
+            true);
+
         parser.AddOption(
             optimizeReorderDataNodes,
             "optimizeReorderDataNodes",
@@ -78,9 +151,39 @@ namespace common
               { "simple", PreferredConvolutionMethod::simple },
               { "diagonal", PreferredConvolutionMethod::diagonal },
               { "winograd", PreferredConvolutionMethod::winograd },
+              { "blocked", PreferredConvolutionMethod::blocked },
+              { "depthwise", PreferredConvolutionMethod::depthwise },
               { "auto", PreferredConvolutionMethod::automatic } },
             "auto");
 
+        parser.AddOption(
+            winogradTileSize,
+            "winogradTileSize",
+            "",
+            "Set the output tile size for Winograd convolution (2, 4 or 6)",
+            2);
+
+        parser.AddOption(
+            fuseDepthwisePointwiseConvolutions,
+            "fuseDepthwisePointwiseConvolutions",
+            "",
+            "Compute a depthwise convolution and the pointwise (1x1) convolution that follows it together, one output row at a time",
+            true);
+
+        parser.AddOption(
+            evaluateForestsWithBitVectors,
+            "evaluateForestsWithBitVectors",
+            "",
+            "Evaluate forests of trees with at most 64 leaves with branch-free bit vectors, instead of walking each tree",
+            false);
+
+        parser.AddOption(
+            blockBinaryConvolutionFilters,
+            "blockBinaryConvolutionFilters",
+            "",
+            "Compute binary convolutions a few filters at a time, with Harley-Seal popcounts, instead of one filter at a time",
+            true);
+
         parser.AddOption(
             modelOptions,
             "modelOption",
@@ -224,11 +327,17 @@ namespace common
         settings.moduleName = namespacePrefix;
         settings.mapFunctionName = functionName;
         settings.compilerSettings.optimize = optimize;
+        settings.compilerSettings.optimizerThreads = optimizerThreads;
+        settings.compilerSettings.mathFunctions = mathFunctions;
         settings.compilerSettings.useBlas = useBlas;
         settings.compilerSettings.allowVectorInstructions = enableVectorization;
         settings.compilerSettings.parallelize = parallelize;
         settings.compilerSettings.vectorWidth = vectorWidth;
         settings.profile = profile;
+        settings.reentrant = reentrant;
+        settings.planPortMemory = planPortMemory;
+        settings.predictBatch = predictBatch;
+        settings.lazyJit = lazyJit;
         settings.compilerSettings.profile = profile;
         settings.compilerSettings.positionIndependentCode = positionIndependentCode;
 
@@ -276,8 +385,16 @@ namespace common
     {
         model::ModelOptimizerOptions options;
         options["fuseLinearFunctionNodes"] = fuseLinearOperations;
+        options["fuseElementwiseNodes"] = fuseElementwiseOperations;
+        options["foldAffineLayers"] = foldAffineLayers;
+        options["fuseLayerEpilogues"] = fuseLayerEpilogues;
+        options["assignMemoryLayouts"] = assignMemoryLayouts;
         options["optimizeReorderDataNodes"] = optimizeReorderDataNodes;
         options["preferredConvolutionMethod"] = convolutionMethod;
+        options["winogradTileSize"] = winogradTileSize;
+        options["fuseDepthwisePointwiseConvolutions"] = fuseDepthwisePointwiseConvolutions;
+        options["evaluateForestsWithBitVectors"] = evaluateForestsWithBitVectors;
+        options["blockBinaryConvolutionFilters"] = blockBinaryConvolutionFilters;
 
         auto metadata = GetOptionsMetadata();
         if (metadata.HasEntry("model"))
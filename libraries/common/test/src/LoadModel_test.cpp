@@ -7,13 +7,21 @@
 
 #include "LoadTestModels.h"
 
+#include <common/include/LoadModel.h>
+
+#include <model/include/InputNode.h>
 #include <model/include/Model.h>
 
+#include <nodes/include/ProtoNNPredictorNode.h>
+
 #include <utilities/include/Files.h>
 
 #include <testing/include/testing.h>
 
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace ell
 {
@@ -27,6 +35,14 @@ namespace
     const int expectedTreeModel1Size = 64;
     const int expectedTreeModel2Size = 104;
     const int expectedTreeModel3Size = 144;
+
+    void ReplaceAll(std::string& str, const std::string& from, const std::string& to)
+    {
+        for (auto pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size()))
+        {
+            str.replace(pos, from.size(), to);
+        }
+    }
 } // namespace
 
 void TestLoadSampleModels()
@@ -96,4 +112,58 @@ void TestSaveModels()
     testing::ProcessTest("Testing tree model 2 size", newTree2.Size() == expectedTreeModel2Size);
     testing::ProcessTest("Testing tree model 3 size", newTree3.Size() == expectedTreeModel3Size);
 }
+
+void TestLoadLegacyProtoNNModel()
+{
+    // A model saved before the ProtoNN predictor was templated uses the plain type names
+    const size_t dim = 3, projectedDim = 2, numPrototypes = 2, numLabels = 2;
+    predictors::ProtoNNPredictor<double> predictor(dim, projectedDim, numPrototypes, numLabels, 0.5);
+    predictor.GetProjectionMatrix() = { { 0.1, 0.2, 0.3 }, { 0.4, 0.5, 0.6 } };
+    predictor.GetPrototypes() = { { 0.1, 0.9 }, { 0.2, 0.8 } };
+    predictor.GetLabelEmbeddings() = { { 0.3, 0.7 }, { 0.6, 0.4 } };
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(dim);
+    auto predictorNode = model.AddNode<nodes::ProtoNNPredictorNode<double>>(inputNode->output, predictor);
+
+    std::stringstream stream;
+    common::SaveModel(model, stream);
+    auto archivedModel = stream.str();
+    ReplaceAll(archivedModel, nodes::ProtoNNPredictorNode<double>::GetTypeName(), "ProtoNNPredictorNode");
+    ReplaceAll(archivedModel, predictors::ProtoNNPredictor<double>::GetTypeName(), "ProtoNNPredictor");
+    testing::ProcessTest("Testing legacy ProtoNN model uses the old type names", archivedModel.find(nodes::ProtoNNPredictorNode<double>::GetTypeName()) == std::string::npos);
+
+    const std::string filename = "protonn_legacy.model";
+    {
+        auto filestream = utilities::OpenOfstream(filename);
+        filestream << archivedModel;
+    }
+    auto loadedModel = common::LoadModel(filename);
+    testing::ProcessTest("Testing legacy ProtoNN model size", loadedModel.Size() == model.Size());
+
+    const nodes::ProtoNNPredictorNode<double>* loadedPredictorNode = nullptr;
+    model::InputNode<double>* loadedInputNode = nullptr;
+    loadedModel.Visit([&](const model::Node& node) {
+        if (auto protoNNNode = dynamic_cast<const nodes::ProtoNNPredictorNode<double>*>(&node))
+        {
+            loadedPredictorNode = protoNNNode;
+        }
+        if (auto input = dynamic_cast<const model::InputNode<double>*>(&node))
+        {
+            loadedInputNode = const_cast<model::InputNode<double>*>(input);
+        }
+    });
+    testing::ProcessTest("Testing legacy ProtoNN model loads as ProtoNNPredictorNode<double>", loadedPredictorNode != nullptr && loadedInputNode != nullptr);
+    if (loadedPredictorNode == nullptr || loadedInputNode == nullptr)
+    {
+        return;
+    }
+
+    std::vector<double> input = { 0.2, 0.4, 0.6 };
+    inputNode->SetInput(input);
+    loadedInputNode->SetInput(input);
+    auto expectedOutput = model.ComputeOutput(predictorNode->output);
+    auto loadedOutput = loadedModel.ComputeOutput(loadedPredictorNode->output);
+    testing::ProcessTest("Testing legacy ProtoNN model output", testing::IsEqual(expectedOutput, loadedOutput, 1e-12));
+}
 } // namespace ell
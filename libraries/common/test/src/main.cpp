@@ -37,6 +37,7 @@ int main(int argc, char* argv[])
         TestLoadSavedModels(examplePath);
 
         TestSaveModels();
+        TestLoadLegacyProtoNNModel();
 
         TestLoadMapWithDefaultArgs(examplePath);
         TestLoadMapWithPorts(examplePath);
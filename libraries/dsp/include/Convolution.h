@@ -41,6 +41,10 @@ namespace dsp
         winograd,
         /// <summary> Normal method of doing convolution via reshaping input into columns and performing a gemm operation. </summary>
         unrolled,
+        /// <summary> A direct convolution that computes blocks of output channels at a time in vector registers. </summary>
+        blocked,
+        /// <summary> A direct convolution for depthwise-separable layers that computes blocks of channels at a time in vector registers. </summary>
+        depthwise,
     };
 
     /// <summary> Convolve a 1D input with a 1D filter. </summary>
@@ -51,6 +51,10 @@ namespace dsp
         case ConvolutionMethodOption::automatic:
         // fallthrough
         case ConvolutionMethodOption::simple:
+        // fallthrough
+        case ConvolutionMethodOption::blocked:
+        // fallthrough
+        case ConvolutionMethodOption::depthwise:
             return Convolve2DSimple(signal, filters, numFilters, stride);
         case ConvolutionMethodOption::unrolled:
             return Convolve2DUnrolled(signal, filters, numFilters, stride);
@@ -80,6 +84,8 @@ namespace dsp
         case ConvolutionMethodOption::automatic:
         // fallthrough
         case ConvolutionMethodOption::simple:
+        // fallthrough
+        case ConvolutionMethodOption::depthwise:
             return Convolve2DSimpleDepthwiseSeparable(signal, filters, numFilters, stride);
         case ConvolutionMethodOption::unrolled:
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -166,14 +166,14 @@ namespace dsp
                 CopyFrom(dataPtr, startRow, startColumn, channelIndex, rows, columns, increment1, increment2);
             }
 
+            // Copies a numRows x numColumns block, and zeros the rest of the array
             void CopyFrom(const ValueType* dataPtr, int startRow, int startColumn, int channelIndex, int numRows, int numColumns, int increment1, int increment2)
             {
-                UNUSED(numColumns, numRows);
                 for (int rowIndex = 0; rowIndex < rows; ++rowIndex)
                 {
                     for (int columnIndex = 0; columnIndex < columns; ++columnIndex)
                     {
-                        _data[rowIndex * columns + columnIndex] = dataPtr[(rowIndex + startRow) * increment2 + (columnIndex + startColumn) * increment1 + channelIndex];
+                        _data[rowIndex * columns + columnIndex] = (rowIndex < numRows && columnIndex < numColumns) ? dataPtr[(rowIndex + startRow) * increment2 + (columnIndex + startColumn) * increment1 + channelIndex] : 0;
                     }
                 }
             }
@@ -406,6 +406,40 @@ namespace dsp
     //       0   1   1   4   4   0
     //       0   1  -1   8  -8   1
     //
+    //
+    // For F(6,3)
+    //
+    // The larger tiles need more interpolation points, and the transforms lose precision quickly as the points
+    // grow. Using the points 0, 1, -1, 2, -2, 1/2, -1/2 (and infinity) keeps the coefficients small enough for
+    // single-precision results.
+    //
+    //      1      0  -21/4      0   21/4      0   -1   0
+    //      0      1      1  -17/4  -17/4      1    1   0
+    //      0     -1      1   17/4  -17/4     -1    1   0
+    // B' = 0    1/2    1/4   -5/2   -5/4      2    1   0
+    //      0   -1/2    1/4    5/2   -5/4     -2    1   0
+    //      0      2      4   -5/2     -5    1/2    1   0
+    //      0     -2      4    5/2     -5   -1/2    1   0
+    //      0     -1      0   21/4      0  -21/4    0   1
+    //
+    //
+    //           1       0      0
+    //        -2/9    -2/9   -2/9
+    //        -2/9     2/9   -2/9
+    // G =    1/90    1/45   2/45
+    //        1/90   -1/45   2/45
+    //       32/45   16/45   8/45
+    //       32/45  -16/45   8/45
+    //           0       0      1
+    //
+    //
+    //       1   1   1   1   1     1      1   0
+    //       0   1  -1   2  -2   1/2   -1/2   0
+    // A' =  0   1   1   4   4   1/4    1/4   0
+    //       0   1  -1   8  -8   1/8   -1/8   0
+    //       0   1   1  16  16  1/16   1/16   0
+    //       0   1  -1  32 -32  1/32  -1/32   1
+    //
 
     /// <summary> Gets the data-transforming matrix for Winograd convolution (commonly notated as B') </summary>
     template <typename ValueType>
@@ -431,6 +465,19 @@ namespace dsp
                                            { 0,  4,  0, -5,  0,  1 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ { 1.0,      0.0, -21.0 / 4,       0.0,  21.0 / 4,       0.0, -1.0, 0.0 },
+                                           { 0.0,      1.0,       1.0, -17.0 / 4, -17.0 / 4,       1.0,  1.0, 0.0 },
+                                           { 0.0,     -1.0,       1.0,  17.0 / 4, -17.0 / 4,      -1.0,  1.0, 0.0 },
+                                           { 0.0,  1.0 / 2,   1.0 / 4,  -5.0 / 2,  -5.0 / 4,       2.0,  1.0, 0.0 },
+                                           { 0.0, -1.0 / 2,   1.0 / 4,   5.0 / 2,  -5.0 / 4,      -2.0,  1.0, 0.0 },
+                                           { 0.0,      2.0,       4.0,  -5.0 / 2,      -5.0,   1.0 / 2,  1.0, 0.0 },
+                                           { 0.0,     -2.0,       4.0,   5.0 / 2,      -5.0,  -1.0 / 2,  1.0, 0.0 },
+                                           { 0.0,     -1.0,       0.0,  21.0 / 4,       0.0, -21.0 / 4,  0.0, 1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -464,6 +511,19 @@ namespace dsp
                                            {       0.0,       0.0,      1.0 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ {        1.0,         0.0,        0.0 },
+                                           {  -2.0 / 9,    -2.0 / 9,   -2.0 / 9 },
+                                           {  -2.0 / 9,     2.0 / 9,   -2.0 / 9 },
+                                           {  1.0 / 90,    1.0 / 45,   2.0 / 45 },
+                                           {  1.0 / 90,   -1.0 / 45,   2.0 / 45 },
+                                           { 32.0 / 45,   16.0 / 45,   8.0 / 45 },
+                                           { 32.0 / 45,  -16.0 / 45,   8.0 / 45 },
+                                           {        0.0,         0.0,        1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -493,6 +553,17 @@ namespace dsp
                                            { 0,  1, -1,  8, -8,  1 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ { 1.0, 1.0,  1.0,  1.0,   1.0,      1.0,       1.0, 0.0 },
+                                           { 0.0, 1.0, -1.0,  2.0,  -2.0,  1.0 / 2,  -1.0 / 2, 0.0 },
+                                           { 0.0, 1.0,  1.0,  4.0,   4.0,  1.0 / 4,   1.0 / 4, 0.0 },
+                                           { 0.0, 1.0, -1.0,  8.0,  -8.0,  1.0 / 8,  -1.0 / 8, 0.0 },
+                                           { 0.0, 1.0,  1.0, 16.0,  16.0, 1.0 / 16,  1.0 / 16, 0.0 },
+                                           { 0.0, 1.0, -1.0, 32.0, -32.0, 1.0 / 32, -1.0 / 32, 1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -959,6 +1030,113 @@ namespace dsp
         }
     };
 
+    // F(6,3)
+    //
+    // The fully-expanded expressions for this size would be unwieldy, so the transforms are applied one dimension
+    // at a time, straight from the B' and A' coefficients (see `GetLeftDataTransformMatrix()` and
+    // `GetLeftResultTransformMatrix()`).
+    template <typename ValueType>
+    struct FixedWinogradTransform2D<ValueType, 6, 3>
+    {
+        static constexpr int tileSize = 6;
+        static constexpr int filterSize = 3;
+        static constexpr auto windowSize = filterSize + tileSize - 1;
+
+        // clang-format off
+        static constexpr double Bt[windowSize][windowSize] = { { 1.0,      0.0, -21.0 / 4,       0.0,  21.0 / 4,       0.0, -1.0, 0.0 },
+                                                               { 0.0,      1.0,       1.0, -17.0 / 4, -17.0 / 4,       1.0,  1.0, 0.0 },
+                                                               { 0.0,     -1.0,       1.0,  17.0 / 4, -17.0 / 4,      -1.0,  1.0, 0.0 },
+                                                               { 0.0,  1.0 / 2,   1.0 / 4,  -5.0 / 2,  -5.0 / 4,       2.0,  1.0, 0.0 },
+                                                               { 0.0, -1.0 / 2,   1.0 / 4,   5.0 / 2,  -5.0 / 4,      -2.0,  1.0, 0.0 },
+                                                               { 0.0,      2.0,       4.0,  -5.0 / 2,      -5.0,   1.0 / 2,  1.0, 0.0 },
+                                                               { 0.0,     -2.0,       4.0,   5.0 / 2,      -5.0,  -1.0 / 2,  1.0, 0.0 },
+                                                               { 0.0,     -1.0,       0.0,  21.0 / 4,       0.0, -21.0 / 4,  0.0, 1.0 } };
+
+        static constexpr double At[tileSize][windowSize] = { { 1.0, 1.0,  1.0,  1.0,   1.0,      1.0,       1.0, 0.0 },
+                                                             { 0.0, 1.0, -1.0,  2.0,  -2.0,  1.0 / 2,  -1.0 / 2, 0.0 },
+                                                             { 0.0, 1.0,  1.0,  4.0,   4.0,  1.0 / 4,   1.0 / 4, 0.0 },
+                                                             { 0.0, 1.0, -1.0,  8.0,  -8.0,  1.0 / 8,  -1.0 / 8, 0.0 },
+                                                             { 0.0, 1.0,  1.0, 16.0,  16.0, 1.0 / 16,  1.0 / 16, 0.0 },
+                                                             { 0.0, 1.0, -1.0, 32.0, -32.0, 1.0 / 32, -1.0 / 32, 1.0 } };
+        // clang-format on
+
+        // Computes M * d * M' for one channel of d, where M is an (outputSize x windowSize) transform matrix
+        template <int outputSize, typename GetFunction, typename SetFunction>
+        static inline void Transform(const double (&M)[outputSize][windowSize], GetFunction get, SetFunction set)
+        {
+            ValueType temp[outputSize][windowSize];
+            for (int i = 0; i < outputSize; ++i)
+            {
+                for (int j = 0; j < windowSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        if (M[i][k] != 0)
+                        {
+                            sum += static_cast<ValueType>(M[i][k]) * get(k, j);
+                        }
+                    }
+                    temp[i][j] = sum;
+                }
+            }
+
+            for (int i = 0; i < outputSize; ++i)
+            {
+                for (int j = 0; j < outputSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        if (M[j][k] != 0)
+                        {
+                            sum += temp[i][k] * static_cast<ValueType>(M[j][k]);
+                        }
+                    }
+                    set(i, j, sum);
+                }
+            }
+        }
+
+        template <typename MatrixType1, typename MatrixType2>
+        static void TransformInputWindow(const MatrixType1& d, MatrixType2& X)
+        {
+            // Compute B'dB
+            Transform(
+                Bt, [&d](int i, int j) { return d(i, j); }, [&X](int i, int j, ValueType value) { X(i, j) = value; });
+        }
+
+        template <typename BlockType1, typename BlockType2>
+        static inline void TransformInputBlock(const BlockType1& d, int blockSize, BlockType2& X)
+        {
+            // Compute B'dB
+            for (int index = 0; index < blockSize; ++index)
+            {
+                Transform(
+                    Bt, [&d, index](int i, int j) { return d(i, j, index); }, [&X, index](int i, int j, ValueType value) { X(i, j, index) = value; });
+            }
+        }
+
+        template <typename MatrixType1, typename MatrixType2>
+        static void TransformOutputTile(const MatrixType1& X, MatrixType2& result)
+        {
+            // Compute A'XA
+            Transform(
+                At, [&X](int i, int j) { return X(i, j); }, [&result](int i, int j, ValueType value) { result(i, j) = value; });
+        }
+
+        template <typename BlockType1, typename BlockType2>
+        static inline void TransformOutputBlock(const BlockType1& X, int blockSize, BlockType2& result)
+        {
+            // Compute A'XA
+            for (int index = 0; index < blockSize; ++index)
+            {
+                Transform(
+                    At, [&X, index](int i, int j) { return X(i, j, index); }, [&result, index](int i, int j, ValueType value) { result(i, j, index) = value; });
+            }
+        }
+    };
+
     //
     // Helper class to implement Winograd convolution steps
     //
@@ -1423,7 +1601,7 @@ namespace dsp
                         for (int tileColumnIndex = 0; tileColumnIndex < numTileColumns; ++tileColumnIndex)
                         {
                             const auto columnIndex = tileColumnIndex * tileSize;
-                            d.CopyFrom(inputSlice.GetConstDataPointer(), rowIndex, columnIndex, 0, numInputRows, numInputColumns, 1, numInputColumns);
+                            d.CopyFrom(inputSlice.GetConstDataPointer(), rowIndex, columnIndex, 0, std::min(static_cast<int>(windowSize), numInputRows - rowIndex), std::min(static_cast<int>(windowSize), numInputColumns - columnIndex), 1, numInputColumns);
 
                             // Compute X = B'dB
                             FixedWinogradTransform2D<ValueType, tileSize, filterSize>::TransformInputWindow(d, X);
@@ -1431,7 +1609,7 @@ namespace dsp
                             ElementwiseMultiply(filterPtr, X.GetDataPointer(), windowSize * windowSize, X.GetDataPointer());
 
                             // Now compute output tile Y = At * X * A
-                            FixedWinogradTransform2D<ValueType, 2, 3>::TransformOutputTile(X, outputTile);
+                            FixedWinogradTransform2D<ValueType, tileSize, filterSize>::TransformOutputTile(X, outputTile);
 
                             // copy the tile into the output
                             const int outputTileRows = std::min(static_cast<int>(tileSize), numOutputRows - rowIndex);
@@ -1524,6 +1702,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
+        }
         else
         {
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -1554,6 +1736,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradTilesFirst(input, transformedFilters, numFilters, transformedInputScratch, transformedOutputScratch, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradTilesFirst(input, transformedFilters, numFilters, transformedInputScratch, transformedOutputScratch, output);
+        }
         else
         {
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -1678,6 +1864,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
+        }
         else
         {
             assert(false && "Tile and filter size not implemented");
@@ -11,6 +11,7 @@
 #include "DSPTestUtilities.h"
 
 #include <dsp/include/Convolution.h>
+#include <dsp/include/WinogradConvolution.h>
 
 #include <math/include/MathConstants.h>
 #include <math/include/Tensor.h>
@@ -252,6 +253,35 @@ void TestConv2DVsSimple(int numRows, int numColumns, int numChannels, int filter
     }
 }
 
+template <typename ValueType>
+void TestConv2DWinogradVsSimple(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order)
+{
+    using Tensor = math::ChannelColumnRowTensor<ValueType>;
+
+    const int filterSize = 3;
+    Tensor signal(numRows, numColumns, numChannels);
+    Tensor filters(numFilters * filterSize, filterSize, numChannels);
+
+    FillInputTensor(signal);
+    FillFiltersTensor(filters, numFilters);
+
+    // Perform the convolution
+    auto reference = Convolve2D(signal, filters, numFilters, dsp::ConvolutionMethodOption::simple);
+    auto result = dsp::Convolve2DWinograd(signal, filters, numFilters, tileSize, order);
+
+    // The larger tiles' transforms lose some precision
+    const auto tolerance = static_cast<ValueType>(tileSize > 2 ? 1e-4 : epsilon);
+    bool ok = testing::ProcessTest("Testing Winograd convolution result with tile size " + std::to_string(tileSize), reference.IsEqual(result, tolerance));
+    if (!ok)
+    {
+        std::cout << "Incorrect result for 2D Winograd convolution with tile size " << tileSize << " (" << (order == dsp::WinogradFilterOrder::tilesFirst ? "tilesFirst" : "filtersFirst") << ") on input of size " << signal.NumRows() << " x " << signal.NumColumns() << " x " << signal.NumChannels() << std::endl;
+        Tensor diff(result);
+        diff -= reference;
+        auto diffArray = diff.ToArray();
+        std::cout << "Max difference:  " << *std::max_element(diffArray.begin(), diffArray.end()) << std::endl;
+    }
+}
+
 // Depthwise-separable
 template <typename ValueType>
 void TestConv2DSeparableVsSimple(int numRows, int numColumns, int numChannels, int filterSize, int stride, dsp::ConvolutionMethodOption algorithm)
@@ -330,6 +360,10 @@ template void TestConv2D<double>(dsp::ConvolutionMethodOption);
 template void TestConv2DVsSimple<float>(int numRows, int numColumns, int numChannels, int filterSize, int numFilters, int stride, dsp::ConvolutionMethodOption algorithm);
 template void TestConv2DVsSimple<double>(int numRows, int numColumns, int numChannels, int filterSize, int numFilters, int stride, dsp::ConvolutionMethodOption algorithm);
 
+// Winograd 2D
+template void TestConv2DWinogradVsSimple<float>(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order);
+template void TestConv2DWinogradVsSimple<double>(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order);
+
 // Depthwise-separable (i.e., multiple 2D in parallel)
 template void TestConv2DSeparable<float>(dsp::ConvolutionMethodOption);
 template void TestConv2DSeparable<double>(dsp::ConvolutionMethodOption);
@@ -65,6 +65,10 @@ std::string GetConvAlgName(dsp::ConvolutionMethodOption alg)
         return "diagonal";
     case dsp::ConvolutionMethodOption::winograd:
         return "winograd";
+    case dsp::ConvolutionMethodOption::blocked:
+        return "blocked";
+    case dsp::ConvolutionMethodOption::depthwise:
+        return "depthwise";
     }
     return "";
 }
@@ -87,6 +87,18 @@ void DspTest(const std::string& path)
     TestConv2DVsSimple<float>(60, 40, 64, 3, 128, 1, ConvolutionMethodOption::winograd);
     TestConv2DVsSimple<float>(129, 129, 128, 3, 128, 1, ConvolutionMethodOption::winograd);
 
+    // Winograd with larger tiles
+    for (auto order : { WinogradFilterOrder::filtersFirst, WinogradFilterOrder::tilesFirst })
+    {
+        for (int tileSize : { 4, 6 })
+        {
+            TestConv2DWinogradVsSimple<float>(6, 6, 1, 1, tileSize, order);
+            TestConv2DWinogradVsSimple<float>(12, 12, 8, 16, tileSize, order);
+            TestConv2DWinogradVsSimple<float>(17, 23, 8, 5, tileSize, order);
+            TestConv2DWinogradVsSimple<double>(20, 14, 3, 7, tileSize, order);
+        }
+    }
+
     // Depthwise-separable 2D convolution
     // Winograd
     TestConv2DSeparable<float>(ConvolutionMethodOption::winograd);
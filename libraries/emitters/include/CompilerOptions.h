@@ -28,6 +28,19 @@ namespace emitters
 
     std::string ToString(BlasType t);
 
+    /// <summary> Ways of computing exp, log, tanh and sigmoid in emitted code. </summary>
+    enum class MathFunctionImplementation
+    {
+        /// <summary> Call the C runtime library (through LLVM intrinsics where there are some), one value at a time. </summary>
+        library = 0,
+        /// <summary> Inline range reduction and minimax polynomials, within a few ULPs of the correctly-rounded result. Loops using them can be vectorized. </summary>
+        accurate,
+        /// <summary> Inline lower-degree polynomials, with errors around 1e-5. Loops using them can be vectorized. </summary>
+        fast
+    };
+
+    std::string ToString(MathFunctionImplementation t);
+
     /// <summary> Standard compiler switches. </summary>
     struct CompilerOptions
     {
@@ -43,6 +56,9 @@ namespace emitters
         /// <summary> Optimize output code using LLVM. </summary>
         bool optimize = true;
 
+        /// <summary> Number of threads to optimize the module on (0 means one per core). </summary>
+        int optimizerThreads = 1;
+
         /// <summary> The specific BLAS implementation to link to ('unknown' will choose whatever is available). </summary>
         BlasType blasType = BlasType::unknown;
 
@@ -64,6 +80,9 @@ namespace emitters
         /// <summary> Allow emitting more efficient code that isn't necessarily IEEE-754 compatible. </summary>
         bool useFastMath = true;
 
+        /// <summary> How to compute exp, log, tanh and sigmoid. </summary>
+        MathFunctionImplementation mathFunctions = MathFunctionImplementation::library;
+
         /// <summary> Allow printing of diagnostic messages from the compiled model. </summary>
         bool includeDiagnosticInfo = false;
 
@@ -99,5 +118,8 @@ namespace utilities
 {
     template <>
     emitters::BlasType FromString<emitters::BlasType>(const std::string& s);
+
+    template <>
+    emitters::MathFunctionImplementation FromString<emitters::MathFunctionImplementation>(const std::string& s);
 }
 } // namespace ell
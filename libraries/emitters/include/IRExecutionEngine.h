@@ -12,15 +12,20 @@
 #include <utilities/include/Exception.h>
 
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <type_traits>
 
 namespace ell
 {
 namespace emitters
 {
+    class IRLazyFunctionCompiler;
     class IRModuleEmitter;
 
     /// <summary> Function signature for a basic function that takes no input and returns no output </summary>
@@ -44,6 +49,18 @@ namespace emitters
         /// <param name="verify"> Indicates if the execution engine should run a verification pass before running the code. </param>
         IRExecutionEngine(std::unique_ptr<llvm::Module> pModule, bool verify = false);
 
+        /// <summary>
+        /// Copy a module into the execution engine, and compile the functions tagged with `c_nodeFunctionTagName` lazily:
+        /// each one is optimized and compiled when it is first called, or earlier by a background thread. The rest of the
+        /// module is compiled up front.
+        /// </summary>
+        ///
+        /// <param name="module"> The module. It's copied into an LLVM context owned by the execution engine, so the
+        /// background thread never touches the context the module was emitted in. </param>
+        /// <param name="optimize"> Indicates if the code should be optimized before it's compiled. </param>
+        /// <param name="verify"> Indicates if the execution engine should run a verification pass before running the code. </param>
+        IRExecutionEngine(const llvm::Module& module, bool optimize, bool verify);
+
         /// <summary> Destructor </summary>
         ~IRExecutionEngine();
 
@@ -52,6 +69,29 @@ namespace emitters
         /// <param name="pModule"> The module to add. </param>
         void AddModule(std::unique_ptr<llvm::Module> pModule);
 
+        /// <summary>
+        /// Use an object cache when generating code. A module found in the cache is loaded from its cached object code
+        /// instead of being compiled. Must be called before any functions are looked up; the cache must outlive the engine.
+        /// </summary>
+        ///
+        /// <param name="cache"> The object cache to use. </param>
+        void SetObjectCache(llvm::ObjectCache* cache);
+
+        /// <summary> Gets the number of functions compiled lazily. Zero unless the engine was created for lazy compilation. </summary>
+        int GetNumLazyFunctions() const;
+
+        /// <summary> Gets the number of lazily-compiled functions that have been compiled so far. </summary>
+        int GetNumCompiledLazyFunctions() const;
+
+        /// <summary> Compile all of the lazily-compiled functions that haven't been compiled yet. </summary>
+        void CompileLazyFunctions();
+
+        /// <summary>
+        /// Gets the lock that serializes every use of the engine, its modules and their LLVM context. The engine's
+        /// own methods take it; code that uses the modules or the context directly from another thread must too.
+        /// </summary>
+        std::recursive_mutex& GetMutex() { return _mutex; }
+
         /// <summary>
         /// Return the address of a named function, JITTing code as needed. Returns 0 if not found.
         /// </summary>
@@ -118,13 +158,18 @@ namespace emitters
         void RunMain();
 
     private:
+        void CreateBuilder(std::unique_ptr<llvm::Module> pModule, bool verify);
         void EnsureEngine();
         void EnsureClockGetTime();
         void PerformInitialization();
         void PerformFinalization();
 
+        std::unique_ptr<llvm::LLVMContext> _pContext; // owns the modules of a lazily-compiling engine, so it's destroyed last
+        std::recursive_mutex _mutex; // recursive, since the static constructors may call lazily-compiled functions
         std::unique_ptr<llvm::EngineBuilder> _pBuilder;
         std::unique_ptr<llvm::ExecutionEngine> _pEngine;
+        llvm::ObjectCache* _pObjectCache = nullptr;
+        std::unique_ptr<IRLazyFunctionCompiler> _pLazyFunctions;
     };
 } // namespace emitters
 } // namespace ell
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRLazyFunctionCompiler.h (emitters)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <llvm/IR/Module.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    class IRExecutionEngine;
+
+    /// <summary>
+    /// Compiles the functions of a module tagged with `c_nodeFunctionTagName` on demand. Each one is moved into its
+    /// own module, and every call to it goes through a function pointer that initially points to a stub. The first
+    /// call to the stub optimizes and compiles the function's module and updates the pointer, so later calls go
+    /// straight to the compiled function. A background thread compiles the functions that haven't been called yet,
+    /// in the order they appear in the module.
+    ///
+    /// All of the modules share the execution engine's LLVM context, so every compilation holds the engine's lock.
+    /// </summary>
+    class IRLazyFunctionCompiler
+    {
+    public:
+        /// <summary> Moves the lazily-compiled functions out of a module, and redirects calls to them through stubs </summary>
+        ///
+        /// <param name="module"> The module to split. It keeps everything but the lazily-compiled functions. </param>
+        /// <param name="optimize"> Indicates if each function's module should be optimized before it is compiled </param>
+        IRLazyFunctionCompiler(llvm::Module& module, bool optimize);
+
+        /// <summary> Destructor. Waits for the background thread to finish the function it's compiling. </summary>
+        ~IRLazyFunctionCompiler();
+
+        /// <summary>
+        /// Points each function at its stub. Called by the execution engine once it has been created from the split
+        /// module, before it runs the module's static constructors.
+        /// </summary>
+        ///
+        /// <param name="engine"> The execution engine the split module was added to </param>
+        void Start(IRExecutionEngine& engine);
+
+        /// <summary> Starts compiling in the background. Called by the execution engine once it's initialized. </summary>
+        void StartBackgroundCompilation();
+
+        /// <summary> Stops compiling in the background, and waits for the background thread to finish </summary>
+        void Stop();
+
+        /// <summary> Compiles all of the functions that haven't been compiled yet </summary>
+        void CompileAll();
+
+        /// <summary> Gets the number of lazily-compiled functions </summary>
+        int GetNumFunctions() const { return static_cast<int>(_functions.size()); }
+
+        /// <summary> Gets the number of lazily-compiled functions that have been compiled so far </summary>
+        int GetNumCompiledFunctions() const { return _numCompiledFunctions; }
+
+    private:
+        struct LazyFunction
+        {
+            std::string name;
+            std::string stubName;
+            std::unique_ptr<llvm::Module> module; // null once handed to the execution engine
+            bool isCompiled = false;
+            std::atomic<void*> address{ nullptr }; // read by the emitted code to call the function
+        };
+
+        // Called from the stubs in the emitted code, which can't propagate exceptions, so it aborts if compilation fails
+        static void* ResolveFunction(IRLazyFunctionCompiler* compiler, int32_t index) noexcept;
+        void* Compile(int index);
+        void CompileInBackground();
+
+        bool _optimize = false;
+        std::vector<std::unique_ptr<LazyFunction>> _functions; // heap-allocated, so the addresses emitted into the code stay valid
+        IRExecutionEngine* _engine = nullptr;
+
+        std::thread _backgroundThread;
+        std::atomic<bool> _stopBackgroundThread{ false };
+        std::atomic<int> _numCompiledFunctions{ 0 };
+    };
+} // namespace emitters
+} // namespace ell
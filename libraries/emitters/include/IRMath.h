@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "CompilerOptions.h"
 #include "IREmitter.h"
 #include "IRFunctionEmitter.h"
 #include "IRLocalValue.h"
@@ -19,7 +20,7 @@ namespace ell
 {
 namespace emitters
 {
-    // Common math functions
+    // Common math functions. Exp, Log, Tanh and Sigmoid are computed as the function's `mathFunctions` compiler option says.
     IRLocalScalar Abs(IRLocalScalar a);
     IRLocalScalar Sqrt(IRLocalScalar a);
     IRLocalScalar Exp(IRLocalScalar a);
@@ -30,6 +31,8 @@ namespace emitters
     template <typename ValueType>
     IRLocalScalar Tanh(IRLocalScalar a);
 
+    IRLocalScalar Sigmoid(IRLocalScalar a);
+
     IRLocalScalar Min(IRLocalScalar a, IRLocalScalar b);
     template <typename ValueType, utilities::IsFundamental<ValueType> = true>
     IRLocalScalar Min(ValueType a, IRLocalScalar b);
@@ -41,6 +44,47 @@ namespace emitters
     IRLocalScalar Max(ValueType a, IRLocalScalar b);
     template <typename ValueType, utilities::IsFundamental<ValueType> = true>
     IRLocalScalar Max(IRLocalScalar a, ValueType b);
+
+    //
+    // Inline approximations of math functions. They work on `float` and `double` scalars and vectors, and are made
+    // of plain arithmetic and bit manipulation, so loops that use them can be vectorized.
+    //
+
+    /// <summary> Emits code to compute exp(x) by reducing x to r in [-ln(2)/2, ln(2)/2] and evaluating a polynomial in r. </summary>
+    ///
+    /// <param name="function"> The function being emitted. </param>
+    /// <param name="x"> The floating-point scalar or vector value. </param>
+    /// <param name="implementation"> `accurate` or `fast`. </param>
+    ///
+    /// <returns> The value of exp(x). </returns>
+    LLVMValue ApproximateExp(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation);
+
+    /// <summary> Emits code to compute log(x) by splitting x into 2^e * (1 + f), with 1 + f in [sqrt(2)/2, sqrt(2)), and evaluating a polynomial in f. </summary>
+    ///
+    /// <param name="function"> The function being emitted. </param>
+    /// <param name="x"> The floating-point scalar or vector value. </param>
+    /// <param name="implementation"> `accurate` or `fast`. </param>
+    ///
+    /// <returns> The value of log(x). </returns>
+    LLVMValue ApproximateLog(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation);
+
+    /// <summary> Emits code to compute tanh(x) as 1 - 2 / (exp(2x) + 1), or with a polynomial near 0 when `accurate`. </summary>
+    ///
+    /// <param name="function"> The function being emitted. </param>
+    /// <param name="x"> The floating-point scalar or vector value. </param>
+    /// <param name="implementation"> `accurate` or `fast`. </param>
+    ///
+    /// <returns> The value of tanh(x). </returns>
+    LLVMValue ApproximateTanh(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation);
+
+    /// <summary> Emits code to compute sigmoid(x) as 1 / (1 + exp(-x)). </summary>
+    ///
+    /// <param name="function"> The function being emitted. </param>
+    /// <param name="x"> The floating-point scalar or vector value. </param>
+    /// <param name="implementation"> `accurate` or `fast`. </param>
+    ///
+    /// <returns> The value of sigmoid(x). </returns>
+    LLVMValue ApproximateSigmoid(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation);
 } // namespace emitters
 } // namespace ell
 
@@ -56,6 +56,12 @@ namespace emitters
     /// </remarks>
     static const std::string c_stepTimeFunctionTagName = "ell.fn.stepTime";
 
+    /// <summary>
+    /// Indicates a function that holds the code for a node. It may be moved into its own module: to be optimized on a
+    /// separate thread, or to be compiled on first call by a lazily-compiling execution engine.
+    /// </summary>
+    static const std::string c_nodeFunctionTagName = "ell.fn.node";
+
     /// <summary> Gets tag to Indicate the names of a struct's fields. </summary>
     /// <remarks>
     /// Returns a module-level tag, with the type name encoded in the name and field names as the value.
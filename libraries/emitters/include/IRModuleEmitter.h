@@ -195,6 +195,15 @@ namespace emitters
         /// <summary> Ensure that the given variable is loaded into a register. </summary>
         LLVMValue LoadVariable(Variable& var);
 
+        /// <summary>
+        /// Redirects all uses of an emitted global variable to another value of the same type, such as a slice
+        /// of a larger buffer, and deletes the original global. Later calls to `EnsureEmitted` return the new value.
+        /// </summary>
+        ///
+        /// <param name="name"> The emitted name of the global variable. </param>
+        /// <param name="pNewValue"> The value to use in place of the global. </param>
+        void ReplaceEmittedGlobal(const std::string& name, llvm::Constant* pNewValue);
+
         //
         // Variable and Constant creation
         //
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRObjectCache.h (emitters)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    /// <summary>
+    /// A persistent, on-disk cache of the object code the JIT produces for a module. Modules are looked up by their
+    /// module identifier, which should be a key computed with `GetKey` from everything that determines the generated code.
+    /// When the cache grows past its size limit, the least recently used objects are evicted.
+    /// </summary>
+    class IRObjectCache : public llvm::ObjectCache
+    {
+    public:
+        /// <summary> A function the module registers to run when it is loaded (in `llvm.global_ctors`) or unloaded (in `llvm.global_dtors`) </summary>
+        struct Initializer
+        {
+            std::string functionName;
+            int priority;
+        };
+
+        /// <summary> The object code and initializers of a cached module </summary>
+        struct CachedObject
+        {
+            std::vector<Initializer> constructors;
+            std::vector<Initializer> destructors;
+        };
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="directory"> The directory to store cached objects in. It is created if it doesn't exist. </param>
+        /// <param name="maxSize"> The maximum total size of the cached objects, in bytes. </param>
+        IRObjectCache(const std::string& directory, uint64_t maxSize);
+
+        /// <summary> Computes a cache key from a description of everything that determines a module's generated code </summary>
+        ///
+        /// <param name="description"> The description (for instance, the serialized model and the compiler options) </param>
+        /// <returns> A key suitable for use as a module identifier and file name </returns>
+        static std::string GetKey(const std::string& description);
+
+        /// <summary>
+        /// Looks up a module's object code, and updates the hit and miss counters. On a hit, the object is held in memory
+        /// until the JIT asks for it, so it can't be evicted in between.
+        /// </summary>
+        ///
+        /// <param name="key"> The module's cache key </param>
+        /// <param name="object"> Filled in with the initializers the cached module registered, on a hit </param>
+        /// <returns> `true` if the object was found in the cache </returns>
+        bool TryLoad(const std::string& key, CachedObject& object);
+
+        /// <summary>
+        /// Prepares a module to be compiled through the cache: sets its identifier to the key, and gives its initializer
+        /// functions external linkage so they can be found in the object code when it's loaded from the cache later.
+        /// </summary>
+        ///
+        /// <param name="module"> The module about to be handed to the JIT </param>
+        /// <param name="key"> The module's cache key </param>
+        static void PrepareModule(llvm::Module& module, const std::string& key);
+
+        /// <summary> Gets the number of lookups that found their object in the cache </summary>
+        uint64_t GetNumHits() const;
+
+        /// <summary> Gets the number of lookups that didn't find their object in the cache </summary>
+        uint64_t GetNumMisses() const;
+
+        /// <summary> Gets the total size of the objects currently stored in the cache directory, in bytes </summary>
+        uint64_t GetSize() const;
+
+        /// <summary> Gets the maximum total size of the cached objects, in bytes </summary>
+        uint64_t GetMaxSize() const { return _maxSize; }
+
+        /// <summary> Gets the directory the cached objects are stored in </summary>
+        const std::string& GetDirectory() const { return _directory; }
+
+        /// <summary> Called by the JIT after it compiles a module: stores the object code, then evicts old objects if the cache is too big </summary>
+        void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef object) override;
+
+        /// <summary> Called by the JIT before it compiles a module: returns the cached object code, or null to compile the module </summary>
+        std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+
+    private:
+        std::string GetObjectPath(const std::string& key) const;
+        std::string GetInitializersPath(const std::string& key) const;
+        void EvictToMaxSize();
+
+        std::string _directory;
+        uint64_t _maxSize = 0;
+
+        mutable std::mutex _mutex;
+        std::map<std::string, std::unique_ptr<llvm::MemoryBuffer>> _loadedObjects;
+        uint64_t _numHits = 0;
+        uint64_t _numMisses = 0;
+    };
+} // namespace emitters
+} // namespace ell
@@ -26,6 +26,11 @@ namespace emitters
         /// <param name="module"> The module. </param>
         IROptimizer(IRModuleEmitter& module);
 
+        /// <summary> Function optimizer for functions in a module that isn't owned by an `IRModuleEmitter`. </summary>
+        ///
+        /// <param name="module"> The module. </param>
+        IROptimizer(llvm::Module& module);
+
         ~IROptimizer();
 
         /// <summary> Add common optimizations to the optimizer pipeline. </summary>
@@ -40,9 +45,30 @@ namespace emitters
         void OptimizeModule(llvm::Module* pModule);
 
     private:
-        IRModuleEmitter& _module;
+        IRModuleEmitter* _module = nullptr;
         llvm::legacy::PassManager _modulePasses;
         llvm::legacy::FunctionPassManager _functionPasses;
     };
+
+    /// <summary> Optimize each function of a module, then the module itself, with the standard passes. </summary>
+    ///
+    /// <param name="module"> The module to optimize. </param>
+    void OptimizeModule(llvm::Module& module);
+
+    /// <summary>
+    /// Optimize a module on several threads with the standard passes. The module's functions are split into
+    /// balanced partitions, each partition is copied into its own LLVM context and optimized on its own thread,
+    /// and the results are linked back into the module. Module-local functions that are only called directly are
+    /// copied into every partition that calls them, and inlined there. Large functions tagged with `c_nodeFunctionTagName`
+    /// are optimized in their own partitions instead, and aren't inlined into their callers. Falls back to `OptimizeModule`
+    /// if the module can't be split. Only the optimizer runs in parallel: the module is still compiled to machine code on
+    /// one thread.
+    /// </summary>
+    ///
+    /// <param name="module"> The module to optimize. It keeps its global variables, and its functions' names and linkage. </param>
+    /// <param name="numThreads"> The number of threads to optimize with. </param>
+    ///
+    /// <returns> The number of partitions the module was optimized in (1 if it wasn't split). </returns>
+    int OptimizeModuleInParallel(llvm::Module& module, int numThreads);
 } // namespace emitters
 } // namespace ell
@@ -14,12 +14,18 @@
 
 #include <utilities/include/Exception.h>
 
+#include <functional>
+
 namespace ell
 {
 namespace emitters
 {
     class IRModuleEmitter;
     class IRFunctionEmitter;
+    struct IRLocalScalar;
+
+    /// <summary> A function applied to each entry of a matrix product as it's stored: it gets the entry's value, row and column, and returns the value to store. </summary>
+    using GEMMEpilogueFunction = std::function<IRLocalScalar(IRFunctionEmitter& function, IRLocalScalar value, IRLocalScalar row, IRLocalScalar column)>;
 
     /// <summary> Manages external as well as compiler auto-generated functions </summary>
     class IRRuntime
@@ -134,6 +140,28 @@ namespace emitters
         template <typename ValueType>
         LLVMFunction GetGEMMFunction(bool useBlas);
 
+        /// <summary>
+        /// Emit the native gemm inline, computing C = op(A) * op(B) and applying an epilogue to each entry of C. The
+        /// micro-kernel applies the epilogue as it stores the last depth block of each tile, so C is only written once more.
+        /// </summary>
+        ///
+        /// <typeparam name="ValueType"> The data type used (`float` or `double`) </typeparam>
+        /// <param name="function"> The function to emit the code into. </param>
+        /// <param name="transposeA"> If `true`, use A' instead of A. </param>
+        /// <param name="transposeB"> If `true`, use B' instead of B. </param>
+        /// <param name="m"> The number of rows in op(A) and C. </param>
+        /// <param name="n"> The number of columns in op(B) and C. </param>
+        /// <param name="k"> The number of columns in op(A) and rows in op(B). </param>
+        /// <param name="A"> The matrix to multiply on the left. </param>
+        /// <param name="lda"> The stride of the matrix A. </param>
+        /// <param name="B"> The matrix to multiply on the right. </param>
+        /// <param name="ldb"> The stride of the matrix B. </param>
+        /// <param name="C"> The result matrix. </param>
+        /// <param name="ldc"> The stride of the matrix C. </param>
+        /// <param name="epilogue"> The function to apply to each entry of C. </param>
+        template <typename ValueType>
+        void EmitGEMM(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc, const GEMMEpilogueFunction& epilogue);
+
         // Special OpenBLAS utility functions
 
         /// <summary> Get the OpenBLAS function for getting the number of threads </summary>
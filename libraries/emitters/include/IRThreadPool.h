@@ -27,7 +27,7 @@ namespace emitters
     class IRThreadPoolTaskArray;
 
     //
-    // IRThreadPool: Simple thread pool class that schedules tasks in blocks, and associated classes:
+    // IRThreadPool: Work-stealing thread pool class that schedules tasks in blocks, and associated classes:
     //
     // IRThreadPoolTask
     // IRThreadPoolTaskArray
@@ -64,13 +64,16 @@ namespace emitters
     private:
         friend class IRThreadPoolTaskArray;
         friend class IRThreadPoolTaskQueue;
-        IRThreadPoolTask(LLVMValue wrappedTaskFunctionPtr, LLVMValue argsStructPtr, LLVMValue returnValuePtr, IRThreadPoolTaskArray* taskArray);
+        IRThreadPoolTask(LLVMValue wrappedTaskFunctionPtr, LLVMValue argsStructPtr, LLVMValue returnValuePtr, const IRThreadPoolTaskArray& taskArray);
 
         LLVMValue _taskFunctionPtr = nullptr;
         LLVMValue _argsStruct = nullptr;
         LLVMValue _returnValuePtr = nullptr;
 
-        IRThreadPoolTaskArray* _taskArray = nullptr;
+        // The task array this task belongs to (see `IRThreadPoolTaskArray` for what these are)
+        IRThreadPoolTaskQueue* _taskQueue = nullptr;
+        LLVMValue _taskArrayData = nullptr;
+        LLVMValue _ownsThreadPool = nullptr;
     };
 
     //
@@ -99,11 +102,11 @@ namespace emitters
         IRThreadPoolTask GetTask(IRFunctionEmitter& function, LLVMValue taskIndex);
 
     private:
+        friend class IRThreadPoolTask;
         friend class IRThreadPoolTaskQueue;
-        IRThreadPoolTaskArray(IRThreadPoolTaskQueue& taskQueue);
-        void Initialize(IRFunctionEmitter& function);
+        IRThreadPoolTaskArray(IRThreadPoolTaskQueue& taskQueue, LLVMValue taskArrayData, LLVMValue ownsThreadPool);
         void SetTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& taskArgs);
-        llvm::StructType* GetTaskArrayDataType(IRModuleEmitter& module);
+        static llvm::StructType* GetTaskArrayDataType(IRModuleEmitter& module);
         LLVMValue GetTaskFunctionPointer(IRFunctionEmitter& function);
         LLVMValue GetReturnValuesStoragePointer(IRFunctionEmitter& function);
         LLVMValue GetTaskArgsStoragePointer(IRFunctionEmitter& function);
@@ -118,9 +121,10 @@ namespace emitters
             argStructSize,
             // nextArray
         };
-        LLVMValue _taskArrayData = nullptr;
+        LLVMValue _taskArrayData = nullptr; // pointer to a struct with the above fields, on the stack of the function that started the tasks
+        LLVMValue _ownsThreadPool = nullptr; // pointer to a bool recording whether the tasks were handed to the pool, or already run inline
 
-        IRThreadPoolTaskQueue& _taskQueue; // make this a pointer if we're not using threadpool
+        IRThreadPoolTaskQueue* _taskQueue = nullptr; // make this a pointer if we're not using threadpool
     };
 
     //
@@ -131,55 +135,63 @@ namespace emitters
     class IRThreadPoolTaskQueue
     {
     public:
-        /// <summary> Starts an array of tasks in the thread pool. </summary>
+        /// <summary>
+        /// Starts an array of tasks in the thread pool. If the pool is already busy (for instance, because this is called from
+        /// inside another task), the tasks are run inline on the calling thread instead.
+        /// </summary>
         ///
         /// <param name="function"> The function currently being emitted into. </param>
         /// <param name="taskFunction"> The function to run asynchronously with many different arguments. </param>
         /// <param name="arguments"> For each task, a vector of arguments for that task. </param>
         ///
         /// <returns> A task array object representing the running tasks. </param>
-        IRThreadPoolTaskArray& StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
+        IRThreadPoolTaskArray StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
 
-        /// <summary> Pop a task off the task queue, waiting for one to become available if necessary. </summary>
+        /// <summary>
+        /// Pop a task off the given worker's deque, stealing from other workers' deques if it is empty. If there is no work anywhere,
+        /// spins for a while and then parks on a condition variable until new tasks are started or the queue is shut down.
+        /// </summary>
         ///
         /// <param name="function"> The function currently being emitted into. </param>
+        /// <param name="workerIndex"> The index of the worker (and deque) that is asking for work. </param>
         ///
-        /// <returns> The next task in the queue. </param>
-        IRThreadPoolTask PopNextTask(IRFunctionEmitter& function);
+        /// <returns> The next task to run, or a null task if the queue is shutting down. </param>
+        IRThreadPoolTask PopNextTask(IRFunctionEmitter& function, LLVMValue workerIndex);
 
-        /// <summary> Wait for all tasks to finish. </summary>
+        /// <summary> Wait for all tasks to finish. The calling thread runs tasks from its own deque (and steals from the workers) while it waits. </summary>
         ///
         /// <param name="function"> The function currently being emitted into. </param>
-        void WaitAll(IRFunctionEmitter& function);
-
-        /// <summary> Gets the array of tasks in the thread pool. </summary>
-        ///
-        /// <returns> A task array object representing the tasks. </param>
-        IRThreadPoolTaskArray& GetTaskArray() { return _tasks; }
+        /// <param name="tasks"> The task array returned by `StartTasks`. </param>
+        void WaitAll(IRFunctionEmitter& function, IRThreadPoolTaskArray& tasks);
 
     private:
         friend class IRThreadPool;
         IRThreadPoolTaskQueue(); // create an empty queue
-        void Initialize(IRFunctionEmitter& function); // initializes the task array
-        LLVMValue GetDataStruct() { return _queueData; }
-        LLVMValue DecrementCountField(IRFunctionEmitter& function, LLVMValue fieldPtr);
+        void Initialize(IRFunctionEmitter& function, int numWorkerThreads); // initializes the deques
+        IRThreadPoolTaskArray GetActiveTaskArray(IRFunctionEmitter& function); // the task array most recently handed to the pool
         llvm::StructType* GetTaskQueueDataType(IRModuleEmitter& module) const;
+        llvm::StructType* GetTaskDequeType(IRModuleEmitter& module) const;
 
         // Accessors for fields
         LLVMValue GetQueueMutexPointer(IRFunctionEmitter& function);
         LLVMValue GetWorkAvailableConditionVariablePointer(IRFunctionEmitter& function);
         LLVMValue GetWorkFinishedConditionVariablePointer(IRFunctionEmitter& function);
-        LLVMValue GetUnscheduledCount(IRFunctionEmitter& function) const;
         LLVMValue GetUnfinishedCount(IRFunctionEmitter& function) const;
+        LLVMValue GetGeneration(IRFunctionEmitter& function) const;
         void SetShutdownFlag(IRFunctionEmitter& function);
         LLVMValue GetShutdownFlag(IRFunctionEmitter& function) const;
-        void SetInitialCount(IRFunctionEmitter& function, LLVMValue newValue);
-        LLVMValue DecrementUnscheduledTasks(IRFunctionEmitter& function);
-        LLVMValue DecrementUnfinishedTasks(IRFunctionEmitter& function);
-        LLVMValue IsEmpty(IRFunctionEmitter& function) const;
         LLVMValue IsFinished(IRFunctionEmitter& function) const;
 
+        // Deque operations. Each deque holds a contiguous range of task indices [head, tail) packed into a single 64-bit word,
+        // so the owner (popping from the tail) and thieves (taking from the head) only need a compare-and-swap to claim a task.
+        LLVMValue GetTaskDequePointer(IRFunctionEmitter& function, LLVMValue dequeIndex);
+        void SetTaskDequeRange(IRFunctionEmitter& function, int dequeIndex, int begin, int end);
+        LLVMValue TryPopTaskIndex(IRFunctionEmitter& function, LLVMValue dequeIndex, bool fromTail);
+        LLVMValue FindTaskIndex(IRFunctionEmitter& function, LLVMValue workerIndex);
+        void FinishTask(IRFunctionEmitter& function);
+
         bool IsInitialized() const;
+        int GetCallerDequeIndex() const { return _numDeques - 1; }
         void NotifyWaitingClients(IRFunctionEmitter& function);
         void LockQueueMutex(IRFunctionEmitter& function);
         void UnlockQueueMutex(IRFunctionEmitter& function);
@@ -190,19 +202,25 @@ namespace emitters
             queueMutex = 0,
             workAvailableCondVar,
             workFinishedCondVar,
-            unscheduledCount,
             unfinishedCount,
-            shutdownFlag
+            generation,
+            shutdownFlag,
+            busyFlag,
+            activeTaskArray
         };
         LLVMValue _queueData = nullptr; // a struct with the above fields
-        IRThreadPoolTaskArray _tasks;
+        llvm::GlobalVariable* _taskDeques = nullptr; // one cache-line-sized deque per worker thread, plus one for the calling thread
+        int _numDeques = 0;
     };
 
     //
     // IRThreadPool
     //
 
-    /// <summary> Class representing a set of threads that can run asynchronous tasks. </summary>
+    /// <summary>
+    /// Class representing a set of threads that can run asynchronous tasks. The pool creates `maxThreads - 1` worker threads;
+    /// the thread that starts a set of tasks participates in running them while it waits, for a total of `maxThreads` threads.
+    /// </summary>
     class IRThreadPool
     {
     public:
@@ -218,7 +236,7 @@ namespace emitters
         /// <param name="arguments"> For each task, a vector of arguments for that task. </param>
         ///
         /// <returns> A task array object representing the running tasks. </param>
-        IRThreadPoolTaskArray& AddTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
+        IRThreadPoolTaskArray AddTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
 
         /// <summary> Tell the thread pool to finish and kill the treads. </summary>
         void ShutDown(IRFunctionEmitter& function);
@@ -231,7 +249,7 @@ namespace emitters
         LLVMFunction GetWorkerThreadFunction();
 
         IRModuleEmitter& _module;
-        size_t _maxThreads = 0;
+        int _numWorkerThreads = 0;
         llvm::GlobalVariable* _threads = nullptr; // global array of pthread_t
 
         // task queue
@@ -14,10 +14,59 @@
 
 #include <utilities/include/TypeTraits.h>
 
+#include <functional>
+#include <vector>
+
 namespace ell
 {
 namespace emitters
 {
+    /// <summary> Describes how an elementwise loop reads or writes one of its operands </summary>
+    struct ElementwiseOperand
+    {
+        /// <summary> Pointer to the element used on the first iteration </summary>
+        LLVMValue pointer = nullptr;
+
+        /// <summary> Distance, in elements, between the elements used on successive iterations. A stride of 0 reads the same element on every iteration. </summary>
+        int stride = 1;
+
+        /// <summary> If not null, a scalar value used on every iteration instead of reading from `pointer` </summary>
+        LLVMValue value = nullptr;
+    };
+
+    /// <summary>
+    /// Type of the body of an elementwise loop. It gets one value per input operand (null for operands with
+    /// neither a pointer nor a value), and returns the output value. The values are either all scalars or all
+    /// vectors of the loop's vector width, so the body must only use operations that work on both.
+    /// </summary>
+    using ElementwiseLoopBodyFunction = std::function<LLVMValue(IRFunctionEmitter& function, const std::vector<LLVMValue>& inputs)>;
+
+    /// <summary>
+    /// Emits a loop that computes `output[i] = body(inputs[0][i], inputs[1][i], ...)` for `i` in [0, count). If the
+    /// compiler options allow vector instructions, the main loop processes `vectorWidth` elements per iteration
+    /// with explicit vector loads and stores (or gathers and scatters, for strided operands), and a scalar loop
+    /// handles the remaining elements. Operands with a stride of 0 are loaded, and broadcast to a vector, once
+    /// before the loop. A boolean (`i1`) result is widened to the output's element type.
+    /// </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="count"> The number of elements to compute </param>
+    /// <param name="inputs"> The input operands </param>
+    /// <param name="output"> The output operand. Its stride must not be 0. </param>
+    /// <param name="body"> The function that emits the computation of one (scalar or vector) output value </param>
+    /// <param name="vectorize"> If false, always emit a scalar loop (for bodies that can't operate on vectors) </param>
+    void EmitElementwiseLoop(IRFunctionEmitter& function, IRLocalScalar count, const std::vector<ElementwiseOperand>& inputs, const ElementwiseOperand& output, ElementwiseLoopBodyFunction body, bool vectorize = true);
+
+    /// <summary> Emits a loop that computes `output[i] = body(inputs[0][i], inputs[1][i], ...)` for `i` in [0, count) </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="count"> The number of elements to compute </param>
+    /// <param name="inputs"> The input operands </param>
+    /// <param name="output"> The output operand. Its stride must not be 0. </param>
+    /// <param name="body"> The function that emits the computation of one (scalar or vector) output value </param>
+    /// <param name="vectorize"> If false, always emit a scalar loop (for bodies that can't operate on vectors) </param>
+    void EmitElementwiseLoop(IRFunctionEmitter& function, int count, const std::vector<ElementwiseOperand>& inputs, const ElementwiseOperand& output, ElementwiseLoopBodyFunction body, bool vectorize = true);
+
     /// <summary> Create an integer vector filled with copies of a value </summary>
     ///
     /// <typeparam name="ValueType"> The type of the value </typeparam>
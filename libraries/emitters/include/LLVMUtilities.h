@@ -9,11 +9,15 @@
 
 #include "EmitterTypes.h"
 
+#include <unordered_set>
+
 namespace llvm
 {
 class Function;
 class FunctionType;
+class GlobalValue;
 class GlobalVariable;
+class Module;
 class StructType;
 class Type;
 class Value;
@@ -67,5 +71,21 @@ namespace emitters
     ///
     /// <returns> The TypedComparison for comparing values of the given type. </returns>
     emitters::TypedComparison GetComparison(LLVMType type, BinaryPredicateType operation);
+
+    //
+    // Splitting modules
+    //
+
+    /// <summary> Get the global values (functions and variables) a function's code refers to, including through constant expressions. </summary>
+    ///
+    /// <param name="function"> The function. </param>
+    ///
+    /// <returns> The global values the function refers to. </returns>
+    std::unordered_set<llvm::GlobalValue*> GetReferencedGlobalValues(const llvm::Function& function);
+
+    /// <summary> Remove the declarations nothing in a module refers to, for instance after cloning only part of a module. </summary>
+    ///
+    /// <param name="module"> The module. </param>
+    void RemoveUnusedDeclarations(llvm::Module& module);
 } // namespace emitters
 } // namespace ell
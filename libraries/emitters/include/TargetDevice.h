@@ -33,6 +33,9 @@ namespace emitters
 
         /// <summary> Indicates if the target device is a macOS system </summary>
         bool IsMacOS() const;
+
+        /// <summary> Indicates if the target device has no operating system, like the Cortex-M microcontrollers </summary>
+        bool IsBareMetal() const;
     };
 
     /// <summary> Create a TargetDevice from a device name. </summary>
@@ -37,6 +37,21 @@ namespace emitters
         }
     }
 
+    std::string ToString(MathFunctionImplementation t)
+    {
+        switch (t)
+        {
+        case MathFunctionImplementation::library:
+            return "library";
+        case MathFunctionImplementation::accurate:
+            return "accurate";
+        case MathFunctionImplementation::fast:
+            return "fast";
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+        }
+    }
+
     /// <summary> Constructor from a property bag </summary>
     CompilerOptions::CompilerOptions(const utilities::PropertyBag& properties)
     {
@@ -60,6 +75,7 @@ namespace emitters
         }
 
         optimize = properties.GetOrParseEntry("optimize", optimize);
+        optimizerThreads = properties.GetOrParseEntry<int>("optimizerThreads", optimizerThreads);
         unrollLoops = properties.GetOrParseEntry("unrollLoops", unrollLoops);
         inlineOperators = properties.GetOrParseEntry<bool>("inlineOperators", inlineOperators);
         allowVectorInstructions = properties.GetOrParseEntry<bool>("allowVectorInstructions", allowVectorInstructions);
@@ -71,6 +87,7 @@ namespace emitters
         useThreadPool = properties.GetOrParseEntry<bool>("useThreadPool", useThreadPool);
         maxThreads = properties.GetOrParseEntry<int>("maxThreads", maxThreads);
         useFastMath = properties.GetOrParseEntry<bool>("useFastMath", useFastMath);
+        mathFunctions = properties.GetOrParseEntry<MathFunctionImplementation>("mathFunctions", mathFunctions);
         debug = properties.GetOrParseEntry<bool>("debug", debug);
 
         if (properties.HasEntry("deviceName"))
@@ -97,5 +114,20 @@ namespace utilities
         
         return it->second;
     }
+
+    template <>
+    emitters::MathFunctionImplementation FromString<emitters::MathFunctionImplementation>(const std::string& s)
+    {
+        static std::map<std::string, emitters::MathFunctionImplementation> nameMap = { { "library", emitters::MathFunctionImplementation::library },
+                                                                                       { "accurate", emitters::MathFunctionImplementation::accurate },
+                                                                                       { "fast", emitters::MathFunctionImplementation::fast } };
+        auto it = nameMap.find(s);
+        if (it == nameMap.end())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown MathFunctionImplementation");
+        }
+
+        return it->second;
+    }
 } // namespace utilities
 } // namespace ell
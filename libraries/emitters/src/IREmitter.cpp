@@ -69,6 +69,16 @@ namespace emitters
                 }
             }
         }
+
+        // Broadcasts a scalar operand to the vector type of the other operand, so scalar constants can be
+        // combined with vector values
+        void SplatToMatch(llvm::IRBuilder<>& builder, LLVMValue& pValue, LLVMValue pOther)
+        {
+            if (!pValue->getType()->isVectorTy() && pOther->getType()->isVectorTy())
+            {
+                pValue = builder.CreateVectorSplat(pOther->getType()->getVectorNumElements(), pValue);
+            }
+        }
     }; // namespace
 
     //
@@ -290,41 +300,49 @@ namespace emitters
         auto inputType = pValue->getType();
         auto bitType = llvm::Type::getInt1Ty(_llvmContext);
 
+        // Vectors are cast elementwise, to a vector of the destination type
+        if (inputType->isVectorTy() && !destinationType->isVectorTy())
+        {
+            destinationType = VectorType(destinationType, inputType->getVectorNumElements());
+        }
+        auto inputScalarType = inputType->getScalarType();
+        auto destinationScalarType = destinationType->getScalarType();
+
         // Boolean
-        if (destinationType == bitType)
+        if (destinationScalarType == bitType)
         {
             return CastToConditionalBool(pValue);
         }
 
-        if (inputType == bitType)
+        if (inputScalarType == bitType)
         {
-            if (destinationType->isIntegerTy())
+            if (destinationScalarType->isIntegerTy())
             {
                 return CastInt(pValue, destinationType, false);
             }
-            else if (destinationType->isFloatingPointTy())
+            else if (destinationScalarType->isFloatingPointTy())
             {
                 return CastIntToFloat(pValue, destinationType, false);
             }
         }
-        else if (inputType->isIntegerTy())
+        else if (inputScalarType->isIntegerTy())
         {
-            if (destinationType->isIntegerTy())
+            if (destinationScalarType->isIntegerTy())
             {
                 return CastInt(pValue, destinationType, true);
             }
-            else if (destinationType->isFloatingPointTy())
+            else if (destinationScalarType->isFloatingPointTy())
             {
                 return CastIntToFloat(pValue, destinationType, true);
             }
         }
-        else if (inputType->isFloatingPointTy())
+        else if (inputScalarType->isFloatingPointTy())
         {
-            if (destinationType->isIntegerTy())
+            if (destinationScalarType->isIntegerTy())
             {
                 return CastFloatToInt(pValue, destinationType, true);
             }
-            else if (destinationType->isFloatingPointTy())
+            else if (destinationScalarType->isFloatingPointTy())
             {
                 return CastFloat(pValue, destinationType);
             }
@@ -528,15 +546,15 @@ namespace emitters
         auto inputType = pValue->getType();
         auto bitType = llvm::Type::getInt1Ty(_llvmContext);
 
-        if (inputType == bitType)
+        if (inputType->getScalarType() == bitType)
         {
             return pValue;
         }
-        else if (inputType->isIntegerTy())
+        else if (inputType->isIntOrIntVectorTy())
         {
             return Comparison(TypedComparison::notEquals, pValue, Zero(inputType));
         }
-        else if (inputType->isFloatingPointTy())
+        else if (inputType->isFPOrFPVectorTy())
         {
             return Comparison(TypedComparison::notEqualsFloat, pValue, Zero(inputType));
         }
@@ -578,6 +596,8 @@ namespace emitters
     {
         assert(pLeftValue != nullptr);
         assert(pRightValue != nullptr);
+        SplatToMatch(_irBuilder, pLeftValue, pRightValue);
+        SplatToMatch(_irBuilder, pRightValue, pLeftValue);
 
         switch (type)
         {
@@ -620,6 +640,8 @@ namespace emitters
     {
         assert(pLeftValue != nullptr);
         assert(pRightValue != nullptr);
+        SplatToMatch(_irBuilder, pLeftValue, pRightValue);
+        SplatToMatch(_irBuilder, pRightValue, pLeftValue);
 
         switch (type)
         {
@@ -679,6 +701,10 @@ namespace emitters
         assert(pTrueValue != nullptr);
         assert(pFalseValue != nullptr);
         auto boolValue = CastToConditionalBool(pCmp);
+        SplatToMatch(_irBuilder, pTrueValue, boolValue);
+        SplatToMatch(_irBuilder, pFalseValue, boolValue);
+        SplatToMatch(_irBuilder, pTrueValue, pFalseValue);
+        SplatToMatch(_irBuilder, pFalseValue, pTrueValue);
 
         return _irBuilder.CreateSelect(boolValue, pTrueValue, pFalseValue);
     }
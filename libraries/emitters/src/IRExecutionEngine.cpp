@@ -7,9 +7,14 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "IRExecutionEngine.h"
+#include "IRLazyFunctionCompiler.h"
 #include "IRModuleEmitter.h"
 
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/Error.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
 
 #include <memory>
 #include <string>
@@ -24,12 +29,42 @@ namespace emitters
         throw emitters::EmitterException(emitters::EmitterError::unexpected, msg);
     }
 
+    namespace
+    {
+        std::unique_ptr<llvm::Module> CopyModule(const llvm::Module& module, llvm::LLVMContext& context)
+        {
+            llvm::SmallVector<char, 0> buffer;
+            llvm::raw_svector_ostream stream(buffer);
+            llvm::WriteBitcodeToFile(&module, stream);
+
+            auto copy = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), module.getModuleIdentifier()), context);
+            if (!copy)
+            {
+                throw EmitterException(EmitterError::unexpected, "Couldn't copy module: " + llvm::toString(copy.takeError()));
+            }
+            return std::move(*copy);
+        }
+    } // namespace
+
     IRExecutionEngine::IRExecutionEngine(IRModuleEmitter&& module, bool verify) :
         IRExecutionEngine(module.TransferOwnership(), verify)
     {
     }
 
     IRExecutionEngine::IRExecutionEngine(std::unique_ptr<llvm::Module> pModule, bool verify)
+    {
+        CreateBuilder(std::move(pModule), verify);
+    }
+
+    IRExecutionEngine::IRExecutionEngine(const llvm::Module& module, bool optimize, bool verify) :
+        _pContext(std::make_unique<llvm::LLVMContext>())
+    {
+        auto pModule = CopyModule(module, *_pContext);
+        _pLazyFunctions = std::make_unique<IRLazyFunctionCompiler>(*pModule, optimize);
+        CreateBuilder(std::move(pModule), verify);
+    }
+
+    void IRExecutionEngine::CreateBuilder(std::unique_ptr<llvm::Module> pModule, bool verify)
     {
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
@@ -48,6 +83,12 @@ namespace emitters
 
     IRExecutionEngine::~IRExecutionEngine()
     {
+        if (_pLazyFunctions)
+        {
+            _pLazyFunctions->Stop();
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         if (_pEngine)
         {
             PerformFinalization();
@@ -57,10 +98,20 @@ namespace emitters
     void IRExecutionEngine::AddModule(std::unique_ptr<llvm::Module> pModule)
     {
         assert(pModule != nullptr);
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         EnsureEngine();
         _pEngine->addModule(std::move(pModule));
     }
 
+    void IRExecutionEngine::SetObjectCache(llvm::ObjectCache* cache)
+    {
+        if (_pEngine)
+        {
+            throw EmitterException(EmitterError::unexpected, "The object cache must be set before the execution engine is used");
+        }
+        _pObjectCache = cache;
+    }
+
     void IRExecutionEngine::PerformInitialization()
     {
         _pEngine->runStaticConstructorsDestructors(false);
@@ -71,14 +122,38 @@ namespace emitters
         _pEngine->runStaticConstructorsDestructors(true);
     }
 
+    int IRExecutionEngine::GetNumLazyFunctions() const
+    {
+        return _pLazyFunctions ? _pLazyFunctions->GetNumFunctions() : 0;
+    }
+
+    int IRExecutionEngine::GetNumCompiledLazyFunctions() const
+    {
+        return _pLazyFunctions ? _pLazyFunctions->GetNumCompiledFunctions() : 0;
+    }
+
+    void IRExecutionEngine::CompileLazyFunctions()
+    {
+        if (_pLazyFunctions)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                EnsureEngine();
+            }
+            _pLazyFunctions->CompileAll();
+        }
+    }
+
     uint64_t IRExecutionEngine::GetFunctionAddress(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         EnsureEngine();
         return _pEngine->getFunctionAddress(name);
     }
 
     uint64_t IRExecutionEngine::GetGlobalValueAddress(const std::string& name)
     {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         EnsureEngine();
         return _pEngine->getGlobalValueAddress(name);
     }
@@ -95,6 +170,7 @@ namespace emitters
 
     void IRExecutionEngine::DefineFunction(LLVMFunction func, uintptr_t address)
     {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         EnsureEngine();
         _pEngine->addGlobalMapping(func, (void*)address);
     }
@@ -123,11 +199,29 @@ namespace emitters
 
     void IRExecutionEngine::EnsureEngine()
     {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         if (!_pEngine)
         {
             auto pEngine = _pBuilder->create();
             _pEngine.reset(pEngine);
+            if (_pObjectCache != nullptr)
+            {
+                // Load (or compile and store) all of the code up front, so the static constructors of a module loaded
+                // from the cache can be found in its object code
+                _pEngine->setObjectCache(_pObjectCache);
+                _pEngine->finalizeObject();
+            }
+            if (_pLazyFunctions)
+            {
+                _pLazyFunctions->Start(*this);
+            }
             PerformInitialization();
+
+            // Only compile in the background once the engine is fully set up
+            if (_pLazyFunctions)
+            {
+                _pLazyFunctions->StartBackgroundCompilation();
+            }
         }
     }
 } // namespace emitters
@@ -319,9 +319,12 @@ namespace emitters
         std::string predictMethodName;
         std::string predictReturnType;
         std::string predictReturnMember;
+        std::string predictContextArg = "this";
+        std::string resetArgs;
         std::vector<std::string> predictMethodArgs;
         std::vector<std::string> predictCallArgs;
         std::stringstream constructorInit;
+        std::stringstream destructorImpl;
         std::stringstream predictPreBody;
         std::stringstream predictPostBody;
         std::stringstream memberDecls;
@@ -483,8 +486,9 @@ namespace emitters
             if (argName == "context")
             {
                 // we really want void* on these puppies, but LLVM won't let us...(which is why the argType is int8_t*,
-                // and for our wrapper class, the context will be 'this' so the "C" callbacks can find this object.
-                info.predictCallArgs.push_back("this");
+                // and for our wrapper class, the context will be 'this' so the "C" callbacks can find this object
+                // (or, for reentrant modules, the instance block created with 'this' as its context).
+                info.predictCallArgs.push_back(info.predictContextArg);
             }
             else
             {
@@ -538,7 +542,7 @@ namespace emitters
             info.helperMethods << "    {\n";
             info.helperMethods << info.predictPreBody.str();
             info.helperMethods << "        double time = _timer.GetMilliseconds();\n";
-            info.helperMethods << "        " << info.predictFunctionName << "(this, &time, nullptr);\n";
+            info.helperMethods << "        " << info.predictFunctionName << "(" << info.predictContextArg << ", &time, nullptr);\n";
             info.helperMethods << info.predictPostBody.str();
             if (info.predictReturnType != "void")
             {
@@ -564,6 +568,27 @@ namespace emitters
         }
     }
 
+    void WritePredictBatchMethod(LLVMFunction predictBatchFunction, CppWrapperInfo& info)
+    {
+        // Arguments are context, count, inputs, outputs
+        std::vector<std::string> argTypes;
+        for (auto arg = predictBatchFunction->arg_begin() + 2, end = predictBatchFunction->arg_end(); arg != end; ++arg)
+        {
+            std::stringstream ss;
+            WriteLLVMType(ss, arg->getType()->getPointerElementType());
+            argTypes.push_back(ss.str());
+        }
+
+        // Inputs are packed one sample after another, and so are the returned outputs
+        info.helperMethods << "    std::vector<" << argTypes[1] << "> " << info.predictMethodName << "Batch(std::vector<" << argTypes[0] << ">& inputs)\n";
+        info.helperMethods << "    {\n";
+        info.helperMethods << "        int32_t count = static_cast<int32_t>(inputs.size() / GetInputSize());\n";
+        info.helperMethods << "        std::vector<" << argTypes[1] << "> outputs(count * GetOutputSize());\n";
+        info.helperMethods << "        " << predictBatchFunction->getName().str() << "(" << info.predictContextArg << ", count, inputs.data(), outputs.data());\n";
+        info.helperMethods << "        return outputs;\n";
+        info.helperMethods << "    }\n\n";
+    }
+
     void WriteModuleCppWrapper(std::ostream& os, IRModuleEmitter& moduleEmitter)
     {
         auto callbacks = GetFunctionsWithTag(moduleEmitter, c_callbackFunctionTagName);
@@ -597,6 +622,18 @@ namespace emitters
 
         bool hasSourceNodes = !moduleCallbacks.sources.empty();
 
+        // Reentrant modules keep their state in an instance block owned by the wrapper
+        if (moduleEmitter.GetLLVMModule()->getFunction(moduleName + "_CreateInstance") != nullptr)
+        {
+            info.predictContextArg = "_instance";
+            info.resetArgs = "_instance";
+            info.constructorInit << "        _instance = " << moduleName << "_CreateInstance(this);\n";
+            info.destructorImpl << "        " << moduleName << "_DestroyInstance(_instance);\n";
+            info.memberDecls << "    " << className << "(const " << className << "&) = delete;\n";
+            info.memberDecls << "    " << className << "& operator=(const " << className << "&) = delete;\n";
+            info.memberDecls << "    void* _instance = nullptr;\n";
+        }
+
         if (!hasSourceNodes)
         {
             WriteSimplePredictMethod(predictFunction, info);
@@ -611,6 +648,12 @@ namespace emitters
 
         WritePredictMethod(moduleCallbacks, info);
 
+        auto predictBatchFunction = moduleEmitter.GetLLVMModule()->getFunction(info.predictFunctionName + "Batch");
+        if (!hasSourceNodes && predictBatchFunction != nullptr)
+        {
+            WritePredictBatchMethod(predictBatchFunction, info);
+        }
+
         // now write out the final completed code.
 
         // (Note: newlines are part of the syntax for #include)
@@ -624,12 +667,14 @@ namespace emitters
         ReplaceDelimiter(predictWrapperCode, "MODULE", moduleName);
         ReplaceDelimiter(predictWrapperCode, "CLASSNAME", className);
         ReplaceDelimiter(predictWrapperCode, "CONSTRUCTOR_IMPL", info.constructorInit.str());
+        ReplaceDelimiter(predictWrapperCode, "DESTRUCTOR_IMPL", info.destructorImpl.str());
         ReplaceDelimiter(predictWrapperCode, "CLASS_GUARD", utilities::ToUppercase(moduleName) + "_WRAPPER_DEFINED");
         ReplaceDelimiter(predictWrapperCode, "MEMBER_DECLS", info.memberDecls.str());
         ReplaceDelimiter(predictWrapperCode, "HELPER_METHODS", info.helperMethods.str());
         ReplaceDelimiter(predictWrapperCode, "CDECLS_GUARD", utilities::ToUppercase(className) + "_CDECLS");
         ReplaceDelimiter(predictWrapperCode, "CDECLS_IMPL", info.cdecls.str());
         ReplaceDelimiter(predictWrapperCode, "STEPPABLE", hasSourceNodes ? "true" : "false");
+        ReplaceDelimiter(predictWrapperCode, "RESET_ARGS", info.resetArgs);
         ReplaceDelimiter(predictWrapperCode, "RESET_BODY", info.resetMethodBody.str());
 
         os << predictWrapperCode;
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRLazyFunctionCompiler.cpp (emitters)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRLazyFunctionCompiler.h"
+#include "EmitterException.h"
+#include "IRExecutionEngine.h"
+#include "IRMetadata.h"
+#include "IROptimizer.h"
+#include "LLVMUtilities.h"
+
+#include <utilities/include/Logger.h>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <unordered_set>
+
+namespace ell
+{
+namespace emitters
+{
+    using namespace logging;
+
+    namespace
+    {
+        using GlobalValueSet = std::unordered_set<const llvm::GlobalValue*>;
+
+        // Checks that every use of a function is a direct call, so all of them can be redirected
+        bool IsOnlyCalledDirectly(const llvm::Function& function)
+        {
+            for (const auto& use : function.uses())
+            {
+                auto call = llvm::dyn_cast<llvm::CallInst>(use.getUser());
+                if (call == nullptr || call->getCalledFunction() != &function)
+                {
+                    return false;
+                }
+                for (const auto& argument : call->arg_operands())
+                {
+                    if (argument.get() == &function)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Gets the functions to define in a lazily-compiled function's module: the function itself, plus the
+        // module-local functions it calls (which get private copies, so they can still be inlined). The module-local
+        // variables they use must be shared with the rest of the code, so they're made external instead.
+        GlobalValueSet GetFunctionModuleDefinitions(llvm::Function& function)
+        {
+            GlobalValueSet definitions = { &function };
+            std::vector<const llvm::Function*> pending = { &function };
+            while (!pending.empty())
+            {
+                auto current = pending.back();
+                pending.pop_back();
+
+                for (auto global : GetReferencedGlobalValues(*current))
+                {
+                    auto localFunction = llvm::dyn_cast<llvm::Function>(global);
+                    if (localFunction != nullptr && localFunction->hasLocalLinkage() && !localFunction->isDeclaration())
+                    {
+                        if (definitions.insert(localFunction).second)
+                        {
+                            pending.push_back(localFunction);
+                        }
+                    }
+                    else if (global->hasLocalLinkage())
+                    {
+                        if (!global->hasName())
+                        {
+                            global->setName("lazy.global");
+                        }
+                        global->setLinkage(llvm::GlobalValue::ExternalLinkage);
+                        global->setVisibility(llvm::GlobalValue::DefaultVisibility);
+                    }
+                }
+            }
+            return definitions;
+        }
+    } // namespace
+
+    IRLazyFunctionCompiler::IRLazyFunctionCompiler(llvm::Module& module, bool optimize) :
+        _optimize(optimize)
+    {
+        std::vector<llvm::Function*> lazyFunctions;
+        for (auto& function : module)
+        {
+            if (!function.isDeclaration() && function.getMetadata(c_nodeFunctionTagName) != nullptr && IsOnlyCalledDirectly(function))
+            {
+                lazyFunctions.push_back(&function);
+            }
+        }
+
+        auto& context = module.getContext();
+        const auto& dataLayout = module.getDataLayout();
+        auto intPtrType = dataLayout.getIntPtrType(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto GetAddressConstant = [intPtrType](uintptr_t address, llvm::Type* type) {
+            return llvm::ConstantExpr::getIntToPtr(llvm::ConstantInt::get(intPtrType, address), type);
+        };
+
+        // The stubs call back into `ResolveFunction`, whose address is emitted as a constant
+        auto resolverType = llvm::FunctionType::get(int8PtrType, { int8PtrType, llvm::Type::getInt32Ty(context) }, false);
+        auto resolver = GetAddressConstant(reinterpret_cast<uintptr_t>(&IRLazyFunctionCompiler::ResolveFunction), resolverType->getPointerTo());
+        auto compiler = GetAddressConstant(reinterpret_cast<uintptr_t>(this), int8PtrType);
+
+        for (size_t index = 0; index < lazyFunctions.size(); ++index)
+        {
+            auto function = lazyFunctions[index];
+            auto functionType = function->getFunctionType();
+            auto functionPointerType = function->getType();
+
+            auto lazyFunction = std::make_unique<LazyFunction>();
+            lazyFunction->name = function->getName().str();
+            lazyFunction->stubName = lazyFunction->name + "_LazyStub";
+            auto address = GetAddressConstant(reinterpret_cast<uintptr_t>(&lazyFunction->address), functionPointerType->getPointerTo());
+
+            // Call the function through its address, which is updated once the function is compiled
+            std::vector<llvm::CallInst*> calls;
+            for (auto user : function->users())
+            {
+                calls.push_back(llvm::cast<llvm::CallInst>(user));
+            }
+            for (auto call : calls)
+            {
+                llvm::IRBuilder<> builder(call);
+                auto functionPointer = builder.CreateLoad(functionPointerType, address, lazyFunction->name + "_address");
+                functionPointer->setAlignment(dataLayout.getPointerABIAlignment(0));
+                functionPointer->setAtomic(llvm::AtomicOrdering::Acquire);
+                call->setCalledFunction(functionType, functionPointer);
+            }
+
+            // The stub compiles the function, then forwards its arguments to it
+            auto stub = llvm::Function::Create(functionType, llvm::GlobalValue::ExternalLinkage, lazyFunction->stubName, &module);
+            stub->setCallingConv(function->getCallingConv());
+            llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", stub));
+            auto compiledFunction = builder.CreateCall(resolverType, resolver, { compiler, builder.getInt32(static_cast<uint32_t>(index)) });
+            std::vector<llvm::Value*> arguments;
+            for (auto& argument : stub->args())
+            {
+                arguments.push_back(&argument);
+            }
+            auto result = builder.CreateCall(functionType, builder.CreatePointerCast(compiledFunction, functionPointerType), arguments);
+            result->setCallingConv(function->getCallingConv());
+            if (result->getType()->isVoidTy())
+            {
+                builder.CreateRetVoid();
+            }
+            else
+            {
+                builder.CreateRet(result);
+            }
+
+            _functions.push_back(std::move(lazyFunction));
+        }
+
+        // Now that no calls refer to the functions directly, move each one into its own module
+        for (size_t index = 0; index < lazyFunctions.size(); ++index)
+        {
+            auto function = lazyFunctions[index];
+            function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            auto definitions = GetFunctionModuleDefinitions(*function);
+
+            llvm::ValueToValueMapTy valueMap;
+            auto functionModule = llvm::CloneModule(&module, valueMap, [&definitions](const llvm::GlobalValue* global) { return definitions.count(global) != 0; });
+            functionModule->setModuleIdentifier(_functions[index]->name);
+            RemoveUnusedDeclarations(*functionModule);
+            _functions[index]->module = std::move(functionModule);
+        }
+
+        for (auto function : lazyFunctions)
+        {
+            function->eraseFromParent();
+        }
+
+        if (_optimize)
+        {
+            OptimizeModule(module);
+        }
+        Log() << "Moved " << _functions.size() << " functions into lazily-compiled modules" << EOL;
+    }
+
+    IRLazyFunctionCompiler::~IRLazyFunctionCompiler()
+    {
+        Stop();
+    }
+
+    void IRLazyFunctionCompiler::Start(IRExecutionEngine& engine)
+    {
+        _engine = &engine;
+        for (auto& function : _functions)
+        {
+            function->address.store(reinterpret_cast<void*>(engine.ResolveFunctionAddress(function->stubName)), std::memory_order_release);
+        }
+    }
+
+    void IRLazyFunctionCompiler::StartBackgroundCompilation()
+    {
+        if (!_functions.empty() && !_backgroundThread.joinable())
+        {
+            _backgroundThread = std::thread([this] { CompileInBackground(); });
+        }
+    }
+
+    void IRLazyFunctionCompiler::Stop()
+    {
+        _stopBackgroundThread = true;
+        if (_backgroundThread.joinable())
+        {
+            _backgroundThread.join();
+        }
+    }
+
+    void IRLazyFunctionCompiler::CompileAll()
+    {
+        for (int index = 0; index < GetNumFunctions(); ++index)
+        {
+            Compile(index);
+        }
+    }
+
+    void* IRLazyFunctionCompiler::ResolveFunction(IRLazyFunctionCompiler* compiler, int32_t index) noexcept
+    {
+        try
+        {
+            return compiler->Compile(index);
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << "Lazy compilation of function " << compiler->_functions[index]->name << " failed: " << exception.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "Lazy compilation of function " << compiler->_functions[index]->name << " failed" << std::endl;
+        }
+        std::abort();
+    }
+
+    void* IRLazyFunctionCompiler::Compile(int index)
+    {
+        // Optimizing and compiling use the LLVM context shared with the engine's other modules
+        std::lock_guard<std::recursive_mutex> lock(_engine->GetMutex());
+
+        auto& function = *_functions[index];
+        if (!function.isCompiled)
+        {
+            if (!function.module)
+            {
+                throw EmitterException(EmitterError::unexpected, "Lazily-compiled function " + function.name + " failed to compile");
+            }
+
+            auto module = std::move(function.module);
+            if (_optimize)
+            {
+                OptimizeModule(*module);
+            }
+            _engine->AddModule(std::move(module));
+            function.address.store(reinterpret_cast<void*>(_engine->ResolveFunctionAddress(function.name)), std::memory_order_release);
+            function.isCompiled = true;
+            ++_numCompiledFunctions;
+        }
+        return function.address.load(std::memory_order_acquire);
+    }
+
+    void IRLazyFunctionCompiler::CompileInBackground()
+    {
+        try
+        {
+            for (int index = 0; index < GetNumFunctions() && !_stopBackgroundThread; ++index)
+            {
+                Compile(index);
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            // Leave the rest to be compiled on first call, which reports the error
+            Log() << "Background compilation stopped: " << exception.what() << EOL;
+        }
+    }
+} // namespace emitters
+} // namespace ell
@@ -12,22 +12,326 @@
 
 #include <utilities/include/Exception.h>
 
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Value.h>
 
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <vector>
 
 namespace ell
 {
 namespace emitters
 {
+    namespace
+    {
+        //
+        // Polynomial coefficients, from the constant term up
+        //
+
+        // exp(r) = 1 + r + r^2 * P(r), minimax coefficients from Cephes' expf
+        const std::vector<double> c_expFloatCoefficients = { 5.0000001201E-1, 1.6666665459E-1, 4.1665795894E-2, 8.3334519073E-3, 1.3981999507E-3, 1.9875691500E-4 };
+
+        // exp(r) = 1 + r + r * c / (2 - c), with c = r - r^2 * P(r^2), minimax coefficients from fdlibm's exp
+        const std::vector<double> c_expDoubleCoefficients = { 1.66666666666666019037e-01, -2.77777777770155933842e-03, 6.61375632143793436117e-05, -1.65339022054652515390e-06, 4.13813679705723846039e-08 };
+
+        // exp(r) = 1 + r + r^2 * P(r), interpolated at Chebyshev nodes (relative error 1.4e-5)
+        const std::vector<double> c_expFastCoefficients = { 0.5, 0.1674189866950507, 0.04179198611287386 };
+
+        // log(1 + f) = f - f^2 / 2 + f^3 * P(f), minimax coefficients from Cephes' logf
+        const std::vector<double> c_logFloatCoefficients = { 3.3333331174E-1, -2.4999993993E-1, 2.0000714765E-1, -1.6668057665E-1, 1.4249322787E-1, -1.2420140846E-1, 1.1676998740E-1, -1.1514610310E-1, 7.0376836292E-2 };
+
+        // log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + s^2 * P(s^2)), with s = f / (2 + f), minimax coefficients from fdlibm's log
+        const std::vector<double> c_logDoubleCoefficients = { 6.666666666666735130e-01, 3.999999999940941908e-01, 2.857142874366239149e-01, 2.222219843214978396e-01, 1.818357216161805012e-01, 1.531383769920937332e-01, 1.479819860511658591e-01 };
+
+        // log(1 + f) = f - f^2 / 2 + f^3 * P(f), interpolated at Chebyshev nodes (absolute error 1.3e-5)
+        const std::vector<double> c_logFastCoefficients = { 0.3331416974296352, -0.2516476913811987, 0.21452891614646918, -0.14852839838899407 };
+
+        // tanh(x) = x + x^3 * P(x^2) for |x| < 0.625, minimax coefficients from Cephes' tanhf
+        const std::vector<double> c_tanhFloatCoefficients = { -3.33332819422E-1, 1.33314422036E-1, -5.37397155531E-2, 2.06390887954E-2, -5.70498872745E-3 };
+
+        // tanh(x) = x + x^3 * P(x^2) / Q(x^2) for |x| < 0.625, from Cephes' tanh
+        const std::vector<double> c_tanhDoubleNumeratorCoefficients = { -1.61468768441708447952E3, -9.92877231001918586564E1, -9.64399179425052238628E-1 };
+        const std::vector<double> c_tanhDoubleDenominatorCoefficients = { 4.84406305325125486048E3, 2.23548839060100448583E3, 1.12811678491632931402E2, 1.0 };
+
+        const double c_log2e = 1.44269504088896340736;
+        const double c_sqrtHalf = 0.70710678118654752440;
+
+        // ln(2), split so that multiplying the high part by a (small) integer is exact
+        const double c_ln2HighFloat = 0.693359375;
+        const double c_ln2LowFloat = -2.12194440e-4;
+        const double c_ln2HighDouble = 6.93147180369123816490e-01;
+        const double c_ln2LowDouble = 1.90821492927058770002e-10;
+
+        // Emits the arithmetic the approximations are made of, for a `float` or `double` scalar or vector type
+        class ApproximationEmitter
+        {
+        public:
+            ApproximationEmitter(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation) :
+                _function(function),
+                _builder(function.GetEmitter().GetIRBuilder()),
+                _type(x->getType())
+            {
+                auto elementType = _type->getScalarType();
+                if (!elementType->isFloatTy() && !elementType->isDoubleTy())
+                {
+                    throw EmitterException(EmitterError::valueTypeNotSupported, "Math function approximations need float or double values");
+                }
+                if (implementation == MathFunctionImplementation::library)
+                {
+                    throw EmitterException(EmitterError::notSupported, "The library math functions aren't approximations");
+                }
+
+                _isDouble = elementType->isDoubleTy();
+                _intType = GetMatchingType(_builder.getIntNTy(_isDouble ? 64 : 32));
+                _int32Type = GetMatchingType(_builder.getInt32Ty());
+            }
+
+            bool IsDouble() const { return _isDouble; }
+            int GetMantissaBits() const { return _isDouble ? 52 : 23; }
+            int GetExponentBias() const { return _isDouble ? 1023 : 127; }
+            llvm::IRBuilder<>& GetBuilder() { return _builder; }
+            LLVMType GetIntType() const { return _intType; }
+            LLVMType GetInt32Type() const { return _int32Type; }
+
+            LLVMValue Constant(double value) { return llvm::ConstantFP::get(_type, value); }
+            LLVMValue IntConstant(int64_t value) { return llvm::ConstantInt::get(_intType, value, true); }
+            LLVMValue Int32Constant(int value) { return llvm::ConstantInt::get(_int32Type, value, true); }
+
+            LLVMValue Add(LLVMValue a, LLVMValue b) { return _builder.CreateFAdd(a, b); }
+            LLVMValue Subtract(LLVMValue a, LLVMValue b) { return _builder.CreateFSub(a, b); }
+            LLVMValue Multiply(LLVMValue a, LLVMValue b) { return _builder.CreateFMul(a, b); }
+            LLVMValue Divide(LLVMValue a, LLVMValue b) { return _builder.CreateFDiv(a, b); }
+            LLVMValue Less(LLVMValue a, LLVMValue b) { return _builder.CreateFCmpOLT(a, b); }
+            LLVMValue Greater(LLVMValue a, LLVMValue b) { return _builder.CreateFCmpOGT(a, b); }
+            LLVMValue Equal(LLVMValue a, LLVMValue b) { return _builder.CreateFCmpOEQ(a, b); }
+            LLVMValue IsNaN(LLVMValue a) { return _builder.CreateFCmpUNO(a, a); }
+            LLVMValue Select(LLVMValue condition, LLVMValue a, LLVMValue b) { return _builder.CreateSelect(condition, a, b); }
+
+            LLVMValue Abs(LLVMValue a)
+            {
+                auto abs = _function.GetModule().GetIntrinsic(llvm::Intrinsic::fabs, { _type });
+                return _builder.CreateCall(abs, { a });
+            }
+
+            // Evaluates a polynomial with Horner's rule
+            LLVMValue Polynomial(LLVMValue x, const std::vector<double>& coefficients)
+            {
+                auto result = Constant(coefficients.back());
+                for (auto coefficient = coefficients.rbegin() + 1; coefficient != coefficients.rend(); ++coefficient)
+                {
+                    result = Add(Multiply(result, x), Constant(*coefficient));
+                }
+                return result;
+            }
+
+            // Rounds down to a 32-bit integer, for values well within its range
+            LLVMValue FloorToInt32(LLVMValue x)
+            {
+                auto truncated = _builder.CreateFPToSI(x, _int32Type);
+                auto roundedUp = Greater(_builder.CreateSIToFP(truncated, _type), x);
+                return _builder.CreateSelect(roundedUp, _builder.CreateSub(truncated, Int32Constant(1)), truncated);
+            }
+
+            LLVMValue ToFloatingPoint(LLVMValue int32Value) { return _builder.CreateSIToFP(int32Value, _type); }
+
+            // 2^n for a 32-bit integer n in the range of normal exponents
+            LLVMValue PowerOfTwo(LLVMValue n)
+            {
+                auto exponent = _builder.CreateAdd(_builder.CreateSExtOrTrunc(n, _intType), IntConstant(GetExponentBias()));
+                return _builder.CreateBitCast(_builder.CreateShl(exponent, GetMantissaBits()), _type);
+            }
+
+        private:
+            LLVMType GetMatchingType(LLVMType elementType)
+            {
+                if (auto vectorType = llvm::dyn_cast<llvm::VectorType>(_type))
+                {
+                    return llvm::VectorType::get(elementType, vectorType->getNumElements());
+                }
+                return elementType;
+            }
+
+            IRFunctionEmitter& _function;
+            llvm::IRBuilder<>& _builder;
+            LLVMType _type;
+            LLVMType _intType;
+            LLVMType _int32Type;
+            bool _isDouble = false;
+        };
+
+        MathFunctionImplementation GetMathFunctionImplementation(const IRLocalScalar& a)
+        {
+            auto elementType = a.value->getType()->getScalarType();
+            if (!elementType->isFloatTy() && !elementType->isDoubleTy())
+            {
+                return MathFunctionImplementation::library;
+            }
+            return a.function.GetCompilerOptions().mathFunctions;
+        }
+    } // namespace
+
+    //
+    // Approximations
+    //
+    LLVMValue ApproximateExp(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation)
+    {
+        ApproximationEmitter emitter(function, x, implementation);
+        auto one = emitter.Constant(1.0);
+
+        // Past these bounds exp(x) underflows to 0 or overflows to infinity. NaN ends up at the upper bound, and is put back at the end.
+        auto lowerBound = emitter.Constant(emitter.IsDouble() ? -746.0 : -104.0);
+        auto upperBound = emitter.Constant(emitter.IsDouble() ? 710.0 : 89.0);
+        auto clampedX = emitter.Select(emitter.Less(x, upperBound), x, upperBound);
+        clampedX = emitter.Select(emitter.Greater(clampedX, lowerBound), clampedX, lowerBound);
+
+        // x = n * ln(2) + r, with |r| <= ln(2) / 2
+        auto n = emitter.FloorToInt32(emitter.Add(emitter.Multiply(clampedX, emitter.Constant(c_log2e)), emitter.Constant(0.5)));
+        auto nValue = emitter.ToFloatingPoint(n);
+        auto ln2High = emitter.Constant(emitter.IsDouble() ? c_ln2HighDouble : c_ln2HighFloat);
+        auto ln2Low = emitter.Constant(emitter.IsDouble() ? c_ln2LowDouble : c_ln2LowFloat);
+        auto r = emitter.Subtract(emitter.Subtract(clampedX, emitter.Multiply(nValue, ln2High)), emitter.Multiply(nValue, ln2Low));
+        auto rSquared = emitter.Multiply(r, r);
+
+        LLVMValue expR = nullptr;
+        if (implementation == MathFunctionImplementation::accurate && emitter.IsDouble())
+        {
+            auto c = emitter.Subtract(r, emitter.Multiply(rSquared, emitter.Polynomial(rSquared, c_expDoubleCoefficients)));
+            expR = emitter.Add(one, emitter.Add(r, emitter.Divide(emitter.Multiply(r, c), emitter.Subtract(emitter.Constant(2.0), c))));
+        }
+        else
+        {
+            const auto& coefficients = implementation == MathFunctionImplementation::fast ? c_expFastCoefficients : c_expFloatCoefficients;
+            expR = emitter.Add(emitter.Add(emitter.Multiply(rSquared, emitter.Polynomial(r, coefficients)), r), one);
+        }
+
+        // Scale by 2^n in two steps, so that results near the ends of the range don't need an out-of-range exponent
+        auto& builder = emitter.GetBuilder();
+        auto n1 = builder.CreateAShr(n, 1);
+        auto n2 = builder.CreateSub(n, n1);
+        auto result = emitter.Multiply(emitter.Multiply(expR, emitter.PowerOfTwo(n1)), emitter.PowerOfTwo(n2));
+        return emitter.Select(emitter.IsNaN(x), x, result);
+    }
+
+    LLVMValue ApproximateLog(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation)
+    {
+        ApproximationEmitter emitter(function, x, implementation);
+        auto& builder = emitter.GetBuilder();
+        auto one = emitter.Constant(1.0);
+        auto half = emitter.Constant(0.5);
+
+        // Scale subnormal numbers up, so the exponent field holds their exponent
+        const int subnormalShift = emitter.GetMantissaBits() + 2;
+        auto minNormal = emitter.IsDouble() ? std::numeric_limits<double>::min() : static_cast<double>(std::numeric_limits<float>::min());
+        auto isSubnormal = emitter.Less(x, emitter.Constant(minNormal));
+        auto scaledX = emitter.Select(isSubnormal, emitter.Multiply(x, emitter.Constant(std::ldexp(1.0, subnormalShift))), x);
+
+        // x = 2^e * m, with m in [0.5, 1)
+        auto bits = builder.CreateBitCast(scaledX, emitter.GetIntType());
+        auto exponentMask = emitter.IntConstant(emitter.IsDouble() ? 0x7ff : 0xff);
+        auto exponent = builder.CreateAnd(builder.CreateLShr(bits, emitter.GetMantissaBits()), exponentMask);
+        auto e = builder.CreateSExtOrTrunc(builder.CreateSub(exponent, emitter.IntConstant(emitter.GetExponentBias() - 1)), emitter.GetInt32Type());
+        e = builder.CreateSelect(isSubnormal, builder.CreateSub(e, emitter.Int32Constant(subnormalShift)), e);
+        auto mantissaMask = emitter.IntConstant((int64_t{ 1 } << emitter.GetMantissaBits()) - 1);
+        auto halfExponent = emitter.IntConstant(static_cast<int64_t>(emitter.GetExponentBias() - 1) << emitter.GetMantissaBits());
+        auto m = builder.CreateBitCast(builder.CreateOr(builder.CreateAnd(bits, mantissaMask), halfExponent), x->getType());
+
+        // Move m into [sqrt(2)/2, sqrt(2)), and write it as 1 + f
+        auto isSmall = emitter.Less(m, emitter.Constant(c_sqrtHalf));
+        auto f = emitter.Select(isSmall, emitter.Subtract(emitter.Add(m, m), one), emitter.Subtract(m, one));
+        auto eValue = emitter.ToFloatingPoint(builder.CreateSelect(isSmall, builder.CreateSub(e, emitter.Int32Constant(1)), e));
+        auto fSquared = emitter.Multiply(f, f);
+
+        LLVMValue result = nullptr;
+        if (implementation == MathFunctionImplementation::accurate && emitter.IsDouble())
+        {
+            auto s = emitter.Divide(f, emitter.Add(emitter.Constant(2.0), f));
+            auto sSquared = emitter.Multiply(s, s);
+            auto R = emitter.Multiply(sSquared, emitter.Polynomial(sSquared, c_logDoubleCoefficients));
+            auto halfFSquared = emitter.Multiply(half, fSquared);
+            auto correction = emitter.Add(emitter.Multiply(s, emitter.Add(halfFSquared, R)), emitter.Multiply(eValue, emitter.Constant(c_ln2LowDouble)));
+            result = emitter.Subtract(emitter.Multiply(eValue, emitter.Constant(c_ln2HighDouble)), emitter.Subtract(emitter.Subtract(halfFSquared, correction), f));
+        }
+        else
+        {
+            const auto& coefficients = implementation == MathFunctionImplementation::fast ? c_logFastCoefficients : c_logFloatCoefficients;
+            auto y = emitter.Multiply(emitter.Multiply(f, fSquared), emitter.Polynomial(f, coefficients));
+            y = emitter.Add(y, emitter.Multiply(eValue, emitter.Constant(c_ln2LowFloat)));
+            y = emitter.Subtract(y, emitter.Multiply(half, fSquared));
+            result = emitter.Add(emitter.Add(f, y), emitter.Multiply(eValue, emitter.Constant(c_ln2HighFloat)));
+        }
+
+        auto infinity = emitter.Constant(std::numeric_limits<double>::infinity());
+        auto zero = emitter.Constant(0.0);
+        result = emitter.Select(emitter.Equal(x, infinity), x, result);
+        result = emitter.Select(emitter.Equal(x, zero), emitter.Constant(-std::numeric_limits<double>::infinity()), result);
+        return emitter.Select(builder.CreateFCmpULT(x, zero), emitter.Constant(std::numeric_limits<double>::quiet_NaN()), result);
+    }
+
+    LLVMValue ApproximateTanh(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation)
+    {
+        ApproximationEmitter emitter(function, x, implementation);
+        auto one = emitter.Constant(1.0);
+        auto expTwoX = ApproximateExp(function, emitter.Add(x, x), implementation);
+        auto result = emitter.Subtract(one, emitter.Divide(emitter.Constant(2.0), emitter.Add(expTwoX, one)));
+        if (implementation == MathFunctionImplementation::fast)
+        {
+            return result;
+        }
+
+        // 1 - 2 / (exp(2x) + 1) loses precision near 0
+        auto xSquared = emitter.Multiply(x, x);
+        LLVMValue smallResult = nullptr;
+        if (emitter.IsDouble())
+        {
+            auto ratio = emitter.Divide(emitter.Multiply(xSquared, emitter.Polynomial(xSquared, c_tanhDoubleNumeratorCoefficients)), emitter.Polynomial(xSquared, c_tanhDoubleDenominatorCoefficients));
+            smallResult = emitter.Add(x, emitter.Multiply(x, ratio));
+        }
+        else
+        {
+            smallResult = emitter.Add(emitter.Multiply(emitter.Multiply(emitter.Polynomial(xSquared, c_tanhFloatCoefficients), xSquared), x), x);
+        }
+        return emitter.Select(emitter.Less(emitter.Abs(x), emitter.Constant(0.625)), smallResult, result);
+    }
+
+    LLVMValue ApproximateSigmoid(IRFunctionEmitter& function, LLVMValue x, MathFunctionImplementation implementation)
+    {
+        ApproximationEmitter emitter(function, x, implementation);
+        auto one = emitter.Constant(1.0);
+        auto expMinusX = ApproximateExp(function, emitter.GetBuilder().CreateFNeg(x), implementation);
+        return emitter.Divide(one, emitter.Add(one, expMinusX));
+    }
+
     //
     // Math functions
     //
     template <typename ValueType>
     IRLocalScalar Tanh(IRLocalScalar a)
     {
+        auto implementation = GetMathFunctionImplementation(a);
+        if (implementation != MathFunctionImplementation::library)
+        {
+            return { a.function, ApproximateTanh(a.function, a.value, implementation) };
+        }
+
         auto f = a.function.GetModule().GetRuntime().GetTanhFunction<ValueType>();
-        return { a.function, a.function.Call(f, { a }) };
+        auto type = a.value->getType();
+        if (!type->isVectorTy())
+        {
+            return { a.function, a.function.Call(f, { a }) };
+        }
+
+        // The library function is scalar, so call it on each element of a vector
+        auto& builder = a.function.GetEmitter().GetIRBuilder();
+        LLVMValue result = llvm::UndefValue::get(type);
+        for (unsigned index = 0; index < type->getVectorNumElements(); ++index)
+        {
+            auto element = builder.CreateExtractElement(a.value, index);
+            result = builder.CreateInsertElement(result, a.function.Call(f, { element }), index);
+        }
+        return { a.function, result };
     }
 
     IRLocalScalar Abs(IRLocalScalar a)
@@ -44,16 +348,46 @@ namespace emitters
 
     IRLocalScalar Exp(IRLocalScalar a)
     {
+        auto implementation = GetMathFunctionImplementation(a);
+        if (implementation != MathFunctionImplementation::library)
+        {
+            return { a.function, ApproximateExp(a.function, a.value, implementation) };
+        }
+
         auto f = a.function.GetModule().GetRuntime().GetExpFunction((a.value)->getType());
         return { a.function, a.function.Call(f, { a }) };
     }
 
     IRLocalScalar Log(IRLocalScalar a)
     {
+        auto implementation = GetMathFunctionImplementation(a);
+        if (implementation != MathFunctionImplementation::library)
+        {
+            return { a.function, ApproximateLog(a.function, a.value, implementation) };
+        }
+
         auto f = a.function.GetModule().GetRuntime().GetLogFunction((a.value)->getType());
         return { a.function, a.function.Call(f, { a }) };
     }
 
+    IRLocalScalar Sigmoid(IRLocalScalar a)
+    {
+        auto implementation = GetMathFunctionImplementation(a);
+        if (implementation != MathFunctionImplementation::library)
+        {
+            return { a.function, ApproximateSigmoid(a.function, a.value, implementation) };
+        }
+
+        // Use whichever of 1 / (1 + exp(-x)) and exp(x) / (exp(x) + 1) doesn't overflow
+        auto& function = a.function;
+        const IRLocalScalar zero{ function, llvm::ConstantFP::get(a.value->getType(), 0.0) };
+        const IRLocalScalar one{ function, llvm::ConstantFP::get(a.value->getType(), 1.0) };
+        auto positiveResult = one / (Exp(a * -one) + one);
+        auto expA = Exp(a);
+        auto negativeResult = expA / (expA + one);
+        return { function, function.Select(a >= zero, positiveResult, negativeResult) };
+    }
+
     IRLocalScalar Sin(IRLocalScalar a)
     {
         auto f = a.function.GetModule().GetRuntime().GetSinFunction((a.value)->getType());
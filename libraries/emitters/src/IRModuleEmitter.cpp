@@ -13,6 +13,7 @@
 #include "IRHeaderWriter.h"
 #include "IRLoader.h"
 #include "IRMetadata.h"
+#include "IROptimizer.h"
 #include "IRSwigInterfaceWriter.h"
 #include "LLVMUtilities.h"
 #include "TargetDevice.h"
@@ -34,6 +35,8 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/Utils/ModuleUtils.h>
 
+#include <thread>
+
 namespace ell
 {
 namespace emitters
@@ -381,6 +384,24 @@ namespace emitters
         return pVal;
     }
 
+    void IRModuleEmitter::ReplaceEmittedGlobal(const std::string& name, llvm::Constant* pNewValue)
+    {
+        auto pGlobal = llvm::dyn_cast_or_null<llvm::GlobalVariable>(_globals.Get(name));
+        if (pGlobal == nullptr)
+        {
+            throw EmitterException(EmitterError::unexpected, "Unknown global variable " + name);
+        }
+        if (pGlobal->getType() != pNewValue->getType())
+        {
+            throw EmitterException(EmitterError::badFunctionArguments, "Replacement for global variable " + name + " has a different type");
+        }
+
+        pGlobal->replaceAllUsesWith(pNewValue);
+        pGlobal->eraseFromParent();
+        _globals.Remove(name);
+        _globals.Add(name, pNewValue);
+    }
+
     //
     // Variable and Constant creation
     //
@@ -777,6 +798,18 @@ namespace emitters
         auto compilerOptions = GetCompilerOptions();
         if (compilerOptions.optimize)
         {
+            auto numThreads = compilerOptions.optimizerThreads;
+            if (numThreads == 0)
+            {
+                numThreads = static_cast<int>(std::thread::hardware_concurrency());
+            }
+
+            if (numThreads > 1)
+            {
+                OptimizeModuleInParallel(*GetLLVMModule(), numThreads);
+                return;
+            }
+
             auto module = GetLLVMModule();
             for (auto& function : *module)
             {
@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRObjectCache.cpp (emitters)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRObjectCache.h"
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+#include <utilities/include/Logger.h>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace ell
+{
+namespace emitters
+{
+    using namespace logging;
+
+    namespace
+    {
+        const char* c_objectExtension = ".o";
+        const char* c_initializersExtension = ".init";
+
+        // 64-bit FNV-1a hash
+        uint64_t Hash(const std::string& data, uint64_t basis)
+        {
+            const uint64_t prime = 1099511628211ull;
+            uint64_t hash = basis;
+            for (auto c : data)
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= prime;
+            }
+            return hash;
+        }
+
+        std::vector<llvm::Function*> GetInitializerFunctions(const llvm::Module& module, const std::string& arrayName, std::vector<int>* priorities = nullptr)
+        {
+            std::vector<llvm::Function*> result;
+            auto array = module.getNamedGlobal(arrayName);
+            if (array == nullptr || !array->hasInitializer())
+            {
+                return result;
+            }
+
+            auto entries = llvm::dyn_cast<llvm::ConstantArray>(array->getInitializer());
+            if (entries == nullptr)
+            {
+                return result;
+            }
+
+            for (auto& operand : entries->operands())
+            {
+                auto entry = llvm::dyn_cast<llvm::ConstantStruct>(operand);
+                if (entry == nullptr || entry->getNumOperands() < 2)
+                {
+                    continue;
+                }
+
+                auto priority = llvm::dyn_cast<llvm::ConstantInt>(entry->getOperand(0));
+                auto function = llvm::dyn_cast<llvm::Function>(entry->getOperand(1)->stripPointerCasts());
+                if (priority != nullptr && function != nullptr)
+                {
+                    result.push_back(function);
+                    if (priorities != nullptr)
+                    {
+                        priorities->push_back(static_cast<int>(priority->getSExtValue()));
+                    }
+                }
+            }
+            return result;
+        }
+
+        std::vector<IRObjectCache::Initializer> GetInitializers(const llvm::Module& module, const std::string& arrayName)
+        {
+            std::vector<int> priorities;
+            auto functions = GetInitializerFunctions(module, arrayName, &priorities);
+            std::vector<IRObjectCache::Initializer> result;
+            for (size_t index = 0; index < functions.size(); ++index)
+            {
+                result.push_back({ functions[index]->getName().str(), priorities[index] });
+            }
+            return result;
+        }
+
+        // Writes a file by writing a temporary file and renaming it, so other processes never see a partially-written file
+        void WriteFileAtomically(const std::string& path, const char* data, size_t size)
+        {
+            auto tempPath = path + ".tmp" + std::to_string(std::random_device{}());
+            {
+                auto stream = utilities::OpenBinaryOfstream(tempPath);
+                stream.write(data, size);
+            }
+
+            std::error_code ec;
+            fs::rename(fs::u8path(tempPath), fs::u8path(path), ec);
+            if (ec)
+            {
+                fs::remove(fs::u8path(tempPath), ec);
+            }
+        }
+    } // namespace
+
+    IRObjectCache::IRObjectCache(const std::string& directory, uint64_t maxSize) :
+        _directory(directory),
+        _maxSize(maxSize)
+    {
+        if (directory.empty())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Object cache directory must not be empty");
+        }
+        utilities::EnsureDirectoryExists(_directory);
+    }
+
+    std::string IRObjectCache::GetKey(const std::string& description)
+    {
+        // Two differently-seeded hashes and the length, so accidental collisions are vanishingly unlikely
+        std::stringstream key;
+        key << std::hex << std::setfill('0')
+            << std::setw(16) << Hash(description, 14695981039346656037ull)
+            << std::setw(16) << Hash(description, 0x9e3779b97f4a7c15ull)
+            << std::setw(8) << description.size();
+        return key.str();
+    }
+
+    bool IRObjectCache::TryLoad(const std::string& key, CachedObject& object)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto objectPath = GetObjectPath(key);
+        auto initializersPath = GetInitializersPath(key);
+        auto buffer = llvm::MemoryBuffer::getFile(objectPath);
+        if (!buffer || !utilities::FileExists(initializersPath))
+        {
+            ++_numMisses;
+            return false;
+        }
+
+        CachedObject result;
+        auto stream = utilities::OpenIfstream(initializersPath);
+        std::string kind;
+        Initializer initializer;
+        while (stream >> kind >> initializer.priority >> initializer.functionName)
+        {
+            (kind == "dtor" ? result.destructors : result.constructors).push_back(initializer);
+        }
+
+        // Mark the object as recently used, so eviction removes older objects first
+        std::error_code ec;
+        fs::last_write_time(fs::u8path(objectPath), fs::file_time_type::clock::now(), ec);
+
+        _loadedObjects[key] = std::move(*buffer);
+        ++_numHits;
+        object = std::move(result);
+        Log() << "Loaded object " << key << " from cache" << EOL;
+        return true;
+    }
+
+    void IRObjectCache::PrepareModule(llvm::Module& module, const std::string& key)
+    {
+        module.setModuleIdentifier(key);
+        for (auto arrayName : { "llvm.global_ctors", "llvm.global_dtors" })
+        {
+            for (auto function : GetInitializerFunctions(module, arrayName))
+            {
+                function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+    }
+
+    uint64_t IRObjectCache::GetNumHits() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numHits;
+    }
+
+    uint64_t IRObjectCache::GetNumMisses() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numMisses;
+    }
+
+    uint64_t IRObjectCache::GetSize() const
+    {
+        uint64_t size = 0;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(fs::u8path(_directory), ec))
+        {
+            if (entry.path().extension() == c_objectExtension)
+            {
+                size += entry.file_size(ec);
+            }
+        }
+        return size;
+    }
+
+    void IRObjectCache::notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef object)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const auto& key = module->getModuleIdentifier();
+        std::stringstream initializers;
+        for (const auto& constructor : GetInitializers(*module, "llvm.global_ctors"))
+        {
+            initializers << "ctor " << constructor.priority << " " << constructor.functionName << "\n";
+        }
+        for (const auto& destructor : GetInitializers(*module, "llvm.global_dtors"))
+        {
+            initializers << "dtor " << destructor.priority << " " << destructor.functionName << "\n";
+        }
+
+        // Write the initializers last: an entry only counts as present once both files exist
+        auto initializersString = initializers.str();
+        WriteFileAtomically(GetObjectPath(key), object.getBufferStart(), object.getBufferSize());
+        WriteFileAtomically(GetInitializersPath(key), initializersString.data(), initializersString.size());
+        Log() << "Stored object " << key << " in cache" << EOL;
+
+        EvictToMaxSize();
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> IRObjectCache::getObject(const llvm::Module* module)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _loadedObjects.find(module->getModuleIdentifier());
+        if (it == _loadedObjects.end())
+        {
+            return nullptr;
+        }
+
+        auto buffer = std::move(it->second);
+        _loadedObjects.erase(it);
+        return buffer;
+    }
+
+    std::string IRObjectCache::GetObjectPath(const std::string& key) const
+    {
+        return utilities::JoinPaths(_directory, key + c_objectExtension);
+    }
+
+    std::string IRObjectCache::GetInitializersPath(const std::string& key) const
+    {
+        return utilities::JoinPaths(_directory, key + c_initializersExtension);
+    }
+
+    void IRObjectCache::EvictToMaxSize()
+    {
+        struct Entry
+        {
+            fs::path path;
+            uint64_t size;
+            fs::file_time_type lastUsed;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(fs::u8path(_directory), ec))
+        {
+            if (entry.path().extension() != c_objectExtension)
+            {
+                continue;
+            }
+            auto size = entry.file_size(ec);
+            entries.push_back({ entry.path(), size, entry.last_write_time(ec) });
+            totalSize += size;
+        }
+
+        // Remove the least recently used objects first, but always keep the most recent one
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+        for (size_t index = 0; index + 1 < entries.size() && totalSize > _maxSize; ++index)
+        {
+            auto initializersPath = entries[index].path;
+            initializersPath.replace_extension(c_initializersExtension);
+            fs::remove(initializersPath, ec);
+            fs::remove(entries[index].path, ec);
+            totalSize -= entries[index].size;
+            Log() << "Evicted object " << entries[index].path.stem().string() << " from cache" << EOL;
+        }
+    }
+} // namespace emitters
+} // namespace ell
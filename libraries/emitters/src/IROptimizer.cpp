@@ -7,29 +7,174 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "IROptimizer.h"
+#include "EmitterException.h"
+#include "IRMetadata.h"
 #include "IRModuleEmitter.h"
 #include "LLVMInclude.h"
 
+#include <utilities/include/Logger.h>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/GVN.h>
 
+#include <algorithm>
+#include <exception>
 #include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ell
 {
 namespace emitters
 {
     using namespace llvm;
+    using namespace logging;
+
+    namespace
+    {
+        // Node functions smaller than this (in instructions) are inlined into their callers, in their callers' partitions.
+        // Larger ones do enough work that the call doesn't matter, so they're optimized on their own.
+        const size_t c_minNodeFunctionUnitSize = 1000;
+
+        size_t GetFunctionSize(const llvm::Function& function)
+        {
+            size_t size = 0;
+            for (const auto& block : function)
+            {
+                size += block.size();
+            }
+            return size;
+        }
+
+        // A function that gets optimized in exactly one partition. The others are module-local helpers that get
+        // copied into every partition that calls them.
+        bool IsPartitionUnit(const llvm::Function& function)
+        {
+            if (function.isDeclaration())
+            {
+                return false;
+            }
+
+            if (!function.hasLocalLinkage())
+            {
+                return true;
+            }
+
+            if (function.getMetadata(c_nodeFunctionTagName) != nullptr && GetFunctionSize(function) >= c_minNodeFunctionUnitSize)
+            {
+                return true;
+            }
+
+            for (auto user : function.users())
+            {
+                if (!llvm::isa<llvm::Instruction>(user))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Adds a function and the helper functions it calls (transitively) to a partition's definitions
+        void AddPartitionDefinitions(llvm::Function& function, std::unordered_set<const llvm::GlobalValue*>& definitions)
+        {
+            std::vector<llvm::Function*> pending = { &function };
+            definitions.insert(&function);
+            while (!pending.empty())
+            {
+                auto current = pending.back();
+                pending.pop_back();
+                for (auto global : GetReferencedGlobalValues(*current))
+                {
+                    auto helper = llvm::dyn_cast<llvm::Function>(global);
+                    if (helper != nullptr && !helper->isDeclaration() && !IsPartitionUnit(*helper) && definitions.insert(helper).second)
+                    {
+                        pending.push_back(helper);
+                    }
+                }
+            }
+        }
+
+        // LLVM contexts can't be shared between threads, so modules move between them as bitcode
+        std::string WriteBitcode(const llvm::Module& module)
+        {
+            std::string bitcode;
+            llvm::raw_string_ostream stream(bitcode);
+            llvm::WriteBitcodeToFile(&module, stream);
+            stream.flush();
+            return bitcode;
+        }
+
+        std::unique_ptr<llvm::Module> ReadBitcode(const std::string& bitcode, llvm::LLVMContext& context)
+        {
+            auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "partition"), context);
+            if (!module)
+            {
+                throw EmitterException(EmitterError::unexpected, "Unable to read partition of module: " + llvm::toString(module.takeError()));
+            }
+            return std::move(module.get());
+        }
+
+        std::string CreatePartition(const llvm::Module& module, const std::unordered_set<const llvm::GlobalValue*>& definitions)
+        {
+            // Global variables stay in the original module, so every partition only declares them
+            llvm::ValueToValueMapTy valueMap;
+            auto partition = llvm::CloneModule(&module, valueMap, [&definitions](const llvm::GlobalValue* global) { return definitions.count(global) != 0; });
+
+            std::vector<llvm::NamedMDNode*> namedMetadata;
+            for (auto& metadata : partition->named_metadata())
+            {
+                if (metadata.getName() != "llvm.module.flags")
+                {
+                    namedMetadata.push_back(&metadata);
+                }
+            }
+            for (auto metadata : namedMetadata)
+            {
+                partition->eraseNamedMetadata(metadata);
+            }
+
+            // Let the optimizer see the values of the constants the partition uses. The copies are dropped when
+            // the partition is linked back into the module that defines them.
+            for (const auto& global : module.globals())
+            {
+                auto declaration = llvm::cast<llvm::GlobalVariable>(valueMap[&global]);
+                if (global.isConstant() && global.hasInitializer() && !global.isInterposable() && !global.hasAppendingLinkage() && !declaration->use_empty())
+                {
+                    declaration->setInitializer(llvm::MapValue(global.getInitializer(), valueMap));
+                    declaration->setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+                }
+            }
+
+            RemoveUnusedDeclarations(*partition);
+            return WriteBitcode(*partition);
+        }
+    } // namespace
+
 
     IROptimizer::IROptimizer(IRModuleEmitter& module) :
-        _module(module),
+        _module(&module),
         _functionPasses(module.GetLLVMModule())
     {
     }
 
+    IROptimizer::IROptimizer(llvm::Module& module) :
+        _functionPasses(&module)
+    {
+    }
+
     IROptimizer::~IROptimizer()
     {
         (void)_functionPasses.doFinalization();
@@ -39,7 +184,7 @@ namespace emitters
     {
         _functionPasses.add(llvm::createVerifierPass());
 
-        auto targetMachine = _module.GetTargetMachine();
+        auto targetMachine = _module != nullptr ? _module->GetTargetMachine() : nullptr;
         llvm::PassManagerBuilder builder;
         builder.OptLevel = 3;
         builder.SizeLevel = 0;
@@ -67,5 +212,156 @@ namespace emitters
     {
         _modulePasses.run(*pModule);
     }
+
+    void OptimizeModule(llvm::Module& module)
+    {
+        IROptimizer optimizer(module);
+        optimizer.AddStandardPasses();
+        for (auto& function : module)
+        {
+            optimizer.OptimizeFunction(&function);
+        }
+        optimizer.OptimizeModule(&module);
+    }
+
+    int OptimizeModuleInParallel(llvm::Module& module, int numThreads)
+    {
+        std::vector<llvm::Function*> units;
+        for (auto& function : module)
+        {
+            if (IsPartitionUnit(function))
+            {
+                units.push_back(&function);
+            }
+        }
+
+        // Aliases and debug info would have to be kept consistent across the partitions
+        bool canSplit = module.alias_empty() && module.ifunc_empty() && module.getNamedMetadata("llvm.dbg.cu") == nullptr;
+        auto numPartitions = std::min(numThreads, static_cast<int>(units.size()));
+        if (!canSplit || numPartitions < 2)
+        {
+            OptimizeModule(module);
+            return 1;
+        }
+
+        // Give the largest functions out first, each to the partition with the least code so far
+        std::vector<std::pair<size_t, llvm::Function*>> unitSizes;
+        for (auto unit : units)
+        {
+            unitSizes.emplace_back(GetFunctionSize(*unit), unit);
+        }
+        std::stable_sort(unitSizes.begin(), unitSizes.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        std::vector<std::unordered_set<const llvm::GlobalValue*>> partitionDefinitions(numPartitions);
+        std::vector<size_t> partitionSizes(numPartitions, 0);
+        for (const auto& unitSize : unitSizes)
+        {
+            auto partition = std::min_element(partitionSizes.begin(), partitionSizes.end()) - partitionSizes.begin();
+            partitionSizes[partition] += unitSize.first;
+            AddPartitionDefinitions(*unitSize.second, partitionDefinitions[partition]);
+        }
+
+        // The partitions refer to each other's functions and to the module's variables by name, so those names have
+        // to be visible outside their module until the partitions are linked back together
+        std::vector<std::pair<std::string, llvm::GlobalValue::LinkageTypes>> localLinkages;
+        auto Externalize = [&localLinkages](llvm::GlobalValue& global) {
+            if (global.hasLocalLinkage())
+            {
+                if (!global.hasName())
+                {
+                    global.setName("partition.global");
+                }
+                localLinkages.emplace_back(global.getName().str(), global.getLinkage());
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                global.setVisibility(llvm::GlobalValue::DefaultVisibility);
+            }
+        };
+        for (auto& global : module.globals())
+        {
+            Externalize(global);
+        }
+        for (auto unit : units)
+        {
+            Externalize(*unit);
+        }
+
+        std::vector<std::string> partitions;
+        for (const auto& definitions : partitionDefinitions)
+        {
+            partitions.push_back(CreatePartition(module, definitions));
+        }
+
+        std::vector<std::exception_ptr> exceptions(numPartitions);
+        std::vector<std::thread> threads;
+        for (int index = 0; index < numPartitions; ++index)
+        {
+            threads.emplace_back([&partitions, &exceptions, index] {
+                try
+                {
+                    llvm::LLVMContext context;
+                    auto partition = ReadBitcode(partitions[index], context);
+                    OptimizeModule(*partition);
+                    partitions[index] = WriteBitcode(*partition);
+                }
+                catch (...)
+                {
+                    exceptions[index] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (auto& exception : exceptions)
+        {
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // Replace the module's code with the optimized partitions
+        std::unordered_set<llvm::Function*> unitSet(units.begin(), units.end());
+        std::vector<llvm::Function*> helpers;
+        for (auto& function : module)
+        {
+            if (!function.isDeclaration())
+            {
+                if (unitSet.count(&function) == 0)
+                {
+                    helpers.push_back(&function);
+                }
+                function.deleteBody();
+            }
+        }
+        for (auto helper : helpers)
+        {
+            if (helper->use_empty())
+            {
+                helper->eraseFromParent();
+            }
+        }
+
+        for (const auto& bitcode : partitions)
+        {
+            if (llvm::Linker::linkModules(module, ReadBitcode(bitcode, module.getContext())))
+            {
+                throw EmitterException(EmitterError::unexpected, "Unable to link optimized partitions of module " + module.getModuleIdentifier());
+            }
+        }
+
+        for (const auto& localLinkage : localLinkages)
+        {
+            if (auto global = module.getNamedValue(localLinkage.first))
+            {
+                global->setLinkage(localLinkage.second);
+            }
+        }
+        Log() << "Optimized module in " << numPartitions << " partitions in parallel" << EOL;
+
+        // Note: only optimization runs in parallel. Code generation still compiles the whole module on one thread.
+        return numPartitions;
+    }
 } // namespace emitters
 } // namespace ell
@@ -9,10 +9,14 @@
 #include "IRRuntime.h"
 #include "IRFunctionEmitter.h"
 #include "IRMetadata.h"
+#include "IRMath.h"
 #include "IRModuleEmitter.h"
+#include "IRVectorUtilities.h"
 
 #include <utilities/include/Unused.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace emitters
@@ -65,11 +69,349 @@ namespace emitters
             return function.GetFunction();
         }
 
+        //
+        // Blocking parameters for the native GEMM implementation
+        //
+        // The native GEMM follows the usual packed-panel structure: C is processed in blocks of `nc` columns,
+        // the inner dimension in slices of depth `kc`, and A in blocks of `mc` rows. Each (kc x nc) block of B and
+        // (mc x kc) block of A is copied into a contiguous, zero-padded buffer on the stack, and a register-tiled
+        // micro-kernel computes an (mr x nr) tile of C from the packed panels. `nr` is the vector width, so each
+        // row of a tile lives in a single vector register.
+        //
+        // The packed buffers have to fit on the stack of whatever thread calls GEMM, which may be a thread pool
+        // worker or a microcontroller's only stack, so the blocks are shrunk until they fit in a per-target budget.
+        //
+        struct GEMMBlockSizes
+        {
+            int mr; // rows in a register tile
+            int nr; // columns in a register tile (the vector width)
+            int mc; // rows of A in a packed block
+            int kc; // depth of a packed block
+            int nc; // columns of B in a packed block
+        };
+
+        // Bare-metal targets (like the Cortex-M devices) typically have stacks of a few KB
+        size_t GetGEMMPackedBufferBudget(const TargetDevice& targetDevice)
+        {
+            const size_t hostedBudget = 64 * 1024;
+            const size_t bareMetalBudget = 4 * 1024;
+            return targetDevice.IsBareMetal() ? bareMetalBudget : hostedBudget;
+        }
+
+        GEMMBlockSizes GetGEMMBlockSizes(const CompilerOptions& options, size_t elementSize)
+        {
+            const int mr = 4;
+            const int nr = std::max(1, options.vectorWidth);
+            int kc = 128;
+            int mc = 16 * mr;
+            int nc = std::max(1, 128 / nr) * nr;
+
+            // Halve the largest block dimension until the packed blocks fit in the budget
+            const int minDepth = 8;
+            const auto maxElements = static_cast<int>(GetGEMMPackedBufferBudget(options.targetDevice) / elementSize);
+            auto packedSize = [&] { return (mc * kc + nr - 1) / nr * nr + kc * nc; };
+            while (packedSize() > maxElements)
+            {
+                if (nc > nr && nc >= kc && nc >= mc)
+                {
+                    nc = std::max(1, nc / (2 * nr)) * nr;
+                }
+                else if (kc > minDepth && kc >= mc)
+                {
+                    kc /= 2;
+                }
+                else if (mc > mr)
+                {
+                    mc = std::max(1, mc / (2 * mr)) * mr;
+                }
+                else
+                {
+                    break; // the smallest blocks are as small as the register tile
+                }
+            }
+            return { mr, nr, mc, kc, nc };
+        }
+
+        // Copy the (numRows x depth) block of op(A) starting at (rowBegin, depthBegin) into `packedA`, as a sequence of
+        // panels of `mr` rows. Within a panel, the `mr` values for each depth index are contiguous. Rows past the end
+        // of the block are filled with zero.
+        template <typename ValueType, bool transposeA>
+        void EmitPackA(IRFunctionEmitter& function, const GEMMBlockSizes& blockSizes, IRLocalArray A, IRLocalScalar lda, IRLocalScalar rowBegin, IRLocalScalar depthBegin, IRLocalScalar numRows, IRLocalScalar depth, IRLocalArray packedA)
+        {
+            const int mr = blockSizes.mr;
+            const int kc = blockSizes.kc;
+            auto numPanels = (numRows + (mr - 1)) / mr;
+            function.For(numPanels, [=](IRFunctionEmitter& function, IRLocalScalar panel) {
+                auto panelRowBegin = panel * mr;
+                auto panelRows = Min(numRows - panelRowBegin, function.LocalScalar<int>(mr));
+                auto panelOffset = panel * (kc * mr);
+                if (transposeA)
+                {
+                    // op(A)(i, p) = A[p * lda + i]: the rows of a panel are contiguous in memory
+                    function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                        auto aRowOffset = (depthBegin + p) * lda + rowBegin + panelRowBegin;
+                        function.For(panelRows, [=](IRFunctionEmitter& function, IRLocalScalar r) {
+                            packedA[panelOffset + p * mr + r] = static_cast<IRLocalScalar>(A[aRowOffset + r]);
+                        });
+                        function.For(panelRows, function.LocalScalar<int>(mr), function.LocalScalar<int>(1), [=](IRFunctionEmitter& function, IRLocalScalar r) {
+                            packedA[panelOffset + p * mr + r] = function.LocalScalar<ValueType>(0);
+                        });
+                    });
+                }
+                else
+                {
+                    // op(A)(i, p) = A[i * lda + p]: the depth index is contiguous in memory
+                    function.For(panelRows, [=](IRFunctionEmitter& function, IRLocalScalar r) {
+                        auto aRowOffset = (rowBegin + panelRowBegin + r) * lda + depthBegin;
+                        function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                            packedA[panelOffset + p * mr + r] = static_cast<IRLocalScalar>(A[aRowOffset + p]);
+                        });
+                    });
+                    function.For(panelRows, function.LocalScalar<int>(mr), function.LocalScalar<int>(1), [=](IRFunctionEmitter& function, IRLocalScalar r) {
+                        function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                            packedA[panelOffset + p * mr + r] = function.LocalScalar<ValueType>(0);
+                        });
+                    });
+                }
+            });
+        }
+
+        // Copy the (depth x numColumns) block of op(B) starting at (depthBegin, columnBegin) into `packedB`, as a
+        // sequence of panels of `nr` columns. Within a panel, the `nr` values for each depth index are contiguous.
+        // Columns past the end of the block are filled with zero.
+        template <typename ValueType, bool transposeB>
+        void EmitPackB(IRFunctionEmitter& function, const GEMMBlockSizes& blockSizes, IRLocalArray B, IRLocalScalar ldb, IRLocalScalar depthBegin, IRLocalScalar columnBegin, IRLocalScalar depth, IRLocalScalar numColumns, IRLocalArray packedB)
+        {
+            const int nr = blockSizes.nr;
+            const int kc = blockSizes.kc;
+            auto numPanels = (numColumns + (nr - 1)) / nr;
+            function.For(numPanels, [=](IRFunctionEmitter& function, IRLocalScalar panel) {
+                auto panelColumnBegin = panel * nr;
+                auto panelColumns = Min(numColumns - panelColumnBegin, function.LocalScalar<int>(nr));
+                auto panelOffset = panel * (kc * nr);
+                if (transposeB)
+                {
+                    // op(B)(p, j) = B[j * ldb + p]: the depth index is contiguous in memory
+                    function.For(panelColumns, [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                        auto bColumnOffset = (columnBegin + panelColumnBegin + c) * ldb + depthBegin;
+                        function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                            packedB[panelOffset + p * nr + c] = static_cast<IRLocalScalar>(B[bColumnOffset + p]);
+                        });
+                    });
+                    function.For(panelColumns, function.LocalScalar<int>(nr), function.LocalScalar<int>(1), [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                        function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                            packedB[panelOffset + p * nr + c] = function.LocalScalar<ValueType>(0);
+                        });
+                    });
+                }
+                else
+                {
+                    // op(B)(p, j) = B[p * ldb + j]: the columns of a panel are contiguous in memory
+                    function.For(depth, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                        auto bRowOffset = (depthBegin + p) * ldb + columnBegin + panelColumnBegin;
+                        function.For(panelColumns, [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                            packedB[panelOffset + p * nr + c] = static_cast<IRLocalScalar>(B[bRowOffset + c]);
+                        });
+                        function.For(panelColumns, function.LocalScalar<int>(nr), function.LocalScalar<int>(1), [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                            packedB[panelOffset + p * nr + c] = function.LocalScalar<ValueType>(0);
+                        });
+                    });
+                }
+            });
+        }
+
+        // Compute C[0:numRows, 0:numColumns] += alpha * (packed A panel) * (packed B panel), where the panels have
+        // the given depth. The full (mr x nr) tile is accumulated in vector registers and only the valid part is
+        // written back to C. If there's an epilogue, it's applied to the values written for the last depth block,
+        // given the row and column of C the tile starts at.
+        template <typename ValueType>
+        void EmitGEMMMicroKernel(IRFunctionEmitter& function, const GEMMBlockSizes& blockSizes, IRLocalScalar depth, IRLocalScalar alpha, LLVMValue packedAPanel, LLVMValue packedBPanel, IRLocalArray C, IRLocalScalar tileRow, IRLocalScalar tileColumn, IRLocalScalar ldc, IRLocalScalar numRows, IRLocalScalar numColumns, IRLocalScalar isLastDepthBlock, const GEMMEpilogueFunction* epilogue)
+        {
+            const int mr = blockSizes.mr;
+            const int nr = blockSizes.nr;
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto vectorType = function.GetEmitter().VectorType(GetVariableType<ValueType>(), nr);
+            auto packedBVector = function.CastPointer(packedBPanel, vectorType->getPointerTo());
+            auto packedA = function.LocalArray(packedAPanel);
+
+            std::vector<LLVMValue> accumulators;
+            for (int r = 0; r < mr; ++r)
+            {
+                auto accum = function.Variable(vectorType, "gemmAccum");
+                function.Store(accum, FillVector<ValueType>(function, vectorType, 0));
+                accumulators.push_back(accum);
+            }
+
+            function.For(depth, [=, &irBuilder](IRFunctionEmitter& function, IRLocalScalar p) {
+                auto bValue = function.ValueAt(packedBVector, p);
+                for (int r = 0; r < mr; ++r)
+                {
+                    LLVMValue aValue = static_cast<IRLocalScalar>(packedA[p * mr + r]);
+                    auto aVector = irBuilder.CreateVectorSplat(nr, aValue);
+                    auto product = function.Operator(GetMultiplyForValueType<ValueType>(), aVector, bValue);
+                    function.OperationAndUpdate(accumulators[r], GetAddForValueType<ValueType>(), product);
+                }
+            });
+
+            // Spill the scaled tile to the stack, then add the valid part of it into C
+            auto tile = function.Variable(vectorType, mr);
+            auto alphaVector = irBuilder.CreateVectorSplat(nr, alpha);
+            for (int r = 0; r < mr; ++r)
+            {
+                auto scaledRow = function.Operator(GetMultiplyForValueType<ValueType>(), function.Load(accumulators[r]), alphaVector);
+                function.SetValueAt(tile, r, scaledRow);
+            }
+            auto tileValues = function.LocalArray(function.CastPointer(tile, GetPointerType(GetVariableType<ValueType>())));
+            auto cOffset = (tileRow * ldc) + tileColumn;
+
+            auto emitStores = [=](IRFunctionEmitter& function, bool applyEpilogue) {
+                auto store = [=](IRFunctionEmitter& function, IRLocalScalar r, IRLocalScalar c, IRLocalScalar tileIndex) {
+                    auto cIndex = cOffset + (r * ldc) + c;
+                    auto value = static_cast<IRLocalScalar>(C[cIndex]) + tileValues[tileIndex];
+                    C[cIndex] = applyEpilogue ? (*epilogue)(function, value, tileRow + r, tileColumn + c) : value;
+                };
+
+                function.If((numRows == mr) && (numColumns == nr), [=](IRFunctionEmitter& function) {
+                    for (int r = 0; r < mr; ++r)
+                    {
+                        for (int c = 0; c < nr; ++c)
+                        {
+                            store(function, function.LocalScalar<int>(r), function.LocalScalar<int>(c), function.LocalScalar<int>(r * nr + c));
+                        }
+                    }
+                })
+                    .Else([=](IRFunctionEmitter& function) {
+                        function.For(numRows, [=](IRFunctionEmitter& function, IRLocalScalar r) {
+                            function.For(numColumns, [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                                store(function, r, c, (r * nr) + c);
+                            });
+                        });
+                    });
+            };
+
+            if (epilogue != nullptr)
+            {
+                function.If(isLastDepthBlock, [=](IRFunctionEmitter& function) {
+                    emitStores(function, true);
+                })
+                    .Else([=](IRFunctionEmitter& function) {
+                        emitStores(function, false);
+                    });
+            }
+            else
+            {
+                emitStores(function, false);
+            }
+        }
+
+        // Emits C += alpha * op(A) * op(B) into the current function, for one combination of transpose flags. If there's
+        // an epilogue, the micro-kernel applies it to each entry of C as it stores the entry's last depth block.
+        template <typename ValueType, bool transposeA, bool transposeB>
+        void EmitGEMMKernel(IRFunctionEmitter& function, IRLocalScalar m, IRLocalScalar n, IRLocalScalar k, IRLocalScalar alpha, IRLocalArray A, IRLocalScalar lda, IRLocalArray B, IRLocalScalar ldb, IRLocalArray C, IRLocalScalar ldc, const GEMMEpilogueFunction* epilogue)
+        {
+            const auto blockSizes = GetGEMMBlockSizes(function.GetModule().GetCompilerOptions(), sizeof(ValueType));
+            const int mr = blockSizes.mr;
+            const int nr = blockSizes.nr;
+            const int mc = blockSizes.mc;
+            const int kc = blockSizes.kc;
+            const int nc = blockSizes.nc;
+
+            // Packed buffers are allocated as arrays of vectors so the micro-kernel can use aligned vector loads
+            const auto valueType = GetVariableType<ValueType>();
+            const auto valuePointerType = GetPointerType(valueType);
+            auto vectorType = function.GetEmitter().VectorType(valueType, nr);
+            auto packedAStorage = function.Variable(vectorType, (mc * kc + nr - 1) / nr);
+            auto packedBStorage = function.Variable(vectorType, kc * nc / nr);
+            auto packedA = function.LocalArray(function.CastPointer(packedAStorage, valuePointerType));
+            auto packedB = function.LocalArray(function.CastPointer(packedBStorage, valuePointerType));
+
+            auto ncLiteral = function.LocalScalar<int>(nc);
+            auto kcLiteral = function.LocalScalar<int>(kc);
+            auto mcLiteral = function.LocalScalar<int>(mc);
+
+            function.For(function.LocalScalar<int>(0), n, ncLiteral, [=](IRFunctionEmitter& function, IRLocalScalar columnBlockBegin) {
+                auto numBlockColumns = Min(n - columnBlockBegin, ncLiteral);
+                function.For(function.LocalScalar<int>(0), k, kcLiteral, [=](IRFunctionEmitter& function, IRLocalScalar depthBlockBegin) {
+                    auto blockDepth = Min(k - depthBlockBegin, kcLiteral);
+                    auto isLastDepthBlock = (depthBlockBegin + kc) >= k;
+                    EmitPackB<ValueType, transposeB>(function, blockSizes, B, ldb, depthBlockBegin, columnBlockBegin, blockDepth, numBlockColumns, packedB);
+
+                    function.For(function.LocalScalar<int>(0), m, mcLiteral, [=](IRFunctionEmitter& function, IRLocalScalar rowBlockBegin) {
+                        auto numBlockRows = Min(m - rowBlockBegin, mcLiteral);
+                        EmitPackA<ValueType, transposeA>(function, blockSizes, A, lda, rowBlockBegin, depthBlockBegin, numBlockRows, blockDepth, packedA);
+
+                        auto numColumnPanels = (numBlockColumns + (nr - 1)) / nr;
+                        auto numRowPanels = (numBlockRows + (mr - 1)) / mr;
+                        function.For(numColumnPanels, [=](IRFunctionEmitter& function, IRLocalScalar columnPanel) {
+                            auto panelColumnBegin = columnPanel * nr;
+                            auto numPanelColumns = Min(numBlockColumns - panelColumnBegin, function.LocalScalar<int>(nr));
+                            auto packedBPanel = function.PointerOffset(packedB, columnPanel * (kc * nr));
+                            function.For(numRowPanels, [=](IRFunctionEmitter& function, IRLocalScalar rowPanel) {
+                                auto panelRowBegin = rowPanel * mr;
+                                auto numPanelRows = Min(numBlockRows - panelRowBegin, function.LocalScalar<int>(mr));
+                                auto packedAPanel = function.PointerOffset(packedA, rowPanel * (kc * mr));
+                                EmitGEMMMicroKernel<ValueType>(function, blockSizes, blockDepth, alpha, packedAPanel, packedBPanel, C, rowBlockBegin + panelRowBegin, columnBlockBegin + panelColumnBegin, ldc, numPanelRows, numPanelColumns, isLastDepthBlock, epilogue);
+                            });
+                        });
+                    });
+                });
+            });
+        }
+
+        // Emits a function computing C += alpha * op(A) * op(B) for one combination of transpose flags
+        template <typename ValueType, bool transposeA, bool transposeB>
+        LLVMFunction EmitGEMMKernelFunction(IRModuleEmitter& module, const std::string& functionName)
+        {
+            const auto valueType = GetVariableType<ValueType>();
+            const auto valuePointerType = GetPointerType(valueType);
+            NamedVariableTypeList argTypes = {
+                { "m", VariableType::Int32 },
+                { "n", VariableType::Int32 },
+                { "k", VariableType::Int32 },
+                { "alpha", valueType },
+                { "A", valuePointerType },
+                { "lda", VariableType::Int32 },
+                { "B", valuePointerType },
+                { "ldb", VariableType::Int32 },
+                { "C", valuePointerType },
+                { "ldc", VariableType::Int32 }
+            };
+
+            auto function = module.BeginFunction(functionName, VariableType::Void, argTypes);
+            function.SetAttributeForArguments({ 4, 6, 8 }, IRFunctionEmitter::Attributes::NoAlias);
+
+            auto arguments = function.Arguments().begin();
+            auto m = function.LocalScalar(&(*arguments++)); // 0
+            auto n = function.LocalScalar(&(*arguments++)); // 1
+            auto k = function.LocalScalar(&(*arguments++)); // 2
+            auto alpha = function.LocalScalar(&(*arguments++)); // 3
+            auto A = function.LocalArray(&(*arguments++)); // 4
+            auto lda = function.LocalScalar(&(*arguments++)); // 5
+            auto B = function.LocalArray(&(*arguments++)); // 6
+            auto ldb = function.LocalScalar(&(*arguments++)); // 7
+            auto C = function.LocalArray(&(*arguments++)); // 8
+            auto ldc = function.LocalScalar(&(*arguments++)); // 9
+
+            EmitGEMMKernel<ValueType, transposeA, transposeB>(function, m, n, k, alpha, A, lda, B, ldb, C, ldc, nullptr);
+
+            function.Return();
+            module.EndFunction();
+            return function.GetFunction();
+        }
+
         template <typename ValueType>
         LLVMFunction EmitGEMMFunction(IRModuleEmitter& module, const std::string& functionName, const NamedVariableTypeList& argTypes)
         {
             const auto CblasNoTrans = 111;
             const auto CblasTrans = 112;
+            UNUSED(CblasNoTrans);
+
+            // One specialized kernel per combination of transpose flags, so the packing loops read memory contiguously
+            // and no transpose checks remain inside the loops
+            auto kernelNN = EmitGEMMKernelFunction<ValueType, false, false>(module, functionName + "_nn");
+            auto kernelNT = EmitGEMMKernelFunction<ValueType, false, true>(module, functionName + "_nt");
+            auto kernelTN = EmitGEMMKernelFunction<ValueType, true, false>(module, functionName + "_tn");
+            auto kernelTT = EmitGEMMKernelFunction<ValueType, true, true>(module, functionName + "_tt");
 
             auto function = module.BeginFunction(functionName, VariableType::Int32, argTypes);
             function.SetAttributeForArguments({ 7, 9, 12 }, IRFunctionEmitter::Attributes::NoAlias);
@@ -89,36 +431,39 @@ namespace emitters
             auto beta = function.LocalScalar(&(*arguments++)); // 11
             auto C = function.LocalArray(&(*arguments++)); // 12
             auto ldc = function.LocalScalar(&(*arguments++)); // 13
-            UNUSED(CblasNoTrans, order, alpha, beta);
-
-            // C = A x B, A: mxk, B: kxn, C: mxn
-            // A': kxm, B': nxk
-
-            // Loop orders:
-            // A*B:   i, k, j
-            // A'*B:  k, i, j
-            // A*B':  i, j, k
-            // A'*B': k, j, i (?)
-
-            // Clear output
-            auto count = ldc * m;
-            function.MemorySet<ValueType>(C, function.Literal<int>(0), function.Literal<uint8_t>(0), count);
-
-            // Accumulate partial values into output
-            function.For(m, [A, B, C, lda, ldb, ldc, transposeA, transposeB, n, k](IRFunctionEmitter& function, auto i) {
-                function.For(k, [i, A, B, C, lda, ldb, ldc, transposeA, transposeB, n](IRFunctionEmitter& function, auto k) {
-                    function.For(n, [i, k, A, B, C, lda, ldb, ldc, transposeA, transposeB](IRFunctionEmitter& function, auto j) {
-                        auto aOffset = function.LocalScalar(function.Select(transposeA, (k * lda) + i, (i * lda) + k));
-                        auto bOffset = function.LocalScalar(function.Select(transposeB, (j * ldb) + k, (k * ldb) + j));
-                        auto cOffset = (i * ldc) + j;
-
-                        // accumulate product in C[i, j]
-                        C[cOffset] = C[cOffset] + (A[aOffset] * B[bOffset]);
+            UNUSED(order);
+
+            // C = beta * C
+            function.If(beta == static_cast<ValueType>(0), [=](IRFunctionEmitter& function) {
+                function.For(m, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+                    function.MemorySet<ValueType>(C, i * ldc, function.Literal<uint8_t>(0), n);
+                });
+            })
+                .ElseIf(beta != static_cast<ValueType>(1), [=](IRFunctionEmitter& function) {
+                    function.For(m, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+                        function.For(n, [=](IRFunctionEmitter& function, IRLocalScalar j) {
+                            auto cIndex = (i * ldc) + j;
+                            C[cIndex] = static_cast<IRLocalScalar>(C[cIndex]) * beta;
+                        });
                     });
                 });
-            });
-            function.Return(function.Literal<int>(0));
 
+            // C += alpha * op(A) * op(B)
+            IRValueList kernelArgs = { m, n, k, alpha, A, lda, B, ldb, C, ldc };
+            function.If(transposeA && transposeB, [=](IRFunctionEmitter& function) {
+                function.Call(kernelTT, kernelArgs);
+            })
+                .ElseIf(transposeA, [=](IRFunctionEmitter& function) {
+                    function.Call(kernelTN, kernelArgs);
+                })
+                .ElseIf(transposeB, [=](IRFunctionEmitter& function) {
+                    function.Call(kernelNT, kernelArgs);
+                })
+                .Else([=](IRFunctionEmitter& function) {
+                    function.Call(kernelNN, kernelArgs);
+                });
+
+            function.Return(function.Literal<int>(0));
             module.EndFunction();
             return function.GetFunction();
         }
@@ -694,6 +1039,50 @@ namespace emitters
         return GetDGEMMFunction(useBlas);
     }
 
+    template <typename ValueType>
+    void IRRuntime::EmitGEMM(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc, const GEMMEpilogueFunction& epilogue)
+    {
+        auto CArray = function.LocalArray(C);
+        function.For(m, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+            function.MemorySet<ValueType>(CArray, i * ldc, function.Literal<uint8_t>(0), n);
+        });
+
+        // With nothing to multiply, the micro-kernel never runs, so the epilogue is applied to the zeros directly
+        if (k == 0)
+        {
+            function.For(m, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+                function.For(n, [=](IRFunctionEmitter& function, IRLocalScalar j) {
+                    auto cIndex = (i * ldc) + j;
+                    CArray[cIndex] = epilogue(function, static_cast<IRLocalScalar>(CArray[cIndex]), i, j);
+                });
+            });
+            return;
+        }
+
+        auto emitKernel = [&](auto kernel) {
+            kernel(function, function.LocalScalar<int>(m), function.LocalScalar<int>(n), function.LocalScalar<int>(k), function.LocalScalar<ValueType>(1), function.LocalArray(A), function.LocalScalar<int>(lda), function.LocalArray(B), function.LocalScalar<int>(ldb), CArray, function.LocalScalar<int>(ldc), &epilogue);
+        };
+        if (transposeA && transposeB)
+        {
+            emitKernel(EmitGEMMKernel<ValueType, true, true>);
+        }
+        else if (transposeA)
+        {
+            emitKernel(EmitGEMMKernel<ValueType, true, false>);
+        }
+        else if (transposeB)
+        {
+            emitKernel(EmitGEMMKernel<ValueType, false, true>);
+        }
+        else
+        {
+            emitKernel(EmitGEMMKernel<ValueType, false, false>);
+        }
+    }
+
+    template void IRRuntime::EmitGEMM<float>(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc, const GEMMEpilogueFunction& epilogue);
+    template void IRRuntime::EmitGEMM<double>(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc, const GEMMEpilogueFunction& epilogue);
+
     LLVMFunction IRRuntime::GetOpenBLASGetNumThreadsFunction()
     {
         // int openblas_get_num_threads();
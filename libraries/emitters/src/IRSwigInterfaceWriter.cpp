@@ -50,7 +50,6 @@ namespace emitters
                 );
                 // clang-format on
 
-                auto resetFunctionName = _moduleName + "_Reset";
                 std::string predictMethodName = TrimPrefix(_functionName, _moduleName + "_");
                 predictMethodName[0] = ::toupper(predictMethodName[0]); // pascal case
 
@@ -62,7 +61,20 @@ namespace emitters
                 ReplaceDelimiter(predictPythonCode, "WRAPPER_CLASS", className);
                 ReplaceDelimiter(predictPythonCode, "PREDICT_METHOD", predictMethodName);
                 ReplaceDelimiter(predictPythonCode, "INPUT_VECTOR_TYPE", inputVectorType);
-                ReplaceDelimiter(predictPythonCode, "RESET_FUNCTION", resetFunctionName);
+
+                if (_hasPredictBatch)
+                {
+                    // clang-format off
+                    std::string predictBatchPythonCode(
+                        #include "SwigPredictBatchPython.in"
+                    );
+                    // clang-format on
+
+                    ReplaceDelimiter(predictBatchPythonCode, "WRAPPER_CLASS", className);
+                    ReplaceDelimiter(predictBatchPythonCode, "PREDICT_METHOD", predictMethodName);
+                    ReplaceDelimiter(predictBatchPythonCode, "INPUT_VECTOR_TYPE", inputVectorType);
+                    predictPythonCode += predictBatchPythonCode;
+                }
 
                 os << "%pythoncode %{\n"
                    << predictPythonCode
@@ -78,6 +90,8 @@ namespace emitters
 
                 _functionName = _function->getName();
 
+                _hasPredictBatch = moduleCallbacks.sources.empty() && moduleEmitter.GetLLVMModule()->getFunction(_functionName + "Batch") != nullptr;
+
                 if (moduleCallbacks.sources.empty())
                 {
                     // Three arguments context, input, output (input may be a scalar or pointer)
@@ -115,6 +129,7 @@ namespace emitters
             std::string _functionName;
             std::string _inputType;
             bool _inputIsScalar;
+            bool _hasPredictBatch = false;
             LLVMFunction _function;
         };
 
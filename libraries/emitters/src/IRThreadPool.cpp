@@ -17,12 +17,69 @@
 #include <utilities/include/Exception.h>
 #include <utilities/include/Unused.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace ell
 {
 namespace emitters
 {
+    namespace
+    {
+        // Number of unsuccessful passes over the task deques an idle thread makes before it parks on a condition variable
+        const int c_spinCountBeforePark = 1024;
+
+        // Each deque is padded out to its own cache line so workers claiming tasks don't invalidate each other's deques
+        const int c_cacheLineSize = 64;
+
+        const auto c_atomicOrdering = llvm::AtomicOrdering::SequentiallyConsistent;
+
+        unsigned GetAtomicAlignment(IRFunctionEmitter& function, LLVMType type)
+        {
+            return static_cast<unsigned>(function.GetModule().GetTargetDataLayout().getTypeAllocSize(type));
+        }
+
+        LLVMValue AtomicLoad(IRFunctionEmitter& function, LLVMValue pointer)
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto load = irBuilder.CreateLoad(pointer);
+            load->setAtomic(c_atomicOrdering);
+            load->setAlignment(GetAtomicAlignment(function, load->getType()));
+            return load;
+        }
+
+        void AtomicStore(IRFunctionEmitter& function, LLVMValue pointer, LLVMValue value)
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto store = irBuilder.CreateStore(value, pointer);
+            store->setAtomic(c_atomicOrdering);
+            store->setAlignment(GetAtomicAlignment(function, value->getType()));
+        }
+
+        // Returns the value stored at `pointer` before the add
+        LLVMValue AtomicFetchAdd(IRFunctionEmitter& function, LLVMValue pointer, LLVMValue value)
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            return irBuilder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, pointer, value, c_atomicOrdering);
+        }
+
+        // Returns `true` if the value stored at `pointer` was `expected` and has been replaced with `desired`
+        LLVMValue AtomicCompareExchange(IRFunctionEmitter& function, LLVMValue pointer, LLVMValue expected, LLVMValue desired)
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto result = irBuilder.CreateAtomicCmpXchg(pointer, expected, desired, c_atomicOrdering, c_atomicOrdering);
+            return irBuilder.CreateExtractValue(result, { 1 });
+        }
+
+        LLVMValue PackTaskRange(IRFunctionEmitter& function, LLVMValue head, LLVMValue tail)
+        {
+            auto int64Type = llvm::Type::getInt64Ty(function.GetLLVMContext());
+            auto packedHead = function.CastUnsignedValue(head, int64Type);
+            auto packedTail = function.Operator(TypedOperator::shiftLeft, function.CastUnsignedValue(tail, int64Type), function.Literal<int64_t>(32));
+            return function.Operator(TypedOperator::logicalOr, packedHead, packedTail);
+        }
+    } // namespace
+
     //
     // IRThreadPool
     //
@@ -34,11 +91,12 @@ namespace emitters
 
     void IRThreadPool::Initialize()
     {
-        _maxThreads = _module.GetCompilerOptions().maxThreads;
+        // The thread that starts the tasks runs them too, so we only need `maxThreads - 1` extra threads
+        _numWorkerThreads = std::max(_module.GetCompilerOptions().maxThreads - 1, 0);
         auto pthreadType = _module.GetRuntime().GetPosixEmitter().GetPthreadType();
 
         // Create global array to hold pthread objects
-        _threads = _module.GlobalArray("taskThreads", pthreadType, _maxThreads);
+        _threads = _module.GlobalArray("taskThreads", pthreadType, std::max(_numWorkerThreads, 1));
 
         AddGlobalInitializer();
         AddGlobalFinalizer();
@@ -58,13 +116,14 @@ namespace emitters
             auto notInited = initThreadPoolFunction.LogicalNot(initThreadPoolFunction.Load(isInitedVar));
             initThreadPoolFunction.If(notInited, [this, int8PtrType, &isInitedVar](auto& initThreadPoolFunction) {
                 initThreadPoolFunction.Store(isInitedVar, initThreadPoolFunction.TrueBit());
-                _taskQueue.Initialize(initThreadPoolFunction);
+                _taskQueue.Initialize(initThreadPoolFunction, _numWorkerThreads);
 
                 auto workerThreadFunction = this->GetWorkerThreadFunction(); // STYLE gcc bug requires `this->` inside generic lambda (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=67274)
                 llvm::ConstantPointerNull* nullAttr = initThreadPoolFunction.NullPointer(int8PtrType);
-                initThreadPoolFunction.For(_maxThreads, [this, int8PtrType, nullAttr, workerThreadFunction](auto& initThreadPoolFunction, LLVMValue index) {
+                initThreadPoolFunction.For(_numWorkerThreads, [this, int8PtrType, nullAttr, workerThreadFunction](auto& initThreadPoolFunction, LLVMValue index) {
+                    // Each worker thread gets its own index (which is also the index of its deque) as its argument
                     auto threadPtr = initThreadPoolFunction.PointerOffset(_threads, index);
-                    initThreadPoolFunction.PthreadCreate(threadPtr, nullAttr, workerThreadFunction, initThreadPoolFunction.CastPointer(_taskQueue.GetDataStruct(), int8PtrType));
+                    initThreadPoolFunction.PthreadCreate(threadPtr, nullAttr, workerThreadFunction, initThreadPoolFunction.CastIntToPointer(index, int8PtrType));
                 });
             });
         }
@@ -83,7 +142,7 @@ namespace emitters
         _module.AddFinalizationFunction(shutDownThreadPoolFunction);
     }
 
-    IRThreadPoolTaskArray& IRThreadPool::AddTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
+    IRThreadPoolTaskArray IRThreadPool::AddTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
     {
         // Call Initialize() the first time we're called --- this adds global init code to the module
         if (!IsInitialized())
@@ -102,7 +161,7 @@ namespace emitters
         _taskQueue.ShutDown(function);
 
         // Now wait for the worker threads to finish
-        function.For(_maxThreads, [=](auto& function, auto index) {
+        function.For(_numWorkerThreads, [=](auto& function, auto index) {
             auto threadPtr = function.PointerOffset(_threads, index);
             function.PthreadJoin(function.Load(threadPtr), function.NullPointer(int8PtrType->getPointerTo()));
         });
@@ -115,13 +174,15 @@ namespace emitters
         auto& context = _module.GetLLVMContext();
         auto boolType = llvm::Type::getInt1Ty(context);
         auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
 
         auto workerThreadFunction = _module.BeginFunction("WorkerThreadFunction", int8PtrType, { int8PtrType });
         {
+            auto workerIndex = workerThreadFunction.CastPointerToInt(&(*workerThreadFunction.Arguments().begin()), int32Type);
             auto notDoneVar = workerThreadFunction.Variable(boolType, "notDone");
             workerThreadFunction.Store(notDoneVar, workerThreadFunction.TrueBit());
-            workerThreadFunction.While(notDoneVar, [this, notDoneVar](IRFunctionEmitter& workerThreadFunction) {
-                auto task = _taskQueue.PopNextTask(workerThreadFunction);
+            workerThreadFunction.While(notDoneVar, [this, notDoneVar, workerIndex](IRFunctionEmitter& workerThreadFunction) {
+                auto task = _taskQueue.PopNextTask(workerThreadFunction, workerIndex);
                 // check for a poison "null" task, indicating we should break out of the loop and terminate the thread
                 workerThreadFunction.If(
                                         workerThreadFunction.Operator(TypedOperator::logicalOr, task.IsNull(workerThreadFunction), _taskQueue.GetShutdownFlag(workerThreadFunction)),
@@ -130,16 +191,7 @@ namespace emitters
                                         })
                     .Else([this, &task](IRFunctionEmitter& workerThreadFunction) {
                         task.Run(workerThreadFunction);
-
-                        // Decrement count of unfinished tasks
-                        _taskQueue.LockQueueMutex(workerThreadFunction);
-                        auto unfinishedCount = _taskQueue.DecrementUnfinishedTasks(workerThreadFunction);
-                        _taskQueue.UnlockQueueMutex(workerThreadFunction);
-
-                        // if zero, signal client cond var
-                        workerThreadFunction.If(workerThreadFunction.Comparison(TypedComparison::equals, unfinishedCount, workerThreadFunction.Literal<int>(0)), [this](auto& workerThreadFunction) {
-                            _taskQueue.NotifyWaitingClients(workerThreadFunction);
-                        });
+                        _taskQueue.FinishTask(workerThreadFunction);
                     });
             });
 
@@ -158,13 +210,12 @@ namespace emitters
     // IRThreadPoolTaskQueue
     //
 
-    IRThreadPoolTaskQueue::IRThreadPoolTaskQueue() :
-        _tasks(*this)
+    IRThreadPoolTaskQueue::IRThreadPoolTaskQueue()
     {
         // Note: we can't initialize ourselves here, for ordering reasons.
     }
 
-    void IRThreadPoolTaskQueue::Initialize(IRFunctionEmitter& function)
+    void IRThreadPoolTaskQueue::Initialize(IRFunctionEmitter& function, int numWorkerThreads)
     {
         if (_queueData != nullptr)
         {
@@ -180,13 +231,20 @@ namespace emitters
         // Allocate a data struct
         _queueData = module.Global(taskQueueDataType, "taskQueueData");
 
+        // Allocate the deques: one per worker thread, and one for the thread that starts the tasks. They start out empty (zero-initialized).
+        _numDeques = numWorkerThreads + 1;
+        _taskDeques = module.GlobalArray("taskDeques", GetTaskDequeType(module), _numDeques);
+        _taskDeques->setAlignment(c_cacheLineSize);
+
         // Get pointers to the fields
         auto queueMutex = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::queueMutex));
         auto workAvailableCondVar = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::workAvailableCondVar));
         auto workFinishedCondVar = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::workFinishedCondVar));
-        auto count = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unscheduledCount));
         auto unfinishedCount = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
+        auto generation = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::generation));
         auto shutdownFlag = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
+        auto busyFlag = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::busyFlag));
+        auto activeTaskArray = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::activeTaskArray));
 
         // Initialize the fields
         llvm::ConstantPointerNull* nullAttr = function.NullPointer(int8PtrType);
@@ -194,27 +252,65 @@ namespace emitters
         errCode = function.PthreadCondInit(workAvailableCondVar, nullAttr);
         errCode = function.PthreadCondInit(workFinishedCondVar, nullAttr);
         UNUSED(errCode);
-        function.Store(count, function.Literal<int>(0));
         function.Store(unfinishedCount, function.Literal<int>(0));
-        function.Store(shutdownFlag, function.FalseBit());
-
-        _tasks.Initialize(function);
+        function.Store(generation, function.Literal<int>(0));
+        function.Store(shutdownFlag, function.Literal<int>(0));
+        function.Store(busyFlag, function.Literal<int>(0));
+        function.Store(activeTaskArray, function.NullPointer(int8PtrType));
     }
 
-    IRThreadPoolTaskArray& IRThreadPoolTaskQueue::StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
+    IRThreadPoolTaskArray IRThreadPoolTaskQueue::StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
     {
         assert(IsInitialized());
 
-        // TODO: assert we're idle (until we can handle multiple task arrays to be active)
+        auto& module = function.GetModule();
+        auto& context = module.GetLLVMContext();
+        auto boolType = llvm::Type::getInt1Ty(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
 
-        const auto numTasks = arguments.size();
+        const auto numTasks = static_cast<int>(arguments.size());
+
+        // The task array lives on our stack, so the pool can run one set of tasks while another waits to start
+        IRThreadPoolTaskArray tasks(*this, function.Variable(IRThreadPoolTaskArray::GetTaskArrayDataType(module), "taskArrayData"), function.Variable(boolType, "ownsThreadPool"));
+        tasks.SetTasks(function, taskFunction, arguments);
+
+        // Only one set of tasks can be scheduled at a time. If the pool is already busy (e.g., we're running inside one of its tasks), run the tasks inline.
+        auto busyFlagPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::busyFlag));
+        auto acquiredPool = AtomicCompareExchange(function, busyFlagPtr, function.Literal<int>(0), function.Literal<int>(1));
+        function.Store(tasks._ownsThreadPool, acquiredPool);
+        function.If(acquiredPool, [this, &tasks, numTasks, int8PtrType](IRFunctionEmitter& function) {
+                    LockQueueMutex(function);
+                    function.Store(function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::activeTaskArray)), function.CastPointer(tasks._taskArrayData, int8PtrType));
+                    AtomicStore(function, function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount)), function.Literal<int>(numTasks));
+
+                    // Deal the tasks out to the deques in contiguous blocks, so neighboring tasks tend to run on the same thread
+                    for (int dequeIndex = 0; dequeIndex < _numDeques; ++dequeIndex)
+                    {
+                        auto begin = (dequeIndex * numTasks) / _numDeques;
+                        auto end = ((dequeIndex + 1) * numTasks) / _numDeques;
+                        SetTaskDequeRange(function, dequeIndex, begin, end);
+                    }
+
+                    // Bump the generation count so idle workers know there may be new work, and wake up any that are parked
+                    AtomicFetchAdd(function, function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::generation)), function.Literal<int>(1));
+                    function.PthreadCondBroadcast(GetWorkAvailableConditionVariablePointer(function));
+                    UnlockQueueMutex(function);
+                })
+            .Else([&tasks, numTasks](IRFunctionEmitter& function) {
+                function.For(numTasks, [&tasks](IRFunctionEmitter& function, LLVMValue taskIndex) {
+                    auto task = tasks.GetTask(function, taskIndex);
+                    task.Run(function);
+                });
+            });
+        return tasks;
+    }
 
-        LockQueueMutex(function);
-        _tasks.SetTasks(function, taskFunction, arguments);
-        SetInitialCount(function, function.Literal<int>(numTasks));
-        function.PthreadCondBroadcast(GetWorkAvailableConditionVariablePointer(function));
-        UnlockQueueMutex(function);
-        return GetTaskArray();
+    IRThreadPoolTaskArray IRThreadPoolTaskQueue::GetActiveTaskArray(IRFunctionEmitter& function)
+    {
+        auto& module = function.GetModule();
+        auto taskArrayDataPtrType = IRThreadPoolTaskArray::GetTaskArrayDataType(module)->getPointerTo();
+        auto activeTaskArray = function.Load(function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::activeTaskArray)));
+        return { *this, function.CastPointer(activeTaskArray, taskArrayDataPtrType), nullptr };
     }
 
     void IRThreadPoolTaskQueue::NotifyWaitingClients(IRFunctionEmitter& function)
@@ -222,34 +318,54 @@ namespace emitters
         function.PthreadCondBroadcast(GetWorkFinishedConditionVariablePointer(function));
     }
 
-    IRThreadPoolTask IRThreadPoolTaskQueue::PopNextTask(IRFunctionEmitter& function)
+    IRThreadPoolTask IRThreadPoolTaskQueue::PopNextTask(IRFunctionEmitter& function, LLVMValue workerIndex)
     {
         assert(IsInitialized());
 
         auto& module = function.GetModule();
         auto& context = module.GetLLVMContext();
         auto boolType = llvm::Type::getInt1Ty(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
 
-        auto isEmptyVar = function.Variable(boolType, "isEmpty");
+        auto taskIndexVar = function.Variable(int32Type, "taskIndex");
+        auto spinCountVar = function.Variable(int32Type, "spinCount");
+        auto keepLookingVar = function.Variable(boolType, "keepLooking");
         auto queueMutex = GetQueueMutexPointer(function);
         auto workAvailableCondVar = GetWorkAvailableConditionVariablePointer(function);
 
-        LockQueueMutex(function);
-        function.Store(isEmptyVar, function.Operator(TypedOperator::logicalAnd, IsEmpty(function), function.Operator(UnaryOperatorType::logicalNot, GetShutdownFlag(function))));
-        function.While(isEmptyVar, [=](auto& function) {
-            // Wait on the condition variable
-            function.PthreadCondWait(workAvailableCondVar, queueMutex);
+        function.Store(taskIndexVar, function.Literal<int>(-1));
+        function.Store(spinCountVar, function.Literal<int>(0));
+        function.Store(keepLookingVar, function.LogicalNot(GetShutdownFlag(function)));
+        function.While(keepLookingVar, [=](IRFunctionEmitter& function) {
+            // Read the generation count before looking for work: if new tasks are started after this point, the count will have changed and we won't park
+            auto generation = this->GetGeneration(function);
+            auto taskIndex = this->FindTaskIndex(function, workerIndex);
+            function.Store(taskIndexVar, taskIndex);
+            function.If(function.Comparison(TypedComparison::lessThan, taskIndex, function.Literal<int>(0)), [=](IRFunctionEmitter& function) {
+                auto spinCount = function.Operator(TypedOperator::add, function.Load(spinCountVar), function.Literal<int>(1));
+                function.Store(spinCountVar, spinCount);
+                function.If(function.Comparison(TypedComparison::greaterThanOrEquals, spinCount, function.Literal<int>(c_spinCountBeforePark)), [=](IRFunctionEmitter& function) {
+                    // Nothing to do for a while --- park until the generation count changes or we're told to shut down
+                    function.Store(spinCountVar, function.Literal<int>(0));
+                    this->LockQueueMutex(function);
+                    function.While([=](IRFunctionEmitter& function) {
+                        auto isSameGeneration = function.Comparison(TypedComparison::equals, this->GetGeneration(function), generation);
+                        return function.Operator(TypedOperator::logicalAnd, isSameGeneration, function.LogicalNot(this->GetShutdownFlag(function)));
+                    },
+                                   [=](IRFunctionEmitter& function) {
+                                       function.PthreadCondWait(workAvailableCondVar, queueMutex);
+                                   });
+                    this->UnlockQueueMutex(function);
+                });
+            });
 
             // update while loop exit condition
-            function.Store(isEmptyVar, function.Operator(TypedOperator::logicalAnd, this->IsEmpty(function), function.Operator(UnaryOperatorType::logicalNot, this->GetShutdownFlag(function))));
+            auto notFound = function.Comparison(TypedComparison::lessThan, function.Load(taskIndexVar), function.Literal<int>(0));
+            function.Store(keepLookingVar, function.Operator(TypedOperator::logicalAnd, notFound, function.LogicalNot(this->GetShutdownFlag(function))));
         });
 
-        // At loop exit, mutex is locked. Now decrement _count, unlock mutex, and return task at index _count
-        auto newCount = DecrementUnscheduledTasks(function);
-        UnlockQueueMutex(function);
-
-        // Get task from task array --- passing in a negative number (which is what happens if the array was empty) returns a null task
-        return _tasks.GetTask(function, newCount);
+        // Get task from task array --- passing in a negative number (which is what happens if we're shutting down) returns a null task
+        return GetActiveTaskArray(function).GetTask(function, function.Load(taskIndexVar));
     }
 
     bool IRThreadPoolTaskQueue::IsInitialized() const
@@ -257,12 +373,6 @@ namespace emitters
         return _queueData != nullptr;
     }
 
-    LLVMValue IRThreadPoolTaskQueue::IsEmpty(IRFunctionEmitter& function) const
-    {
-        assert(IsInitialized());
-        return function.Comparison(TypedComparison::equals, GetUnscheduledCount(function), function.Literal<int>(0));
-    }
-
     LLVMValue IRThreadPoolTaskQueue::IsFinished(IRFunctionEmitter& function) const
     {
         assert(IsInitialized());
@@ -273,28 +383,70 @@ namespace emitters
     {
         SetShutdownFlag(function);
 
-        // Now wake up the threads so they see it is time to shutdown.
+        // Now wake up the threads so they see it is time to shutdown. Holding the mutex here ensures a worker that is about to park sees the flag.
+        LockQueueMutex(function);
         function.PthreadCondBroadcast(GetWorkAvailableConditionVariablePointer(function));
+        UnlockQueueMutex(function);
         // Now PopNextTask will emit null tasks
     }
 
-    void IRThreadPoolTaskQueue::WaitAll(IRFunctionEmitter& function)
+    void IRThreadPoolTaskQueue::WaitAll(IRFunctionEmitter& function, IRThreadPoolTaskArray& tasks)
     {
         auto& module = function.GetModule();
         auto& context = module.GetLLVMContext();
         auto boolType = llvm::Type::getInt1Ty(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
 
         auto isNotDoneVar = function.Variable(boolType, "isNotDone");
+        auto spinCountVar = function.Variable(int32Type, "spinCount");
         auto mutex = GetQueueMutexPointer(function);
         auto workFinishedCondVar = GetWorkFinishedConditionVariablePointer(function);
+        auto callerIndex = function.Literal<int>(GetCallerDequeIndex());
+
+        // If the tasks were run inline by `StartTasks`, they're already done
+        function.If(function.Load(tasks._ownsThreadPool), [=, &tasks](IRFunctionEmitter& function) {
+            // Run tasks on this thread until there are none left to claim, then wait for the workers to finish theirs
+            function.Store(spinCountVar, function.Literal<int>(0));
+            function.Store(isNotDoneVar, function.LogicalNot(IsFinished(function)));
+            function.While(isNotDoneVar, [=, &tasks](IRFunctionEmitter& function) {
+                auto taskIndex = FindTaskIndex(function, callerIndex);
+                function.If(function.Comparison(TypedComparison::greaterThanOrEquals, taskIndex, function.Literal<int>(0)), [=, &tasks](IRFunctionEmitter& function) {
+                            auto task = tasks.GetTask(function, taskIndex);
+                            task.Run(function);
+                            FinishTask(function);
+                        })
+                    .Else([=](IRFunctionEmitter& function) {
+                        auto spinCount = function.Operator(TypedOperator::add, function.Load(spinCountVar), function.Literal<int>(1));
+                        function.Store(spinCountVar, spinCount);
+                        function.If(function.Comparison(TypedComparison::greaterThanOrEquals, spinCount, function.Literal<int>(c_spinCountBeforePark)), [=](IRFunctionEmitter& function) {
+                            function.Store(spinCountVar, function.Literal<int>(0));
+                            LockQueueMutex(function);
+                            function.While([=](IRFunctionEmitter& function) { return function.LogicalNot(IsFinished(function)); },
+                                           [=](IRFunctionEmitter& function) {
+                                               function.PthreadCondWait(workFinishedCondVar, mutex);
+                                           });
+                            UnlockQueueMutex(function);
+                        });
+                    });
+                function.Store(isNotDoneVar, function.LogicalNot(IsFinished(function)));
+            });
 
-        LockQueueMutex(function);
-        function.Store(isNotDoneVar, function.Operator(UnaryOperatorType::logicalNot, IsFinished(function)));
-        function.While(isNotDoneVar, [=](auto& function) {
-            function.PthreadCondWait(workFinishedCondVar, mutex);
-            function.Store(isNotDoneVar, function.Operator(UnaryOperatorType::logicalNot, this->IsFinished(function))); // STYLE gcc bug requires `this->` inside generic lambda (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=67274)
+            // Let the next set of tasks use the pool
+            AtomicStore(function, function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::busyFlag)), function.Literal<int>(0));
+        });
+    }
+
+    void IRThreadPoolTaskQueue::FinishTask(IRFunctionEmitter& function)
+    {
+        // Decrement count of unfinished tasks, and if we finished the last one, signal the client cond var
+        auto unfinishedCountPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
+        auto oldCount = AtomicFetchAdd(function, unfinishedCountPtr, function.Literal<int>(-1));
+        function.If(function.Comparison(TypedComparison::equals, oldCount, function.Literal<int>(1)), [this](IRFunctionEmitter& function) {
+            // Taking the mutex here ensures a client that is about to wait on the condition variable doesn't miss the notification
+            this->LockQueueMutex(function);
+            this->NotifyWaitingClients(function);
+            this->UnlockQueueMutex(function);
         });
-        UnlockQueueMutex(function);
     }
 
     llvm::StructType* IRThreadPoolTaskQueue::GetTaskQueueDataType(IRModuleEmitter& module) const // TODO: come up with a naming convention for "class" structs like this
@@ -302,10 +454,21 @@ namespace emitters
         auto& context = module.GetLLVMContext();
         auto mutexType = module.GetRuntime().GetPosixEmitter().GetPthreadMutexType();
         auto conditionVarType = module.GetRuntime().GetPosixEmitter().GetPthreadCondType();
-        auto boolType = llvm::Type::getInt1Ty(context);
         auto int32Type = llvm::Type::getInt32Ty(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
 
-        std::vector<LLVMType> fieldTypes = { mutexType, conditionVarType, conditionVarType, int32Type, int32Type, boolType };
+        std::vector<LLVMType> fieldTypes = { mutexType, conditionVarType, conditionVarType, int32Type, int32Type, int32Type, int32Type, int8PtrType };
+        return module.GetAnonymousStructType(fieldTypes);
+    }
+
+    llvm::StructType* IRThreadPoolTaskQueue::GetTaskDequeType(IRModuleEmitter& module) const
+    {
+        // The packed [head, tail) range, followed by padding out to a full cache line
+        auto& context = module.GetLLVMContext();
+        auto int64Type = llvm::Type::getInt64Ty(context);
+        auto paddingType = llvm::ArrayType::get(int64Type, c_cacheLineSize / sizeof(int64_t) - 1);
+
+        std::vector<LLVMType> fieldTypes = { int64Type, paddingType };
         return module.GetAnonymousStructType(fieldTypes);
     }
 
@@ -327,64 +490,90 @@ namespace emitters
         return function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::workFinishedCondVar));
     }
 
-    LLVMValue IRThreadPoolTaskQueue::GetUnscheduledCount(IRFunctionEmitter& function) const
+    LLVMValue IRThreadPoolTaskQueue::GetUnfinishedCount(IRFunctionEmitter& function) const
     {
         assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unscheduledCount));
-        return function.Load(fieldPtr);
+        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
+        return AtomicLoad(function, fieldPtr);
     }
 
-    LLVMValue IRThreadPoolTaskQueue::GetUnfinishedCount(IRFunctionEmitter& function) const
+    LLVMValue IRThreadPoolTaskQueue::GetGeneration(IRFunctionEmitter& function) const
     {
         assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
-        return function.Load(fieldPtr);
+        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::generation));
+        return AtomicLoad(function, fieldPtr);
     }
 
-    void IRThreadPoolTaskQueue::SetInitialCount(IRFunctionEmitter& function, LLVMValue numTasks)
+    LLVMValue IRThreadPoolTaskQueue::GetShutdownFlag(IRFunctionEmitter& function) const
     {
         assert(IsInitialized());
-        function.Store(function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unscheduledCount)), numTasks);
-        function.Store(function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount)), numTasks);
+        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
+        return function.Comparison(TypedComparison::notEquals, AtomicLoad(function, fieldPtr), function.Literal<int>(0));
     }
 
-    LLVMValue IRThreadPoolTaskQueue::DecrementCountField(IRFunctionEmitter& function, LLVMValue fieldPtr)
+    void IRThreadPoolTaskQueue::SetShutdownFlag(IRFunctionEmitter& function)
     {
-        auto count = function.Load(fieldPtr);
-        auto newCount = function.Operator(TypedOperator::subtract, count, function.Literal<int>(1));
-        auto isNotZero = function.Comparison(TypedComparison::notEquals, count, function.Literal<int>(0));
-        function.If(isNotZero, [=](auto& function) {
-            function.Store(fieldPtr, newCount);
-        });
-        return newCount;
+        assert(IsInitialized());
+        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
+        AtomicStore(function, fieldPtr, function.Literal<int>(1));
     }
 
-    LLVMValue IRThreadPoolTaskQueue::DecrementUnscheduledTasks(IRFunctionEmitter& function)
+    LLVMValue IRThreadPoolTaskQueue::GetTaskDequePointer(IRFunctionEmitter& function, LLVMValue dequeIndex)
     {
         assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unscheduledCount));
-        return DecrementCountField(function, fieldPtr);
+        auto deque = function.PointerOffset(_taskDeques, dequeIndex);
+        return function.GetStructFieldPointer(deque, 0);
     }
 
-    LLVMValue IRThreadPoolTaskQueue::DecrementUnfinishedTasks(IRFunctionEmitter& function)
+    void IRThreadPoolTaskQueue::SetTaskDequeRange(IRFunctionEmitter& function, int dequeIndex, int begin, int end)
     {
-        assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
-        return DecrementCountField(function, fieldPtr);
+        auto packedRange = (static_cast<uint64_t>(end) << 32) | static_cast<uint64_t>(begin);
+        AtomicStore(function, GetTaskDequePointer(function, function.Literal<int>(dequeIndex)), function.Literal<int64_t>(static_cast<int64_t>(packedRange)));
     }
 
-    LLVMValue IRThreadPoolTaskQueue::GetShutdownFlag(IRFunctionEmitter& function) const
+    LLVMValue IRThreadPoolTaskQueue::TryPopTaskIndex(IRFunctionEmitter& function, LLVMValue dequeIndex, bool fromTail)
     {
-        assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
-        return function.Load(fieldPtr);
+        // The owner of a deque pops from its tail, and thieves take from its head. Either way, a single compare-and-swap of the packed
+        // range claims the task; if it fails, another thread got there first and we report that nothing was found this time around.
+        auto& context = function.GetLLVMContext();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        auto resultVar = function.Variable(int32Type, "poppedTaskIndex");
+        function.Store(resultVar, function.Literal<int>(-1));
+
+        auto dequePtr = GetTaskDequePointer(function, dequeIndex);
+        auto packedRange = AtomicLoad(function, dequePtr);
+        auto head = function.CastValue(packedRange, int32Type);
+        auto tail = function.CastValue(function.Operator(TypedOperator::logicalShiftRight, packedRange, function.Literal<int64_t>(32)), int32Type);
+        function.If(function.Comparison(TypedComparison::lessThan, head, tail), [=](IRFunctionEmitter& function) {
+            auto one = function.Literal<int>(1);
+            auto taskIndex = fromTail ? function.Operator(TypedOperator::subtract, tail, one) : head;
+            auto newRange = fromTail ? PackTaskRange(function, head, taskIndex) : PackTaskRange(function, function.Operator(TypedOperator::add, head, one), tail);
+            function.If(AtomicCompareExchange(function, dequePtr, packedRange, newRange), [=](IRFunctionEmitter& function) {
+                function.Store(resultVar, taskIndex);
+            });
+        });
+        return function.Load(resultVar);
     }
 
-    void IRThreadPoolTaskQueue::SetShutdownFlag(IRFunctionEmitter& function)
+    LLVMValue IRThreadPoolTaskQueue::FindTaskIndex(IRFunctionEmitter& function, LLVMValue workerIndex)
     {
-        assert(IsInitialized());
-        auto fieldPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
-        function.Store(fieldPtr, function.TrueBit());
+        auto& context = function.GetLLVMContext();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        // First look in our own deque
+        auto resultVar = function.Variable(int32Type, "foundTaskIndex");
+        function.Store(resultVar, TryPopTaskIndex(function, workerIndex, true));
+
+        // Then try to steal from the others, starting with our neighbor
+        function.For(1, _numDeques, [=](IRFunctionEmitter& function, LLVMValue offset) {
+            auto notFound = function.Comparison(TypedComparison::lessThan, function.Load(resultVar), function.Literal<int>(0));
+            function.If(notFound, [=](IRFunctionEmitter& function) {
+                auto victimIndex = function.Operator(TypedOperator::moduloSigned, function.Operator(TypedOperator::add, workerIndex, offset), function.Literal<int>(_numDeques));
+                function.Store(resultVar, this->TryPopTaskIndex(function, victimIndex, false));
+            });
+        });
+        return function.Load(resultVar);
     }
 
     void IRThreadPoolTaskQueue::LockQueueMutex(IRFunctionEmitter& function)
@@ -404,11 +593,13 @@ namespace emitters
     //
     // IRThreadPoolTask
     //
-    IRThreadPoolTask::IRThreadPoolTask(LLVMValue wrappedTaskFunctionPtr, LLVMValue argsStructPtr, LLVMValue returnValuePtr, IRThreadPoolTaskArray* taskArray) :
+    IRThreadPoolTask::IRThreadPoolTask(LLVMValue wrappedTaskFunctionPtr, LLVMValue argsStructPtr, LLVMValue returnValuePtr, const IRThreadPoolTaskArray& taskArray) :
         _taskFunctionPtr(wrappedTaskFunctionPtr),
         _argsStruct(argsStructPtr),
         _returnValuePtr(returnValuePtr),
-        _taskArray(taskArray)
+        _taskQueue(taskArray._taskQueue),
+        _taskArrayData(taskArray._taskArrayData),
+        _ownsThreadPool(taskArray._ownsThreadPool)
     {
         if (_taskFunctionPtr == nullptr)
         {
@@ -432,7 +623,8 @@ namespace emitters
 
     void IRThreadPoolTask::Wait(IRFunctionEmitter& function)
     {
-        _taskArray->WaitAll(function);
+        IRThreadPoolTaskArray taskArray(*_taskQueue, _taskArrayData, _ownsThreadPool);
+        taskArray.WaitAll(function);
     }
 
     LLVMValue IRThreadPoolTask::GetReturnValue(IRFunctionEmitter& function)
@@ -452,23 +644,13 @@ namespace emitters
     // IRThreadPoolTaskArray
     //
 
-    IRThreadPoolTaskArray::IRThreadPoolTaskArray(IRThreadPoolTaskQueue& taskQueue) :
-        _taskQueue(taskQueue)
+    IRThreadPoolTaskArray::IRThreadPoolTaskArray(IRThreadPoolTaskQueue& taskQueue, LLVMValue taskArrayData, LLVMValue ownsThreadPool) :
+        _taskArrayData(taskArrayData),
+        _ownsThreadPool(ownsThreadPool),
+        _taskQueue(&taskQueue)
     {
     }
 
-    void IRThreadPoolTaskArray::Initialize(IRFunctionEmitter& function)
-    {
-        assert(_taskArrayData == nullptr);
-        auto& module = function.GetModule();
-
-        // Get types
-        auto taskArrayDataType = GetTaskArrayDataType(module);
-
-        // Allocate our data struct
-        _taskArrayData = module.Global(taskArrayDataType, "taskArrayData");
-    }
-
     llvm::StructType* IRThreadPoolTaskArray::GetTaskArrayDataType(IRModuleEmitter& module) // TODO: come up with a naming convention for "class" structs like this
     {
         auto& context = module.GetLLVMContext();
@@ -563,7 +745,7 @@ namespace emitters
     void IRThreadPoolTaskArray::WaitAll(IRFunctionEmitter& function)
     {
         // Wait for all the tasks to finish
-        _taskQueue.WaitAll(function);
+        _taskQueue->WaitAll(function, *this);
     }
 
     IRThreadPoolTask IRThreadPoolTaskArray::GetTask(IRFunctionEmitter& function, size_t taskIndex)
@@ -612,7 +794,7 @@ namespace emitters
                 function.Store(taskReturnValueVar, function.NullPointer(int8PtrPtrType));
             });
 
-        return { function.Load(taskFunctionVar), function.Load(taskDataVar), function.Load(taskReturnValueVar), this };
+        return { function.Load(taskFunctionVar), function.Load(taskDataVar), function.Load(taskReturnValueVar), *this };
     }
 } // namespace emitters
 } // namespace ell
@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRVectorUtilities.cpp (emitters)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRVectorUtilities.h"
+#include "IRModuleEmitter.h"
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+
+namespace ell
+{
+namespace emitters
+{
+    namespace
+    {
+        // An operand with its pointer resolved to a pointer to its element type, and its broadcast value
+        // (if any) loaded
+        struct LoopOperand
+        {
+            LLVMValue pointer = nullptr;
+            LLVMValue vectorPointer = nullptr; // only for contiguous operands in a vectorized loop
+            int stride = 1;
+            LLVMValue value = nullptr;
+            LLVMType elementType = nullptr;
+
+            bool IsBroadcast() const { return pointer == nullptr || stride == 0; }
+        };
+
+        LoopOperand PrepareOperand(IRFunctionEmitter& function, const ElementwiseOperand& operand)
+        {
+            LoopOperand result;
+            result.stride = operand.stride;
+            result.value = operand.value;
+            if (operand.value == nullptr && operand.pointer != nullptr)
+            {
+                // Also turns globals (which are pointers to arrays) into pointers to their first element
+                result.pointer = function.PointerOffset(operand.pointer, 0);
+                result.elementType = result.pointer->getType()->getPointerElementType();
+                if (operand.stride == 0)
+                {
+                    result.value = function.Load(result.pointer);
+                }
+            }
+            else if (operand.value != nullptr)
+            {
+                result.elementType = operand.value->getType();
+            }
+            return result;
+        }
+
+        LLVMValue GetElementOffset(const LoopOperand& operand, IRLocalScalar index)
+        {
+            return operand.stride == 1 ? index : index * operand.stride;
+        }
+
+        LLVMValue WidenBoolResult(IRFunctionEmitter& function, LLVMValue result, LLVMType outputElementType)
+        {
+            auto resultType = result->getType();
+            if (resultType->getScalarType()->isIntegerTy(1) && !outputElementType->isIntegerTy(1))
+            {
+                auto destinationType = resultType->isVectorTy() ? function.GetEmitter().VectorType(outputElementType, resultType->getVectorNumElements()) : outputElementType;
+                return function.GetEmitter().GetIRBuilder().CreateZExt(result, destinationType);
+            }
+            return result;
+        }
+
+        void EmitScalarLoop(IRFunctionEmitter& function, IRLocalScalar begin, IRLocalScalar end, const std::vector<LoopOperand>& inputs, const LoopOperand& output, const ElementwiseLoopBodyFunction& body)
+        {
+            function.For(begin, end, [&inputs, &output, &body](IRFunctionEmitter& function, IRLocalScalar index) {
+                std::vector<LLVMValue> values;
+                for (const auto& input : inputs)
+                {
+                    values.push_back(input.IsBroadcast() ? input.value : function.ValueAt(input.pointer, GetElementOffset(input, index)));
+                }
+                auto result = WidenBoolResult(function, body(function, values), output.elementType);
+                function.SetValueAt(output.pointer, GetElementOffset(output, index), result);
+            });
+        }
+
+        void EmitVectorLoop(IRFunctionEmitter& function, IRLocalScalar numBlocks, int vectorWidth, std::vector<LoopOperand>& inputs, LoopOperand& output, const ElementwiseLoopBodyFunction& body)
+        {
+            auto& emitter = function.GetEmitter();
+            auto& builder = emitter.GetIRBuilder();
+            const auto& dataLayout = function.GetModule().GetTargetDataLayout();
+
+            // Broadcast values and vector pointers are computed once, before the loop
+            std::vector<LLVMValue> broadcastValues;
+            for (auto& operand : inputs)
+            {
+                LLVMValue vectorValue = nullptr;
+                if (operand.IsBroadcast())
+                {
+                    if (operand.value != nullptr)
+                    {
+                        vectorValue = builder.CreateVectorSplat(vectorWidth, operand.value);
+                    }
+                }
+                else if (operand.stride == 1)
+                {
+                    operand.vectorPointer = function.CastPointer(operand.pointer, emitter.VectorType(operand.elementType, vectorWidth)->getPointerTo());
+                }
+                broadcastValues.push_back(vectorValue);
+            }
+            if (output.stride == 1)
+            {
+                output.vectorPointer = function.CastPointer(output.pointer, emitter.VectorType(output.elementType, vectorWidth)->getPointerTo());
+            }
+
+            function.For(numBlocks, [&, vectorWidth](IRFunctionEmitter& function, IRLocalScalar blockIndex) {
+                auto blockStart = blockIndex * vectorWidth;
+                std::vector<LLVMValue> values;
+                for (size_t operandIndex = 0; operandIndex < inputs.size(); ++operandIndex)
+                {
+                    const auto& input = inputs[operandIndex];
+                    if (input.IsBroadcast())
+                    {
+                        values.push_back(broadcastValues[operandIndex]);
+                    }
+                    else if (input.vectorPointer != nullptr)
+                    {
+                        // Ports are only guaranteed to be aligned to their element type
+                        auto alignment = dataLayout.getABITypeAlignment(input.elementType);
+                        values.push_back(builder.CreateAlignedLoad(function.PointerOffset(input.vectorPointer, blockIndex), alignment));
+                    }
+                    else
+                    {
+                        // Gather the elements of a strided operand
+                        LLVMValue vectorValue = llvm::UndefValue::get(emitter.VectorType(input.elementType, vectorWidth));
+                        for (int lane = 0; lane < vectorWidth; ++lane)
+                        {
+                            auto element = function.ValueAt(input.pointer, GetElementOffset(input, blockStart + lane));
+                            vectorValue = builder.CreateInsertElement(vectorValue, element, lane);
+                        }
+                        values.push_back(vectorValue);
+                    }
+                }
+
+                auto result = body(function, values);
+                if (!result->getType()->isVectorTy())
+                {
+                    result = builder.CreateVectorSplat(vectorWidth, result);
+                }
+                result = WidenBoolResult(function, result, output.elementType);
+
+                if (output.vectorPointer != nullptr)
+                {
+                    auto alignment = dataLayout.getABITypeAlignment(output.elementType);
+                    builder.CreateAlignedStore(result, function.PointerOffset(output.vectorPointer, blockIndex), alignment);
+                }
+                else
+                {
+                    for (int lane = 0; lane < vectorWidth; ++lane)
+                    {
+                        auto element = builder.CreateExtractElement(result, lane);
+                        function.SetValueAt(output.pointer, GetElementOffset(output, blockStart + lane), element);
+                    }
+                }
+            });
+        }
+    } // namespace
+
+    void EmitElementwiseLoop(IRFunctionEmitter& function, IRLocalScalar count, const std::vector<ElementwiseOperand>& inputs, const ElementwiseOperand& output, ElementwiseLoopBodyFunction body, bool vectorize)
+    {
+        if (output.pointer == nullptr || output.stride == 0)
+        {
+            throw EmitterException(EmitterError::badFunctionArguments, "Elementwise loop output must be a strided pointer");
+        }
+
+        std::vector<LoopOperand> loopInputs;
+        for (const auto& input : inputs)
+        {
+            loopInputs.push_back(PrepareOperand(function, input));
+        }
+        auto loopOutput = PrepareOperand(function, output);
+
+        const auto& options = function.GetCompilerOptions();
+        const int vectorWidth = (vectorize && options.allowVectorInstructions) ? options.vectorWidth : 1;
+        bool canVectorize = vectorWidth > 1 && llvm::VectorType::isValidElementType(loopOutput.elementType);
+        for (const auto& input : loopInputs)
+        {
+            if (input.elementType != nullptr && !llvm::VectorType::isValidElementType(input.elementType))
+            {
+                canVectorize = false;
+            }
+        }
+
+        // With a constant count, skip whichever of the loops has nothing to do
+        const int constantCount = count.IsConstantInt() ? count.GetIntValue<int>() : -1;
+        if (!canVectorize || (constantCount >= 0 && constantCount < vectorWidth))
+        {
+            EmitScalarLoop(function, function.LocalScalar<int>(0), count, loopInputs, loopOutput, body);
+            return;
+        }
+
+        auto numBlocks = count / vectorWidth;
+        EmitVectorLoop(function, numBlocks, vectorWidth, loopInputs, loopOutput, body);
+        if (constantCount < 0 || constantCount % vectorWidth != 0)
+        {
+            EmitScalarLoop(function, numBlocks * vectorWidth, count, loopInputs, loopOutput, body);
+        }
+    }
+
+    void EmitElementwiseLoop(IRFunctionEmitter& function, int count, const std::vector<ElementwiseOperand>& inputs, const ElementwiseOperand& output, ElementwiseLoopBodyFunction body, bool vectorize)
+    {
+        EmitElementwiseLoop(function, function.LocalScalar<int>(count), inputs, output, body, vectorize);
+    }
+} // namespace emitters
+} // namespace ell
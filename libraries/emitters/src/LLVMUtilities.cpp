@@ -10,7 +10,10 @@
 #include "EmitterException.h"
 
 #include <llvm/IR/Type.h>
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 
 namespace ell
@@ -33,6 +36,8 @@ namespace emitters
 
     emitters::TypedOperator GetOperator(LLVMType type, BinaryOperatorType operation)
     {
+        // Vector operations use the same operator as their elements
+        type = type->getScalarType();
         if (type->isIntegerTy() && type->getIntegerBitWidth() == 1)
         {
             return GetBooleanOperator(operation);
@@ -51,6 +56,7 @@ namespace emitters
 
     emitters::TypedComparison GetComparison(LLVMType type, BinaryPredicateType comparison)
     {
+        type = type->getScalarType();
         if (type->isIntegerTy())
         {
             return GetIntegerComparison(comparison);
@@ -62,5 +68,63 @@ namespace emitters
 
         throw EmitterException(EmitterError::valueTypeNotSupported);
     }
+
+    //
+    // Splitting modules
+    //
+    namespace
+    {
+        void AddReferencedGlobalValues(llvm::Value* value, std::unordered_set<llvm::GlobalValue*>& globals)
+        {
+            if (auto global = llvm::dyn_cast<llvm::GlobalValue>(value))
+            {
+                globals.insert(global);
+            }
+            else if (auto constant = llvm::dyn_cast<llvm::Constant>(value))
+            {
+                for (auto& operand : constant->operands())
+                {
+                    AddReferencedGlobalValues(operand.get(), globals);
+                }
+            }
+        }
+    } // namespace
+
+    std::unordered_set<llvm::GlobalValue*> GetReferencedGlobalValues(const llvm::Function& function)
+    {
+        std::unordered_set<llvm::GlobalValue*> globals;
+        for (const auto& block : function)
+        {
+            for (const auto& instruction : block)
+            {
+                for (const auto& operand : instruction.operands())
+                {
+                    AddReferencedGlobalValues(operand.get(), globals);
+                }
+            }
+        }
+        return globals;
+    }
+
+    void RemoveUnusedDeclarations(llvm::Module& module)
+    {
+        for (auto it = module.global_begin(); it != module.global_end();)
+        {
+            auto& global = *it++;
+            if (global.isDeclaration() && global.use_empty())
+            {
+                global.eraseFromParent();
+            }
+        }
+
+        for (auto it = module.begin(); it != module.end();)
+        {
+            auto& function = *it++;
+            if (function.isDeclaration() && function.use_empty())
+            {
+                function.eraseFromParent();
+            }
+        }
+    }
 } // namespace emitters
 } // namespace ell
@@ -132,6 +132,12 @@ namespace emitters
         return tripleObj.getOS() == llvm::Triple::MacOSX || tripleObj.getOS() == llvm::Triple::Darwin;
     }
 
+    bool TargetDevice::IsBareMetal() const
+    {
+        auto tripleObj = GetNormalizedTriple(triple);
+        return tripleObj.getOS() == llvm::Triple::UnknownOS;
+    }
+
     TargetDevice GetTargetDevice(std::string deviceName)
     {
         TargetDevice target;
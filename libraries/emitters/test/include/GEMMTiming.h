@@ -0,0 +1,13 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GEMMTiming.h (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Times the emitted native GEMM against the original unblocked loop and (if available) against BLAS
+template <typename ValueType>
+void TimeGEMM(int m, int n, int k, int vectorWidth, int numIterations);
@@ -0,0 +1,22 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRMathTest.h (emitters_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <emitters/include/CompilerOptions.h>
+
+// Checks the error of exp, log, tanh and sigmoid computed with the given implementation, in ULPs for `accurate` and absolute or relative error for `fast`
+template <typename ValueType>
+void TestMathFunctionApproximations(ell::emitters::MathFunctionImplementation implementation);
+
+// Checks the approximations on explicit vector values of the given width
+template <typename ValueType>
+void TestVectorMathFunctionApproximations(ell::emitters::MathFunctionImplementation implementation, int vectorWidth);
+
+// Checks the approximations' results for infinities, NaN, zero and subnormal inputs
+template <typename ValueType>
+void TestMathFunctionSpecialValues(ell::emitters::MathFunctionImplementation implementation);
@@ -0,0 +1,11 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRRuntimeTest.h (emitters_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+template <typename ValueType>
+void TestNativeGEMM(bool transposeA, bool transposeB, int m, int n, int k, int vectorWidth);
@@ -0,0 +1,13 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MathFunctionTiming.h (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Times optimized loops computing exp, log, tanh and sigmoid with each of the `mathFunctions` implementations
+template <typename ValueType>
+void TimeMathFunctions(int count, int numIterations);
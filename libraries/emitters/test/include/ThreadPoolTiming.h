@@ -0,0 +1,13 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ThreadPoolTiming.h (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Times running `numTasks` thread pool tasks on a pool with `numThreads` threads (including the calling thread), and returns the time in ms.
+// If `unevenTasks` is true, the amount of work per task grows linearly with the task index (with the same total work), which exercises work stealing.
+double TimeThreadPool(int numThreads, int numTasks, int workPerTask, bool unevenTasks, int numIterations);
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GEMMTiming.cpp (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GEMMTiming.h"
+
+#include <emitters/include/CompilerOptions.h>
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRRuntime.h>
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/MillisecondTimer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace ell::emitters;
+
+namespace
+{
+template <typename ValueType>
+using GEMMFunction = int (*)(int, int, int, int, int, int, ValueType, const ValueType*, int, const ValueType*, int, ValueType, ValueType*, int);
+
+const int CblasRowMajor = 101;
+const int CblasNoTrans = 111;
+
+// The unblocked i/k/j loop the native GEMM used before it was blocked and packed, kept here as a baseline
+template <typename ValueType>
+void EmitUnblockedGEMMFunction(IRModuleEmitter& module, const std::string& functionName)
+{
+    const auto valueType = GetVariableType<ValueType>();
+    const auto valuePointerType = GetPointerType(valueType);
+    NamedVariableTypeList argTypes = {
+        { "order", VariableType::Int32 },
+        { "transposeA", VariableType::Int32 },
+        { "transposeB", VariableType::Int32 },
+        { "m", VariableType::Int32 },
+        { "n", VariableType::Int32 },
+        { "k", VariableType::Int32 },
+        { "alpha", valueType },
+        { "A", valuePointerType },
+        { "lda", VariableType::Int32 },
+        { "B", valuePointerType },
+        { "ldb", VariableType::Int32 },
+        { "beta", valueType },
+        { "C", valuePointerType },
+        { "ldc", VariableType::Int32 }
+    };
+
+    auto function = module.BeginFunction(functionName, VariableType::Int32, argTypes);
+    function.SetAttributeForArguments({ 7, 9, 12 }, IRFunctionEmitter::Attributes::NoAlias);
+
+    auto arguments = function.Arguments().begin();
+    arguments++; // order
+    arguments++; // transposeA
+    arguments++; // transposeB
+    auto m = function.LocalScalar(&(*arguments++));
+    auto n = function.LocalScalar(&(*arguments++));
+    auto k = function.LocalScalar(&(*arguments++));
+    arguments++; // alpha
+    auto A = function.LocalArray(&(*arguments++));
+    auto lda = function.LocalScalar(&(*arguments++));
+    auto B = function.LocalArray(&(*arguments++));
+    auto ldb = function.LocalScalar(&(*arguments++));
+    arguments++; // beta
+    auto C = function.LocalArray(&(*arguments++));
+    auto ldc = function.LocalScalar(&(*arguments++));
+
+    function.MemorySet<ValueType>(C, function.Literal<int>(0), function.Literal<uint8_t>(0), ldc * m);
+    function.For(m, [A, B, C, lda, ldb, ldc, n, k](IRFunctionEmitter& function, auto i) {
+        function.For(k, [i, A, B, C, lda, ldb, ldc, n](IRFunctionEmitter& function, auto p) {
+            function.For(n, [i, p, A, B, C, lda, ldb, ldc](IRFunctionEmitter& function, auto j) {
+                auto cOffset = (i * ldc) + j;
+                C[cOffset] = C[cOffset] + (A[(i * lda) + p] * B[(p * ldb) + j]);
+            });
+        });
+    });
+    function.Return(function.Literal<int>(0));
+    module.EndFunction();
+}
+
+template <typename ValueType>
+double TimeGEMMFunction(GEMMFunction<ValueType> gemm, int m, int n, int k, const std::vector<ValueType>& A, const std::vector<ValueType>& B, std::vector<ValueType>& C, int numIterations)
+{
+    // Warm up
+    gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, 1, A.data(), k, B.data(), n, 0, C.data(), n);
+
+    utilities::MillisecondTimer timer;
+    for (int iter = 0; iter < numIterations; ++iter)
+    {
+        gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, 1, A.data(), k, B.data(), n, 0, C.data(), n);
+    }
+    return static_cast<double>(timer.Elapsed()) / numIterations;
+}
+
+double GetGFlops(int m, int n, int k, double milliseconds)
+{
+    return milliseconds > 0 ? (2.0 * m * n * k) / (milliseconds * 1.0e6) : 0.0;
+}
+} // namespace
+
+template <typename ValueType>
+void TimeGEMM(int m, int n, int k, int vectorWidth, int numIterations)
+{
+    const std::string unblockedName = "unblocked_gemm";
+    CompilerOptions options;
+    options.vectorWidth = vectorWidth;
+    IRModuleEmitter module("GEMMTiming", options);
+    EmitUnblockedGEMMFunction<ValueType>(module, unblockedName);
+    std::string nativeName = module.GetRuntime().GetGEMMFunction<ValueType>(false)->getName().str();
+#if USE_BLAS
+    std::string blasName = module.GetRuntime().GetGEMMFunction<ValueType>(true)->getName().str();
+#endif
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto unblockedGEMM = (GEMMFunction<ValueType>)executionEngine.ResolveFunctionAddress(unblockedName);
+    auto nativeGEMM = (GEMMFunction<ValueType>)executionEngine.ResolveFunctionAddress(nativeName);
+
+    std::vector<ValueType> A(m * k);
+    std::vector<ValueType> B(k * n);
+    for (size_t index = 0; index < A.size(); ++index)
+    {
+        A[index] = static_cast<ValueType>(index % 17) / 17;
+    }
+    for (size_t index = 0; index < B.size(); ++index)
+    {
+        B[index] = static_cast<ValueType>(index % 13) / 13;
+    }
+    std::vector<ValueType> unblockedC(m * n);
+    std::vector<ValueType> nativeC(m * n);
+
+    auto unblockedTime = TimeGEMMFunction(unblockedGEMM, m, n, k, A, B, unblockedC, numIterations);
+    auto nativeTime = TimeGEMMFunction(nativeGEMM, m, n, k, A, B, nativeC, numIterations);
+    testing::ProcessTest("Checking native GEMM results for " + std::to_string(m) + " x " + std::to_string(n) + " x " + std::to_string(k), testing::IsEqual(unblockedC, nativeC, static_cast<ValueType>(1e-3)));
+
+    std::cout << "GEMM " << m << " x " << n << " x " << k << " (vector width " << vectorWidth << "):\t"
+              << "unblocked: " << unblockedTime << " ms (" << GetGFlops(m, n, k, unblockedTime) << " GFlop/s)\t"
+              << "native: " << nativeTime << " ms (" << GetGFlops(m, n, k, nativeTime) << " GFlop/s)";
+#if USE_BLAS
+    auto blasGEMM = (GEMMFunction<ValueType>)executionEngine.ResolveFunctionAddress(blasName);
+    std::vector<ValueType> blasC(m * n);
+    auto blasTime = TimeGEMMFunction(blasGEMM, m, n, k, A, B, blasC, numIterations);
+    std::cout << "\tBLAS: " << blasTime << " ms (" << GetGFlops(m, n, k, blasTime) << " GFlop/s)";
+#endif
+    std::cout << std::endl;
+}
+
+//
+// Explicit instantiations
+//
+template void TimeGEMM<float>(int m, int n, int k, int vectorWidth, int numIterations);
+template void TimeGEMM<double>(int m, int n, int k, int vectorWidth, int numIterations);
@@ -15,7 +15,9 @@
 #include <emitters/include/IRExecutionEngine.h>
 #include <emitters/include/IRFunctionEmitter.h>
 #include <emitters/include/IRHeaderWriter.h>
+#include <emitters/include/IRMetadata.h>
 #include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IROptimizer.h>
 
 #include <testing/include/testing.h>
 
@@ -1164,3 +1166,62 @@ void TestCastToConditionalBool()
     TestCastToConditionalBool<float>();
     TestCastToConditionalBool<double>();
 }
+
+void TestOptimizeModuleInParallel()
+{
+    auto module = MakeHostModuleEmitter("OptimizeModuleInParallel");
+    auto int32Type = VariableType::Int32;
+    const int numFunctions = 4;
+    const int numIter = 100;
+
+    // A module-local helper, which is copied into every partition
+    auto helper = module.BeginFunction("ParallelHelper", int32Type, NamedVariableTypeList{ { "x", int32Type } });
+    {
+        auto x = helper.LocalScalar(helper.GetFunctionArgument("x"));
+        helper.Return((x * 3) + 1);
+    }
+    module.EndFunction();
+
+    // A small node function, which is inlined into its caller's partition
+    auto node = module.BeginFunction("ParallelNode", int32Type, NamedVariableTypeList{ { "x", int32Type } });
+    {
+        auto x = node.LocalScalar(node.GetFunctionArgument("x"));
+        node.Return(x - 2);
+    }
+    module.EndFunction();
+    module.InsertFunctionMetadata("ParallelNode", c_nodeFunctionTagName);
+
+    // The public functions each get optimized in one of the partitions
+    for (int index = 0; index < numFunctions; ++index)
+    {
+        auto fn = module.BeginFunction("ParallelTest" + std::to_string(index), int32Type);
+        fn.IncludeInHeader();
+        auto sum = fn.Variable(int32Type);
+        fn.Store(sum, fn.Literal<int32_t>(0));
+        fn.For(numIter, [sum, index](IRFunctionEmitter& fn, IRLocalScalar i) {
+            LLVMValue x = i * (index + 1);
+            auto value = fn.LocalScalar(fn.Call(index == 0 ? "ParallelNode" : "ParallelHelper", { x }));
+            fn.Store(sum, fn.LocalScalar(fn.Load(sum)) + value);
+        });
+        fn.Return(fn.Load(sum));
+        module.EndFunction();
+    }
+
+    auto numPartitions = OptimizeModuleInParallel(*module.GetLLVMModule(), numFunctions);
+    testing::ProcessTest("Testing module is optimized in more than one partition", numPartitions > 1);
+
+    IRExecutionEngine jit(std::move(module));
+    bool success = true;
+    for (int index = 0; index < numFunctions; ++index)
+    {
+        auto testFn = jit.GetFunction<int32_t()>("ParallelTest" + std::to_string(index));
+        int32_t expected = 0;
+        for (int i = 0; i < numIter; ++i)
+        {
+            auto x = i * (index + 1);
+            expected += index == 0 ? x - 2 : (x * 3) + 1;
+        }
+        success = success && (testFn() == expected);
+    }
+    testing::ProcessTest("Testing module optimized in parallel", success);
+}
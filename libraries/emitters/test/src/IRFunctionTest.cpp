@@ -18,14 +18,18 @@
 #include <emitters/include/IRFunctionEmitter.h>
 #include <emitters/include/IRLocalScalar.h>
 #include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRVectorUtilities.h>
 #include <emitters/include/Variable.h>
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 using namespace ell;
 using namespace ell::emitters;
@@ -51,6 +55,7 @@ public:
 
 using UnaryScalarDoubleFunction = double (*)(double);
 using BinaryScalarDoubleFunction = double (*)(double, double);
+using ElementwiseTestFunction = void (*)(const float*, const float*, const float*, float*, int8_t*, float*, int);
 
 //
 // Tests
@@ -142,4 +147,75 @@ void TestStringCompareFunction()
     testing::ProcessTest("Testing string comparison function",
                          testing::IsEqual(u, 0) && testing::IsEqual(v, 0) && testing::IsEqual(x, 0) && testing::IsEqual(y, 0) &&
                              testing::IsEqual(z, 1));
-}
\ No newline at end of file
+}
+
+void TestElementwiseLoop(int vectorWidth)
+{
+    CompilerOptions options;
+    options.allowVectorInstructions = vectorWidth > 1;
+    options.vectorWidth = vectorWidth;
+    IRModuleEmitter module("ElementwiseLoop", options);
+
+    // Constant count, with a remainder for every vector width
+    const int constantCount = 19;
+    const std::string functionName = "Elementwise";
+    auto floatPointerType = GetPointerType(VariableType::Float);
+    auto function = module.BeginFunction(functionName, VariableType::Void, { { "input1", floatPointerType }, { "input2", floatPointerType }, { "scale", floatPointerType }, { "output", floatPointerType }, { "flags", GetPointerType(VariableType::Byte) }, { "strided", floatPointerType }, { "count", VariableType::Int32 } });
+    auto input1 = function.GetFunctionArgument("input1");
+    auto input2 = function.GetFunctionArgument("input2");
+    auto scale = function.GetFunctionArgument("scale");
+    auto count = function.LocalScalar(function.GetFunctionArgument("count"));
+
+    // output[i] = input1[i] * input2[2i] + scale[0], for a count only known at runtime
+    EmitElementwiseLoop(function, count, { { input1 }, { input2, 2 }, { scale, 0 } }, { function.GetFunctionArgument("output") }, [](IRFunctionEmitter& function, const std::vector<LLVMValue>& inputs) {
+        return function.LocalScalar(inputs[0]) * inputs[1] + inputs[2];
+    });
+
+    // flags[i] = input1[i] > 0
+    EmitElementwiseLoop(function, constantCount, { { input1 } }, { function.GetFunctionArgument("flags") }, [](IRFunctionEmitter& function, const std::vector<LLVMValue>& inputs) {
+        return function.LocalScalar(inputs[0]) > 0.0f;
+    });
+
+    // strided[2i] = input1[i] + 1
+    EmitElementwiseLoop(function, constantCount, { { input1 }, { nullptr, 0, function.Literal(1.0f) } }, { function.GetFunctionArgument("strided"), 2 }, [](IRFunctionEmitter& function, const std::vector<LLVMValue>& inputs) {
+        return function.LocalScalar(inputs[0]) + inputs[1];
+    });
+    module.EndFunction();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto compiledFunction = (ElementwiseTestFunction)executionEngine.ResolveFunctionAddress(functionName);
+    for (int runtimeCount : { 3, constantCount, 37 })
+    {
+        const int size = 2 * std::max(runtimeCount, constantCount);
+        std::vector<float> input1(size);
+        std::vector<float> input2(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input1[index] = static_cast<float>(index % 5) - 2.0f;
+            input2[index] = 0.5f * static_cast<float>(index);
+        }
+        float scale = 3.0f;
+        std::vector<float> output(size, -1.0f);
+        std::vector<int8_t> flags(size, -1);
+        std::vector<float> strided(size, -1.0f);
+        compiledFunction(input1.data(), input2.data(), &scale, output.data(), flags.data(), strided.data(), runtimeCount);
+
+        std::vector<float> expectedOutput(size, -1.0f);
+        std::vector<int8_t> expectedFlags(size, -1);
+        std::vector<float> expectedStrided(size, -1.0f);
+        for (int index = 0; index < runtimeCount; ++index)
+        {
+            expectedOutput[index] = input1[index] * input2[2 * index] + scale;
+        }
+        for (int index = 0; index < constantCount; ++index)
+        {
+            expectedFlags[index] = input1[index] > 0 ? 1 : 0;
+            expectedStrided[2 * index] = input1[index] + 1.0f;
+        }
+
+        auto message = " (vector width " + std::to_string(vectorWidth) + ", count " + std::to_string(runtimeCount) + ")";
+        testing::ProcessTest("Testing elementwise loop with strided and broadcast operands" + message, testing::IsEqual(expectedOutput, output));
+        testing::ProcessTest("Testing elementwise loop with boolean result" + message, expectedFlags == flags);
+        testing::ProcessTest("Testing elementwise loop with strided output" + message, testing::IsEqual(expectedStrided, strided));
+    }
+}
@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRMathTest.cpp (emitters_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRMathTest.h"
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRMath.h>
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <testing/include/testing.h>
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace ell::emitters;
+
+namespace
+{
+template <typename ValueType>
+using MathFunction = void (*)(const ValueType*, ValueType*, int);
+
+enum class TestedFunction
+{
+    exp,
+    log,
+    tanh,
+    sigmoid
+};
+
+const std::vector<TestedFunction> c_testedFunctions = { TestedFunction::exp, TestedFunction::log, TestedFunction::tanh, TestedFunction::sigmoid };
+
+std::string GetFunctionName(TestedFunction testedFunction)
+{
+    switch (testedFunction)
+    {
+    case TestedFunction::exp:
+        return "exp";
+    case TestedFunction::log:
+        return "log";
+    case TestedFunction::tanh:
+        return "tanh";
+    case TestedFunction::sigmoid:
+        return "sigmoid";
+    }
+    return "";
+}
+
+long double Reference(TestedFunction testedFunction, long double x)
+{
+    switch (testedFunction)
+    {
+    case TestedFunction::exp:
+        return std::exp(x);
+    case TestedFunction::log:
+        return std::log(x);
+    case TestedFunction::tanh:
+        return std::tanh(x);
+    case TestedFunction::sigmoid:
+        return 1 / (1 + std::exp(-x));
+    }
+    return 0;
+}
+
+template <typename ValueType>
+std::vector<ValueType> GetTestInputs(TestedFunction testedFunction)
+{
+    const bool isDouble = std::is_same<ValueType, double>::value;
+    std::vector<std::pair<double, double>> ranges;
+    switch (testedFunction)
+    {
+    case TestedFunction::exp:
+        ranges = { { isDouble ? -700 : -87, isDouble ? 700 : 88 }, { -2, 2 } };
+        break;
+    case TestedFunction::log:
+        // These get exponentiated below
+        ranges = { { isDouble ? -700 : -85, isDouble ? 700 : 85 }, { -0.7, 0.7 } };
+        break;
+    case TestedFunction::tanh:
+        ranges = { { -10, 10 }, { -1, 1 }, { -0.01, 0.01 } };
+        break;
+    case TestedFunction::sigmoid:
+        ranges = { { -80, 80 }, { -5, 5 } };
+        break;
+    }
+
+    const int samplesPerRange = 20000;
+    std::vector<ValueType> inputs;
+    for (const auto& range : ranges)
+    {
+        for (int index = 0; index < samplesPerRange; ++index)
+        {
+            // Irregular spacing, so the samples don't all fall on the same points of the reduced range
+            auto t = std::fmod(index * 0.6180339887498949, 1.0);
+            auto x = range.first + (range.second - range.first) * t;
+            inputs.push_back(static_cast<ValueType>(testedFunction == TestedFunction::log ? std::exp(x) : x));
+        }
+    }
+    return inputs;
+}
+
+template <typename ValueType>
+long double GetUlp(long double value)
+{
+    value = std::abs(value);
+    auto minExponent = std::numeric_limits<ValueType>::min_exponent - std::numeric_limits<ValueType>::digits;
+    auto exponent = value == 0 ? minExponent : std::max(std::ilogb(value) - std::numeric_limits<ValueType>::digits + 1, minExponent);
+    return std::ldexp(static_cast<long double>(1), exponent);
+}
+
+// Emits `void <name>(const ValueType* input, ValueType* output, int count)`, computing one value at a time
+template <typename ValueType>
+void EmitScalarFunction(IRModuleEmitter& module, const std::string& name, TestedFunction testedFunction)
+{
+    const auto valueType = GetVariableType<ValueType>();
+    auto function = module.BeginFunction(name, VariableType::Void, { { "input", GetPointerType(valueType) }, { "output", GetPointerType(valueType) }, { "count", VariableType::Int32 } });
+    auto arguments = function.Arguments().begin();
+    auto input = function.LocalArray(&(*arguments++));
+    auto output = function.LocalArray(&(*arguments++));
+    auto count = function.LocalScalar(&(*arguments++));
+    function.For(count, [input, output, testedFunction](IRFunctionEmitter& function, auto i) {
+        IRLocalScalar x = input[i];
+        switch (testedFunction)
+        {
+        case TestedFunction::exp:
+            output[i] = Exp(x);
+            break;
+        case TestedFunction::log:
+            output[i] = Log(x);
+            break;
+        case TestedFunction::tanh:
+            output[i] = Tanh<ValueType>(x);
+            break;
+        case TestedFunction::sigmoid:
+            output[i] = Sigmoid(x);
+            break;
+        }
+    });
+    module.EndFunction();
+}
+
+// Emits `void <name>(const ValueType* input, ValueType* output, int count)`, computing `vectorWidth` values at a time (count must be a multiple of it)
+template <typename ValueType>
+void EmitVectorFunction(IRModuleEmitter& module, const std::string& name, TestedFunction testedFunction, MathFunctionImplementation implementation, int vectorWidth)
+{
+    const auto valueType = GetVariableType<ValueType>();
+    auto function = module.BeginFunction(name, VariableType::Void, { { "input", GetPointerType(valueType) }, { "output", GetPointerType(valueType) }, { "count", VariableType::Int32 } });
+    auto arguments = function.Arguments().begin();
+    LLVMValue input = &(*arguments++);
+    LLVMValue output = &(*arguments++);
+    auto count = function.LocalScalar(&(*arguments++));
+
+    auto& builder = function.GetEmitter().GetIRBuilder();
+    auto vectorPointerType = function.GetEmitter().VectorType(valueType, vectorWidth)->getPointerTo();
+    auto vectorInput = builder.CreateBitCast(input, vectorPointerType);
+    auto vectorOutput = builder.CreateBitCast(output, vectorPointerType);
+    function.For(count / vectorWidth, [=, &builder](IRFunctionEmitter& function, auto i) {
+        auto x = builder.CreateAlignedLoad(function.PointerOffset(vectorInput, i), sizeof(ValueType));
+        LLVMValue result = nullptr;
+        switch (testedFunction)
+        {
+        case TestedFunction::exp:
+            result = ApproximateExp(function, x, implementation);
+            break;
+        case TestedFunction::log:
+            result = ApproximateLog(function, x, implementation);
+            break;
+        case TestedFunction::tanh:
+            result = ApproximateTanh(function, x, implementation);
+            break;
+        case TestedFunction::sigmoid:
+            result = ApproximateSigmoid(function, x, implementation);
+            break;
+        }
+        builder.CreateAlignedStore(result, function.PointerOffset(vectorOutput, i), sizeof(ValueType));
+    });
+    module.EndFunction();
+}
+
+// Checks results against the C runtime library, computed at higher precision
+template <typename ValueType>
+void CheckResults(TestedFunction testedFunction, MathFunctionImplementation implementation, const std::vector<ValueType>& inputs, const std::vector<ValueType>& results, const std::string& description)
+{
+    long double largestError = 0;
+    for (size_t index = 0; index < inputs.size(); ++index)
+    {
+        auto reference = Reference(testedFunction, inputs[index]);
+        auto difference = std::abs(static_cast<long double>(results[index]) - reference);
+        long double error = 0;
+        if (implementation == MathFunctionImplementation::accurate)
+        {
+            error = difference / GetUlp<ValueType>(reference);
+        }
+        else if (testedFunction == TestedFunction::log || testedFunction == TestedFunction::tanh)
+        {
+            error = difference;
+        }
+        else
+        {
+            error = difference / std::abs(reference);
+        }
+
+        if (!(error <= largestError)) // catches NaN
+        {
+            largestError = error;
+        }
+    }
+
+    const bool isAccurate = implementation == MathFunctionImplementation::accurate;
+    const long double tolerance = isAccurate ? 4 : 5e-5;
+    testing::ProcessTest("Testing " + ToString(implementation) + " " + GetFunctionName(testedFunction) + "<" + std::string(std::is_same<ValueType, double>::value ? "double" : "float") + ">" + description +
+                             " (largest error " + std::to_string(static_cast<double>(largestError)) + (isAccurate ? " ULPs)" : ")"),
+                         largestError <= tolerance);
+}
+} // namespace
+
+template <typename ValueType>
+void TestMathFunctionApproximations(MathFunctionImplementation implementation)
+{
+    CompilerOptions options;
+    options.mathFunctions = implementation;
+    IRModuleEmitter module("MathFunctionApproximations", options);
+    for (auto testedFunction : c_testedFunctions)
+    {
+        EmitScalarFunction<ValueType>(module, GetFunctionName(testedFunction), testedFunction);
+    }
+
+    IRExecutionEngine executionEngine(std::move(module));
+    for (auto testedFunction : c_testedFunctions)
+    {
+        auto compiledFunction = (MathFunction<ValueType>)executionEngine.ResolveFunctionAddress(GetFunctionName(testedFunction));
+        auto inputs = GetTestInputs<ValueType>(testedFunction);
+        std::vector<ValueType> results(inputs.size());
+        compiledFunction(inputs.data(), results.data(), static_cast<int>(inputs.size()));
+        CheckResults(testedFunction, implementation, inputs, results, "");
+    }
+}
+
+template <typename ValueType>
+void TestVectorMathFunctionApproximations(MathFunctionImplementation implementation, int vectorWidth)
+{
+    IRModuleEmitter module("VectorMathFunctionApproximations", CompilerOptions{});
+    for (auto testedFunction : c_testedFunctions)
+    {
+        EmitVectorFunction<ValueType>(module, GetFunctionName(testedFunction), testedFunction, implementation, vectorWidth);
+    }
+
+    IRExecutionEngine executionEngine(std::move(module));
+    for (auto testedFunction : c_testedFunctions)
+    {
+        auto compiledFunction = (MathFunction<ValueType>)executionEngine.ResolveFunctionAddress(GetFunctionName(testedFunction));
+        auto inputs = GetTestInputs<ValueType>(testedFunction);
+        inputs.resize(inputs.size() - inputs.size() % vectorWidth);
+        std::vector<ValueType> results(inputs.size());
+        compiledFunction(inputs.data(), results.data(), static_cast<int>(inputs.size()));
+        CheckResults(testedFunction, implementation, inputs, results, " on vectors of " + std::to_string(vectorWidth));
+    }
+}
+
+template <typename ValueType>
+void TestMathFunctionSpecialValues(MathFunctionImplementation implementation)
+{
+    CompilerOptions options;
+    options.mathFunctions = implementation;
+    IRModuleEmitter module("MathFunctionSpecialValues", options);
+    for (auto testedFunction : c_testedFunctions)
+    {
+        EmitScalarFunction<ValueType>(module, GetFunctionName(testedFunction), testedFunction);
+    }
+
+    IRExecutionEngine executionEngine(std::move(module));
+    const auto infinity = std::numeric_limits<ValueType>::infinity();
+    const auto nan = std::numeric_limits<ValueType>::quiet_NaN();
+    const auto subnormal = std::numeric_limits<ValueType>::denorm_min() * 1000;
+    const std::vector<ValueType> inputs = { -infinity, infinity, nan, 0, 1, -1, 1000, -1000, subnormal };
+    auto Evaluate = [&](TestedFunction testedFunction) {
+        auto compiledFunction = (MathFunction<ValueType>)executionEngine.ResolveFunctionAddress(GetFunctionName(testedFunction));
+        std::vector<ValueType> results(inputs.size());
+        compiledFunction(inputs.data(), results.data(), static_cast<int>(inputs.size()));
+        return results;
+    };
+    auto prefix = "Testing " + ToString(implementation) + " ";
+    auto suffix = std::string("<") + (std::is_same<ValueType, double>::value ? "double" : "float") + "> of special values";
+
+    auto exp = Evaluate(TestedFunction::exp);
+    testing::ProcessTest(prefix + "exp" + suffix, exp[0] == 0 && exp[1] == infinity && std::isnan(exp[2]) && exp[3] == 1 && exp[6] == infinity && exp[7] == 0);
+
+    auto log = Evaluate(TestedFunction::log);
+    auto subnormalLogError = std::abs(log[8] - std::log(static_cast<long double>(subnormal)));
+    testing::ProcessTest(prefix + "log" + suffix, std::isnan(log[0]) && log[1] == infinity && std::isnan(log[2]) && log[3] == -infinity && log[4] == 0 && std::isnan(log[5]) && subnormalLogError < 1e-4);
+
+    auto tanh = Evaluate(TestedFunction::tanh);
+    testing::ProcessTest(prefix + "tanh" + suffix, tanh[0] == -1 && tanh[1] == 1 && std::isnan(tanh[2]) && tanh[3] == 0 && tanh[6] == 1 && tanh[7] == -1);
+
+    auto sigmoid = Evaluate(TestedFunction::sigmoid);
+    testing::ProcessTest(prefix + "sigmoid" + suffix, sigmoid[0] == 0 && sigmoid[1] == 1 && std::isnan(sigmoid[2]) && sigmoid[3] == 0.5 && sigmoid[6] == 1 && sigmoid[7] == 0);
+}
+
+//
+// Explicit instantiations
+//
+template void TestMathFunctionApproximations<float>(MathFunctionImplementation implementation);
+template void TestMathFunctionApproximations<double>(MathFunctionImplementation implementation);
+template void TestVectorMathFunctionApproximations<float>(MathFunctionImplementation implementation, int vectorWidth);
+template void TestVectorMathFunctionApproximations<double>(MathFunctionImplementation implementation, int vectorWidth);
+template void TestMathFunctionSpecialValues<float>(MathFunctionImplementation implementation);
+template void TestMathFunctionSpecialValues<double>(MathFunctionImplementation implementation);
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRRuntimeTest.cpp (emitters_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRRuntimeTest.h"
+
+#include <emitters/include/CompilerOptions.h>
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRRuntime.h>
+
+#include <testing/include/testing.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace ell::emitters;
+
+template <typename ValueType>
+using GEMMFunction = int (*)(int, int, int, int, int, int, ValueType, const ValueType*, int, const ValueType*, int, ValueType, ValueType*, int);
+
+namespace
+{
+const int CblasRowMajor = 101;
+const int CblasNoTrans = 111;
+const int CblasTrans = 112;
+
+template <typename ValueType>
+std::vector<ValueType> GetTestMatrix(int rows, int columns, int seed)
+{
+    std::vector<ValueType> result(rows * columns);
+    for (int index = 0; index < rows * columns; ++index)
+    {
+        result[index] = static_cast<ValueType>(((index * 7 + seed) % 13) - 6) / 4;
+    }
+    return result;
+}
+
+// Reference row-major C = alpha * op(A) * op(B) + beta * C
+template <typename ValueType>
+void ReferenceGEMM(bool transposeA, bool transposeB, int m, int n, int k, ValueType alpha, const std::vector<ValueType>& A, int lda, const std::vector<ValueType>& B, int ldb, ValueType beta, std::vector<ValueType>& C, int ldc)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            ValueType sum = 0;
+            for (int p = 0; p < k; ++p)
+            {
+                auto a = transposeA ? A[p * lda + i] : A[i * lda + p];
+                auto b = transposeB ? B[j * ldb + p] : B[p * ldb + j];
+                sum += a * b;
+            }
+            C[i * ldc + j] = alpha * sum + beta * C[i * ldc + j];
+        }
+    }
+}
+} // namespace
+
+template <typename ValueType>
+void TestNativeGEMM(bool transposeA, bool transposeB, int m, int n, int k, int vectorWidth)
+{
+    CompilerOptions options;
+    options.vectorWidth = vectorWidth;
+    IRModuleEmitter module("NativeGEMM", options);
+    auto gemmFunction = module.GetRuntime().GetGEMMFunction<ValueType>(false);
+    std::string functionName = gemmFunction->getName().str();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto compiledGEMM = (GEMMFunction<ValueType>)executionEngine.ResolveFunctionAddress(functionName);
+
+    // Use padded leading dimensions, to make sure strides are honored
+    const int lda = (transposeA ? m : k) + 1;
+    const int ldb = (transposeB ? k : n) + 2;
+    const int ldc = n + 3;
+    auto A = GetTestMatrix<ValueType>(transposeA ? k : m, lda, 1);
+    auto B = GetTestMatrix<ValueType>(transposeB ? n : k, ldb, 2);
+    auto initialC = GetTestMatrix<ValueType>(m, ldc, 3);
+
+    std::stringstream testName;
+    testName << "Testing native GEMM (" << (transposeA ? "A'" : "A") << " x " << (transposeB ? "B'" : "B") << ", m = " << m << ", n = " << n << ", k = " << k << ", vector width " << vectorWidth << ")";
+
+    for (auto beta : { static_cast<ValueType>(0), static_cast<ValueType>(0.5) })
+    {
+        const ValueType alpha = 2;
+        auto expectedC = initialC;
+        ReferenceGEMM(transposeA, transposeB, m, n, k, alpha, A, lda, B, ldb, beta, expectedC, ldc);
+
+        auto actualC = initialC;
+        compiledGEMM(CblasRowMajor, transposeA ? CblasTrans : CblasNoTrans, transposeB ? CblasTrans : CblasNoTrans, m, n, k, alpha, A.data(), lda, B.data(), ldb, beta, actualC.data(), ldc);
+
+        testing::ProcessTest(testName.str() + ", beta = " + std::to_string(beta), testing::IsEqual(expectedC, actualC, static_cast<ValueType>(1e-4)));
+    }
+}
+
+//
+// Explicit instantiations
+//
+template void TestNativeGEMM<float>(bool transposeA, bool transposeB, int m, int n, int k, int vectorWidth);
+template void TestNativeGEMM<double>(bool transposeA, bool transposeB, int m, int n, int k, int vectorWidth);
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MathFunctionTiming.cpp (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "MathFunctionTiming.h"
+
+#include <emitters/include/CompilerOptions.h>
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRMath.h>
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IROptimizer.h>
+
+#include <utilities/include/MillisecondTimer.h>
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace ell::emitters;
+
+namespace
+{
+template <typename ValueType>
+using MathFunction = void (*)(const ValueType*, ValueType*, int);
+
+using MathFunctionEmitter = std::function<IRLocalScalar(IRLocalScalar)>;
+
+template <typename ValueType>
+void EmitMathFunction(IRModuleEmitter& module, const std::string& name, MathFunctionEmitter emitFunction)
+{
+    const auto valueType = GetVariableType<ValueType>();
+    auto function = module.BeginFunction(name, VariableType::Void, { { "input", GetPointerType(valueType) }, { "output", GetPointerType(valueType) }, { "count", VariableType::Int32 } });
+    function.SetAttributeForArguments({ 0, 1 }, IRFunctionEmitter::Attributes::NoAlias);
+    auto arguments = function.Arguments().begin();
+    auto input = function.LocalArray(&(*arguments++));
+    auto output = function.LocalArray(&(*arguments++));
+    auto count = function.LocalScalar(&(*arguments++));
+    function.For(count, [input, output, emitFunction](IRFunctionEmitter& function, auto i) {
+        output[i] = emitFunction(input[i]);
+    });
+    module.EndFunction();
+}
+} // namespace
+
+template <typename ValueType>
+void TimeMathFunctions(int count, int numIterations)
+{
+    const std::vector<std::pair<std::string, MathFunctionEmitter>> functions = {
+        { "exp", [](IRLocalScalar x) { return Exp(x); } },
+        { "log", [](IRLocalScalar x) { return Log(x); } },
+        { "tanh", [](IRLocalScalar x) { return Tanh<ValueType>(x); } },
+        { "sigmoid", [](IRLocalScalar x) { return Sigmoid(x); } }
+    };
+
+    // Inputs in (0, 8], which are valid for all of the functions
+    std::vector<ValueType> input(count);
+    for (int index = 0; index < count; ++index)
+    {
+        input[index] = static_cast<ValueType>(index % 1000 + 1) / 125;
+    }
+    std::vector<ValueType> output(count);
+
+    for (const auto& function : functions)
+    {
+        std::cout << function.first << "<" << (std::is_same<ValueType, double>::value ? "double" : "float") << "> on " << count << " values:";
+        double libraryTime = 0;
+        for (auto implementation : { MathFunctionImplementation::library, MathFunctionImplementation::accurate, MathFunctionImplementation::fast })
+        {
+            CompilerOptions options;
+            options.mathFunctions = implementation;
+            IRModuleEmitter module("MathFunctionTiming", options);
+            EmitMathFunction<ValueType>(module, function.first, function.second);
+            IROptimizer optimizer(module);
+            optimizer.AddStandardPasses();
+            module.Optimize(optimizer);
+
+            IRExecutionEngine executionEngine(std::move(module));
+            auto compiledFunction = (MathFunction<ValueType>)executionEngine.ResolveFunctionAddress(function.first);
+
+            // Warm up
+            compiledFunction(input.data(), output.data(), count);
+
+            utilities::MillisecondTimer timer;
+            for (int iter = 0; iter < numIterations; ++iter)
+            {
+                compiledFunction(input.data(), output.data(), count);
+            }
+            auto time = static_cast<double>(timer.Elapsed()) / numIterations;
+            if (implementation == MathFunctionImplementation::library)
+            {
+                libraryTime = time;
+            }
+
+            std::cout << "\t" << ToString(implementation) << ": " << time << " ms (" << (time > 0 ? count / (time * 1000.0) : 0.0) << " Mvalues/s";
+            if (implementation != MathFunctionImplementation::library)
+            {
+                std::cout << ", speedup " << (time > 0 ? libraryTime / time : 0.0) << "x";
+            }
+            std::cout << ")";
+        }
+        std::cout << std::endl;
+    }
+}
+
+//
+// Explicit instantiations
+//
+template void TimeMathFunctions<float>(int count, int numIterations);
+template void TimeMathFunctions<double>(int count, int numIterations);
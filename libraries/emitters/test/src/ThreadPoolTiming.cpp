@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ThreadPoolTiming.cpp (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPoolTiming.h"
+
+#include <emitters/include/CompilerOptions.h>
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/MillisecondTimer.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace ell::emitters;
+
+namespace
+{
+using RunTasksFunction = void (*)(float*);
+
+// Emits a task function that runs a serial floating-point recurrence `workAmount` times and writes the result to `output[taskIndex]`
+IRFunctionEmitter EmitTaskFunction(IRModuleEmitter& module)
+{
+    auto& context = module.GetLLVMContext();
+    LLVMType int32Type = llvm::Type::getInt32Ty(context);
+    LLVMType floatPtrType = llvm::Type::getFloatPtrTy(context);
+
+    auto taskFunction = module.BeginFunction("ThreadPoolTimingTask", int32Type, { floatPtrType, int32Type, int32Type });
+    {
+        auto arguments = taskFunction.Arguments().begin();
+        auto output = &(*arguments++);
+        auto taskIndex = &(*arguments++);
+        auto workAmount = &(*arguments++);
+
+        auto x = taskFunction.Variable(VariableType::Float, "x");
+        taskFunction.Store(x, taskFunction.Literal<float>(1.0f));
+        taskFunction.For(workAmount, [x](IRFunctionEmitter& function, IRLocalScalar) {
+            auto value = function.LocalScalar(function.Load(x));
+            function.Store(x, value * 0.999f + 0.001f);
+        });
+        taskFunction.SetValueAt(output, taskIndex, taskFunction.Load(x));
+        taskFunction.Return(taskFunction.Literal<int>(0));
+    }
+    module.EndFunction();
+    return taskFunction;
+}
+} // namespace
+
+double TimeThreadPool(int numThreads, int numTasks, int workPerTask, bool unevenTasks, int numIterations)
+{
+    const std::string functionName = "RunThreadPoolTasks";
+    CompilerOptions options;
+    options.targetDevice.deviceName = "host";
+    options.parallelize = true;
+    options.useThreadPool = true;
+    options.maxThreads = numThreads;
+    IRModuleEmitter module("ThreadPoolTiming", options);
+
+    auto taskFunction = EmitTaskFunction(module);
+    auto function = module.BeginFunction(functionName, VariableType::Void, { { "output", VariableType::FloatPointer } });
+    {
+        auto output = function.GetFunctionArgument("output");
+        std::vector<std::vector<LLVMValue>> taskArgs;
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            // Uneven tasks go from roughly no work up to roughly twice the average
+            auto workAmount = unevenTasks ? (2 * workPerTask * (taskIndex + 1)) / (numTasks + 1) : workPerTask;
+            taskArgs.push_back({ output, function.Literal<int>(taskIndex), function.Literal<int>(workAmount) });
+        }
+        auto tasks = function.StartTasks(taskFunction, taskArgs);
+        tasks.WaitAll(function);
+    }
+    module.EndFunction();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto runTasks = (RunTasksFunction)executionEngine.ResolveFunctionAddress(functionName);
+
+    std::vector<float> output(numTasks, -1.0f);
+
+    // Warm up (this also lets the worker threads get started)
+    runTasks(output.data());
+    auto allTasksRan = std::none_of(output.begin(), output.end(), [](float x) { return x < 0; });
+    testing::ProcessTest("Checking all thread pool tasks ran with " + std::to_string(numThreads) + " threads", allTasksRan);
+
+    utilities::MillisecondTimer timer;
+    for (int iter = 0; iter < numIterations; ++iter)
+    {
+        runTasks(output.data());
+    }
+    return static_cast<double>(timer.Elapsed()) / numIterations;
+}
@@ -9,7 +9,9 @@
 #include "AsyncEmitterTest.h"
 #include "IREmitterTest.h"
 #include "IRFunctionTest.h"
+#include "IRMathTest.h"
 #include "IRProfilerTest.h"
+#include "IRRuntimeTest.h"
 #include "PosixEmitterTest.h"
 #include "StdlibEmitterTest.h"
 
@@ -53,12 +55,49 @@ void TestIR()
 
     TestCastValue();
     TestCastToConditionalBool();
+
+    TestOptimizeModuleInParallel();
 }
 
 void TestIRFunction()
 {
     TestIRAddFunction();
     TestCompilableFunction();
+    for (int vectorWidth : { 1, 4, 8, 16 })
+    {
+        TestElementwiseLoop(vectorWidth);
+    }
+}
+
+void TestMathFunctions()
+{
+    using emitters::MathFunctionImplementation;
+    for (auto implementation : { MathFunctionImplementation::accurate, MathFunctionImplementation::fast })
+    {
+        TestMathFunctionApproximations<float>(implementation);
+        TestMathFunctionApproximations<double>(implementation);
+        TestMathFunctionSpecialValues<float>(implementation);
+        TestMathFunctionSpecialValues<double>(implementation);
+        for (auto vectorWidth : { 4, 8 })
+        {
+            TestVectorMathFunctionApproximations<float>(implementation, vectorWidth);
+            TestVectorMathFunctionApproximations<double>(implementation, vectorWidth);
+        }
+    }
+}
+
+void TestRuntime()
+{
+    for (auto transposeA : { false, true })
+    {
+        for (auto transposeB : { false, true })
+        {
+            TestNativeGEMM<float>(transposeA, transposeB, 1, 1, 1, 4);
+            TestNativeGEMM<float>(transposeA, transposeB, 5, 7, 3, 4);
+            TestNativeGEMM<float>(transposeA, transposeB, 70, 135, 130, 8); // spans more than one packed block in each dimension
+            TestNativeGEMM<double>(transposeA, transposeB, 17, 9, 33, 4);
+        }
+    }
 }
 
 void TestAsyncEmitter()
@@ -105,6 +144,8 @@ int main()
 {
     TestIR();
     TestIRFunction();
+    TestMathFunctions();
+    TestRuntime();
     TestAsyncEmitter();
     TestPosixEmitter();
     TestProfiler();
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     timing_main.cpp (emitters_timing)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GEMMTiming.h"
+#include "MathFunctionTiming.h"
+#include "ThreadPoolTiming.h"
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/Exception.h>
+
+#include <iostream>
+#include <string>
+
+using namespace ell;
+
+int main()
+{
+    try
+    {
+        // Shapes typical of fully-connected layers (GEMV-like) and unrolled convolutions
+        for (auto vectorWidth : { 4, 8, 16 })
+        {
+            TimeGEMM<float>(64, 64, 64, vectorWidth, 100);
+            TimeGEMM<float>(256, 256, 256, vectorWidth, 10);
+            TimeGEMM<float>(32, 3600, 288, vectorWidth, 10);
+            TimeGEMM<float>(512, 512, 512, vectorWidth, 2);
+            std::cout << "\n";
+        }
+        TimeGEMM<double>(256, 256, 256, 4, 10);
+        std::cout << "\n";
+
+        // Math function throughput, calling the C runtime library and with the inline approximations
+        TimeMathFunctions<float>(1 << 16, 100);
+        TimeMathFunctions<double>(1 << 16, 100);
+        std::cout << "\n";
+
+        // Thread pool scaling, with equal-sized tasks and with uneven tasks that need to be stolen to balance the load
+        for (auto unevenTasks : { false, true })
+        {
+            const int numTasks = 256;
+            const int workPerTask = 20000;
+            double serialTime = 0;
+            for (auto numThreads : { 1, 2, 4, 8, 16, 32, 64 })
+            {
+                auto time = TimeThreadPool(numThreads, numTasks, workPerTask, unevenTasks, 20);
+                if (numThreads == 1)
+                {
+                    serialTime = time;
+                }
+                std::cout << "Thread pool, " << numTasks << (unevenTasks ? " uneven" : " even") << " tasks, " << numThreads << " threads:\t"
+                          << time << " ms (speedup " << (time > 0 ? serialTime / time : 0.0) << "x)" << std::endl;
+            }
+        }
+    }
+    catch (const utilities::Exception& exception)
+    {
+        std::cerr << "ERROR, got ELL exception. Message: " << exception.GetMessage() << std::endl;
+        throw;
+    }
+
+    return testing::DidTestFail() ? 1 : 0;
+}
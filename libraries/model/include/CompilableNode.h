@@ -35,6 +35,18 @@ namespace model
         /// <param name="compiler"> The compiler to use when compiling the node </param>
         void CompileNode(MapCompiler& compiler);
 
+        /// <summary> Compile the node into the batched predict function, for a batch of samples </summary>
+        ///
+        /// <param name="compiler"> The compiler to use when compiling the node </param>
+        /// <param name="function"> The batched predict function </param>
+        /// <param name="batchSize"> The number of samples to compute </param>
+        void CompileNodeBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize);
+
+        /// <summary> Indicates if the node can be compiled into the batched predict function, either for a whole batch or once per sample. </summary>
+        ///
+        /// <param name="compiler"> The compiler compiling the node </param>
+        bool IsBatchCompilable(IRMapCompiler& compiler) const;
+
         /// <summary> Indicates if this node is able to compile itself to code. </summary>
         bool IsCompilable(const MapCompiler* compiler) const override { return true; }
 
@@ -105,6 +117,15 @@ namespace model
         // for the node's compute function.
         virtual void CallNodeFunction(IRMapCompiler& compiler, emitters::IRFunctionEmitter& currentFunction);
 
+        // Returns true if the node can compute a whole batch of samples at once in the batched predict function, with `CompileBatch`.
+        // The default implementation returns false, and the batched predict function calls the node's function once per sample instead.
+        virtual bool CanCompileBatch(IRMapCompiler& compiler) const;
+
+        // If `CanCompileBatch` returns true, this function must emit code that computes the node for `batchSize` samples.
+        // `IRMapCompiler::GetBatchPortValues` returns the values of a port for all the samples, stored one sample after another.
+        // The default implementation throws a `notImplemented` exception.
+        virtual void CompileBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize);
+
     private:
         const std::string _nodeFunctionPrefix = "_Node__";
         const char _badIdentifierChars[3] = { '<', '>', ',' };
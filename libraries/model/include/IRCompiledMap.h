@@ -18,6 +18,7 @@
 
 #include <emitters/include/IRExecutionEngine.h>
 #include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRObjectCache.h>
 #include <emitters/include/ModuleEmitter.h>
 
 #include <utilities/include/Boolean.h>
@@ -44,6 +45,7 @@ namespace model
         IRCompiledMap(IRCompiledMap&& other);
         IRCompiledMap& operator=(const IRCompiledMap&) = delete;
         //IRCompiledMap& operator=(IRCompiledMap&& other);
+        ~IRCompiledMap() override;
 
         /// <summary> Output the compiled model to the given file </summary>
         ///
@@ -189,6 +191,55 @@ namespace model
         /// <summary> Get the context object to use in the predict call </summary>
         void* GetContext() const { return _context; }
 
+        /// <summary> Is the compiled map reentrant (i.e., does it keep its mutable state in per-instance blocks)? </summary>
+        bool IsReentrant() const { return _compilerOptions.reentrant; }
+
+        /// <summary> Create a new instance block for a reentrant map. Each thread evaluating the map needs its own instance. </summary>
+        ///
+        /// <param name="context"> The context object passed to callbacks when evaluating with this instance. </param>
+        /// <returns> The new instance, to be passed as the `context` argument of the predict function. </returns>
+        void* CreateInstance(void* context);
+
+        /// <summary> Destroy an instance block created with `CreateInstance`. </summary>
+        ///
+        /// <param name="instance"> The instance to destroy. </param>
+        void DestroyInstance(void* instance);
+
+        /// <summary> Reset the state of the model and of the compiled map (for reentrant maps, the default instance used by `Compute`). </summary>
+        void Reset();
+
+        /// <summary> Reset the state held in an instance block of a reentrant map. </summary>
+        ///
+        /// <param name="instance"> The instance to reset, created with `CreateInstance`. </param>
+        void Reset(void* instance);
+
+        /// <summary> Was the map compiled with a batched predict function (the `predictBatch` option)? </summary>
+        bool HasPredictBatch() const { return _compilerOptions.predictBatch; }
+
+        /// <summary>
+        /// Was the map's object code found in the object cache (the `objectCacheDirectory` option)? A map loaded from the cache
+        /// skipped compilation entirely: it can be evaluated, but its module only holds declarations, so it can't be written out as code.
+        /// </summary>
+        bool IsLoadedFromObjectCache() const { return _loadedFromObjectCache; }
+
+        /// <summary>
+        /// Was the map compiled for lazy JIT compilation (the `lazyJit` option)? Each node's function is then compiled when it's first called,
+        /// or earlier by a background thread; `GetJitter().CompileLazyFunctions()` compiles the rest right away.
+        /// </summary>
+        bool IsLazilyCompiled() const { return _compilerOptions.lazyJit; }
+
+        /// <summary>
+        /// Evaluates the map on a batch of samples with a single call to the batched predict function.
+        /// Samples are processed in order, as if by consecutive calls to `Compute`.
+        /// </summary>
+        ///
+        /// <typeparam name="InputType"> The input element type. </typeparam>
+        /// <typeparam name="OutputType"> The output element type. </typeparam>
+        /// <param name="inputs"> The input samples, stored one after another. </param>
+        /// <returns> The output for each sample, stored one after another. </returns>
+        template <typename InputType, typename OutputType = InputType>
+        std::vector<OutputType> ComputeBatch(const std::vector<InputType>& inputs);
+
     protected:
         void WriteCode(const std::string& filePath, emitters::ModuleOutputFormat format, emitters::MachineCodeOutputOptions options) const;
         void WriteCode(std::ostream& stream, emitters::ModuleOutputFormat format, emitters::MachineCodeOutputOptions options) const;
@@ -209,8 +260,10 @@ namespace model
         friend class IRMapCompiler;
 
         IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule);
+        IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule, std::shared_ptr<emitters::IRObjectCache> objectCache, const std::string& objectCacheKey, bool loadedFromObjectCache);
 
         void EnsureExecutionEngine();
+        void* GetPredictContext();
         void SetComputeFunction();
         template <typename InputType>
         void SetComputeFunctionForInputType();
@@ -221,9 +274,15 @@ namespace model
         emitters::IRModuleEmitter& _module;
         std::string _moduleName;
 
+        // the object cache must outlive the execution engine that uses it
+        std::shared_ptr<emitters::IRObjectCache> _objectCache;
+        std::string _objectCacheKey;
+        bool _loadedFromObjectCache = false;
+
         std::unique_ptr<emitters::IRExecutionEngine> _executionEngine;
         bool _verifyJittedModule = false;
         void* _context = nullptr;
+        void* _instance = nullptr; // default instance used by `Compute` for reentrant maps
 
         template <typename T>
         using Vector = std::vector<std::conditional_t<std::is_same_v<bool, T>, Boolean, T>>;
@@ -310,6 +369,34 @@ namespace model
         }
     }
 
+    template <typename InputType, typename OutputType>
+    std::vector<OutputType> IRCompiledMap::ComputeBatch(const std::vector<InputType>& inputs)
+    {
+        static_assert(!std::is_same_v<InputType, bool> && !std::is_same_v<OutputType, bool>, "ComputeBatch doesn't support boolean inputs or outputs");
+
+        if (!HasPredictBatch())
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Map was compiled without a batched predict function");
+        }
+        if (GetInput(0)->GetOutputPort().GetType() != Port::GetPortType<InputType>() || GetOutput(0).GetPortType() != Port::GetPortType<OutputType>())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+        }
+
+        auto inputSize = GetInput(0)->Size();
+        auto outputSize = GetOutput(0).Size();
+        if (inputSize == 0 || inputs.size() % inputSize != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Input size must be a multiple of the map's input size");
+        }
+
+        auto count = inputs.size() / inputSize;
+        std::vector<OutputType> outputs(count * outputSize);
+        auto fn = reinterpret_cast<void (*)(void*, int32_t, const InputType*, OutputType*)>(GetJitter().ResolveFunctionAddress(_functionName + "Batch"));
+        fn(GetPredictContext(), static_cast<int32_t>(count), inputs.data(), outputs.data());
+        return outputs;
+    }
+
     template <typename ElementType>
     ElementType* IRCompiledMap::GetGlobalValuePointer(const std::string& name)
     {
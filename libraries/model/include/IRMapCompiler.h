@@ -14,13 +14,18 @@
 #include "Node.h"
 #include "NodeMap.h"
 #include "OutputPort.h"
+#include "PortMemoryPlanner.h"
 
 #include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRObjectCache.h>
 #include <emitters/include/LLVMUtilities.h>
 
 #include <utilities/include/Logger.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace ell
@@ -33,6 +38,8 @@ namespace emitters
 
 namespace model
 {
+    class CompilableNode;
+
     /// <summary> Compiles ELL Models to LLVM IR </summary>
     class IRMapCompiler : public MapCompiler
     {
@@ -58,6 +65,29 @@ namespace model
         /// <returns> The CompilerOptions struct used by the IR emitter to control code generation. </returns>
         emitters::CompilerOptions GetCompilerOptions() const { return GetModule().GetCompilerOptions(); }
 
+        /// <summary> Gets the placement of intermediate port buffers chosen when the map was compiled. </summary>
+        ///
+        /// <returns> The port memory plan, including the planned and naive memory sizes. Empty if `planPortMemory` is disabled. </returns>
+        const PortMemoryPlan& GetPortMemoryPlan() const { return _portMemoryPlan; }
+
+        /// <summary> Gets the number of groups of independent model branches that were emitted as concurrent tasks. </summary>
+        ///
+        /// <returns> The number of parallel branch groups. Zero unless the map was compiled with `parallelize` enabled. </returns>
+        int GetNumParallelBranchGroups() const { return _numParallelBranchGroups; }
+
+        /// <summary>
+        /// Sets the object cache used to store and reuse JIT-compiled object code. Compilers can share a cache. If no cache is set,
+        /// one is created for the `objectCacheDirectory` option, if that is set.
+        /// </summary>
+        ///
+        /// <param name="objectCache"> The object cache to use. </param>
+        void SetObjectCache(std::shared_ptr<emitters::IRObjectCache> objectCache) { _objectCache = std::move(objectCache); }
+
+        /// <summary> Gets the object cache, which keeps count of cache hits and misses. </summary>
+        ///
+        /// <returns> The object cache, or null if object caching isn't enabled. </returns>
+        std::shared_ptr<emitters::IRObjectCache> GetObjectCache() const { return _objectCache; }
+
         //
         // Routines useful to Node implementers
         //
@@ -102,6 +132,32 @@ namespace model
         /// <returns> The LLVM Value object corresponding to the port element. </returns>
         emitters::LLVMValue LoadPortElementVariable(const PortElementBase& element);
 
+        /// <summary> Gets the values of the output port referenced by this input port in the batched predict function </summary>
+        ///
+        /// <param name="port"> The port to get the values of. </param>
+        /// <returns> Pointer to the port's values for every sample of the batch, stored one sample after another. If `IsBatchPortShared`
+        /// returns true for the port, pointer to the one copy of the values that all the samples share. </returns>
+        emitters::LLVMValue GetBatchPortValues(const InputPortBase& port);
+
+        /// <summary> Gets the values of the given port in the batched predict function </summary>
+        ///
+        /// <param name="port"> The port to get the values of. </param>
+        /// <returns> Pointer to the port's values for every sample of the batch, stored one sample after another. If `IsBatchPortShared`
+        /// returns true for the port, pointer to the one copy of the values that all the samples share. </returns>
+        emitters::LLVMValue GetBatchPortValues(const OutputPortBase& port);
+
+        /// <summary> Indicates if all the samples in the batched predict function share the values of the output port referenced by this input port </summary>
+        ///
+        /// <param name="port"> The port to check. </param>
+        /// <returns> `true` if the port's values don't depend on the sample, as with constants. </returns>
+        bool IsBatchPortShared(const InputPortBase& port);
+
+        /// <summary> Indicates if all the samples in the batched predict function share the values of the given port </summary>
+        ///
+        /// <param name="port"> The port to check. </param>
+        /// <returns> `true` if the port's values don't depend on the sample, as with constants. </returns>
+        bool IsBatchPortShared(const OutputPortBase& port);
+
         /// <summary> Creates a new BlockRegion for the node </summary>
         ///
         /// <param name="node"> The node we're compiling </param>
@@ -154,6 +210,7 @@ namespace model
         void OnEndCompileNode(const Node& node) override;
         void PushScope() override;
         void PopScope() override;
+        void CompileNodes(Model& model) override;
         emitters::ModuleEmitter* GetModuleEmitter() override { return &_moduleEmitter; }
         virtual std::string GetPredictFunctionName() const;
         virtual void EmitModelAPIFunctions(const Map& map);
@@ -182,6 +239,50 @@ namespace model
         void EmitGetMetadataFunction(const Map& map);
         void EmitStringConditionals(emitters::IRFunctionEmitter& fn, std::vector<std::pair<std::string, std::string>> keyValuePairs);
 
+        // Reentrant maps: moves mutable globals created since `sharedGlobals` was captured into a per-instance block
+        std::unordered_set<const llvm::GlobalVariable*> GetGlobalVariables() const;
+        void EmitInstanceState(const std::unordered_set<const llvm::GlobalVariable*>& sharedGlobals);
+        void EmitCreateInstanceFunction(const std::vector<llvm::GlobalVariable*>& stateGlobals, const std::vector<uint64_t>& offsets, uint64_t instanceSize);
+        void EmitDestroyInstanceFunction();
+
+        // Batched predict: the batch is computed in tiles of samples. Nodes that can compute a whole tile at once do so, the others
+        // are called once per sample, and the tile's intermediate port values are packed into one arena, as with port memory planning
+        void EmitPredictBatchFunction(const Map& map);
+        std::vector<CompilableNode*> GetPredictBatchSchedule(const Map& map);
+        emitters::LLVMValue EmitPredictBatchTiles(const Map& map, const std::vector<CompilableNode*>& schedule, emitters::IRFunctionEmitter& function);
+        std::unordered_map<const OutputPortBase*, emitters::LLVMValue> _batchPortValues;
+
+        // Object caching: the key covers everything that determines the generated code, so a cache hit can skip compilation entirely
+        bool IsUsingObjectCache();
+        std::string GetObjectCacheKey(const Map& map);
+        void EmitCachedObjectDeclarations(const emitters::IRObjectCache::CachedObject& object);
+        std::shared_ptr<emitters::IRObjectCache> _objectCache;
+
+        // Parallel branch scheduling: emits each group of independent branches as tasks that run concurrently on the thread pool
+        bool IsSchedulingParallelBranches() const;
+        void EmitParallelBranches(const std::vector<std::vector<const Node*>>& branches);
+        int _numParallelBranchGroups = 0;
+
+        // Port memory planning: records the schedule steps at which each port buffer is used, then packs the
+        // buffers whose live ranges don't overlap into a single shared arena
+        bool IsPlanningPortMemory() const;
+        emitters::LLVMValue EnsurePortVariableEmitted(emitters::Variable& var, const OutputPortBase& port);
+        void EmitPortMemoryPlan();
+
+        struct PortVariableUse
+        {
+            emitters::Variable* variable;
+            int begin;
+            int end;
+            bool canShare;
+        };
+        std::vector<PortVariableUse> _portVariableUses;
+        std::unordered_map<const emitters::Variable*, size_t> _portVariableUseIndex;
+        llvm::Function* _predictFunction = nullptr;
+        int _currentScheduleStep = -1;
+        int _numScheduleSteps = 0;
+        PortMemoryPlan _portMemoryPlan;
+
         // stack of node regions
         std::vector<NodeMap<emitters::IRBlockRegion*>> _nodeRegions;
     };
@@ -201,7 +302,7 @@ namespace model
 
         Log() << "EnsurePortEmitted called for port " << port.GetRuntimeTypeName() << EOL;
         auto pVar = GetOrAllocatePortVariable(port, initialValue);
-        return GetModule().EnsureEmitted(*pVar);
+        return EnsurePortVariableEmitted(*pVar, port);
     }
 } // namespace model
 } // namespace ell
@@ -69,6 +69,11 @@ namespace model
 
         bool ShouldCompileInline() const override { return true; }
         bool HasState() const override { return false; }
+
+        // The batched predict function reads the input's values straight from its `inputs` argument
+        bool CanCompileBatch(IRMapCompiler& compiler) const override { return true; }
+        void CompileBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override {}
+
         void SetShape(const MemoryShape& shape);
         void SetMemoryLayout(const PortMemoryLayout& layout);
         utilities::ArchiveVersion GetArchiveVersion() const override;
@@ -101,6 +106,9 @@ namespace model
         {
         }
 
+        // Sources call back once per sample, from their own code
+        bool CanCompileBatch(IRMapCompiler& compiler) const override { return false; }
+
     private:
         std::string _callbackName;
     };
@@ -139,6 +139,12 @@ namespace model
         virtual void PopScope();
         virtual emitters::ModuleEmitter* GetModuleEmitter() = 0;
 
+        /// <summary> Compiles the nodes of a model, in dependency order. </summary>
+        virtual void CompileNodes(Model& model);
+
+        /// <summary> Checks that a node can be compiled, and compiles it. </summary>
+        void CompileNode(const Node& node);
+
     private:
         enum class ArgType
         {
@@ -148,7 +154,6 @@ namespace model
 
         friend class CompilableNode;
 
-        void CompileNodes(Model& model);
         emitters::Variable* AllocatePortFunctionArgument(emitters::ModuleEmitter& emitter, const OutputPortBase& port, ArgType argType, ell::utilities::UniqueNameList& list);
         emitters::Variable* AllocatePortFunctionArgument(emitters::ModuleEmitter& emitter, const PortElementBase& element, ArgType argType, ell::utilities::UniqueNameList& list);
 
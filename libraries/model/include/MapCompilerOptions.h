@@ -36,6 +36,13 @@ namespace model
         std::string sinkFunctionName;
         bool verifyJittedModule = false;
         bool profile = false;
+        bool reentrant = false; // emit mutable model state into a per-instance block passed via the `context` argument
+        bool planPortMemory = true; // share one arena between intermediate port buffers whose lifetimes don't overlap
+        bool predictBatch = false; // also emit `<predict>Batch(context, count, inputs, outputs)`
+        double parallelBranchCost = 16384; // when parallelizing, run independent branches at least this expensive (in elements touched) as concurrent tasks
+        std::string objectCacheDirectory; // if set, JIT-compiled object code is cached here and reused by later compiles of the same map
+        int objectCacheMaxMegabytes = 1024; // evict the least recently used cached objects when the cache grows past this size
+        bool lazyJit = false; // JIT each node's function on first call (or in the background) and defer IR optimization to the JIT; for maps evaluated in-process, not written out
 
         // per-node options
         bool inlineNodes = false;
@@ -63,6 +63,8 @@ namespace model
         bool ShouldCompileInline() const override { return true; }
         bool HasState() const override { return false; }
         void Compile(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool CanCompileBatch(IRMapCompiler& compiler) const override { return true; }
+        void CompileBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override;
         ell::utilities::ArchiveVersion GetArchiveVersion() const override;
 
         void SetShape(const MemoryShape& shape);
@@ -93,6 +95,9 @@ namespace model
         {
         }
 
+        // Sinks call back once per sample, from their own code
+        bool CanCompileBatch(IRMapCompiler& compiler) const override { return false; }
+
     private:
         std::string _callbackName;
     };
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelBranchScheduler.h (model)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    class Model;
+    class Node;
+
+    /// <summary>
+    /// One step of a parallel branch schedule: either a single node to compile in sequence, or a group of
+    /// independent branches (each a list of nodes in dependency order) that may be run concurrently.
+    /// </summary>
+    struct ParallelScheduleStep
+    {
+        /// <summary> The node to compile, or `nullptr` if this step is a group of parallel branches </summary>
+        const Node* node = nullptr;
+
+        /// <summary> The branches that may run concurrently. Empty if this step is a single node. </summary>
+        std::vector<std::vector<const Node*>> branches;
+
+        /// <summary> Checks if this step is a group of parallel branches </summary>
+        bool IsParallel() const { return node == nullptr; }
+    };
+
+    /// <summary>
+    /// Partitions a model into sequential nodes and groups of independent branches that may be run concurrently.
+    /// A branch is the set of nodes that feed exactly one input of a join node (a node with several parent nodes, or
+    /// the end of the model when it has several sink nodes) and nothing else. Branches cheaper than
+    /// `minimumBranchCost` are left in sequence, and a group is only formed when it has at least two branches worth
+    /// running in parallel. When groups nest, the outermost one wins.
+    /// </summary>
+    ///
+    /// <param name="model"> The model to schedule </param>
+    /// <param name="nodeCost"> A function returning the estimated cost of computing a node </param>
+    /// <param name="minimumBranchCost"> The minimum total cost of a branch worth running as its own task </param>
+    /// <param name="canRunInBranch"> A function returning `false` for nodes that must stay on the main schedule </param>
+    /// <returns> The schedule, which contains every node of the model exactly once, in an order that respects dependencies </returns>
+    std::vector<ParallelScheduleStep> GetParallelBranchSchedule(const Model& model,
+                                                                std::function<double(const Node&)> nodeCost,
+                                                                double minimumBranchCost,
+                                                                std::function<bool(const Node&)> canRunInBranch);
+
+    /// <summary> Estimates the cost of computing a node as the number of input and output elements it touches </summary>
+    ///
+    /// <param name="node"> The node </param>
+    /// <returns> The estimated cost </returns>
+    double GetNodeElementCost(const Node& node);
+} // namespace model
+} // namespace ell
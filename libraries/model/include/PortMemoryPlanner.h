@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PortMemoryPlanner.h (model)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    /// <summary> The size of a buffer and the (inclusive) range of schedule steps during which its contents are live </summary>
+    struct BufferLiveRange
+    {
+        uint64_t size;
+        int begin;
+        int end;
+    };
+
+    /// <summary> The placement of a set of buffers inside a single shared arena </summary>
+    struct PortMemoryPlan
+    {
+        /// <summary> The offset of each buffer in the arena, in the same order as the buffers passed to the planner </summary>
+        std::vector<uint64_t> offsets;
+
+        /// <summary> The size of the arena needed to hold all of the buffers (the planned peak memory) </summary>
+        uint64_t arenaSize = 0;
+
+        /// <summary> The memory needed if every buffer were given its own storage </summary>
+        uint64_t naiveSize = 0;
+    };
+
+    /// <summary>
+    /// Packs buffers into a single arena, letting buffers whose live ranges don't overlap share memory.
+    /// Buffers are placed largest-first, each at the lowest aligned offset that doesn't collide with a
+    /// previously-placed buffer that is live at the same time.
+    /// </summary>
+    ///
+    /// <param name="buffers"> The buffers to place </param>
+    /// <param name="alignment"> The alignment of each buffer's offset, in bytes </param>
+    /// <returns> The placement of the buffers in the arena </returns>
+    PortMemoryPlan PlanPortMemory(const std::vector<BufferLiveRange>& buffers, uint64_t alignment);
+
+    /// <summary> Checks if two buffers are live at the same schedule step </summary>
+    ///
+    /// <param name="a"> The first buffer </param>
+    /// <param name="b"> The second buffer </param>
+    /// <returns> `true` if the live ranges of the buffers overlap </returns>
+    bool LiveRangesOverlap(const BufferLiveRange& a, const BufferLiveRange& b);
+} // namespace model
+} // namespace ell
@@ -12,6 +12,7 @@
 #include "MapCompiler.h"
 
 #include <emitters/include/EmitterException.h>
+#include <emitters/include/IRMetadata.h>
 #include <emitters/include/LLVMUtilities.h>
 
 #include <utilities/include/Logger.h>
@@ -97,6 +98,11 @@ namespace model
                 Log() << "Function " << functionName << " already exists for " << DiagnosticString(*this) << EOL;
             }
 
+            if (moduleEmitter.HasFunction(functionName))
+            {
+                moduleEmitter.InsertFunctionMetadata(functionName, emitters::c_nodeFunctionTagName);
+            }
+
             // Call function for node
             irCompiler->NewNodeRegion(*this);
             CallNodeFunction(*irCompiler, enclosingFunction);
@@ -104,6 +110,58 @@ namespace model
         }
     }
 
+    void CompilableNode::CompileNodeBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        if (CanCompileBatch(compiler))
+        {
+            Log() << "Compiling node " << DiagnosticString(*this) << " for a batch of " << batchSize << " samples" << EOL;
+            CompileBatch(compiler, function, batchSize);
+            return;
+        }
+
+        // Call the node function emitted for the predict function on each sample's slice of the port values
+        Log() << "Calling the function for node " << DiagnosticString(*this) << " once per sample" << EOL;
+        auto nodeFunction = compiler.GetModule().GetFunction(GetCompiledFunctionName());
+        auto getSampleValues = [&compiler](emitters::IRFunctionEmitter& function, const OutputPortBase& port, emitters::IRLocalScalar sample) {
+            auto pValues = compiler.GetBatchPortValues(port);
+            return compiler.IsBatchPortShared(port) ? pValues : function.PointerOffset(pValues, sample * static_cast<int>(port.Size()));
+        };
+        function.For(batchSize, [&, this](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar sample) {
+            std::vector<emitters::LLVMValue> args;
+            for (auto port : GetInputPorts())
+            {
+                args.push_back(getSampleValues(function, port->GetReferencedPort(), sample));
+            }
+
+            auto stateArgs = GetNodeFunctionStateArguments(compiler, function);
+            args.insert(args.end(), stateArgs.begin(), stateArgs.end());
+
+            for (auto port : GetOutputPorts())
+            {
+                args.push_back(getSampleValues(function, *port, sample));
+            }
+            function.Call(nodeFunction, args);
+        });
+    }
+
+    bool CompilableNode::IsBatchCompilable(IRMapCompiler& compiler) const
+    {
+        if (CanCompileBatch(compiler))
+        {
+            return true;
+        }
+
+        // Otherwise, the node must have a function with the usual signature that can be called once per sample
+        if (ShouldCompileInline() || compiler.GetMapCompilerOptions(*this).inlineNodes)
+        {
+            return false;
+        }
+
+        auto nodeFunction = compiler.GetModule().GetFunction(GetCompiledFunctionName());
+        auto numParameters = GetInputPorts().size() + GetNodeFunctionStateParameterList(compiler).size() + GetOutputPorts().size();
+        return nodeFunction != nullptr && nodeFunction->arg_size() == numParameters;
+    }
+
     void CompilableNode::Compile(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -157,6 +215,16 @@ namespace model
         return "";
     }
 
+    bool CompilableNode::CanCompileBatch(IRMapCompiler& compiler) const
+    {
+        return false;
+    }
+
+    void CompilableNode::CompileBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
+    }
+
     std::string CompilableNode::GetInternalStateIdentifier() const
     {
         if (HasState())
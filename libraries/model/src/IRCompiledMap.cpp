@@ -33,10 +33,16 @@ namespace model
         CompiledMap(std::move(other), other._functionName, other._compilerOptions),
         _module(other._module),
         _moduleName(std::move(other._moduleName)),
+        _objectCache(std::move(other._objectCache)),
+        _objectCacheKey(std::move(other._objectCacheKey)),
+        _loadedFromObjectCache(other._loadedFromObjectCache),
         _executionEngine(std::move(other._executionEngine)),
         _verifyJittedModule(other._verifyJittedModule),
+        _context(other._context),
+        _instance(other._instance),
         _computeFunctionDefined(false)
     {
+        other._instance = nullptr;
     }
 
     // private constructor:
@@ -49,6 +55,22 @@ namespace model
     {
     }
 
+    IRCompiledMap::IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule, std::shared_ptr<emitters::IRObjectCache> objectCache, const std::string& objectCacheKey, bool loadedFromObjectCache) :
+        IRCompiledMap(std::move(map), functionName, options, module, verifyJittedModule)
+    {
+        _objectCache = std::move(objectCache);
+        _objectCacheKey = objectCacheKey;
+        _loadedFromObjectCache = loadedFromObjectCache;
+    }
+
+    IRCompiledMap::~IRCompiledMap()
+    {
+        if (_instance != nullptr)
+        {
+            DestroyInstance(_instance);
+        }
+    }
+
     bool IRCompiledMap::IsValid() const
     {
         return _module.IsValid() && !_moduleName.empty();
@@ -62,11 +84,80 @@ namespace model
 
     void IRCompiledMap::EnsureExecutionEngine()
     {
-        if (!_executionEngine)
+        if (!_executionEngine && IsLazilyCompiled())
+        {
+            _executionEngine = std::make_unique<emitters::IRExecutionEngine>(*_module.GetLLVMModule(), _compilerOptions.compilerSettings.optimize, _verifyJittedModule);
+        }
+        else if (!_executionEngine)
         {
             auto moduleClone = std::unique_ptr<llvm::Module>(llvm::CloneModule(_module.GetLLVMModule()));
+            if (_objectCache)
+            {
+                emitters::IRObjectCache::PrepareModule(*moduleClone, _objectCacheKey);
+            }
             _executionEngine = std::make_unique<emitters::IRExecutionEngine>(std::move(moduleClone), _verifyJittedModule);
+            if (_objectCache)
+            {
+                _executionEngine->SetObjectCache(_objectCache.get());
+            }
+        }
+    }
+
+    void* IRCompiledMap::CreateInstance(void* context)
+    {
+        if (!IsReentrant())
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Instances can only be created for reentrant maps");
+        }
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<void* (*)(void*)>(jitter.ResolveFunctionAddress(_moduleName + "_CreateInstance"));
+        return fn(context);
+    }
+
+    void IRCompiledMap::DestroyInstance(void* instance)
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<void (*)(void*)>(jitter.ResolveFunctionAddress(_moduleName + "_DestroyInstance"));
+        fn(instance);
+    }
+
+    void IRCompiledMap::Reset()
+    {
+        Map::Reset();
+        if (!IsReentrant())
+        {
+            auto fn = reinterpret_cast<void (*)()>(GetJitter().ResolveFunctionAddress(_moduleName + "_Reset"));
+            fn();
+        }
+        else if (_instance != nullptr)
+        {
+            // An instance that hasn't been created yet starts out with the initial state anyway
+            Reset(_instance);
+        }
+    }
+
+    void IRCompiledMap::Reset(void* instance)
+    {
+        if (!IsReentrant())
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Only reentrant maps have instances to reset");
+        }
+        auto fn = reinterpret_cast<void (*)(void*)>(GetJitter().ResolveFunctionAddress(_moduleName + "_Reset"));
+        fn(instance);
+    }
+
+    void* IRCompiledMap::GetPredictContext()
+    {
+        if (!IsReentrant())
+        {
+            return GetContext();
+        }
+
+        if (_instance == nullptr)
+        {
+            _instance = CreateInstance(GetContext());
         }
+        return _instance;
     }
 
     void IRCompiledMap::FinishJitting()
@@ -118,7 +209,7 @@ namespace model
             temp[index] = static_cast<bool>(inputValues[index]);
         }
 
-        std::get<ComputeFunction<bool>>(_computeInputFunction)(GetContext(), (bool*)temp.data());
+        std::get<ComputeFunction<bool>>(_computeInputFunction)(GetPredictContext(), (bool*)temp.data());
     }
 
     void IRCompiledMap::SetNodeInput(model::InputNode<int>* node, const std::vector<int>& inputValues)
@@ -130,7 +221,7 @@ namespace model
             throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
         }
 
-        std::get<ComputeFunction<int>>(_computeInputFunction)(GetContext(), inputValues.data());
+        std::get<ComputeFunction<int>>(_computeInputFunction)(GetPredictContext(), inputValues.data());
     }
 
     void IRCompiledMap::SetNodeInput(model::InputNode<int64_t>* node, const std::vector<int64_t>& inputValues)
@@ -142,7 +233,7 @@ namespace model
             throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
         }
 
-        std::get<ComputeFunction<int64_t>>(_computeInputFunction)(GetContext(), inputValues.data());
+        std::get<ComputeFunction<int64_t>>(_computeInputFunction)(GetPredictContext(), inputValues.data());
     }
 
     void IRCompiledMap::SetNodeInput(model::InputNode<float>* node, const std::vector<float>& inputValues)
@@ -154,7 +245,7 @@ namespace model
             throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
         }
 
-        std::get<ComputeFunction<float>>(_computeInputFunction)(GetContext(), inputValues.data());
+        std::get<ComputeFunction<float>>(_computeInputFunction)(GetPredictContext(), inputValues.data());
     }
 
     void IRCompiledMap::SetNodeInput(model::InputNode<double>* node, const std::vector<double>& inputValues)
@@ -169,7 +260,7 @@ namespace model
             throw utilities::InputException(utilities::InputExceptionErrors::nullReference);
         }
 
-        std::get<ComputeFunction<double>>(_computeInputFunction)(GetContext(), inputValues.data());
+        std::get<ComputeFunction<double>>(_computeInputFunction)(GetPredictContext(), inputValues.data());
     }
 
     std::vector<bool> IRCompiledMap::ComputeBoolOutput(const model::PortElementsBase& outputs)
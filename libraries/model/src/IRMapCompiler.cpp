@@ -10,9 +10,12 @@
 #include "CompilableNode.h"
 #include "CompilableNodeUtilities.h"
 #include "IRModelProfiler.h"
+#include "InputNodeBase.h"
 #include "Model.h"
 #include "OptimizeModelTransformation.h"
 #include "OutputNode.h"
+#include "OutputNodeBase.h"
+#include "ParallelBranchScheduler.h"
 #include "RefineTransformation.h"
 
 #include <emitters/include/EmitterException.h>
@@ -20,29 +23,205 @@
 #include <emitters/include/LLVMUtilities.h>
 #include <emitters/include/Variable.h>
 
+#include <utilities/include/Exception.h>
+#include <utilities/include/JsonArchiver.h>
 #include <utilities/include/Logger.h>
 #include <utilities/include/StringUtil.h>
 
 #include <value/include/LLVMContext.h>
 
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <tuple>
 #include <vector>
 
+#ifndef ELL_VERSION
+#define ELL_VERSION "unknown"
+#endif
+
 namespace ell
 {
 namespace model
 {
     using namespace logging;
 
+    namespace
+    {
+        // Layout of a reentrant map's instance block: a header holding the unaligned allocation
+        // (so DestroyInstance can free it), followed by the state variables
+        const uint64_t c_instanceAlignment = 64;
+        const uint64_t c_instanceHeaderSize = 64;
+
+        // Alignment of each port buffer placed in the shared port arena
+        const uint64_t c_portArenaAlignment = 64;
+
+        // The batched predict function computes at most this many samples at a time, with at most this many bytes of intermediate values (unless one sample needs more)
+        const uint64_t c_maxPredictBatchTileSize = 32;
+        const uint64_t c_predictBatchArenaBudget = 4 << 20;
+
+        uint64_t RoundUp(uint64_t value, uint64_t alignment)
+        {
+            return ((value + alignment - 1) / alignment) * alignment;
+        }
+
+        MapCompilerOptions GetEffectiveOptions(MapCompilerOptions settings)
+        {
+            if (settings.reentrant)
+            {
+                // Parallel tasks run on pool threads and reference state globals directly,
+                // so they have no way to find the caller's instance block
+                settings.compilerSettings.parallelize = false;
+            }
+            return settings;
+        }
+
+        llvm::Instruction* GetInsertionPointForUse(llvm::Use& use)
+        {
+            auto instruction = llvm::cast<llvm::Instruction>(use.getUser());
+            if (auto phi = llvm::dyn_cast<llvm::PHINode>(instruction))
+            {
+                return phi->getIncomingBlock(use)->getTerminator();
+            }
+            return instruction;
+        }
+
+        // Turns constant expressions that refer to `value` (e.g., constant GEPs into a global array)
+        // into instructions, so that every remaining use of `value` is an instruction operand
+        void ExpandConstantExpressionUsers(llvm::Constant* value)
+        {
+            std::vector<llvm::User*> users(value->user_begin(), value->user_end());
+            for (auto user : users)
+            {
+                auto expression = llvm::dyn_cast<llvm::ConstantExpr>(user);
+                if (expression == nullptr)
+                {
+                    if (!llvm::isa<llvm::Instruction>(user))
+                    {
+                        throw emitters::EmitterException(emitters::EmitterError::notSupported, "Model state referenced from a constant initializer can't be moved into an instance block");
+                    }
+                    continue;
+                }
+
+                ExpandConstantExpressionUsers(expression);
+                std::vector<llvm::Use*> uses;
+                for (auto& use : expression->uses())
+                {
+                    uses.push_back(&use);
+                }
+                for (auto use : uses)
+                {
+                    auto instruction = expression->getAsInstruction();
+                    instruction->insertBefore(GetInsertionPointForUse(*use));
+                    use->set(instruction);
+                }
+                expression->destroyConstant();
+            }
+        }
+
+        // Returns true if memory reachable from `pointer` may be modified or escapes somewhere we can't see
+        bool MayBeWrittenThrough(llvm::Value* pointer)
+        {
+            for (auto user : pointer->users())
+            {
+                if (llvm::isa<llvm::LoadInst>(user))
+                {
+                    continue;
+                }
+                if (llvm::isa<llvm::GetElementPtrInst>(user) || llvm::isa<llvm::BitCastInst>(user))
+                {
+                    if (MayBeWrittenThrough(user))
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+                if (auto copy = llvm::dyn_cast<llvm::MemTransferInst>(user))
+                {
+                    if (copy->getRawDest() != pointer)
+                    {
+                        continue;
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // Replaces `function` with a copy that takes the instance block as an extra first parameter
+        llvm::Function* AddInstanceParameter(llvm::Function* function)
+        {
+            auto& context = function->getContext();
+            std::vector<llvm::Type*> parameterTypes = { llvm::Type::getInt8PtrTy(context) };
+            std::vector<llvm::AttributeSet> parameterAttributes = { llvm::AttributeSet() };
+            const auto& attributes = function->getAttributes();
+            for (auto& argument : function->args())
+            {
+                parameterTypes.push_back(argument.getType());
+                parameterAttributes.push_back(attributes.getParamAttributes(argument.getArgNo()));
+            }
+
+            auto functionType = llvm::FunctionType::get(function->getReturnType(), parameterTypes, function->isVarArg());
+            auto newFunction = llvm::Function::Create(functionType, function->getLinkage(), "", function->getParent());
+            newFunction->takeName(function);
+            newFunction->setCallingConv(function->getCallingConv());
+            newFunction->setAttributes(llvm::AttributeList::get(context, attributes.getFnAttributes(), attributes.getRetAttributes(), parameterAttributes));
+
+            llvm::SmallVector<std::pair<unsigned, llvm::MDNode*>, 4> metadata;
+            function->getAllMetadata(metadata);
+            for (const auto& entry : metadata)
+            {
+                newFunction->setMetadata(entry.first, entry.second);
+            }
+
+            newFunction->getBasicBlockList().splice(newFunction->begin(), function->getBasicBlockList());
+            auto newArgument = newFunction->arg_begin();
+            newArgument->setName("instance");
+            ++newArgument;
+            for (auto& argument : function->args())
+            {
+                argument.replaceAllUsesWith(&*newArgument);
+                newArgument->takeName(&argument);
+                ++newArgument;
+            }
+            return newFunction;
+        }
+
+        bool IsOnlyUsedInFunction(const llvm::Value* value, const llvm::Function* function)
+        {
+            for (auto user : value->users())
+            {
+                if (auto inst = llvm::dyn_cast<llvm::Instruction>(user))
+                {
+                    if (inst->getFunction() != function)
+                    {
+                        return false;
+                    }
+                }
+                else if (!llvm::isa<llvm::ConstantExpr>(user) || !IsOnlyUsedInFunction(user, function))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
     IRMapCompiler::IRMapCompiler() :
         IRMapCompiler(MapCompilerOptions{}, ModelOptimizerOptions{})
     {
     }
 
     IRMapCompiler::IRMapCompiler(const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions) :
-        MapCompiler(settings, optimizerOptions),
-        _moduleEmitter(settings.moduleName, settings.compilerSettings),
+        MapCompiler(GetEffectiveOptions(settings), optimizerOptions),
+        _moduleEmitter(settings.moduleName, GetEffectiveOptions(settings).compilerSettings),
         _profiler()
     {
         Log() << "Initializing IR map compiler" << EOL;
@@ -69,6 +248,25 @@ namespace model
     {
         Log() << "Compile called for map" << EOL;
 
+        // Check the options before looking in the object cache, so a cached map can't hide an unsupported combination
+        if (GetMapCompilerOptions().reentrant && GetMapCompilerOptions().profile)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Profiling isn't supported for reentrant maps");
+        }
+
+        std::string objectCacheKey;
+        if (IsUsingObjectCache())
+        {
+            objectCacheKey = GetObjectCacheKey(map);
+            emitters::IRObjectCache::CachedObject cachedObject;
+            if (_objectCache->TryLoad(objectCacheKey, cachedObject))
+            {
+                Log() << "Found compiled map in object cache" << EOL;
+                EmitCachedObjectDeclarations(cachedObject);
+                return IRCompiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, GetMapCompilerOptions().verifyJittedModule, _objectCache, objectCacheKey, true);
+            }
+        }
+
         RefineAndOptimize(map);
 
         // Renaming callbacks based on map compiler parameters
@@ -91,13 +289,34 @@ namespace model
 
             // Now we have the refined map, compile it
             Log() << "Compiling map..." << EOL;
+            auto sharedGlobals = GetGlobalVariables();
             CompileMap(map, GetPredictFunctionName());
+
+            if (IsPlanningPortMemory())
+            {
+                Log() << "Packing port buffers into shared arena..." << EOL;
+                EmitPortMemoryPlan();
+            }
+
+            // The batched predict function calls node functions, so it's emitted before they get a reentrant map's instance parameter
+            if (GetMapCompilerOptions().predictBatch)
+            {
+                Log() << "Emitting batched predict function..." << EOL;
+                EmitPredictBatchFunction(map);
+            }
+
+            if (GetMapCompilerOptions().reentrant)
+            {
+                Log() << "Moving model state into instance block..." << EOL;
+                EmitInstanceState(sharedGlobals);
+            }
         }
 
         // Emit runtime model APIs
         EmitModelAPIFunctions(map);
 
-        if (GetMapCompilerOptions().compilerSettings.optimize)
+        // With lazy JIT compilation, the execution engine optimizes each node's function when it compiles it
+        if (GetMapCompilerOptions().compilerSettings.optimize && !GetMapCompilerOptions().lazyJit)
         {
             // Save callback declarations in case they get optimized away
             std::vector<std::tuple<std::string, llvm::FunctionType*, std::vector<std::string>>> savedCallbacks;
@@ -120,7 +339,58 @@ namespace model
             }
         }
 
-        return IRCompiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, GetMapCompilerOptions().verifyJittedModule);
+        return IRCompiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, GetMapCompilerOptions().verifyJittedModule, _objectCache, objectCacheKey, false);
+    }
+
+    bool IRMapCompiler::IsUsingObjectCache()
+    {
+        // Lazily-compiled code refers to the execution engine's function table by address, so it can't be cached
+        if (!_objectCache && !GetMapCompilerOptions().objectCacheDirectory.empty() && !GetMapCompilerOptions().lazyJit)
+        {
+            const uint64_t megabyte = 1024 * 1024;
+            _objectCache = std::make_shared<emitters::IRObjectCache>(GetMapCompilerOptions().objectCacheDirectory, GetMapCompilerOptions().objectCacheMaxMegabytes * megabyte);
+        }
+        return _objectCache != nullptr;
+    }
+
+    std::string IRMapCompiler::GetObjectCacheKey(const Map& map)
+    {
+        std::stringstream description;
+        description << "ELL " << ELL_VERSION << "\n";
+
+        // The model, including the per-node options stored in its metadata, and the options used to optimize it
+        utilities::JsonArchiver archiver(description);
+        archiver << map;
+        archiver << GetModelOptimizerOptions().AsPropertyBag();
+
+        // The compiler options, with the target device as it was completed for this module (so "host" includes the CPU)
+        const auto& options = GetMapCompilerOptions();
+        const auto& settings = options.compilerSettings;
+        const auto& device = GetModule().GetCompilerOptions().targetDevice;
+        description << "\n"
+                    << options.moduleName << " " << options.mapFunctionName << " " << options.sourceFunctionName << " " << options.sinkFunctionName << " "
+                    << options.profile << options.reentrant << options.planPortMemory << options.predictBatch << options.inlineNodes << " " << options.parallelBranchCost << "\n"
+                    << settings.optimize << static_cast<int>(settings.blasType) << settings.positionIndependentCode.HasValue() << settings.positionIndependentCode.GetValue(false)
+                    << settings.profile << settings.parallelize << settings.useThreadPool << settings.useFastMath << static_cast<int>(settings.mathFunctions) << settings.includeDiagnosticInfo
+                    << settings.useBlas << settings.unrollLoops << settings.inlineOperators << settings.allowVectorInstructions << settings.debug << " "
+                    << settings.maxThreads << " " << settings.vectorWidth << " " << settings.optimizerThreads << "\n"
+                    << device.deviceName << " " << device.triple << " " << device.architecture << " " << device.dataLayout << " "
+                    << device.cpu << " " << device.features << " " << device.numBits << "\n";
+        return emitters::IRObjectCache::GetKey(description.str());
+    }
+
+    void IRMapCompiler::EmitCachedObjectDeclarations(const emitters::IRObjectCache::CachedObject& object)
+    {
+        // The cached object code replaces this module when it's jitted; it just needs to run the same initializers
+        auto& module = GetModule();
+        for (const auto& constructor : object.constructors)
+        {
+            module.AddInitializationFunction(module.DeclareFunction(constructor.functionName, emitters::VariableType::Void), constructor.priority);
+        }
+        for (const auto& destructor : object.destructors)
+        {
+            module.AddFinalizationFunction(module.DeclareFunction(destructor.functionName, emitters::VariableType::Void), destructor.priority);
+        }
     }
 
     void IRMapCompiler::RefineAndOptimize(Map& map)
@@ -136,6 +406,555 @@ namespace model
         map.Prune();
     }
 
+    std::unordered_set<const llvm::GlobalVariable*> IRMapCompiler::GetGlobalVariables() const
+    {
+        std::unordered_set<const llvm::GlobalVariable*> result;
+        for (const auto& global : GetModule().GetLLVMModule()->globals())
+        {
+            result.insert(&global);
+        }
+        return result;
+    }
+
+    // Every non-constant global the map's code writes to (port buffers, node state, and the
+    // callback context pointer) is given an offset in an instance block. The predict function's
+    // `context` argument then points at that block, and each function that touches state gets
+    // the block as an extra first parameter. Globals that are never written become constants
+    // and stay shared between instances.
+    void IRMapCompiler::EmitInstanceState(const std::unordered_set<const llvm::GlobalVariable*>& sharedGlobals)
+    {
+        auto module = _moduleEmitter.GetLLVMModule();
+        auto predictFunction = module->getFunction(GetPredictFunctionName());
+        auto predictInstance = &*predictFunction->arg_begin();
+        auto contextGlobal = module->getNamedGlobal(GetNamespacePrefix() + "_context");
+
+        // The callback context now lives in the instance block and is set once, by CreateInstance
+        std::vector<llvm::User*> contextUsers(contextGlobal->user_begin(), contextGlobal->user_end());
+        for (auto user : contextUsers)
+        {
+            auto store = llvm::dyn_cast<llvm::StoreInst>(user);
+            if (store != nullptr && store->getFunction() == predictFunction && store->getValueOperand() == predictInstance)
+            {
+                store->eraseFromParent();
+            }
+        }
+
+        std::vector<llvm::GlobalVariable*> stateGlobals;
+        for (auto& global : module->globals())
+        {
+            if (sharedGlobals.count(&global) == 0 && !global.isConstant() && global.hasInitializer())
+            {
+                ExpandConstantExpressionUsers(&global);
+                if (&global == contextGlobal || MayBeWrittenThrough(&global))
+                {
+                    stateGlobals.push_back(&global);
+                }
+                else
+                {
+                    global.setConstant(true);
+                }
+            }
+        }
+
+        const auto& dataLayout = module->getDataLayout();
+        std::vector<uint64_t> offsets;
+        uint64_t instanceSize = c_instanceHeaderSize;
+        for (auto global : stateGlobals)
+        {
+            auto alignment = std::min<uint64_t>(c_instanceAlignment, std::max<uint64_t>(16, dataLayout.getPrefTypeAlignment(global->getValueType())));
+            instanceSize = RoundUp(instanceSize, alignment);
+            offsets.push_back(instanceSize);
+            instanceSize += dataLayout.getTypeAllocSize(global->getValueType());
+        }
+        Log() << "Instance block holds " << stateGlobals.size() << " variables in " << instanceSize << " bytes" << EOL;
+
+        // Find every function that needs the instance block: the ones that touch state, the
+        // public Reset function, and, transitively, their callers
+        auto resetFunction = module->getFunction(GetNamespacePrefix() + "_Reset");
+        std::vector<llvm::Function*> functions = { resetFunction };
+        std::unordered_set<llvm::Function*> visited = { predictFunction, resetFunction };
+        std::map<llvm::Function*, llvm::Value*> instanceArguments = { { predictFunction, predictInstance } };
+
+        // Like the predict function, the batched predict function already takes the instance as its `context` argument
+        auto batchFunction = module->getFunction(GetPredictFunctionName() + "Batch");
+        if (batchFunction != nullptr)
+        {
+            visited.insert(batchFunction);
+            instanceArguments[batchFunction] = &*batchFunction->arg_begin();
+        }
+        for (auto global : stateGlobals)
+        {
+            for (auto user : global->users())
+            {
+                auto function = llvm::cast<llvm::Instruction>(user)->getFunction();
+                if (visited.insert(function).second)
+                {
+                    functions.push_back(function);
+                }
+            }
+        }
+        for (size_t index = 0; index < functions.size(); ++index)
+        {
+            auto function = functions[index];
+            for (auto user : function->users())
+            {
+                auto call = llvm::dyn_cast<llvm::CallInst>(user);
+                if (call == nullptr || call->getCalledFunction() != function)
+                {
+                    throw emitters::EmitterException(emitters::EmitterError::notSupported, "Function " + function->getName().str() + " uses model state but isn't called directly, so it can't be made reentrant");
+                }
+                if (visited.insert(call->getFunction()).second)
+                {
+                    functions.push_back(call->getFunction());
+                }
+            }
+        }
+
+        std::vector<std::pair<llvm::Function*, llvm::Function*>> replacedFunctions;
+        for (auto function : functions)
+        {
+            auto newFunction = AddInstanceParameter(function);
+            instanceArguments[newFunction] = &*newFunction->arg_begin();
+            replacedFunctions.emplace_back(function, newFunction);
+        }
+        for (const auto& entry : replacedFunctions)
+        {
+            std::vector<llvm::User*> calls(entry.first->user_begin(), entry.first->user_end());
+            for (auto user : calls)
+            {
+                auto call = llvm::cast<llvm::CallInst>(user);
+                std::vector<llvm::Value*> arguments = { instanceArguments.at(call->getFunction()) };
+                arguments.insert(arguments.end(), call->arg_operands().begin(), call->arg_operands().end());
+                auto newCall = llvm::CallInst::Create(entry.second, arguments, "", call);
+                newCall->setCallingConv(call->getCallingConv());
+                call->replaceAllUsesWith(newCall);
+                newCall->takeName(call);
+                call->eraseFromParent();
+            }
+            entry.first->eraseFromParent();
+        }
+        _moduleEmitter.GetFunctionDeclaration(GetNamespacePrefix() + "_Reset") = { GetNamespacePrefix() + "_Reset", emitters::VariableType::Void, { { "instance", emitters::VariableType::VoidPointer } } };
+
+        // Point every use of a state global at its slot in the instance block. The globals themselves
+        // are left behind, unwritten, as the initial image CreateInstance copies into a new block.
+        for (size_t index = 0; index < stateGlobals.size(); ++index)
+        {
+            auto global = stateGlobals[index];
+            std::vector<llvm::Use*> uses;
+            for (auto& use : global->uses())
+            {
+                uses.push_back(&use);
+            }
+            for (auto use : uses)
+            {
+                auto instance = instanceArguments.at(llvm::cast<llvm::Instruction>(use->getUser())->getFunction());
+                llvm::IRBuilder<> builder(GetInsertionPointForUse(*use));
+                auto address = builder.CreateConstInBoundsGEP1_64(instance, offsets[index]);
+                use->set(builder.CreatePointerCast(address, global->getType()));
+            }
+            global->setConstant(true);
+        }
+
+        EmitCreateInstanceFunction(stateGlobals, offsets, instanceSize);
+        EmitDestroyInstanceFunction();
+    }
+
+    void IRMapCompiler::EmitCreateInstanceFunction(const std::vector<llvm::GlobalVariable*>& stateGlobals, const std::vector<uint64_t>& offsets, uint64_t instanceSize)
+    {
+        const emitters::NamedVariableTypeList parameters = { { "context", emitters::VariableType::VoidPointer } };
+        auto& function = _moduleEmitter.BeginFunction(GetNamespacePrefix() + "_CreateInstance", emitters::VariableType::VoidPointer, parameters);
+        function.IncludeInHeader();
+
+        auto allocation = function.Malloc(emitters::VariableType::BytePointer, static_cast<int64_t>(instanceSize + c_instanceAlignment - 1));
+        auto address = function.CastPointerToInt(allocation, emitters::VariableType::Int64);
+        address = function.Operator(emitters::TypedOperator::add, address, function.Literal<int64_t>(c_instanceAlignment - 1));
+        address = function.Operator(emitters::TypedOperator::logicalAnd, address, function.Literal<int64_t>(~static_cast<int64_t>(c_instanceAlignment - 1)));
+        auto instance = function.CastIntToPointer(address, emitters::VariableType::BytePointer);
+        function.Store(function.CastPointer(instance, allocation->getType()->getPointerTo()), allocation);
+
+        auto contextGlobal = _moduleEmitter.GetLLVMModule()->getNamedGlobal(GetNamespacePrefix() + "_context");
+        const auto& dataLayout = _moduleEmitter.GetLLVMModule()->getDataLayout();
+        for (size_t index = 0; index < stateGlobals.size(); ++index)
+        {
+            auto global = stateGlobals[index];
+            auto slot = function.PointerOffset(instance, static_cast<int>(offsets[index]));
+            if (global == contextGlobal)
+            {
+                function.Store(function.CastPointer(slot, global->getType()), function.GetFunctionArgument("context"));
+            }
+            else
+            {
+                auto size = static_cast<int>(dataLayout.getTypeAllocSize(global->getValueType()));
+                function.MemoryCopy<uint8_t>(function.CastPointer(global, emitters::VariableType::BytePointer), slot, size);
+            }
+        }
+        function.Return(instance);
+        _moduleEmitter.EndFunction();
+    }
+
+    void IRMapCompiler::EmitDestroyInstanceFunction()
+    {
+        const emitters::NamedVariableTypeList parameters = { { "instance", emitters::VariableType::VoidPointer } };
+        auto& function = _moduleEmitter.BeginFunction(GetNamespacePrefix() + "_DestroyInstance", emitters::VariableType::Void, parameters);
+        function.IncludeInHeader();
+
+        auto instance = function.GetFunctionArgument("instance");
+        function.If(function.Comparison(emitters::TypedComparison::notEquals, instance, function.NullPointer(llvm::cast<llvm::PointerType>(instance->getType()))), [instance](emitters::IRFunctionEmitter& function) {
+            auto bytePointerType = function.GetEmitter().Type(emitters::VariableType::BytePointer);
+            function.Free(function.Load(function.CastPointer(instance, bytePointerType->getPointerTo())));
+        });
+        _moduleEmitter.EndFunction();
+    }
+
+    void IRMapCompiler::EmitPredictBatchFunction(const Map& map)
+    {
+        if (map.NumInputs() != 1 || map.NumOutputs() != 1)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "A batched predict function can only be emitted for maps with one input and one output");
+        }
+
+        // The batched function has the predict function's signature, plus a sample count
+        auto predictFunctionName = GetPredictFunctionName();
+        auto predictArguments = _moduleEmitter.GetFunctionDeclaration(predictFunctionName).GetArguments();
+        const emitters::NamedVariableTypeList parameters = {
+            { "context", predictArguments[0].second },
+            { "count", emitters::VariableType::Int32 },
+            { "inputs", predictArguments[1].second },
+            { "outputs", predictArguments[2].second }
+        };
+
+        auto batchFunctionName = predictFunctionName + "Batch";
+        auto& function = _moduleEmitter.BeginFunction(batchFunctionName, emitters::VariableType::Void, parameters);
+        function.IncludeInHeader();
+        _moduleEmitter.GetFunctionDeclaration(batchFunctionName).GetComments() = {
+            "Evaluates " + predictFunctionName + " on 'count' samples in order; inputs and outputs are stored one sample after another",
+            "Input size: " + std::to_string(map.GetInput(0)->Size()) + " per sample, output size: " + std::to_string(map.GetOutput(0).Size()) + " per sample"
+        };
+
+        // Like the predict function, publish the context for callbacks. A reentrant map's callback context lives in the instance block instead.
+        auto context = function.GetFunctionArgument("context");
+        if (!GetMapCompilerOptions().reentrant)
+        {
+            function.Store(_moduleEmitter.GlobalPointer(GetNamespacePrefix() + "_context", emitters::VariableType::Byte), context);
+        }
+
+        emitters::LLVMValue numBatchedSamples = function.Literal<int>(0);
+        auto schedule = GetPredictBatchSchedule(map);
+        if (!schedule.empty())
+        {
+            numBatchedSamples = EmitPredictBatchTiles(map, schedule, function);
+        }
+
+        // The samples after the last full tile, or all of them if some node can't be compiled into this function, run through the predict function one at a time
+        const int inputSize = static_cast<int>(map.GetInput(0)->Size());
+        const int outputSize = static_cast<int>(map.GetOutput(0).Size());
+        auto inputs = function.GetFunctionArgument("inputs");
+        auto outputs = function.GetFunctionArgument("outputs");
+        function.For(numBatchedSamples, function.GetFunctionArgument("count"), [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar sample) {
+            auto input = function.PointerOffset(inputs, sample * inputSize);
+            auto output = function.PointerOffset(outputs, sample * outputSize);
+            function.Call(predictFunctionName, { context, input, output });
+        });
+        _moduleEmitter.EndFunction();
+    }
+
+    std::vector<CompilableNode*> IRMapCompiler::GetPredictBatchSchedule(const Map& map)
+    {
+        std::vector<CompilableNode*> schedule;
+        bool canBatch = true;
+        map.GetModel().Visit([this, &map, &schedule, &canBatch](const Node& node) {
+            // Constants are read straight from their globals
+            const auto& outputs = node.GetOutputPorts();
+            if (!outputs.empty() && std::all_of(outputs.begin(), outputs.end(), [this](const OutputPortBase* port) { return IsBatchPortShared(*port); }))
+            {
+                return;
+            }
+
+            auto compilableNode = const_cast<CompilableNode*>(dynamic_cast<const CompilableNode*>(&node));
+            bool isOtherInput = dynamic_cast<const InputNodeBase*>(&node) != nullptr && &node != map.GetInput(0);
+            if (compilableNode == nullptr || isOtherInput || !compilableNode->IsBatchCompilable(*this))
+            {
+                Log() << "Node " << DiagnosticString(node) << " can't be compiled into the batched predict function" << EOL;
+                canBatch = false;
+                return;
+            }
+
+            // The batch's buffers start out zeroed, so ports that rely on other initial values (padding, for instance) can't use them
+            for (auto port : outputs)
+            {
+                auto pVar = GetVariableForPort(*port);
+                auto pGlobal = pVar != nullptr && pVar->IsGlobal() ? GetModule().GetLLVMModule()->getNamedGlobal(pVar->EmittedName()) : nullptr;
+                if (pGlobal != nullptr && pGlobal->hasInitializer() && !pGlobal->getInitializer()->isNullValue())
+                {
+                    Log() << "Output of node " << DiagnosticString(node) << " has initial values, so it can't be compiled into the batched predict function" << EOL;
+                    canBatch = false;
+                }
+            }
+            schedule.push_back(compilableNode);
+        });
+
+        if (!canBatch)
+        {
+            return {};
+        }
+        return schedule;
+    }
+
+    emitters::LLVMValue IRMapCompiler::EmitPredictBatchTiles(const Map& map, const std::vector<CompilableNode*>& schedule, emitters::IRFunctionEmitter& function)
+    {
+        // The input and output ports are bound to the function's arguments. Every other port gets a buffer in the arena, live from the node
+        // that writes it to the last node that reads it.
+        const auto& inputPort = map.GetInput(0)->GetOutputPort();
+        const auto& outputPort = *map.GetOutput(0).GetRanges()[0].ReferencedPort();
+        std::unordered_map<const OutputPortBase*, int> lastUses;
+        for (int step = 0; step < static_cast<int>(schedule.size()); ++step)
+        {
+            for (auto input : schedule[step]->GetInputPorts())
+            {
+                lastUses[&input->GetReferencedPort()] = step;
+            }
+        }
+
+        std::vector<const OutputPortBase*> ports;
+        std::vector<BufferLiveRange> buffers;
+        for (int step = 0; step < static_cast<int>(schedule.size()); ++step)
+        {
+            for (auto port : schedule[step]->GetOutputPorts())
+            {
+                if (port == &inputPort || port == &outputPort || IsBatchPortShared(*port))
+                {
+                    continue;
+                }
+
+                // Padding is never written, so padded buffers keep memory of their own, which stays zeroed
+                auto lastUse = lastUses.find(port);
+                BufferLiveRange buffer = { port->Size() * _moduleEmitter.GetIREmitter().SizeOf(PortTypeToVariableType(port->GetType())), step, lastUse == lastUses.end() ? step : lastUse->second };
+                if (port->GetMemoryLayout().HasPadding())
+                {
+                    buffer.begin = 0;
+                    buffer.end = static_cast<int>(schedule.size());
+                }
+                ports.push_back(port);
+                buffers.push_back(buffer);
+            }
+        }
+
+        // Compute as many samples at a time as keeps the tile's intermediate values within budget
+        auto samplePlan = PlanPortMemory(buffers, c_portArenaAlignment);
+        const int tileSize = static_cast<int>(std::max<uint64_t>(1, std::min<uint64_t>(c_maxPredictBatchTileSize, c_predictBatchArenaBudget / std::max<uint64_t>(1, samplePlan.arenaSize))));
+        for (auto& buffer : buffers)
+        {
+            buffer.size *= tileSize;
+        }
+        auto plan = PlanPortMemory(buffers, c_portArenaAlignment);
+        Log() << "Batched predict function computes " << tileSize << " samples at a time, with " << plan.arenaSize << " bytes of intermediate values" << EOL;
+
+        const int inputSize = static_cast<int>(inputPort.Size());
+        const int outputSize = static_cast<int>(outputPort.Size());
+        auto inputs = function.GetFunctionArgument("inputs");
+        auto outputs = function.GetFunctionArgument("outputs");
+        auto numTiles = function.LocalScalar(function.GetFunctionArgument("count")) / tileSize;
+        function.If(emitters::TypedComparison::greaterThan, numTiles, function.Literal<int>(0), [&](emitters::IRFunctionEmitter& function) {
+            auto pArena = function.Malloc(emitters::VariableType::BytePointer, static_cast<int64_t>(std::max<uint64_t>(1, plan.arenaSize)));
+            function.MemorySet<uint8_t>(pArena, 0, function.Literal<uint8_t>(0), static_cast<int>(plan.arenaSize));
+            for (size_t index = 0; index < ports.size(); ++index)
+            {
+                auto pointerType = emitters::GetPointerType(PortTypeToVariableType(ports[index]->GetType()));
+                _batchPortValues[ports[index]] = function.CastPointer(function.PointerOffset(pArena, static_cast<int>(plan.offsets[index])), pointerType);
+            }
+
+            function.For(numTiles, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tile) {
+                _batchPortValues[&inputPort] = function.PointerOffset(inputs, tile * (tileSize * inputSize));
+                _batchPortValues[&outputPort] = function.PointerOffset(outputs, tile * (tileSize * outputSize));
+                for (auto node : schedule)
+                {
+                    node->CompileNodeBatch(*this, function, tileSize);
+                }
+            });
+            function.Free(pArena);
+        });
+        _batchPortValues.clear();
+
+        return numTiles * tileSize;
+    }
+
+    bool IRMapCompiler::IsSchedulingParallelBranches() const
+    {
+        // Branch functions can't see a reentrant map's instance block, and the profiler only instruments the predict function
+        const auto& options = GetMapCompilerOptions();
+        return options.compilerSettings.parallelize && !options.reentrant && !options.profile;
+    }
+
+    void IRMapCompiler::CompileNodes(Model& model)
+    {
+        if (!IsSchedulingParallelBranches())
+        {
+            MapCompiler::CompileNodes(model);
+            return;
+        }
+
+        // Input and output nodes read and write the predict function's arguments directly, so they stay on the main schedule
+        auto canRunInBranch = [](const Node& node) {
+            return dynamic_cast<const InputNodeBase*>(&node) == nullptr && dynamic_cast<const OutputNodeBase*>(&node) == nullptr;
+        };
+        auto schedule = GetParallelBranchSchedule(model, GetNodeElementCost, GetMapCompilerOptions().parallelBranchCost, canRunInBranch);
+        for (const auto& step : schedule)
+        {
+            if (step.IsParallel())
+            {
+                EmitParallelBranches(step.branches);
+            }
+            else
+            {
+                CompileNode(*step.node);
+            }
+        }
+    }
+
+    void IRMapCompiler::EmitParallelBranches(const std::vector<std::vector<const Node*>>& branches)
+    {
+        auto& module = GetModule();
+        auto predictFunctionName = GetPredictFunctionName();
+        auto predictArguments = module.GetFunctionDeclaration(predictFunctionName).GetArguments();
+        auto groupFunctionName = predictFunctionName + "_ParallelBranches" + std::to_string(_numParallelBranchGroups++);
+        Log() << "Emitting " << branches.size() << " parallel branches in " << groupFunctionName << EOL;
+
+        // Each branch gets its own function with the predict function's signature, so port variables
+        // that live in the predict function's arguments resolve the same way inside the branch
+        std::vector<std::string> branchFunctionNames;
+        for (const auto& branch : branches)
+        {
+            auto branchFunctionName = groupFunctionName + "_Branch" + std::to_string(branchFunctionNames.size());
+            module.BeginFunction(branchFunctionName, emitters::VariableType::Void, predictArguments);
+            _nodeRegions.emplace_back();
+            for (auto node : branch)
+            {
+                CompileNode(*node);
+            }
+            _nodeRegions.pop_back();
+            module.EndFunction();
+            branchFunctionNames.push_back(branchFunctionName);
+        }
+
+        // The task function runs the branch selected by its last argument
+        auto taskParameters = predictArguments;
+        taskParameters.push_back({ "branchIndex", emitters::VariableType::Int32 });
+        auto& taskFunction = module.BeginFunction(groupFunctionName, emitters::VariableType::Void, taskParameters);
+        {
+            std::vector<emitters::LLVMValue> arguments;
+            for (const auto& argument : predictArguments)
+            {
+                arguments.push_back(taskFunction.GetFunctionArgument(argument.first));
+            }
+            auto branchIndex = taskFunction.LocalScalar(taskFunction.GetFunctionArgument("branchIndex"));
+            for (size_t index = 0; index < branchFunctionNames.size(); ++index)
+            {
+                auto branchFunctionName = branchFunctionNames[index];
+                taskFunction.If(branchIndex == static_cast<int>(index), [branchFunctionName, arguments](emitters::IRFunctionEmitter& function) {
+                    function.Call(branchFunctionName, arguments);
+                });
+            }
+        }
+        module.EndFunction();
+
+        // Start the branches from their own region of the predict function and wait for all of them before continuing
+        auto& function = module.GetCurrentFunction();
+        auto pBlock = function.Block(groupFunctionName);
+        function.SetCurrentBlock(pBlock);
+        auto pRegion = function.AddRegion(pBlock);
+
+        std::vector<std::vector<emitters::LLVMValue>> taskArguments;
+        for (size_t index = 0; index < branches.size(); ++index)
+        {
+            std::vector<emitters::LLVMValue> arguments;
+            for (const auto& argument : predictArguments)
+            {
+                arguments.push_back(function.GetFunctionArgument(argument.first));
+            }
+            arguments.push_back(function.Literal<int>(static_cast<int>(index)));
+            taskArguments.push_back(arguments);
+        }
+        auto tasks = function.StartTasks(module.GetFunction(groupFunctionName), taskArguments);
+        tasks.WaitAll(function);
+        pRegion->SetEnd(function.GetCurrentBlock());
+    }
+
+    bool IRMapCompiler::IsPlanningPortMemory() const
+    {
+        return GetMapCompilerOptions().planPortMemory;
+    }
+
+    emitters::LLVMValue IRMapCompiler::EnsurePortVariableEmitted(emitters::Variable& var, const OutputPortBase& port)
+    {
+        auto pValue = GetModule().EnsureEmitted(var);
+        if (!IsPlanningPortMemory() || var.Scope() != emitters::VariableScope::global)
+        {
+            return pValue;
+        }
+
+        auto entry = _portVariableUseIndex.emplace(&var, _portVariableUses.size());
+        if (entry.second)
+        {
+            _portVariableUses.push_back({ &var, _currentScheduleStep, _currentScheduleStep, true });
+        }
+
+        // Buffers touched outside of the node schedule, or whose padding must keep its initial value, keep their own storage
+        auto& use = _portVariableUses[entry.first->second];
+        use.end = std::max(use.end, _currentScheduleStep);
+        bool inSchedule = _currentScheduleStep >= 0 && GetModule().GetCurrentFunction().GetFunction() == _predictFunction;
+        if (!inSchedule || port.GetMemoryLayout().HasPadding())
+        {
+            use.canShare = false;
+        }
+        return pValue;
+    }
+
+    void IRMapCompiler::EmitPortMemoryPlan()
+    {
+        auto& module = GetModule();
+        const auto& dataLayout = module.GetTargetDataLayout();
+
+        std::vector<emitters::Variable*> variables;
+        std::vector<llvm::Type*> types;
+        std::vector<BufferLiveRange> buffers;
+        for (const auto& use : _portVariableUses)
+        {
+            if (!use.canShare)
+            {
+                continue;
+            }
+
+            // Only plain zero-initialized buffers that live entirely inside the predict function can be moved into the arena
+            auto pGlobal = llvm::dyn_cast<llvm::GlobalVariable>(module.EnsureEmitted(*use.variable));
+            if (pGlobal == nullptr || pGlobal->isConstant() || !pGlobal->hasInitializer() || !pGlobal->getInitializer()->isNullValue() || !IsOnlyUsedInFunction(pGlobal, _predictFunction))
+            {
+                continue;
+            }
+
+            variables.push_back(use.variable);
+            types.push_back(pGlobal->getType());
+            buffers.push_back({ dataLayout.getTypeAllocSize(pGlobal->getValueType()), use.begin, use.end });
+        }
+
+        _portMemoryPlan = PlanPortMemory(buffers, c_portArenaAlignment);
+        Log() << "Port memory plan: " << buffers.size() << " buffers, planned peak " << _portMemoryPlan.arenaSize << " bytes, naive " << _portMemoryPlan.naiveSize << " bytes" << EOL;
+        if (buffers.empty())
+        {
+            return;
+        }
+
+        auto pArena = module.GlobalArray(emitters::VariableType::Byte, GetNamespacePrefix() + "_PortArena", _portMemoryPlan.arenaSize);
+        pArena->setAlignment(c_portArenaAlignment);
+
+        auto int64Type = llvm::Type::getInt64Ty(GetLLVMContext());
+        for (size_t index = 0; index < buffers.size(); ++index)
+        {
+            llvm::Constant* indices[] = { llvm::ConstantInt::get(int64Type, 0), llvm::ConstantInt::get(int64Type, _portMemoryPlan.offsets[index]) };
+            auto pAddress = llvm::ConstantExpr::getInBoundsGetElementPtr(pArena->getValueType(), pArena, indices);
+            module.ReplaceEmittedGlobal(variables[index]->EmittedName(), llvm::ConstantExpr::getPointerCast(pAddress, types[index]));
+        }
+    }
+
     void IRMapCompiler::EmitModelAPIFunctions(const Map& map)
     {
         EmitGetInputSizeFunction(map);
@@ -584,13 +1403,47 @@ namespace model
             throw emitters::EmitterException(emitters::EmitterError::unexpected,
                                              utilities::FormatString("Error: missing port variable for '%s' port on node %s(%s)", port.GetName().c_str(), node->GetRuntimeTypeName().c_str(), node->GetId().ToString().c_str()));
         }
-        return GetModule().EnsureEmitted(*pVar);
+        return EnsurePortVariableEmitted(*pVar, port.GetReferencedPort());
     }
 
     emitters::LLVMValue IRMapCompiler::EnsurePortEmitted(const OutputPortBase& port)
     {
         auto pVar = GetOrAllocatePortVariable(port);
-        return GetModule().EnsureEmitted(*pVar);
+        return EnsurePortVariableEmitted(*pVar, port);
+    }
+
+    emitters::LLVMValue IRMapCompiler::GetBatchPortValues(const InputPortBase& port)
+    {
+        return GetBatchPortValues(port.GetReferencedPort());
+    }
+
+    emitters::LLVMValue IRMapCompiler::GetBatchPortValues(const OutputPortBase& port)
+    {
+        if (IsBatchPortShared(port))
+        {
+            return GetModule().GetCurrentFunction().PointerOffset(GetModule().EnsureEmitted(*GetVariableForPort(port)), 0);
+        }
+
+        auto entry = _batchPortValues.find(&port);
+        if (entry == _batchPortValues.end())
+        {
+            const Node* node = port.GetNode();
+            throw emitters::EmitterException(emitters::EmitterError::unexpected,
+                                             utilities::FormatString("Error: missing batch values for '%s' port on node %s(%s)", port.GetName().c_str(), node->GetRuntimeTypeName().c_str(), node->GetId().ToString().c_str()));
+        }
+        return entry->second;
+    }
+
+    bool IRMapCompiler::IsBatchPortShared(const InputPortBase& port)
+    {
+        return IsBatchPortShared(port.GetReferencedPort());
+    }
+
+    bool IRMapCompiler::IsBatchPortShared(const OutputPortBase& port)
+    {
+        // Constants are stored in literal globals, which every sample reads
+        auto pVar = GetVariableForPort(port);
+        return pVar != nullptr && pVar->IsLiteral();
     }
 
     void IRMapCompiler::OnBeginCompileModel(const Model& model)
@@ -607,6 +1460,7 @@ namespace model
         currentFunction.IncludeInPredictInterface();
 
         _profiler.StartModel(currentFunction);
+        _predictFunction = currentFunction.GetFunction();
     }
 
     void IRMapCompiler::OnEndCompileModel(const Model& model)
@@ -626,6 +1480,11 @@ namespace model
 
         _profiler.InitNode(currentFunction, node);
         _profiler.StartNode(currentFunction, node);
+
+        if (currentFunction.GetFunction() == _predictFunction)
+        {
+            _currentScheduleStep = _numScheduleSteps++;
+        }
     }
 
     void IRMapCompiler::OnEndCompileNode(const Node& node)
@@ -643,6 +1502,11 @@ namespace model
             currentFunction.GetCurrentRegion()->SetEnd(pCurBlock);
         }
 
+        if (currentFunction.GetFunction() == _predictFunction)
+        {
+            _currentScheduleStep = -1;
+        }
+
         Log() << "Finished compiling node " << DiagnosticString(node) << EOL;
     }
 
@@ -760,6 +1624,13 @@ namespace model
 
         Log() << "Trying to merge emitted code for node " << DiagnosticString(src) << " with existing code region in " << currentFunction.GetFunctionName() << EOL;
 
+        // Merging moves the node's code out of schedule order, which would invalidate the port buffer live ranges
+        if (IsPlanningPortMemory())
+        {
+            Log() << "Not merging code regions while planning port memory" << EOL;
+            return false;
+        }
+
         emitters::IRBlockRegion* pSrcRegion = GetCurrentNodeBlocks().Get(src);
         if (pSrcRegion == nullptr || pSrcRegion == pDestRegion)
         {
@@ -777,7 +1648,7 @@ namespace model
     emitters::IRBlockRegion* IRMapCompiler::GetMergeableNodeRegion(const PortElementBase& element)
     {
         const Node* pNode = nullptr;
-        if (HasSingleDescendant(element))
+        if (HasSingleDescendant(element) && !IsPlanningPortMemory())
         {
             emitters::Variable* pVar = GetVariableForPort(*element.ReferencedPort());
             if (pVar != nullptr && !pVar->IsLiteral())
@@ -810,7 +1681,7 @@ namespace model
             throw emitters::EmitterException(emitters::EmitterError::indexOutOfRange);
         }
 
-        emitters::LLVMValue pVal = GetModule().EnsureEmitted(*pVar);
+        emitters::LLVMValue pVal = EnsurePortVariableEmitted(*pVar, *element.ReferencedPort());
         auto valType = pVal->getType();
         bool needsDereference = valType->isPointerTy(); // TODO: Maybe this should be `isPtrOrPtrVectorTy()` or even `isPtrOrPtrVectorTy() || isArrayTy()`
         if (needsDereference)
@@ -127,26 +127,32 @@ namespace model
                     throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Visited node before all its descendants!");
                 }
             }
-            if (!node.IsCompilable(this))
-            {
-                std::string typeName = node.GetRuntimeTypeName();
-                throw emitters::EmitterException(emitters::EmitterError::notSupported, std::string("Uncompilable node type: " + typeName));
-            }
-
-            auto compilableNode = const_cast<CompilableNode*>(dynamic_cast<const CompilableNode*>(&node));
-            if (!compilableNode)
-            {
-                throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Encountered null compilable node");
-            }
 
             visitedNodes.insert(&node);
-            Log() << "Now compiling node " << DiagnosticString(node) << EOL;
-            OnBeginCompileNode(node);
-            compilableNode->CompileNode(*this);
-            OnEndCompileNode(node);
+            CompileNode(node);
         });
     }
 
+    void MapCompiler::CompileNode(const Node& node)
+    {
+        if (!node.IsCompilable(this))
+        {
+            std::string typeName = node.GetRuntimeTypeName();
+            throw emitters::EmitterException(emitters::EmitterError::notSupported, std::string("Uncompilable node type: " + typeName));
+        }
+
+        auto compilableNode = const_cast<CompilableNode*>(dynamic_cast<const CompilableNode*>(&node));
+        if (!compilableNode)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Encountered null compilable node");
+        }
+
+        Log() << "Now compiling node " << DiagnosticString(node) << EOL;
+        OnBeginCompileNode(node);
+        compilableNode->CompileNode(*this);
+        OnEndCompileNode(node);
+    }
+
     emitters::Variable* MapCompiler::AllocatePortVariable(const OutputPortBase& port)
     {
         auto pModuleEmitter = GetModuleEmitter();
@@ -33,6 +33,13 @@ namespace model
         sinkFunctionName = properties.GetOrParseEntry("sinkFunctionName", sinkFunctionName);
         verifyJittedModule = properties.GetOrParseEntry("verifyJittedModule", verifyJittedModule);
         profile = properties.GetOrParseEntry("profile", profile);
+        reentrant = properties.GetOrParseEntry("reentrant", reentrant);
+        planPortMemory = properties.GetOrParseEntry("planPortMemory", planPortMemory);
+        predictBatch = properties.GetOrParseEntry("predictBatch", predictBatch);
+        lazyJit = properties.GetOrParseEntry("lazyJit", lazyJit);
+        parallelBranchCost = properties.GetOrParseEntry("parallelBranchCost", parallelBranchCost);
+        objectCacheDirectory = properties.GetOrParseEntry("objectCacheDirectory", objectCacheDirectory);
+        objectCacheMaxMegabytes = properties.GetOrParseEntry("objectCacheMaxMegabytes", objectCacheMaxMegabytes);
         inlineNodes = properties.GetOrParseEntry("inlineNodes", inlineNodes);
     }
 } // namespace model
@@ -68,5 +68,26 @@ namespace model
             });
         });
     }
+
+    void OutputNodeBase::CompileBatch(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        auto output = function.LocalArray(compiler.GetBatchPortValues(_outputBase));
+        auto input = function.LocalArray(compiler.GetBatchPortValues(_inputBase));
+        const int size = static_cast<int>(_inputBase.Size());
+        if (!compiler.IsBatchPortShared(_inputBase))
+        {
+            function.For(batchSize * size, [input, output](emitters::IRFunctionEmitter& function, auto i) {
+                output[i] = input[i];
+            });
+            return;
+        }
+
+        // Every sample gets a copy of a shared input
+        function.For(batchSize, [input, output, size](emitters::IRFunctionEmitter& function, auto sample) {
+            function.For(size, [input, output, size, sample](emitters::IRFunctionEmitter& function, auto i) {
+                output[sample * size + i] = input[i];
+            });
+        });
+    }
 } // namespace model
 } // namespace ell
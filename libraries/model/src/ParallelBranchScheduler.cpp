@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelBranchScheduler.cpp (model)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelBranchScheduler.h"
+#include "InputPort.h"
+#include "Model.h"
+#include "Node.h"
+#include "OutputPort.h"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        using NodeSet = std::unordered_set<const Node*>;
+
+        struct BranchGroup
+        {
+            std::vector<std::vector<const Node*>> branches;
+            bool active = true;
+        };
+
+        class ScheduleBuilder
+        {
+        public:
+            ScheduleBuilder(const Model& model, std::function<double(const Node&)> nodeCost, double minimumBranchCost, std::function<bool(const Node&)> canRunInBranch) :
+                _nodeCost(std::move(nodeCost)),
+                _minimumBranchCost(minimumBranchCost),
+                _canRunInBranch(std::move(canRunInBranch))
+            {
+                model.Visit([this](const Node& node) {
+                    _position[&node] = static_cast<int>(_order.size());
+                    _order.push_back(&node);
+                });
+            }
+
+            std::vector<ParallelScheduleStep> GetSchedule()
+            {
+                FindBranchGroups();
+
+                // If the groups can't be ordered together, drop the most recently found ones until they can
+                std::vector<ParallelScheduleStep> schedule;
+                while (!TryGetSchedule(schedule))
+                {
+                    auto lastActive = std::find_if(_groups.rbegin(), _groups.rend(), [](const BranchGroup& group) { return group.active; });
+                    lastActive->active = false;
+                }
+                return schedule;
+            }
+
+        private:
+            std::vector<const Node*> GetSortedParents(const Node& node) const
+            {
+                auto parents = node.GetParentNodes();
+                std::sort(parents.begin(), parents.end(), [this](const Node* a, const Node* b) { return _position.at(a) < _position.at(b); });
+                return parents;
+            }
+
+            const NodeSet& GetAncestors(const Node* node)
+            {
+                auto it = _ancestors.find(node);
+                if (it != _ancestors.end())
+                {
+                    return it->second;
+                }
+
+                NodeSet ancestors = { node };
+                for (auto parent : node->GetParentNodes())
+                {
+                    const auto& parentAncestors = GetAncestors(parent);
+                    ancestors.insert(parentAncestors.begin(), parentAncestors.end());
+                }
+                return _ancestors.emplace(node, std::move(ancestors)).first->second;
+            }
+
+            // The nodes feeding the end of the model: for each sink, the first ancestor that may run in a branch
+            std::vector<const Node*> GetModelHeads() const
+            {
+                std::vector<const Node*> heads;
+                for (auto node : _order)
+                {
+                    if (!node->GetDependentNodes().empty())
+                    {
+                        continue;
+                    }
+
+                    while (!_canRunInBranch(*node) && node->GetParentNodes().size() == 1)
+                    {
+                        node = node->GetParentNodes()[0];
+                    }
+                    if (_canRunInBranch(*node) && std::find(heads.begin(), heads.end(), node) == heads.end())
+                    {
+                        heads.push_back(node);
+                    }
+                }
+                std::sort(heads.begin(), heads.end(), [this](const Node* a, const Node* b) { return _position.at(a) < _position.at(b); });
+                return heads;
+            }
+
+            void AddBranchGroup(const std::vector<const Node*>& heads)
+            {
+                std::unordered_map<const Node*, int> closureCount;
+                for (auto head : heads)
+                {
+                    for (auto node : GetAncestors(head))
+                    {
+                        ++closureCount[node];
+                    }
+                }
+
+                BranchGroup group;
+                for (auto head : heads)
+                {
+                    std::vector<const Node*> branch;
+                    bool isValid = true;
+                    double cost = 0;
+                    for (auto node : GetAncestors(head))
+                    {
+                        if (closureCount[node] == 1)
+                        {
+                            isValid = isValid && _canRunInBranch(*node);
+                            cost += _nodeCost(*node);
+                            branch.push_back(node);
+                        }
+                    }
+
+                    if (isValid && !branch.empty() && cost >= _minimumBranchCost)
+                    {
+                        std::sort(branch.begin(), branch.end(), [this](const Node* a, const Node* b) { return _position.at(a) < _position.at(b); });
+                        group.branches.push_back(std::move(branch));
+                    }
+                }
+
+                if (group.branches.size() < 2)
+                {
+                    return;
+                }
+
+                // Groups are found from the inside out, so a new group that overlaps an earlier one encloses it
+                NodeSet groupNodes;
+                for (const auto& branch : group.branches)
+                {
+                    groupNodes.insert(branch.begin(), branch.end());
+                }
+                for (auto& earlierGroup : _groups)
+                {
+                    for (const auto& branch : earlierGroup.branches)
+                    {
+                        if (std::any_of(branch.begin(), branch.end(), [&groupNodes](const Node* node) { return groupNodes.count(node) != 0; }))
+                        {
+                            earlierGroup.active = false;
+                        }
+                    }
+                }
+                _groups.push_back(std::move(group));
+            }
+
+            void FindBranchGroups()
+            {
+                for (auto node : _order)
+                {
+                    auto parents = GetSortedParents(*node);
+                    if (parents.size() >= 2)
+                    {
+                        AddBranchGroup(parents);
+                    }
+                }
+
+                auto heads = GetModelHeads();
+                if (heads.size() >= 2)
+                {
+                    AddBranchGroup(heads);
+                }
+            }
+
+            // Orders the sequential nodes and active groups, treating each group as a single unit that depends on
+            // everything its nodes depend on. Returns `false` if the units can't be ordered.
+            bool TryGetSchedule(std::vector<ParallelScheduleStep>& schedule) const
+            {
+                std::unordered_map<const Node*, int> unitOfNode;
+                std::vector<ParallelScheduleStep> units;
+                std::vector<int> unitPositions;
+                for (const auto& group : _groups)
+                {
+                    if (!group.active)
+                    {
+                        continue;
+                    }
+
+                    ParallelScheduleStep step;
+                    step.branches = group.branches;
+                    int position = 0;
+                    for (const auto& branch : group.branches)
+                    {
+                        for (auto node : branch)
+                        {
+                            unitOfNode[node] = static_cast<int>(units.size());
+                            position = std::max(position, _position.at(node));
+                        }
+                    }
+                    units.push_back(std::move(step));
+                    unitPositions.push_back(position);
+                }
+                for (auto node : _order)
+                {
+                    if (unitOfNode.count(node) == 0)
+                    {
+                        unitOfNode[node] = static_cast<int>(units.size());
+                        ParallelScheduleStep step;
+                        step.node = node;
+                        units.push_back(std::move(step));
+                        unitPositions.push_back(_position.at(node));
+                    }
+                }
+
+                std::set<std::pair<int, int>> edges;
+                for (auto node : _order)
+                {
+                    auto unit = unitOfNode[node];
+                    for (auto parent : node->GetParentNodes())
+                    {
+                        auto parentUnit = unitOfNode[parent];
+                        if (parentUnit != unit)
+                        {
+                            edges.emplace(parentUnit, unit);
+                        }
+                    }
+                }
+
+                std::vector<int> numPending(units.size(), 0);
+                std::vector<std::vector<int>> dependents(units.size());
+                for (const auto& edge : edges)
+                {
+                    ++numPending[edge.second];
+                    dependents[edge.first].push_back(edge.second);
+                }
+
+                // Emit ready units in their original order, so the schedule only differs from the model's where groups were formed
+                using QueueEntry = std::pair<int, int>;
+                std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> ready;
+                for (size_t unit = 0; unit < units.size(); ++unit)
+                {
+                    if (numPending[unit] == 0)
+                    {
+                        ready.emplace(unitPositions[unit], static_cast<int>(unit));
+                    }
+                }
+
+                schedule.clear();
+                while (!ready.empty())
+                {
+                    auto unit = ready.top().second;
+                    ready.pop();
+                    schedule.push_back(units[unit]);
+                    for (auto dependent : dependents[unit])
+                    {
+                        if (--numPending[dependent] == 0)
+                        {
+                            ready.emplace(unitPositions[dependent], dependent);
+                        }
+                    }
+                }
+                return schedule.size() == units.size();
+            }
+
+            std::function<double(const Node&)> _nodeCost;
+            double _minimumBranchCost;
+            std::function<bool(const Node&)> _canRunInBranch;
+
+            std::vector<const Node*> _order;
+            std::unordered_map<const Node*, int> _position;
+            std::unordered_map<const Node*, NodeSet> _ancestors;
+            std::vector<BranchGroup> _groups;
+        };
+    } // namespace
+
+    std::vector<ParallelScheduleStep> GetParallelBranchSchedule(const Model& model,
+                                                                std::function<double(const Node&)> nodeCost,
+                                                                double minimumBranchCost,
+                                                                std::function<bool(const Node&)> canRunInBranch)
+    {
+        ScheduleBuilder builder(model, std::move(nodeCost), minimumBranchCost, std::move(canRunInBranch));
+        return builder.GetSchedule();
+    }
+
+    double GetNodeElementCost(const Node& node)
+    {
+        double cost = 0;
+        for (auto input : node.GetInputPorts())
+        {
+            cost += static_cast<double>(input->Size());
+        }
+        for (auto output : node.GetOutputPorts())
+        {
+            cost += static_cast<double>(output->Size());
+        }
+        return cost;
+    }
+} // namespace model
+} // namespace ell
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PortMemoryPlanner.cpp (model)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PortMemoryPlanner.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        uint64_t AlignUp(uint64_t value, uint64_t alignment)
+        {
+            return ((value + alignment - 1) / alignment) * alignment;
+        }
+    } // namespace
+
+    bool LiveRangesOverlap(const BufferLiveRange& a, const BufferLiveRange& b)
+    {
+        return a.begin <= b.end && b.begin <= a.end;
+    }
+
+    PortMemoryPlan PlanPortMemory(const std::vector<BufferLiveRange>& buffers, uint64_t alignment)
+    {
+        if (alignment == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Alignment must be nonzero");
+        }
+
+        PortMemoryPlan plan;
+        plan.offsets.resize(buffers.size(), 0);
+
+        // Place the largest buffers first, breaking ties by start time so the result is deterministic
+        std::vector<size_t> order(buffers.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&buffers](size_t a, size_t b) {
+            if (buffers[a].size != buffers[b].size)
+            {
+                return buffers[a].size > buffers[b].size;
+            }
+            return buffers[a].begin < buffers[b].begin;
+        });
+
+        std::vector<size_t> placed;
+        std::vector<size_t> conflicts;
+        for (auto index : order)
+        {
+            const auto& buffer = buffers[index];
+            plan.naiveSize += buffer.size;
+
+            conflicts.clear();
+            for (auto other : placed)
+            {
+                if (LiveRangesOverlap(buffer, buffers[other]))
+                {
+                    conflicts.push_back(other);
+                }
+            }
+            std::sort(conflicts.begin(), conflicts.end(), [&plan](size_t a, size_t b) { return plan.offsets[a] < plan.offsets[b]; });
+
+            // First fit: walk the live buffers in address order looking for a gap big enough to hold this one
+            uint64_t offset = 0;
+            for (auto other : conflicts)
+            {
+                if (offset + buffer.size <= plan.offsets[other])
+                {
+                    break;
+                }
+                offset = std::max(offset, AlignUp(plan.offsets[other] + buffers[other].size, alignment));
+            }
+
+            plan.offsets[index] = offset;
+            plan.arenaSize = std::max(plan.arenaSize, offset + buffer.size);
+            placed.push_back(index);
+        }
+
+        plan.arenaSize = AlignUp(plan.arenaSize, alignment);
+        return plan;
+    }
+} // namespace model
+} // namespace ell
@@ -61,6 +61,8 @@ void TestMultipleOutputNodes();
 void TestShapeFunctionGeneration();
 void TestCompilableClockNode();
 void TestCompilableFFTNode();
+void TestFlatForestPredictorNode(bool useBitVectors);
+void TestProtoNNLabelScoresNode(int numPrototypes, bool allowVectorInstructions, bool parallelize);
 
 //
 // mathy nodes
@@ -94,8 +96,9 @@ void TestParametricReLUActivationLayerNode(size_t inputPadding = 0, size_t outpu
 void TestSigmoidActivationLayerNode(size_t inputPadding = 0, size_t outputPadding = 0);
 void TestBatchNormalizationLayerNode(size_t inputPadding = 0, size_t outputPadding = 0);
 void TestBiasLayerNode(size_t inputPadding = 0, size_t outputPadding = 0);
-void TestBinaryConvolutionalLayerNode(size_t imageRows, size_t imageColumns, size_t numChannels, size_t numFilters, size_t inputPadding = 1, size_t outputPadding = 0, ell::predictors::neural::PaddingScheme = ell::predictors::neural::PaddingScheme::zeros, bool scaleByFilterMeans = true);
+void TestBinaryConvolutionalLayerNode(size_t imageRows, size_t imageColumns, size_t numChannels, size_t numFilters, size_t inputPadding = 1, size_t outputPadding = 0, ell::predictors::neural::PaddingScheme = ell::predictors::neural::PaddingScheme::zeros, bool scaleByFilterMeans = true, bool allowVectorInstructions = false, bool blockFilters = true, bool parallelize = false);
 void TestBroadcastLinearFunctionNode();
+void TestVectorizedElementwiseNodes(int vectorWidth);
 void TestConvolutionalLayerNode(ConvolutionMethod convolutionMethod, size_t inputPadding = 1, size_t outputPadding = 0);
 void TestConvolutionalLayerNode2(ConvolutionMethod convolutionMethod, size_t inputPadding = 1, size_t outputPadding = 0);
 void TestConvolutionalLayerNode3(ConvolutionMethod convolutionMethod, size_t inputPadding = 1, size_t outputPadding = 0);
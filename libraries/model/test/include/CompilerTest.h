@@ -55,6 +55,14 @@ void TestCombineOutputMap();
 void TestMultiOutputMap();
 void TestMultiSourceSinkMap();
 void TestCompiledMapMove();
+void TestReentrantMap();
+void TestPortMemoryPlanning();
+void TestPredictBatch();
+void TestPredictBatchGemm();
+void TestParallelBranches();
+void TestObjectCache();
+void TestLazyJit();
+void TestParallelOptimization();
 
 #pragma region implementation
 
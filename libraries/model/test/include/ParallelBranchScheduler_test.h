@@ -0,0 +1,14 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelBranchScheduler_test.h (model_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+void TestParallelBranchScheduleDiamond();
+void TestParallelBranchScheduleCostThreshold();
+void TestParallelBranchScheduleMultipleOutputs();
+void TestParallelBranchScheduleNested();
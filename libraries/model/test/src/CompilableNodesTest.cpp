@@ -45,6 +45,7 @@
 #include <nodes/include/DotProductNode.h>
 #include <nodes/include/ExtremalValueNode.h>
 #include <nodes/include/FFTNode.h>
+#include <nodes/include/ForestPredictorNode.h>
 #include <nodes/include/FullyConnectedLayerNode.h>
 #include <nodes/include/IRNode.h>
 #include <nodes/include/L2NormSquaredNode.h>
@@ -55,6 +56,7 @@
 #include <nodes/include/NeuralNetworkPredictorNode.h>
 #include <nodes/include/NodeOperations.h>
 #include <nodes/include/PoolingLayerNode.h>
+#include <nodes/include/ProtoNNPredictorNode.h>
 #include <nodes/include/ReceptiveFieldMatrixNode.h>
 #include <nodes/include/RegionDetectionLayerNode.h>
 #include <nodes/include/ReinterpretLayoutNode.h>
@@ -1513,6 +1515,108 @@ void TestCompilableFFTNode()
     });
 }
 
+void TestFlatForestPredictorNode(bool useBitVectors)
+{
+    using SplitAction = predictors::SimpleForestPredictor::SplitAction;
+    using SplitRule = predictors::SingleElementThresholdPredictor;
+    using EdgePredictorVector = std::vector<predictors::ConstantPredictor>;
+
+    predictors::SimpleForestPredictor forest;
+    auto root = forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ 0, 0.3 }, EdgePredictorVector{ -1.0, 1.0 } });
+    auto child1 = forest.Split(SplitAction{ forest.GetChildId(root, 0), SplitRule{ 1, 0.6 }, EdgePredictorVector{ -2.0, 2.0 } });
+    forest.Split(SplitAction{ forest.GetChildId(child1, 0), SplitRule{ 1, 0.4 }, EdgePredictorVector{ -2.1, 2.1 } });
+    forest.Split(SplitAction{ forest.GetChildId(child1, 1), SplitRule{ 1, 0.7 }, EdgePredictorVector{ -2.2, 2.2 } });
+    forest.Split(SplitAction{ forest.GetChildId(root, 1), SplitRule{ 2, 0.9 }, EdgePredictorVector{ -4.0, 4.0 } });
+
+    auto root2 = forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ 0, 0.2 }, EdgePredictorVector{ -3.0, 3.0 } });
+    forest.Split(SplitAction{ forest.GetChildId(root2, 0), SplitRule{ 1, 0.21 }, EdgePredictorVector{ -3.1, 3.1 } });
+    auto child2 = forest.Split(SplitAction{ forest.GetChildId(root2, 1), SplitRule{ 1, 0.22 }, EdgePredictorVector{ -3.2, 3.2 } });
+    forest.Split(SplitAction{ forest.GetChildId(child2, 1), SplitRule{ 2, 0.5 }, EdgePredictorVector{ -3.3, 3.3 } });
+
+    forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ 2, 0.6 }, EdgePredictorVector{ -5.0, 5.0 } });
+
+    // a split rule past the end of the input reads the feature as 0
+    forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ 4, -0.5 }, EdgePredictorVector{ -6.0, 6.0 } });
+    forest.AddToBias(0.5);
+
+    std::vector<std::vector<double>> signal = { { 0.0, 0.0, 0.0 }, { 0.3, 0.6, 0.9 }, { 0.25, 0.5, 0.75 }, { 0.1, 0.65, 0.95 }, { 1.0, 0.1, 0.55 }, { 0.35, 0.8, 0.2 } };
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto forestNode = model.AddNode<SimpleForestPredictorNode>(inputNode->output, forest);
+
+    std::string name = useBitVectors ? "FlatForestPredictorNode (bit vectors)" : "FlatForestPredictorNode";
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["evaluateForestsWithBitVectors"] = useBitVectors;
+
+    auto outputMap = model::Map(model, { { "input", inputNode } }, { { "output", forestNode->output } });
+    model::IRMapCompiler outputCompiler(settings, optimizerOptions);
+    auto compiledOutputMap = outputCompiler.Compile(outputMap);
+    VerifyCompiledOutput(outputMap, compiledOutputMap, signal, name + " output");
+
+    auto treeOutputsMap = model::Map(model, { { "input", inputNode } }, { { "treeOutputs", forestNode->treeOutputs } });
+    model::IRMapCompiler treeOutputsCompiler(settings, optimizerOptions);
+    auto compiledTreeOutputsMap = treeOutputsCompiler.Compile(treeOutputsMap);
+    VerifyCompiledOutput(treeOutputsMap, compiledTreeOutputsMap, signal, name + " treeOutputs");
+
+    auto edgeIndicatorMap = model::Map(model, { { "input", inputNode } }, { { "edgeIndicatorVector", forestNode->edgeIndicatorVector } });
+    model::IRMapCompiler edgeIndicatorCompiler(settings, optimizerOptions);
+    auto compiledEdgeIndicatorMap = edgeIndicatorCompiler.Compile(edgeIndicatorMap);
+    VerifyCompiledOutput(edgeIndicatorMap, compiledEdgeIndicatorMap, signal, name + " edgeIndicatorVector");
+}
+
+void TestProtoNNLabelScoresNode(int numPrototypes, bool allowVectorInstructions, bool parallelize)
+{
+    using ValueType = float;
+    const int dimension = 6;
+    const int numLabels = 3;
+    const ValueType gamma = 1.5;
+
+    std::vector<ValueType> prototypeValues(dimension * numPrototypes);
+    std::vector<ValueType> labelEmbeddingValues(numLabels * numPrototypes);
+    FillRandomVector(prototypeValues, ValueType{ 0 }, ValueType{ 0.5 });
+    FillRandomVector(labelEmbeddingValues);
+
+    math::ColumnMatrix<ValueType> prototypes(dimension, numPrototypes);
+    math::ColumnMatrix<ValueType> labelEmbeddings(numLabels, numPrototypes);
+    for (int prototype = 0; prototype < numPrototypes; ++prototype)
+    {
+        for (int k = 0; k < dimension; ++k)
+        {
+            prototypes(k, prototype) = prototypeValues[k * numPrototypes + prototype];
+        }
+        for (int label = 0; label < numLabels; ++label)
+        {
+            labelEmbeddings(label, prototype) = labelEmbeddingValues[label * numPrototypes + prototype];
+        }
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(dimension);
+    auto labelScoresNode = model.AddNode<ProtoNNLabelScoresNode<ValueType>>(inputNode->output, prototypes, labelEmbeddings, gamma);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", labelScoresNode->output } });
+
+    std::string name = utilities::FormatString("ProtoNNLabelScoresNode(%d prototypes, vectorize: %d, parallelize: %d)", numPrototypes, allowVectorInstructions, parallelize);
+    TestWithSerialization(map, name, [&](model::Map& map, int iteration) {
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.allowVectorInstructions = allowVectorInstructions;
+        settings.compilerSettings.parallelize = parallelize;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+
+        std::vector<std::vector<ValueType>> signal;
+        for (int index = 0; index < 4; ++index)
+        {
+            std::vector<ValueType> input(dimension);
+            FillRandomVector(input, ValueType{ 0 }, ValueType{ 0.5 });
+            signal.push_back(input);
+        }
+        VerifyCompiledOutput(map, compiledMap, signal, utilities::FormatString("%s iteration %d", name.c_str(), iteration), "", 1e-3);
+    });
+}
+
 class BinaryFunctionIRNode : public IRNode
 {
 public:
@@ -1771,6 +1875,128 @@ void TestBroadcastLinearFunctionNode()
     }
 }
 
+// Compiles elementwise nodes with vector instructions enabled, on an input whose innermost dimension isn't a
+// multiple of the vector width, and compares the results with the nodes' Compute methods
+void TestVectorizedElementwiseNodes(int vectorWidth)
+{
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const int rows = 3;
+    const int columns = 19;
+    const std::string suffix = "_vectorWidth" + std::to_string(vectorWidth);
+
+    std::vector<std::vector<ElementType>> signal;
+    for (int sample = 0; sample < 3; ++sample)
+    {
+        std::vector<ElementType> input(rows * columns);
+        for (size_t index = 0; index < input.size(); ++index)
+        {
+            input[index] = static_cast<ElementType>(((index * 7 + sample * 3) % 25) - 12) / 5;
+        }
+        signal.push_back(input);
+    }
+
+    auto Verify = [&](model::Model& model, model::InputNode<ElementType>* inputNode, const model::OutputPortBase& output, const std::string& name) {
+        auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.allowVectorInstructions = true;
+        settings.compilerSettings.vectorWidth = vectorWidth;
+        settings.compilerSettings.parallelize = false;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+        VerifyCompiledOutput(map, compiledMap, signal, name + suffix, "", 1e-4);
+    };
+
+    model::MemoryShape shape{ rows, columns };
+    std::vector<ElementType> constantValues(rows * columns);
+    for (size_t index = 0; index < constantValues.size(); ++index)
+    {
+        constantValues[index] = static_cast<ElementType>(index % 4) - 1.5f;
+    }
+
+    std::vector<std::pair<UnaryOperationType, std::string>> unaryOperations = { { UnaryOperationType::abs, "abs" },
+                                                                                { UnaryOperationType::exp, "exp" },
+                                                                                { UnaryOperationType::hardSigmoid, "hardSigmoid" },
+                                                                                { UnaryOperationType::sigmoid, "sigmoid" },
+                                                                                { UnaryOperationType::square, "square" },
+                                                                                { UnaryOperationType::tanh, "tanh" } };
+    for (const auto& operation : unaryOperations)
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(shape);
+        auto testNode = model.AddNode<UnaryOperationNode<ElementType>>(inputNode->output, operation.first);
+        Verify(model, inputNode, testNode->output, "UnaryOperationNode_" + operation.second);
+    }
+
+    for (auto operation : { BinaryOperationType::add, BinaryOperationType::multiply })
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(shape);
+        auto constantNode = model.AddNode<ConstantNode<ElementType>>(constantValues, shape);
+        auto testNode = model.AddNode<BinaryOperationNode<ElementType>>(inputNode->output, constantNode->output, operation);
+        Verify(model, inputNode, testNode->output, "BinaryOperationNode_" + std::to_string(static_cast<int>(operation)));
+    }
+
+    {
+        // Padded output, which takes the per-dimension path
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(shape);
+        auto constantNode = model.AddNode<ConstantNode<ElementType>>(constantValues, shape);
+        model::PortMemoryLayout outputLayout(shape, model::MemoryShape{ 1, 1 });
+        auto testNode = model.AddNode<BinaryOperationNode<ElementType>>(inputNode->output, inputNode->output.GetMemoryLayout(), constantNode->output, constantNode->output.GetMemoryLayout(), outputLayout, BinaryOperationType::subtract);
+        Verify(model, inputNode, testNode->output, "BinaryOperationNode_padded");
+    }
+
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(shape);
+        auto constantNode = model.AddNode<ConstantNode<ElementType>>(constantValues, shape);
+        auto testNode = model.AddNode<BinaryPredicateNode<ElementType>>(inputNode->output, constantNode->output, BinaryPredicateType::greater);
+        Verify(model, inputNode, testNode->output, "BinaryPredicateNode");
+    }
+
+    // Broadcasting the secondary inputs along the outer dimension reads one value per row; along the inner dimension, one value per element
+    for (size_t secondaryInputDimension : { 0, 1 })
+    {
+        const int secondarySize = secondaryInputDimension == 0 ? rows : columns;
+        std::vector<ElementType> scaleValues(secondarySize);
+        std::vector<ElementType> biasValues(secondarySize);
+        for (int index = 0; index < secondarySize; ++index)
+        {
+            scaleValues[index] = static_cast<ElementType>(index + 1) / 4;
+            biasValues[index] = static_cast<ElementType>(index % 3) - 1;
+        }
+
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(shape);
+        auto scaleNode = model.AddNode<ConstantNode<ElementType>>(scaleValues);
+        auto biasNode = model.AddNode<ConstantNode<ElementType>>(biasValues);
+        auto testNode = model.AddNode<BroadcastLinearFunctionNode<ElementType>>(inputNode->output, inputNode->output.GetMemoryLayout(), scaleNode->output, biasNode->output, secondaryInputDimension, inputNode->output.GetMemoryLayout());
+        Verify(model, inputNode, testNode->output, "BroadcastLinearFunctionNode_dimension" + std::to_string(secondaryInputDimension));
+    }
+
+    std::vector<std::pair<Activation<ElementType>, std::string>> activations;
+    activations.emplace_back(new ReLUActivation<ElementType>(), "ReLU");
+    activations.emplace_back(new LeakyReLUActivation<ElementType>(), "LeakyReLU");
+    activations.emplace_back(new SigmoidActivation<ElementType>(), "Sigmoid");
+    for (const auto& activation : activations)
+    {
+        TensorType input(1, rows, columns);
+        Shape outputShape = { 1, rows, columns };
+        LayerParameters layerParameters{ input, NoPadding(), outputShape, NoPadding() };
+        ActivationLayer<ElementType> layer(layerParameters, activation.first);
+
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(input.Size());
+        auto testNode = model.AddNode<ActivationLayerNode<ElementType>>(inputNode->output, layer);
+        Verify(model, inputNode, testNode->output, "ActivationLayerNode_" + activation.second);
+    }
+}
+
 void TestNeuralNetworkPredictorNode2()
 {
     // Create a simple neural net model with the following layers:
@@ -2537,7 +2763,7 @@ void TestBiasLayerNode(size_t inputPaddingSize, size_t outputPaddingSize)
     VerifyArchiveAndUnarchivingMap<ElementType>(map, computeNode, inputWithPadding, output);
 }
 
-void TestBinaryConvolutionalLayerNode(size_t imageRows, size_t imageColumns, size_t numChannels, size_t numFilters, size_t inputPaddingSize, size_t outputPaddingSize, PaddingScheme paddingScheme, bool scaleByFilterMeans)
+void TestBinaryConvolutionalLayerNode(size_t imageRows, size_t imageColumns, size_t numChannels, size_t numFilters, size_t inputPaddingSize, size_t outputPaddingSize, PaddingScheme paddingScheme, bool scaleByFilterMeans, bool allowVectorInstructions, bool blockFilters, bool parallelize)
 {
     using ElementType = float;
     using LayerParameters = typename Layer<ElementType>::LayerParameters;
@@ -2578,14 +2804,16 @@ void TestBinaryConvolutionalLayerNode(size_t imageRows, size_t imageColumns, siz
     model::MapCompilerOptions settings;
     settings.compilerSettings.optimize = true;
     settings.compilerSettings.useBlas = true; // !!! if BLAS is off, this fails
-    settings.compilerSettings.allowVectorInstructions = false;
+    settings.compilerSettings.allowVectorInstructions = allowVectorInstructions;
     settings.compilerSettings.vectorWidth = 2;
+    settings.compilerSettings.parallelize = parallelize;
     model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["blockBinaryConvolutionFilters"] = blockFilters;
     model::IRMapCompiler compiler(settings, optimizerOptions);
     auto compiledMap = compiler.Compile(map);
 
     auto signal = std::vector<std::vector<ElementType>>{ inputWithPadding.ToArray() };
-    VerifyCompiledOutput<ElementType>(map, compiledMap, { signal }, computeNode->GetRuntimeTypeName());
+    VerifyCompiledOutput<ElementType>(map, compiledMap, { signal }, computeNode->GetRuntimeTypeName() + (blockFilters ? "_blocked" : ""));
 
     // Test archiving / unarchiving produces same result
     VerifyArchiveAndUnarchivingMap<ElementType>(map, computeNode, inputWithPadding, output);
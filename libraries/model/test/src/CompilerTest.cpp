@@ -18,6 +18,7 @@
 #include <model/include/Model.h>
 
 #include <nodes/include/AccumulatorNode.h>
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/ClockNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/DelayNode.h>
@@ -31,6 +32,7 @@
 #include <nodes/include/SourceNode.h>
 #include <nodes/include/SquaredEuclideanDistanceNode.h>
 #include <nodes/include/SumNode.h>
+#include <nodes/include/UnaryOperationNode.h>
 
 #include <emitters/include/EmitterException.h>
 #include <emitters/include/EmitterTypes.h>
@@ -47,9 +49,13 @@
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 using namespace ell;
@@ -178,6 +184,55 @@ void TestSqEuclideanDistanceMap()
     VerifyCompiledOutput(map, compiledMap, signal, " map");
 }
 
+template <typename ElementType>
+static void VerifyProtoNNPredictorMap(const predictors::ProtoNNPredictor<ElementType>& protonnPredictor, const std::vector<std::vector<double>>& features, const std::vector<std::vector<int>>& labels, bool allowVectorInstructions, bool parallelize)
+{
+    const auto dim = protonnPredictor.GetDimension();
+    const double tolerance = std::is_same<ElementType, float>::value ? 1e-4 : 1e-5;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(dim);
+    auto protonnPredictorNode = model.AddNode<nodes::ProtoNNPredictorNode<ElementType>>(inputNode->output, protonnPredictor);
+    auto outputNode = model.AddNode<model::OutputNode<ElementType>>(protonnPredictorNode->output);
+    auto map = model::Map{ model, { { "input", inputNode } }, { { "output", outputNode->output } } };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimize = false;
+    settings.compilerSettings.includeDiagnosticInfo = true;
+    settings.compilerSettings.inlineOperators = false;
+    settings.compilerSettings.allowVectorInstructions = allowVectorInstructions;
+    settings.compilerSettings.parallelize = parallelize;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    testing::ProcessTest("Testing IsValid of original map", testing::IsEqual(compiledMap.IsValid(), true));
+
+    for (unsigned i = 0; i < features.size(); ++i)
+    {
+        std::vector<ElementType> input(features[i].size());
+        std::transform(features[i].begin(), features[i].end(), input.begin(), [](double d) { return static_cast<ElementType>(d / 255); });
+
+        const auto& label = labels[i];
+
+        IsEqual(input.size(), dim);
+
+        inputNode->SetInput(input);
+        auto computeOutput = model.ComputeOutput(outputNode->output);
+        testing::ProcessTest("one hot indices are incorrect for computed and actual label",
+                             IsEqual(std::max_element(label.begin(), label.end()) - label.begin(),
+                                     std::max_element(computeOutput.begin(), computeOutput.end()) - computeOutput.begin()));
+
+        map.SetInputValue(0, input);
+        auto refinedOutput = map.ComputeOutput<ElementType>(0);
+        testing::ProcessTest("computed and refined output vectors don't match", IsEqual(computeOutput, refinedOutput, static_cast<ElementType>(tolerance)));
+
+        compiledMap.SetInputValue(0, input);
+        auto compiledOutput = compiledMap.ComputeOutput<ElementType>(0);
+        testing::ProcessTest("refined and compiled output vectors don't match", IsEqual(refinedOutput, compiledOutput, static_cast<ElementType>(tolerance)));
+    }
+}
+
 void TestProtoNNPredictorMap()
 {
     // the values of dim, gamma, and matrices come from the result of running protoNNTrainer with the following command line
@@ -185,7 +240,7 @@ void TestProtoNNPredictorMap()
 
     size_t dim = 784, projectedDim = 15, numPrototypes = 50, numLabels = 10;
     double gamma = 0.0733256;
-    predictors::ProtoNNPredictor protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
+    predictors::ProtoNNPredictor<double> protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
 
     // projectedDim * dim
     auto W = protonnPredictor.GetProjectionMatrix() =
@@ -217,45 +272,10 @@ void TestProtoNNPredictorMap()
     testing::IsEqual(protonnPredictor.GetNumPrototypes(), numPrototypes);
     testing::IsEqual(protonnPredictor.GetNumLabels(), numLabels);
 
-    model::Model model;
-    auto inputNode = model.AddNode<model::InputNode<double>>(dim);
-    auto protonnPredictorNode = model.AddNode<nodes::ProtoNNPredictorNode>(inputNode->output, protonnPredictor);
-    auto outputNode = model.AddNode<model::OutputNode<double>>(protonnPredictorNode->output);
-    auto map = model::Map{ model, { { "input", inputNode } }, { { "output", outputNode->output } } };
-
-    model::MapCompilerOptions settings;
-    settings.compilerSettings.optimize = false;
-    settings.compilerSettings.includeDiagnosticInfo = true;
-    settings.compilerSettings.inlineOperators = false;
-    model::ModelOptimizerOptions optimizerOptions;
-    model::IRMapCompiler compiler(settings, optimizerOptions);
-    auto compiledMap = compiler.Compile(map);
-
-    testing::ProcessTest("Testing IsValid of original map", testing::IsEqual(compiledMap.IsValid(), true));
-
-    for (unsigned i = 0; i < features.size(); ++i)
-    {
-        auto& input = features[i];
-        std::transform(input.begin(), input.end(), input.begin(), [](double d) { return d / 255; });
-
-        const auto& label = labels[i];
-
-        IsEqual(input.size(), dim);
-
-        inputNode->SetInput(input);
-        auto computeOutput = model.ComputeOutput(outputNode->output);
-        testing::ProcessTest("one hot indices are incorrect for computed and actual label",
-                             IsEqual(std::max_element(label.begin(), label.end()) - label.begin(),
-                                     std::max_element(computeOutput.begin(), computeOutput.end()) - computeOutput.begin()));
-
-        map.SetInputValue(0, input);
-        auto refinedOutput = map.ComputeOutput<double>(0);
-        testing::ProcessTest("computed and refined output vectors don't match", IsEqual(computeOutput, refinedOutput, 1e-5));
-
-        compiledMap.SetInputValue(0, input);
-        auto compiledOutput = compiledMap.ComputeOutput<double>(0);
-        testing::ProcessTest("refined and compiled output vectors don't match", IsEqual(refinedOutput, compiledOutput, 1e-5));
-    }
+    VerifyProtoNNPredictorMap(protonnPredictor, features, labels, false, false);
+    VerifyProtoNNPredictorMap(protonnPredictor, features, labels, true, false);
+    VerifyProtoNNPredictorMap(predictors::ProtoNNPredictor<float>(protonnPredictor), features, labels, false, false);
+    VerifyProtoNNPredictorMap(predictors::ProtoNNPredictor<float>(protonnPredictor), features, labels, true, true);
 }
 
 void TestCombineOutputMap()
@@ -342,6 +362,396 @@ void TestCompiledMapMove()
 
 typedef void (*MapPredictFunction)(void* context, double*, double*);
 
+void TestReentrantMap()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto delayNode = model.AddNode<nodes::DelayNode<double>>(accumNode->output, 2);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", delayNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.moduleName = "TestReentrant";
+    settings.mapFunctionName = "TestReentrant_Predict";
+    settings.reentrant = true;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    // The default instance used by Compute should behave like the uncompiled map
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 } };
+    VerifyCompiledOutput(map, compiledMap, signal, " reentrant compiled map");
+
+    // Evaluate one module from several threads at once, each with a private instance
+    const int numThreads = 4;
+    const int numSteps = 1000;
+    auto predict = reinterpret_cast<MapPredictFunction>(compiledMap.GetJitter().ResolveFunctionAddress("TestReentrant_Predict"));
+    std::vector<void*> instances;
+    for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        instances.push_back(compiledMap.CreateInstance(nullptr));
+    }
+
+    std::vector<std::vector<double>> results(numThreads);
+    std::vector<std::thread> threads;
+    for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        threads.emplace_back([&, threadIndex]() {
+            double scale = threadIndex + 1;
+            std::vector<double> input = { scale, 2 * scale, 3 * scale };
+            std::vector<double> output(input.size());
+            for (int step = 0; step < numSteps; ++step)
+            {
+                predict(instances[threadIndex], input.data(), output.data());
+            }
+            results[threadIndex] = output;
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    bool ok = true;
+    for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        // Accumulated sum of the constant input, delayed by 2 steps
+        double expected = (numSteps - 2) * (threadIndex + 1.0);
+        ok = ok && testing::IsEqual(results[threadIndex], std::vector<double>{ expected, 2 * expected, 3 * expected });
+    }
+    testing::ProcessTest("Testing reentrant compiled map with private instances on " + std::to_string(numThreads) + " threads", ok);
+
+    // Resetting one instance restarts its accumulator and delay line, and leaves the other instances alone
+    compiledMap.Reset(instances[0]);
+    std::vector<double> input = { 1, 2, 3 };
+    std::vector<double> resetOutput(input.size());
+    std::vector<double> otherOutput(input.size());
+    for (int step = 0; step < 3; ++step)
+    {
+        predict(instances[0], input.data(), resetOutput.data());
+        predict(instances[1], input.data(), otherOutput.data());
+    }
+    double otherExpected = (numSteps + 1) * 2.0;
+    testing::ProcessTest("Testing reset of a reentrant compiled map instance", testing::IsEqual(resetOutput, input) && testing::IsEqual(otherOutput, std::vector<double>{ otherExpected, 2 * otherExpected, 3 * otherExpected }));
+
+    // Resetting the map resets its default instance
+    map.Reset();
+    compiledMap.Reset();
+    VerifyCompiledOutput(map, compiledMap, signal, " reentrant compiled map after reset");
+
+    for (auto instance : instances)
+    {
+        compiledMap.DestroyInstance(instance);
+    }
+}
+
+void TestPortMemoryPlanning()
+{
+    // A chain of nodes, where each intermediate buffer is dead as soon as the next node has read it
+    const int size = 16;
+    const int numNodes = 6;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    const model::OutputPort<double>* previous = &inputNode->output;
+    for (int index = 0; index < numNodes; ++index)
+    {
+        auto operation = (index % 2 == 0) ? nodes::BinaryOperationType::add : nodes::BinaryOperationType::multiply;
+        previous = &model.AddNode<nodes::BinaryOperationNode<double>>(*previous, inputNode->output, operation)->output;
+    }
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", *previous } });
+
+    std::vector<std::vector<double>> signal;
+    for (int step = 0; step < 4; ++step)
+    {
+        std::vector<double> input(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input[index] = 0.25 * (index - step);
+        }
+        signal.push_back(input);
+    }
+
+    for (bool planPortMemory : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.planPortMemory = planPortMemory;
+        model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+        auto compiledMap = compiler.Compile(map);
+        PrintIR(compiledMap);
+        VerifyCompiledOutput(map, compiledMap, signal, planPortMemory ? " map with planned port memory" : " map without planned port memory");
+
+        const auto& plan = compiler.GetPortMemoryPlan();
+        if (planPortMemory)
+        {
+            testing::ProcessTest("Testing port memory plan reuses buffers", plan.arenaSize < plan.naiveSize);
+        }
+        else
+        {
+            testing::ProcessTest("Testing disabled port memory plan", plan.offsets.empty());
+        }
+    }
+}
+
+void TestPredictBatch()
+{
+    // Includes an accumulator, so the batch must be evaluated in order
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(productNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.moduleName = "TestBatch";
+    settings.mapFunctionName = "TestBatch_Predict";
+    settings.predictBatch = true;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    const int numSamples = 5;
+    std::vector<double> inputs;
+    std::vector<double> expected;
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        std::vector<double> input = { 1.0 * sample, 2.0 - sample, 0.5 * sample };
+        map.SetInputValue(0, input);
+        auto output = map.ComputeOutput<double>(0);
+        inputs.insert(inputs.end(), input.begin(), input.end());
+        expected.insert(expected.end(), output.begin(), output.end());
+    }
+
+    auto outputs = compiledMap.ComputeBatch<double>(inputs);
+    testing::ProcessTest("Testing batched predict function", testing::IsEqual(outputs, expected));
+}
+
+void TestPredictBatchGemm()
+{
+    // A fully-connected layer and an activation, so the batched function computes whole tiles with one matrix product.
+    // 70 samples is two full tiles and a few leftover samples.
+    const int inputSize = 5;
+    const int outputSize = 4;
+    math::RowMatrix<double> weights(outputSize, inputSize);
+    weights.Generate([index = 0]() mutable { return 0.1 * (index++ % 7) - 0.3; });
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(inputSize);
+    auto productNode = model.AddNode<nodes::MatrixVectorProductNode<double, math::MatrixLayout::rowMajor>>(inputNode->output, weights);
+    auto expNode = model.AddNode<nodes::UnaryOperationNode<double>>(productNode->output, nodes::UnaryOperationType::exp);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", expNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.moduleName = "TestBatchGemm";
+    settings.mapFunctionName = "TestBatchGemm_Predict";
+    settings.predictBatch = true;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    const int numSamples = 70;
+    std::vector<double> inputs;
+    std::vector<double> expected;
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        std::vector<double> input(inputSize);
+        for (int index = 0; index < inputSize; ++index)
+        {
+            input[index] = 0.05 * ((sample * 3 + index) % 11) - 0.2;
+        }
+        map.SetInputValue(0, input);
+        auto output = map.ComputeOutput<double>(0);
+        inputs.insert(inputs.end(), input.begin(), input.end());
+        expected.insert(expected.end(), output.begin(), output.end());
+    }
+
+    auto outputs = compiledMap.ComputeBatch<double>(inputs);
+    testing::ProcessTest("Testing batched predict function with a matrix product", testing::IsEqual(outputs, expected, 1e-10));
+}
+
+void TestParallelBranches()
+{
+    // Two independent branches joined by an add
+    const int size = 64;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    auto expNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::exp);
+    auto sinNode = model.AddNode<nodes::UnaryOperationNode<double>>(expNode->output, nodes::UnaryOperationType::sin);
+    auto squareNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::square);
+    auto cosNode = model.AddNode<nodes::UnaryOperationNode<double>>(squareNode->output, nodes::UnaryOperationType::cos);
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<double>>(sinNode->output, cosNode->output, nodes::BinaryOperationType::add);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", addNode->output } });
+
+    std::vector<std::vector<double>> signal;
+    for (int step = 0; step < 4; ++step)
+    {
+        std::vector<double> input(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input[index] = 0.125 * (index - step);
+        }
+        signal.push_back(input);
+    }
+
+    for (bool useThreadPool : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.parallelize = true;
+        settings.compilerSettings.useThreadPool = useThreadPool;
+        settings.parallelBranchCost = 0;
+        model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+        auto compiledMap = compiler.Compile(map);
+        PrintIR(compiledMap);
+
+        std::string suffix = useThreadPool ? " map with parallel branches on the thread pool" : " map with parallel branches on new threads";
+        testing::ProcessTest("Testing parallel branches were scheduled for" + suffix, compiler.GetNumParallelBranchGroups() == 1);
+        VerifyCompiledOutput(map, compiledMap, signal, suffix);
+    }
+
+    // Sequential unless parallelization is enabled
+    model::MapCompilerOptions settings;
+    settings.parallelBranchCost = 0;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    testing::ProcessTest("Testing parallel branches are disabled without parallelize", compiler.GetNumParallelBranchGroups() == 0);
+}
+
+void TestObjectCache()
+{
+    // Two parallel branches, so the module has a thread pool with static constructors and destructors
+    const int size = 64;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    auto expNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::exp);
+    auto squareNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::square);
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<double>>(expNode->output, squareNode->output, nodes::BinaryOperationType::add);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", addNode->output } });
+
+    std::vector<std::vector<double>> signal;
+    for (int step = 0; step < 4; ++step)
+    {
+        std::vector<double> input(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input[index] = 0.125 * (index - step);
+        }
+        signal.push_back(input);
+    }
+
+    auto cacheDirectory = (std::filesystem::temp_directory_path() / "ell_object_cache_test").u8string();
+    std::filesystem::remove_all(std::filesystem::u8path(cacheDirectory));
+
+    model::MapCompilerOptions settings;
+    settings.objectCacheDirectory = cacheDirectory;
+    settings.compilerSettings.parallelize = true;
+    settings.parallelBranchCost = 0;
+
+    {
+        model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+        auto compiledMap = compiler.Compile(map);
+        VerifyCompiledOutput(map, compiledMap, signal, " map compiled into the object cache");
+        auto cache = compiler.GetObjectCache();
+        testing::ProcessTest("Testing object cache miss", !compiledMap.IsLoadedFromObjectCache() && cache->GetNumMisses() == 1 && cache->GetNumHits() == 0);
+        testing::ProcessTest("Testing object cache stores compiled object", cache->GetSize() > 0);
+    }
+
+    {
+        model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+        auto compiledMap = compiler.Compile(map);
+        VerifyCompiledOutput(map, compiledMap, signal, " map loaded from the object cache");
+        auto cache = compiler.GetObjectCache();
+        testing::ProcessTest("Testing object cache hit", compiledMap.IsLoadedFromObjectCache() && cache->GetNumHits() == 1 && cache->GetNumMisses() == 0);
+    }
+
+    // Different options produce different code, and the size limit evicts all but the newest object
+    settings.compilerSettings.optimize = false;
+    settings.objectCacheMaxMegabytes = 0;
+    {
+        model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+        auto compiledMap = compiler.Compile(map);
+        VerifyCompiledOutput(map, compiledMap, signal, " unoptimized map compiled into the object cache");
+        testing::ProcessTest("Testing object cache misses on different options", !compiledMap.IsLoadedFromObjectCache() && compiler.GetObjectCache()->GetNumMisses() == 1);
+
+        int numObjects = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::u8path(cacheDirectory)))
+        {
+            numObjects += entry.path().extension() == ".o" ? 1 : 0;
+        }
+        testing::ProcessTest("Testing object cache evicts objects over the size limit", numObjects == 1);
+    }
+
+    std::filesystem::remove_all(std::filesystem::u8path(cacheDirectory));
+}
+
+void TestLazyJit()
+{
+    const int size = 32;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    auto expNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::exp);
+    auto squareNode = model.AddNode<nodes::UnaryOperationNode<double>>(expNode->output, nodes::UnaryOperationType::square);
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<double>>(expNode->output, squareNode->output, nodes::BinaryOperationType::add);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", addNode->output } });
+
+    std::vector<std::vector<double>> signal;
+    for (int step = 0; step < 4; ++step)
+    {
+        std::vector<double> input(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input[index] = 0.0625 * (index - step);
+        }
+        signal.push_back(input);
+    }
+
+    model::MapCompilerOptions settings;
+    settings.lazyJit = true;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    auto& jitter = compiledMap.GetJitter();
+    testing::ProcessTest("Testing lazy JIT moves node functions into their own modules", compiledMap.IsLazilyCompiled() && jitter.GetNumLazyFunctions() == 3);
+
+    VerifyCompiledOutput(map, compiledMap, signal, " lazily-compiled map");
+    testing::ProcessTest("Testing lazy JIT compiled every node function that was called", jitter.GetNumCompiledLazyFunctions() == jitter.GetNumLazyFunctions());
+}
+
+void TestParallelOptimization()
+{
+    const int size = 32;
+    std::vector<double> offsets(size);
+    for (int index = 0; index < size; ++index)
+    {
+        offsets[index] = 0.25 * index;
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    auto constantNode = model.AddNode<nodes::ConstantNode<double>>(offsets);
+    auto expNode = model.AddNode<nodes::UnaryOperationNode<double>>(inputNode->output, nodes::UnaryOperationType::exp);
+    auto squareNode = model.AddNode<nodes::UnaryOperationNode<double>>(expNode->output, nodes::UnaryOperationType::square);
+    auto offsetNode = model.AddNode<nodes::BinaryOperationNode<double>>(squareNode->output, constantNode->output, nodes::BinaryOperationType::add);
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<double>>(expNode->output, offsetNode->output, nodes::BinaryOperationType::add);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", addNode->output } });
+
+    std::vector<std::vector<double>> signal;
+    for (int step = 0; step < 4; ++step)
+    {
+        std::vector<double> input(size);
+        for (int index = 0; index < size; ++index)
+        {
+            input[index] = 0.0625 * (index - step);
+        }
+        signal.push_back(input);
+    }
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimizerThreads = 4;
+    model::IRMapCompiler compiler(settings, model::ModelOptimizerOptions{});
+    auto compiledMap = compiler.Compile(map);
+    testing::ProcessTest("Testing map optimized in parallel still has its predict function", compiledMap.GetModule().HasFunction(settings.mapFunctionName));
+
+    VerifyCompiledOutput(map, compiledMap, signal, " map optimized in parallel");
+}
+
 void TestBinaryVector(bool expanded, bool runJit)
 {
     std::vector<double> data = { 5, 10, 15, 20 };
@@ -31,7 +31,7 @@ namespace
 {
 bool OptionsEqual(const ModelOptimizerOptions& a, const ModelOptimizerOptions& b)
 {
-    std::vector<std::string> interestingOptions = { "fuseLinearFunctionNodes", "optimizeReorderDataNodes", "preferredConvolutionMethod" };
+    std::vector<std::string> interestingOptions = { "fuseLinearFunctionNodes", "fuseElementwiseNodes", "foldAffineLayers", "fuseLayerEpilogues", "assignMemoryLayouts", "optimizeReorderDataNodes", "fuseDepthwisePointwiseConvolutions", "evaluateForestsWithBitVectors", "blockBinaryConvolutionFilters", "preferredConvolutionMethod" };
     for (auto s : interestingOptions)
     {
         if (a.HasEntry(s) != b.HasEntry(s))
@@ -81,6 +81,8 @@ void TestArchiveModelOptimizerOptions()
     // Create optimizer options
     ModelOptimizerOptions options;
     options["fuseLinearFunctionNodes"] = false;
+    options["fuseElementwiseNodes"] = true;
+    options["foldAffineLayers"] = false;
     options["optimizeReorderDataNodes"] = true;
     options["preferredConvolutionMethod"] = PreferredConvolutionMethod::diagonal;
 
@@ -101,16 +103,22 @@ void TestModelOptimizerOptionsMetadata()
 
     ModelOptimizerOptions modelOptions;
     modelOptions["fuseLinearFunctionNodes"] = false;
+    modelOptions["fuseElementwiseNodes"] = false;
+    modelOptions["foldAffineLayers"] = true;
     modelOptions["optimizeReorderDataNodes"] = true;
     modelOptions["preferredConvolutionMethod"] = PreferredConvolutionMethod::diagonal;
 
     ModelOptimizerOptions node1Options;
     node1Options["fuseLinearFunctionNodes"] = true;
+    node1Options["fuseElementwiseNodes"] = true;
+    node1Options["foldAffineLayers"] = false;
     node1Options["optimizeReorderDataNodes"] = true;
     node1Options["preferredConvolutionMethod"] = PreferredConvolutionMethod::diagonal;
 
     ModelOptimizerOptions node3Options;
     node3Options["fuseLinearFunctionNodes"] = false;
+    node3Options["fuseElementwiseNodes"] = false;
+    node3Options["foldAffineLayers"] = true;
     node3Options["optimizeReorderDataNodes"] = false;
     node3Options["preferredConvolutionMethod"] = PreferredConvolutionMethod::simple;
 
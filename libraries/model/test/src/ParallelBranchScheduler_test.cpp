@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelBranchScheduler_test.cpp (model_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelBranchScheduler_test.h"
+
+#include <model/include/InputNode.h>
+#include <model/include/Model.h>
+#include <model/include/OutputNode.h>
+#include <model/include/ParallelBranchScheduler.h>
+
+#include <nodes/include/BinaryOperationNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <testing/include/testing.h>
+
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::nodes;
+
+namespace
+{
+bool CanRunInBranch(const Node& node)
+{
+    return dynamic_cast<const InputNodeBase*>(&node) == nullptr && dynamic_cast<const OutputNodeBase*>(&node) == nullptr;
+}
+
+std::vector<ParallelScheduleStep> GetSchedule(const Model& model, double minimumBranchCost)
+{
+    return GetParallelBranchSchedule(model, GetNodeElementCost, minimumBranchCost, CanRunInBranch);
+}
+
+// Returns true if every node in the model is scheduled exactly once, after all of its parents. Nodes in
+// a parallel group may only depend on earlier steps, or on earlier nodes in their own branch.
+bool IsValidSchedule(const Model& model, const std::vector<ParallelScheduleStep>& schedule)
+{
+    std::unordered_set<const Node*> scheduled;
+    for (const auto& step : schedule)
+    {
+        if (!step.IsParallel())
+        {
+            for (auto parent : step.node->GetParentNodes())
+            {
+                if (scheduled.count(parent) == 0)
+                {
+                    return false;
+                }
+            }
+            if (!scheduled.insert(step.node).second)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        std::unordered_set<const Node*> groupNodes;
+        for (const auto& branch : step.branches)
+        {
+            std::unordered_set<const Node*> branchNodes;
+            for (auto node : branch)
+            {
+                for (auto parent : node->GetParentNodes())
+                {
+                    if (scheduled.count(parent) == 0 && branchNodes.count(parent) == 0)
+                    {
+                        return false;
+                    }
+                }
+                branchNodes.insert(node);
+                if (!groupNodes.insert(node).second)
+                {
+                    return false;
+                }
+            }
+        }
+        for (auto node : groupNodes)
+        {
+            if (!scheduled.insert(node).second)
+            {
+                return false;
+            }
+        }
+    }
+    return scheduled.size() == model.Size();
+}
+
+std::vector<const ParallelScheduleStep*> GetParallelSteps(const std::vector<ParallelScheduleStep>& schedule)
+{
+    std::vector<const ParallelScheduleStep*> result;
+    for (const auto& step : schedule)
+    {
+        if (step.IsParallel())
+        {
+            result.push_back(&step);
+        }
+    }
+    return result;
+}
+
+// input -> { exp -> sin, sin -> cos } -> add -> output
+Model GetDiamondModel()
+{
+    Model model;
+    auto in = model.AddNode<InputNode<double>>(16);
+    auto a1 = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::exp);
+    auto a2 = model.AddNode<UnaryOperationNode<double>>(a1->output, UnaryOperationType::sin);
+    auto b1 = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::sin);
+    auto b2 = model.AddNode<UnaryOperationNode<double>>(b1->output, UnaryOperationType::cos);
+    auto join = model.AddNode<BinaryOperationNode<double>>(a2->output, b2->output, BinaryOperationType::add);
+    model.AddNode<OutputNode<double>>(join->output);
+    return model;
+}
+} // namespace
+
+void TestParallelBranchScheduleDiamond()
+{
+    auto model = GetDiamondModel();
+    auto schedule = GetSchedule(model, 0);
+    auto parallelSteps = GetParallelSteps(schedule);
+
+    testing::ProcessTest("Testing parallel branch schedule of a diamond is valid", IsValidSchedule(model, schedule));
+    testing::ProcessTest("Testing parallel branch schedule of a diamond has one parallel group", parallelSteps.size() == 1);
+    if (parallelSteps.size() == 1)
+    {
+        const auto& branches = parallelSteps[0]->branches;
+        testing::ProcessTest("Testing parallel branch schedule of a diamond has two branches of two nodes",
+                             branches.size() == 2 && branches[0].size() == 2 && branches[1].size() == 2);
+    }
+}
+
+void TestParallelBranchScheduleCostThreshold()
+{
+    auto model = GetDiamondModel();
+
+    // Each branch touches 64 elements: two nodes with 16 inputs and 16 outputs each
+    auto cheapSchedule = GetSchedule(model, 64);
+    testing::ProcessTest("Testing branches at the cost threshold are run in parallel", GetParallelSteps(cheapSchedule).size() == 1);
+
+    auto expensiveSchedule = GetSchedule(model, 65);
+    testing::ProcessTest("Testing parallel branch schedule below the cost threshold is valid", IsValidSchedule(model, expensiveSchedule));
+    testing::ProcessTest("Testing branches below the cost threshold stay sequential", GetParallelSteps(expensiveSchedule).empty() && expensiveSchedule.size() == model.Size());
+}
+
+void TestParallelBranchScheduleMultipleOutputs()
+{
+    // input -> { exp -> output, sin -> output }: the heads join at the end of the model
+    Model model;
+    auto in = model.AddNode<InputNode<double>>(16);
+    auto a = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::exp);
+    auto b = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::sin);
+    model.AddNode<OutputNode<double>>(a->output);
+    model.AddNode<OutputNode<double>>(b->output);
+
+    auto schedule = GetSchedule(model, 0);
+    auto parallelSteps = GetParallelSteps(schedule);
+    testing::ProcessTest("Testing parallel branch schedule of a multi-output model is valid", IsValidSchedule(model, schedule));
+    testing::ProcessTest("Testing parallel branch schedule of a multi-output model has one parallel group",
+                         parallelSteps.size() == 1 && parallelSteps[0]->branches.size() == 2);
+}
+
+void TestParallelBranchScheduleNested()
+{
+    // input -> { exp -> { sin, cos } -> add, sin } -> multiply -> output: the inner diamond is part of the outer group's first branch
+    Model model;
+    auto in = model.AddNode<InputNode<double>>(16);
+    auto a = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::exp);
+    auto a1 = model.AddNode<UnaryOperationNode<double>>(a->output, UnaryOperationType::sin);
+    auto a2 = model.AddNode<UnaryOperationNode<double>>(a->output, UnaryOperationType::cos);
+    auto innerJoin = model.AddNode<BinaryOperationNode<double>>(a1->output, a2->output, BinaryOperationType::add);
+    auto b = model.AddNode<UnaryOperationNode<double>>(in->output, UnaryOperationType::sin);
+    auto outerJoin = model.AddNode<BinaryOperationNode<double>>(innerJoin->output, b->output, BinaryOperationType::multiply);
+    model.AddNode<OutputNode<double>>(outerJoin->output);
+
+    auto schedule = GetSchedule(model, 0);
+    auto parallelSteps = GetParallelSteps(schedule);
+    testing::ProcessTest("Testing nested parallel branch schedule is valid", IsValidSchedule(model, schedule));
+    testing::ProcessTest("Testing nested parallel branch schedule keeps only the outer group", parallelSteps.size() == 1);
+    if (parallelSteps.size() == 1)
+    {
+        const auto& branches = parallelSteps[0]->branches;
+        bool hasExpectedBranches = branches.size() == 2 &&
+                                   ((branches[0].size() == 4 && branches[1].size() == 1) || (branches[0].size() == 1 && branches[1].size() == 4));
+        testing::ProcessTest("Testing nested parallel branch schedule has the outer branches", hasExpectedBranches);
+    }
+}
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PortMemoryPlanner_test.cpp (model_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PortMemoryPlanner_test.h"
+
+#include <model/include/PortMemoryPlanner.h>
+
+#include <testing/include/testing.h>
+
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+
+namespace
+{
+// Returns true if no two buffers that are live at the same time share any bytes
+bool IsValidPlan(const std::vector<BufferLiveRange>& buffers, const PortMemoryPlan& plan)
+{
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        if (plan.offsets[i] + buffers[i].size > plan.arenaSize)
+        {
+            return false;
+        }
+
+        for (size_t j = i + 1; j < buffers.size(); ++j)
+        {
+            if (!LiveRangesOverlap(buffers[i], buffers[j]))
+            {
+                continue;
+            }
+
+            bool disjoint = plan.offsets[i] + buffers[i].size <= plan.offsets[j] || plan.offsets[j] + buffers[j].size <= plan.offsets[i];
+            if (!disjoint)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+void TestPlanPortMemoryChain()
+{
+    // A chain of nodes: each buffer is written by one step and read by the next
+    std::vector<BufferLiveRange> buffers;
+    for (int index = 0; index < 8; ++index)
+    {
+        buffers.push_back({ 256, index, index + 1 });
+    }
+
+    auto plan = PlanPortMemory(buffers, 16);
+    testing::ProcessTest("Testing PlanPortMemory on a chain", IsValidPlan(buffers, plan));
+    testing::ProcessTest("Testing PlanPortMemory on a chain reuses buffers", testing::IsEqual(plan.arenaSize, static_cast<uint64_t>(512)));
+    testing::ProcessTest("Testing PlanPortMemory naive size", testing::IsEqual(plan.naiveSize, static_cast<uint64_t>(8 * 256)));
+}
+
+void TestPlanPortMemoryNoOverlap()
+{
+    // A mix of long- and short-lived buffers of different sizes
+    std::vector<BufferLiveRange> buffers = {
+        { 400, 0, 9 },
+        { 100, 0, 2 },
+        { 300, 1, 3 },
+        { 200, 3, 5 },
+        { 100, 4, 4 },
+        { 500, 5, 7 },
+        { 50, 6, 9 },
+        { 300, 8, 9 },
+        { 10, 2, 8 },
+    };
+
+    auto plan = PlanPortMemory(buffers, 4);
+    testing::ProcessTest("Testing PlanPortMemory keeps live buffers disjoint", IsValidPlan(buffers, plan));
+    testing::ProcessTest("Testing PlanPortMemory peak is below naive", plan.arenaSize < plan.naiveSize);
+
+    auto emptyPlan = PlanPortMemory({}, 4);
+    testing::ProcessTest("Testing PlanPortMemory with no buffers", testing::IsEqual(emptyPlan.arenaSize, static_cast<uint64_t>(0)));
+}
+
+void TestPlanPortMemoryAlignment()
+{
+    std::vector<BufferLiveRange> buffers = {
+        { 3, 0, 1 },
+        { 5, 0, 1 },
+        { 7, 1, 2 },
+    };
+
+    auto plan = PlanPortMemory(buffers, 64);
+    bool aligned = true;
+    for (auto offset : plan.offsets)
+    {
+        aligned = aligned && (offset % 64 == 0);
+    }
+    testing::ProcessTest("Testing PlanPortMemory alignment", aligned && IsValidPlan(buffers, plan));
+    testing::ProcessTest("Testing PlanPortMemory arena size is aligned", testing::IsEqual(plan.arenaSize % 64, static_cast<uint64_t>(0)));
+}
@@ -16,7 +16,9 @@
 #include "ModelOptimizerOptions_test.h"
 #include "ModelTransformerTest.h"
 #include "Model_test.h"
+#include "ParallelBranchScheduler_test.h"
 #include "PortElements_test.h"
+#include "PortMemoryPlanner_test.h"
 #include "Submodel_test.h"
 
 #include <testing/include/testing.h>
@@ -49,6 +51,17 @@ int main()
         TestParsePortElements();
         TestConvertPortElements();
 
+        // ParallelBranchScheduler tests
+        TestParallelBranchScheduleDiamond();
+        TestParallelBranchScheduleCostThreshold();
+        TestParallelBranchScheduleMultipleOutputs();
+        TestParallelBranchScheduleNested();
+
+        // PortMemoryPlanner tests
+        TestPlanPortMemoryChain();
+        TestPlanPortMemoryNoOverlap();
+        TestPlanPortMemoryAlignment();
+
         // Map tests
         TestMapCreate();
         TestMapCompute();
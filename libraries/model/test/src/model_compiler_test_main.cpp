@@ -26,6 +26,10 @@ void TestIRCompiler()
 {
     TestReinterpretLayoutNode();
     TestBroadcastLinearFunctionNode();
+    for (int vectorWidth : { 4, 8, 16 })
+    {
+        TestVectorizedElementwiseNodes(vectorWidth);
+    }
 
     TestNodeMetadata();
     TestMultiOutputMap();
@@ -46,6 +50,14 @@ void TestIRCompiler()
     TestSimpleMap(false);
     TestSimpleMap(true);
     TestCompiledMapMove();
+    TestReentrantMap();
+    TestPortMemoryPlanning();
+    TestPredictBatch();
+    TestPredictBatchGemm();
+    TestParallelBranches();
+    TestObjectCache();
+    TestLazyJit();
+    TestParallelOptimization();
     TestBinaryScalar();
     TestBinaryVector(true);
     TestBinaryVector(false);
@@ -121,6 +133,11 @@ void TestIRCompiler()
     TestCompilableSinkNode();
     TestCompilableClockNode();
     TestCompilableFFTNode();
+    TestFlatForestPredictorNode(false);
+    TestFlatForestPredictorNode(true);
+    TestProtoNNLabelScoresNode(37, false, false);
+    TestProtoNNLabelScoresNode(37, true, false);
+    TestProtoNNLabelScoresNode(1027, true, true);
 
     TestPerformanceCounters();
     TestCompilableDotProductNode2<float>(3); // uses IR
@@ -207,6 +224,10 @@ void TestIRCompiler()
     TestBinaryConvolutionalLayerNode(32, 32, 3, 4, 1, 0, PaddingScheme::zeros, true);
     TestBinaryConvolutionalLayerNode(32, 32, 3, 4, 1, 0, PaddingScheme::minusOnes, false);
     TestBinaryConvolutionalLayerNode(32, 32, 3, 4, 1, 0, PaddingScheme::minusOnes, true);
+    TestBinaryConvolutionalLayerNode(8, 8, 128, 5, 1, 0, PaddingScheme::zeros, true, true, false);
+    TestBinaryConvolutionalLayerNode(8, 8, 128, 5, 1, 0, PaddingScheme::zeros, true, true, true);
+    TestBinaryConvolutionalLayerNode(8, 8, 128, 5, 1, 0, PaddingScheme::minusOnes, false, true, true);
+    TestBinaryConvolutionalLayerNode(8, 8, 128, 5, 1, 0, PaddingScheme::zeros, true, true, true, true);
 
     // TestConvolutionalLayerNode(ConvolutionMethod::unrolled);
     TestConvolutionalLayerNode(ConvolutionMethod::unrolled, 1, 0);
@@ -27,6 +27,9 @@ namespace nodes
     template <typename ValueType>
     class ActivationFunction : public BroadcastUnaryFunction<ValueType>
     {
+    public:
+        /// <summary> Indicates if the function can operate on vector types </summary>
+        bool CanUseVectorTypes() const { return true; }
     };
 
     template <typename ValueType>
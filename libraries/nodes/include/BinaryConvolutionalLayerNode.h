@@ -166,6 +166,14 @@ namespace nodes
     //
     // BinaryXnorNode
     //
+
+    /// <summary> A node that computes a binary convolution from the packed receptive field matrix of its input, by counting
+    /// the bits that differ between each row of the matrix and each packed filter.
+    ///
+    /// If the "blockBinaryConvolutionFilters" optimizer option is set (the default), the compiled node computes all the
+    /// filters of one output pixel before moving to the next, combining each block of the input with a few filters at a time,
+    /// and counts the bits of 8 vector blocks at once with a Harley-Seal carry-save adder. Otherwise, it computes one filter
+    /// at a time, with a popcount per block. </summary>
     template <typename ValueType, typename PackedBitsType>
     class BinaryXnorNode : public model::CompilableNode
     {
@@ -197,7 +205,7 @@ namespace nodes
         /// <param name="convolutionalParameters"> The convolutional parameters. </param>
         /// <param name="inputPaddingParameters"> The input padding parameters. </param>
         /// <param name="inputMemoryLayout"> The layout of the input data. </param>
-        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data, which is in (f x h x w) order. </param>
         BinaryXnorNode(const model::OutputPort<PackedBitsType>& input,
                        const model::OutputPort<PackedBitsType>& inputPaddingMasks,
                        const model::OutputPort<int>& inputPaddingMaskSums,
@@ -252,6 +260,22 @@ namespace nodes
                                  bool useVectorInstructions,
                                  int vectorSize,
                                  int numVectorBlocks);
+        void ComputeOutputPixels(emitters::IRFunctionEmitter& function,
+                                 emitters::LLVMValue pInput,
+                                 emitters::LLVMValue pFilterWeights,
+                                 emitters::LLVMValue pFilterMeans,
+                                 emitters::LLVMValue pInputPaddingMask,
+                                 emitters::LLVMValue pInputPaddingMaskSums,
+                                 emitters::LLVMValue pOutput,
+                                 emitters::LLVMValue beginPixel,
+                                 emitters::LLVMValue endPixel,
+                                 bool hasZeroPadding,
+                                 int outputColumns,
+                                 int numFilters,
+                                 int packedRowSize,
+                                 int packedRowStride,
+                                 int vectorSize,
+                                 int numVectorBlocks);
 
         bool HasState() const override { return true; } // stored state: convolutional parameters and input/output memory layouts
         void WriteToArchive(utilities::Archiver& archiver) const override;
@@ -270,7 +294,7 @@ namespace nodes
                            int numBlocks,
                            bool hasZeroPadding);
 
-        emitters::IRFunctionEmitter GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
+        emitters::IRFunctionEmitter GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, bool blockFilters);
 
         // Input
         model::InputPort<PackedBitsType> _input;
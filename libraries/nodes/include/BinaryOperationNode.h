@@ -18,6 +18,7 @@
 #include <model/include/Node.h>
 #include <model/include/PortMemoryLayout.h>
 
+#include <emitters/include/IRVectorUtilities.h>
 #include <emitters/include/LLVMUtilities.h>
 
 #include <utilities/include/ArchiveVersion.h>
@@ -106,6 +107,23 @@ namespace nodes
         /// <returns> The operation </returns>
         BinaryOperationType GetOperation() const { return _operation; }
 
+        /// <summary> Gets the memory layout of one of the inputs </summary>
+        ///
+        /// <param name="index"> The index of the input: 0 for `input1`, 1 for `input2` </param>
+        ///
+        /// <returns> The layout of the input </returns>
+        const model::PortMemoryLayout& GetInputMemoryLayout(int index) const { return index == 0 ? _inputLayout1 : _inputLayout2; }
+
+        /// <summary> Gets the memory layout of the output </summary>
+        ///
+        /// <returns> The layout of the output </returns>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the value written to the padding area of the output </summary>
+        ///
+        /// <returns> The padding value </returns>
+        ValueType GetPaddingValue() const { return _paddingValue; }
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -120,6 +138,7 @@ namespace nodes
 
         void CompileLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
         void CompileExpanded(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
+        void EmitElementwiseOperation(emitters::IRFunctionEmitter& function, int count, emitters::LLVMValue input1, emitters::LLVMValue input2, emitters::LLVMValue output) const;
         void EmitComputeDimensionLoop(model::IRMapCompiler& compiler,
                                       emitters::IRFunctionEmitter& function,
                                       size_t dimension,
@@ -455,9 +474,16 @@ namespace nodes
         emitters::LLVMValue pInput2 = compiler.EnsurePortEmitted(input2);
         emitters::LLVMValue pResult = compiler.EnsurePortEmitted(output);
 
-        auto count = input1.Size();
-        function.VectorOperator(emitters::GetOperator<ValueType>(ToEmitterType(GetOperation())), count, pInput1, pInput2, [&pResult, &function](emitters::LLVMValue i, emitters::LLVMValue pValue) {
-            function.SetValueAt(pResult, i, pValue);
+        auto count = static_cast<int>(input1.Size());
+        EmitElementwiseOperation(function, count, pInput1, pInput2, pResult);
+    }
+
+    template <typename ValueType>
+    void BinaryOperationNode<ValueType>::EmitElementwiseOperation(emitters::IRFunctionEmitter& function, int count, emitters::LLVMValue input1, emitters::LLVMValue input2, emitters::LLVMValue output) const
+    {
+        auto operation = emitters::GetOperator<ValueType>(ToEmitterType(GetOperation()));
+        emitters::EmitElementwiseLoop(function, count, { { input1 }, { input2 } }, { output }, [operation](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& inputs) {
+            return function.Operator(operation, inputs[0], inputs[1]);
         });
     }
 
@@ -570,7 +596,26 @@ namespace nodes
         auto&& outputStride = outputLayout.GetExtent();
         auto&& outputOffset = outputLayout.GetOffset();
 
-        function.For(inputSize[dimension], [input1, input2, output, inputOffset1, inputOffset2, inputStride1, inputStride2, outputStride, outputOffset, prevInput1DimensionOffset, prevInput2DimensionOffset, prevOutputDimensionOffset, dimension, numDimensions, &compiler, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex) {
+        if (static_cast<int>(dimension) == numDimensions - 1)
+        {
+            // The innermost dimension is contiguous in memory, so compute it with an elementwise loop
+            // starting at offset[dimension] (plus the previous offset scaled by this dimension's stride)
+            auto GetStartPointer = [&function, dimension](emitters::LLVMValue pointer, emitters::LLVMValue prevOffset, int offset, int stride) {
+                auto startOffset = function.LocalScalar<int>(offset);
+                if (dimension != 0)
+                {
+                    startOffset = startOffset + function.LocalScalar(prevOffset) * stride;
+                }
+                return function.PointerOffset(pointer, startOffset);
+            };
+            auto start1 = GetStartPointer(input1, prevInput1DimensionOffset, inputOffset1[dimension], inputStride1[dimension]);
+            auto start2 = GetStartPointer(input2, prevInput2DimensionOffset, inputOffset2[dimension], inputStride2[dimension]);
+            auto outputStart = GetStartPointer(output, prevOutputDimensionOffset, outputOffset[dimension], outputStride[dimension]);
+            EmitElementwiseOperation(function, inputSize[dimension], start1, start2, outputStart);
+            return;
+        }
+
+        function.For(inputSize[dimension], [input1, input2, output, inputOffset1, inputOffset2, inputStride1, inputStride2, outputStride, outputOffset, prevInput1DimensionOffset, prevInput2DimensionOffset, prevOutputDimensionOffset, dimension, &compiler, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex) {
             // Calculate the offset within this dimension = (loopIndex + offset[dimension])
             emitters::LLVMValue thisInput1DimensionInternalOffset = function.Operator(emitters::GetAddForValueType<int>(), loopIndex, function.Literal<int>(inputOffset1[dimension]));
             emitters::LLVMValue thisInput2DimensionInternalOffset = function.Operator(emitters::GetAddForValueType<int>(), loopIndex, function.Literal<int>(inputOffset2[dimension]));
@@ -602,19 +647,8 @@ namespace nodes
                 thisOutputDimensionOffset = function.Operator(emitters::GetAddForValueType<int>(), scaledOutputDimensionOffset, thisOutputDimensionInternalOffset);
             }
 
-            if (static_cast<int>(dimension) < numDimensions - 1)
-            {
-                // Recursive call to emit nested loop
-                EmitComputeDimensionLoop(compiler, function, dimension + 1, input1, input2, output, thisInput1DimensionOffset, thisInput2DimensionOffset, thisOutputDimensionOffset);
-            }
-            else
-            {
-                // We're in the innermost loop --- compute the value
-                auto value1 = function.ValueAt(input1, thisInput1DimensionOffset);
-                auto value2 = function.ValueAt(input2, thisInput2DimensionOffset);
-                auto outputValue = function.Operator(emitters::GetOperator<ValueType>(ToEmitterType(GetOperation())), value1, value2);
-                function.SetValueAt(output, thisOutputDimensionOffset, outputValue);
-            }
+            // Recursive call to emit nested loop
+            EmitComputeDimensionLoop(compiler, function, dimension + 1, input1, input2, output, thisInput1DimensionOffset, thisInput2DimensionOffset, thisOutputDimensionOffset);
         });
     }
 
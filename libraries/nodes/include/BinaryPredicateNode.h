@@ -18,6 +18,7 @@
 #include <model/include/Node.h>
 
 #include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRVectorUtilities.h>
 
 #include <utilities/include/Exception.h>
 #include <utilities/include/IArchivable.h>
@@ -239,12 +240,11 @@ namespace nodes
         emitters::LLVMValue pResult = compiler.EnsurePortEmitted(output);
         emitters::TypedComparison cmp = emitters::GetComparison<ValueType>(ToEmitterType(GetPredicate()));
 
-        function.For(input1.Size(), [pInput1, pInput2, pResult, cmp](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
-            emitters::LLVMValue inputValue1 = function.ValueAt(pInput1, i);
-            emitters::LLVMValue inputValue2 = function.ValueAt(pInput2, i);
-            emitters::LLVMValue pOpResult = function.Comparison(cmp, inputValue1, inputValue2);
-            // LLVM internally uses 1 bit for boolean. We use integers to store boolean results. That requires a typecast in LLVM
-            function.SetValueAt(pResult, i, function.CastBoolToByte(pOpResult));
+        // LLVM internally uses 1 bit for boolean. We use integers to store boolean results, so the loop widens the
+        // comparison result to the output's element type
+        auto count = static_cast<int>(input1.Size());
+        emitters::EmitElementwiseLoop(function, count, { { pInput1 }, { pInput2 } }, { pResult }, [cmp](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& inputs) {
+            return function.Comparison(cmp, inputs[0], inputs[1]);
         });
     }
 
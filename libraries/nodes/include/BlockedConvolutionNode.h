@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BlockedConvolutionNode.h (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FusedEpilogue.h"
+
+#include <math/include/Tensor.h>
+
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/PortElements.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// If blocked convolution is specified, a ConvolutionalLayerNode will refine itself into a BlockedConvolutionNode.
+    ///
+    /// A direct convolution that doesn't materialize the receptive-field matrix. The filters are packed into blocks of
+    /// `vectorWidth` output channels, and each block is computed for a tile of adjacent output columns at a time, with
+    /// one vector accumulator per column kept in registers across the whole receptive field. The work is split into
+    /// (output row, channel block) tasks, which run in parallel if the compiler options allow it.
+    ///
+    /// The input and output must be in (row, column, channel) order, so a block of output channels is contiguous in
+    /// memory, and the input must be padded by half the filter size.
+    /// </summary>
+    template <typename ValueType>
+    class BlockedConvolutionNode : public model::CompilableNode
+    {
+    public:
+        using TensorType = math::ChannelColumnRowTensor<ValueType>;
+        using ConstTensorReferenceType = math::ConstChannelColumnRowTensorReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        BlockedConvolutionNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="filterWeights"> The weights for the convolutional filters. Stored
+        ///  as a 3D tensor of dimensions (nf*fw) x fw x d, where nf == # filters, fw == filter width, and d == input depth. </param>
+        /// <param name="stride"> The output stride. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
+        BlockedConvolutionNode(const model::OutputPort<ValueType>& input,
+                               const model::PortMemoryLayout& inputMemoryLayout,
+                               const model::PortMemoryLayout& outputMemoryLayout,
+                               const ConstTensorReferenceType& filterWeights,
+                               size_t stride,
+                               const FusedEpilogue<ValueType>& epilogue = {});
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets information about the output memory layout </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Returns true if the node can accept input with this memory layout order, else false </summary>
+        ///
+        /// <param name="order"> The memory layout order for all the input ports </summary>
+        /// <returns> If the node can accept the input memory layout order, true, else false </returns>
+        bool CanAcceptInputLayout(const utilities::DimensionOrder& order) const override
+        {
+            return GetInputMemoryLayout().GetLogicalDimensionOrder() == order;
+        }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("BlockedConvolutionNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: weights, convolutional parameters and memory layout
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Returns the filter weights packed in blocks of `blockSize` filters: [block][windowRow][windowColumn][inputChannel][filter % blockSize]
+        std::vector<ValueType> GetPackedWeights(int blockSize) const;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        TensorType _filterWeights;
+
+        int _stride = 1;
+        FusedEpilogue<ValueType> _epilogue;
+    };
+} // namespace nodes
+} // namespace ell
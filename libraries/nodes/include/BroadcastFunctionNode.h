@@ -247,6 +247,8 @@ namespace nodes
 
         size_t GetBroadcastDimension() const { return _broadcastDimension; }
         size_t NumPrimaryInputDimensions() const { return GetInputMemoryLayout().NumDimensions(); }
+        FunctionType GetFunction() const { return _function; }
+        ValueType GetOutputPadding() const { return _paddingValue; }
 
     protected:
         BroadcastFunctionNode(const std::vector<model::InputPortBase*>& inputs, const std::vector<model::OutputPortBase*>& outputs);
@@ -265,10 +267,11 @@ namespace nodes
         virtual const model::InputPort<ValueType>* GetSecondaryInput(int index) const = 0;
         virtual const model::OutputPort<ValueType>& GetOutput() const = 0;
         bool IsSecondaryInputPresent(int index) const;
-        FunctionType GetFunction() const { return _function; }
 
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool CanCompileBatch(model::IRMapCompiler& compiler) const override;
+        void CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override;
 
         // Helpers for generating nested loops to visit all input/output values
         void ComputeDimensionLoop(size_t dimension, std::vector<ValueType>& output, size_t prevInputDimensionOffset, size_t prevOutputDimensionOffset, std::vector<ValueType>& secondaryValues) const;
@@ -278,8 +281,6 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
-        ValueType GetOutputPadding() const { return _paddingValue; }
-
     private:
         model::PortMemoryLayout _inputLayout;
         size_t _broadcastDimension = 0;
@@ -334,10 +335,10 @@ namespace nodes
         using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputMemoryLayout;
         using BroadcastFunctionNode<ValueType, FunctionType>::GetBroadcastDimension;
         using BroadcastFunctionNode<ValueType, FunctionType>::NumPrimaryInputDimensions;
-
-    protected:
         using BroadcastFunctionNode<ValueType, FunctionType>::GetFunction;
+        using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputPadding;
 
+    protected:
         utilities::ArchiveVersion GetArchiveVersion() const override;
         bool CanReadArchiveVersion(const utilities::ArchiveVersion& version) const override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
@@ -408,9 +409,10 @@ namespace nodes
         using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputMemoryLayout;
         using BroadcastFunctionNode<ValueType, FunctionType>::GetBroadcastDimension;
         using BroadcastFunctionNode<ValueType, FunctionType>::NumPrimaryInputDimensions;
+        using BroadcastFunctionNode<ValueType, FunctionType>::GetFunction;
+        using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputPadding;
 
     protected:
-        using BroadcastFunctionNode<ValueType, FunctionType>::GetFunction;
         using BroadcastFunctionNode<ValueType, FunctionType>::NumElements;
 
         void WriteToArchive(utilities::Archiver& archiver) const override;
@@ -484,10 +486,10 @@ namespace nodes
         using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputMemoryLayout;
         using BroadcastFunctionNode<ValueType, FunctionType>::GetBroadcastDimension;
         using BroadcastFunctionNode<ValueType, FunctionType>::NumPrimaryInputDimensions;
-
-    protected:
         using BroadcastFunctionNode<ValueType, FunctionType>::GetFunction;
+        using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputPadding;
 
+    protected:
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
@@ -827,7 +829,6 @@ namespace nodes
     void BroadcastFunctionNode<ValueType, FunctionType>::EmitComputeDimensionLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, size_t dimension, emitters::IRLocalScalar begin, emitters::IRLocalScalar end, emitters::LLVMValue primaryInput, const std::vector<emitters::LLVMValue>& secondaryInputs, emitters::LLVMValue output, emitters::IRLocalScalar prevInputDimensionOffset, emitters::IRLocalScalar prevOutputDimensionOffset, std::vector<emitters::LLVMValue>& secondaryValues) const
     {
         // Note: It should be easy to unroll the last K levels by putting a real loop here when dimension < k
-        //       Or, instead of unrolling, vectorizing --- if broadcastDimension = 1, let secondaryValue be a vector and load it one loop previous
         //       If broadcastDimension = outermost dimension (0), we may want to parallelize over that dimension
         const auto numDimensions = NumPrimaryInputDimensions();
         auto&& inputLayout = GetInputMemoryLayout();
@@ -840,7 +841,41 @@ namespace nodes
         const auto broadcastDimension = GetBroadcastDimension();
         const auto numSecondaryInputs = NumSecondaryInputs();
 
-        function.For(begin, end, [dimension, numDimensions, inputSize, inputOffset, inputStride, outputOffset, outputStride, broadcastDimension, numSecondaryInputs, prevInputDimensionOffset, prevOutputDimensionOffset, primaryInput, secondaryInputs, output, &secondaryValues, &compiler, this](emitters::IRFunctionEmitter& function, auto loopIndex) {
+        if (dimension == numDimensions - 1)
+        {
+            // The innermost dimension is contiguous in memory, so compute it with an elementwise loop over [begin, end)
+            auto inputStart = begin + inputOffset[dimension];
+            auto outputStart = begin + outputOffset[dimension];
+            if (dimension != 0)
+            {
+                inputStart = inputStart + (prevInputDimensionOffset * inputStride[dimension]);
+                outputStart = outputStart + (prevOutputDimensionOffset * outputStride[dimension]);
+            }
+
+            std::vector<emitters::ElementwiseOperand> inputs{ { function.PointerOffset(primaryInput, inputStart) } };
+            for (int index = 0; index < numSecondaryInputs; ++index)
+            {
+                emitters::ElementwiseOperand secondaryInput;
+                if (dimension != broadcastDimension)
+                {
+                    secondaryInput.value = secondaryValues[index];
+                }
+                else if (IsSecondaryInputPresent(index))
+                {
+                    secondaryInput.pointer = function.PointerOffset(secondaryInputs[index], begin);
+                }
+                inputs.push_back(secondaryInput);
+            }
+
+            auto body = [this](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& values) {
+                std::vector<emitters::LLVMValue> secondaryArgs(values.begin() + 1, values.end());
+                return this->GetFunction().Compile(function, values[0], secondaryArgs);
+            };
+            emitters::EmitElementwiseLoop(function, end - begin, inputs, { function.PointerOffset(output, outputStart) }, body, GetFunction().CanUseVectorTypes());
+            return;
+        }
+
+        function.For(begin, end, [dimension, inputSize, inputOffset, inputStride, outputOffset, outputStride, broadcastDimension, numSecondaryInputs, prevInputDimensionOffset, prevOutputDimensionOffset, primaryInput, secondaryInputs, output, &secondaryValues, &compiler, this](emitters::IRFunctionEmitter& function, auto loopIndex) {
             // Calculate the offset within this dimension = (loopIndex + offset[dimension])
             auto thisInputDimensionInternalOffset = loopIndex + inputOffset[dimension];
             auto thisOutputDimensionInternalOffset = loopIndex + outputOffset[dimension];
@@ -872,20 +907,10 @@ namespace nodes
                 }
             }
 
-            if (dimension < numDimensions - 1)
-            {
-                // Recursive call to emit nested loop
-                auto nextBegin = function.LocalScalar<int>(0);
-                auto nextEnd = function.LocalScalar<int>(inputSize[dimension + 1]);
-                this->EmitComputeDimensionLoop(compiler, function, dimension + 1, nextBegin, nextEnd, primaryInput, secondaryInputs, output, thisInputDimensionOffset, thisOutputDimensionOffset, secondaryValues);
-            }
-            else
-            {
-                // We're in the innermost loop --- compute the value
-                auto primaryValue = function.ValueAt(primaryInput, thisInputDimensionOffset);
-                auto outputValue = this->GetFunction().Compile(function, primaryValue, secondaryValues);
-                function.SetValueAt(output, thisOutputDimensionOffset, outputValue);
-            }
+            // Recursive call to emit nested loop
+            auto nextBegin = function.LocalScalar<int>(0);
+            auto nextEnd = function.LocalScalar<int>(inputSize[dimension + 1]);
+            this->EmitComputeDimensionLoop(compiler, function, dimension + 1, nextBegin, nextEnd, primaryInput, secondaryInputs, output, thisInputDimensionOffset, thisOutputDimensionOffset, secondaryValues);
         });
     }
 
@@ -1011,6 +1036,64 @@ namespace nodes
         }
     }
 
+    template <typename ValueType, typename FunctionType>
+    bool BroadcastFunctionNode<ValueType, FunctionType>::CanCompileBatch(model::IRMapCompiler& compiler) const
+    {
+        // The batch's output buffers start out zeroed, so padding with other values needs the node's own output buffer
+        if (compiler.IsBatchPortShared(GetPrimaryInput()) || (GetOutputPadding() != 0 && GetOutputMemoryLayout().HasPadding()))
+        {
+            return false;
+        }
+
+        // All the samples share the secondary inputs (a layer's scales and biases, for instance)
+        for (int index = 0; index < NumSecondaryInputs(); ++index)
+        {
+            if (IsSecondaryInputPresent(index) && !compiler.IsBatchPortShared(*GetSecondaryInput(index)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename ValueType, typename FunctionType>
+    void BroadcastFunctionNode<ValueType, FunctionType>::CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        auto valuePtrType = function.GetModule().GetIREmitter().Type(emitters::GetVariableType<ValueType>())->getPointerTo();
+        const auto& primaryInput = GetPrimaryInput();
+        auto&& inputLayout = GetInputMemoryLayout();
+        auto outputLayout = GetOutputMemoryLayout();
+        const int inputSize = static_cast<int>(primaryInput.Size());
+        const int outputSize = static_cast<int>(GetOutput().Size());
+
+        emitters::LLVMValue pPrimaryInputs = compiler.GetBatchPortValues(primaryInput);
+        emitters::LLVMValue pOutputs = compiler.GetBatchPortValues(GetOutput());
+        std::vector<emitters::LLVMValue> secondaryInputs;
+        for (int index = 0; index < NumSecondaryInputs(); ++index)
+        {
+            secondaryInputs.push_back(IsSecondaryInputPresent(index) ? compiler.GetBatchPortValues(*GetSecondaryInput(index)) : function.NullPointer(valuePtrType));
+        }
+
+        // Without secondary inputs or padding, the samples' values are contiguous, so the whole batch is one elementwise loop
+        if (NumSecondaryInputs() == 0 && !inputLayout.HasPadding() && inputLayout == outputLayout)
+        {
+            auto body = [this](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& values) {
+                return this->GetFunction().Compile(function, values[0], std::vector<emitters::LLVMValue>{});
+            };
+            emitters::EmitElementwiseLoop(function, batchSize * inputSize, { { pPrimaryInputs } }, { pOutputs }, body, GetFunction().CanUseVectorTypes());
+            return;
+        }
+
+        function.For(batchSize, [&, this](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar sample) {
+            std::vector<emitters::LLVMValue> secondaryValues(NumSecondaryInputs(), nullptr);
+            auto pPrimaryInput = function.PointerOffset(pPrimaryInputs, sample * inputSize);
+            auto pOutput = function.PointerOffset(pOutputs, sample * outputSize);
+            auto begin = function.LocalScalar<int>(0);
+            auto end = function.LocalScalar<int>(inputLayout.GetActiveSize()[0]);
+            EmitComputeDimensionLoop(compiler, function, 0, begin, end, pPrimaryInput, secondaryInputs, pOutput, function.LocalScalar(), function.LocalScalar(), secondaryValues);
+        });
+    }
+
     template <typename ValueType, typename FunctionType>
     void BroadcastFunctionNode<ValueType, FunctionType>::WriteToArchive(utilities::Archiver& archiver) const
     {
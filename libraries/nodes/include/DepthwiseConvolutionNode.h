@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DepthwiseConvolutionNode.h (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FusedEpilogue.h"
+
+#include <math/include/Tensor.h>
+
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/PortElements.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// If depthwise convolution is specified, a depthwise-separable ConvolutionalLayerNode will refine itself into a DepthwiseConvolutionNode.
+    ///
+    /// A direct convolution where each input channel is convolved with its own filter. The channels are processed in
+    /// blocks of `vectorWidth`, with one vector accumulator per output column in a tile of adjacent columns, and the
+    /// filter window unrolled. Each output row is a separate task, and the tasks run in parallel if the compiler options
+    /// allow it.
+    ///
+    /// The node can also apply a following 1x1 (pointwise) convolution to each output row while it's still in the cache,
+    /// so the depthwise output is never written to memory. In that case the node's output has one channel per pointwise
+    /// filter.
+    ///
+    /// The input and output must be in (row, column, channel) order, so a block of channels is contiguous in memory,
+    /// and the input must be padded by half the filter size.
+    /// </summary>
+    template <typename ValueType>
+    class DepthwiseConvolutionNode : public model::CompilableNode
+    {
+    public:
+        using TensorType = math::ChannelColumnRowTensor<ValueType>;
+        using ConstTensorReferenceType = math::ConstChannelColumnRowTensorReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        DepthwiseConvolutionNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="filterWeights"> The weights for the convolutional filters. Stored
+        ///  as a 3D tensor of dimensions (d*fw) x fw x 1, where fw == filter width, and d == input depth. </param>
+        /// <param name="stride"> The output stride. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
+        DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                 const model::PortMemoryLayout& inputMemoryLayout,
+                                 const model::PortMemoryLayout& outputMemoryLayout,
+                                 const ConstTensorReferenceType& filterWeights,
+                                 size_t stride,
+                                 const FusedEpilogue<ValueType>& epilogue = {});
+
+        /// <summary> Constructor for a depthwise convolution followed by a pointwise convolution. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output of the pointwise convolution. </param>
+        /// <param name="filterWeights"> The weights for the depthwise filters. Stored
+        ///  as a 3D tensor of dimensions (d*fw) x fw x 1, where fw == filter width, and d == input depth. </param>
+        /// <param name="stride"> The output stride of the depthwise convolution. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output of the depthwise convolution. </param>
+        /// <param name="pointwiseWeights"> The weights for the pointwise filters. Stored
+        ///  as a 3D tensor of dimensions nf x 1 x d, where nf == # pointwise filters, and d == input depth. </param>
+        /// <param name="pointwiseEpilogue"> The bias and activation to apply to the output of the pointwise convolution. </param>
+        DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                 const model::PortMemoryLayout& inputMemoryLayout,
+                                 const model::PortMemoryLayout& outputMemoryLayout,
+                                 const ConstTensorReferenceType& filterWeights,
+                                 size_t stride,
+                                 const FusedEpilogue<ValueType>& epilogue,
+                                 const ConstTensorReferenceType& pointwiseWeights,
+                                 const FusedEpilogue<ValueType>& pointwiseEpilogue = {});
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets information about the output memory layout </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Indicates if the node applies a pointwise convolution to the output of the depthwise convolution </summary>
+        bool HasPointwiseConvolution() const { return _pointwiseWeights.NumRows() != 0; }
+
+        /// <summary> Returns true if the node can accept input with this memory layout order, else false </summary>
+        ///
+        /// <param name="order"> The memory layout order for all the input ports </summary>
+        /// <returns> If the node can accept the input memory layout order, true, else false </returns>
+        bool CanAcceptInputLayout(const utilities::DimensionOrder& order) const override
+        {
+            return GetInputMemoryLayout().GetLogicalDimensionOrder() == order;
+        }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("DepthwiseConvolutionNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: weights, convolutional parameters and memory layout
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void Validate() const;
+
+        // Returns the filter weights packed as [windowRow][windowColumn][channel]
+        std::vector<ValueType> GetPackedWeights() const;
+
+        // Returns the pointwise weights as a (filter, channel) matrix in row-major order
+        std::vector<ValueType> GetPointwiseWeightsMatrix() const;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        TensorType _filterWeights;
+
+        int _stride = 1;
+        FusedEpilogue<ValueType> _epilogue;
+
+        TensorType _pointwiseWeights;
+        FusedEpilogue<ValueType> _pointwiseEpilogue;
+    };
+} // namespace nodes
+} // namespace ell
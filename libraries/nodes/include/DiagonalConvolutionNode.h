@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <model/include/IRMapCompiler.h>
 #include <model/include/ModelTransformer.h>
 #include <model/include/PortElements.h>
@@ -49,11 +51,13 @@ namespace nodes
         /// <param name="filterWeights"> The weights for the convolutional filters. Stored
         ///  as a 3D tensor of dimensions (nf*fw) x fw x d, where nf == # filters, fw == filter width, and d == input depth. </param>
         /// <param name="stride"> The output stride. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         DiagonalConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 const ConstTensorReferenceType& filterWeights,
-                                int stride);
+                                int stride,
+                                const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -104,6 +108,7 @@ namespace nodes
         TensorType _filterWeights;
 
         int _stride = 1;
+        FusedEpilogue<ValueType> _epilogue;
     };
 
     //
@@ -136,12 +141,14 @@ namespace nodes
         /// <param name="outputMemoryLayout"> The layout of the output data. </param>
         /// <param name="filterSize"> The filter width. </param>
         /// <param name="stride"> The output stride. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         DiagonalConvolutionComputeNode(const model::OutputPort<ValueType>& input,
                                        const model::OutputPort<ValueType>& filterWeights,
                                        const model::PortMemoryLayout& inputMemoryLayout,
                                        const model::PortMemoryLayout& outputMemoryLayout,
                                        int filterSize,
-                                       int stride);
+                                       int stride,
+                                       const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -190,6 +197,7 @@ namespace nodes
         int _filterSize = 0;
         int _stride = 1;
         int _batchSize = 0;
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictorNode.h (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+
+#include <predictors/include/ForestPredictor.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> A node that evaluates a forest of threshold trees with constant edge predictors. A `SimpleForestPredictorNode`
+    /// refines itself into a `FlatForestPredictorNode`.
+    ///
+    /// The compiled node stores the forest as flat arrays (feature index and threshold per interior node, value and target
+    /// per edge) and walks each tree from its root to a leaf, so a prediction visits only the nodes on the paths it takes.
+    ///
+    /// If the "evaluateForestsWithBitVectors" optimizer option is set, and every tree has at most 64 leaves, the node
+    /// evaluates the trees with QuickScorer-style bit vectors instead: the leaves of each tree are the bits of a mask, every
+    /// split whose test takes the right branch clears the leaves of its left subtree, and the leftmost remaining leaf is the
+    /// one the input reaches. This evaluates every split of every tree, but without any data-dependent branches, which is
+    /// faster for many shallow trees. </summary>
+    class FlatForestPredictorNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* treeOutputsPortName = "treeOutputs";
+        static constexpr const char* edgeIndicatorVectorPortName = "edgeIndicatorVector";
+        const model::InputPort<double>& input = _input;
+        const model::OutputPort<double>& output = _output;
+        const model::OutputPort<double>& treeOutputs = _treeOutputs;
+        const model::OutputPort<bool>& edgeIndicatorVector = _edgeIndicatorVector;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FlatForestPredictorNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The predictor's input. </param>
+        /// <param name="forest"> The forest predictor. </param>
+        FlatForestPredictorNode(const model::OutputPort<double>& input, const predictors::SimpleForestPredictor& forest);
+
+        /// <summary> Gets the forest predictor. </summary>
+        const predictors::SimpleForestPredictor& GetForest() const { return _forest; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return "FlatForestPredictorNode"; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: the forest
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Input
+        model::InputPort<double> _input;
+
+        // Outputs
+        model::OutputPort<double> _output;
+        model::OutputPort<double> _treeOutputs;
+        model::OutputPort<bool> _edgeIndicatorVector;
+
+        // Forest
+        predictors::SimpleForestPredictor _forest;
+    };
+} // namespace nodes
+} // namespace ell
@@ -11,6 +11,7 @@
 #include "BinaryOperationNode.h"
 #include "ConstantNode.h"
 #include "DemultiplexerNode.h"
+#include "FlatForestPredictorNode.h"
 #include "ForestPredictorNode.h"
 #include "MultiplexerNode.h"
 #include "SingleElementThresholdNode.h"
@@ -25,6 +26,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace ell
@@ -158,6 +160,17 @@ namespace nodes
     bool ForestPredictorNode<SplitRuleType, EdgePredictorType>::Refine(model::ModelTransformer& transformer) const
     {
         const auto& newPortElements = transformer.GetCorrespondingInputs(_input);
+
+        // A forest of threshold trees compiles as a single node, instead of a node per split and edge
+        if constexpr (std::is_same_v<ForestPredictor, predictors::SimpleForestPredictor>)
+        {
+            auto flatForestNode = transformer.AddNode<FlatForestPredictorNode>(newPortElements, _forest);
+            transformer.MapNodeOutput(output, flatForestNode->output);
+            transformer.MapNodeOutput(treeOutputs, flatForestNode->treeOutputs);
+            transformer.MapNodeOutput(edgeIndicatorVector, flatForestNode->edgeIndicatorVector);
+            return true;
+        }
+
         const auto& interiorNodes = _forest.GetInteriorNodes();
 
         // create a place to store references to the output ports of the sub-models at each interior node
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
 #include "NeuralNetworkLayerNode.h"
 
 #include <model/include/IRMapCompiler.h>
@@ -43,7 +44,11 @@ namespace nodes
         ///
         /// <param name="input"> </param>
         /// <param name="layer"> The bias layer to wrap. </param>
-        FullyConnectedLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::FullyConnectedLayer<ValueType>& layer);
+        /// <param name="epilogue"> The bias and activation to apply to the layer's output. </param>
+        FullyConnectedLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::FullyConnectedLayer<ValueType>& layer, const FusedEpilogue<ValueType>& epilogue = {});
+
+        /// <summary> Gets the bias and activation applied to the layer's output. </summary>
+        const FusedEpilogue<ValueType>& GetEpilogue() const { return _epilogue; }
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -59,10 +64,15 @@ namespace nodes
         bool IsCompilable(const model::MapCompiler* compiler) const override { return false; }
 
     protected:
+        void Compute() const override;
         bool Refine(model::ModelTransformer& transformer) const override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
+
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedElementwiseNode.h (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NodeOperations.h"
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <emitters/include/EmitterTypes.h>
+
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> The kinds of function a step of a `FusedElementwiseNode` can apply. </summary>
+    enum class ElementwiseStepType
+    {
+        unaryOperation,
+        binaryOperation,
+        reLU,
+        leakyReLU
+    };
+
+    /// <summary> One of the pointwise functions applied by a `FusedElementwiseNode`. </summary>
+    template <typename ValueType>
+    struct ElementwiseStep
+    {
+        /// <summary> Value of `operandDimension` for an operand with one value per active entry (in physical order). </summary>
+        static constexpr int allDimensions = -1;
+
+        ElementwiseStepType type = ElementwiseStepType::unaryOperation;
+        UnaryOperationType unaryOperation = UnaryOperationType::none; // for unaryOperation steps
+        BinaryOperationType binaryOperation = BinaryOperationType::none; // for binaryOperation steps
+
+        // The constant operand of a binaryOperation step: a single value, one value per entry along the
+        // (physical) dimension `operandDimension`, or one value per active entry
+        std::vector<ValueType> operand;
+        int operandDimension = 0;
+        bool operandIsFirst = false; // true if the operand is the left-hand side of the operation
+
+        ValueType parameter = 0; // the leaky factor of a leakyReLU step
+    };
+
+    /// <summary> A node that applies a sequence of pointwise functions to its input in a single pass, without storing
+    /// the intermediate results. Created by the elementwise operation fusion pass from chains of elementwise nodes. </summary>
+    template <typename ValueType, typename OutputValueType = ValueType>
+    class FusedElementwiseNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<OutputValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FusedElementwiseNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to process. </param>
+        /// <param name="inputLayout"> The memory layout of the input. </param>
+        /// <param name="outputLayout"> The memory layout of the output. Its active area must be the same shape as the input's. </param>
+        /// <param name="steps"> The functions to apply to each entry, in order. The result of the last one is cast to the output type. </param>
+        /// <param name="padding"> The value to write into the padding area of the output. </param>
+        FusedElementwiseNode(const model::OutputPort<ValueType>& input, const model::PortMemoryLayout& inputLayout, const model::PortMemoryLayout& outputLayout, const std::vector<ElementwiseStep<ValueType>>& steps, OutputValueType padding = 0);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType, OutputValueType>("FusedElementwiseNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Gets the memory layout of the input </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputLayout; }
+
+        /// <summary> Gets the memory layout of the output </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the functions this node applies </summary>
+        const std::vector<ElementwiseStep<ValueType>>& GetSteps() const { return _steps; }
+
+        /// <summary> Gets the value written to the padding area of the output </summary>
+        OutputValueType GetOutputPadding() const { return _paddingValue; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: steps, layouts, and padding value
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        void EmitComputeDimensionLoop(emitters::IRFunctionEmitter& function,
+                                      int dimension,
+                                      emitters::LLVMValue input,
+                                      emitters::LLVMValue output,
+                                      const std::vector<emitters::LLVMValue>& operands,
+                                      emitters::IRLocalScalar prevInputDimensionOffset,
+                                      emitters::IRLocalScalar prevOutputDimensionOffset,
+                                      emitters::IRLocalScalar prevEntryIndex,
+                                      std::vector<emitters::LLVMValue>& operandValues) const;
+
+        // Inputs
+        model::InputPort<ValueType> _input;
+        model::PortMemoryLayout _inputLayout;
+
+        // Output
+        model::OutputPort<OutputValueType> _output;
+
+        std::vector<ElementwiseStep<ValueType>> _steps;
+        OutputValueType _paddingValue;
+    };
+
+    /// <summary> The pointwise function an elementwise node computes, and the ports and layouts it computes it on. </summary>
+    template <typename ValueType>
+    struct ElementwiseNodeInfo
+    {
+        const model::OutputPort<ValueType>* input = nullptr;
+        const model::OutputPort<ValueType>* output = nullptr;
+        model::PortMemoryLayout inputLayout;
+        model::PortMemoryLayout outputLayout;
+        std::vector<ElementwiseStep<ValueType>> steps;
+        ValueType padding = 0;
+    };
+
+    /// <summary> Gets the function an elementwise node computes, as the steps of an equivalent `FusedElementwiseNode`.
+    /// Recognizes `FusedElementwiseNode`s, broadcast linear and activation function nodes, unary operations, and binary
+    /// operations with a constant operand. </summary>
+    ///
+    /// <param name="node"> The node. </param>
+    /// <param name="info"> Receives the node's function, ports and layouts. </param>
+    /// <returns> True if `node` is an elementwise node this function recognizes, else false. </returns>
+    template <typename ValueType>
+    bool TryGetElementwiseNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info);
+} // namespace nodes
+} // namespace ell
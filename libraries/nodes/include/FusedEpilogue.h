@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedEpilogue.h (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/PortMemoryLayout.h>
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRLocalScalar.h>
+
+#include <utilities/include/Archiver.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> The activation functions a `FusedEpilogue` can apply. </summary>
+    enum class EpilogueActivationType
+    {
+        none,
+        reLU,
+        leakyReLU,
+        parametricReLU,
+        hardSigmoid
+    };
+
+    /// <summary> A per-channel bias followed by an activation function, applied to the output of a convolution or
+    /// matrix product as it is written, instead of by separate bias and activation layers.
+    ///
+    /// Output entries are numbered in logical (row, column, channel) order of the active output area, and the channel of
+    /// an entry is its index along the last logical dimension. </summary>
+    template <typename ValueType>
+    struct FusedEpilogue
+    {
+        std::vector<ValueType> bias; // one value per output channel, or empty for no bias
+        EpilogueActivationType activation = EpilogueActivationType::none;
+        ValueType leakyFactor = 0; // for leakyReLU
+        std::vector<ValueType> alpha; // for parametricReLU: one value per active output entry
+
+        /// <summary> Returns true if the epilogue leaves its input unchanged. </summary>
+        bool IsEmpty() const { return bias.empty() && activation == EpilogueActivationType::none; }
+
+        /// <summary> Applies the epilogue to one output value. </summary>
+        ///
+        /// <param name="value"> The value to transform. </param>
+        /// <param name="channel"> The output channel of the value. </param>
+        /// <param name="entryIndex"> The index of the value in logical order. </param>
+        /// <returns> The transformed value. </returns>
+        ValueType Compute(ValueType value, int channel, int entryIndex) const;
+
+        /// <summary> Applies the epilogue in place to the active area of a 3D (row, column, channel) tensor. </summary>
+        ///
+        /// <param name="values"> The tensor's memory. </param>
+        /// <param name="layout"> The tensor's memory layout. </param>
+        void Compute(std::vector<ValueType>& values, const model::PortMemoryLayout& layout) const;
+
+        /// <summary> Adds the epilogue's properties to an archive. </summary>
+        ///
+        /// <param name="archiver"> The archiver. </param>
+        /// <param name="prefix"> The prefix of the properties' names, for nodes with more than one epilogue. </param>
+        void WriteToArchive(utilities::Archiver& archiver, const std::string& prefix = "epilogue") const;
+
+        /// <summary> Reads the epilogue's properties from an archive. The properties are optional, so nodes written before
+        /// epilogues existed read back with an empty epilogue. </summary>
+        ///
+        /// <param name="archiver"> The unarchiver. </param>
+        /// <param name="prefix"> The prefix of the properties' names, for nodes with more than one epilogue. </param>
+        void ReadFromArchive(utilities::Unarchiver& archiver, const std::string& prefix = "epilogue");
+    };
+
+    /// <summary> Emits the code for a `FusedEpilogue`. The epilogue's constants are emitted as global arrays when the
+    /// emitter is constructed, so the emitter can be used from any function in the module, including the task functions
+    /// of a parallel loop. </summary>
+    template <typename ValueType>
+    class FusedEpilogueEmitter
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="function"> The function being emitted. </param>
+        /// <param name="epilogue"> The epilogue to emit. </param>
+        /// <param name="name"> A unique prefix for the names of the epilogue's global arrays. </param>
+        FusedEpilogueEmitter(emitters::IRFunctionEmitter& function, const FusedEpilogue<ValueType>& epilogue, const std::string& name);
+
+        /// <summary> Returns true if the epilogue leaves its input unchanged. </summary>
+        bool IsEmpty() const { return _bias == nullptr && _activation == EpilogueActivationType::none; }
+
+        /// <summary> Emits the code to apply the epilogue to one output value. </summary>
+        ///
+        /// <param name="value"> The value to transform. </param>
+        /// <param name="channel"> The output channel of the value. </param>
+        /// <param name="entryIndex"> The index of the value in logical order. </param>
+        /// <returns> The transformed value. </returns>
+        emitters::IRLocalScalar Compile(emitters::IRLocalScalar value, emitters::IRLocalScalar channel, emitters::IRLocalScalar entryIndex) const;
+
+        /// <summary> Emits a loop that applies the epilogue in place to a range of output channels of a 3D (row, column, channel) tensor. </summary>
+        ///
+        /// <param name="function"> The function being emitted. </param>
+        /// <param name="output"> Pointer to the tensor's memory. </param>
+        /// <param name="layout"> The tensor's memory layout. </param>
+        /// <param name="beginChannel"> The first channel to transform. </param>
+        /// <param name="numChannels"> The number of channels to transform. </param>
+        void CompileChannels(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const model::PortMemoryLayout& layout, emitters::IRLocalScalar beginChannel, int numChannels) const;
+
+        /// <summary> Emits a loop that applies the epilogue in place to a contiguous range of output entries, stored in logical order without padding. </summary>
+        ///
+        /// <param name="function"> The function being emitted. </param>
+        /// <param name="output"> Pointer to the first entry of the output. </param>
+        /// <param name="beginEntry"> The index of the first entry to transform. </param>
+        /// <param name="numEntries"> The number of entries to transform. </param>
+        void CompileEntries(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, emitters::IRLocalScalar beginEntry, int numEntries) const;
+
+    private:
+        EpilogueActivationType _activation;
+        ValueType _leakyFactor;
+        int _numBiasChannels;
+        llvm::GlobalVariable* _bias = nullptr;
+        llvm::GlobalVariable* _alpha = nullptr;
+    };
+} // namespace nodes
+} // namespace ell
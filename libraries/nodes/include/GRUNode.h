@@ -20,6 +20,7 @@
 
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace ell
 {
@@ -47,6 +48,7 @@ namespace nodes
         /// <param name="activation"> The activation function. </param>
         /// <param name="recurrentActivation"> The recurrent activation function. </param>
         /// <param name="validateWeights"> Whether to check the size of the weights. </param>
+        /// <param name="sequenceLength"> The number of frames in the input. The output has one hidden state per frame. </param>
         GRUNode(const model::OutputPort<ValueType>& input,
                 const model::OutputPortBase& resetTrigger,
                 size_t hiddenUnits,
@@ -56,7 +58,8 @@ namespace nodes
                 const model::OutputPort<ValueType>& hiddenBias,
                 const ActivationType& activation,
                 const ActivationType& recurrentActivation,
-                bool validateWeights = true);
+                bool validateWeights = true,
+                size_t sequenceLength = 1);
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -72,14 +75,20 @@ namespace nodes
         void Reset() override;
 
     protected:
-        void Compute() const override;
+        using VectorType = math::ColumnVector<ValueType>;
+
+        void ComputeStep(const VectorType& input) const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void CompileHiddenUnitUpdate(emitters::IRFunctionEmitter& function,
+                                     const std::vector<emitters::IRLocalScalar>& inputGates,
+                                     const std::vector<emitters::IRLocalScalar>& hiddenGates,
+                                     emitters::IRLocalArray hiddenState,
+                                     emitters::IRLocalArray cellState,
+                                     emitters::IRLocalScalar unit) override;
         bool HasState() const override { return true; }
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
-
-        using VectorType = math::ColumnVector<ValueType>;
     };
 } // namespace nodes
 } // namespace ell
@@ -23,12 +23,19 @@
 
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace ell
 {
 namespace nodes
 {
-    ///<summary> LSTMnode implements a Long Short Term Memory network.  See http://colah.github.io/posts/2015-08-Understanding-LSTMs/. </summary>
+    ///<summary> LSTMnode implements a Long Short Term Memory network.  See http://colah.github.io/posts/2015-08-Understanding-LSTMs/.
+    ///
+    /// If the weights and biases come from constant nodes, the compiled node repacks them so the gates of each hidden unit
+    /// are adjacent, and applies the biases, the gate activations and the state update in a single pass over the output of
+    /// the matrix-vector products. With a sequence length greater than 1, the input is a window of frames and the output
+    /// is the hidden state after each frame; the input projections for the whole window are then computed with one
+    /// matrix-matrix product, and only the recurrent product is left per frame. </summary>
     template <typename ValueType>
     class LSTMNode : public RNNNode<ValueType>
     {
@@ -50,6 +57,7 @@ namespace nodes
         /// <param name="activation"> The activation function. </param>
         /// <param name="recurrentActivation"> The recurrent activation function. </param>
         /// <param name="validateWeights"> Whether to check the size of the weights. </param>
+        /// <param name="sequenceLength"> The number of frames in the input. The output has one hidden state per frame. </param>
         LSTMNode(const model::OutputPort<ValueType>& input,
                  const model::OutputPortBase& resetTrigger,
                  size_t hiddenUnits,
@@ -59,7 +67,13 @@ namespace nodes
                  const model::OutputPort<ValueType>& hiddenBias,
                  const ActivationType& activation,
                  const ActivationType& recurrentActivation,
-                 bool validateWeights = true);
+                 bool validateWeights = true,
+                 size_t sequenceLength = 1);
+
+        /// <summary> Gets the number of frames the node processes each time it is called. </summary>
+        ///
+        /// <returns> The sequence length. </returns>
+        size_t GetSequenceLength() const { return _sequenceLength; }
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -75,6 +89,8 @@ namespace nodes
         void Reset() override;
 
     protected:
+        using VectorType = math::ColumnVector<ValueType>;
+
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
         bool HasState() const override { return true; }
@@ -83,11 +99,26 @@ namespace nodes
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         void Copy(model::ModelTransformer& transformer) const override;
 
+        // Updates the state with one frame of input
+        virtual void ComputeStep(const VectorType& input) const;
+
+        // Emits the code shared by the LSTM and GRU nodes: the matrix products for all the gates, the loop over the hidden
+        // units that calls `CompileHiddenUnitUpdate`, and the reset logic
+        void CompileRecurrence(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int numGates, bool useCellState, const std::string& resetFunctionName);
+
+        // Emits the update of the state of one hidden unit. `inputGates` and `hiddenGates` hold W_i x + b_i and W_h h + b_h
+        // for each gate of the unit. `cellState` is only valid if `CompileRecurrence` was called with `useCellState`.
+        virtual void CompileHiddenUnitUpdate(emitters::IRFunctionEmitter& function,
+                                             const std::vector<emitters::IRLocalScalar>& inputGates,
+                                             const std::vector<emitters::IRLocalScalar>& hiddenGates,
+                                             emitters::IRLocalArray hiddenState,
+                                             emitters::IRLocalArray cellState,
+                                             emitters::IRLocalScalar unit);
+
         ActivationType _recurrentActivation;
+        size_t _sequenceLength = 1;
 
     private:
-        using VectorType = math::ColumnVector<ValueType>;
-
         // Additional Hidden state for compute
         mutable VectorType _cellState;
     };
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <emitters/include/IRFunctionEmitter.h>
 
 #include <model/include/CompilableNode.h>
@@ -81,7 +83,10 @@ namespace nodes
         /// <param name="transpose1"> If true, transpose the left-hand input matrix. </param>
         /// <param name="transpose2"> If true, transpose the right-hand input matrix. </param>
         /// <param name="transposeOutput"> If true, transpose the output matrix. </param>
-        MatrixMatrixMultiplyNode(const model::OutputPort<ValueType>& input1, int m, int n, int k, int matrix1Stride, bool transpose1, const model::OutputPort<ValueType>& input2, int matrix2Stride, bool transpose2, int outputMatrixStride, bool transposeOutput);
+        /// <param name="epilogue"> The bias and activation to apply to the output. The epilogue's channels are the rows of the
+        ///  m x n product, and its entries are numbered column by column, which is the (row, column, channel) order of an
+        ///  unrolled convolution's output. </param>
+        MatrixMatrixMultiplyNode(const model::OutputPort<ValueType>& input1, int m, int n, int k, int matrix1Stride, bool transpose1, const model::OutputPort<ValueType>& input2, int matrix2Stride, bool transpose2, int outputMatrixStride, bool transposeOutput, const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -104,6 +109,8 @@ namespace nodes
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
+        void CompileGEMM(emitters::IRFunctionEmitter& function, emitters::LLVMValue pInput1, emitters::LLVMValue pInput2, emitters::LLVMValue pOutput, int n);
+        void CompileEpiloguePanel(emitters::IRFunctionEmitter& function, const FusedEpilogueEmitter<ValueType>& epilogue, emitters::LLVMValue pInput1, emitters::LLVMValue pInput2, emitters::LLVMValue pOutput, emitters::IRLocalScalar panelBegin, int panelColumns);
 
         // Inputs
         model::InputPort<ValueType> _input1;
@@ -117,6 +124,7 @@ namespace nodes
         int _m = 0, _n = 0, _k = 0;
         int _lda = 0, _ldb = 0, _ldc = 0;
         bool _transpose1 = false, _transpose2 = false, _transposeOutput = false;
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
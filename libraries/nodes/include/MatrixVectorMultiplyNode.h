@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <model/include/CompilableNode.h>
 #include <model/include/IRMapCompiler.h>
 #include <model/include/InputPort.h>
@@ -51,7 +53,8 @@ namespace nodes
         ///
         /// <param name="inputMatrix"> The left-hand input of the matrix multiplication. </param>
         /// <param name="inputVector"> The right-hand input of the matrix multiplication. </param>
-        MatrixVectorMultiplyNode(const model::OutputPort<ValueType>& inputMatrix, size_t m, size_t n, size_t matrixStride, const model::OutputPort<ValueType>& inputVector);
+        /// <param name="epilogue"> The bias and activation to apply to the output vector. </param>
+        MatrixVectorMultiplyNode(const model::OutputPort<ValueType>& inputMatrix, size_t m, size_t n, size_t matrixStride, const model::OutputPort<ValueType>& inputVector, const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -66,6 +69,8 @@ namespace nodes
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool CanCompileBatch(model::IRMapCompiler& compiler) const override;
+        void CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: m, n, lda, incx
@@ -84,6 +89,7 @@ namespace nodes
         // Matrix is MxN, vector is of length N
         size_t _m, _n;
         size_t _lda, _incx;
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
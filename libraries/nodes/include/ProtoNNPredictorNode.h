@@ -8,30 +8,38 @@
 
 #pragma once
 
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/Model.h>
 #include <model/include/ModelTransformer.h>
 #include <model/include/Node.h>
 
+#include <math/include/Matrix.h>
+
 #include <predictors/include/ProtoNNPredictor.h>
 
 #include <string>
+#include <vector>
 
 namespace ell
 {
 namespace nodes
 {
     /// <summary> A node that represents a ProtoNN predictor. </summary>
+    ///
+    /// <typeparam name="ElementType"> The fundamental type used by this predictor. </typeparam>
+    template <typename ElementType>
     class ProtoNNPredictorNode : public model::Node
     {
     public:
         /// @name Input and Output Ports
         /// @{
-        const model::InputPort<double>& input = _input;
-        const model::OutputPort<double>& output = _output;
+        const model::InputPort<ElementType>& input = _input;
+        const model::OutputPort<ElementType>& output = _output;
 
         /// @}
 
-        using ProtoNNPredictor = predictors::ProtoNNPredictor;
+        using ProtoNNPredictor = predictors::ProtoNNPredictor<ElementType>;
 
         /// <summary> Default Constructor </summary>
         ProtoNNPredictorNode();
@@ -39,14 +47,13 @@ namespace nodes
         /// <summary> Constructor </summary>
         ///
         /// <param name="input"> The signal to predict from </param>
-        /// <param name="outputSize">The size of the output vector</param>
         /// <param name="predictor"> The ProtoNN predictor to use when making the prediction. </param>
-        ProtoNNPredictorNode(const model::OutputPort<double>& input, const ProtoNNPredictor& predictor);
+        ProtoNNPredictorNode(const model::OutputPort<ElementType>& input, const ProtoNNPredictor& predictor);
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
-        static std::string GetTypeName() { return "ProtoNNPredictorNode"; }
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ElementType>("ProtoNNPredictorNode"); }
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -65,22 +72,100 @@ namespace nodes
         void Copy(model::ModelTransformer& transformer) const override;
 
         // Inputs
-        model::InputPort<double> _input;
+        model::InputPort<ElementType> _input;
 
         // Output scores
-        model::OutputPort<double> _output;
+        model::OutputPort<ElementType> _output;
 
         // ProtoNN predictor
         ProtoNNPredictor _predictor;
     };
 
+    /// <summary> A node that computes the label scores of a ProtoNN predictor from its projected input: the similarity
+    /// exp(-gamma^2 * d) of the input to each prototype, where d is the squared distance between them, weighted by the
+    /// label embeddings of the prototype. A `ProtoNNPredictorNode` refines itself into a projection and this node.
+    ///
+    /// The compiled node computes the similarities of a block of prototypes at a time (a vector's worth, if vector
+    /// instructions are allowed), and adds their weighted similarities to the scores right away, so it never stores the
+    /// distances to all the prototypes. If the map is compiled with `parallelize` and there are many prototypes, the tasks
+    /// split the prototypes, and their partial scores are summed at the end. </summary>
+    ///
+    /// <typeparam name="ElementType"> The element type. </typeparam>
+    template <typename ElementType>
+    class ProtoNNLabelScoresNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ElementType>& input = _input;
+        const model::OutputPort<ElementType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        ProtoNNLabelScoresNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The projected input. </param>
+        /// <param name="prototypes"> The prototypes, one per column. </param>
+        /// <param name="labelEmbeddings"> The label embeddings, with one row per label and one column per prototype. </param>
+        /// <param name="gamma"> The gamma value. </param>
+        ProtoNNLabelScoresNode(const model::OutputPort<ElementType>& input, const math::ColumnMatrix<ElementType>& prototypes, const math::ColumnMatrix<ElementType>& labelEmbeddings, ElementType gamma);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ElementType>("ProtoNNLabelScoresNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: prototypes, label embeddings and gamma
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        void EmitPrototypeBlocks(emitters::IRFunctionEmitter& function,
+                                 emitters::LLVMValue pInput,
+                                 emitters::LLVMValue pPrototypes,
+                                 emitters::LLVMValue pLabelEmbeddings,
+                                 emitters::LLVMValue pScores,
+                                 emitters::LLVMValue beginBlock,
+                                 emitters::LLVMValue endBlock,
+                                 int blockSize,
+                                 int firstPrototype);
+
+        emitters::IRFunctionEmitter GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& arguments, int blockSize);
+
+        // Input
+        model::InputPort<ElementType> _input;
+
+        // Output scores
+        model::OutputPort<ElementType> _output;
+
+        // Stored with one column per prototype and in row-major order, so the entries of a block of prototypes are contiguous
+        math::RowMatrix<ElementType> _prototypes;
+        math::RowMatrix<ElementType> _labelEmbeddings;
+
+        ElementType _gamma = 0;
+    };
+
     /// <summary> Adds a ProtoNN predictor node to a model transformer. </summary>
     ///
+    /// <typeparam name="ElementType"> The fundamental type used by this predictor. </typeparam>
     /// <param name="input"> The input to the predictor. </param>
     /// <param name="predictor"> The ProtoNN predictor. </param>
     /// <param name="transformer"> [in,out] The model transformer. </param>
     ///
     /// <returns> The node added to the model. </returns>
-    ProtoNNPredictorNode* AddNodeToModelTransformer(const model::PortElements<double>& input, const predictors::ProtoNNPredictor& predictor, model::ModelTransformer& transformer);
+    template <typename ElementType>
+    ProtoNNPredictorNode<ElementType>* AddNodeToModelTransformer(const model::PortElements<ElementType>& input, const predictors::ProtoNNPredictor<ElementType>& predictor, model::ModelTransformer& transformer);
 } // namespace nodes
 } // namespace ell
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <math/include/Tensor.h>
 
 #include <model/include/IRMapCompiler.h>
@@ -49,11 +51,13 @@ namespace nodes
         /// <param name="filterWeights"> The weights for the convolutional filters. Stored
         ///  as a 3D tensor of dimensions (nf*fw) x fw x d, where nf == # filters, fw == filter width, and d == input depth. </param>
         /// <param name="stride"> The output stride. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         SimpleConvolutionNode(const model::OutputPort<ValueType>& input,
                               const model::PortMemoryLayout& inputMemoryLayout,
                               const model::PortMemoryLayout& outputMemoryLayout,
                               const ConstTensorReferenceType& filterWeights,
-                              size_t stride);
+                              size_t stride,
+                              const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -105,6 +109,7 @@ namespace nodes
 
         int _stride = 1;
         bool _isDepthwiseSeparable = false;
+        FusedEpilogue<ValueType> _epilogue;
     };
 
     //
@@ -138,13 +143,15 @@ namespace nodes
         /// <param name="filterSize"> The filter width. </param>
         /// <param name="stride"> The output stride. </param>
         /// <param name="isDepthwiseSeparable"> Boolean value indicating whether the convolution is depthwise separable. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         SimpleConvolutionComputeNode(const model::OutputPort<ValueType>& input,
                                      const model::OutputPort<ValueType>& filterWeights,
                                      const model::PortMemoryLayout& inputMemoryLayout,
                                      const model::PortMemoryLayout& outputMemoryLayout,
                                      int filterSize,
                                      int stride,
-                                     bool isDepthwiseSeparable);
+                                     bool isDepthwiseSeparable,
+                                     const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -194,6 +201,7 @@ namespace nodes
         int _stride = 1;
 
         bool _isDepthwiseSeparable = false;
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
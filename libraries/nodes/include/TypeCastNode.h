@@ -57,6 +57,8 @@ namespace nodes
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
         bool ShouldCompileInline() const override { return true; }
+        bool CanCompileBatch(model::IRMapCompiler& compiler) const override { return true; }
+        void CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return false; }
@@ -163,6 +165,21 @@ namespace nodes
         }
     }
 
+    template <typename InputValueType, typename OutputValueType>
+    void TypeCastNode<InputValueType, OutputValueType>::CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        const int size = static_cast<int>(input.Size());
+        emitters::LLVMValue pInputs = compiler.GetBatchPortValues(input);
+        emitters::LLVMValue pResults = compiler.GetBatchPortValues(output);
+
+        // A constant input has one copy of its values for the whole batch
+        const bool isShared = compiler.IsBatchPortShared(input);
+        function.For(batchSize * size, [pInputs, pResults, size, isShared](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar i) {
+            emitters::LLVMValue inputValue = function.ValueAt(pInputs, isShared ? (i % size) : i);
+            function.SetValueAt(pResults, i, function.CastValue<OutputValueType>(inputValue));
+        });
+    }
+
     template <typename InputValueType, typename OutputValueType>
     void TypeCastNode<InputValueType, OutputValueType>::WriteToArchive(utilities::Archiver& archiver) const
     {
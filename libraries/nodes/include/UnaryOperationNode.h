@@ -69,6 +69,8 @@ namespace nodes
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool CanCompileBatch(model::IRMapCompiler& compiler) const override;
+        void CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize) override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: operation
@@ -77,6 +79,7 @@ namespace nodes
         void Copy(model::ModelTransformer& transformer) const override;
 
         void CompileLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
+        void CompileElementwiseLoop(emitters::IRFunctionEmitter& function, emitters::LLVMValue pInput, emitters::LLVMValue pResult, int count);
         void CompileExpanded(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
 
         // Inputs
@@ -98,6 +101,24 @@ namespace nodes
     template <typename ValueType>
     const model::OutputPort<ValueType>& AppendUnaryOperation(const model::OutputPort<ValueType>& input, UnaryOperationType operation);
 
+    /// <summary> Applies a unary operation to a single value. </summary>
+    ///
+    /// <param name="value"> The value to apply the operation to. </param>
+    /// <param name="operation"> The operation to apply. </param>
+    ///
+    /// <returns> The result of the operation. </returns>
+    template <typename ValueType>
+    ValueType ComputeUnaryOperation(ValueType value, UnaryOperationType operation);
+
+    /// <summary> Emits code that applies a unary operation to a scalar or vector value. </summary>
+    ///
+    /// <param name="value"> The value to apply the operation to. </param>
+    /// <param name="operation"> The operation to apply. </param>
+    ///
+    /// <returns> The result of the operation. </returns>
+    template <typename ValueType>
+    emitters::IRLocalScalar CompileUnaryOperation(emitters::IRLocalScalar value, UnaryOperationType operation);
+
     inline namespace operations
     {
         template <typename ValueType>
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <math/include/Tensor.h>
 
 #include <model/include/IRMapCompiler.h>
@@ -24,6 +26,11 @@ namespace nodes
     /// <summary> A node that implements convolution using matrix multiply on a reshaped input image. </summary>
     /// If Unrolled convolution is specified, a ConvolutionalLayerNode will refine
     /// itself into a UnrolledConvolutionNode.
+    ///
+    /// When the input is in (row, column, channel) order and the output isn't padded, the node compiles itself: the output
+    /// pixels are split into one band per thread, and each task unrolls its band and multiplies it by the weights in panels
+    /// small enough that a panel's unrolled receptive fields stay in the L2 cache, so the whole unrolled matrix never exists.
+    /// Otherwise, the node refines itself into a `ReceptiveFieldMatrixNode` and a `MatrixMatrixMultiplyNode`.
     template <typename ValueType>
     class UnrolledConvolutionNode : public model::CompilableNode
     {
@@ -48,11 +55,13 @@ namespace nodes
         /// <param name="inputMemoryLayout"> The layout of the input data. </param>
         /// <param name="filterWeights"> The weights for the convolutional filters. </param>
         /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         UnrolledConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 const ConstTensorReferenceType& filterWeights,
-                                int stride);
+                                int stride,
+                                const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Constructor. </summary>
         ///
@@ -60,12 +69,14 @@ namespace nodes
         /// <param name="inputMemoryLayout"> The layout of the input data. </param>
         /// <param name="filterWeights"> The weights for the convolutional filters, expressed as a matrix. </param>
         /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         UnrolledConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 ConstMatrixReferenceType filterWeights,
                                 int filterSize,
-                                int stride);
+                                int stride,
+                                const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -93,7 +104,7 @@ namespace nodes
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
         /// <summary> Indicates if this node is able to compile itself to code. </summary>
-        bool IsCompilable(const model::MapCompiler* compiler) const override { return _isDepthwiseSeparable; }
+        bool IsCompilable(const model::MapCompiler* compiler) const override { return _isDepthwiseSeparable || CanCompileInPanels(); }
 
     protected:
         bool Refine(model::ModelTransformer& transformer) const override;
@@ -108,6 +119,10 @@ namespace nodes
 
         MatrixType GetWeightsMatrix(const ConstTensorReferenceType& weightsTensor) const;
 
+        // Returns true if the memory layouts let the node unroll and multiply the input a panel at a time
+        bool CanCompileInPanels() const;
+        void CompileInPanels(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
+
         // Input
         model::InputPort<ValueType> _input;
 
@@ -121,6 +136,7 @@ namespace nodes
         int _filterSize = 0;
         int _stride = 1;
         bool _isDepthwiseSeparable = false;
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
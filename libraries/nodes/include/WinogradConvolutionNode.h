@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FusedEpilogue.h"
+
 #include <emitters/include/LLVMUtilities.h>
 
 #include <dsp/include/WinogradConvolution.h>
@@ -54,11 +56,30 @@ namespace nodes
         /// <param name="filterWeights"> The weights for the convolutional filters. </param>
         /// <param name="outputMemoryLayout"> The layout of the output data. </param>
         /// <param name="stride"> The number of elements to move/jump when sliding over the input. Typically this is 1 to 3. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
+        WinogradConvolutionNode(const model::OutputPort<ValueType>& input,
+                                const model::PortMemoryLayout& inputMemoryLayout,
+                                const model::PortMemoryLayout& outputMemoryLayout,
+                                const ConstTensorReferenceType& filterWeights,
+                                int stride,
+                                const FusedEpilogue<ValueType>& epilogue = {});
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The port to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. </param>
+        /// <param name="filterWeights"> The weights for the convolutional filters. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="stride"> The number of elements to move/jump when sliding over the input. Typically this is 1 to 3. </param>
+        /// <param name="tileSize"> The size of the output tiles --- the number of output values to produce at a time. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         WinogradConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 const ConstTensorReferenceType& filterWeights,
-                                int stride);
+                                int stride,
+                                int tileSize,
+                                const FusedEpilogue<ValueType>& epilogue);
 
         /// <summary> Constructor. </summary>
         ///
@@ -69,13 +90,15 @@ namespace nodes
         /// <param name="stride"> The number of elements to move/jump when sliding over the input. Typically this is 1 to 3. </param>
         /// <param name="tileSize"> The size of the output tiles --- the number of output values to produce at a time. </param>
         /// <param name="order"> The order to process filter data during convolution. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         WinogradConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 const ConstTensorReferenceType& filterWeights,
                                 int stride,
                                 int tileSize,
-                                FilterOrder order);
+                                FilterOrder order,
+                                const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Cloning constructor </summary>
         ///
@@ -135,6 +158,7 @@ namespace nodes
         int _tileSize = 0;
         int _filterSize = 0;
         FilterOrder _order = FilterOrder::tilesFirst;
+        FusedEpilogue<ValueType> _epilogue;
     };
 
     //
@@ -172,6 +196,7 @@ namespace nodes
         /// <param name="tileSize"> The spatial size of the filters. </param>
         /// <param name="order"> The order to process filter data during convolution. </param>
         /// <param name="numFilterChannels"> The number of channels per filter. </param>
+        /// <param name="epilogue"> The bias and activation to apply to the output. </param>
         WinogradConvolutionComputeNode(const model::OutputPort<ValueType>& input,
                                        const model::OutputPort<ValueType>& filterWeights,
                                        const model::PortMemoryLayout& inputMemoryLayout,
@@ -180,7 +205,8 @@ namespace nodes
                                        int tileSize,
                                        int filterSize,
                                        FilterOrder order,
-                                       int numFilterChannels);
+                                       int numFilterChannels,
+                                       const FusedEpilogue<ValueType>& epilogue = {});
 
         /// <summary> Gets information about the input memory layout </summary>
         const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
@@ -220,7 +246,15 @@ namespace nodes
         bool HasState() const override { return true; } // stored state: convolutional parameters and memory layout
 
     private:
+        // The number of filters and filter channels the 'filtersFirst' order processes at a time
+        struct FiltersFirstBlockDepths
+        {
+            int filters;
+            int filterChannels;
+        };
+
         void CompileFiltersFirst(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::IRLocalArray input, emitters::IRLocalArray transformedFilters, emitters::IRLocalArray output);
+        void CompileFiltersFirstTileRows(emitters::IRFunctionEmitter& function, emitters::IRLocalArray input, emitters::IRLocalArray transformedFilters, emitters::IRLocalArray output, FiltersFirstBlockDepths blockDepths, const FusedEpilogueEmitter<ValueType>& epilogue, emitters::IRLocalScalar beginTileRow, emitters::IRLocalScalar endTileRow, bool includePartialTileRow);
         void CompileTilesFirst(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::IRLocalArray input, emitters::IRLocalArray transformedFilters, emitters::IRLocalArray output);
         void Copy(model::ModelTransformer& transformer) const override;
 
@@ -244,6 +278,8 @@ namespace nodes
         // Tunable parameters
         int _inputBlockSize = 1;
         int _outputBlockSize = 1;
+
+        FusedEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
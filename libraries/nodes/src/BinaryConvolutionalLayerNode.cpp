@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <utility>
 
 namespace ell
 {
@@ -32,6 +33,15 @@ namespace nodes
         // convolution parameters
         const auto scaleOutputByFilterMeans = ell::predictors::neural::BinaryWeightsScale::mean;
 
+        // The number of filters whose weights are combined with each block of the packed input
+        const int filterBlockSize = 4;
+
+        // The number of vector blocks summed by each step of the Harley-Seal popcount
+        const int carrySaveGroupSize = 8;
+
+        // The name of the optimizer option that selects the blocked xnor kernel and vectorized bit-packing
+        const char* blockFiltersOptionName = "blockBinaryConvolutionFilters";
+
         //
         // Functions
         //
@@ -101,7 +111,7 @@ namespace nodes
         }
 
         template <typename ValueType, typename PackedBitsType>
-        void CompressRow(emitters::IRFunctionEmitter& function, emitters::LLVMValue realRow, emitters::LLVMValue packedOutput, int numValues)
+        void CompressRow(emitters::IRFunctionEmitter& function, emitters::LLVMValue realRow, emitters::LLVMValue packedOutput, int numValues, bool useVectorInstructions)
         {
             int storedElementSize = sizeof(PackedBitsType);
             int storedElementNumBits = 8 * storedElementSize;
@@ -110,21 +120,42 @@ namespace nodes
 
             auto input = function.LocalArray(realRow);
             auto output = function.LocalArray(packedOutput);
-            function.For(numCompleteBlocks, [storedElementNumBits, input, output](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
-                auto blockIndex = function.LocalScalar(i);
-
-                // TODO: block-vectorize this:
-                auto blockValue = function.LocalScalar<PackedBitsType>(0);
-                for (int bitIndex = 0; bitIndex < storedElementNumBits; ++bitIndex)
-                {
-                    auto realValue = input[(blockIndex * storedElementNumBits) + bitIndex];
-                    auto cmp = realValue > static_cast<ValueType>(0);
-                    auto bitValue = function.LocalScalar(function.Select(cmp, function.Literal<PackedBitsType>(1), function.Literal<PackedBitsType>(0)));
-                    // blockValue = blockValue | ((realValue>0?1:0) << bitIndex);
-                    blockValue = blockValue | (bitValue << function.LocalScalar<PackedBitsType>(bitIndex));
-                }
-                output[blockIndex] = blockValue;
-            });
+            if (useVectorInstructions)
+            {
+                // Compare a whole block of values at once, and reinterpret the vector of comparison results as an integer.
+                // On our (little-endian) targets, element i of the vector becomes bit i of the integer, as in the scalar version.
+                auto& emitter = function.GetEmitter();
+                auto valueType = emitter.Type(emitters::GetVariableType<ValueType>());
+                auto packedBitsType = emitter.Type(emitters::GetVariableType<PackedBitsType>());
+                auto vectorPointerType = emitter.VectorType(valueType, storedElementNumBits)->getPointerTo();
+
+                // The scratch row is only guaranteed to be aligned to its element type
+                const auto alignment = function.GetModule().GetTargetDataLayout().getABITypeAlignment(valueType);
+                function.For(numCompleteBlocks, [=](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto& builder = function.GetEmitter().GetIRBuilder();
+                    auto blockIndex = function.LocalScalar(i);
+                    auto realValues = builder.CreateAlignedLoad(function.CastPointer(function.PointerOffset(realRow, blockIndex * storedElementNumBits), vectorPointerType), alignment);
+                    auto signs = function.Comparison(emitters::TypedComparison::greaterThanFloat, realValues, function.Literal<ValueType>(0));
+                    function.SetValueAt(packedOutput, blockIndex, function.BitCast(signs, packedBitsType));
+                });
+            }
+            else
+            {
+                function.For(numCompleteBlocks, [storedElementNumBits, input, output](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto blockIndex = function.LocalScalar(i);
+
+                    auto blockValue = function.LocalScalar<PackedBitsType>(0);
+                    for (int bitIndex = 0; bitIndex < storedElementNumBits; ++bitIndex)
+                    {
+                        auto realValue = input[(blockIndex * storedElementNumBits) + bitIndex];
+                        auto cmp = realValue > static_cast<ValueType>(0);
+                        auto bitValue = function.LocalScalar(function.Select(cmp, function.Literal<PackedBitsType>(1), function.Literal<PackedBitsType>(0)));
+                        // blockValue = blockValue | ((realValue>0?1:0) << bitIndex);
+                        blockValue = blockValue | (bitValue << function.LocalScalar<PackedBitsType>(bitIndex));
+                    }
+                    output[blockIndex] = blockValue;
+                });
+            }
 
             // now do the last, partial, block
             if (numBlocks > numCompleteBlocks)
@@ -147,6 +178,16 @@ namespace nodes
             }
         }
 
+        // Adds three bit vectors with a carry-save adder, returning the carry and sum bits
+        std::pair<emitters::LLVMValue, emitters::LLVMValue> CarrySaveAdd(emitters::IRFunctionEmitter& function, emitters::LLVMValue a, emitters::LLVMValue b, emitters::LLVMValue c)
+        {
+            auto& builder = function.GetEmitter().GetIRBuilder();
+            auto aXorB = builder.CreateXor(a, b);
+            auto carries = builder.CreateOr(builder.CreateAnd(a, b), builder.CreateAnd(aXorB, c));
+            auto sums = builder.CreateXor(aXorB, c);
+            return { carries, sums };
+        }
+
         void PushPackedBits(std::vector<int64_t>& vec, const std::vector<uint64_t>& bits)
         {
             vec.insert(vec.end(), bits.begin(), bits.end());
@@ -245,7 +286,8 @@ namespace nodes
             xnorOutput = AddRefinedNodes<int64_t>(transformer, newInput);
         }
 
-        // Output of xnor is in (f x h x w) order, need to transpose to the canonical (h x w x f) order
+        // Output of xnor is in (f x h x w) order, need to transpose to the canonical (h x w x f) order. The xnor node's
+        // output port says so, so the reorder is a plain permutation that a later layout pass can remove.
         model::PortMemoryLayout outputShape(model::MemoryShape{ numFilters, outputImageHeight, outputImageWidth }, model::DimensionOrder{ 2, 0, 1 }); // Note: memory layout constructor takes the sizes in physical dimension order
         model::PortMemoryLayout transposedOutputShape(model::MemoryShape{ outputImageHeight, outputImageWidth, numFilters }, model::MemoryShape{ outputDataPadding, outputDataPadding, 0 }, model::DimensionOrder{ 0, 1, 2 });
         auto reorderOutputNode = transformer.AddNode<ReorderDataNode<ValueType>>(xnorOutput, outputShape, transposedOutputShape);
@@ -283,7 +325,7 @@ namespace nodes
                                                                                        convParams,
                                                                                        layerParams.inputPaddingParameters,
                                                                                        inputLayout,
-                                                                                       outputLayout);
+                                                                                       outputLayout.ReorderedCopy(model::DimensionOrder{ 2, 0, 1 }));
 
         return { xnorNode->output };
     }
@@ -359,6 +401,7 @@ namespace nodes
 
         int packedRowSize = (fieldVolumeSize - 1) / numBits + 1;
         assert(packedRowSize != 0);
+        const bool useVectorInstructions = function.GetCompilerOptions().allowVectorInstructions && compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>(blockFiltersOptionName, true);
 
         auto argTypes = emitters::GetLLVMTypes({ inputTemp, outputTemp, function.Literal<int32_t>(0), function.Literal<int32_t>(0) });
         emitters::IRFunctionEmitter taskFunction = function.GetModule().BeginFunction(utilities::to_string(GetId()) + "_task", voidType, argTypes);
@@ -373,7 +416,7 @@ namespace nodes
 
             // TODO: interleave load/compress more tightly to eliminate need for a scratch variable to hold a whole row
             llvm::AllocaInst* realValueRow = taskFunction.Variable(emitters::GetVariableType<ValueType>(), fieldVolumeSize);
-            taskFunction.For(begin, end, [this, pInput, pOutput, packedRowSize, fieldVolumeSize, realValueRow](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue i) {
+            taskFunction.For(begin, end, [this, pInput, pOutput, packedRowSize, fieldVolumeSize, realValueRow, useVectorInstructions](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue i) {
                 auto outputRowIndex = taskFunction.LocalScalar(i);
                 LoadRow<ValueType>(taskFunction,
                                    pInput,
@@ -384,7 +427,7 @@ namespace nodes
                                    realValueRow);
 
                 auto outputRow = taskFunction.PointerOffset(pOutput, outputRowIndex * packedRowSize);
-                CompressRow<ValueType, PackedBitsType>(taskFunction, realValueRow, outputRow, fieldVolumeSize);
+                CompressRow<ValueType, PackedBitsType>(taskFunction, realValueRow, outputRow, fieldVolumeSize, useVectorInstructions);
             });
             taskFunction.Return();
         }
@@ -415,6 +458,7 @@ namespace nodes
         const auto outputImageHeight = _outputMemoryLayout.GetActiveSize(0);
         const auto outputImageWidth = _outputMemoryLayout.GetActiveSize(1);
         const auto numOutputRows = outputImageWidth * outputImageHeight;
+        const bool useVectorInstructions = compilerSettings.allowVectorInstructions && compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>(blockFiltersOptionName, true);
 
         const auto numDesiredTasks = compilerSettings.maxThreads;
         const int taskSize = CeilDiv(numOutputRows, numDesiredTasks);
@@ -436,7 +480,7 @@ namespace nodes
         {
             // TODO: interleave load/compress more tightly to eliminate need for a scratch variable to hold the whole row
             llvm::AllocaInst* realValueRow = function.Variable(emitters::GetVariableType<ValueType>(), fieldVolumeSize);
-            function.For(numOutputRows, [this, pInput, pOutput, realValueRow, packedRowSize, fieldVolumeSize](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+            function.For(numOutputRows, [this, pInput, pOutput, realValueRow, packedRowSize, fieldVolumeSize, useVectorInstructions](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
                 auto outputRowIndex = function.LocalScalar(i);
                 LoadRow<ValueType>(function,
                                    pInput,
@@ -447,7 +491,7 @@ namespace nodes
                                    realValueRow);
 
                 auto outputRow = function.PointerOffset(pOutput, outputRowIndex * static_cast<int>(packedRowSize));
-                CompressRow<ValueType, PackedBitsType>(function, realValueRow, outputRow, fieldVolumeSize);
+                CompressRow<ValueType, PackedBitsType>(function, realValueRow, outputRow, fieldVolumeSize, useVectorInstructions);
             });
         }
     }
@@ -573,9 +617,8 @@ namespace nodes
         const auto& inputLayout = this->GetInputMemoryLayout();
         const auto& inputSize = inputLayout.GetActiveSize();
 
-        const auto& outputLayout = this->GetOutputMemoryLayout();
-        // const auto& outputLayout = this->GetOutputMemoryLayout().ReorderedCopy({2,0,1}); // TODO: reorder from r,c,d -> d,r,c
-        const auto& outputSize = outputLayout.GetActiveSize();
+        // The output is in (f x h x w) order, so get its sizes in the logical (h x w x f) order
+        const auto outputSize = this->GetOutputMemoryLayout().GetLogicalDimensionActiveSize();
 
         // The workspace buffer element sizes are dependent on the processor architecture's bitness
         const auto storedElementSize = sizeof(PackedBitsType);
@@ -587,9 +630,6 @@ namespace nodes
         const auto numInputChannels = inputSize[2]; // inputSize is the dimensions of the input to the original layer node
         const auto fieldVolumeSize = filterWidth * filterWidth * numInputChannels; // = size*size*numInputChannels
 
-        // TODO: Put this back once we're using the transposed output layout
-        // const auto numFilters = outputSize[0]; // == # output rows
-        // const auto outputColumns = outputSize[1] * outputSize[2];
         const auto numFilters = outputSize[2]; // == # output rows
         const auto outputColumns = outputSize[0] * outputSize[1];
         const auto numStoredBlocksPerFilter = (fieldVolumeSize - 1) / storedElementNumBits + 1;
@@ -610,23 +650,48 @@ namespace nodes
             useVectorInstructions = false;
         }
 
+        // The blocked kernel splits the rows of the output image among the tasks, so each task reads its part of the packed
+        // input only once. Otherwise, the tasks split the filters.
+        const bool blockFilters = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>(blockFiltersOptionName, true);
+        const int numTaskItems = blockFilters ? outputSize[0] : numFilters;
+        const int taskItemSize = blockFilters ? outputSize[1] : 1;
+
         const int numDesiredTasks = compilerSettings.maxThreads;
-        const int taskSize = CeilDiv(numFilters, numDesiredTasks);
-        const int numTasks = CeilDiv(numFilters, taskSize);
+        const int taskSize = CeilDiv(numTaskItems, numDesiredTasks);
+        const int numTasks = CeilDiv(numTaskItems, taskSize);
         if (compilerSettings.parallelize && numTasks > 1)
         {
-            auto taskFunction = GetTaskFunction(compiler, function);
+            auto taskFunction = GetTaskFunction(compiler, function, blockFilters);
             std::vector<std::vector<emitters::LLVMValue>> taskArgs;
             for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
             {
-                auto start = taskIndex * taskSize;
-                auto end = std::min((taskIndex + 1) * taskSize, numFilters);
+                auto start = taskIndex * taskSize * taskItemSize;
+                auto end = std::min((taskIndex + 1) * taskSize, numTaskItems) * taskItemSize;
                 std::vector<emitters::LLVMValue> args = { pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, function.Literal<int32_t>(start), function.Literal<int32_t>(end) };
                 taskArgs.push_back(args);
             }
             auto tasks = function.StartTasks(taskFunction, taskArgs);
             tasks.WaitAll(function);
         }
+        else if (blockFilters)
+        {
+            ComputeOutputPixels(function,
+                                pInput,
+                                pFilterWeights,
+                                pFilterMeans,
+                                pInputPaddingMask,
+                                pInputPaddingMaskSums,
+                                pOutput,
+                                function.Literal<int32_t>(0),
+                                function.Literal<int32_t>(outputColumns),
+                                hasZeroPadding,
+                                outputColumns,
+                                numFilters,
+                                packedRowSize,
+                                packedRowStride,
+                                vectorSize,
+                                numVectorBlocks);
+        }
         else // single-threaded
         {
             function.For(numFilters, [=, &compiler](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
@@ -652,7 +717,7 @@ namespace nodes
     }
 
     template <typename ValueType, typename PackedBitsType>
-    emitters::IRFunctionEmitter BinaryXnorNode<ValueType, PackedBitsType>::GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    emitters::IRFunctionEmitter BinaryXnorNode<ValueType, PackedBitsType>::GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, bool blockFilters)
     {
         // Get port variables
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
@@ -674,9 +739,8 @@ namespace nodes
         const auto& inputLayout = this->GetInputMemoryLayout();
         const auto& inputSize = inputLayout.GetActiveSize();
 
-        const auto& outputLayout = this->GetOutputMemoryLayout();
-        // const auto& outputLayout = this->GetOutputMemoryLayout().ReorderedCopy({2,0,1}); // TODO: reorder from r,c,d -> d,r,c
-        const auto& outputSize = outputLayout.GetActiveSize();
+        // The output is in (f x h x w) order, so get its sizes in the logical (h x w x f) order
+        const auto outputSize = this->GetOutputMemoryLayout().GetLogicalDimensionActiveSize();
 
         // The workspace buffer element sizes are dependent on the processor architecture's bitness
         const auto storedElementSize = sizeof(PackedBitsType);
@@ -688,8 +752,7 @@ namespace nodes
         const auto numInputChannels = inputSize[2]; // inputSize is the dimensions of the input to the original layer node
         const auto fieldVolumeSize = filterWidth * filterWidth * numInputChannels; // = size*size*numInputChannels
 
-        // TODO: Put this back once we're using the transposed output layout
-        // const auto outputColumns = outputSize[1] * outputSize[2];
+        const auto numFilters = outputSize[2];
         const auto outputColumns = outputSize[0] * outputSize[1];
         const auto numStoredBlocksPerFilter = (fieldVolumeSize - 1) / storedElementNumBits + 1;
         const auto packedRowSize = numStoredBlocksPerFilter; // numStoredBlocksPerFilter * (storedElementSize / elementSize);
@@ -728,24 +791,46 @@ namespace nodes
             auto blockStartVal = &(*arguments++);
             auto blockEndVal = &(*arguments++);
 
-            taskFunction.For(blockStartVal, blockEndVal, taskFunction.Literal<int>(1), [pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, hasZeroPadding, outputColumns, packedRowSize, packedRowStride, useVectorInstructions, vectorSize, numVectorBlocks, &compiler, this](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue filterIndex) {
-                ComputeFilterOutput(compiler,
-                                    taskFunction,
+            if (blockFilters) // The arguments are the range of output pixels for this task
+            {
+                ComputeOutputPixels(taskFunction,
                                     pInput,
                                     pFilterWeights,
                                     pFilterMeans,
                                     pInputPaddingMask,
                                     pInputPaddingMaskSums,
                                     pOutput,
-                                    filterIndex,
+                                    blockStartVal,
+                                    blockEndVal,
                                     hasZeroPadding,
                                     outputColumns,
+                                    numFilters,
                                     packedRowSize,
                                     packedRowStride,
-                                    useVectorInstructions,
                                     vectorSize,
                                     numVectorBlocks);
-            });
+            }
+            else // The arguments are the range of filters for this task
+            {
+                taskFunction.For(blockStartVal, blockEndVal, taskFunction.Literal<int>(1), [pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, hasZeroPadding, outputColumns, packedRowSize, packedRowStride, useVectorInstructions, vectorSize, numVectorBlocks, &compiler, this](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue filterIndex) {
+                    ComputeFilterOutput(compiler,
+                                        taskFunction,
+                                        pInput,
+                                        pFilterWeights,
+                                        pFilterMeans,
+                                        pInputPaddingMask,
+                                        pInputPaddingMaskSums,
+                                        pOutput,
+                                        filterIndex,
+                                        hasZeroPadding,
+                                        outputColumns,
+                                        packedRowSize,
+                                        packedRowStride,
+                                        useVectorInstructions,
+                                        vectorSize,
+                                        numVectorBlocks);
+                });
+            }
 
             taskFunction.Return();
         }
@@ -899,6 +984,246 @@ namespace nodes
         });
     }
 
+    template <typename ValueType, typename PackedBitsType>
+    void BinaryXnorNode<ValueType, PackedBitsType>::ComputeOutputPixels(emitters::IRFunctionEmitter& function,
+                                                                        emitters::LLVMValue pInput,
+                                                                        emitters::LLVMValue pFilterWeights,
+                                                                        emitters::LLVMValue pFilterMeans,
+                                                                        emitters::LLVMValue pInputPaddingMask,
+                                                                        emitters::LLVMValue pInputPaddingMaskSums,
+                                                                        emitters::LLVMValue pOutput,
+                                                                        emitters::LLVMValue beginPixel,
+                                                                        emitters::LLVMValue endPixel,
+                                                                        bool hasZeroPadding,
+                                                                        int outputColumns,
+                                                                        int numFilters,
+                                                                        int packedRowSize,
+                                                                        int packedRowStride,
+                                                                        int vectorSize,
+                                                                        int numVectorBlocks)
+    {
+        const auto& inputSize = this->GetInputMemoryLayout().GetActiveSize();
+        const int numBits = 8 * sizeof(PackedBitsType);
+        const int filterWidth = static_cast<int>(_convolutionalParameters.receptiveField);
+        const int fieldVolumeSize = filterWidth * filterWidth * inputSize[2];
+        const int partialBlockSize = fieldVolumeSize % numBits;
+        const bool scaleByFilterMeans = _convolutionalParameters.weightsScale == scaleOutputByFilterMeans;
+
+        // The vector blocks of each row are summed 8 at a time with a Harley-Seal carry-save adder, which only needs one
+        // popcount per 8 blocks. The rest of the vector blocks, and the scalar blocks at the end of the row, are popcounted
+        // one at a time.
+        const int numCarrySaveGroups = numVectorBlocks / carrySaveGroupSize;
+        const int numRemainingVectorBlocks = numVectorBlocks % carrySaveGroupSize;
+        const int numScalarBlocks = packedRowSize - (vectorSize * numVectorBlocks);
+
+        // Get LLVM types
+        auto& emitter = function.GetEmitter();
+        auto packedBitsType = emitter.Type(emitters::GetVariableType<PackedBitsType>());
+        assert(llvm::VectorType::isValidElementType(packedBitsType) && "Invalid element type for LLVM vector");
+        auto vectorType = emitter.VectorType(packedBitsType, vectorSize);
+        auto vectorPointerType = vectorType->getPointerTo();
+
+        emitters::LLVMFunction popcountFunction = function.GetModule().GetIntrinsic(llvm::Intrinsic::ctpop, { packedBitsType });
+        emitters::LLVMFunction vecPopcountFunction = function.GetModule().GetIntrinsic(llvm::Intrinsic::ctpop, { vectorType });
+
+        // Ports are only guaranteed to be aligned to their element type
+        const auto alignment = function.GetModule().GetTargetDataLayout().getABITypeAlignment(packedBitsType);
+
+        // Variables to hold the carry-save state and running sums of each filter in a block
+        std::vector<emitters::LLVMValue> onesVars, twosVars, foursVars, eightsCountVars, sumVars;
+        for (int filter = 0; filter < filterBlockSize; ++filter)
+        {
+            if (numCarrySaveGroups > 0)
+            {
+                onesVars.push_back(function.Variable(vectorType, "ones"));
+                twosVars.push_back(function.Variable(vectorType, "twos"));
+                foursVars.push_back(function.Variable(vectorType, "fours"));
+                eightsCountVars.push_back(function.Variable(vectorType, "eightsCount"));
+            }
+            if (numScalarBlocks > 0)
+            {
+                sumVars.push_back(function.Variable(packedBitsType, "xorSum"));
+            }
+        }
+
+        // Emits the code that computes the outputs of `numBlockFilters` adjacent filters for one output pixel
+        auto emitFilterBlock = [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar pixelIndex, emitters::IRLocalScalar firstFilter, int numBlockFilters) {
+            auto& builder = function.GetEmitter().GetIRBuilder();
+
+            // The start of the binarized receptive field matrix for this output image pixel, and of the weights of each filter
+            auto inputBegin = pixelIndex * packedRowSize;
+            auto paddingBegin = pixelIndex * packedRowStride;
+            std::vector<emitters::IRLocalScalar> weightsBegin;
+            for (int filter = 0; filter < numBlockFilters; ++filter)
+            {
+                weightsBegin.push_back((firstFilter + filter) * packedRowStride);
+            }
+
+            // Loads a vector block of the input and xors it with the same block of each filter, so every block of the input
+            // is loaded only once per filter block
+            auto loadVector = [&](emitters::LLVMValue pointer, emitters::IRLocalScalar offset) {
+                return builder.CreateAlignedLoad(function.CastPointer(function.PointerOffset(pointer, offset), vectorPointerType), alignment);
+            };
+            auto getXorVectors = [&](emitters::IRLocalScalar offset) {
+                auto inputVector = loadVector(pInput, inputBegin + offset);
+                emitters::LLVMValue paddingMaskVector = hasZeroPadding ? loadVector(pInputPaddingMask, paddingBegin + offset) : nullptr;
+                std::vector<emitters::LLVMValue> xorVectors;
+                for (int filter = 0; filter < numBlockFilters; ++filter)
+                {
+                    emitters::LLVMValue xorVector = builder.CreateXor(inputVector, loadVector(pFilterWeights, weightsBegin[filter] + offset));
+                    if (hasZeroPadding)
+                    {
+                        // Mask out the bits associated with zero padding from the XOR value
+                        xorVector = builder.CreateAnd(paddingMaskVector, xorVector);
+                    }
+                    xorVectors.push_back(xorVector);
+                }
+                return xorVectors;
+            };
+
+            std::vector<emitters::LLVMValue> vectorCounts(numBlockFilters, nullptr);
+            if (numCarrySaveGroups > 0)
+            {
+                for (int filter = 0; filter < numBlockFilters; ++filter)
+                {
+                    function.StoreZero(onesVars[filter]);
+                    function.StoreZero(twosVars[filter]);
+                    function.StoreZero(foursVars[filter]);
+                    function.StoreZero(eightsCountVars[filter]);
+                }
+
+                function.For(numCarrySaveGroups, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto groupBegin = function.LocalScalar(i) * (carrySaveGroupSize * vectorSize);
+                    std::vector<std::vector<emitters::LLVMValue>> xorVectors;
+                    for (int block = 0; block < carrySaveGroupSize; ++block)
+                    {
+                        xorVectors.push_back(getXorVectors(groupBegin + (block * vectorSize)));
+                    }
+
+                    for (int filter = 0; filter < numBlockFilters; ++filter)
+                    {
+                        auto d = [&](int block) { return xorVectors[block][filter]; };
+                        auto ones = function.Load(onesVars[filter]);
+                        auto twos = function.Load(twosVars[filter]);
+                        auto fours = function.Load(foursVars[filter]);
+                        emitters::LLVMValue twosA, twosB, foursA, foursB, eights;
+                        std::tie(twosA, ones) = CarrySaveAdd(function, ones, d(0), d(1));
+                        std::tie(twosB, ones) = CarrySaveAdd(function, ones, d(2), d(3));
+                        std::tie(foursA, twos) = CarrySaveAdd(function, twos, twosA, twosB);
+                        std::tie(twosA, ones) = CarrySaveAdd(function, ones, d(4), d(5));
+                        std::tie(twosB, ones) = CarrySaveAdd(function, ones, d(6), d(7));
+                        std::tie(foursB, twos) = CarrySaveAdd(function, twos, twosA, twosB);
+                        std::tie(eights, fours) = CarrySaveAdd(function, fours, foursA, foursB);
+                        function.Store(onesVars[filter], ones);
+                        function.Store(twosVars[filter], twos);
+                        function.Store(foursVars[filter], fours);
+                        function.Store(eightsCountVars[filter], builder.CreateAdd(function.Load(eightsCountVars[filter]), function.Call(vecPopcountFunction, { eights })));
+                    }
+                });
+
+                // The count is 8 * (the number of eights) + 4 * popcount(fours) + 2 * popcount(twos) + popcount(ones)
+                for (int filter = 0; filter < numBlockFilters; ++filter)
+                {
+                    auto count = builder.CreateShl(function.Load(eightsCountVars[filter]), 3);
+                    count = builder.CreateAdd(count, builder.CreateShl(function.Call(vecPopcountFunction, { function.Load(foursVars[filter]) }), 2));
+                    count = builder.CreateAdd(count, builder.CreateShl(function.Call(vecPopcountFunction, { function.Load(twosVars[filter]) }), 1));
+                    vectorCounts[filter] = builder.CreateAdd(count, function.Call(vecPopcountFunction, { function.Load(onesVars[filter]) }));
+                }
+            }
+
+            for (int block = 0; block < numRemainingVectorBlocks; ++block)
+            {
+                auto xorVectors = getXorVectors(function.LocalScalar<int>((numCarrySaveGroups * carrySaveGroupSize + block) * vectorSize));
+                for (int filter = 0; filter < numBlockFilters; ++filter)
+                {
+                    auto count = function.Call(vecPopcountFunction, { xorVectors[filter] });
+                    vectorCounts[filter] = vectorCounts[filter] == nullptr ? count : builder.CreateAdd(vectorCounts[filter], count);
+                }
+            }
+
+            // Now compute the non-vectorized values
+            if (numScalarBlocks > 0)
+            {
+                auto input = function.LocalArray(pInput);
+                auto paddingMask = function.LocalArray(pInputPaddingMask);
+                auto weights = function.LocalArray(pFilterWeights);
+                for (int filter = 0; filter < numBlockFilters; ++filter)
+                {
+                    function.StoreZero(sumVars[filter]);
+                }
+
+                const int start = vectorSize * numVectorBlocks;
+                function.For(start, packedRowSize, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto blockIndex = function.LocalScalar(i);
+                    emitters::IRLocalScalar inputVal = input[inputBegin + blockIndex];
+                    auto paddingMaskVal = function.LocalScalar();
+                    if (hasZeroPadding)
+                    {
+                        paddingMaskVal = paddingMask[paddingBegin + blockIndex];
+                    }
+                    for (int filter = 0; filter < numBlockFilters; ++filter)
+                    {
+                        emitters::IRLocalScalar filterVal = weights[weightsBegin[filter] + blockIndex];
+                        auto xorVal = inputVal ^ filterVal;
+                        if (hasZeroPadding)
+                        {
+                            // Mask out the bits associated with zero padding from the XOR value
+                            xorVal = paddingMaskVal & xorVal;
+                        }
+                        auto xorCount = function.Call(popcountFunction, { xorVal });
+                        function.OperationAndUpdate(sumVars[filter], emitters::TypedOperator::add, xorCount);
+                    }
+                });
+            }
+
+            emitters::LLVMValue paddingSum = hasZeroPadding ? function.ValueAt(pInputPaddingMaskSums, pixelIndex) : nullptr;
+            for (int filter = 0; filter < numBlockFilters; ++filter)
+            {
+                emitters::LLVMValue xorSum = (numScalarBlocks > 0) ? function.Load(sumVars[filter]) : nullptr;
+                if (vectorCounts[filter] != nullptr)
+                {
+                    auto vectorXorSum = emitters::HorizontalVectorSum<PackedBitsType>(function, vectorCounts[filter]);
+                    xorSum = (xorSum == nullptr) ? vectorXorSum : builder.CreateAdd(xorSum, vectorXorSum);
+                }
+                assert(xorSum != nullptr);
+
+                // Output scaling, as in `ComputeFilterOutput`
+                auto sumInt = function.CastValue<int>(xorSum);
+                auto scaledSum = (function.LocalScalar<int>(-2) * sumInt) + (numBits * packedRowSize);
+                if (hasZeroPadding)
+                {
+                    scaledSum = scaledSum - paddingSum;
+                }
+
+                auto adjustedSum = function.LocalScalar(function.CastValue<ValueType>(scaledSum));
+                if (partialBlockSize != 0)
+                {
+                    adjustedSum = adjustedSum - function.LocalScalar<ValueType>(numBits - partialBlockSize);
+                }
+
+                auto filterIndex = firstFilter + filter;
+                if (scaleByFilterMeans)
+                {
+                    adjustedSum = adjustedSum * function.ValueAt(pFilterMeans, filterIndex);
+                }
+                function.SetValueAt(pOutput, (filterIndex * outputColumns) + pixelIndex, adjustedSum);
+            }
+        };
+
+        function.For(beginPixel, endPixel, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+            auto pixelIndex = function.LocalScalar(i);
+            function.For(numFilters / filterBlockSize, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue j) {
+                emitFilterBlock(function, pixelIndex, function.LocalScalar(j) * filterBlockSize, filterBlockSize);
+            });
+
+            const int numRemainingFilters = numFilters % filterBlockSize;
+            if (numRemainingFilters > 0)
+            {
+                emitFilterBlock(function, pixelIndex, function.LocalScalar<int>(numFilters - numRemainingFilters), numRemainingFilters);
+            }
+        });
+    }
+
     template <typename ValueType, typename PackedBitsType>
     void BinaryXnorNode<ValueType, PackedBitsType>::WriteToArchive(utilities::Archiver& archiver) const
     {
@@ -0,0 +1,349 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BlockedConvolutionNode.cpp (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BlockedConvolutionNode.h"
+
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRVectorUtilities.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // The number of adjacent output columns computed at once, each with its own vector accumulator
+        const int tileColumns = 4;
+
+        struct BlockedConvolutionParameters
+        {
+            PortMemoryLayout inputLayout;
+            PortMemoryLayout outputLayout;
+            int filterSize;
+            int stride;
+            int blockSize;
+        };
+
+        // Returns the physical offset of the entry at logical (row, column, channel) `coordinates` of the memory area,
+        // where the coordinates are relative to the first entry of the active area
+        IRLocalScalar GetEntryOffset(const PortMemoryLayout& layout, IRLocalScalar row, IRLocalScalar column, IRLocalScalar channel)
+        {
+            const auto increment = layout.GetLogicalDimensionIncrement();
+            const auto offset = layout.GetLogicalDimensionOffset();
+            return ((row + offset[0]) * static_cast<int>(increment[0])) + ((column + offset[1]) * static_cast<int>(increment[1])) + ((channel + offset[2]) * static_cast<int>(increment[2]));
+        }
+
+        //
+        // Low-level code-generation
+        //
+
+        // Emits the code that computes one block of output channels for `numColumns` adjacent output columns
+        template <typename ValueType>
+        void EmitBlockedConvolutionTile(IRFunctionEmitter& function, LLVMValue input, LLVMValue weights, LLVMValue output, const BlockedConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue, IRLocalScalar outputRow, IRLocalScalar block, IRLocalScalar firstColumn, int numColumns)
+        {
+            auto& emitter = function.GetEmitter();
+            auto& builder = emitter.GetIRBuilder();
+            const auto blockSize = parameters.blockSize;
+            const auto filterSize = parameters.filterSize;
+            const auto stride = parameters.stride;
+            const auto numInputChannels = parameters.inputLayout.GetLogicalDimensionActiveSize(2);
+            const auto numFilters = parameters.outputLayout.GetLogicalDimensionActiveSize(2);
+            auto vectorType = emitter.VectorType(GetVariableType<ValueType>(), blockSize);
+
+            // Ports and global arrays are only guaranteed to be aligned to their element type
+            const auto alignment = function.GetModule().GetTargetDataLayout().getABITypeAlignment(emitter.Type(GetVariableType<ValueType>()));
+
+            std::vector<LLVMValue> accumulators;
+            for (int column = 0; column < numColumns; ++column)
+            {
+                auto accumulator = function.Variable(vectorType, "accumulator");
+                function.Store(accumulator, FillVector<ValueType>(function, vectorType, 0));
+                accumulators.push_back(accumulator);
+            }
+
+            // The input is padded by half the filter size, so the receptive field of output (r, c) starts at input (r * stride, c * stride)
+            const auto inputPadding = filterSize / 2;
+            auto firstInputRow = (outputRow * stride) - inputPadding;
+            auto firstInputColumn = (firstColumn * stride) - inputPadding;
+            function.For(numInputChannels, [&](IRFunctionEmitter& function, IRLocalScalar inputChannel) {
+                // The filters are typically small, so we unroll the loops over the receptive field
+                for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                {
+                    for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                    {
+                        auto weightsIndex = (((((block * filterSize) + windowRow) * filterSize) + windowColumn) * numInputChannels) + inputChannel;
+                        auto weightsVector = builder.CreateAlignedLoad(function.PointerOffset(weights, weightsIndex), alignment);
+                        for (int column = 0; column < numColumns; ++column)
+                        {
+                            auto inputOffset = GetEntryOffset(parameters.inputLayout, firstInputRow + windowRow, firstInputColumn + ((column * stride) + windowColumn), inputChannel);
+                            auto inputVector = builder.CreateVectorSplat(blockSize, function.ValueAt(input, inputOffset));
+                            auto sum = builder.CreateFAdd(function.Load(accumulators[column]), builder.CreateFMul(inputVector, weightsVector));
+                            function.Store(accumulators[column], sum);
+                        }
+                    }
+                }
+            });
+
+            // Write the results, applying the epilogue while they're still in registers
+            const bool hasPartialBlock = (numFilters % blockSize) != 0;
+            const bool canStoreVectors = epilogue.IsEmpty() && !hasPartialBlock && parameters.outputLayout.GetLogicalDimensionIncrement(2) == 1;
+            const auto outputColumns = parameters.outputLayout.GetLogicalDimensionActiveSize(1);
+            const auto channelIncrement = static_cast<int>(parameters.outputLayout.GetLogicalDimensionIncrement(2));
+            auto outputArray = function.LocalArray(output);
+            auto firstChannel = block * blockSize;
+            for (int column = 0; column < numColumns; ++column)
+            {
+                auto outputColumn = firstColumn + column;
+                auto outputOffset = GetEntryOffset(parameters.outputLayout, outputRow, outputColumn, firstChannel);
+                auto result = function.Load(accumulators[column]);
+                if (canStoreVectors)
+                {
+                    auto vectorPointer = function.CastPointer(function.PointerOffset(output, outputOffset), vectorType->getPointerTo());
+                    builder.CreateAlignedStore(result, vectorPointer, alignment);
+                    continue;
+                }
+
+                for (int lane = 0; lane < blockSize; ++lane)
+                {
+                    auto channel = firstChannel + lane;
+                    auto storeLane = [&, lane, channel](IRFunctionEmitter& function) {
+                        auto value = function.LocalScalar(builder.CreateExtractElement(result, static_cast<uint64_t>(lane)));
+                        auto entryIndex = (((outputRow * outputColumns) + outputColumn) * numFilters) + channel;
+                        outputArray[outputOffset + (lane * channelIncrement)] = epilogue.Compile(value, channel, entryIndex);
+                    };
+
+                    // Only the last block can be partial
+                    if (hasPartialBlock)
+                    {
+                        function.If(channel < numFilters, storeLane);
+                    }
+                    else
+                    {
+                        storeLane(function);
+                    }
+                }
+            }
+        }
+
+        template <typename ValueType>
+        void EmitBlockedConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue packedWeights, LLVMValue output, const BlockedConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue)
+        {
+            const auto outputRows = parameters.outputLayout.GetLogicalDimensionActiveSize(0);
+            const auto outputColumns = parameters.outputLayout.GetLogicalDimensionActiveSize(1);
+            const auto numFilters = parameters.outputLayout.GetLogicalDimensionActiveSize(2);
+            const auto numBlocks = (numFilters + parameters.blockSize - 1) / parameters.blockSize;
+
+            // Each task computes one block of output channels for one output row
+            function.ParallelFor(outputRows * numBlocks, { input, packedWeights, output }, [parameters, epilogue, numBlocks, outputColumns](IRFunctionEmitter& function, IRLocalScalar taskIndex, const std::vector<LLVMValue>& capturedValues) {
+                auto input = capturedValues[0];
+                auto output = capturedValues[2];
+                auto vectorType = function.GetEmitter().VectorType(GetVariableType<ValueType>(), parameters.blockSize);
+                auto weights = function.CastPointer(function.PointerOffset(capturedValues[1], 0), vectorType->getPointerTo());
+
+                auto outputRow = taskIndex / numBlocks;
+                auto block = taskIndex % numBlocks;
+                const auto numTiles = outputColumns / tileColumns;
+                function.For(numTiles, [&](IRFunctionEmitter& function, IRLocalScalar tile) {
+                    EmitBlockedConvolutionTile(function, input, weights, output, parameters, epilogue, outputRow, block, tile * tileColumns, tileColumns);
+                });
+
+                const auto remainingColumns = outputColumns % tileColumns;
+                if (remainingColumns > 0)
+                {
+                    EmitBlockedConvolutionTile(function, input, weights, output, parameters, epilogue, outputRow, block, function.LocalScalar(numTiles * tileColumns), remainingColumns);
+                }
+            });
+        }
+    } // end anonymous namespace
+
+    //
+    // BlockedConvolutionNode
+    //
+
+    template <typename ValueType>
+    BlockedConvolutionNode<ValueType>::BlockedConvolutionNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    BlockedConvolutionNode<ValueType>::BlockedConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                              const model::PortMemoryLayout& inputMemoryLayout,
+                                                              const model::PortMemoryLayout& outputMemoryLayout,
+                                                              const ConstTensorReferenceType& filterWeights,
+                                                              size_t stride,
+                                                              const FusedEpilogue<ValueType>& epilogue) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _filterWeights(filterWeights),
+        _stride(static_cast<int>(stride)),
+        _epilogue(epilogue)
+    {
+        if (!inputMemoryLayout.GetLogicalDimensionOrder().IsCanonicalOrder() || !outputMemoryLayout.GetLogicalDimensionOrder().IsCanonicalOrder())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "BlockedConvolutionNode: input and output must be in (row, column, channel) order");
+        }
+
+        if (filterWeights.NumChannels() != static_cast<size_t>(inputMemoryLayout.GetLogicalDimensionActiveSize(2)))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "BlockedConvolutionNode: depthwise-separable convolutions aren't supported");
+        }
+
+        // The receptive field of output (r, c) starts at input (r * stride - filterSize / 2, c * stride - filterSize / 2), so
+        // the input must be padded by that much
+        const auto inputPadding = static_cast<int>(filterWeights.NumColumns()) / 2;
+        if (inputMemoryLayout.GetLogicalDimensionOffset(0) != inputPadding || inputMemoryLayout.GetLogicalDimensionOffset(1) != inputPadding)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "BlockedConvolutionNode: input padding must be filterSize/2");
+        }
+    }
+
+    template <typename ValueType>
+    void BlockedConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<BlockedConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride, _epilogue);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> BlockedConvolutionNode<ValueType>::GetPackedWeights(int blockSize) const
+    {
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int numInputChannels = static_cast<int>(_filterWeights.NumChannels());
+        const int numFilters = static_cast<int>(_filterWeights.NumRows()) / filterSize;
+        const int numBlocks = (numFilters + blockSize - 1) / blockSize;
+
+        // The filters past the end of the last block are zero
+        std::vector<ValueType> result(numBlocks * filterSize * filterSize * numInputChannels * blockSize, 0);
+        auto entry = result.begin();
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+            {
+                for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                {
+                    for (int inputChannel = 0; inputChannel < numInputChannels; ++inputChannel)
+                    {
+                        for (int lane = 0; lane < blockSize; ++lane, ++entry)
+                        {
+                            const int filter = (block * blockSize) + lane;
+                            if (filter < numFilters)
+                            {
+                                *entry = _filterWeights((filter * filterSize) + windowRow, windowColumn, inputChannel);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    void BlockedConvolutionNode<ValueType>::Compute() const
+    {
+        const auto& inputLayout = _inputMemoryLayout;
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int inputPadding = filterSize / 2;
+        const int numInputChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+        const int outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+        const int outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+        const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+
+        auto inputValues = _input.GetValue();
+        std::vector<ValueType> outputValues(outputLayout.GetMemorySize(), 0);
+        int entryIndex = 0;
+        for (int outputRow = 0; outputRow < outputRows; ++outputRow)
+        {
+            for (int outputColumn = 0; outputColumn < outputColumns; ++outputColumn)
+            {
+                for (int filter = 0; filter < numFilters; ++filter, ++entryIndex)
+                {
+                    ValueType sum = 0;
+                    for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                    {
+                        for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                        {
+                            const int inputRow = (outputRow * _stride) + windowRow - inputPadding;
+                            const int inputColumn = (outputColumn * _stride) + windowColumn - inputPadding;
+                            for (int inputChannel = 0; inputChannel < numInputChannels; ++inputChannel)
+                            {
+                                sum += inputValues[inputLayout.GetLogicalEntryOffset({ inputRow, inputColumn, inputChannel })] * _filterWeights((filter * filterSize) + windowRow, windowColumn, inputChannel);
+                            }
+                        }
+                    }
+                    outputValues[outputLayout.GetLogicalEntryOffset({ outputRow, outputColumn, filter })] = _epilogue.Compute(sum, filter, entryIndex);
+                }
+            }
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void BlockedConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        // Each block holds one vector of output channels
+        BlockedConvolutionParameters parameters{ _inputMemoryLayout, GetOutputMemoryLayout(), static_cast<int>(_filterWeights.NumColumns()), _stride, options.allowVectorInstructions ? options.vectorWidth : 1 };
+        auto pWeights = function.GetModule().ConstantArray(GetInternalStateIdentifier() + "_packedWeights", GetPackedWeights(parameters.blockSize));
+
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        EmitBlockedConvolutionCode<ValueType>(function, pInput, pWeights, pOutput, parameters, epilogue);
+    }
+
+    template <typename ValueType>
+    void BlockedConvolutionNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["stride"] << _stride;
+        math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
+    }
+
+    template <typename ValueType>
+    void BlockedConvolutionNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["stride"] >> _stride;
+        math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
+    }
+
+    // Explicit specializations
+    template class BlockedConvolutionNode<float>;
+    template class BlockedConvolutionNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -6,7 +6,9 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "BlockedConvolutionNode.h"
 #include "ConvolutionalLayerNode.h"
+#include "DepthwiseConvolutionNode.h"
 #include "DiagonalConvolutionNode.h"
 #include "ReorderDataNode.h"
 #include "SimpleConvolutionNode.h"
@@ -21,11 +23,24 @@ namespace ell
 namespace nodes
 {
     template <typename ValueType>
-    ConvolutionalLayerNode<ValueType>::ConvolutionalLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::ConvolutionalLayer<ValueType>& layer) :
-        NeuralNetworkLayerNode<ConvolutionalLayerNode<ValueType>, predictors::neural::ConvolutionalLayer<ValueType>, ValueType>(input, layer)
+    ConvolutionalLayerNode<ValueType>::ConvolutionalLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::ConvolutionalLayer<ValueType>& layer, const FusedEpilogue<ValueType>& epilogue) :
+        NeuralNetworkLayerNode<ConvolutionalLayerNode<ValueType>, predictors::neural::ConvolutionalLayer<ValueType>, ValueType>(input, layer),
+        _epilogue(epilogue)
     {
     }
 
+    template <typename ValueType>
+    void ConvolutionalLayerNode<ValueType>::Compute() const
+    {
+        BaseType::Compute();
+        if (!_epilogue.IsEmpty())
+        {
+            auto outputValues = this->_output.GetOutput();
+            _epilogue.Compute(outputValues, this->GetOutputMemoryLayout());
+            this->_output.SetOutput(outputValues);
+        }
+    }
+
     template <typename ValueType>
     bool ConvolutionalLayerNode<ValueType>::Refine(model::ModelTransformer& transformer) const
     {
@@ -58,25 +73,47 @@ namespace nodes
         {
         case ConvolutionMethod::simple:
         {
-            auto convNode = transformer.AddNode<SimpleConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride);
+            auto convNode = transformer.AddNode<SimpleConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, _epilogue);
             convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
         }
         break;
         case ConvolutionMethod::unrolled:
         {
-            auto convNode = transformer.AddNode<UnrolledConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride);
+            auto convNode = transformer.AddNode<UnrolledConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, _epilogue);
             convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
         }
         break;
         case ConvolutionMethod::diagonal:
         {
-            auto convNode = transformer.AddNode<DiagonalConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride);
+            auto convNode = transformer.AddNode<DiagonalConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, _epilogue);
             convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
         }
         break;
         case ConvolutionMethod::winograd:
         {
-            auto convNode = transformer.AddNode<WinogradConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride);
+            // Larger tiles do fewer multiplies per output, at the cost of some precision
+            int tileSize = 2;
+            if (auto compiler = transformer.GetContext().GetCompiler())
+            {
+                tileSize = compiler->GetModelOptimizerOptions(*this).template GetEntry<int>("winogradTileSize", 2);
+            }
+            if (tileSize != 2 && tileSize != 4 && tileSize != 6)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "ConvolutionalLayerNode: winogradTileSize must be 2, 4, or 6");
+            }
+            auto convNode = transformer.AddNode<WinogradConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, tileSize, _epilogue);
+            convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
+        }
+        break;
+        case ConvolutionMethod::blocked:
+        {
+            auto convNode = transformer.AddNode<BlockedConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, _epilogue);
+            convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
+        }
+        break;
+        case ConvolutionMethod::depthwise:
+        {
+            auto convNode = transformer.AddNode<DepthwiseConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, _epilogue);
             convOutput = static_cast<model::OutputPort<ValueType>*>(convNode->GetOutputPort(0));
         }
         break;
@@ -97,10 +134,24 @@ namespace nodes
     void ConvolutionalLayerNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newPortElements = transformer.GetCorrespondingInputs(this->_input);
-        auto newNode = transformer.AddNode<ConvolutionalLayerNode<ValueType>>(newPortElements, this->_layer);
+        auto newNode = transformer.AddNode<ConvolutionalLayerNode<ValueType>>(newPortElements, this->_layer, _epilogue);
         transformer.MapNodeOutput(this->_output, newNode->output);
     }
 
+    template <typename ValueType>
+    void ConvolutionalLayerNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        BaseType::WriteToArchive(archiver);
+        _epilogue.WriteToArchive(archiver);
+    }
+
+    template <typename ValueType>
+    void ConvolutionalLayerNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        BaseType::ReadFromArchive(archiver);
+        _epilogue.ReadFromArchive(archiver);
+    }
+
     // Explicit specializations
     template class ConvolutionalLayerNode<float>;
     template class ConvolutionalLayerNode<double>;
@@ -0,0 +1,477 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DepthwiseConvolutionNode.cpp (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DepthwiseConvolutionNode.h"
+
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRVectorUtilities.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // The number of adjacent output columns computed at once, each with its own vector accumulator
+        const int tileColumns = 4;
+
+        struct DepthwiseConvolutionParameters
+        {
+            PortMemoryLayout inputLayout;
+            int outputRows;
+            int outputColumns;
+            int numChannels;
+            int filterSize;
+            int stride;
+            int blockSize;
+        };
+
+        // Returns the physical offset of the entry at logical (row, column, channel) `coordinates` of the memory area,
+        // where the coordinates are relative to the first entry of the active area
+        IRLocalScalar GetEntryOffset(const PortMemoryLayout& layout, IRLocalScalar row, IRLocalScalar column, IRLocalScalar channel)
+        {
+            const auto increment = layout.GetLogicalDimensionIncrement();
+            const auto offset = layout.GetLogicalDimensionOffset();
+            return ((row + offset[0]) * static_cast<int>(increment[0])) + ((column + offset[1]) * static_cast<int>(increment[1])) + ((channel + offset[2]) * static_cast<int>(increment[2]));
+        }
+
+        //
+        // Low-level code-generation
+        //
+
+        // Emits the code that computes `numLanes` adjacent channels of `numColumns` adjacent columns of an output row,
+        // and writes them to row `destinationRow` of `destination`
+        template <typename ValueType>
+        void EmitDepthwiseConvolutionTile(IRFunctionEmitter& function, LLVMValue input, LLVMValue weights, LLVMValue destination, const PortMemoryLayout& destinationLayout, const DepthwiseConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue, IRLocalScalar outputRow, IRLocalScalar destinationRow, IRLocalScalar firstColumn, int numColumns, IRLocalScalar firstChannel, int numLanes)
+        {
+            auto& emitter = function.GetEmitter();
+            auto& builder = emitter.GetIRBuilder();
+            const auto filterSize = parameters.filterSize;
+            const auto stride = parameters.stride;
+            const auto numChannels = parameters.numChannels;
+            auto vectorType = emitter.VectorType(GetVariableType<ValueType>(), numLanes);
+            auto vectorPointerType = vectorType->getPointerTo();
+
+            // Ports and global arrays are only guaranteed to be aligned to their element type
+            const auto alignment = function.GetModule().GetTargetDataLayout().getABITypeAlignment(emitter.Type(GetVariableType<ValueType>()));
+            auto loadVector = [&](LLVMValue pointer, IRLocalScalar offset) {
+                return builder.CreateAlignedLoad(function.CastPointer(function.PointerOffset(pointer, offset), vectorPointerType), alignment);
+            };
+
+            // The window is unrolled, so the accumulators stay in registers
+            std::vector<LLVMValue> sums(numColumns, FillVector<ValueType>(function, vectorType, 0));
+
+            // The input is padded by half the filter size, so the receptive field of output (r, c) starts at input (r * stride, c * stride)
+            const auto inputPadding = filterSize / 2;
+            auto firstInputRow = (outputRow * stride) - inputPadding;
+            auto firstInputColumn = (firstColumn * stride) - inputPadding;
+            for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+            {
+                for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                {
+                    auto weightsVector = loadVector(weights, firstChannel + (((windowRow * filterSize) + windowColumn) * numChannels));
+                    for (int column = 0; column < numColumns; ++column)
+                    {
+                        auto inputVector = loadVector(input, GetEntryOffset(parameters.inputLayout, firstInputRow + windowRow, firstInputColumn + ((column * stride) + windowColumn), firstChannel));
+                        sums[column] = builder.CreateFAdd(sums[column], builder.CreateFMul(inputVector, weightsVector));
+                    }
+                }
+            }
+
+            // Write the results, applying the epilogue while they're still in registers
+            auto destinationArray = function.LocalArray(destination);
+            for (int column = 0; column < numColumns; ++column)
+            {
+                auto outputColumn = firstColumn + column;
+                auto destinationOffset = GetEntryOffset(destinationLayout, destinationRow, outputColumn, firstChannel);
+                if (epilogue.IsEmpty())
+                {
+                    builder.CreateAlignedStore(sums[column], function.CastPointer(function.PointerOffset(destination, destinationOffset), vectorPointerType), alignment);
+                    continue;
+                }
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    auto channel = firstChannel + lane;
+                    auto value = function.LocalScalar(builder.CreateExtractElement(sums[column], static_cast<uint64_t>(lane)));
+                    auto entryIndex = (((outputRow * parameters.outputColumns) + outputColumn) * numChannels) + channel;
+                    destinationArray[destinationOffset + lane] = epilogue.Compile(value, channel, entryIndex);
+                }
+            }
+        }
+
+        // Emits the code that computes one output row, and writes it to row `destinationRow` of `destination`
+        template <typename ValueType>
+        void EmitDepthwiseConvolutionRow(IRFunctionEmitter& function, LLVMValue input, LLVMValue weights, LLVMValue destination, const PortMemoryLayout& destinationLayout, const DepthwiseConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue, IRLocalScalar outputRow, IRLocalScalar destinationRow)
+        {
+            const auto blockSize = parameters.blockSize;
+            const auto numChannels = parameters.numChannels;
+            const auto numBlocks = numChannels / blockSize;
+            const auto firstRemainingChannel = numBlocks * blockSize;
+
+            auto emitColumns = [&](IRFunctionEmitter& function, IRLocalScalar firstColumn, int numColumns) {
+                function.For(numBlocks, [&](IRFunctionEmitter& function, IRLocalScalar block) {
+                    EmitDepthwiseConvolutionTile(function, input, weights, destination, destinationLayout, parameters, epilogue, outputRow, destinationRow, firstColumn, numColumns, block * blockSize, blockSize);
+                });
+
+                // The channels past the last full block are computed one at a time
+                if (firstRemainingChannel < numChannels)
+                {
+                    function.For(firstRemainingChannel, numChannels, [&](IRFunctionEmitter& function, IRLocalScalar channel) {
+                        EmitDepthwiseConvolutionTile(function, input, weights, destination, destinationLayout, parameters, epilogue, outputRow, destinationRow, firstColumn, numColumns, channel, 1);
+                    });
+                }
+            };
+
+            const auto numTiles = parameters.outputColumns / tileColumns;
+            function.For(numTiles, [&](IRFunctionEmitter& function, IRLocalScalar tile) {
+                emitColumns(function, tile * tileColumns, tileColumns);
+            });
+
+            const auto remainingColumns = parameters.outputColumns % tileColumns;
+            if (remainingColumns > 0)
+            {
+                emitColumns(function, function.LocalScalar(numTiles * tileColumns), remainingColumns);
+            }
+        }
+
+        template <typename ValueType>
+        void EmitDepthwiseConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue packedWeights, LLVMValue output, const PortMemoryLayout& outputLayout, const DepthwiseConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue)
+        {
+            // Each task computes one output row
+            function.ParallelFor(parameters.outputRows, { input, packedWeights, output }, [parameters, outputLayout, epilogue](IRFunctionEmitter& function, IRLocalScalar outputRow, const std::vector<LLVMValue>& capturedValues) {
+                auto weights = function.PointerOffset(capturedValues[1], 0);
+                EmitDepthwiseConvolutionRow(function, capturedValues[0], weights, capturedValues[2], outputLayout, parameters, epilogue, outputRow, outputRow);
+            });
+        }
+
+        template <typename ValueType>
+        void EmitDepthwisePointwiseConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue packedWeights, LLVMValue pointwiseWeights, LLVMValue output, const PortMemoryLayout& outputLayout, const DepthwiseConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue, const FusedEpilogueEmitter<ValueType>& pointwiseEpilogue)
+        {
+            const auto outputColumns = parameters.outputColumns;
+            const auto numChannels = parameters.numChannels;
+            const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+
+            // Each task computes one output row
+            function.ParallelFor(parameters.outputRows, { input, packedWeights, pointwiseWeights, output }, [parameters, outputLayout, epilogue, pointwiseEpilogue, outputColumns, numChannels, numFilters](IRFunctionEmitter& function, IRLocalScalar outputRow, const std::vector<LLVMValue>& capturedValues) {
+                auto weights = function.PointerOffset(capturedValues[1], 0);
+                auto pointwiseWeights = function.PointerOffset(capturedValues[2], 0);
+                auto output = capturedValues[3];
+
+                // The row of depthwise output only lives in a scratch buffer, in (column, channel) order
+                PortMemoryLayout scratchLayout(MemoryShape{ 1, outputColumns, numChannels });
+                auto scratch = function.Variable(GetVariableType<ValueType>(), outputColumns * numChannels);
+                EmitDepthwiseConvolutionRow(function, capturedValues[0], weights, scratch, scratchLayout, parameters, epilogue, outputRow, function.LocalScalar(0));
+
+                // The pointwise convolution of a row is the matrix product (columns x channels) * (channels x filters)
+                auto outputRowOffset = GetEntryOffset(outputLayout, outputRow, function.LocalScalar(0), function.LocalScalar(0));
+                const auto columnIncrement = static_cast<int>(outputLayout.GetLogicalDimensionIncrement(1));
+                function.CallGEMM<ValueType>(false, true, outputColumns, numFilters, numChannels, scratch, numChannels, pointwiseWeights, numChannels, function.PointerOffset(output, outputRowOffset), columnIncrement);
+
+                if (!pointwiseEpilogue.IsEmpty())
+                {
+                    auto outputArray = function.LocalArray(output);
+                    function.For(outputColumns, [&](IRFunctionEmitter& function, IRLocalScalar column) {
+                        function.For(numFilters, [&](IRFunctionEmitter& function, IRLocalScalar filter) {
+                            auto outputOffset = GetEntryOffset(outputLayout, outputRow, column, filter);
+                            auto entryIndex = (((outputRow * outputColumns) + column) * numFilters) + filter;
+                            IRLocalScalar value = outputArray[outputOffset];
+                            outputArray[outputOffset] = pointwiseEpilogue.Compile(value, filter, entryIndex);
+                        });
+                    });
+                }
+            });
+        }
+    } // end anonymous namespace
+
+    //
+    // DepthwiseConvolutionNode
+    //
+
+    template <typename ValueType>
+    DepthwiseConvolutionNode<ValueType>::DepthwiseConvolutionNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    DepthwiseConvolutionNode<ValueType>::DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                                  const model::PortMemoryLayout& inputMemoryLayout,
+                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                  const ConstTensorReferenceType& filterWeights,
+                                                                  size_t stride,
+                                                                  const FusedEpilogue<ValueType>& epilogue) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _filterWeights(filterWeights),
+        _stride(static_cast<int>(stride)),
+        _epilogue(epilogue)
+    {
+        Validate();
+    }
+
+    template <typename ValueType>
+    DepthwiseConvolutionNode<ValueType>::DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                                  const model::PortMemoryLayout& inputMemoryLayout,
+                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                  const ConstTensorReferenceType& filterWeights,
+                                                                  size_t stride,
+                                                                  const FusedEpilogue<ValueType>& epilogue,
+                                                                  const ConstTensorReferenceType& pointwiseWeights,
+                                                                  const FusedEpilogue<ValueType>& pointwiseEpilogue) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _filterWeights(filterWeights),
+        _stride(static_cast<int>(stride)),
+        _epilogue(epilogue),
+        _pointwiseWeights(pointwiseWeights),
+        _pointwiseEpilogue(pointwiseEpilogue)
+    {
+        Validate();
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Validate() const
+    {
+        if (!_inputMemoryLayout.GetLogicalDimensionOrder().IsCanonicalOrder() || !GetOutputMemoryLayout().GetLogicalDimensionOrder().IsCanonicalOrder())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DepthwiseConvolutionNode: input and output must be in (row, column, channel) order");
+        }
+
+        const auto numChannels = static_cast<size_t>(_inputMemoryLayout.GetLogicalDimensionActiveSize(2));
+        const auto numOutputChannels = static_cast<size_t>(GetOutputMemoryLayout().GetLogicalDimensionActiveSize(2));
+        if (_filterWeights.NumChannels() != 1 || _filterWeights.NumRows() != numChannels * _filterWeights.NumColumns())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "DepthwiseConvolutionNode: there must be one single-channel filter per input channel");
+        }
+
+        // The receptive field of output (r, c) starts at input (r * stride - filterSize / 2, c * stride - filterSize / 2), so
+        // the input must be padded by that much
+        const auto inputPadding = static_cast<int>(_filterWeights.NumColumns()) / 2;
+        if (_inputMemoryLayout.GetLogicalDimensionOffset(0) != inputPadding || _inputMemoryLayout.GetLogicalDimensionOffset(1) != inputPadding)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DepthwiseConvolutionNode: input padding must be filterSize/2");
+        }
+
+        if (HasPointwiseConvolution())
+        {
+            if (_pointwiseWeights.NumColumns() != 1 || _pointwiseWeights.NumChannels() != numChannels || _pointwiseWeights.NumRows() != numOutputChannels)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "DepthwiseConvolutionNode: pointwise weights don't match the number of input and output channels");
+            }
+        }
+        else if (numOutputChannels != numChannels)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "DepthwiseConvolutionNode: the output must have the same number of channels as the input");
+        }
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<DepthwiseConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride, _epilogue, _pointwiseWeights, _pointwiseEpilogue);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> DepthwiseConvolutionNode<ValueType>::GetPackedWeights() const
+    {
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int numChannels = static_cast<int>(_filterWeights.NumRows()) / filterSize;
+
+        std::vector<ValueType> result(filterSize * filterSize * numChannels);
+        auto entry = result.begin();
+        for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+        {
+            for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+            {
+                for (int channel = 0; channel < numChannels; ++channel, ++entry)
+                {
+                    *entry = _filterWeights((channel * filterSize) + windowRow, windowColumn, 0);
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> DepthwiseConvolutionNode<ValueType>::GetPointwiseWeightsMatrix() const
+    {
+        const int numFilters = static_cast<int>(_pointwiseWeights.NumRows());
+        const int numChannels = static_cast<int>(_pointwiseWeights.NumChannels());
+
+        std::vector<ValueType> result(numFilters * numChannels);
+        auto entry = result.begin();
+        for (int filter = 0; filter < numFilters; ++filter)
+        {
+            for (int channel = 0; channel < numChannels; ++channel, ++entry)
+            {
+                *entry = _pointwiseWeights(filter, 0, channel);
+            }
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Compute() const
+    {
+        const auto& inputLayout = _inputMemoryLayout;
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int inputPadding = filterSize / 2;
+        const int numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+        const int outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+        const int outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+
+        // The depthwise output, in logical order
+        auto inputValues = _input.GetValue();
+        std::vector<ValueType> depthwiseValues(outputRows * outputColumns * numChannels);
+        int entryIndex = 0;
+        for (int outputRow = 0; outputRow < outputRows; ++outputRow)
+        {
+            for (int outputColumn = 0; outputColumn < outputColumns; ++outputColumn)
+            {
+                for (int channel = 0; channel < numChannels; ++channel, ++entryIndex)
+                {
+                    ValueType sum = 0;
+                    for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                    {
+                        for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                        {
+                            const int inputRow = (outputRow * _stride) + windowRow - inputPadding;
+                            const int inputColumn = (outputColumn * _stride) + windowColumn - inputPadding;
+                            sum += inputValues[inputLayout.GetLogicalEntryOffset({ inputRow, inputColumn, channel })] * _filterWeights((channel * filterSize) + windowRow, windowColumn, 0);
+                        }
+                    }
+                    depthwiseValues[entryIndex] = _epilogue.Compute(sum, channel, entryIndex);
+                }
+            }
+        }
+
+        std::vector<ValueType> outputValues(outputLayout.GetMemorySize(), 0);
+        if (!HasPointwiseConvolution())
+        {
+            entryIndex = 0;
+            for (int outputRow = 0; outputRow < outputRows; ++outputRow)
+            {
+                for (int outputColumn = 0; outputColumn < outputColumns; ++outputColumn)
+                {
+                    for (int channel = 0; channel < numChannels; ++channel, ++entryIndex)
+                    {
+                        outputValues[outputLayout.GetLogicalEntryOffset({ outputRow, outputColumn, channel })] = depthwiseValues[entryIndex];
+                    }
+                }
+            }
+            _output.SetOutput(outputValues);
+            return;
+        }
+
+        const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+        entryIndex = 0;
+        for (int outputRow = 0; outputRow < outputRows; ++outputRow)
+        {
+            for (int outputColumn = 0; outputColumn < outputColumns; ++outputColumn)
+            {
+                const auto depthwiseEntry = depthwiseValues.begin() + (((outputRow * outputColumns) + outputColumn) * numChannels);
+                for (int filter = 0; filter < numFilters; ++filter, ++entryIndex)
+                {
+                    ValueType sum = 0;
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        sum += depthwiseEntry[channel] * _pointwiseWeights(filter, 0, channel);
+                    }
+                    outputValues[outputLayout.GetLogicalEntryOffset({ outputRow, outputColumn, filter })] = _pointwiseEpilogue.Compute(sum, filter, entryIndex);
+                }
+            }
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        // Each block holds one vector of channels
+        const auto outputLayout = GetOutputMemoryLayout();
+        DepthwiseConvolutionParameters parameters{ _inputMemoryLayout,
+                                                   outputLayout.GetLogicalDimensionActiveSize(0),
+                                                   outputLayout.GetLogicalDimensionActiveSize(1),
+                                                   _inputMemoryLayout.GetLogicalDimensionActiveSize(2),
+                                                   static_cast<int>(_filterWeights.NumColumns()),
+                                                   _stride,
+                                                   options.allowVectorInstructions ? options.vectorWidth : 1 };
+        auto pWeights = function.GetModule().ConstantArray(GetInternalStateIdentifier() + "_packedWeights", GetPackedWeights());
+
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        if (!HasPointwiseConvolution())
+        {
+            EmitDepthwiseConvolutionCode<ValueType>(function, pInput, pWeights, pOutput, outputLayout, parameters, epilogue);
+            return;
+        }
+
+        auto pPointwiseWeights = function.GetModule().ConstantArray(GetInternalStateIdentifier() + "_pointwiseWeights", GetPointwiseWeightsMatrix());
+        FusedEpilogueEmitter<ValueType> pointwiseEpilogue(function, _pointwiseEpilogue, GetInternalStateIdentifier() + "_pointwise");
+        EmitDepthwisePointwiseConvolutionCode<ValueType>(function, pInput, pWeights, pPointwiseWeights, pOutput, outputLayout, parameters, epilogue, pointwiseEpilogue);
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["stride"] << _stride;
+        math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
+        math::TensorArchiver::Write(_pointwiseWeights, "pointwiseWeights", archiver);
+        _pointwiseEpilogue.WriteToArchive(archiver, "pointwiseEpilogue");
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["stride"] >> _stride;
+        math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
+        math::TensorArchiver::Read(_pointwiseWeights, "pointwiseWeights", archiver);
+        _pointwiseEpilogue.ReadFromArchive(archiver, "pointwiseEpilogue");
+    }
+
+    // Explicit specializations
+    template class DepthwiseConvolutionNode<float>;
+    template class DepthwiseConvolutionNode<double>;
+} // namespace nodes
+} // namespace ell
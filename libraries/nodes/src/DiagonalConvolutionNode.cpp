@@ -35,13 +35,15 @@ namespace nodes
                                                                 const model::PortMemoryLayout& inputMemoryLayout,
                                                                 const model::PortMemoryLayout& outputMemoryLayout,
                                                                 const ConstTensorReferenceType& filterWeights,
-                                                                int stride) :
+                                                                int stride,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _filterWeights(filterWeights),
-        _stride(stride)
+        _stride(stride),
+        _epilogue(epilogue)
     {
     }
 
@@ -49,7 +51,7 @@ namespace nodes
     void DiagonalConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<DiagonalConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride);
+        auto newNode = transformer.AddNode<DiagonalConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride, _epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
@@ -64,7 +66,7 @@ namespace nodes
         auto weightsValues = weightsTranspose.ToArray();
         int filterSize = _filterWeights.NumColumns();
         const auto& weights = AppendConstant(transformer, weightsValues);
-        auto convNode = transformer.AddNode<DiagonalConvolutionComputeNode<ValueType>>(newInput, weights, _inputMemoryLayout, GetOutputMemoryLayout(), filterSize, _stride);
+        auto convNode = transformer.AddNode<DiagonalConvolutionComputeNode<ValueType>>(newInput, weights, _inputMemoryLayout, GetOutputMemoryLayout(), filterSize, _stride, _epilogue);
         convNode->GetMetadata() = GetMetadata();
         transformer.MapNodeOutput(this->output, convNode->output);
         return true;
@@ -129,7 +131,9 @@ namespace nodes
                             sum += A(startRow + diagonal, l * filterSize + diagonal);
                         }
 
-                        outputMatrix(startRow + inputPadding, j + inputPadding + paddedWidth * (filterStart + l)) = sum;
+                        const int filterIndex = filterStart + l;
+                        const int entryIndex = (((startRow * outputWidth) + j) * numFilters) + filterIndex;
+                        outputMatrix(startRow + inputPadding, j + inputPadding + paddedWidth * filterIndex) = _epilogue.Compute(static_cast<ValueType>(sum), filterIndex, entryIndex);
                     }
                 }
             }
@@ -147,6 +151,7 @@ namespace nodes
         archiver["outputLayout"] << GetOutputMemoryLayout();
         archiver["stride"] << _stride;
         math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -160,6 +165,7 @@ namespace nodes
         _output.SetMemoryLayout(outputMemoryLayout);
         archiver["stride"] >> _stride;
         math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
     }
 
     //
@@ -181,14 +187,16 @@ namespace nodes
                                                                               const model::PortMemoryLayout& inputMemoryLayout,
                                                                               const model::PortMemoryLayout& outputMemoryLayout,
                                                                               int filterSize,
-                                                                              int stride) :
+                                                                              int stride,
+                                                                              const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input, &_filterWeights }, { &_output }),
         _input(this, input, defaultInputPortName),
         _filterWeights(this, filterWeights, filterWeightsPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _filterSize(filterSize),
-        _stride(stride)
+        _stride(stride),
+        _epilogue(epilogue)
     {
         const int numFilters = outputMemoryLayout.GetActiveSize(2);
         _batchSize = numFilters;
@@ -199,7 +207,7 @@ namespace nodes
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
         const auto& newFilterWeights = transformer.GetCorrespondingInputs(_filterWeights);
-        auto newNode = transformer.AddNode<DiagonalConvolutionComputeNode<ValueType>>(newInput, newFilterWeights, _inputMemoryLayout, GetOutputMemoryLayout(), _filterSize, _stride);
+        auto newNode = transformer.AddNode<DiagonalConvolutionComputeNode<ValueType>>(newInput, newFilterWeights, _inputMemoryLayout, GetOutputMemoryLayout(), _filterSize, _stride, _epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
@@ -240,6 +248,7 @@ namespace nodes
         const int paddedHeight = inputLayout.GetExtent(0);
 
         // output data parameters
+        const int outputWidth = outputLayout.GetActiveSize(1);
         const int numFilters = outputLayout.GetActiveSize(2);
 
         // computation parameters
@@ -296,8 +305,9 @@ namespace nodes
         llvm::GlobalVariable* scratch = function.GetModule().GlobalArray(emitters::GetVariableType<ValueType>(), "scratch", scratchMemSize);
         auto scratchPtr = function.PointerOffset(scratch, 0); // Convert LLVM array to pointer
 
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
         const size_t numConvolutions = (inputWidth - 1) / stackSize + 1;
-        function.For(numConvolutions, [inputDepth, pStackedInput, pWeights, scratchPtr, inputPadding, inputHeight, outputTensor, numFilters, batchSize, filterSize, stackedInputHeight, stackSize, stackedInputWidth, numConvolutions](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex1) {
+        function.For(numConvolutions, [inputDepth, pStackedInput, pWeights, scratchPtr, inputPadding, inputHeight, outputTensor, outputWidth, numFilters, batchSize, filterSize, stackedInputHeight, stackSize, stackedInputWidth, numConvolutions, epilogue](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex1) {
             auto j = function.LocalScalar(loopIndex1); // j = start column for convolution
 
             // Get the submatrix for Vj
@@ -325,16 +335,16 @@ namespace nodes
                 function.CallGEMM<ValueType>(false, true, m, n, k, Vj, lda, Wl, ldb, scratchPtr, ldc);
 
                 // S loop here as well
-                function.For(stackSize, [inputPadding, j, numFiltersToUse, numConvolutions, filterStart, inputHeight, filterSize, scratchPtr, outputTensor, batchSize](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex2) {
+                function.For(stackSize, [inputPadding, j, numFiltersToUse, numConvolutions, filterStart, inputHeight, filterSize, scratchPtr, outputTensor, outputWidth, numFilters, batchSize, epilogue](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex2) {
                     auto stackIndex = function.LocalScalar(loopIndex2);
                     auto stackRowOffset = stackIndex * function.LocalScalar<int>(inputHeight + inputPadding);
                     auto outputColumn = (stackIndex * function.LocalScalar<int>(numConvolutions)) + j;
 
-                    function.For(numFiltersToUse, [filterStart, inputHeight, stackRowOffset, filterSize, scratchPtr, outputColumn, outputTensor, batchSize](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex3) {
+                    function.For(numFiltersToUse, [filterStart, inputHeight, stackRowOffset, filterSize, scratchPtr, outputColumn, outputTensor, outputWidth, numFilters, batchSize, epilogue](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex3) {
                         auto l = function.LocalScalar(loopIndex3); // batchFilterIndex
                         auto filterIndex = function.LocalScalar<int>(filterStart) + l;
 
-                        function.For(inputHeight, [stackRowOffset, filterSize, l, scratchPtr, outputColumn, filterIndex, batchSize, outputTensor](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex4) {
+                        function.For(inputHeight, [stackRowOffset, filterSize, l, scratchPtr, outputColumn, filterIndex, batchSize, outputTensor, outputWidth, numFilters, epilogue](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex4) {
                             auto startRow = function.LocalScalar(loopIndex4);
                             auto stackStartRow = stackRowOffset + startRow;
                             auto sum = function.LocalScalar();
@@ -355,7 +365,8 @@ namespace nodes
                                     sum = sum + diagonalValue;
                             }
 
-                            outputTensor({ startRow, outputColumn, filterIndex }) = sum;
+                            auto entryIndex = (((startRow * outputWidth) + outputColumn) * numFilters) + filterIndex;
+                            outputTensor({ startRow, outputColumn, filterIndex }) = epilogue.Compile(sum, filterIndex, entryIndex);
                         });
                     });
                 });
@@ -374,6 +385,7 @@ namespace nodes
         archiver["filterSize"] << _filterSize;
         archiver["stride"] << _stride;
         archiver["batchSize"] << _batchSize;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -389,6 +401,7 @@ namespace nodes
         archiver["filterSize"] >> _filterSize;
         archiver["stride"] >> _stride;
         archiver["batchSize"] >> _batchSize;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicit specializations
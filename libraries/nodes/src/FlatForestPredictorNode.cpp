@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictorNode.cpp (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FlatForestPredictorNode.h"
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using predictors::SimpleForestPredictor;
+
+        // The leaves of a tree are the bits of a 64-bit mask in the bit-vector evaluation
+        const int maxBitVectorLeaves = 64;
+
+        // The forest, as arrays. Interior nodes and edges keep their indices in the forest.
+        struct FlatForest
+        {
+            // One entry per interior node
+            std::vector<int> featureIndices;
+            std::vector<double> thresholds;
+            std::vector<int> firstEdges;
+
+            // One entry per edge
+            std::vector<double> edgeValues;
+            std::vector<int> edgeTargets; // the index of the target interior node, or -1 for a leaf
+
+            // One entry per tree
+            std::vector<int> roots;
+        };
+
+        // The forest, as arrays for the bit-vector evaluation
+        struct BitVectorForest
+        {
+            // One entry per interior node, ordered by feature and then by threshold
+            std::vector<int> featureIndices;
+            std::vector<double> thresholds;
+            std::vector<int> trees;
+            std::vector<int64_t> masks; // clears the leaves of the node's left subtree
+
+            // One entry per leaf, ordered by tree and then from left to right
+            std::vector<double> leafValues; // the sum of the edge values on the path to the leaf
+            std::vector<int> leafEdges;
+
+            // One entry per tree
+            std::vector<int> firstLeaves;
+
+            // One entry per edge
+            std::vector<int> parentEdges; // the edge into the edge's source node, or -1 if the source is a root
+        };
+
+        FlatForest GetFlatForest(const SimpleForestPredictor& forest)
+        {
+            FlatForest flatForest;
+            flatForest.edgeValues.resize(forest.NumEdges());
+            flatForest.edgeTargets.resize(forest.NumEdges());
+            for (const auto& interiorNode : forest.GetInteriorNodes())
+            {
+                const auto& splitRule = interiorNode.GetSplitRule();
+                flatForest.featureIndices.push_back(static_cast<int>(splitRule.GetElementIndex()));
+                flatForest.thresholds.push_back(splitRule.GetThreshold());
+                flatForest.firstEdges.push_back(static_cast<int>(interiorNode.GetFirstEdgeIndex()));
+
+                const auto& edges = interiorNode.GetOutgoingEdges();
+                for (size_t position = 0; position < edges.size(); ++position)
+                {
+                    auto edgeIndex = interiorNode.GetFirstEdgeIndex() + position;
+                    flatForest.edgeValues[edgeIndex] = edges[position].GetPredictor().GetValue();
+                    flatForest.edgeTargets[edgeIndex] = edges[position].IsTargetInterior() ? static_cast<int>(edges[position].GetTargetNodeIndex()) : -1;
+                }
+            }
+
+            for (auto root : forest.GetRootIndices())
+            {
+                flatForest.roots.push_back(static_cast<int>(root));
+            }
+            return flatForest;
+        }
+
+        // Returns false if a tree has too many leaves for a 64-bit mask
+        bool TryGetBitVectorForest(const FlatForest& flatForest, BitVectorForest& bitVectorForest)
+        {
+            const auto numInteriorNodes = static_cast<int>(flatForest.featureIndices.size());
+            std::vector<int> nodeTrees(numInteriorNodes, 0);
+            std::vector<std::pair<int, int>> leftSubtreeLeaves(numInteriorNodes); // [begin, end) of each node's left subtree leaves, relative to the tree's first leaf
+
+            // A node's left subtree leaves start where the node's leaves start
+            std::vector<int> firstNodeLeaves(numInteriorNodes, 0);
+            for (int tree = 0; tree < static_cast<int>(flatForest.roots.size()); ++tree)
+            {
+                const int firstTreeLeaf = static_cast<int>(bitVectorForest.leafValues.size());
+                bitVectorForest.firstLeaves.push_back(firstTreeLeaf);
+
+                // Visit the tree depth-first, left to right, numbering the leaves
+                std::function<void(int, double)> visit = [&](int nodeIndex, double pathValue) {
+                    nodeTrees[nodeIndex] = tree;
+                    firstNodeLeaves[nodeIndex] = static_cast<int>(bitVectorForest.leafValues.size()) - firstTreeLeaf;
+                    for (int position = 0; position < 2; ++position)
+                    {
+                        const int edgeIndex = flatForest.firstEdges[nodeIndex] + position;
+                        const double value = pathValue + flatForest.edgeValues[edgeIndex];
+                        const int target = flatForest.edgeTargets[edgeIndex];
+                        if (target >= 0)
+                        {
+                            visit(target, value);
+                        }
+                        else
+                        {
+                            bitVectorForest.leafValues.push_back(value);
+                            bitVectorForest.leafEdges.push_back(edgeIndex);
+                        }
+
+                        if (position == 0)
+                        {
+                            leftSubtreeLeaves[nodeIndex] = { firstNodeLeaves[nodeIndex], static_cast<int>(bitVectorForest.leafValues.size()) - firstTreeLeaf };
+                        }
+                    }
+                };
+                visit(flatForest.roots[tree], 0.0);
+
+                if (static_cast<int>(bitVectorForest.leafValues.size()) - firstTreeLeaf > maxBitVectorLeaves)
+                {
+                    return false;
+                }
+            }
+
+            // Order the interior nodes by feature, so each feature's entries are together, and then by threshold
+            std::vector<int> nodeOrder(numInteriorNodes);
+            std::iota(nodeOrder.begin(), nodeOrder.end(), 0);
+            std::stable_sort(nodeOrder.begin(), nodeOrder.end(), [&flatForest](int a, int b) {
+                if (flatForest.featureIndices[a] != flatForest.featureIndices[b])
+                {
+                    return flatForest.featureIndices[a] < flatForest.featureIndices[b];
+                }
+                return flatForest.thresholds[a] < flatForest.thresholds[b];
+            });
+            for (auto nodeIndex : nodeOrder)
+            {
+                const auto& leftLeaves = leftSubtreeLeaves[nodeIndex];
+                const int numLeftLeaves = leftLeaves.second - leftLeaves.first;
+                const uint64_t leftMask = (numLeftLeaves == maxBitVectorLeaves ? ~uint64_t{ 0 } : ((uint64_t{ 1 } << numLeftLeaves) - 1)) << leftLeaves.first;
+
+                bitVectorForest.featureIndices.push_back(flatForest.featureIndices[nodeIndex]);
+                bitVectorForest.thresholds.push_back(flatForest.thresholds[nodeIndex]);
+                bitVectorForest.trees.push_back(nodeTrees[nodeIndex]);
+                bitVectorForest.masks.push_back(static_cast<int64_t>(~leftMask));
+            }
+
+            // Record the path from each edge back to its tree's root
+            std::vector<int> incomingEdges(numInteriorNodes, -1);
+            for (int nodeIndex = 0; nodeIndex < numInteriorNodes; ++nodeIndex)
+            {
+                for (int position = 0; position < 2; ++position)
+                {
+                    const int edgeIndex = flatForest.firstEdges[nodeIndex] + position;
+                    if (flatForest.edgeTargets[edgeIndex] >= 0)
+                    {
+                        incomingEdges[flatForest.edgeTargets[edgeIndex]] = edgeIndex;
+                    }
+                }
+            }
+            bitVectorForest.parentEdges.resize(flatForest.edgeValues.size(), -1);
+            for (int nodeIndex = 0; nodeIndex < numInteriorNodes; ++nodeIndex)
+            {
+                for (int position = 0; position < 2; ++position)
+                {
+                    bitVectorForest.parentEdges[flatForest.firstEdges[nodeIndex] + position] = incomingEdges[nodeIndex];
+                }
+            }
+            return true;
+        }
+
+        // The split rules compare the input as a float, because the predictor reads it into a `FloatDataVector`. Like the
+        // predictor, features past the end of the input are 0. Checking for them is only needed if some split rule reads
+        // past the end.
+        IRLocalScalar GetFeatureValue(IRFunctionEmitter& function, IRLocalArray input, int inputSize, bool readsPastEnd, IRLocalScalar featureIndex)
+        {
+            if (!readsPastEnd)
+            {
+                IRLocalScalar value = input[featureIndex];
+                return function.LocalScalar(function.CastValue<double>(function.CastValue<float>(value)));
+            }
+
+            auto isInside = featureIndex < inputSize;
+            auto clampedIndex = function.LocalScalar(function.Select(isInside, featureIndex, function.Literal<int>(0)));
+            IRLocalScalar value = input[clampedIndex];
+            auto floatValue = function.LocalScalar(function.CastValue<double>(function.CastValue<float>(value)));
+            return function.LocalScalar(function.Select(isInside, floatValue, function.Literal(0.0)));
+        }
+
+        bool ReadsPastEnd(const std::vector<int>& featureIndices, int inputSize)
+        {
+            return std::any_of(featureIndices.begin(), featureIndices.end(), [inputSize](int featureIndex) { return featureIndex >= inputSize; });
+        }
+
+        void EmitTreeTraversalCode(IRFunctionEmitter& function, LLVMValue pInput, int inputSize, LLVMValue pTreeOutputs, LLVMValue pEdgeIndicator, const FlatForest& flatForest, const std::string& name)
+        {
+            const bool readsPastEnd = ReadsPastEnd(flatForest.featureIndices, inputSize);
+            auto& module = function.GetModule();
+            auto featureIndices = function.LocalArray(module.ConstantArray(name + "_featureIndices", flatForest.featureIndices));
+            auto thresholds = function.LocalArray(module.ConstantArray(name + "_thresholds", flatForest.thresholds));
+            auto firstEdges = function.LocalArray(module.ConstantArray(name + "_firstEdges", flatForest.firstEdges));
+            auto edgeValues = function.LocalArray(module.ConstantArray(name + "_edgeValues", flatForest.edgeValues));
+            auto edgeTargets = function.LocalArray(module.ConstantArray(name + "_edgeTargets", flatForest.edgeTargets));
+            auto roots = function.LocalArray(module.ConstantArray(name + "_roots", flatForest.roots));
+
+            auto input = function.LocalArray(pInput);
+            auto treeOutputs = function.LocalArray(pTreeOutputs);
+            auto edgeIndicator = function.LocalArray(pEdgeIndicator);
+
+            auto nodeVariable = function.Variable(VariableType::Int32, "node");
+            auto treeOutputVariable = function.Variable(VariableType::Double, "treeOutput");
+            function.For(static_cast<int>(flatForest.roots.size()), [&](IRFunctionEmitter& function, IRLocalScalar tree) {
+                IRLocalScalar root = roots[tree];
+                function.Store(nodeVariable, root);
+                function.Store(treeOutputVariable, function.Literal(0.0));
+
+                // Follow the path from the root to a leaf. Leaves are marked by a negative target.
+                function.While([nodeVariable](IRFunctionEmitter& function) { return function.LocalScalar(function.Load(nodeVariable)) >= 0; }, [&](IRFunctionEmitter& function) {
+                    auto node = function.LocalScalar(function.Load(nodeVariable));
+                    auto featureValue = GetFeatureValue(function, input, inputSize, readsPastEnd, featureIndices[node]);
+                    IRLocalScalar firstEdge = firstEdges[node];
+                    auto edge = function.LocalScalar(function.Select(featureValue > thresholds[node], firstEdge + 1, firstEdge));
+
+                    auto treeOutput = function.LocalScalar(function.Load(treeOutputVariable));
+                    function.Store(treeOutputVariable, treeOutput + edgeValues[edge]);
+                    edgeIndicator[edge] = function.Literal(true);
+                    IRLocalScalar target = edgeTargets[edge];
+                    function.Store(nodeVariable, target);
+                });
+
+                treeOutputs[tree] = function.Load(treeOutputVariable);
+            });
+        }
+
+        void EmitBitVectorCode(IRFunctionEmitter& function, LLVMValue pInput, int inputSize, LLVMValue pTreeOutputs, LLVMValue pEdgeIndicator, const BitVectorForest& bitVectorForest, const std::string& name)
+        {
+            const bool readsPastEnd = ReadsPastEnd(bitVectorForest.featureIndices, inputSize);
+            auto& module = function.GetModule();
+            auto featureIndices = function.LocalArray(module.ConstantArray(name + "_featureIndices", bitVectorForest.featureIndices));
+            auto thresholds = function.LocalArray(module.ConstantArray(name + "_thresholds", bitVectorForest.thresholds));
+            auto trees = function.LocalArray(module.ConstantArray(name + "_trees", bitVectorForest.trees));
+            auto masks = function.LocalArray(module.ConstantArray(name + "_masks", bitVectorForest.masks));
+            auto leafValues = function.LocalArray(module.ConstantArray(name + "_leafValues", bitVectorForest.leafValues));
+            auto leafEdges = function.LocalArray(module.ConstantArray(name + "_leafEdges", bitVectorForest.leafEdges));
+            auto firstLeaves = function.LocalArray(module.ConstantArray(name + "_firstLeaves", bitVectorForest.firstLeaves));
+            auto parentEdges = function.LocalArray(module.ConstantArray(name + "_parentEdges", bitVectorForest.parentEdges));
+
+            auto input = function.LocalArray(pInput);
+            auto treeOutputs = function.LocalArray(pTreeOutputs);
+            auto edgeIndicator = function.LocalArray(pEdgeIndicator);
+
+            // Start with all the leaves of every tree, and let each split whose test goes right clear its left subtree
+            const int numTrees = static_cast<int>(bitVectorForest.firstLeaves.size());
+            auto pLeafMasks = function.Variable(VariableType::Int64, numTrees);
+            function.MemorySet<int64_t>(pLeafMasks, 0, function.Literal<uint8_t>(0xff), numTrees);
+            auto leafMasks = function.LocalArray(pLeafMasks);
+            auto allLeaves = function.LocalScalar(function.Literal<int64_t>(-1));
+            function.For(static_cast<int>(bitVectorForest.featureIndices.size()), [&](IRFunctionEmitter& function, IRLocalScalar index) {
+                auto featureValue = GetFeatureValue(function, input, inputSize, readsPastEnd, featureIndices[index]);
+                IRLocalScalar mask = masks[index];
+                IRLocalScalar tree = trees[index];
+                IRLocalScalar leafMask = leafMasks[tree];
+                leafMasks[tree] = leafMask & function.LocalScalar(function.Select(featureValue > thresholds[index], mask, allLeaves));
+            });
+
+            // The input reaches the leftmost remaining leaf of each tree
+            auto countTrailingZeros = module.GetIntrinsic(llvm::Intrinsic::cttz, { VariableType::Int64 });
+            auto edgeVariable = function.Variable(VariableType::Int32, "edge");
+            function.For(numTrees, [&](IRFunctionEmitter& function, IRLocalScalar tree) {
+                IRLocalScalar leafMask = leafMasks[tree];
+                auto leafPosition = function.LocalScalar(function.CastValue<int>(function.Call(countTrailingZeros, { leafMask, function.FalseBit() })));
+                auto leaf = firstLeaves[tree] + leafPosition;
+                treeOutputs[tree] = leafValues[leaf];
+
+                // Mark the path from the leaf back to the root
+                IRLocalScalar leafEdge = leafEdges[leaf];
+                function.Store(edgeVariable, leafEdge);
+                function.While([edgeVariable](IRFunctionEmitter& function) { return function.LocalScalar(function.Load(edgeVariable)) >= 0; }, [&](IRFunctionEmitter& function) {
+                    auto edge = function.LocalScalar(function.Load(edgeVariable));
+                    edgeIndicator[edge] = function.Literal(true);
+                    IRLocalScalar parentEdge = parentEdges[edge];
+                    function.Store(edgeVariable, parentEdge);
+                });
+            });
+        }
+    } // end anonymous namespace
+
+    FlatForestPredictorNode::FlatForestPredictorNode() :
+        CompilableNode({ &_input }, { &_output, &_treeOutputs, &_edgeIndicatorVector }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 1),
+        _treeOutputs(this, treeOutputsPortName, 0),
+        _edgeIndicatorVector(this, edgeIndicatorVectorPortName, 0)
+    {
+    }
+
+    FlatForestPredictorNode::FlatForestPredictorNode(const model::OutputPort<double>& input, const predictors::SimpleForestPredictor& forest) :
+        CompilableNode({ &_input }, { &_output, &_treeOutputs, &_edgeIndicatorVector }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, 1),
+        _treeOutputs(this, treeOutputsPortName, forest.NumTrees()),
+        _edgeIndicatorVector(this, edgeIndicatorVectorPortName, forest.NumEdges()),
+        _forest(forest)
+    {
+    }
+
+    void FlatForestPredictorNode::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FlatForestPredictorNode>(newInput, _forest);
+        transformer.MapNodeOutput(output, newNode->output);
+        transformer.MapNodeOutput(treeOutputs, newNode->treeOutputs);
+        transformer.MapNodeOutput(edgeIndicatorVector, newNode->edgeIndicatorVector);
+    }
+
+    void FlatForestPredictorNode::Compute() const
+    {
+        // forest output
+        auto inputDataVector = predictors::SimpleForestPredictor::DataVectorType(_input.GetValue());
+        _output.SetOutput({ _forest.Predict(inputDataVector) });
+
+        // individual tree outputs
+        std::vector<double> treeOutputs(_forest.NumTrees());
+        for (size_t i = 0; i < _forest.NumTrees(); ++i)
+        {
+            treeOutputs[i] = _forest.Predict(inputDataVector, _forest.GetRootIndex(i));
+        }
+        _treeOutputs.SetOutput(std::move(treeOutputs));
+
+        // path indicator
+        _edgeIndicatorVector.SetOutput(_forest.GetEdgeIndicatorVector(inputDataVector));
+    }
+
+    void FlatForestPredictorNode::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto flatForest = GetFlatForest(_forest);
+        const int inputSize = static_cast<int>(_input.Size());
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(_input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(_output);
+        LLVMValue pTreeOutputs = compiler.EnsurePortEmitted(_treeOutputs);
+        LLVMValue pEdgeIndicator = compiler.EnsurePortEmitted(_edgeIndicatorVector);
+
+        // The evaluation only sets the indicators of the edges on the paths
+        const int numEdges = static_cast<int>(_forest.NumEdges());
+        if (numEdges > 0)
+        {
+            function.MemorySet<bool>(pEdgeIndicator, 0, function.Literal<uint8_t>(0), numEdges);
+        }
+
+        auto useBitVectors = compiler.GetModelOptimizerOptions(*this).GetEntry<bool>("evaluateForestsWithBitVectors", false);
+        if (_forest.NumTrees() > 0)
+        {
+            BitVectorForest bitVectorForest;
+            if (useBitVectors && TryGetBitVectorForest(flatForest, bitVectorForest))
+            {
+                EmitBitVectorCode(function, pInput, inputSize, pTreeOutputs, pEdgeIndicator, bitVectorForest, GetInternalStateIdentifier());
+            }
+            else
+            {
+                EmitTreeTraversalCode(function, pInput, inputSize, pTreeOutputs, pEdgeIndicator, flatForest, GetInternalStateIdentifier());
+            }
+        }
+
+        // Sum the trees in the same order as the predictor, starting with the bias
+        auto treeOutputs = function.LocalArray(pTreeOutputs);
+        auto sum = function.LocalScalar(function.Literal(_forest.GetBias()));
+        for (int tree = 0; tree < static_cast<int>(_forest.NumTrees()); ++tree)
+        {
+            sum = sum + treeOutputs[tree];
+        }
+        function.SetValueAt(pOutput, 0, sum);
+    }
+
+    void FlatForestPredictorNode::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["forest"] << _forest;
+    }
+
+    void FlatForestPredictorNode::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["forest"] >> _forest;
+
+        _treeOutputs.SetSize(_forest.NumTrees());
+        _edgeIndicatorVector.SetSize(_forest.NumEdges());
+    }
+} // namespace nodes
+} // namespace ell
@@ -18,8 +18,9 @@ namespace ell
 namespace nodes
 {
     template <typename ValueType>
-    FullyConnectedLayerNode<ValueType>::FullyConnectedLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::FullyConnectedLayer<ValueType>& layer) :
-        NeuralNetworkLayerNode<FullyConnectedLayerNode<ValueType>, predictors::neural::FullyConnectedLayer<ValueType>, ValueType>(input, layer)
+    FullyConnectedLayerNode<ValueType>::FullyConnectedLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::FullyConnectedLayer<ValueType>& layer, const FusedEpilogue<ValueType>& epilogue) :
+        NeuralNetworkLayerNode<FullyConnectedLayerNode<ValueType>, predictors::neural::FullyConnectedLayer<ValueType>, ValueType>(input, layer),
+        _epilogue(epilogue)
     {
         const auto& layerParameters = layer.GetLayerParameters();
         if (HasPadding(layerParameters.inputPaddingParameters))
@@ -33,6 +34,18 @@ namespace nodes
         }
     }
 
+    template <typename ValueType>
+    void FullyConnectedLayerNode<ValueType>::Compute() const
+    {
+        BaseType::Compute();
+        if (!_epilogue.IsEmpty())
+        {
+            auto outputValues = this->_output.GetOutput();
+            _epilogue.Compute(outputValues, this->GetOutputMemoryLayout());
+            this->_output.SetOutput(outputValues);
+        }
+    }
+
     template <typename ValueType>
     bool FullyConnectedLayerNode<ValueType>::Refine(model::ModelTransformer& transformer) const
     {
@@ -64,7 +77,7 @@ namespace nodes
         auto lda = weights.GetIncrement();
         auto weightsValues = weights.ToArray();
         const auto& weightsOut = AppendConstant(transformer, weightsValues);
-        auto matrixMultiplyNode = transformer.AddNode<MatrixVectorMultiplyNode<ValueType>>(weightsOut, m, n, lda, newInput);
+        auto matrixMultiplyNode = transformer.AddNode<MatrixVectorMultiplyNode<ValueType>>(weightsOut, m, n, lda, newInput, _epilogue);
 
         // TODO: add a reorder node here that adds padding to the output, if necessary
 
@@ -76,10 +89,24 @@ namespace nodes
     void FullyConnectedLayerNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newPortElements = transformer.GetCorrespondingInputs(this->_input);
-        auto newNode = transformer.AddNode<FullyConnectedLayerNode<ValueType>>(newPortElements, this->_layer);
+        auto newNode = transformer.AddNode<FullyConnectedLayerNode<ValueType>>(newPortElements, this->_layer, _epilogue);
         transformer.MapNodeOutput(this->_output, newNode->output);
     }
 
+    template <typename ValueType>
+    void FullyConnectedLayerNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        BaseType::WriteToArchive(archiver);
+        _epilogue.WriteToArchive(archiver);
+    }
+
+    template <typename ValueType>
+    void FullyConnectedLayerNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        BaseType::ReadFromArchive(archiver);
+        _epilogue.ReadFromArchive(archiver);
+    }
+
     // Explicit specialization
     template class FullyConnectedLayerNode<float>;
     template class FullyConnectedLayerNode<double>;
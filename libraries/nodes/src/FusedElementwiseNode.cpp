@@ -0,0 +1,710 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedElementwiseNode.cpp (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FusedElementwiseNode.h"
+#include "ActivationFunctions.h"
+#include "BinaryOperationNode.h"
+#include "BroadcastFunctionNode.h"
+#include "ConstantNode.h"
+#include "UnaryOperationNode.h"
+
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRVectorUtilities.h>
+#include <emitters/include/LLVMUtilities.h>
+
+#include <utilities/include/Exception.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        std::string GetStepTypeName(ElementwiseStepType type)
+        {
+            switch (type)
+            {
+            case ElementwiseStepType::unaryOperation:
+                return "unaryOperation";
+            case ElementwiseStepType::binaryOperation:
+                return "binaryOperation";
+            case ElementwiseStepType::reLU:
+                return "reLU";
+            case ElementwiseStepType::leakyReLU:
+                return "leakyReLU";
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Unknown elementwise step type");
+            }
+        }
+
+        ElementwiseStepType GetStepType(const std::string& name)
+        {
+            for (auto type : { ElementwiseStepType::unaryOperation, ElementwiseStepType::binaryOperation, ElementwiseStepType::reLU, ElementwiseStepType::leakyReLU })
+            {
+                if (GetStepTypeName(type) == name)
+                {
+                    return type;
+                }
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Unknown elementwise step type " + name);
+        }
+
+        size_t GetEntryOffset(const model::PortMemoryLayout& layout, const std::vector<int>& coordinates)
+        {
+            size_t result = 0;
+            for (size_t dimension = 0; dimension < coordinates.size(); ++dimension)
+            {
+                result += layout.GetCumulativeIncrement(dimension) * (coordinates[dimension] + layout.GetOffset(dimension));
+            }
+            return result;
+        }
+
+        template <typename ValueType>
+        ValueType GetOperandValue(const ElementwiseStep<ValueType>& step, const std::vector<int>& coordinates, int entryIndex)
+        {
+            if (step.operand.size() == 1)
+            {
+                return step.operand[0];
+            }
+            return step.operand[step.operandDimension == ElementwiseStep<ValueType>::allDimensions ? entryIndex : coordinates[step.operandDimension]];
+        }
+
+        template <typename ValueType>
+        ValueType ComputeStep(const ElementwiseStep<ValueType>& step, ValueType x, ValueType operand)
+        {
+            switch (step.type)
+            {
+            case ElementwiseStepType::unaryOperation:
+                return ComputeUnaryOperation(x, step.unaryOperation);
+            case ElementwiseStepType::binaryOperation:
+            {
+                auto a = step.operandIsFirst ? operand : x;
+                auto b = step.operandIsFirst ? x : operand;
+                switch (step.binaryOperation)
+                {
+                case BinaryOperationType::add:
+                    return Add(a, b);
+                case BinaryOperationType::subtract:
+                    return Subtract(a, b);
+                case BinaryOperationType::multiply:
+                    return Multiply(a, b);
+                case BinaryOperationType::divide:
+                    return Divide(a, b);
+                default:
+                    throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Unsupported binary operation in fused elementwise node");
+                }
+            }
+            case ElementwiseStepType::reLU:
+                return ReLUActivationFunction<ValueType>().Compute(x);
+            case ElementwiseStepType::leakyReLU:
+                return LeakyReLUActivationFunction<ValueType>(step.parameter).Compute(x);
+            default:
+                throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Unknown elementwise step type");
+            }
+        }
+
+        template <typename ValueType>
+        emitters::LLVMValue CompileStep(emitters::IRFunctionEmitter& function, const ElementwiseStep<ValueType>& step, emitters::LLVMValue x, emitters::LLVMValue operand)
+        {
+            switch (step.type)
+            {
+            case ElementwiseStepType::unaryOperation:
+                return CompileUnaryOperation<ValueType>({ function, x }, step.unaryOperation).value;
+            case ElementwiseStepType::binaryOperation:
+            {
+                auto a = step.operandIsFirst ? operand : x;
+                auto b = step.operandIsFirst ? x : operand;
+                return function.Operator(emitters::GetOperator<ValueType>(ToEmitterType(step.binaryOperation)), a, b);
+            }
+            case ElementwiseStepType::reLU:
+                return ReLUActivationFunction<ValueType>().Compile(function, x);
+            case ElementwiseStepType::leakyReLU:
+                return LeakyReLUActivationFunction<ValueType>(step.parameter).Compile(function, x);
+            default:
+                throw emitters::EmitterException(emitters::EmitterError::notSupported, "Unknown elementwise step type");
+            }
+        }
+
+        template <typename ValueType>
+        const ConstantNode<ValueType>* GetConstantInputNode(const model::InputPort<ValueType>& input)
+        {
+            if (input.Size() == 0)
+            {
+                return nullptr;
+            }
+            return dynamic_cast<const ConstantNode<ValueType>*>(input.GetReferencedPort().GetNode());
+        }
+
+        // Replaces an operand whose values are all the same with a single value
+        template <typename ValueType>
+        void CollapseUniformOperand(ElementwiseStep<ValueType>& step)
+        {
+            const auto& operand = step.operand;
+            if (!operand.empty() && std::all_of(operand.begin(), operand.end(), [&](ValueType value) { return value == operand[0]; }))
+            {
+                step.operand.resize(1);
+            }
+        }
+
+        template <typename ValueType>
+        ElementwiseStep<ValueType> MakeUnaryStep(UnaryOperationType operation)
+        {
+            ElementwiseStep<ValueType> step;
+            step.type = ElementwiseStepType::unaryOperation;
+            step.unaryOperation = operation;
+            return step;
+        }
+
+        template <typename ValueType>
+        ElementwiseStep<ValueType> MakeBinaryStep(BinaryOperationType operation, const std::vector<ValueType>& operand, int operandDimension, bool operandIsFirst)
+        {
+            ElementwiseStep<ValueType> step;
+            step.type = ElementwiseStepType::binaryOperation;
+            step.binaryOperation = operation;
+            step.operand = operand;
+            step.operandDimension = operandDimension;
+            step.operandIsFirst = operandIsFirst;
+            CollapseUniformOperand(step);
+            return step;
+        }
+
+        // Returns the values of a constant with the given layout, one per active entry in physical order
+        template <typename ValueType>
+        std::vector<ValueType> GetActiveValues(const std::vector<ValueType>& values, const model::PortMemoryLayout& layout)
+        {
+            const auto& activeSize = layout.GetActiveSize();
+            const int numDimensions = layout.NumDimensions();
+            std::vector<ValueType> result;
+            std::vector<int> coordinates(numDimensions, 0);
+            for (int entryIndex = 0; entryIndex < activeSize.NumElements(); ++entryIndex)
+            {
+                result.push_back(values[layout.GetEntryOffset(coordinates)]);
+                for (int dimension = numDimensions - 1; dimension >= 0; --dimension)
+                {
+                    if (++coordinates[dimension] < activeSize[dimension])
+                    {
+                        break;
+                    }
+                    coordinates[dimension] = 0;
+                }
+            }
+            return result;
+        }
+
+        template <typename ValueType>
+        bool TryGetFusedNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+        {
+            auto thisNode = dynamic_cast<const FusedElementwiseNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            info.input = &thisNode->input.GetReferencedPort();
+            info.output = &thisNode->output;
+            info.inputLayout = thisNode->GetInputMemoryLayout();
+            info.outputLayout = thisNode->GetOutputMemoryLayout();
+            info.steps = thisNode->GetSteps();
+            info.padding = thisNode->GetOutputPadding();
+            return true;
+        }
+
+        template <typename ValueType>
+        bool TryGetLinearFunctionNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+        {
+            auto thisNode = dynamic_cast<const BroadcastLinearFunctionNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            // The coefficients must be constant, and have one entry per element along the broadcast dimension
+            const auto& inputLayout = thisNode->GetInputMemoryLayout();
+            const int broadcastDimension = static_cast<int>(thisNode->GetBroadcastDimension());
+            const auto scaleNode = GetConstantInputNode(thisNode->secondaryInput1);
+            const auto biasNode = GetConstantInputNode(thisNode->secondaryInput2);
+            if ((scaleNode == nullptr && thisNode->secondaryInput1.Size() != 0) || (biasNode == nullptr && thisNode->secondaryInput2.Size() != 0))
+            {
+                return false;
+            }
+            if (scaleNode == nullptr && biasNode == nullptr)
+            {
+                return false;
+            }
+            for (auto coefficientNode : { scaleNode, biasNode })
+            {
+                if (coefficientNode != nullptr && static_cast<int>(coefficientNode->GetValues().size()) != inputLayout.GetActiveSize(broadcastDimension))
+                {
+                    return false;
+                }
+            }
+
+            info.input = &thisNode->primaryInput.GetReferencedPort();
+            info.output = &thisNode->output;
+            info.inputLayout = inputLayout;
+            info.outputLayout = thisNode->GetOutputMemoryLayout();
+            info.steps.clear();
+            if (scaleNode != nullptr)
+            {
+                info.steps.push_back(MakeBinaryStep(BinaryOperationType::multiply, scaleNode->GetValues(), broadcastDimension, true));
+            }
+            if (biasNode != nullptr)
+            {
+                info.steps.push_back(MakeBinaryStep(BinaryOperationType::add, biasNode->GetValues(), broadcastDimension, false));
+            }
+            info.padding = thisNode->GetOutputPadding();
+            return true;
+        }
+
+        template <typename ValueType, typename FunctionType>
+        bool TryGetActivationFunctionNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info, ElementwiseStep<ValueType> step)
+        {
+            auto thisNode = dynamic_cast<const BroadcastUnaryFunctionNode<ValueType, FunctionType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            info.input = &thisNode->primaryInput.GetReferencedPort();
+            info.output = &thisNode->output;
+            info.inputLayout = thisNode->GetInputMemoryLayout();
+            info.outputLayout = thisNode->GetOutputMemoryLayout();
+            info.steps = { step };
+            info.padding = thisNode->GetOutputPadding();
+            return true;
+        }
+
+        template <typename ValueType>
+        bool TryGetActivationFunctionNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+        {
+            ElementwiseStep<ValueType> reLUStep;
+            reLUStep.type = ElementwiseStepType::reLU;
+            if (TryGetActivationFunctionNodeInfo<ValueType, ReLUActivationFunction<ValueType>>(node, info, reLUStep))
+            {
+                return true;
+            }
+
+            if (auto leakyReLUNode = dynamic_cast<const BroadcastUnaryFunctionNode<ValueType, LeakyReLUActivationFunction<ValueType>>*>(&node))
+            {
+                ElementwiseStep<ValueType> leakyReLUStep;
+                leakyReLUStep.type = ElementwiseStepType::leakyReLU;
+                leakyReLUStep.parameter = leakyReLUNode->GetFunction().GetLeakyFactor();
+                return TryGetActivationFunctionNodeInfo<ValueType, LeakyReLUActivationFunction<ValueType>>(node, info, leakyReLUStep);
+            }
+
+            return TryGetActivationFunctionNodeInfo<ValueType, SigmoidActivationFunction<ValueType>>(node, info, MakeUnaryStep<ValueType>(UnaryOperationType::sigmoid)) ||
+                   TryGetActivationFunctionNodeInfo<ValueType, HardSigmoidActivationFunction<ValueType>>(node, info, MakeUnaryStep<ValueType>(UnaryOperationType::hardSigmoid)) ||
+                   TryGetActivationFunctionNodeInfo<ValueType, TanhActivationFunction<ValueType>>(node, info, MakeUnaryStep<ValueType>(UnaryOperationType::tanh));
+        }
+
+        template <typename ValueType>
+        bool TryGetUnaryOperationNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+        {
+            auto thisNode = dynamic_cast<const UnaryOperationNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            auto operation = thisNode->GetOperation();
+            if (operation == UnaryOperationType::none || operation == UnaryOperationType::logicalNot)
+            {
+                return false;
+            }
+
+            // UnaryOperationNode applies its function to the whole input buffer, so it only matches a layout-based
+            // node if there is no padding
+            const auto& input = thisNode->input.GetReferencedPort();
+            auto layout = input.GetMemoryLayout();
+            if (layout.HasPadding())
+            {
+                return false;
+            }
+
+            info.input = &input;
+            info.output = &thisNode->output;
+            info.inputLayout = layout;
+            info.outputLayout = layout;
+            info.steps = { MakeUnaryStep<ValueType>(operation) };
+            info.padding = 0;
+            return true;
+        }
+
+        template <typename ValueType>
+        bool TryGetBinaryOperationNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+        {
+            auto thisNode = dynamic_cast<const BinaryOperationNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            auto operation = thisNode->GetOperation();
+            if (operation != BinaryOperationType::add && operation != BinaryOperationType::subtract && operation != BinaryOperationType::multiply && operation != BinaryOperationType::divide)
+            {
+                return false;
+            }
+
+            // Exactly one of the inputs must be a constant, laid out the same way as the other input
+            const auto constant1 = GetConstantInputNode(thisNode->input1);
+            const auto constant2 = GetConstantInputNode(thisNode->input2);
+            if ((constant1 == nullptr) == (constant2 == nullptr))
+            {
+                return false;
+            }
+
+            const bool operandIsFirst = constant1 != nullptr;
+            const auto& constantNode = operandIsFirst ? *constant1 : *constant2;
+            const auto& inputLayout = thisNode->GetInputMemoryLayout(operandIsFirst ? 1 : 0);
+            const auto& constantLayout = thisNode->GetInputMemoryLayout(operandIsFirst ? 0 : 1);
+            if (constantLayout != inputLayout || constantNode.GetValues().size() < constantLayout.GetMemorySize())
+            {
+                return false;
+            }
+
+            info.input = &(operandIsFirst ? thisNode->input2 : thisNode->input1).GetReferencedPort();
+            info.output = &thisNode->output;
+            info.inputLayout = inputLayout;
+            info.outputLayout = thisNode->GetOutputMemoryLayout();
+            info.steps = { MakeBinaryStep(operation, GetActiveValues(constantNode.GetValues(), constantLayout), ElementwiseStep<ValueType>::allDimensions, operandIsFirst) };
+            info.padding = thisNode->GetPaddingValue();
+            return true;
+        }
+    } // namespace
+
+    template <typename ValueType, typename OutputValueType>
+    FusedElementwiseNode<ValueType, OutputValueType>::FusedElementwiseNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _paddingValue(0)
+    {
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    FusedElementwiseNode<ValueType, OutputValueType>::FusedElementwiseNode(const model::OutputPort<ValueType>& input, const model::PortMemoryLayout& inputLayout, const model::PortMemoryLayout& outputLayout, const std::vector<ElementwiseStep<ValueType>>& steps, OutputValueType padding) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _inputLayout(inputLayout),
+        _output(this, defaultOutputPortName, outputLayout),
+        _steps(steps),
+        _paddingValue(padding)
+    {
+        if (inputLayout.GetActiveSize() != outputLayout.GetActiveSize())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: input and output active areas must match");
+        }
+
+        const auto& activeSize = inputLayout.GetActiveSize();
+        for (const auto& step : _steps)
+        {
+            if (step.type != ElementwiseStepType::binaryOperation || step.operand.size() == 1)
+            {
+                continue;
+            }
+
+            auto expectedSize = step.operandDimension == ElementwiseStep<ValueType>::allDimensions ? activeSize.NumElements() : activeSize[step.operandDimension];
+            if (static_cast<int>(step.operand.size()) != expectedSize)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "FusedElementwiseNode: operand size doesn't match the input");
+            }
+        }
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FusedElementwiseNode<ValueType, OutputValueType>>(newInput, _inputLayout, GetOutputMemoryLayout(), _steps, _paddingValue);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::Compute() const
+    {
+        auto outputLayout = GetOutputMemoryLayout();
+        const auto& activeSize = _inputLayout.GetActiveSize();
+        const int numDimensions = activeSize.NumDimensions();
+        const int numEntries = activeSize.NumElements();
+
+        auto inputValues = _input.GetValue();
+        std::vector<OutputValueType> outputValues(outputLayout.GetMemorySize(), _paddingValue);
+
+        // Visit the active entries in physical order
+        std::vector<int> coordinates(numDimensions, 0);
+        for (int entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+        {
+            auto value = inputValues[GetEntryOffset(_inputLayout, coordinates)];
+            for (const auto& step : _steps)
+            {
+                auto operand = step.type == ElementwiseStepType::binaryOperation ? GetOperandValue(step, coordinates, entryIndex) : static_cast<ValueType>(0);
+                value = ComputeStep(step, value, operand);
+            }
+            outputValues[GetEntryOffset(outputLayout, coordinates)] = static_cast<OutputValueType>(value);
+
+            for (int dimension = numDimensions - 1; dimension >= 0; --dimension)
+            {
+                if (++coordinates[dimension] < activeSize[dimension])
+                {
+                    break;
+                }
+                coordinates[dimension] = 0;
+            }
+        }
+
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto& module = function.GetModule();
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output, _paddingValue);
+
+        // Operands with more than one value are stored in constant arrays
+        std::vector<emitters::LLVMValue> operands;
+        for (size_t index = 0; index < _steps.size(); ++index)
+        {
+            const auto& operand = _steps[index].operand;
+            operands.push_back(operand.size() > 1 ? module.ConstantArray(GetInternalStateIdentifier() + "_operand" + std::to_string(index), operand) : nullptr);
+        }
+
+        std::vector<emitters::LLVMValue> operandValues(_steps.size(), nullptr);
+        EmitComputeDimensionLoop(function, 0, pInput, pOutput, operands, function.LocalScalar(), function.LocalScalar(), function.LocalScalar(), operandValues);
+    }
+
+    //
+    // Emits a loop nest over the active area, like the one BroadcastFunctionNode emits. Operands that vary along an outer
+    // dimension are loaded in that dimension's loop, and the innermost dimension is computed with a single elementwise loop
+    // that applies all of the steps.
+    //
+    // Note: operandValues is passed by non-const reference to avoid copies. It doesn't function as an output parameter.
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::EmitComputeDimensionLoop(emitters::IRFunctionEmitter& function,
+                                                                                     int dimension,
+                                                                                     emitters::LLVMValue input,
+                                                                                     emitters::LLVMValue output,
+                                                                                     const std::vector<emitters::LLVMValue>& operands,
+                                                                                     emitters::IRLocalScalar prevInputDimensionOffset,
+                                                                                     emitters::IRLocalScalar prevOutputDimensionOffset,
+                                                                                     emitters::IRLocalScalar prevEntryIndex,
+                                                                                     std::vector<emitters::LLVMValue>& operandValues) const
+    {
+        const auto& inputLayout = _inputLayout;
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int numDimensions = inputLayout.NumDimensions();
+        const int size = inputLayout.GetActiveSize(dimension);
+        const int inputOffset = inputLayout.GetOffset(dimension);
+        const int inputStride = inputLayout.GetExtent(dimension);
+        const int outputOffset = outputLayout.GetOffset(dimension);
+        const int outputStride = outputLayout.GetExtent(dimension);
+
+        if (dimension == numDimensions - 1)
+        {
+            auto inputStart = function.LocalScalar<int>(inputOffset);
+            auto outputStart = function.LocalScalar<int>(outputOffset);
+            auto entryStart = function.LocalScalar<int>(0);
+            if (dimension != 0)
+            {
+                inputStart = inputStart + (prevInputDimensionOffset * inputStride);
+                outputStart = outputStart + (prevOutputDimensionOffset * outputStride);
+                entryStart = prevEntryIndex * size;
+            }
+
+            // The loop's inputs are the primary input followed by each step's operand: constant and outer-dimension
+            // operands are broadcast, the others are read along with the input
+            std::vector<emitters::ElementwiseOperand> loopInputs{ { function.PointerOffset(input, inputStart) } };
+            for (size_t index = 0; index < _steps.size(); ++index)
+            {
+                const auto& step = _steps[index];
+                emitters::ElementwiseOperand operand; // steps without an operand get a null value
+                if (step.type == ElementwiseStepType::binaryOperation)
+                {
+                    if (step.operand.size() == 1)
+                    {
+                        operand.value = function.Literal<ValueType>(step.operand[0]);
+                    }
+                    else if (step.operandDimension == dimension)
+                    {
+                        operand.pointer = operands[index];
+                    }
+                    else if (step.operandDimension == ElementwiseStep<ValueType>::allDimensions)
+                    {
+                        operand.pointer = function.PointerOffset(operands[index], entryStart);
+                    }
+                    else
+                    {
+                        operand.value = operandValues[index];
+                    }
+                }
+                loopInputs.push_back(operand);
+            }
+
+            auto body = [this](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& values) {
+                auto result = values[0];
+                for (size_t index = 0; index < _steps.size(); ++index)
+                {
+                    result = CompileStep(function, _steps[index], result, values[index + 1]);
+                }
+                if (!std::is_same<ValueType, OutputValueType>::value)
+                {
+                    result = function.CastValue<OutputValueType>(result);
+                }
+                return result;
+            };
+            emitters::EmitElementwiseLoop(function, size, loopInputs, { function.PointerOffset(output, outputStart) }, body);
+            return;
+        }
+
+        function.For(size, [&, dimension, inputOffset, inputStride, outputOffset, outputStride](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar loopIndex) {
+            auto thisInputDimensionOffset = loopIndex + inputOffset;
+            auto thisOutputDimensionOffset = loopIndex + outputOffset;
+            auto thisEntryIndex = loopIndex;
+            if (dimension != 0)
+            {
+                thisInputDimensionOffset = thisInputDimensionOffset + (prevInputDimensionOffset * inputStride);
+                thisOutputDimensionOffset = thisOutputDimensionOffset + (prevOutputDimensionOffset * outputStride);
+                thisEntryIndex = thisEntryIndex + (prevEntryIndex * inputLayout.GetActiveSize(dimension));
+            }
+
+            for (size_t index = 0; index < _steps.size(); ++index)
+            {
+                if (_steps[index].operand.size() > 1 && _steps[index].operandDimension == dimension)
+                {
+                    operandValues[index] = function.ValueAt(operands[index], loopIndex);
+                }
+            }
+
+            this->EmitComputeDimensionLoop(function, dimension + 1, input, output, operands, thisInputDimensionOffset, thisOutputDimensionOffset, thisEntryIndex, operandValues);
+        });
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["paddingValue"] << _paddingValue;
+
+        // The steps are stored as parallel arrays, with the operands concatenated
+        std::vector<std::string> stepTypes;
+        std::vector<std::string> stepOperations;
+        std::vector<int> operandSizes;
+        std::vector<ValueType> operands;
+        std::vector<int> operandDimensions;
+        std::vector<int> operandIsFirst;
+        std::vector<ValueType> parameters;
+        for (const auto& step : _steps)
+        {
+            stepTypes.push_back(GetStepTypeName(step.type));
+            if (step.type == ElementwiseStepType::unaryOperation)
+            {
+                stepOperations.push_back(ToString(step.unaryOperation));
+            }
+            else if (step.type == ElementwiseStepType::binaryOperation)
+            {
+                stepOperations.push_back(ToString(step.binaryOperation));
+            }
+            else
+            {
+                stepOperations.push_back("");
+            }
+            operandSizes.push_back(static_cast<int>(step.operand.size()));
+            operands.insert(operands.end(), step.operand.begin(), step.operand.end());
+            operandDimensions.push_back(step.operandDimension);
+            operandIsFirst.push_back(step.operandIsFirst ? 1 : 0);
+            parameters.push_back(step.parameter);
+        }
+        archiver["stepTypes"] << stepTypes;
+        archiver["stepOperations"] << stepOperations;
+        archiver["operandSizes"] << operandSizes;
+        archiver["operands"] << operands;
+        archiver["operandDimensions"] << operandDimensions;
+        archiver["operandIsFirst"] << operandIsFirst;
+        archiver["parameters"] << parameters;
+    }
+
+    template <typename ValueType, typename OutputValueType>
+    void FusedElementwiseNode<ValueType, OutputValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputLayout;
+        model::PortMemoryLayout outputLayout;
+        archiver["outputLayout"] >> outputLayout;
+        _output.SetMemoryLayout(outputLayout);
+        archiver["paddingValue"] >> _paddingValue;
+
+        std::vector<std::string> stepTypes;
+        std::vector<std::string> stepOperations;
+        std::vector<int> operandSizes;
+        std::vector<ValueType> operands;
+        std::vector<int> operandDimensions;
+        std::vector<int> operandIsFirst;
+        std::vector<ValueType> parameters;
+        archiver["stepTypes"] >> stepTypes;
+        archiver["stepOperations"] >> stepOperations;
+        archiver["operandSizes"] >> operandSizes;
+        archiver["operands"] >> operands;
+        archiver["operandDimensions"] >> operandDimensions;
+        archiver["operandIsFirst"] >> operandIsFirst;
+        archiver["parameters"] >> parameters;
+
+        _steps.clear();
+        auto operandStart = operands.begin();
+        for (size_t index = 0; index < stepTypes.size(); ++index)
+        {
+            ElementwiseStep<ValueType> step;
+            step.type = GetStepType(stepTypes[index]);
+            if (step.type == ElementwiseStepType::unaryOperation)
+            {
+                step.unaryOperation = FromString<UnaryOperationType>(stepOperations[index]);
+            }
+            else if (step.type == ElementwiseStepType::binaryOperation)
+            {
+                step.binaryOperation = FromString<BinaryOperationType>(stepOperations[index]);
+            }
+            step.operand.assign(operandStart, operandStart + operandSizes[index]);
+            operandStart += operandSizes[index];
+            step.operandDimension = operandDimensions[index];
+            step.operandIsFirst = operandIsFirst[index] != 0;
+            step.parameter = parameters[index];
+            _steps.push_back(step);
+        }
+    }
+
+    //
+    // Getting the function of an elementwise node
+    //
+    template <typename ValueType>
+    bool TryGetElementwiseNodeInfo(const model::Node& node, ElementwiseNodeInfo<ValueType>& info)
+    {
+        return TryGetFusedNodeInfo(node, info) ||
+               TryGetLinearFunctionNodeInfo(node, info) ||
+               TryGetActivationFunctionNodeInfo(node, info) ||
+               TryGetUnaryOperationNodeInfo(node, info) ||
+               TryGetBinaryOperationNodeInfo(node, info);
+    }
+
+    // Explicit specializations
+    template class FusedElementwiseNode<float, float>;
+    template class FusedElementwiseNode<float, double>;
+    template class FusedElementwiseNode<float, int>;
+    template class FusedElementwiseNode<double, float>;
+    template class FusedElementwiseNode<double, double>;
+    template class FusedElementwiseNode<double, int>;
+
+    template bool TryGetElementwiseNodeInfo(const model::Node& node, ElementwiseNodeInfo<float>& info);
+    template bool TryGetElementwiseNodeInfo(const model::Node& node, ElementwiseNodeInfo<double>& info);
+} // namespace nodes
+} // namespace ell
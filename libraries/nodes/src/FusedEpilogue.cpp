@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedEpilogue.cpp (nodes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FusedEpilogue.h"
+#include "ActivationFunctions.h"
+
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <utilities/include/Exception.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        std::string GetActivationTypeName(EpilogueActivationType type)
+        {
+            switch (type)
+            {
+            case EpilogueActivationType::none:
+                return "none";
+            case EpilogueActivationType::reLU:
+                return "reLU";
+            case EpilogueActivationType::leakyReLU:
+                return "leakyReLU";
+            case EpilogueActivationType::parametricReLU:
+                return "parametricReLU";
+            case EpilogueActivationType::hardSigmoid:
+                return "hardSigmoid";
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Unknown epilogue activation type");
+            }
+        }
+
+        EpilogueActivationType GetActivationType(const std::string& name)
+        {
+            for (auto type : { EpilogueActivationType::none, EpilogueActivationType::reLU, EpilogueActivationType::leakyReLU, EpilogueActivationType::parametricReLU, EpilogueActivationType::hardSigmoid })
+            {
+                if (GetActivationTypeName(type) == name)
+                {
+                    return type;
+                }
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Unknown epilogue activation type " + name);
+        }
+    } // namespace
+
+    //
+    // FusedEpilogue
+    //
+    template <typename ValueType>
+    ValueType FusedEpilogue<ValueType>::Compute(ValueType value, int channel, int entryIndex) const
+    {
+        if (!bias.empty())
+        {
+            value += bias[channel];
+        }
+
+        switch (activation)
+        {
+        case EpilogueActivationType::none:
+            return value;
+        case EpilogueActivationType::reLU:
+            return ReLUActivationFunction<ValueType>().Compute(value);
+        case EpilogueActivationType::leakyReLU:
+            return LeakyReLUActivationFunction<ValueType>(leakyFactor).Compute(value);
+        case EpilogueActivationType::parametricReLU:
+            return ParametricReLUActivationFunction<ValueType>().Compute(value, alpha[entryIndex]);
+        case EpilogueActivationType::hardSigmoid:
+            return HardSigmoidActivationFunction<ValueType>().Compute(value);
+        default:
+            throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Unknown epilogue activation type");
+        }
+    }
+
+    template <typename ValueType>
+    void FusedEpilogue<ValueType>::Compute(std::vector<ValueType>& values, const model::PortMemoryLayout& layout) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        const auto numRows = layout.GetLogicalDimensionActiveSize(0);
+        const auto numColumns = layout.GetLogicalDimensionActiveSize(1);
+        const auto numChannels = layout.GetLogicalDimensionActiveSize(2);
+        int entryIndex = 0;
+        for (int row = 0; row < numRows; ++row)
+        {
+            for (int column = 0; column < numColumns; ++column)
+            {
+                for (int channel = 0; channel < numChannels; ++channel, ++entryIndex)
+                {
+                    auto& value = values[layout.GetLogicalEntryOffset({ row, column, channel })];
+                    value = Compute(value, channel, entryIndex);
+                }
+            }
+        }
+    }
+
+    template <typename ValueType>
+    void FusedEpilogue<ValueType>::WriteToArchive(utilities::Archiver& archiver, const std::string& prefix) const
+    {
+        archiver[prefix + "Bias"] << bias;
+        archiver[prefix + "Activation"] << GetActivationTypeName(activation);
+        archiver[prefix + "LeakyFactor"] << leakyFactor;
+        archiver[prefix + "Alpha"] << alpha;
+    }
+
+    template <typename ValueType>
+    void FusedEpilogue<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver, const std::string& prefix)
+    {
+        std::string activationName;
+        archiver.OptionalProperty(prefix + "Bias", std::vector<ValueType>{}) >> bias;
+        archiver.OptionalProperty(prefix + "Activation", GetActivationTypeName(EpilogueActivationType::none)) >> activationName;
+        archiver.OptionalProperty(prefix + "LeakyFactor", ValueType{ 0 }) >> leakyFactor;
+        archiver.OptionalProperty(prefix + "Alpha", std::vector<ValueType>{}) >> alpha;
+        activation = GetActivationType(activationName);
+    }
+
+    //
+    // FusedEpilogueEmitter
+    //
+    template <typename ValueType>
+    FusedEpilogueEmitter<ValueType>::FusedEpilogueEmitter(emitters::IRFunctionEmitter& function, const FusedEpilogue<ValueType>& epilogue, const std::string& name) :
+        _activation(epilogue.activation),
+        _leakyFactor(epilogue.leakyFactor),
+        _numBiasChannels(static_cast<int>(epilogue.bias.size()))
+    {
+        auto& module = function.GetModule();
+        if (!epilogue.bias.empty())
+        {
+            _bias = module.ConstantArray(name + "_epilogueBias", epilogue.bias);
+        }
+
+        if (_activation == EpilogueActivationType::parametricReLU)
+        {
+            _alpha = module.ConstantArray(name + "_epilogueAlpha", epilogue.alpha);
+        }
+    }
+
+    template <typename ValueType>
+    emitters::IRLocalScalar FusedEpilogueEmitter<ValueType>::Compile(emitters::IRLocalScalar value, emitters::IRLocalScalar channel, emitters::IRLocalScalar entryIndex) const
+    {
+        auto& function = value.function;
+        auto result = value;
+        if (_bias != nullptr)
+        {
+            result = result + function.LocalScalar(function.ValueAt(_bias, channel));
+        }
+
+        switch (_activation)
+        {
+        case EpilogueActivationType::none:
+            return result;
+        case EpilogueActivationType::reLU:
+            return function.LocalScalar(ReLUActivationFunction<ValueType>().Compile(function, result));
+        case EpilogueActivationType::leakyReLU:
+            return function.LocalScalar(LeakyReLUActivationFunction<ValueType>(_leakyFactor).Compile(function, result));
+        case EpilogueActivationType::parametricReLU:
+            return function.LocalScalar(ParametricReLUActivationFunction<ValueType>().Compile(function, result, function.ValueAt(_alpha, entryIndex)));
+        case EpilogueActivationType::hardSigmoid:
+            return HardSigmoidActivationFunction<ValueType>().Compile(result);
+        default:
+            throw emitters::EmitterException(emitters::EmitterError::notSupported, "Unknown epilogue activation type");
+        }
+    }
+
+    template <typename ValueType>
+    void FusedEpilogueEmitter<ValueType>::CompileChannels(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const model::PortMemoryLayout& layout, emitters::IRLocalScalar beginChannel, int numChannels) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        const auto numRows = layout.GetLogicalDimensionActiveSize(0);
+        const auto numColumns = layout.GetLogicalDimensionActiveSize(1);
+        const auto totalChannels = layout.GetLogicalDimensionActiveSize(2);
+        const auto increment = layout.GetLogicalDimensionIncrement();
+        const auto offset = layout.GetLogicalDimensionOffset();
+        const int firstEntryOffset = (offset[0] * increment[0]) + (offset[1] * increment[1]) + (offset[2] * increment[2]);
+        auto outputArray = function.LocalArray(function.PointerOffset(output, firstEntryOffset));
+        function.For(numRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+            function.For(numColumns, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+                auto pixelIndex = (row * numColumns) + column;
+                auto pixelOffset = (row * static_cast<int>(increment[0])) + (column * static_cast<int>(increment[1]));
+                function.For(numChannels, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channelIndex) {
+                    auto channel = beginChannel + channelIndex;
+                    auto entryOffset = pixelOffset + (channel * static_cast<int>(increment[2]));
+                    emitters::IRLocalScalar value = outputArray[entryOffset];
+                    outputArray[entryOffset] = Compile(value, channel, (pixelIndex * totalChannels) + channel);
+                });
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void FusedEpilogueEmitter<ValueType>::CompileEntries(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, emitters::IRLocalScalar beginEntry, int numEntries) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        auto outputArray = function.LocalArray(output);
+        function.For(numEntries, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            auto entryIndex = beginEntry + index;
+            auto channel = _numBiasChannels > 1 ? entryIndex % _numBiasChannels : function.LocalScalar<int>(0);
+            emitters::IRLocalScalar value = outputArray[index];
+            outputArray[index] = Compile(value, channel, entryIndex);
+        });
+    }
+
+    // Explicit instantiations
+    template struct FusedEpilogue<float>;
+    template struct FusedEpilogue<double>;
+    template class FusedEpilogueEmitter<float>;
+    template class FusedEpilogueEmitter<double>;
+} // namespace nodes
+} // namespace ell
@@ -7,10 +7,12 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "GRUNode.h"
+#include "ActivationFunctions.h"
 
 #include <math/include/MatrixOperations.h>
 
 #include <utilities/include/Exception.h>
+#include <utilities/include/Unused.h>
 
 namespace ell
 {
@@ -35,14 +37,15 @@ namespace nodes
                                 const model::OutputPort<ValueType>& hiddenBias,
                                 const ActivationType& activation,
                                 const ActivationType& recurrentActivation,
-                                bool validateWeights) :
-        LSTMNode<ValueType>(input, resetTrigger, hiddenUnits, inputWeights, hiddenWeights, inputBias, hiddenBias, activation, recurrentActivation, false)
+                                bool validateWeights,
+                                size_t sequenceLength) :
+        LSTMNode<ValueType>(input, resetTrigger, hiddenUnits, inputWeights, hiddenWeights, inputBias, hiddenBias, activation, recurrentActivation, false, sequenceLength)
     {
         if (validateWeights)
         {
             size_t stackHeight = 3; // GRU has 3 stacked weights for (input, reset, hidden).
             size_t numRows = stackHeight * hiddenUnits;
-            size_t numColumns = input.Size();
+            size_t numColumns = input.Size() / sequenceLength;
 
             if (inputWeights.Size() != numRows * numColumns)
             {
@@ -80,12 +83,12 @@ namespace nodes
         const auto& newHiddenWeights = transformer.GetCorrespondingInputs(this->_hiddenWeights);
         const auto& newInputBias = transformer.GetCorrespondingInputs(this->_inputBias);
         const auto& newHiddenBias = transformer.GetCorrespondingInputs(this->_hiddenBias);
-        auto newNode = transformer.AddNode<GRUNode>(newInput, newResetTrigger, this->_hiddenUnits, newInputWeights, newHiddenWeights, newInputBias, newHiddenBias, this->_activation, this->_recurrentActivation);
+        auto newNode = transformer.AddNode<GRUNode>(newInput, newResetTrigger, this->_hiddenUnits, newInputWeights, newHiddenWeights, newInputBias, newHiddenBias, this->_activation, this->_recurrentActivation, true, this->_sequenceLength);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
     template <typename ValueType>
-    void GRUNode<ValueType>::Compute() const
+    void GRUNode<ValueType>::ComputeStep(const VectorType& inputVector) const
     {
         using ConstMatrixReferenceType = math::ConstRowMatrixReference<ValueType>;
         /*
@@ -97,7 +100,6 @@ namespace nodes
         */
         size_t hiddenUnits = this->_hiddenUnits;
         size_t stackHeight = 3; // GRU has 3 stacked weights for (input, reset, hidden)
-        VectorType inputVector = this->_input.GetValue();
         size_t numRows = stackHeight * hiddenUnits;
         size_t numColumns = inputVector.Size();
         std::vector<ValueType> inputWeightsValue = this->_inputWeights.GetValue();
@@ -149,13 +151,6 @@ namespace nodes
         this->_hiddenState -= hidden_gate;
         ElementwiseMultiplySet(this->_hiddenState, input_gate, this->_hiddenState);
         this->_hiddenState += hidden_gate;
-
-        if (this->ShouldReset())
-        {
-            const_cast<GRUNode<ValueType>*>(this)->Reset();
-        }
-
-        this->_output.SetOutput(this->_hiddenState.ToArray());
     }
 
     template <typename ValueType>
@@ -172,106 +167,42 @@ namespace nodes
     template <typename ValueType>
     void GRUNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
-        const int hiddenUnits = static_cast<int>(this->_hiddenUnits);
-        const int inputSize = static_cast<int>(this->input.Size());
-        const int outputSize = static_cast<int>(this->_hiddenUnits);
-
-        // Get LLVM references for all node inputs
-        auto input = compiler.EnsurePortEmitted(this->input);
-        auto resetTrigger = compiler.EnsurePortEmitted(this->resetTrigger);
-        auto inputWeights = compiler.EnsurePortEmitted(this->inputWeights);
-        auto hiddenWeights = compiler.EnsurePortEmitted(this->hiddenWeights);
-        auto inputBias = compiler.EnsurePortEmitted(this->inputBias);
-        auto hiddenBias = compiler.EnsurePortEmitted(this->hiddenBias);
-
-        // Get LLVM reference for node output
-        auto output = function.LocalArray(compiler.EnsurePortEmitted(this->output));
-
-        // Allocate global buffer for hidden state
-        emitters::IRModuleEmitter& module = function.GetModule();
-        auto hiddenStateVariable = module.Variables().AddVectorVariable<ValueType>(emitters::VariableScope::global, hiddenUnits);
-        auto hiddenStateValue = module.EnsureEmitted(*hiddenStateVariable);
-        auto hiddenStatePointer = function.PointerOffset(hiddenStateValue, 0); // convert "global variable" to a pointer
-        auto hiddenState = function.LocalArray(hiddenStatePointer);
-        auto& prevHiddenState = hiddenState;
-
-        // Allocate local variables
-        const size_t stackSize = hiddenUnits * 3;
-        auto istack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto hstack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto inputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto resetGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto hiddenGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-
-        auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
-        auto beta = static_cast<ValueType>(1.0); // GEMV scaling of the bias addition
-
-        // W_i * x + b, one matrix multiplication for all 3 gates (input,reset,hidden)
-        function.MemoryCopy<ValueType>(inputBias, istack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, istack, 1);
-
-        // W_h * h + b
-        function.MemoryCopy<ValueType>(hiddenBias, hstack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, hiddenState, 1, beta, hstack, 1);
+        /*
+        rt = sigma(W_{ ir } x + b_{ ir } + W_{ hr } h + b_{ hr })
+        zt = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
+        nt = tanh(W_{ in } x + b_{ in } + rt * (W_{ hn } h + b_{ hn }))
+        ht = (1 - zt) * nt + zt * h
+        */
+        const int stackHeight = 3; // GRU has 3 stacked weights for (input, reset, hidden).
+        this->CompileRecurrence(compiler, function, stackHeight, false, "GRUNodeReset");
+    }
 
-        // the weights are stacked in 3 slices for (input, reset, hidden).
-        auto istack_slice0 = istack;
-        auto istack_slice1 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits)));
-        auto istack_slice2 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 2)));
-        auto hstack_slice0 = hstack;
-        auto hstack_slice1 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits)));
-        auto hstack_slice2 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 2)));
+    template <typename ValueType>
+    void GRUNode<ValueType>::CompileHiddenUnitUpdate(emitters::IRFunctionEmitter& function,
+                                                     const std::vector<emitters::IRLocalScalar>& inputGates,
+                                                     const std::vector<emitters::IRLocalScalar>& hiddenGates,
+                                                     emitters::IRLocalArray hiddenState,
+                                                     emitters::IRLocalArray cellState,
+                                                     emitters::IRLocalScalar unit)
+    {
+        UNUSED(cellState); // GRU has no cell state
+        auto activation = GetNodeActivationFunction(this->_activation);
+        auto recurrentActivation = GetNodeActivationFunction(this->_recurrentActivation);
 
         // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            inputGate[i] = istack_slice0[i] + hstack_slice0[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, inputGate, hiddenUnits);
+        auto z = function.LocalScalar(recurrentActivation->Compile(function, inputGates[0] + hiddenGates[0]));
 
         // reset_gate = sigma(W_{ ir } x + b_{ ir } + W_{ hr } h + b_{ hr })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            resetGate[i] = istack_slice1[i] + hstack_slice1[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, resetGate, hiddenUnits);
+        auto r = function.LocalScalar(recurrentActivation->Compile(function, inputGates[1] + hiddenGates[1]));
 
         // hidden_gate = tanh(W_{ in } x + b_{ in } + reset_gate * (W_{ hn } h + b_{ hn }))
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            hiddenGate[i] = istack_slice2[i] + resetGate[i] * hstack_slice2[i];
-        });
-        this->ApplyActivation(function, this->_activation, hiddenGate, hiddenUnits);
+        auto n = function.LocalScalar(activation->Compile(function, inputGates[2] + r * hiddenGates[2]));
 
         //ht = (1 - input_gate) * hidden_gate + input_gate * h
         //   = hidden_gate - input_gate * hidden_gate + input_gate * h
         //   = hidden_gate + input_gate (h - hidden_gate )
-
-        function.For(outputSize, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto z_i = inputGate[i];
-            auto n_i = hiddenGate[i];
-            auto h_i = prevHiddenState[i];
-            auto newValue = n_i + z_i * (h_i - n_i);
-            hiddenState[i] = newValue;
-        });
-
-        // Copy hidden state to the output.
-        function.MemoryCopy<ValueType>(hiddenState, output, hiddenUnits);
-
-        // Add the internal reset function
-        std::string resetFunctionName = compiler.GetGlobalName(*this, "GRUNodeReset");
-        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
-        auto resetHiddenState = resetFunction.LocalArray(hiddenStateValue);
-        resetFunction.MemorySet<ValueType>(resetHiddenState, 0, function.Literal<uint8_t>(0), outputSize);
-        //resetFunction.Print("### GRU Node was reset\n"); // this is a handy way to debug whether the VAD node is working or not.
-        module.EndResetFunction();
-
-        // if the reset trigger drops to zero then it means it is time to reset this node, but only do this when signal transitions from 1 to 0
-        // Allocate global variable to hold the previous trigger value so we can detect the change in state.
-        auto lastSignal = module.Global<int>(compiler.GetGlobalName(*this, "lastSignal"), 0);
-        auto lastSignalValue = function.LocalScalar(function.Load(lastSignal));
-        auto resetTriggerValue = function.LocalScalar(function.CastValue<int>(function.Load(resetTrigger)));
-        function.If((resetTriggerValue == 0) && (lastSignalValue == 1), [resetFunctionName](emitters::IRFunctionEmitter& fn) {
-            fn.Call(resetFunctionName);
-        });
-        function.Store(lastSignal, resetTriggerValue);
+        emitters::IRLocalScalar h = hiddenState[unit];
+        hiddenState[unit] = n + z * (h - n);
     }
 
     // Explicit specialization
@@ -7,15 +7,52 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "LSTMNode.h"
+#include "ActivationFunctions.h"
+#include "ConstantNode.h"
 
 #include <math/include/MatrixOperations.h>
 
 #include <utilities/include/Exception.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
 {
+    namespace
+    {
+        // Returns a copy of a constant stack of gate weights or biases, with the rows reordered so the gates of each hidden
+        // unit are adjacent: row (unit * numGates + gate) of the result is row (gate * hiddenUnits + unit) of the stack.
+        // Returns an empty vector if the stack doesn't come from a constant node.
+        template <typename ValueType>
+        std::vector<ValueType> GetUnitInterleavedStack(const model::InputPort<ValueType>& stack, int numGates, int hiddenUnits)
+        {
+            if (stack.Size() == 0)
+            {
+                return {};
+            }
+            auto constantNode = dynamic_cast<const ConstantNode<ValueType>*>(stack.GetReferencedPort().GetNode());
+            if (constantNode == nullptr || constantNode->GetValues().size() != stack.Size())
+            {
+                return {};
+            }
+
+            const auto& values = constantNode->GetValues();
+            const size_t rowSize = values.size() / (numGates * hiddenUnits);
+            std::vector<ValueType> result(values.size());
+            for (int unit = 0; unit < hiddenUnits; ++unit)
+            {
+                for (int gate = 0; gate < numGates; ++gate)
+                {
+                    auto sourceRow = values.begin() + (gate * hiddenUnits + unit) * rowSize;
+                    std::copy(sourceRow, sourceRow + rowSize, result.begin() + (unit * numGates + gate) * rowSize);
+                }
+            }
+            return result;
+        }
+    } // namespace
+
     //
     // LSTMNode
     //
@@ -35,16 +72,25 @@ namespace nodes
                                   const model::OutputPort<ValueType>& hiddenBias,
                                   const ActivationType& activation,
                                   const ActivationType& recurrentActivation,
-                                  bool validateWeights) :
+                                  bool validateWeights,
+                                  size_t sequenceLength) :
         RNNNode<ValueType>(input, resetTrigger, hiddenUnits, inputWeights, hiddenWeights, inputBias, hiddenBias, activation, false),
         _recurrentActivation(recurrentActivation),
+        _sequenceLength(sequenceLength),
         _cellState(hiddenUnits)
     {
+        if (sequenceLength == 0 || input.Size() % sequenceLength != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument,
+                                            ell::utilities::FormatString("The LSTMNode input size %zu is not a multiple of the sequence length %zu", input.Size(), sequenceLength));
+        }
+        this->_output.SetSize(hiddenUnits * sequenceLength);
+
         if (validateWeights)
         {
             size_t stackHeight = 4; // LSTM has 4 stacked weights for (input, forget, cell, output).
             size_t numRows = stackHeight * hiddenUnits;
-            size_t numColumns = input.Size();
+            size_t numColumns = input.Size() / sequenceLength;
             if (inputWeights.Size() != numRows * numColumns)
             {
                 throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument,
@@ -81,12 +127,38 @@ namespace nodes
         const auto& newHiddenWeights = transformer.GetCorrespondingInputs(this->_hiddenWeights);
         const auto& newInputBias = transformer.GetCorrespondingInputs(this->_inputBias);
         const auto& newHiddenBias = transformer.GetCorrespondingInputs(this->_hiddenBias);
-        auto newNode = transformer.AddNode<LSTMNode>(newInput, newResetTrigger, this->_hiddenUnits, newInputWeights, newHiddenWeights, newInputBias, newHiddenBias, this->_activation, this->_recurrentActivation);
+        auto newNode = transformer.AddNode<LSTMNode>(newInput, newResetTrigger, this->_hiddenUnits, newInputWeights, newHiddenWeights, newInputBias, newHiddenBias, this->_activation, this->_recurrentActivation, true, _sequenceLength);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
     template <typename ValueType>
     void LSTMNode<ValueType>::Compute() const
+    {
+        // The input is a sequence of frames, and the output is the hidden state after each one
+        const size_t hiddenUnits = this->_hiddenUnits;
+        std::vector<ValueType> inputValue = this->_input.GetValue();
+        const size_t frameSize = inputValue.size() / _sequenceLength;
+        std::vector<ValueType> outputValue(hiddenUnits * _sequenceLength);
+        for (size_t frame = 0; frame < _sequenceLength; ++frame)
+        {
+            auto frameBegin = inputValue.begin() + frame * frameSize;
+            ComputeStep(VectorType(std::vector<ValueType>(frameBegin, frameBegin + frameSize)));
+
+            if (frame + 1 == _sequenceLength && this->ShouldReset())
+            {
+                const_cast<LSTMNode<ValueType>*>(this)->Reset();
+            }
+
+            auto hiddenState = this->_hiddenState.ToArray();
+            std::copy(hiddenState.begin(), hiddenState.end(), outputValue.begin() + frame * hiddenUnits);
+        }
+
+        // copy to output
+        this->_output.SetOutput(outputValue);
+    }
+
+    template <typename ValueType>
+    void LSTMNode<ValueType>::ComputeStep(const VectorType& inputVector) const
     {
         using ConstMatrixReferenceType = math::ConstRowMatrixReference<ValueType>;
 
@@ -100,7 +172,6 @@ namespace nodes
         */
         size_t hiddenUnits = this->_hiddenUnits;
         size_t stackHeight = 4; // LSTM has 4 stacked weights for (input, forget, cell, output).
-        VectorType inputVector(this->_input.GetValue());
         size_t numRows = stackHeight * hiddenUnits;
         size_t numColumns = inputVector.Size();
         std::vector<ValueType> inputWeightsValue = this->_inputWeights.GetValue();
@@ -168,14 +239,6 @@ namespace nodes
         temp.CopyFrom(this->_cellState);
         this->_activation.Apply(temp);
         ElementwiseMultiplySet(outputGate, temp, this->_hiddenState);
-
-        if (this->ShouldReset())
-        {
-            const_cast<LSTMNode<ValueType>*>(this)->Reset();
-        }
-
-        // copy to output
-        this->_output.SetOutput(this->_hiddenState.ToArray());
     }
 
     template <typename ValueType>
@@ -196,122 +259,142 @@ namespace nodes
         ct = ft * c + it * gt
         ht = ot * tanh(ct)
         */
+        const int stackHeight = 4; // LSTM has 4 stacked weights for (input, forget, cell, output).
+        CompileRecurrence(compiler, function, stackHeight, true, "LSTMNodeReset");
+    }
+
+    template <typename ValueType>
+    void LSTMNode<ValueType>::CompileHiddenUnitUpdate(emitters::IRFunctionEmitter& function,
+                                                      const std::vector<emitters::IRLocalScalar>& inputGates,
+                                                      const std::vector<emitters::IRLocalScalar>& hiddenGates,
+                                                      emitters::IRLocalArray hiddenState,
+                                                      emitters::IRLocalArray cellState,
+                                                      emitters::IRLocalScalar unit)
+    {
+        auto activation = GetNodeActivationFunction(this->_activation);
+        auto recurrentActivation = GetNodeActivationFunction(this->_recurrentActivation);
+
+        // the gates are (input, forget, cell, output)
+        auto it = function.LocalScalar(recurrentActivation->Compile(function, inputGates[0] + hiddenGates[0]));
+        auto ft = function.LocalScalar(recurrentActivation->Compile(function, inputGates[1] + hiddenGates[1]));
+        auto gt = function.LocalScalar(activation->Compile(function, inputGates[2] + hiddenGates[2]));
+        auto ot = function.LocalScalar(recurrentActivation->Compile(function, inputGates[3] + hiddenGates[3]));
+
+        // ct = ft * c + it * gt
+        emitters::IRLocalScalar prevCellState = cellState[unit];
+        auto newCellState = ft * prevCellState + it * gt;
+        cellState[unit] = newCellState;
+
+        // ht = ot * tanh(ct)
+        hiddenState[unit] = ot * function.LocalScalar(activation->Compile(function, newCellState));
+    }
+
+    template <typename ValueType>
+    void LSTMNode<ValueType>::CompileRecurrence(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int numGates, bool useCellState, const std::string& resetFunctionName)
+    {
         const int hiddenUnits = static_cast<int>(this->_hiddenUnits);
-        const int inputSize = static_cast<int>(this->input.Size());
-        size_t stackHeight = 4; // LSTM has 4 stacked weights for (input, forget, cell, output).
+        const int sequenceLength = static_cast<int>(_sequenceLength);
+        const int inputSize = static_cast<int>(this->input.Size()) / sequenceLength;
+        const int stackSize = numGates * hiddenUnits;
+        emitters::IRModuleEmitter& module = function.GetModule();
 
         // Get LLVM references for all node inputs
         auto input = compiler.EnsurePortEmitted(this->input);
         auto resetTrigger = compiler.EnsurePortEmitted(this->resetTrigger);
-        auto inputWeights = compiler.EnsurePortEmitted(this->inputWeights);
-        auto hiddenWeights = compiler.EnsurePortEmitted(this->hiddenWeights);
-        auto inputBias = compiler.EnsurePortEmitted(this->inputBias);
-        auto hiddenBias = compiler.EnsurePortEmitted(this->hiddenBias);
+
+        // If the weights and biases are constant, use copies with the gates of each hidden unit in adjacent rows, so the
+        // per-unit epilogue below reads one short contiguous run of each stack instead of `numGates` far-apart elements
+        auto packedInputWeights = GetUnitInterleavedStack(this->_inputWeights, numGates, hiddenUnits);
+        auto packedHiddenWeights = GetUnitInterleavedStack(this->_hiddenWeights, numGates, hiddenUnits);
+        auto packedInputBias = GetUnitInterleavedStack(this->_inputBias, numGates, hiddenUnits);
+        auto packedHiddenBias = GetUnitInterleavedStack(this->_hiddenBias, numGates, hiddenUnits);
+        const bool interleaved = !packedInputWeights.empty() && !packedHiddenWeights.empty() && !packedInputBias.empty() && !packedHiddenBias.empty();
+
+        emitters::LLVMValue inputWeights = nullptr;
+        emitters::LLVMValue hiddenWeights = nullptr;
+        emitters::LLVMValue inputBiasValue = nullptr;
+        emitters::LLVMValue hiddenBiasValue = nullptr;
+        if (interleaved)
+        {
+            inputWeights = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "packedInputWeights"), packedInputWeights), 0);
+            hiddenWeights = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "packedHiddenWeights"), packedHiddenWeights), 0);
+            inputBiasValue = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "packedInputBias"), packedInputBias), 0);
+            hiddenBiasValue = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "packedHiddenBias"), packedHiddenBias), 0);
+        }
+        else
+        {
+            inputWeights = compiler.EnsurePortEmitted(this->inputWeights);
+            hiddenWeights = compiler.EnsurePortEmitted(this->hiddenWeights);
+            inputBiasValue = compiler.EnsurePortEmitted(this->inputBias);
+            hiddenBiasValue = compiler.EnsurePortEmitted(this->hiddenBias);
+        }
+        auto inputBias = function.LocalArray(inputBiasValue);
+        auto hiddenBias = function.LocalArray(hiddenBiasValue);
 
         // Get LLVM reference for node output
-        auto output = function.LocalArray(compiler.EnsurePortEmitted(this->output));
+        auto output = compiler.EnsurePortEmitted(this->output);
 
-        // Allocate global buffer for hidden state
-        emitters::IRModuleEmitter& module = function.GetModule();
+        // Allocate global buffers for hidden state and cell state
         auto hiddenStateVariable = module.Variables().AddVectorVariable<ValueType>(emitters::VariableScope::global, hiddenUnits);
         auto hiddenStateValue = module.EnsureEmitted(*hiddenStateVariable);
-        auto hiddenStatePointer = function.PointerOffset(hiddenStateValue, 0); // convert "global variable" to a pointer
-        auto hiddenState = function.LocalArray(hiddenStatePointer);
-        auto& prevHiddenState = hiddenState;
-
-        // Allocate global buffer for cell state
-        auto cellStateVariable = module.Variables().AddVectorVariable<ValueType>(emitters::VariableScope::global, hiddenUnits);
-        auto cellStateValue = module.EnsureEmitted(*cellStateVariable);
-        auto cellStatePointer = function.PointerOffset(cellStateValue, 0); // convert "global variable" to a pointer
-        auto cellState = function.LocalArray(cellStatePointer);
-        auto& prevCellState = cellState;
-
-        // Allocate local variables
-        const size_t stackSize = hiddenUnits * stackHeight;
-        auto istack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto hstack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto inputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto forgetGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto cellGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto outputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-
-        auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
-        auto beta = static_cast<ValueType>(1.0); // GEMV scaling of the bias addition
-
-        // W_i * x + b_i, one matrix multiplication for all 4 gates (input, forget, cell, output)
-        function.MemoryCopy<ValueType>(inputBias, istack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, istack, 1);
-
-        // W_h * h + b_h
-        function.MemoryCopy<ValueType>(hiddenBias, hstack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, prevHiddenState, 1, beta, hstack, 1);
-
-        // the weights are stacked in 4 slices for (input, forget, cell, output).
-        auto istack_slice0 = istack;
-        auto istack_slice1 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits)));
-        auto istack_slice2 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 2)));
-        auto istack_slice3 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 3)));
-
-        auto hstack_slice0 = hstack;
-        auto hstack_slice1 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits)));
-        auto hstack_slice2 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 2)));
-        auto hstack_slice3 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 3)));
-
-        // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            inputGate[i] = istack_slice0[i] + hstack_slice0[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, inputGate, hiddenUnits);
-
-        // forget_gate = sigma(W_{if} x + b_{if} + W_{hf} h + b_{hf})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            forgetGate[i] = istack_slice1[i] + hstack_slice1[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, forgetGate, hiddenUnits);
+        auto hiddenState = function.LocalArray(function.PointerOffset(hiddenStateValue, 0)); // convert "global variable" to a pointer
 
-        // cell_gate = tanh(W_{ig} x + b_{ig} + W_{hg} h + b_{hg})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            cellGate[i] = istack_slice2[i] + hstack_slice2[i];
-        });
-        this->ApplyActivation(function, this->_activation, cellGate, hiddenUnits);
-
-        // output_gate = sigma(W_{io} x + b_{io} + W_{ho} h + b_{ho})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            outputGate[i] = istack_slice3[i] + hstack_slice3[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, outputGate, hiddenUnits);
-
-        // cellState = forget_gate * cellState + input_gate * cell_gate
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto ft = forgetGate[i];
-            auto ct = prevCellState[i];
-            auto it = inputGate[i];
-            auto gt = cellGate[i];
-            auto newValue = ft * ct + it * gt;
-            cellState[i] = newValue;
-        });
+        emitters::LLVMValue cellStateValue = nullptr;
+        if (useCellState)
+        {
+            auto cellStateVariable = module.Variables().AddVectorVariable<ValueType>(emitters::VariableScope::global, hiddenUnits);
+            cellStateValue = module.EnsureEmitted(*cellStateVariable);
+        }
+        auto cellState = useCellState ? function.LocalArray(function.PointerOffset(cellStateValue, 0)) : hiddenState;
 
-        // newHiddenState = output_gate * tanh(ct), we'll reuse inputGate local variable to compile tanh(ct)
-        function.MemoryCopy<ValueType>(cellState, inputGate, hiddenUnits);
-        this->ApplyActivation(function, this->_activation, inputGate, hiddenUnits);
+        // W_i * x for all the gates and all the frames: one matrix multiplication for a single frame, or one
+        // matrix-matrix multiplication for a sequence. The biases are added in the epilogue.
+        auto istack = function.Variable(emitters::GetVariableType<ValueType>(), stackSize * sequenceLength);
+        auto hstack = function.Variable(emitters::GetVariableType<ValueType>(), stackSize);
+        auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
+        auto beta = static_cast<ValueType>(0.0); // GEMV scaling of the previous output
+        if (sequenceLength == 1)
+        {
+            function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, istack, 1);
+        }
+        else
+        {
+            function.CallGEMM<ValueType>(false, true, sequenceLength, stackSize, inputSize, input, inputSize, inputWeights, inputSize, istack, stackSize);
+        }
 
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto tan_ct = inputGate[i];
-            auto ot = outputGate[i];
-            auto newValue = ot * tan_ct;
-            hiddenState[i] = newValue;
+        function.For(sequenceLength, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar frame) {
+            // W_h * h, the only matrix multiplication that has to wait for the previous frame
+            fn.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, hiddenState, 1, beta, hstack, 1);
+
+            // Add the biases, apply the gate activations and update the state, one hidden unit at a time
+            auto frameInputStack = fn.LocalArray(fn.PointerOffset(istack, frame * stackSize));
+            auto hiddenStack = fn.LocalArray(hstack);
+            fn.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar unit) {
+                std::vector<emitters::IRLocalScalar> inputGates;
+                std::vector<emitters::IRLocalScalar> hiddenGates;
+                for (int gate = 0; gate < numGates; ++gate)
+                {
+                    auto index = interleaved ? unit * numGates + gate : gate * hiddenUnits + unit;
+                    inputGates.push_back(frameInputStack[index] + inputBias[index]);
+                    hiddenGates.push_back(hiddenStack[index] + hiddenBias[index]);
+                }
+                this->CompileHiddenUnitUpdate(fn, inputGates, hiddenGates, hiddenState, cellState, unit);
+            });
+
+            // Copy hidden state to the output.
+            fn.MemoryCopy<ValueType>(hiddenState, fn.Literal<int>(0), output, frame * hiddenUnits, fn.Literal<int>(hiddenUnits));
         });
 
-        // Copy hidden state to the output.
-        function.MemoryCopy<ValueType>(hiddenState, output, hiddenUnits);
-
         // Add the internal reset function
-        std::string resetFunctionName = compiler.GetGlobalName(*this, "LSTMNodeReset");
-        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        std::string resetFunctionGlobalName = compiler.GetGlobalName(*this, resetFunctionName);
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionGlobalName);
         auto resetHiddenState = resetFunction.LocalArray(hiddenStateValue);
-        auto resetCellState = resetFunction.LocalArray(cellStateValue);
         resetFunction.MemorySet<ValueType>(resetHiddenState, 0, function.Literal<uint8_t>(0), hiddenUnits);
-        resetFunction.MemorySet<ValueType>(resetCellState, 0, function.Literal<uint8_t>(0), hiddenUnits);
+        if (useCellState)
+        {
+            auto resetCellState = resetFunction.LocalArray(cellStateValue);
+            resetFunction.MemorySet<ValueType>(resetCellState, 0, function.Literal<uint8_t>(0), hiddenUnits);
+        }
         // resetFunction.Print("### LSTM Node was reset\n"); // this is a handy way to debug whether the VAD node is working or not.
         module.EndResetFunction();
 
@@ -320,8 +403,8 @@ namespace nodes
         auto lastSignal = module.Global<int>(compiler.GetGlobalName(*this, "lastSignal"), 0);
         auto lastSignalValue = function.LocalScalar(function.Load(lastSignal));
         auto resetTriggerValue = function.LocalScalar(function.CastValue<int>(function.Load(resetTrigger)));
-        function.If((resetTriggerValue == 0) && (lastSignalValue == 1), [resetFunctionName](emitters::IRFunctionEmitter& fn) {
-            fn.Call(resetFunctionName);
+        function.If((resetTriggerValue == 0) && (lastSignalValue == 1), [resetFunctionGlobalName](emitters::IRFunctionEmitter& fn) {
+            fn.Call(resetFunctionGlobalName);
         });
         function.Store(lastSignal, resetTriggerValue);
     }
@@ -331,6 +414,7 @@ namespace nodes
     {
         RNNNode<ValueType>::WriteToArchive(archiver);
         _recurrentActivation.WriteToArchive(archiver);
+        archiver["sequenceLength"] << _sequenceLength;
     }
 
     template <typename ValueType>
@@ -338,8 +422,10 @@ namespace nodes
     {
         RNNNode<ValueType>::ReadFromArchive(archiver);
         _recurrentActivation.ReadFromArchive(archiver);
+        archiver.OptionalProperty("sequenceLength", size_t{ 1 }) >> _sequenceLength;
 
         this->_cellState.Resize(this->_hiddenUnits);
+        this->_output.SetSize(this->_hiddenUnits * _sequenceLength);
     }
 
     // Explicit specialization
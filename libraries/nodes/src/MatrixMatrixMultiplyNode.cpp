@@ -22,6 +22,14 @@ namespace nodes
         //
         constexpr utilities::ArchiveVersion currentArchiveVersion = { utilities::ArchiveVersionNumbers::v2 };
 
+        // When there is an epilogue and the product comes from BLAS, it is computed in panels of columns about this
+        // size, so that the epilogue reads each panel back while it is still in the L2 cache. Bare-metal targets have
+        // little or no cache, so their panels are kept small.
+        int GetEpiloguePanelBytes(const emitters::TargetDevice& targetDevice)
+        {
+            return targetDevice.IsBareMetal() ? 16 * 1024 : 128 * 1024;
+        }
+
         template <typename ValueType>
         void MatrixMatrixMultiply(bool transposeA, bool transposeB, bool transposeC, int m, int n, int k, const std::vector<ValueType>& matrixAValues, const std::vector<ValueType>& matrixBValues, std::vector<ValueType>& matrixCValues)
         {
@@ -173,7 +181,7 @@ namespace nodes
     }
 
     template <typename ValueType>
-    MatrixMatrixMultiplyNode<ValueType>::MatrixMatrixMultiplyNode(const model::OutputPort<ValueType>& input1, int m, int n, int k, int matrix1Stride, bool transpose1, const model::OutputPort<ValueType>& input2, int matrix2Stride, bool transpose2, int outputMatrixStride, bool transposeOutput) :
+    MatrixMatrixMultiplyNode<ValueType>::MatrixMatrixMultiplyNode(const model::OutputPort<ValueType>& input1, int m, int n, int k, int matrix1Stride, bool transpose1, const model::OutputPort<ValueType>& input2, int matrix2Stride, bool transpose2, int outputMatrixStride, bool transposeOutput, const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input1, &_input2 }, { &_output }),
         _input1(this, input1, defaultInput1PortName),
         _input2(this, input2, defaultInput2PortName),
@@ -186,7 +194,8 @@ namespace nodes
         _ldc(outputMatrixStride),
         _transpose1(transpose1),
         _transpose2(transpose2),
-        _transposeOutput(transposeOutput)
+        _transposeOutput(transposeOutput),
+        _epilogue(epilogue)
     {
         // TODO: reset output layout (incl. transpose info)
         if (static_cast<int>(input1.Size()) != m * k)
@@ -219,6 +228,18 @@ namespace nodes
 
         MatrixMatrixMultiply(_transpose1, _transpose2, _transposeOutput, (int)_m, (int)_n, (int)_k, inputMatrix1Values, inputMatrix2Values, outputMatrixValues);
 
+        if (!_epilogue.IsEmpty())
+        {
+            for (int j = 0; j < _n; ++j)
+            {
+                for (int i = 0; i < _m; ++i)
+                {
+                    auto& value = outputMatrixValues[_transposeOutput ? (j * _m) + i : (i * _n) + j];
+                    value = _epilogue.Compute(value, i, (j * _m) + i);
+                }
+            }
+        }
+
         _output.SetOutput(outputMatrixValues);
     };
 
@@ -227,7 +248,7 @@ namespace nodes
     {
         const auto& PortElements1 = transformer.GetCorrespondingInputs(_input1);
         const auto& PortElements2 = transformer.GetCorrespondingInputs(_input2);
-        auto newNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(PortElements1, _m, _n, _k, _lda, _transpose1, PortElements2, _ldb, _transpose2, _ldc, _transposeOutput);
+        auto newNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(PortElements1, _m, _n, _k, _lda, _transpose1, PortElements2, _ldb, _transpose2, _ldc, _transposeOutput, _epilogue);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
@@ -238,13 +259,111 @@ namespace nodes
         emitters::LLVMValue pInput2 = compiler.EnsurePortEmitted(input2);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
 
+        if (_epilogue.IsEmpty())
+        {
+            CompileGEMM(function, pInput1, pInput2, pOutput, _n);
+            return;
+        }
+
+        // The native GEMM applies the epilogue itself, as it stores each tile of the product
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        if (!function.GetCompilerOptions().useBlas)
+        {
+            CompileEpiloguePanel(function, epilogue, pInput1, pInput2, pOutput, function.LocalScalar<int>(0), _n);
+            return;
+        }
+
+        // Otherwise, compute the product in panels of columns, applying the epilogue to each panel right after it's computed
+        const int epiloguePanelBytes = GetEpiloguePanelBytes(function.GetCompilerOptions().targetDevice);
+        const int panelColumns = std::min(_n, std::max(1, epiloguePanelBytes / static_cast<int>(sizeof(ValueType) * _m)));
+        const int numFullPanels = _n / panelColumns;
+        const int remainderColumns = _n % panelColumns;
+        if (numFullPanels > 1)
+        {
+            function.For(numFullPanels, [this, pInput1, pInput2, pOutput, panelColumns, epilogue](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar panelIndex) {
+                CompileEpiloguePanel(function, epilogue, pInput1, pInput2, pOutput, panelIndex * panelColumns, panelColumns);
+            });
+        }
+        else
+        {
+            CompileEpiloguePanel(function, epilogue, pInput1, pInput2, pOutput, function.LocalScalar<int>(0), panelColumns);
+        }
+
+        if (remainderColumns > 0)
+        {
+            CompileEpiloguePanel(function, epilogue, pInput1, pInput2, pOutput, function.LocalScalar<int>(numFullPanels * panelColumns), remainderColumns);
+        }
+    }
+
+    template <typename ValueType>
+    void MatrixMatrixMultiplyNode<ValueType>::CompileGEMM(emitters::IRFunctionEmitter& function, emitters::LLVMValue pInput1, emitters::LLVMValue pInput2, emitters::LLVMValue pOutput, int n)
+    {
         if (_transposeOutput)
         {
-            function.CallGEMM<ValueType>(!_transpose2, !_transpose1, (int)_n, (int)_m, (int)_k, pInput2, (int)_ldb, pInput1, (int)_lda, pOutput, (int)_ldc);
+            function.CallGEMM<ValueType>(!_transpose2, !_transpose1, n, (int)_m, (int)_k, pInput2, (int)_ldb, pInput1, (int)_lda, pOutput, (int)_ldc);
+        }
+        else
+        {
+            function.CallGEMM<ValueType>(_transpose1, _transpose2, (int)_m, n, (int)_k, pInput1, (int)_lda, pInput2, (int)_ldb, pOutput, (int)_ldc);
+        }
+    }
+
+    template <typename ValueType>
+    void MatrixMatrixMultiplyNode<ValueType>::CompileEpiloguePanel(emitters::IRFunctionEmitter& function, const FusedEpilogueEmitter<ValueType>& epilogue, emitters::LLVMValue pInput1, emitters::LLVMValue pInput2, emitters::LLVMValue pOutput, emitters::IRLocalScalar panelBegin, int panelColumns)
+    {
+        // Column j of op(B) and of C start at row j of their memory if they're transposed, else at column j
+        auto input2Panel = function.PointerOffset(pInput2, _transpose2 ? panelBegin * _ldb : panelBegin);
+        auto outputPanel = function.PointerOffset(pOutput, _transposeOutput ? panelBegin * _ldc : panelBegin);
+
+        // The epilogue's channels are the rows of the product, and its entries are numbered column by column
+        const int m = _m;
+        const int ldc = _ldc;
+        const bool transposeOutput = _transposeOutput;
+        if (!function.GetCompilerOptions().useBlas)
+        {
+            // The GEMM's rows are the product's columns if the output is transposed
+            emitters::GEMMEpilogueFunction applyEpilogue = [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar value, emitters::IRLocalScalar row, emitters::IRLocalScalar column) {
+                auto i = transposeOutput ? column : row;
+                auto j = transposeOutput ? row : column;
+                return epilogue.Compile(value, i, ((panelBegin + j) * m) + i);
+            };
+
+            auto& runtime = function.GetModule().GetRuntime();
+            if (_transposeOutput)
+            {
+                runtime.EmitGEMM<ValueType>(function, !_transpose2, !_transpose1, panelColumns, (int)_m, (int)_k, input2Panel, (int)_ldb, pInput1, (int)_lda, outputPanel, (int)_ldc, applyEpilogue);
+            }
+            else
+            {
+                runtime.EmitGEMM<ValueType>(function, _transpose1, _transpose2, (int)_m, panelColumns, (int)_k, pInput1, (int)_lda, input2Panel, (int)_ldb, outputPanel, (int)_ldc, applyEpilogue);
+            }
+            return;
+        }
+
+        CompileGEMM(function, pInput1, input2Panel, outputPanel, panelColumns);
+
+        // Visit the panel in memory order: each column of the product is contiguous if the output is transposed, else each row is
+        auto outputArray = function.LocalArray(outputPanel);
+        auto applyEpilogue = [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar i, emitters::IRLocalScalar j) {
+            auto offset = transposeOutput ? (j * ldc) + i : (i * ldc) + j;
+            emitters::IRLocalScalar value = outputArray[offset];
+            outputArray[offset] = epilogue.Compile(value, i, ((panelBegin + j) * m) + i);
+        };
+        if (transposeOutput)
+        {
+            function.For(panelColumns, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar j) {
+                function.For(m, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar i) {
+                    applyEpilogue(function, i, j);
+                });
+            });
         }
         else
         {
-            function.CallGEMM<ValueType>(_transpose1, _transpose2, (int)_m, (int)_n, (int)_k, pInput1, (int)_lda, pInput2, (int)_ldb, pOutput, (int)_ldc);
+            function.For(m, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar i) {
+                function.For(panelColumns, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar j) {
+                    applyEpilogue(function, i, j);
+                });
+            });
         }
     }
 
@@ -276,6 +395,7 @@ namespace nodes
         archiver["transpose1"] << _transpose1;
         archiver["transpose2"] << _transpose2;
         archiver["transposeOutput"] << _transposeOutput;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -295,6 +415,7 @@ namespace nodes
         archiver["transpose1"] >> _transpose1;
         archiver["transpose2"] >> _transpose2;
         archiver.OptionalProperty("transposeOutput", false) >> _transposeOutput;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicitly instantiate versions
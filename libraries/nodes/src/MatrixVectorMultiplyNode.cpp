@@ -29,7 +29,7 @@ namespace nodes
     }
 
     template <typename ValueType>
-    MatrixVectorMultiplyNode<ValueType>::MatrixVectorMultiplyNode(const model::OutputPort<ValueType>& inputMatrix, size_t m, size_t n, size_t matrixStride, const model::OutputPort<ValueType>& inputVector) :
+    MatrixVectorMultiplyNode<ValueType>::MatrixVectorMultiplyNode(const model::OutputPort<ValueType>& inputMatrix, size_t m, size_t n, size_t matrixStride, const model::OutputPort<ValueType>& inputVector, const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_inputMatrix, &_inputVector }, { &_output }),
         _inputMatrix(this, inputMatrix, inputMatrixPortName),
         _inputVector(this, inputVector, inputVectorPortName),
@@ -37,7 +37,8 @@ namespace nodes
         _m(m),
         _n(n),
         _lda(matrixStride),
-        _incx(1)
+        _incx(1),
+        _epilogue(epilogue)
     {
         if (inputMatrix.Size() != m * n)
         {
@@ -65,6 +66,16 @@ namespace nodes
 
         math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), inputMatrixRef, inputVectorRef, static_cast<ValueType>(0.0), outputVectorRef);
 
+        if (!_epilogue.IsEmpty())
+        {
+            const int numBiasChannels = static_cast<int>(_epilogue.bias.size());
+            for (int index = 0; index < static_cast<int>(_m); ++index)
+            {
+                auto channel = numBiasChannels > 1 ? index % numBiasChannels : 0;
+                outputVectorValues[index] = _epilogue.Compute(outputVectorValues[index], channel, index);
+            }
+        }
+
         _output.SetOutput(outputVectorValues);
     };
 
@@ -73,7 +84,7 @@ namespace nodes
     {
         const auto& matrixElements = transformer.GetCorrespondingInputs(_inputMatrix);
         const auto& vectorElements = transformer.GetCorrespondingInputs(_inputVector);
-        auto newNode = transformer.AddNode<MatrixVectorMultiplyNode<ValueType>>(matrixElements, _m, _n, _lda, vectorElements);
+        auto newNode = transformer.AddNode<MatrixVectorMultiplyNode<ValueType>>(matrixElements, _m, _n, _lda, vectorElements, _epilogue);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
@@ -85,6 +96,37 @@ namespace nodes
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
 
         function.CallGEMV<ValueType>((int)_m, (int)_n, pInputMatrix, (int)_lda, pInputVector, _incx, pOutput, 1);
+
+        // Apply the bias and activation while the output vector is still in the cache
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        epilogue.CompileEntries(function, pOutput, function.LocalScalar<int>(0), (int)_m);
+    }
+
+    template <typename ValueType>
+    bool MatrixVectorMultiplyNode<ValueType>::CanCompileBatch(model::IRMapCompiler& compiler) const
+    {
+        return _incx == 1 && compiler.IsBatchPortShared(inputMatrix) && !compiler.IsBatchPortShared(inputVector);
+    }
+
+    template <typename ValueType>
+    void MatrixVectorMultiplyNode<ValueType>::CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        emitters::LLVMValue pInputMatrix = compiler.GetBatchPortValues(inputMatrix);
+        emitters::LLVMValue pInputVectors = compiler.GetBatchPortValues(inputVector);
+        emitters::LLVMValue pOutputs = compiler.GetBatchPortValues(output);
+
+        // The samples' vectors are the rows of a (batchSize x n) matrix, so the whole batch is one GEMM with the transposed matrix
+        const int inputStride = static_cast<int>(inputVector.Size());
+        const int outputStride = static_cast<int>(output.Size());
+        function.CallGEMM<ValueType>(false, true, batchSize, (int)_m, (int)_n, pInputVectors, inputStride, pInputMatrix, (int)_lda, pOutputs, outputStride);
+
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        if (!epilogue.IsEmpty())
+        {
+            function.For(batchSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar sample) {
+                epilogue.CompileEntries(function, function.PointerOffset(pOutputs, sample * outputStride), function.LocalScalar<int>(0), (int)_m);
+            });
+        }
     }
 
     template <typename ValueType>
@@ -98,6 +140,7 @@ namespace nodes
         archiver["n"] << _n;
         archiver["lda"] << _lda;
         archiver["incx"] << _incx;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -111,6 +154,7 @@ namespace nodes
         archiver["n"] >> _n;
         archiver["lda"] >> _lda;
         archiver["incx"] >> _incx;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicitly instantiate versions
@@ -8,19 +8,16 @@
 
 #include "ProtoNNPredictorNode.h"
 
-#include "BinaryOperationNode.h"
-#include "ConstantNode.h"
-#include "ExtremalValueNode.h"
-#include "L2NormSquaredNode.h"
 #include "MatrixVectorProductNode.h"
-#include "SquaredEuclideanDistanceNode.h"
-#include "UnaryOperationNode.h"
 
-#include <utilities/include/Exception.h>
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IRVectorUtilities.h>
 
-#include <data/include/DenseDataVector.h>
+#include <utilities/include/Exception.h>
 
-#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -28,14 +25,30 @@ namespace ell
 {
 namespace nodes
 {
-    ProtoNNPredictorNode::ProtoNNPredictorNode() :
+    namespace
+    {
+        // Below this many prototypes per task, the cost of starting the tasks outweighs the work
+        const int minPrototypesPerTask = 256;
+
+        int CeilDiv(int a, int b)
+        {
+            return (a - 1) / b + 1;
+        }
+    } // namespace
+
+    //
+    // ProtoNNPredictorNode
+    //
+    template <typename ElementType>
+    ProtoNNPredictorNode<ElementType>::ProtoNNPredictorNode() :
         Node({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0)
     {
     }
 
-    ProtoNNPredictorNode::ProtoNNPredictorNode(const model::OutputPort<double>& input, const predictors::ProtoNNPredictor& predictor) :
+    template <typename ElementType>
+    ProtoNNPredictorNode<ElementType>::ProtoNNPredictorNode(const model::OutputPort<ElementType>& input, const ProtoNNPredictor& predictor) :
         Node({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, predictor.GetNumLabels()),
@@ -47,7 +60,8 @@ namespace nodes
         }
     }
 
-    void ProtoNNPredictorNode::WriteToArchive(utilities::Archiver& archiver) const
+    template <typename ElementType>
+    void ProtoNNPredictorNode<ElementType>::WriteToArchive(utilities::Archiver& archiver) const
     {
         Node::WriteToArchive(archiver);
         archiver[defaultInputPortName] << _input;
@@ -55,7 +69,8 @@ namespace nodes
         archiver["predictor"] << _predictor;
     }
 
-    void ProtoNNPredictorNode::ReadFromArchive(utilities::Unarchiver& archiver)
+    template <typename ElementType>
+    void ProtoNNPredictorNode<ElementType>::ReadFromArchive(utilities::Unarchiver& archiver)
     {
         Node::ReadFromArchive(archiver);
         archiver[defaultInputPortName] >> _input;
@@ -63,57 +78,305 @@ namespace nodes
         archiver["predictor"] >> _predictor;
     }
 
-    void ProtoNNPredictorNode::Copy(model::ModelTransformer& transformer) const
+    template <typename ElementType>
+    void ProtoNNPredictorNode<ElementType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newPortElements = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<ProtoNNPredictorNode>(newPortElements, _predictor);
+        auto newNode = transformer.AddNode<ProtoNNPredictorNode<ElementType>>(newPortElements, _predictor);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
-    bool ProtoNNPredictorNode::Refine(model::ModelTransformer& transformer) const
+    template <typename ElementType>
+    bool ProtoNNPredictorNode<ElementType>::Refine(model::ModelTransformer& transformer) const
     {
         const auto& newPortElements = transformer.GetCorrespondingInputs(_input);
 
         // Projection
         auto projectionMatrix = _predictor.GetProjectionMatrix();
-        auto projecedInputNode = transformer.AddNode<MatrixVectorProductNode<double, math::MatrixLayout::columnMajor>>(newPortElements, projectionMatrix);
+        auto projecedInputNode = transformer.AddNode<MatrixVectorProductNode<ElementType, math::MatrixLayout::columnMajor>>(newPortElements, projectionMatrix);
 
-        auto prototypes = _predictor.GetPrototypes();
-        auto m = _predictor.GetNumPrototypes();
+        // Similarity to each prototype, weighted by its label embeddings
+        auto labelScoresNode = transformer.AddNode<ProtoNNLabelScoresNode<ElementType>>(projecedInputNode->output, _predictor.GetPrototypes(), _predictor.GetLabelEmbeddings(), _predictor.GetGamma());
 
-        std::vector<double> multiplier(m, _predictor.GetGamma() * _predictor.GetGamma() * -1);
-        const auto& gamma = AppendConstant(transformer, multiplier);
+        transformer.MapNodeOutput(output, labelScoresNode->output);
 
-        // Distance to each prototype
-        math::RowMatrixReference<double> prototypesMatrix = prototypes.Transpose();
-        auto squareDistanceNode = transformer.AddNode<SquaredEuclideanDistanceNode<double, math::MatrixLayout::rowMajor>>(projecedInputNode->output, prototypesMatrix);
+        return true;
+    }
 
-        // Similarity to each prototype
-        const auto& scaledDistance = AppendBinaryOperation(squareDistanceNode->output, gamma, BinaryOperationType::multiply);
-        const auto& expDistance = AppendUnaryOperation(scaledDistance, UnaryOperationType::exp);
+    template <typename ElementType>
+    void ProtoNNPredictorNode<ElementType>::Compute() const
+    {
+        auto prediction = _predictor.Predict(_input.GetValue());
 
-        // Get the prediction label
-        auto labelScoresNode = transformer.AddNode<MatrixVectorProductNode<double, math::MatrixLayout::columnMajor>>(expDistance, _predictor.GetLabelEmbeddings());
+        _output.SetOutput(prediction.ToArray());
+    }
 
-        transformer.MapNodeOutput(output, labelScoresNode->output);
+    //
+    // ProtoNNLabelScoresNode
+    //
+    template <typename ElementType>
+    ProtoNNLabelScoresNode<ElementType>::ProtoNNLabelScoresNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _prototypes(0, 0),
+        _labelEmbeddings(0, 0)
+    {
+    }
 
-        return true;
+    template <typename ElementType>
+    ProtoNNLabelScoresNode<ElementType>::ProtoNNLabelScoresNode(const model::OutputPort<ElementType>& input, const math::ColumnMatrix<ElementType>& prototypes, const math::ColumnMatrix<ElementType>& labelEmbeddings, ElementType gamma) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, labelEmbeddings.NumRows()),
+        _prototypes(prototypes),
+        _labelEmbeddings(labelEmbeddings),
+        _gamma(gamma)
+    {
+        if (input.Size() != prototypes.NumRows())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "ProtoNNLabelScoresNode: input size must match the prototype dimension");
+        }
+        if (prototypes.NumColumns() != labelEmbeddings.NumColumns())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "ProtoNNLabelScoresNode: the label embeddings must have one column per prototype");
+        }
     }
 
-    void ProtoNNPredictorNode::Compute() const
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::Compute() const
     {
-        auto data = _input.GetValue();
-        std::vector<double> inputData;
-        inputData.reserve(data.size());
-        std::transform(data.begin(), data.end(), std::back_inserter(inputData), [](auto x) { return static_cast<double>(x); });
-        auto prediction = _predictor.Predict(inputData);
+        const auto input = _input.GetValue();
+        const auto dimension = _prototypes.NumRows();
+        const auto numPrototypes = _prototypes.NumColumns();
+        const auto numLabels = _labelEmbeddings.NumRows();
+        const auto multiplier = -_gamma * _gamma;
 
-        _output.SetOutput(prediction.ToArray());
+        std::vector<ElementType> scores(numLabels, 0);
+        for (size_t prototype = 0; prototype < numPrototypes; ++prototype)
+        {
+            ElementType distance = 0;
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                const auto difference = _prototypes(k, prototype) - input[k];
+                distance += difference * difference;
+            }
+
+            const auto similarity = std::exp(distance * multiplier);
+            for (size_t label = 0; label < numLabels; ++label)
+            {
+                scores[label] += _labelEmbeddings(label, prototype) * similarity;
+            }
+        }
+        _output.SetOutput(scores);
     }
 
-    ProtoNNPredictorNode* AddNodeToModelTransformer(const model::PortElements<double>& input, const predictors::ProtoNNPredictor& predictor, model::ModelTransformer& transformer)
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
-        return transformer.AddNode<ProtoNNPredictorNode>(input, predictor);
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        auto& module = function.GetModule();
+        emitters::LLVMValue pPrototypes = function.PointerOffset(module.ConstantArray(GetInternalStateIdentifier() + "_prototypes", _prototypes.ToArray()), 0);
+        emitters::LLVMValue pLabelEmbeddings = function.PointerOffset(module.ConstantArray(GetInternalStateIdentifier() + "_labelEmbeddings", _labelEmbeddings.ToArray()), 0);
+
+        const auto& compilerSettings = function.GetCompilerOptions();
+        const int numPrototypes = static_cast<int>(_prototypes.NumColumns());
+        const int numLabels = static_cast<int>(_labelEmbeddings.NumRows());
+        const int blockSize = compilerSettings.allowVectorInstructions ? compilerSettings.vectorWidth : 1;
+        const int numBlocks = numPrototypes / blockSize;
+
+        function.For(numLabels, [pOutput](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar label) {
+            function.SetValueAt(pOutput, label, function.Literal<ElementType>(0));
+        });
+
+        // The tasks split the blocks of prototypes, and each one adds up its scores in its own part of a scratch buffer
+        const int numDesiredTasks = compilerSettings.parallelize ? std::min(compilerSettings.maxThreads, numBlocks * blockSize / minPrototypesPerTask) : 1;
+        const int taskSize = CeilDiv(numBlocks, std::max(numDesiredTasks, 1));
+        const int numTasks = numBlocks > 0 ? CeilDiv(numBlocks, taskSize) : 0;
+        if (numTasks > 1)
+        {
+            auto pPartialScores = function.Variable(emitters::GetVariableType<ElementType>(), numTasks * numLabels);
+            auto taskFunction = GetTaskFunction(compiler, function, { pInput, pPrototypes, pLabelEmbeddings, pPartialScores }, blockSize);
+            std::vector<std::vector<emitters::LLVMValue>> taskArgs;
+            for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+            {
+                auto start = taskIndex * taskSize;
+                auto end = std::min((taskIndex + 1) * taskSize, numBlocks);
+                std::vector<emitters::LLVMValue> args = { pInput, pPrototypes, pLabelEmbeddings, function.PointerOffset(pPartialScores, taskIndex * numLabels), function.Literal<int32_t>(start), function.Literal<int32_t>(end) };
+                taskArgs.push_back(args);
+            }
+            auto tasks = function.StartTasks(taskFunction, taskArgs);
+            tasks.WaitAll(function);
+
+            function.For(numLabels, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar label) {
+                auto sum = function.LocalScalar(function.ValueAt(pPartialScores, label));
+                for (int taskIndex = 1; taskIndex < numTasks; ++taskIndex)
+                {
+                    sum = sum + function.ValueAt(pPartialScores, label + (taskIndex * numLabels));
+                }
+                function.SetValueAt(pOutput, label, sum);
+            });
+        }
+        else if (numBlocks > 0)
+        {
+            EmitPrototypeBlocks(function, pInput, pPrototypes, pLabelEmbeddings, pOutput, function.Literal<int32_t>(0), function.Literal<int32_t>(numBlocks), blockSize, 0);
+        }
+
+        // The prototypes past the last full block are done one at a time
+        const int firstRemainingPrototype = numBlocks * blockSize;
+        if (firstRemainingPrototype < numPrototypes)
+        {
+            EmitPrototypeBlocks(function, pInput, pPrototypes, pLabelEmbeddings, pOutput, function.Literal<int32_t>(0), function.Literal<int32_t>(numPrototypes - firstRemainingPrototype), 1, firstRemainingPrototype);
+        }
+    }
+
+    template <typename ElementType>
+    emitters::IRFunctionEmitter ProtoNNLabelScoresNode<ElementType>::GetTaskFunction(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& arguments, int blockSize)
+    {
+        auto& module = function.GetModule();
+        auto voidType = llvm::Type::getVoidTy(module.GetLLVMContext());
+
+        // The arguments are the input, prototypes, label embeddings and scores, followed by the range of blocks for the task
+        auto taskArguments = arguments;
+        taskArguments.push_back(function.Literal<int32_t>(0));
+        taskArguments.push_back(function.Literal<int32_t>(0));
+        auto argTypes = emitters::GetLLVMTypes(taskArguments);
+        emitters::IRFunctionEmitter taskFunction = module.BeginFunction(utilities::to_string(GetId()) + "_task", voidType, argTypes);
+        std::vector<size_t> indices(arguments.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        taskFunction.SetAttributeForArguments(indices, emitters::IRFunctionEmitter::Attributes::NoAlias);
+
+        {
+            auto taskArgument = taskFunction.Arguments().begin();
+            auto pInput = &(*taskArgument++);
+            auto pPrototypes = &(*taskArgument++);
+            auto pLabelEmbeddings = &(*taskArgument++);
+            auto pScores = &(*taskArgument++);
+            auto blockStartVal = &(*taskArgument++);
+            auto blockEndVal = &(*taskArgument++);
+
+            const int numLabels = static_cast<int>(_labelEmbeddings.NumRows());
+            taskFunction.For(numLabels, [pScores](emitters::IRFunctionEmitter& taskFunction, emitters::IRLocalScalar label) {
+                taskFunction.SetValueAt(pScores, label, taskFunction.Literal<ElementType>(0));
+            });
+            EmitPrototypeBlocks(taskFunction, pInput, pPrototypes, pLabelEmbeddings, pScores, blockStartVal, blockEndVal, blockSize, 0);
+            taskFunction.Return();
+        }
+        module.EndFunction();
+        return taskFunction;
+    }
+
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::EmitPrototypeBlocks(emitters::IRFunctionEmitter& function,
+                                                                  emitters::LLVMValue pInput,
+                                                                  emitters::LLVMValue pPrototypes,
+                                                                  emitters::LLVMValue pLabelEmbeddings,
+                                                                  emitters::LLVMValue pScores,
+                                                                  emitters::LLVMValue beginBlock,
+                                                                  emitters::LLVMValue endBlock,
+                                                                  int blockSize,
+                                                                  int firstPrototype)
+    {
+        auto& emitter = function.GetEmitter();
+        auto& builder = emitter.GetIRBuilder();
+        const int dimension = static_cast<int>(_prototypes.NumRows());
+        const int numPrototypes = static_cast<int>(_prototypes.NumColumns());
+        const int numLabels = static_cast<int>(_labelEmbeddings.NumRows());
+
+        // A block holds one entry for each of `blockSize` adjacent prototypes
+        auto elementType = emitter.Type(emitters::GetVariableType<ElementType>());
+        emitters::LLVMType blockType = blockSize > 1 ? static_cast<emitters::LLVMType>(emitter.VectorType(emitters::GetVariableType<ElementType>(), blockSize)) : elementType;
+        auto blockPointerType = blockType->getPointerTo();
+        auto splat = [&](emitters::LLVMValue value) {
+            return blockSize > 1 ? builder.CreateVectorSplat(blockSize, value) : value;
+        };
+
+        // Global arrays are only guaranteed to be aligned to their element type
+        const auto alignment = function.GetModule().GetTargetDataLayout().getABITypeAlignment(elementType);
+        auto loadBlock = [&](emitters::LLVMValue pointer, emitters::IRLocalScalar offset) {
+            return builder.CreateAlignedLoad(function.CastPointer(function.PointerOffset(pointer, offset), blockPointerType), alignment);
+        };
+
+        auto expFunction = function.GetModule().GetRuntime().GetExpFunction(blockType);
+        auto multiplier = splat(function.Literal<ElementType>(-_gamma * _gamma));
+        auto zero = splat(function.Literal<ElementType>(0));
+
+        // Each label accumulates a block of weighted similarities, which are only summed at the end
+        auto pDistance = function.Variable(blockType, "distance");
+        auto pAccumulators = function.Variable(blockType, numLabels);
+        function.For(numLabels, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar label) {
+            function.Store(function.PointerOffset(pAccumulators, label), zero);
+        });
+
+        function.For(beginBlock, endBlock, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue block) {
+            auto prototype = (function.LocalScalar(block) * blockSize) + firstPrototype;
+
+            // Squared distance from the input to the prototypes in the block
+            function.Store(pDistance, zero);
+            function.For(dimension, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar k) {
+                auto difference = builder.CreateFSub(loadBlock(pPrototypes, (k * numPrototypes) + prototype), splat(function.ValueAt(pInput, k)));
+                function.Store(pDistance, builder.CreateFAdd(function.Load(pDistance), builder.CreateFMul(difference, difference)));
+            });
+
+            // The similarities go straight into the label accumulators, so the distances never leave the registers
+            auto similarity = function.Call(expFunction, { builder.CreateFMul(function.Load(pDistance), multiplier) });
+            function.For(numLabels, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar label) {
+                auto pAccumulator = function.PointerOffset(pAccumulators, label);
+                auto weightedSimilarity = builder.CreateFMul(loadBlock(pLabelEmbeddings, (label * numPrototypes) + prototype), similarity);
+                function.Store(pAccumulator, builder.CreateFAdd(function.Load(pAccumulator), weightedSimilarity));
+            });
+        });
+
+        function.For(numLabels, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar label) {
+            auto sum = emitters::HorizontalVectorSum<ElementType>(function, function.Load(function.PointerOffset(pAccumulators, label)));
+            function.SetValueAt(pScores, label, function.LocalScalar(function.ValueAt(pScores, label)) + sum);
+        });
+    }
+
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newPortElements = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<ProtoNNLabelScoresNode<ElementType>>(newPortElements, math::ColumnMatrix<ElementType>(_prototypes), math::ColumnMatrix<ElementType>(_labelEmbeddings), _gamma);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        math::MatrixArchiver::Write(_prototypes, "prototypes", archiver);
+        math::MatrixArchiver::Write(_labelEmbeddings, "labelEmbeddings", archiver);
+        archiver["gamma"] << _gamma;
     }
+
+    template <typename ElementType>
+    void ProtoNNLabelScoresNode<ElementType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        math::MatrixArchiver::Read(_prototypes, "prototypes", archiver);
+        math::MatrixArchiver::Read(_labelEmbeddings, "labelEmbeddings", archiver);
+        archiver["gamma"] >> _gamma;
+        _output.SetSize(_labelEmbeddings.NumRows());
+    }
+
+    template <typename ElementType>
+    ProtoNNPredictorNode<ElementType>* AddNodeToModelTransformer(const model::PortElements<ElementType>& input, const predictors::ProtoNNPredictor<ElementType>& predictor, model::ModelTransformer& transformer)
+    {
+        return transformer.AddNode<ProtoNNPredictorNode<ElementType>>(input, predictor);
+    }
+
+    // Explicit instantiations
+    template class ProtoNNPredictorNode<float>;
+    template class ProtoNNPredictorNode<double>;
+    template class ProtoNNLabelScoresNode<float>;
+    template class ProtoNNLabelScoresNode<double>;
+
+    template ProtoNNPredictorNode<float>* AddNodeToModelTransformer(const model::PortElements<float>& input, const predictors::ProtoNNPredictor<float>& predictor, model::ModelTransformer& transformer);
+    template ProtoNNPredictorNode<double>* AddNodeToModelTransformer(const model::PortElements<double>& input, const predictors::ProtoNNPredictor<double>& predictor, model::ModelTransformer& transformer);
 } // namespace nodes
 } // namespace ell
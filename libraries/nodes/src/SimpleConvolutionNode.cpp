@@ -26,7 +26,7 @@ namespace nodes
         // Low-level code-generation
         //
         template <typename ValueType>
-        void EmitSimpleConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue filterWeights, const PortMemoryLayout& inputLayout, const PortMemoryLayout& outputLayout, int filterSize, int stride, LLVMValue result)
+        void EmitSimpleConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue filterWeights, const PortMemoryLayout& inputLayout, const PortMemoryLayout& outputLayout, int filterSize, int stride, const FusedEpilogueEmitter<ValueType>& epilogue, LLVMValue result)
         {
             // input is a d x (w+2p) x (h+2p) array
             // reshaped, it's a d*(w+2p)) x (h+2p) array == d*(w+k-1) x (h+k-1)
@@ -45,7 +45,7 @@ namespace nodes
 
             // For each filter
             const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
-            function.ParallelFor(numFilters, { input, filterWeights, result }, [inputLayout, outputLayout, inputMemoryIncrements, filterSize, stride](IRFunctionEmitter& function, IRLocalScalar filterIndex, const std::vector<LLVMValue>& capturedValues) {
+            function.ParallelFor(numFilters, { input, filterWeights, result }, [inputLayout, outputLayout, inputMemoryIncrements, filterSize, stride, epilogue](IRFunctionEmitter& function, IRLocalScalar filterIndex, const std::vector<LLVMValue>& capturedValues) {
                 auto input = capturedValues[0];
                 auto filterWeights = capturedValues[1];
                 auto result = capturedValues[2];
@@ -53,12 +53,13 @@ namespace nodes
 
                 // For each output row
                 const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
-                function.For(outputRows, [filterIndex, input, filterWeights, inputLayout, outputLayout, inputMemoryIncrements, outputTensor, filterSize, stride](IRFunctionEmitter& function, LLVMValue loopIndex2) {
+                function.For(outputRows, [filterIndex, input, filterWeights, inputLayout, outputLayout, inputMemoryIncrements, outputTensor, filterSize, stride, epilogue](IRFunctionEmitter& function, LLVMValue loopIndex2) {
                     auto outputRow = function.LocalScalar(loopIndex2);
 
                     // For each output column
                     const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
-                    function.For(outputColumns, [outputRow, filterIndex, input, filterWeights, inputLayout, inputMemoryIncrements, outputTensor, filterSize, stride](IRFunctionEmitter& function, LLVMValue loopIndex3) {
+                    const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+                    function.For(outputColumns, [outputRow, filterIndex, input, filterWeights, inputLayout, inputMemoryIncrements, outputTensor, filterSize, stride, outputColumns, numFilters, epilogue](IRFunctionEmitter& function, LLVMValue loopIndex3) {
                         auto outputColumn = function.LocalScalar(loopIndex3);
 
                         const bool canCombineColumns = (inputLayout.GetLogicalDimensionActiveSize(1) == inputLayout.GetLogicalDimensionExtent(1)) && (stride == 1);
@@ -95,15 +96,18 @@ namespace nodes
                                     val = val + function.DotProduct(inputDepth, imageRow, filterRow);
                                 }
                             }
-                            outputTensor({ outputRow, outputColumn, filterIndex }) = val;
                         }
+
+                        // Apply the bias and activation while the result is still in a register
+                        auto entryIndex = (((outputRow * outputColumns) + outputColumn) * numFilters) + filterIndex;
+                        outputTensor({ outputRow, outputColumn, filterIndex }) = epilogue.Compile(val, filterIndex, entryIndex);
                     }); // End outputColumns loop
                 }); // End outputRows loop
             }); // End numFilters loop
         }
 
         template <typename ValueType>
-        void EmitSimpleDepthwiseSeparableConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue filterWeights, const PortMemoryLayout& inputLayout, const PortMemoryLayout& outputLayout, int filterSize, int stride, LLVMValue result)
+        void EmitSimpleDepthwiseSeparableConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue filterWeights, const PortMemoryLayout& inputLayout, const PortMemoryLayout& outputLayout, int filterSize, int stride, const FusedEpilogueEmitter<ValueType>& epilogue, LLVMValue result)
         {
             const auto inputDepth = inputLayout.GetLogicalDimensionActiveSize(2);
             const auto inputPadding = inputLayout.GetLogicalDimensionOffset(0);
@@ -118,7 +122,7 @@ namespace nodes
             // For each filter
             // For each output row
             const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
-            function.ParallelFor(outputRows, { input, filterWeights, result }, [inputLayout, outputLayout, filterSize, stride](IRFunctionEmitter& function, auto outputRow, const std::vector<LLVMValue>& capturedValues) {
+            function.ParallelFor(outputRows, { input, filterWeights, result }, [inputLayout, outputLayout, filterSize, stride, epilogue](IRFunctionEmitter& function, auto outputRow, const std::vector<LLVMValue>& capturedValues) {
                 auto input = capturedValues[0];
                 auto filterWeights = capturedValues[1];
                 auto result = capturedValues[2];
@@ -129,10 +133,10 @@ namespace nodes
 
                 // For each output column
                 const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
-                function.For(outputColumns, [outputLayout, outputRow, inputTensor, filter, outputTensor, filterSize, stride](IRFunctionEmitter& function, auto outputColumn) {
+                function.For(outputColumns, [outputLayout, outputRow, outputColumns, inputTensor, filter, outputTensor, filterSize, stride, epilogue](IRFunctionEmitter& function, auto outputColumn) {
                     // For each filter
                     const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
-                    function.For(numFilters, [outputRow, outputColumn, inputTensor, filter, outputTensor, filterSize, stride](IRFunctionEmitter& function, auto filterIndex) {
+                    function.For(numFilters, [outputRow, outputColumn, outputColumns, numFilters, inputTensor, filter, outputTensor, filterSize, stride, epilogue](IRFunctionEmitter& function, auto filterIndex) {
                         // The filters are typically small, so we unroll the loops here
                         auto val = function.LocalScalar(ValueType{ 0 });
                         for (int windowRow = 0; windowRow < filterSize; ++windowRow)
@@ -151,7 +155,8 @@ namespace nodes
                                 val += inputVal * filterVal;
                             }
                         }
-                        outputTensor({ outputRow, outputColumn, filterIndex }) = val;
+                        auto entryIndex = (((outputRow * outputColumns) + outputColumn) * numFilters) + filterIndex;
+                        outputTensor({ outputRow, outputColumn, filterIndex }) = epilogue.Compile(val, filterIndex, entryIndex);
                     });
                 });
             });
@@ -175,13 +180,15 @@ namespace nodes
                                                             const model::PortMemoryLayout& inputMemoryLayout,
                                                             const model::PortMemoryLayout& outputMemoryLayout,
                                                             const ConstTensorReferenceType& filterWeights,
-                                                            size_t stride) :
+                                                            size_t stride,
+                                                            const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _filterWeights(filterWeights),
-        _stride(static_cast<int>(stride))
+        _stride(static_cast<int>(stride)),
+        _epilogue(epilogue)
     {
         _isDepthwiseSeparable = (filterWeights.NumChannels() == 1) && (inputMemoryLayout.GetLogicalDimensionActiveSize(2) > 1);
     }
@@ -190,7 +197,7 @@ namespace nodes
     void SimpleConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<SimpleConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride);
+        auto newNode = transformer.AddNode<SimpleConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride, _epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
@@ -204,7 +211,7 @@ namespace nodes
         const auto weightsValues = weightsMatrix.ToArray();
         const int filterSize = _filterWeights.NumColumns();
         const auto& weights = AppendConstant(transformer, weightsValues);
-        auto convNode = transformer.AddNode<SimpleConvolutionComputeNode<ValueType>>(newInput, weights, _inputMemoryLayout, GetOutputMemoryLayout(), filterSize, _stride, _isDepthwiseSeparable);
+        auto convNode = transformer.AddNode<SimpleConvolutionComputeNode<ValueType>>(newInput, weights, _inputMemoryLayout, GetOutputMemoryLayout(), filterSize, _stride, _isDepthwiseSeparable, _epilogue);
         convNode->GetMetadata() = GetMetadata();
         transformer.MapNodeOutput(this->output, convNode->output);
         return true;
@@ -225,6 +232,7 @@ namespace nodes
         archiver["outputLayout"] << GetOutputMemoryLayout();
         archiver["stride"] << _stride;
         math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -238,6 +246,7 @@ namespace nodes
         _output.SetMemoryLayout(outputMemoryLayout);
         archiver["stride"] >> _stride;
         math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
 
         _isDepthwiseSeparable = (_filterWeights.NumChannels() == 1) && (_inputMemoryLayout.GetLogicalDimensionActiveSize(2) > 1);
     }
@@ -262,7 +271,8 @@ namespace nodes
                                                                           const model::PortMemoryLayout& outputMemoryLayout,
                                                                           int filterSize,
                                                                           int stride,
-                                                                          bool isDepthwiseSeparable) :
+                                                                          bool isDepthwiseSeparable,
+                                                                          const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input, &_filterWeights }, { &_output }),
         _input(this, input, defaultInputPortName),
         _filterWeights(this, filterWeights, filterWeightsPortName),
@@ -270,7 +280,8 @@ namespace nodes
         _inputMemoryLayout(inputMemoryLayout),
         _filterSize(filterSize),
         _stride(stride),
-        _isDepthwiseSeparable(isDepthwiseSeparable)
+        _isDepthwiseSeparable(isDepthwiseSeparable),
+        _epilogue(epilogue)
     {
     }
 
@@ -279,7 +290,7 @@ namespace nodes
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
         const auto& newFilterWeights = transformer.GetCorrespondingInputs(_filterWeights);
-        auto newNode = transformer.AddNode<SimpleConvolutionComputeNode<ValueType>>(newInput, newFilterWeights, _inputMemoryLayout, GetOutputMemoryLayout(), _filterSize, _stride, _isDepthwiseSeparable);
+        auto newNode = transformer.AddNode<SimpleConvolutionComputeNode<ValueType>>(newInput, newFilterWeights, _inputMemoryLayout, GetOutputMemoryLayout(), _filterSize, _stride, _isDepthwiseSeparable, _epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
@@ -322,16 +333,17 @@ namespace nodes
         DEBUG_USED(inputPadding);
         assert((inputPadding == _filterSize / 2) && "Input padding must be filterSize/2");
 
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
         if (!_isDepthwiseSeparable)
         {
-            EmitSimpleConvolutionCode<ValueType>(function, pInput, pWeights, inputLayout, outputLayout, _filterSize, _stride, pOutput);
+            EmitSimpleConvolutionCode<ValueType>(function, pInput, pWeights, inputLayout, outputLayout, _filterSize, _stride, epilogue, pOutput);
         }
         else
         {
             // Verify correct ordering
             assert((inputLayout.GetLogicalDimensionOrder() == utilities::DimensionOrder({ 2, 0, 1 })));
             assert((outputLayout.GetLogicalDimensionOrder() == utilities::DimensionOrder({ 2, 0, 1 })));
-            EmitSimpleDepthwiseSeparableConvolutionCode<ValueType>(function, pInput, pWeights, inputLayout, outputLayout, _filterSize, _stride, pOutput);
+            EmitSimpleDepthwiseSeparableConvolutionCode<ValueType>(function, pInput, pWeights, inputLayout, outputLayout, _filterSize, _stride, epilogue, pOutput);
         }
     }
 
@@ -346,6 +358,7 @@ namespace nodes
         archiver["filterSize"] << _filterSize; // TODO: get this from weights layout
         archiver["stride"] << _stride;
         archiver["dw"] << _isDepthwiseSeparable;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -361,6 +374,7 @@ namespace nodes
         archiver["filterSize"] >> _filterSize;
         archiver["stride"] >> _stride;
         archiver["dw"] >> _isDepthwiseSeparable;
+        _epilogue.ReadFromArchive(archiver);
         // _isDepthwiseSeparable = (_filterWeights.NumChannels() == 1) && (_inputMemoryLayout.GetLogicalDimensionActiveSize(2) > 1);
     }
 
@@ -10,6 +10,8 @@
 #include "BroadcastFunctionNode.h"
 #include "ConstantNode.h"
 
+#include <emitters/include/IRMath.h>
+
 namespace ell
 {
 namespace nodes
@@ -63,7 +65,6 @@ namespace nodes
             {
                 auto valueType = emitters::GetVariableType<ValueType>();
                 _accumValueVar = function.Variable(valueType, "eulerSumAccumValue");
-                _expFunc = function.GetModule().GetRuntime().GetExpFunction<ValueType>();
                 Reset(function);
             }
 
@@ -77,7 +78,7 @@ namespace nodes
                 const auto plusFloat = emitters::TypedOperator::addFloat;
                 const auto minusFloat = emitters::TypedOperator::subtractFloat;
                 auto valueMinusMax = function.Operator(minusFloat, x, _maxValue);
-                auto eulerVal = function.Call(_expFunc, { valueMinusMax });
+                auto eulerVal = emitters::Exp(function.LocalScalar(valueMinusMax));
                 function.OperationAndUpdate(_accumValueVar, plusFloat, eulerVal);
                 return eulerVal;
             }
@@ -88,7 +89,6 @@ namespace nodes
             }
 
         private:
-            emitters::LLVMFunction _expFunc;
             emitters::LLVMValue _maxValue;
             emitters::LLVMValue _accumValueVar;
         };
@@ -10,10 +10,12 @@
 #include "NodeOperations.h"
 
 #include <emitters/include/IRMath.h>
+#include <emitters/include/IRVectorUtilities.h>
 
 #include <utilities/include/TypeTraits.h>
 
 #include <cmath>
+#include <type_traits>
 
 using namespace ell;
 
@@ -214,19 +216,38 @@ namespace nodes
         }
     }
 
+    template <typename ValueType>
+    bool UnaryOperationNode<ValueType>::CanCompileBatch(model::IRMapCompiler& compiler) const
+    {
+        return !compiler.IsBatchPortShared(input);
+    }
+
+    template <typename ValueType>
+    void UnaryOperationNode<ValueType>::CompileBatch(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, int batchSize)
+    {
+        // The samples are stored one after another, so the whole batch is one elementwise loop
+        emitters::LLVMValue pInputs = compiler.GetBatchPortValues(input);
+        emitters::LLVMValue pResults = compiler.GetBatchPortValues(output);
+        CompileElementwiseLoop(function, pInputs, pResults, batchSize * static_cast<int>(input.Size()));
+    }
+
     template <typename ValueType>
     void UnaryOperationNode<ValueType>::CompileLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
-        // Loop version broken
-        auto count = input.Size();
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
         emitters::LLVMValue pResult = compiler.EnsurePortEmitted(output);
+        CompileElementwiseLoop(function, pInput, pResult, static_cast<int>(input.Size()));
+    }
 
-        function.For(count, [pInput, pResult, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
-            emitters::LLVMValue inputValue = function.ValueAt(pInput, i);
-            emitters::IRLocalScalar pOpResult = CompileOperator<ValueType>({ function, inputValue }, _operation);
-            function.SetValueAt(pResult, i, pOpResult.value);
-        });
+    template <typename ValueType>
+    void UnaryOperationNode<ValueType>::CompileElementwiseLoop(emitters::IRFunctionEmitter& function, emitters::LLVMValue pInput, emitters::LLVMValue pResult, int count)
+    {
+        // Integer operations are computed on floats, and the casts aren't vectorized
+        const bool vectorize = !(std::is_integral<ValueType>::value && !std::is_same<ValueType, bool>::value);
+        auto body = [this](emitters::IRFunctionEmitter& function, const std::vector<emitters::LLVMValue>& inputs) {
+            return CompileOperator<ValueType>({ function, inputs[0] }, _operation).value;
+        };
+        emitters::EmitElementwiseLoop(function, count, { { pInput } }, { pResult }, body, vectorize);
     }
 
     template <typename ValueType>
@@ -261,7 +282,24 @@ namespace nodes
         _output.SetSize(_input.Size());
     }
 
+    template <typename ValueType>
+    ValueType ComputeUnaryOperation(ValueType value, UnaryOperationType operation)
+    {
+        return ComputeOutput<ValueType>({ value }, operation)[0];
+    }
+
+    template <typename ValueType>
+    emitters::IRLocalScalar CompileUnaryOperation(emitters::IRLocalScalar value, UnaryOperationType operation)
+    {
+        return CompileOperator<ValueType>(value, operation);
+    }
+
     // Explicit specializations
+    template float ComputeUnaryOperation(float value, UnaryOperationType operation);
+    template double ComputeUnaryOperation(double value, UnaryOperationType operation);
+    template emitters::IRLocalScalar CompileUnaryOperation<float>(emitters::IRLocalScalar value, UnaryOperationType operation);
+    template emitters::IRLocalScalar CompileUnaryOperation<double>(emitters::IRLocalScalar value, UnaryOperationType operation);
+
     template class UnaryOperationNode<float>;
     template class UnaryOperationNode<double>;
     template class UnaryOperationNode<int>;
@@ -14,10 +14,65 @@
 
 #include <utilities/include/Unused.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
 {
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // The unrolled receptive fields of a panel are read once per filter, so we size the panels to keep them in
+        // half of a typical 256KB L2 cache, leaving room for the weights and the output
+        const int panelCacheBytes = 128 * 1024;
+
+        struct UnrolledConvolutionParameters
+        {
+            PortMemoryLayout inputLayout;
+            int outputColumns;
+            int numFilters;
+            int filterSize;
+            int stride;
+            int fieldVolume; // the number of entries in a receptive field
+        };
+
+        // Unrolls the receptive fields of a panel of output pixels into the rows of a (pixels x fieldVolume) matrix,
+        // multiplies it by the transposed weights, and applies the epilogue to the panel's output
+        template <typename ValueType>
+        void EmitUnrolledConvolutionPanel(IRFunctionEmitter& function, LLVMValue input, LLVMValue weights, LLVMValue output, LLVMValue scratch, const UnrolledConvolutionParameters& parameters, const FusedEpilogueEmitter<ValueType>& epilogue, IRLocalScalar firstPixel, int numPixels)
+        {
+            const auto& inputLayout = parameters.inputLayout;
+            const int rowIncrement = static_cast<int>(inputLayout.GetLogicalDimensionIncrement(0));
+            const int columnIncrement = static_cast<int>(inputLayout.GetLogicalDimensionIncrement(1));
+
+            // Each row of a receptive field is contiguous in the input, with the channels innermost, which is the order of
+            // the weights' columns
+            const int fieldRowVolume = parameters.filterSize * static_cast<int>(inputLayout.GetLogicalDimensionActiveSize(2));
+            function.For(numPixels, [&](IRFunctionEmitter& function, IRLocalScalar panelPixel) {
+                auto pixel = firstPixel + panelPixel;
+                auto inputRow = (pixel / parameters.outputColumns) * parameters.stride;
+                auto inputColumn = (pixel % parameters.outputColumns) * parameters.stride;
+                for (int fieldRow = 0; fieldRow < parameters.filterSize; ++fieldRow)
+                {
+                    auto inputOffset = ((inputRow + fieldRow) * rowIncrement) + (inputColumn * columnIncrement);
+                    auto scratchOffset = (panelPixel * parameters.fieldVolume) + (fieldRow * fieldRowVolume);
+                    function.MemoryCopy<ValueType>(function.PointerOffset(input, inputOffset), function.PointerOffset(scratch, scratchOffset), fieldRowVolume);
+                }
+            });
+
+            // panel output (pixels x filters) = unrolled panel (pixels x fieldVolume) * transpose(weights (filters x fieldVolume))
+            auto firstEntry = firstPixel * parameters.numFilters;
+            auto panelOutput = function.PointerOffset(output, firstEntry);
+            function.CallGEMM<ValueType>(false, true, numPixels, parameters.numFilters, parameters.fieldVolume, scratch, parameters.fieldVolume, weights, parameters.fieldVolume, panelOutput, parameters.numFilters);
+
+            // Apply the bias and activation while the panel's output is still in the cache
+            epilogue.CompileEntries(function, panelOutput, firstEntry, numPixels * parameters.numFilters);
+        }
+    } // end anonymous namespace
+
     template <typename ValueType>
     UnrolledConvolutionNode<ValueType>::UnrolledConvolutionNode() :
         CompilableNode({ &_input }, { &_output }),
@@ -32,14 +87,16 @@ namespace nodes
                                                                 const model::PortMemoryLayout& inputMemoryLayout,
                                                                 const model::PortMemoryLayout& outputMemoryLayout,
                                                                 const ConstTensorReferenceType& filterWeights,
-                                                                int stride) :
+                                                                int stride,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _filterWeights(0, 0),
         _filterSize(filterWeights.NumColumns()),
-        _stride(stride)
+        _stride(stride),
+        _epilogue(epilogue)
     {
         _isDepthwiseSeparable = (filterWeights.NumChannels() == 1) && (inputMemoryLayout.GetLogicalDimensionActiveSize(2) > 1);
         _filterWeights = GetWeightsMatrix(filterWeights);
@@ -51,14 +108,16 @@ namespace nodes
                                                                 const model::PortMemoryLayout& outputMemoryLayout,
                                                                 ConstMatrixReferenceType filterWeights,
                                                                 int filterSize,
-                                                                int stride) :
+                                                                int stride,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _filterWeights(filterWeights),
         _filterSize(filterSize),
-        _stride(stride)
+        _stride(stride),
+        _epilogue(epilogue)
     {
         _isDepthwiseSeparable = (static_cast<int>(filterWeights.NumColumns()) == (filterSize * filterSize)) && (inputMemoryLayout.GetLogicalDimensionActiveSize(2) > static_cast<int>(1));
     }
@@ -90,11 +149,28 @@ namespace nodes
         return weightsMatrix;
     }
 
+    template <typename ValueType>
+    bool UnrolledConvolutionNode<ValueType>::CanCompileInPanels() const
+    {
+        if (_isDepthwiseSeparable)
+        {
+            return false;
+        }
+
+        // Each row of a receptive field must be contiguous in the input, and the output pixels must be contiguous in the output
+        const auto& inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        return inputLayout.IsCanonicalOrder() && outputLayout.IsCanonicalOrder() &&
+               (inputLayout.GetLogicalDimensionOffset(2) == 0) &&
+               (inputLayout.GetLogicalDimensionExtent(2) == inputLayout.GetLogicalDimensionActiveSize(2)) &&
+               !outputLayout.HasPadding();
+    }
+
     template <typename ValueType>
     void UnrolledConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<UnrolledConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _filterSize, _stride);
+        auto newNode = transformer.AddNode<UnrolledConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _filterSize, _stride, _epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
@@ -107,7 +183,7 @@ namespace nodes
     template <typename ValueType>
     bool UnrolledConvolutionNode<ValueType>::Refine(model::ModelTransformer& transformer) const
     {
-        if (_isDepthwiseSeparable)
+        if (_isDepthwiseSeparable || CanCompileInPanels())
         {
             return false;
         }
@@ -151,11 +227,12 @@ namespace nodes
         // weights: numFilters x fieldVolumeSize == m x k
         // ShapedInput: fieldVolumeSize x outputRows == k x n
         // Matrix multiply output: numFilters x outputRows = m x n
+        // The bias and activation are applied by the matrix multiply, as it writes each panel of output pixels
 
         if (dataOrder == rcdOrder) // don't reorder input -- use old method
         {
             auto receptiveFieldMatrixNode = transformer.AddNode<ReceptiveFieldMatrixNode<ValueType>>(newInput, inputLayout, filterSize, _stride, inputPadding, dataOrder, outputImageWidth, outputImageHeight);
-            auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true);
+            auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true, _epilogue);
 
             if (outputPadding != 0)
             {
@@ -180,7 +257,7 @@ namespace nodes
             auto reorderInputNode = transformer.AddNode<ReorderDataNode<ValueType>>(newInput, inputLayout, transposedInputLayout);
 
             auto receptiveFieldMatrixNode = transformer.AddNode<ReceptiveFieldMatrixNode<ValueType>>(reorderInputNode->output, reorderInputNode->GetOutputMemoryLayout(), _filterSize, _stride, inputPadding, dataOrder, outputImageWidth, outputImageHeight);
-            auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true);
+            auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true, _epilogue);
 
             if (outputPadding != 0)
             {
@@ -201,6 +278,12 @@ namespace nodes
     template <typename ValueType>
     void UnrolledConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
+        if (!_isDepthwiseSeparable)
+        {
+            CompileInPanels(compiler, function);
+            return;
+        }
+
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
 
@@ -237,9 +320,11 @@ namespace nodes
         // Create temporary space for a matrix which is (output rows * output columns, _filterSize * _filterSize)
         llvm::AllocaInst* reshapedInputMatrix = function.Variable(emitters::GetVariableType<ValueType>(), outputElements * fieldArea);
 
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+
         // Loop over all input channels.
         // The large capture parameters for the lambda are to work around a bug in gcc 5.4
-        function.For(numFilters, [this, inputBuffer, outputBuffer, reshapedInputMatrix, inputIncrement, outputIncrement, weights, fieldArea, outputRows, outputColumns, outputElements, depth](emitters::IRFunctionEmitter& function, emitters::LLVMValue fValue) {
+        function.For(numFilters, [this, pOutput, inputBuffer, outputBuffer, reshapedInputMatrix, inputIncrement, outputIncrement, outputLayout, weights, fieldArea, outputRows, outputColumns, outputElements, depth, epilogue](emitters::IRFunctionEmitter& function, emitters::LLVMValue fValue) {
             auto f = function.LocalScalar(fValue);
 
             emitters::LLVMValue inputPtr = function.PointerOffset(inputBuffer, f);
@@ -275,6 +360,79 @@ namespace nodes
             });
             auto weightsPtr = function.PointerOffset(weights, f * fieldArea);
             function.CallGEMV<ValueType>(outputElements, fieldArea, shapedInput, (int)fieldArea, weightsPtr, (int)1, outputPtr, (int)depth);
+
+            // Apply the bias and activation to this channel while it's still in the cache
+            epilogue.CompileChannels(function, pOutput, outputLayout, f, 1);
+        });
+    }
+
+    template <typename ValueType>
+    void UnrolledConvolutionNode<ValueType>::CompileInPanels(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+        const int outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+        const int numPixels = outputRows * outputColumns;
+        UnrolledConvolutionParameters parameters{ GetInputMemoryLayout(), outputColumns, static_cast<int>(_filterWeights.NumRows()), _filterSize, _stride, static_cast<int>(_filterWeights.NumColumns()) };
+
+        // Split the pixels into one band per thread, with boundaries (t * numPixels) / numTasks, so the bands differ in size
+        // by at most one pixel. Each task works through its band in panels small enough to stay in the cache.
+        const int numTasks = parallelize ? std::max(1, std::min(options.maxThreads, numPixels)) : 1;
+        const int smallBandSize = numPixels / numTasks;
+        const bool hasLargeBands = numPixels % numTasks != 0;
+        const int maxBandSize = smallBandSize + (hasLargeBands ? 1 : 0);
+        const int panelSize = std::min(maxBandSize, std::max(1, panelCacheBytes / static_cast<int>(parameters.fieldVolume * sizeof(ValueType))));
+
+        auto pWeights = function.GetModule().ConstantArray(GetInternalStateIdentifier() + "_weights", _filterWeights.ToArray());
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+
+        // Each task unrolls its panels into its own slot of a global scratch buffer, rather than into a large stack variable
+        const int scratchSlotSize = panelSize * parameters.fieldVolume;
+        auto pScratch = function.GetModule().GlobalArray<ValueType>(GetInternalStateIdentifier() + "_scratch", numTasks * scratchSlotSize);
+
+        function.ParallelFor(numTasks, { pInput, pWeights, pOutput }, [parameters, epilogue, numPixels, numTasks, smallBandSize, hasLargeBands, panelSize, scratchSlotSize, pScratch](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar taskIndex, const std::vector<emitters::LLVMValue>& capturedValues) {
+            auto input = capturedValues[0];
+            auto weights = function.PointerOffset(capturedValues[1], 0);
+            auto output = capturedValues[2];
+            auto scratch = function.PointerOffset(pScratch, taskIndex * scratchSlotSize);
+            auto firstPixel = (taskIndex * numPixels) / numTasks;
+            auto endPixel = ((taskIndex + 1) * numPixels) / numTasks;
+
+            // The matrix multiply needs a fixed number of pixels, so each band size is compiled separately
+            auto emitBand = [&](emitters::IRFunctionEmitter& function, int bandSize) {
+                const int numFullPanels = bandSize / panelSize;
+                const int lastPanelSize = bandSize % panelSize;
+                function.For(numFullPanels, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar panel) {
+                    EmitUnrolledConvolutionPanel(function, input, weights, output, scratch, parameters, epilogue, firstPixel + (panel * panelSize), panelSize);
+                });
+                if (lastPanelSize > 0)
+                {
+                    EmitUnrolledConvolutionPanel(function, input, weights, output, scratch, parameters, epilogue, firstPixel + (numFullPanels * panelSize), lastPanelSize);
+                }
+            };
+
+            if (hasLargeBands)
+            {
+                function.If(endPixel - firstPixel > smallBandSize, [&](emitters::IRFunctionEmitter& function) {
+                    emitBand(function, smallBandSize + 1);
+                }).Else([&](emitters::IRFunctionEmitter& function) {
+                    emitBand(function, smallBandSize);
+                });
+            }
+            else
+            {
+                emitBand(function, smallBandSize);
+            }
         });
     }
 
@@ -288,6 +446,7 @@ namespace nodes
         archiver["filterSize"] << _filterSize;
         archiver["stride"] << _stride;
         math::MatrixArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -302,6 +461,7 @@ namespace nodes
         archiver["filterSize"] >> _filterSize;
         archiver["stride"] >> _stride;
         math::MatrixArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
         _isDepthwiseSeparable = (static_cast<int>(_filterWeights.NumColumns()) == (_filterSize * _filterSize));
     }
 
@@ -711,7 +711,7 @@ namespace nodes
         }
 
         template <typename ValueType>
-        void SplatOutputTile(emitters::IRFunctionEmitter& function, emitters::LLVMValue outputTile, emitters::IRLocalScalar tileRow, emitters::IRLocalScalar tileColumn, emitters::IRLocalScalar filterIndex, int numOutputRows, int numOutputColumns, int numFilters, int tileSize, int blockSize, emitters::LLVMValue output)
+        void SplatOutputTile(emitters::IRFunctionEmitter& function, emitters::LLVMValue outputTile, emitters::IRLocalScalar tileRow, emitters::IRLocalScalar tileColumn, emitters::IRLocalScalar filterIndex, int numOutputRows, int numOutputColumns, int numFilters, int tileSize, int blockSize, const FusedEpilogueEmitter<ValueType>& epilogue, emitters::LLVMValue output)
         {
             auto tileRowSize = tileSize;
             auto tileColumnSize = tileSize;
@@ -740,7 +740,21 @@ namespace nodes
                 {
                     auto inputLoc = ((rowIndex * tileSize) + columnIndex) * blockSize;
                     auto outputLoc = outputStart + (rowIndex * rowStride) + (columnIndex * columnStride);
-                    function.MemoryCopy<ValueType>(outputTile, function.Literal<int>(inputLoc), output, outputLoc, function.Literal<int>(blockSize));
+                    if (epilogue.IsEmpty())
+                    {
+                        function.MemoryCopy<ValueType>(outputTile, function.Literal<int>(inputLoc), output, outputLoc, function.Literal<int>(blockSize));
+                    }
+                    else
+                    {
+                        // The output has no padding, so an entry's offset is also its logical index
+                        auto outputTileArray = function.LocalArray(outputTile);
+                        auto outputArray = function.LocalArray(output);
+                        for (int blockEntryIndex = 0; blockEntryIndex < blockSize; ++blockEntryIndex)
+                        {
+                            emitters::IRLocalScalar value = outputTileArray[inputLoc + blockEntryIndex];
+                            outputArray[outputLoc + blockEntryIndex] = epilogue.Compile(value, filterIndex + blockEntryIndex, outputLoc + blockEntryIndex);
+                        }
+                    }
                 }
             }
         }
@@ -801,6 +815,7 @@ namespace nodes
                                 int blockSize,
                                 emitters::IRLocalArray transformedOutputBlock,
                                 emitters::IRLocalArray outputTile,
+                                const FusedEpilogueEmitter<ValueType>& epilogue,
                                 emitters::IRLocalArray output,
                                 const model::PortMemoryLayout& outputLayout)
         {
@@ -813,7 +828,7 @@ namespace nodes
             TransformOutputBlock<ValueType>(function, transformedOutputBlock, tileSize, filterSize, blockSize, outputTile);
 
             // outputTile is the tile block at (tileRow, tileColumn, filterIndex) of the output
-            SplatOutputTile<ValueType>(function, outputTile, tileRow, tileColumn, filterIndex, numOutputRows, numOutputColumns, numFilters, tileSize, blockSize, output);
+            SplatOutputTile<ValueType>(function, outputTile, tileRow, tileColumn, filterIndex, numOutputRows, numOutputColumns, numFilters, tileSize, blockSize, epilogue, output);
         }
 
         //
@@ -914,10 +929,58 @@ namespace nodes
         //
         // Core algorithm parts
         //
+        // The 'tilesFirst' algorithm works on bands of consecutive tile rows. `firstTileRow` may be a runtime value, in which
+        // case every tile row in the band must be a full one. A constant `firstTileRow` for a single-row band allows the
+        // last, partial, tile row to be processed.
+        //
+        template <typename ValueType>
+        void TransformInputTileRow(emitters::IRFunctionEmitter& function,
+                                   emitters::IRLocalArray input,
+                                   const model::PortMemoryLayout& inputLayout,
+                                   emitters::IRLocalScalar tileRow,
+                                   int tileSize,
+                                   int filterSize,
+                                   int blockSize,
+                                   emitters::IRLocalArray inputBlock,
+                                   emitters::IRLocalArray transformedInputBlock,
+                                   emitters::IRLocalArray transformedInput)
+        {
+            const auto windowPadding = function.LocalScalar(filterSize - 1); // This is just the amount by which "windows" (== input tiles) are bigger than output tiles
+            const auto numOutputRows = inputLayout.GetLogicalDimensionActiveSize(0);
+            const auto numOutputColumns = inputLayout.GetLogicalDimensionActiveSize(1);
+            const auto numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+
+            auto tileRowSize = tileSize;
+            if (tileRow.IsConstantInt())
+            {
+                tileRowSize = std::min(tileSize, numOutputRows - (tileRow.GetIntValue<int>() * tileSize));
+            }
+            auto rowBegin = tileRow * tileSize;
+            BlockRange windowRowRange{ rowBegin, rowBegin + (tileRowSize + filterSize - 1), function.LocalScalar(tileRowSize + filterSize - 1), tileRow };
+
+            auto loopRanges = std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange>{ { 0, numOutputColumns, tileSize },
+                                                                                             { 0, numChannels, blockSize } };
+            function.For(loopRanges, [=](emitters::IRFunctionEmitter& function, auto loopRanges) {
+                BlockRange windowColumnRange{ loopRanges[0].begin, AddAndSimplify(loopRanges[0].end, windowPadding), AddAndSimplify(loopRanges[0].size, windowPadding), loopRanges[0].index };
+
+                ProcessInputBlock<ValueType>(function,
+                                             input,
+                                             inputLayout,
+                                             { windowRowRange, windowColumnRange, loopRanges[1] },
+                                             tileSize,
+                                             filterSize,
+                                             inputBlock,
+                                             transformedInputBlock,
+                                             transformedInput);
+            });
+        }
+
         template <typename ValueType>
         void TransformInput(emitters::IRFunctionEmitter& function,
                             emitters::IRLocalArray input,
                             const model::PortMemoryLayout& inputLayout,
+                            emitters::IRLocalScalar firstTileRow,
+                            int numBandTileRows,
                             int tileSize,
                             int filterSize,
                             int blockSize,
@@ -929,34 +992,22 @@ namespace nodes
 #endif
 
             const int windowSize = tileSize + filterSize - 1;
-            const auto windowPadding = function.LocalScalar(filterSize - 1); // This is just the amount by which "windows" (== input tiles) are bigger than output tiles
 
             // scratch space for conversion
             const auto valueType = emitters::GetVariableType<ValueType>();
             auto inputBlock = function.LocalArray(function.Variable(valueType, windowSize * windowSize * blockSize));
             auto transformedInputBlock = function.LocalArray(function.Variable(valueType, windowSize * windowSize * blockSize));
-            const auto numOutputRows = inputLayout.GetLogicalDimensionActiveSize(0);
-            const auto numOutputColumns = inputLayout.GetLogicalDimensionActiveSize(1);
-            const auto numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
-            ;
 
-            auto loopRanges = std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange>{ { 0, numOutputRows, tileSize },
-                                                                                             { 0, numOutputColumns, tileSize },
-                                                                                             { 0, numChannels, blockSize } };
-            function.For(loopRanges, [=](emitters::IRFunctionEmitter& function, auto loopRanges) {
-                BlockRange windowRowRange{ loopRanges[0].begin, AddAndSimplify(loopRanges[0].end, windowPadding), AddAndSimplify(loopRanges[0].size, windowPadding), loopRanges[0].index };
-                BlockRange windowColumnRange{ loopRanges[1].begin, AddAndSimplify(loopRanges[1].end, windowPadding), AddAndSimplify(loopRanges[1].size, windowPadding), loopRanges[1].index };
-
-                ProcessInputBlock<ValueType>(function,
-                                             input,
-                                             inputLayout,
-                                             { windowRowRange, windowColumnRange, loopRanges[2] },
-                                             tileSize,
-                                             filterSize,
-                                             inputBlock,
-                                             transformedInputBlock,
-                                             transformedInput);
-            });
+            if (numBandTileRows == 1)
+            {
+                TransformInputTileRow<ValueType>(function, input, inputLayout, firstTileRow, tileSize, filterSize, blockSize, inputBlock, transformedInputBlock, transformedInput);
+            }
+            else
+            {
+                function.For(numBandTileRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar bandTileRow) {
+                    TransformInputTileRow<ValueType>(function, input, inputLayout, firstTileRow + bandTileRow, tileSize, filterSize, blockSize, inputBlock, transformedInputBlock, transformedInput);
+                });
+            }
         }
 
         // Apply the (transformed) filters to the transformed input to produce the transformed output
@@ -964,6 +1015,8 @@ namespace nodes
         void ComputeTransformedOutput(emitters::IRFunctionEmitter& function,
                                       emitters::LLVMValue transformedInput,
                                       emitters::LLVMValue transformedFilters,
+                                      emitters::IRLocalScalar firstTileRow,
+                                      int numBandTileRows,
                                       int numOutputRows,
                                       int numOutputColumns,
                                       int numChannels,
@@ -981,6 +1034,8 @@ namespace nodes
             // transformedSignal is a (windowRows*windowColumns) x (tr * tc) x (numChannels) tensor containing the entire transformed input signal
             // transformedFilters is a (windowRows*windowColumns) x (numFilters) x (numChannels) tensor
             // transformedOutput is a (windowRows*windowColumns) x (tr * tc) x (numFilters) tensor containing the entire transformed output signal
+            //
+            // The tiles in the band are contiguous in each of these matrices, so each window position needs a single matrix multiply
 
             const auto windowSize = filterSize + tileSize - 1;
             const auto numTileRows = ((numOutputRows - 1) / tileSize) + 1;
@@ -992,17 +1047,22 @@ namespace nodes
             int transformedFiltersStride = numFilters * numChannels;
             int transformedOutputStride = numOutputTiles * numFilters;
 
+            // The offsets of the band's first tile
+            auto firstTile = firstTileRow * numTileColumns;
+            auto transformedInputBand = function.PointerOffset(transformedInput, firstTile * numChannels);
+            auto transformedOutputBand = function.PointerOffset(transformedOutput, firstTile * numFilters);
+
             // Each window pixel position has a separate matrix of values to transform via a matrix multiply
             for (int windowPosition = 0; windowPosition < windowSize * windowSize; ++windowPosition)
             {
                 // Compute the offsets to the particular (wr, wc) matrix we want
-                auto transformedInputMatrix = function.PointerOffset(transformedInput, windowPosition * transformedInputStride);
+                auto transformedInputMatrix = function.PointerOffset(transformedInputBand, windowPosition * transformedInputStride);
                 auto transformedFiltersMatrix = function.PointerOffset(transformedFilters, windowPosition * transformedFiltersStride);
-                auto transformedOutputMatrix = function.PointerOffset(transformedOutput, windowPosition * transformedOutputStride);
+                auto transformedOutputMatrix = function.PointerOffset(transformedOutputBand, windowPosition * transformedOutputStride);
 
                 // filter: m x k, input: k x n, output: m x n
                 // transformedOutput = transformedFilter * transformedInput
-                const int m = numOutputTiles;
+                const int m = numBandTileRows * numTileColumns;
                 const int n = numFilters;
                 const int k = numChannels;
                 const int lda = numChannels;
@@ -1015,40 +1075,31 @@ namespace nodes
         }
 
         template <typename ValueType>
-        void TransformOutput(emitters::IRFunctionEmitter& function,
-                             emitters::IRLocalArray transformedOutput,
-                             int tileSize,
-                             int filterSize,
-                             int blockSize,
-                             emitters::IRLocalArray output,
-                             const model::PortMemoryLayout& outputLayout)
+        void TransformOutputTileRow(emitters::IRFunctionEmitter& function,
+                                    emitters::IRLocalArray transformedOutput,
+                                    emitters::IRLocalScalar tileRow,
+                                    int tileSize,
+                                    int filterSize,
+                                    int blockSize,
+                                    emitters::IRLocalArray transformedOutputBlock,
+                                    emitters::IRLocalArray outputTile,
+                                    const FusedEpilogueEmitter<ValueType>& epilogue,
+                                    emitters::IRLocalArray output,
+                                    const model::PortMemoryLayout& outputLayout)
         {
-#ifdef PROFILE_REGIONS
-            auto region = emitters::IRProfileRegionBlock(function, "Winograd_TF_TransformOutput");
-            UNUSED(region);
-#endif
-
-            const int windowSize = tileSize + filterSize - 1;
-            const auto numOutputRows = outputLayout.GetLogicalDimensionActiveSize(0);
             const auto numOutputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
             const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
 
-            const auto valueType = emitters::GetVariableType<ValueType>();
-            auto transformedOutputBlock = function.LocalArray(function.Variable(valueType, windowSize * windowSize * blockSize));
-            auto outputTile = function.LocalArray(function.Variable(valueType, tileSize * tileSize * blockSize));
-
             auto loopRanges = std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange>{ { 0, numFilters, blockSize },
-                                                                                             { 0, numOutputRows, tileSize },
                                                                                              { 0, numOutputColumns, tileSize } };
             function.For(loopRanges, [=](emitters::IRFunctionEmitter& function, auto loopRanges) {
                 auto filterIndex = loopRanges[0].begin;
-                auto rowTileIndex = loopRanges[1].index;
-                auto columnTileIndex = loopRanges[2].index;
+                auto columnTileIndex = loopRanges[1].index;
                 auto thisBlockSize = loopRanges[0].size.template GetIntValue<int>();
 
                 ProcessOutputBlock<ValueType>(function,
                                               transformedOutput,
-                                              rowTileIndex,
+                                              tileRow,
                                               columnTileIndex,
                                               filterIndex,
                                               tileSize,
@@ -1056,10 +1107,73 @@ namespace nodes
                                               thisBlockSize,
                                               transformedOutputBlock,
                                               outputTile,
+                                              epilogue,
                                               output,
                                               outputLayout);
             });
         }
+
+        template <typename ValueType>
+        void TransformOutput(emitters::IRFunctionEmitter& function,
+                             emitters::IRLocalArray transformedOutput,
+                             emitters::IRLocalScalar firstTileRow,
+                             int numBandTileRows,
+                             int tileSize,
+                             int filterSize,
+                             int blockSize,
+                             const FusedEpilogueEmitter<ValueType>& epilogue,
+                             emitters::IRLocalArray output,
+                             const model::PortMemoryLayout& outputLayout)
+        {
+#ifdef PROFILE_REGIONS
+            auto region = emitters::IRProfileRegionBlock(function, "Winograd_TF_TransformOutput");
+            UNUSED(region);
+#endif
+
+            const int windowSize = tileSize + filterSize - 1;
+            const auto valueType = emitters::GetVariableType<ValueType>();
+            auto transformedOutputBlock = function.LocalArray(function.Variable(valueType, windowSize * windowSize * blockSize));
+            auto outputTile = function.LocalArray(function.Variable(valueType, tileSize * tileSize * blockSize));
+
+            if (numBandTileRows == 1)
+            {
+                TransformOutputTileRow<ValueType>(function, transformedOutput, firstTileRow, tileSize, filterSize, blockSize, transformedOutputBlock, outputTile, epilogue, output, outputLayout);
+            }
+            else
+            {
+                function.For(numBandTileRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar bandTileRow) {
+                    TransformOutputTileRow<ValueType>(function, transformedOutput, firstTileRow + bandTileRow, tileSize, filterSize, blockSize, transformedOutputBlock, outputTile, epilogue, output, outputLayout);
+                });
+            }
+        }
+
+        // Runs the whole 'tilesFirst' pipeline on a band of tile rows: transform the input, multiply it by the transformed filters, and transform it back
+        template <typename ValueType>
+        void ConvolveTileRows(emitters::IRFunctionEmitter& function,
+                              emitters::IRLocalArray input,
+                              const model::PortMemoryLayout& inputLayout,
+                              emitters::IRLocalArray transformedFilters,
+                              emitters::IRLocalScalar firstTileRow,
+                              int numBandTileRows,
+                              int tileSize,
+                              int filterSize,
+                              int inputBlockSize,
+                              int outputBlockSize,
+                              emitters::IRLocalArray transformedInput,
+                              emitters::IRLocalArray transformedOutput,
+                              const FusedEpilogueEmitter<ValueType>& epilogue,
+                              emitters::IRLocalArray output,
+                              const model::PortMemoryLayout& outputLayout)
+        {
+            const int numOutputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+            const int numOutputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+            const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+            const int numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+
+            TransformInput<ValueType>(function, input, inputLayout, firstTileRow, numBandTileRows, tileSize, filterSize, inputBlockSize, transformedInput);
+            ComputeTransformedOutput<ValueType>(function, transformedInput, transformedFilters, firstTileRow, numBandTileRows, numOutputRows, numOutputColumns, numChannels, numFilters, tileSize, filterSize, transformedOutput);
+            TransformOutput<ValueType>(function, transformedOutput, firstTileRow, numBandTileRows, tileSize, filterSize, outputBlockSize, epilogue, output, outputLayout);
+        }
     } // end anonymous namespace
 
     //
@@ -1084,7 +1198,8 @@ namespace nodes
         _stride(other._stride),
         _tileSize(other._tileSize),
         _filterSize(other._filterSize),
-        _order(other._order)
+        _order(other._order),
+        _epilogue(other._epilogue)
     {
     }
 
@@ -1093,16 +1208,30 @@ namespace nodes
                                                                 const model::PortMemoryLayout& inputMemoryLayout,
                                                                 const model::PortMemoryLayout& outputMemoryLayout,
                                                                 const ConstTensorReferenceType& filterWeights,
-                                                                int stride) :
+                                                                int stride,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
+        WinogradConvolutionNode(input, inputMemoryLayout, outputMemoryLayout, filterWeights, stride, 2, epilogue)
+    {
+    }
+
+    template <typename ValueType>
+    WinogradConvolutionNode<ValueType>::WinogradConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                                const model::PortMemoryLayout& inputMemoryLayout,
+                                                                const model::PortMemoryLayout& outputMemoryLayout,
+                                                                const ConstTensorReferenceType& filterWeights,
+                                                                int stride,
+                                                                int tileSize,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
-        _stride(stride)
+        _stride(stride),
+        _tileSize(tileSize),
+        _epilogue(epilogue)
     {
         using FilterOrder = typename WinogradConvolutionNode<ValueType>::FilterOrder;
 
-        _tileSize = 2;
         const int numFilters = outputMemoryLayout.GetLogicalDimensionActiveSize(2);
         const int numFilterChannels = static_cast<int>(filterWeights.NumChannels());
         const int filtersFirstThreshold = 4; // empirically determined
@@ -1123,14 +1252,16 @@ namespace nodes
                                                                 const ConstTensorReferenceType& filterWeights,
                                                                 int stride,
                                                                 int tileSize,
-                                                                FilterOrder order) :
+                                                                FilterOrder order,
+                                                                const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
         _stride(stride),
         _tileSize(tileSize),
-        _order(order)
+        _order(order),
+        _epilogue(epilogue)
     {
         const int numFilters = outputMemoryLayout.GetLogicalDimensionActiveSize(2);
         _filterSize = filterWeights.NumColumns();
@@ -1192,7 +1323,7 @@ namespace nodes
             convInputLayout = reorderNode->GetOutputMemoryLayout();
         }
 
-        auto convNode = transformer.AddNode<WinogradConvolutionComputeNode<ValueType>>(*newInput, weights, convInputLayout, GetOutputMemoryLayout(), _stride, _tileSize, _filterSize, _order, static_cast<int>(numFilterChannels));
+        auto convNode = transformer.AddNode<WinogradConvolutionComputeNode<ValueType>>(*newInput, weights, convInputLayout, GetOutputMemoryLayout(), _stride, _tileSize, _filterSize, _order, static_cast<int>(numFilterChannels), _epilogue);
         convNode->GetMetadata() = GetMetadata();
         transformer.MapNodeOutput(this->output, convNode->output);
         return true;
@@ -1216,6 +1347,7 @@ namespace nodes
         archiver["stride"] << _stride;
         archiver["order"] << to_string(_order);
         math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -1234,6 +1366,7 @@ namespace nodes
         archiver["order"] >> orderName;
         _order = filter_order_from_string(orderName);
         math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+        _epilogue.ReadFromArchive(archiver);
     }
 
     //
@@ -1258,7 +1391,8 @@ namespace nodes
                                                                               int tileSize,
                                                                               int filterSize,
                                                                               FilterOrder order,
-                                                                              int numFilterChannels) :
+                                                                              int numFilterChannels,
+                                                                              const FusedEpilogue<ValueType>& epilogue) :
         CompilableNode({ &_input, &_filterWeights }, { &_output }),
         _input(this, input, defaultInputPortName),
         _filterWeights(this, filterWeights, filterWeightsPortName),
@@ -1268,7 +1402,8 @@ namespace nodes
         _tileSize(tileSize),
         _filterSize(filterSize),
         _order(order),
-        _numFilterChannels(numFilterChannels)
+        _numFilterChannels(numFilterChannels),
+        _epilogue(epilogue)
     {
         const auto numChannels = inputMemoryLayout.GetLogicalDimensionActiveSize(2);
         const int numFilters = outputMemoryLayout.GetLogicalDimensionActiveSize(2);
@@ -1291,7 +1426,8 @@ namespace nodes
         _order(other._order),
         _numFilterChannels(other._numFilterChannels),
         _inputBlockSize(other._inputBlockSize),
-        _outputBlockSize(other._outputBlockSize)
+        _outputBlockSize(other._outputBlockSize),
+        _epilogue(other._epilogue)
     {
     }
 
@@ -1376,10 +1512,66 @@ namespace nodes
         // Clear output buffer
         function.StoreZero(output, outputLayout.NumElements());
 
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
         // This is the core of the Winograd convolution algorithm: transform the input, perform an elementwise multiply between it an the transformed filter, and transform it back
-        TransformInput<ValueType>(function, input, inputLayout, _tileSize, _filterSize, _inputBlockSize, transformedInput);
-        ComputeTransformedOutput<ValueType>(function, transformedInput, transformedFilters, numOutputRows, numOutputColumns, numChannels, numFilters, _tileSize, _filterSize, transformedOutput);
-        TransformOutput<ValueType>(function, transformedOutput, _tileSize, _filterSize, _outputBlockSize, output, outputLayout);
+        // The bias and activation are applied as each output tile is written
+        //
+        // The full tile rows are split into one band per thread, and each task runs the whole pipeline on its band, so the transforms
+        // run in parallel along with the matrix multiplies. The bands differ in size by at most one tile row, so there are no rows
+        // left over, and the last task also does the last (partial) tile row.
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        const int numFullTileRows = numOutputRows / _tileSize;
+        const bool hasPartialTileRow = numFullTileRows < numTileRows;
+        const int numTasks = parallelize ? std::max(1, options.maxThreads) : 1;
+        const int numBands = std::min(numTasks, numFullTileRows);
+
+        const int tileSize = _tileSize;
+        const int filterSize = _filterSize;
+        const int inputBlockSize = _inputBlockSize;
+        const int outputBlockSize = _outputBlockSize;
+        if (numBands > 0)
+        {
+            // The matrix multiply needs a fixed number of tiles, so a band of (smallBandTileRows + 1) rows is compiled separately
+            const int smallBandTileRows = numFullTileRows / numBands;
+            const bool hasLargeBands = numFullTileRows % numBands != 0;
+            function.ParallelFor(numBands, { input, transformedFilters, transformedInput, transformedOutput, output }, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar bandIndex, const std::vector<emitters::LLVMValue>& capturedValues) {
+                auto input = function.LocalArray(capturedValues[0]);
+                auto transformedFilters = function.LocalArray(capturedValues[1]);
+                auto transformedInput = function.LocalArray(capturedValues[2]);
+                auto transformedOutput = function.LocalArray(capturedValues[3]);
+                auto output = function.LocalArray(capturedValues[4]);
+                auto beginTileRow = (bandIndex * numFullTileRows) / numBands;
+                auto endTileRow = ((bandIndex + 1) * numFullTileRows) / numBands;
+                if (hasLargeBands)
+                {
+                    function.If(endTileRow - beginTileRow > smallBandTileRows, [=](emitters::IRFunctionEmitter& function) {
+                        ConvolveTileRows<ValueType>(function, input, inputLayout, transformedFilters, beginTileRow, smallBandTileRows + 1, tileSize, filterSize, inputBlockSize, outputBlockSize, transformedInput, transformedOutput, epilogue, output, outputLayout);
+                    }).Else([=](emitters::IRFunctionEmitter& function) {
+                        ConvolveTileRows<ValueType>(function, input, inputLayout, transformedFilters, beginTileRow, smallBandTileRows, tileSize, filterSize, inputBlockSize, outputBlockSize, transformedInput, transformedOutput, epilogue, output, outputLayout);
+                    });
+                }
+                else
+                {
+                    ConvolveTileRows<ValueType>(function, input, inputLayout, transformedFilters, beginTileRow, smallBandTileRows, tileSize, filterSize, inputBlockSize, outputBlockSize, transformedInput, transformedOutput, epilogue, output, outputLayout);
+                }
+
+                if (hasPartialTileRow)
+                {
+                    function.If(bandIndex == numBands - 1, [=](emitters::IRFunctionEmitter& function) {
+                        ConvolveTileRows<ValueType>(function, input, inputLayout, transformedFilters, function.LocalScalar(numFullTileRows), 1, tileSize, filterSize, inputBlockSize, outputBlockSize, transformedInput, transformedOutput, epilogue, output, outputLayout);
+                    });
+                }
+            });
+        }
+        else if (hasPartialTileRow)
+        {
+            ConvolveTileRows<ValueType>(function, input, inputLayout, transformedFilters, function.LocalScalar(numFullTileRows), 1, tileSize, filterSize, inputBlockSize, outputBlockSize, transformedInput, transformedOutput, epilogue, output, outputLayout);
+        }
     }
 
     template <typename ValueType>
@@ -1389,8 +1581,6 @@ namespace nodes
                                                                         emitters::IRLocalArray transformedFilters,
                                                                         emitters::IRLocalArray output)
     {
-        const auto windowSize = _filterSize + _tileSize - 1;
-
         // Input data parameters
         const auto inputLayout = this->GetInputMemoryLayout();
         const auto numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
@@ -1406,11 +1596,8 @@ namespace nodes
         // Output data parameters
         const auto outputLayout = this->GetOutputMemoryLayout();
         const int numOutputRows = outputLayout.GetLogicalDimensionActiveSize(0);
-        const int numOutputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
         const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
 
-        const model::PortMemoryLayout transformedFilterLayout(model::MemoryShape{ numFilters, numFilterChannels, windowSize, windowSize });
-
         // When blockSize > 1, the inner loop reads in a windowSize x windowSize x blockSize block of
         // input image data, transforms it, multiplies it, post-transforms it, and writes to output image tile
         // All this can happen inside ConvolveAccumulateBlock()
@@ -1430,11 +1617,88 @@ namespace nodes
 
         const int maxFilterChannelBlockDepth = isSeparable ? 1 : nonseparableChannelDepth;
         const int maxFilterBlockDepth = isSeparable ? separableBlockDepth : nonseparableFilterBlockDepth;
+        const FiltersFirstBlockDepths blockDepths = { maxFilterBlockDepth, maxFilterChannelBlockDepth };
+
+        // Clear output buffer
+        function.StoreZero(output, outputLayout.NumElements());
+
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        // As in the 'tilesFirst' order, the full tile rows are split into one band per thread, and each task runs the whole
+        // pipeline on its band with its own temporaries. The bands differ in size by at most one tile row, so there are no
+        // rows left over, and the last (partial) tile row is one more task.
+        FusedEpilogueEmitter<ValueType> epilogue(function, _epilogue, GetInternalStateIdentifier());
+        const int numFullTileRows = numOutputRows / _tileSize;
+        const bool hasPartialTileRow = numFullTileRows * _tileSize < numOutputRows;
+        const int numTasks = parallelize ? std::max(1, options.maxThreads) : 1;
+        const int numBands = std::min(numTasks, numFullTileRows);
+        const int numParallelTasks = numBands + (hasPartialTileRow ? 1 : 0);
+        if (numBands < 1 || numParallelTasks < 2)
+        {
+            CompileFiltersFirstTileRows(function, input, transformedFilters, output, blockDepths, epilogue, function.LocalScalar(0), function.LocalScalar(numFullTileRows), hasPartialTileRow);
+            return;
+        }
+
+        function.ParallelFor(numParallelTasks, { input, transformedFilters, output }, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar taskIndex, const std::vector<emitters::LLVMValue>& capturedValues) {
+            auto input = function.LocalArray(capturedValues[0]);
+            auto transformedFilters = function.LocalArray(capturedValues[1]);
+            auto output = function.LocalArray(capturedValues[2]);
+            auto ifEmitter = function.If(taskIndex < numBands, [=](emitters::IRFunctionEmitter& function) {
+                auto beginTileRow = (taskIndex * numFullTileRows) / numBands;
+                auto endTileRow = ((taskIndex + 1) * numFullTileRows) / numBands;
+                this->CompileFiltersFirstTileRows(function, input, transformedFilters, output, blockDepths, epilogue, beginTileRow, endTileRow, false);
+            });
+            if (hasPartialTileRow)
+            {
+                ifEmitter.Else([=](emitters::IRFunctionEmitter& function) {
+                    this->CompileFiltersFirstTileRows(function, input, transformedFilters, output, blockDepths, epilogue, function.LocalScalar(numFullTileRows), function.LocalScalar(numFullTileRows), true);
+                });
+            }
+        });
+    }
+
+    template <typename ValueType>
+    void WinogradConvolutionComputeNode<ValueType>::CompileFiltersFirstTileRows(emitters::IRFunctionEmitter& function,
+                                                                                emitters::IRLocalArray input,
+                                                                                emitters::IRLocalArray transformedFilters,
+                                                                                emitters::IRLocalArray output,
+                                                                                FiltersFirstBlockDepths blockDepths,
+                                                                                const FusedEpilogueEmitter<ValueType>& epilogue,
+                                                                                emitters::IRLocalScalar beginTileRow,
+                                                                                emitters::IRLocalScalar endTileRow,
+                                                                                bool includePartialTileRow)
+    {
+        const auto windowSize = _filterSize + _tileSize - 1;
+        const int tileSize = _tileSize;
+
+        // Input data parameters
+        const auto inputLayout = this->GetInputMemoryLayout();
+        const auto numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+
+        // Filter data parameters
+        const int numFilterChannels = _numFilterChannels;
+
+        // Output data parameters
+        const auto outputLayout = this->GetOutputMemoryLayout();
+        const int numOutputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+        const int numOutputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+        const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+        const int numFullTileRows = numOutputRows / tileSize;
+        const int partialTileRowSize = numOutputRows - (numFullTileRows * tileSize);
+
+        const model::PortMemoryLayout transformedFilterLayout(model::MemoryShape{ numFilters, numFilterChannels, windowSize, windowSize });
+        const bool isSeparable = (numFilterChannels == 1 && numFilters == numChannels);
+
+        const int maxFilterChannelBlockDepth = blockDepths.filterChannels;
+        const int maxFilterBlockDepth = blockDepths.filters;
         const int maxInputBlockDepth = isSeparable ? maxFilterBlockDepth : maxFilterChannelBlockDepth;
         const int maxOutputBlockDepth = maxFilterBlockDepth;
 
-        // Temporaries
-        // TODO: allocate a set of temporaries per thread and parallelize the big outer loop
+        // Temporaries. These are local to the function being emitted, so each parallel task gets its own.
         WinogradScratchStorage scratch;
         const auto valueType = emitters::GetVariableType<ValueType>();
         const auto inputBlockElements = windowSize * windowSize * maxInputBlockDepth;
@@ -1453,27 +1717,11 @@ namespace nodes
         ConstConvolutionSize problemSize = { numOutputRows, numOutputColumns, numChannels, numFilterChannels, numFilters };
         auto windowPadding = function.LocalScalar(windowSize - _tileSize); // This is just the amount by which "windows" (== input tiles) are bigger than output tiles
 
-        // Clear output buffer
-        function.StoreZero(output, outputLayout.NumElements());
-        std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange> outerLoopRanges = { { 0, numFilters, maxFilterBlockDepth },
-                                                                                          { 0, numFilterChannels, maxFilterChannelBlockDepth } };
-        function.For(outerLoopRanges, [problemSize, numChannels, numFilterChannels, isSeparable, windowPadding, scratch, input, inputLayout, transformedFilters, transformedFilterLayout, output, outputLayout, this](emitters::IRFunctionEmitter& function, std::vector<emitters::IRFunctionEmitter::BlockInterval> loopRanges) {
-            auto filterRange = loopRanges[0];
-            auto filterChannelRange = loopRanges[1];
-            int filterBlockDepth = filterRange.size.template GetIntValue<int>();
-            int filterChannelBlockDepth = filterChannelRange.size.template GetIntValue<int>();
-            const auto useFilterBlock = (filterBlockDepth > 1 || filterChannelBlockDepth > 1);
-            if (useFilterBlock)
-            {
-                LoadFilterBlock<ValueType>(function, transformedFilters, transformedFilterLayout, filterRange, filterChannelRange, this->_tileSize, this->_filterSize, scratch.transformedFilterBlock);
-            }
-
-            std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange> innerLoopRanges = { { 0, problemSize.rows, _tileSize },
-                                                                                              { 0, problemSize.columns, _tileSize } };
-            function.For(innerLoopRanges, [filterRange, filterChannelRange, problemSize, numChannels, numFilterChannels, isSeparable, windowPadding, scratch, input, inputLayout, transformedFilters, transformedFilterLayout, output, outputLayout, this](emitters::IRFunctionEmitter& function, std::vector<emitters::IRFunctionEmitter::BlockInterval> loopRanges) {
-                auto tileRowRange = loopRanges[0];
-                auto tileColumnRange = loopRanges[1];
-
+        // Convolves one tile row for a block of filters and filter channels. The rows passed in as compile-time constants
+        // (the partial tile row) get their partial tiles handled correctly.
+        auto convolveTileRow = [=](emitters::IRFunctionEmitter& function, emitters::IRFunctionEmitter::BlockInterval tileRowRange, emitters::IRFunctionEmitter::BlockInterval filterRange, emitters::IRFunctionEmitter::BlockInterval filterChannelRange) {
+            const emitters::IRFunctionEmitter::ConstTiledLoopRange tileColumnLoopRange = { 0, problemSize.columns, tileSize };
+            function.For(tileColumnLoopRange, [=](emitters::IRFunctionEmitter& function, emitters::IRFunctionEmitter::BlockInterval tileColumnRange) {
                 auto channelStart = (filterRange.begin * numFilterChannels) % numChannels;
                 // TODO: See about removing the "% numChannels" if we can know that it's unnecessary at compile-time (e.g., if numFilterChannels == N*numChannels) for N > 0
                 // TODO: assert (channelStart + filterRange.size * numFilterChannels) < numChannels) --- make sure it doesn't wrap around while processing a block
@@ -1487,8 +1735,48 @@ namespace nodes
                 BlockRange outputChannelRange = filterRange;
                 ConvolutionBlockRanges ranges{ windowRowRange, windowColumnRange, inputChannelRange, filterRange, filterChannelRange, tileRowRange, tileColumnRange, outputChannelRange }; // filterRange == output channel range
 
-                ConvolveAccumulateBlock<ValueType>(function, input, inputLayout, transformedFilters, transformedFilterLayout, ranges, problemSize, _tileSize, _filterSize, scratch, output, outputLayout);
+                ConvolveAccumulateBlock<ValueType>(function, input, inputLayout, transformedFilters, transformedFilterLayout, ranges, problemSize, tileSize, this->_filterSize, scratch, output, outputLayout);
+            });
+        };
+
+        // `AccumulateOutputTile()` writes the output as a dense (row, column, channel) tensor, so the epilogue addresses it the same way
+        const model::PortMemoryLayout tileRowEpilogueLayout(model::MemoryShape{ tileSize, numOutputColumns, numFilters });
+        const model::PortMemoryLayout partialTileRowEpilogueLayout(model::MemoryShape{ std::max(1, partialTileRowSize), numOutputColumns, numFilters });
+        const int tileRowOutputSize = tileSize * numOutputColumns * numFilters;
+
+        const emitters::IRFunctionEmitter::ConstTiledLoopRange filterLoopRange = { 0, numFilters, maxFilterBlockDepth };
+        const emitters::IRFunctionEmitter::ConstTiledLoopRange filterChannelLoopRange = { 0, numFilterChannels, maxFilterChannelBlockDepth };
+        function.For(filterLoopRange, [=](emitters::IRFunctionEmitter& function, emitters::IRFunctionEmitter::BlockInterval filterRange) {
+            function.For(filterChannelLoopRange, [=](emitters::IRFunctionEmitter& function, emitters::IRFunctionEmitter::BlockInterval filterChannelRange) {
+                int filterBlockDepth = filterRange.size.template GetIntValue<int>();
+                int filterChannelBlockDepth = filterChannelRange.size.template GetIntValue<int>();
+                const auto useFilterBlock = (filterBlockDepth > 1 || filterChannelBlockDepth > 1);
+                if (useFilterBlock)
+                {
+                    LoadFilterBlock<ValueType>(function, transformedFilters, transformedFilterLayout, filterRange, filterChannelRange, this->_tileSize, this->_filterSize, scratch.transformedFilterBlock);
+                }
+
+                function.For(beginTileRow, endTileRow, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tileRow) {
+                    auto rowBegin = tileRow * tileSize;
+                    convolveTileRow(function, { rowBegin, rowBegin + tileSize, function.LocalScalar(tileSize), tileRow }, filterRange, filterChannelRange);
+                });
+
+                if (includePartialTileRow && partialTileRowSize > 0)
+                {
+                    const int rowBegin = numFullTileRows * tileSize;
+                    convolveTileRow(function, { function.LocalScalar(rowBegin), function.LocalScalar(numOutputRows), function.LocalScalar(partialTileRowSize), function.LocalScalar(numFullTileRows) }, filterRange, filterChannelRange);
+                }
+            });
+
+            // All the channels for this block of filters have been accumulated, so apply the bias and activation to this task's rows
+            const int filterBlockDepth = filterRange.size.template GetIntValue<int>();
+            function.For(beginTileRow, endTileRow, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tileRow) {
+                epilogue.CompileChannels(function, function.PointerOffset(output, tileRow * tileRowOutputSize), tileRowEpilogueLayout, filterRange.begin, filterBlockDepth);
             });
+            if (includePartialTileRow && partialTileRowSize > 0)
+            {
+                epilogue.CompileChannels(function, function.PointerOffset(output, numFullTileRows * tileRowOutputSize), partialTileRowEpilogueLayout, filterRange.begin, filterBlockDepth);
+            }
         });
     }
 
@@ -1505,6 +1793,7 @@ namespace nodes
         archiver["stride"] << _stride;
         archiver["order"] << to_string(_order);
         archiver["filterChannels"] << _numFilterChannels;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -1524,6 +1813,7 @@ namespace nodes
         archiver["order"] >> orderName;
         _order = filter_order_from_string(orderName);
         archiver["filterChannels"] >> _numFilterChannels;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicit specializations
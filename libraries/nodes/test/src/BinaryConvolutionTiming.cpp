@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinaryConvolutionTiming.cpp (nodes_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BinaryConvolutionTiming.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
+#include <model/include/Model.h>
+
+#include <nodes/include/BinaryConvolutionalLayerNode.h>
+
+#include <predictors/neural/include/BinaryConvolutionalLayer.h>
+
+#include <utilities/include/MillisecondTimer.h>
+#include <utilities/include/RandomEngines.h>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ell;
+using namespace nodes;
+
+namespace
+{
+using ElementType = float;
+using LayerType = predictors::neural::BinaryConvolutionalLayer<ElementType>;
+
+// The shapes of the 3x3 binary convolution layers of a binarized (XNOR) Darknet reference network, whose max pooling
+// layers halve the image size between them
+struct LayerShape
+{
+    int imageSize;
+    int numChannels;
+    int numFilters;
+};
+const std::vector<LayerShape> c_layerShapes = { { 56, 64, 128 }, { 28, 128, 256 }, { 14, 256, 512 }, { 7, 512, 1024 } };
+
+template <typename TensorType>
+void FillRandomTensor(TensorType& tensor)
+{
+    auto randomEngine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<ElementType> uniform(-1, 1);
+    tensor.Generate([&]() { return uniform(randomEngine); });
+}
+
+// Times the compiled layer, and prints the average time per call
+void TimeBinaryConvolution(const LayerShape& shape, bool blockFilters, bool parallelize, int numIterations)
+{
+    using namespace predictors::neural;
+    const size_t filterSize = 3;
+    const size_t padding = 1;
+
+    typename LayerType::TensorType input(shape.imageSize + 2 * padding, shape.imageSize + 2 * padding, shape.numChannels);
+    auto activeInput = input.GetSubTensor(padding, padding, 0, shape.imageSize, shape.imageSize, shape.numChannels);
+    FillRandomTensor(activeInput);
+    typename LayerType::TensorType weights(filterSize * shape.numFilters, filterSize, shape.numChannels);
+    FillRandomTensor(weights);
+
+    typename LayerType::LayerParameters parameters{ input, { PaddingScheme::zeros, padding }, { static_cast<size_t>(shape.imageSize), static_cast<size_t>(shape.imageSize), static_cast<size_t>(shape.numFilters) }, NoPadding() };
+    BinaryConvolutionalParameters convolutionalParameters{ filterSize, 1, BinaryConvolutionMethod::bitwise, BinaryWeightsScale::mean };
+    LayerType layer(parameters, convolutionalParameters, weights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(input.Size());
+    auto computeNode = model.AddNode<BinaryConvolutionalLayerNode<ElementType>>(inputNode->output, layer);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", computeNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimize = true;
+    settings.compilerSettings.allowVectorInstructions = true;
+    settings.compilerSettings.parallelize = parallelize;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["blockBinaryConvolutionFilters"] = blockFilters;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    auto inputValues = input.ToArray();
+
+    // Warm up
+    compiledMap.SetInputValue(0, inputValues);
+    volatile auto warmupResult = compiledMap.ComputeOutput<ElementType>(0);
+
+    utilities::MillisecondTimer timer;
+    for (int iteration = 0; iteration < numIterations; ++iteration)
+    {
+        compiledMap.SetInputValue(0, inputValues);
+        volatile auto compiledResult = compiledMap.ComputeOutput<ElementType>(0);
+    }
+    auto duration = timer.Elapsed();
+
+    std::cout << "BinaryConvolutionalLayerNode " << shape.imageSize << "x" << shape.imageSize << "x" << shape.numChannels << " -> " << shape.numFilters << " filters, "
+              << (blockFilters ? "blocked filters" : "one filter at a time") << ", " << (parallelize ? "parallel" : "serial") << ": "
+              << "total time for " << numIterations << " iterations: " << duration << " ms\t"
+              << "(" << static_cast<double>(duration) / numIterations << " ms per iteration)\n";
+}
+} // namespace
+
+void TimeBinaryConvolutionNodes()
+{
+    const int numIterations = 20;
+    for (const auto& shape : c_layerShapes)
+    {
+        for (bool parallelize : { false, true })
+        {
+            TimeBinaryConvolution(shape, false, parallelize, numIterations);
+            TimeBinaryConvolution(shape, true, parallelize, numIterations);
+        }
+        std::cout << std::endl;
+    }
+}
@@ -26,10 +26,12 @@
 #include <model/include/Model.h>
 #include <model/include/Node.h>
 
+#include <nodes/include/BlockedConvolutionNode.h>
 #include <nodes/include/BufferNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/DTWDistanceNode.h>
 #include <nodes/include/DelayNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
 #include <nodes/include/DiagonalConvolutionNode.h>
 #include <nodes/include/FFTNode.h>
 #include <nodes/include/FilterBankNode.h>
@@ -87,6 +89,10 @@ std::string GetConvAlgName(dsp::ConvolutionMethodOption alg)
         return "diagonal";
     case dsp::ConvolutionMethodOption::winograd:
         return "winograd";
+    case dsp::ConvolutionMethodOption::blocked:
+        return "blocked";
+    case dsp::ConvolutionMethodOption::depthwise:
+        return "depthwise";
     }
     return "";
 }
@@ -501,6 +507,12 @@ static void TestConvolutionNodeCompile(dsp::ConvolutionMethodOption convolutionM
     case dsp::ConvolutionMethodOption::winograd:
         outputNode = model.AddNode<nodes::WinogradConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride, winogradTileSize, winogradFilterOrder);
         break;
+    case dsp::ConvolutionMethodOption::blocked:
+        outputNode = model.AddNode<nodes::BlockedConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        break;
+    case dsp::ConvolutionMethodOption::depthwise:
+        outputNode = model.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        break;
     }
 
     auto map = model::Map(model, { { "input", inputNode } }, { { "output", model::PortElementsBase(*(outputNode->GetOutputPort(0))) } });
@@ -580,6 +592,8 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     settings.compilerSettings.optimize = true;
     settings.compilerSettings.useBlas = true;
     settings.verifyJittedModule = true;
+    settings.compilerSettings.allowVectorInstructions = (convolutionMethod == dsp::ConvolutionMethodOption::blocked) || (convolutionMethod == dsp::ConvolutionMethodOption::depthwise);
+    settings.compilerSettings.parallelize = (convolutionMethod == dsp::ConvolutionMethodOption::unrolled); // the serial panels are covered by TestConvolutionNodeCompile
     model::ModelOptimizerOptions optimizerOptions;
     model::IRMapCompiler compiler(settings, optimizerOptions);
 
@@ -626,6 +640,18 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
         convOutput = convNode->output;
         break;
     }
+    case dsp::ConvolutionMethodOption::blocked:
+    {
+        auto convNode = model.AddNode<nodes::BlockedConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, filterWeights, stride);
+        convOutput = convNode->output;
+        break;
+    }
+    case dsp::ConvolutionMethodOption::depthwise:
+    {
+        auto convNode = model.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, filterWeights, stride);
+        convOutput = convNode->output;
+        break;
+    }
     }
 
     auto postConvReorderNode = model.AddNode<nodes::ReorderDataNode<ValueType>>(convOutput, convOutputLayout, outputMemoryLayout);
@@ -644,7 +670,7 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     std::vector<ValueType> reference;
     if (isDepthwiseSeparable)
     {
-        reference = dsp::Convolve2DDepthwiseSeparable(paddedDataTensor, filterWeights, numFilters).ToArray();
+        reference = dsp::Convolve2DDepthwiseSeparable(paddedDataTensor, filterWeights, numFilters, stride).ToArray();
     }
     else
     {
@@ -681,6 +707,46 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     }
 }
 
+// The blocked and depthwise convolutions assume the input is padded by half the filter size
+template <typename ValueType>
+static void TestConvolutionNodeRejectsUnpaddedInput(dsp::ConvolutionMethodOption convolutionMethod)
+{
+    using Tensor = math::ChannelColumnRowTensor<ValueType>;
+
+    const int inputSize = 8;
+    const int numChannels = 2;
+    const int filterSize = 3;
+    const int stride = 1;
+
+    // A "valid" convolution, where the output is smaller than the unpadded input
+    const int outputSize = inputSize - filterSize + 1;
+    auto inputMemoryLayout = CalculateMemoryLayout(inputSize, inputSize, numChannels, 0);
+    auto outputMemoryLayout = CalculateMemoryLayout(outputSize, outputSize, numChannels, 0);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(inputMemoryLayout.GetMemorySize());
+    bool threw = false;
+    try
+    {
+        if (convolutionMethod == dsp::ConvolutionMethodOption::blocked)
+        {
+            auto filterWeights = Tensor(numChannels * filterSize, filterSize, numChannels);
+            model.AddNode<nodes::BlockedConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        }
+        else if (convolutionMethod == dsp::ConvolutionMethodOption::depthwise)
+        {
+            auto filterWeights = Tensor(numChannels * filterSize, filterSize, 1);
+            model.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        }
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+
+    testing::ProcessTest("Testing " + GetConvAlgName(convolutionMethod) + " convolution rejects an unpadded input", threw);
+}
+
 //
 // Recurrent layer nodes (Recurrent, GRU, LSTM)
 //
@@ -761,7 +827,9 @@ void TestRNNNode()
         }
     });
 }
-void TestGRUNode()
+// With a sequence length greater than 1, the input is the same frame repeated, so the outputs are the hidden states of consecutive steps.
+// If `constantWeights` is false, the weights and biases are appended to the map's input instead of coming from constant nodes.
+void TestGRUNode(size_t sequenceLength, bool constantWeights)
 {
     using ElementType = double;
     using namespace ell::predictors;
@@ -784,8 +852,12 @@ void TestGRUNode()
     size_t hiddenSize = 3;
     double epsilon = 1e-5;
 
-    ConstVectorReference input(x_t, sizeof(x_t) / sizeof(double));
-    size_t inputSize = input.Size();
+    std::vector<ElementType> input;
+    for (size_t frame = 0; frame < sequenceLength; ++frame)
+    {
+        input.insert(input.end(), std::begin(x_t), std::end(x_t));
+    }
+    size_t inputSize = input.size();
     ConstVectorReference inputWeights(w_i, sizeof(w_i) / sizeof(double));
     ConstVectorReference hiddenWeights(w_h, sizeof(w_h) / sizeof(double));
     ConstVectorReference inputBias(b_i, sizeof(b_i) / sizeof(double));
@@ -793,16 +865,42 @@ void TestGRUNode()
 
     // Create model
     model::Model model;
-    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputSize);
     auto resetTriggerNode = model.AddNode<nodes::ConstantNode<int>>(0);
-    auto inputWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputWeights.ToArray());
-    auto hiddenWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenWeights.ToArray());
-    auto inputBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputBias.ToArray());
-    auto hiddenBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenBias.ToArray());
+    model::InputNode<ElementType>* inputNode = nullptr;
+    model::PortElements<ElementType> frame, inputWeightsElements, hiddenWeightsElements, inputBiasElements, hiddenBiasElements;
+    if (constantWeights)
+    {
+        inputNode = model.AddNode<model::InputNode<ElementType>>(inputSize);
+        frame = { inputNode->output };
+        inputWeightsElements = { model.AddNode<nodes::ConstantNode<ElementType>>(inputWeights.ToArray())->output };
+        hiddenWeightsElements = { model.AddNode<nodes::ConstantNode<ElementType>>(hiddenWeights.ToArray())->output };
+        inputBiasElements = { model.AddNode<nodes::ConstantNode<ElementType>>(inputBias.ToArray())->output };
+        hiddenBiasElements = { model.AddNode<nodes::ConstantNode<ElementType>>(hiddenBias.ToArray())->output };
+    }
+    else
+    {
+        // Route the weights and biases from the input, so the node can't pack them at compile time
+        for (auto values : { inputWeights, hiddenWeights, inputBias, hiddenBias })
+        {
+            input.insert(input.end(), values.GetConstDataPointer(), values.GetConstDataPointer() + values.Size());
+        }
+        inputNode = model.AddNode<model::InputNode<ElementType>>(input.size());
+        size_t offset = 0;
+        auto nextRange = [&](size_t size) {
+            model::PortElements<ElementType> elements(inputNode->output, offset, size);
+            offset += size;
+            return elements;
+        };
+        frame = nextRange(inputSize);
+        inputWeightsElements = nextRange(inputWeights.Size());
+        hiddenWeightsElements = nextRange(hiddenWeights.Size());
+        inputBiasElements = nextRange(inputBias.Size());
+        hiddenBiasElements = nextRange(hiddenBias.Size());
+    }
     auto activation = ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::TanhActivation<ElementType>());
     auto recurrentActivation = ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::SigmoidActivation<ElementType>());
 
-    auto gruNode = model.AddNode<nodes::GRUNode<ElementType>>(inputNode->output, resetTriggerNode->output, hiddenSize, inputWeightsNode->output, hiddenWeightsNode->output, inputBiasNode->output, hiddenBiasNode->output, activation, recurrentActivation);
+    auto gruNode = model.AddNode<nodes::GRUNode<ElementType>>(frame, resetTriggerNode->output, hiddenSize, inputWeightsElements, hiddenWeightsElements, inputBiasElements, hiddenBiasElements, activation, recurrentActivation, true, sequenceLength);
     auto map = model::Map(model, { { "input", inputNode } }, { { "output", gruNode->output } });
 
     TestWithSerialization(map, "TestGRUNode", [&](model::Map& map, int iteration) {
@@ -814,7 +912,7 @@ void TestGRUNode()
         auto compiledMap = compiler.Compile(map);
         auto name = gruNode->GetRuntimeTypeName();
 
-        std::vector<std::vector<ElementType>> signal = { input.ToArray() };
+        std::vector<std::vector<ElementType>> signal = { input };
         map.SetInputValue(0, signal[0]);
         std::vector<ElementType> computedResult = map.ComputeOutput<ElementType>(0);
         if (IsEqual(computedResult, std::vector<ElementType>(computedResult.size()), static_cast<double>(epsilon)))
@@ -829,19 +927,25 @@ void TestGRUNode()
         }
 
         // test statefulness of the GRU node
-        for (size_t i = 0; i < 3; i++)
+        for (size_t i = 0; i < 3; i += sequenceLength)
         {
-            ConstVectorReference expectedOutput(h_t[i], sizeof(h_1) / sizeof(double));
+            std::vector<ElementType> expectedOutput;
+            for (size_t step = i; step < i + sequenceLength; ++step)
+            {
+                expectedOutput.insert(expectedOutput.end(), h_t[step], h_t[step] + sizeof(h_1) / sizeof(double));
+            }
 
-            std::string message = name + utilities::FormatString(" iteration %d row %d", iteration, i);
+            std::string message = name + utilities::FormatString(" iteration %d row %d sequence length %d", iteration, i, sequenceLength) + (constantWeights ? "" : " with input weights");
 
             // compare computed vs. compiled output
-            VerifyCompiledOutputAndResult<ElementType, ElementType>(map, compiledMap, signal, { expectedOutput.ToArray() }, message);
+            VerifyCompiledOutputAndResult<ElementType, ElementType>(map, compiledMap, signal, { expectedOutput }, message);
         }
     });
 }
 
-void TestLSTMNode()
+// With a sequence length greater than 1, the input is the same frame repeated, so the outputs are the hidden states of consecutive steps.
+// If `constantWeights` is false, the weights and biases are appended to the map's input instead of coming from constant nodes.
+void TestLSTMNode(size_t sequenceLength, bool constantWeights)
 {
     using ElementType = double;
     using namespace ell::predictors;
@@ -864,8 +968,12 @@ void TestLSTMNode()
     size_t hiddenSize = 4;
     double epsilon = 1e-5;
 
-    ConstVectorReference input(x_t, sizeof(x_t) / sizeof(double));
-    size_t inputSize = input.Size();
+    std::vector<ElementType> input;
+    for (size_t frame = 0; frame < sequenceLength; ++frame)
+    {
+        input.insert(input.end(), std::begin(x_t), std::end(x_t));
+    }
+    size_t inputSize = input.size();
     ConstVectorReference inputWeights(w_i, sizeof(w_i) / sizeof(double));
     ConstVectorReference hiddenWeights(w_h, sizeof(w_h) / sizeof(double));
     ConstVectorReference inputBias(b_i, sizeof(b_i) / sizeof(double));
@@ -873,13 +981,39 @@ void TestLSTMNode()
 
     // Create model
     model::Model model;
-    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputSize);
     auto resetTriggerNode = model.AddNode<nodes::ConstantNode<int>>(0);
-    auto inputWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputWeights.ToArray());
-    auto hiddenWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenWeights.ToArray());
-    auto inputBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputBias.ToArray());
-    auto hiddenBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenBias.ToArray());
-    auto lstmNode = model.AddNode<nodes::LSTMNode<ElementType>>(inputNode->output, resetTriggerNode->output, hiddenSize, inputWeightsNode->output, hiddenWeightsNode->output, inputBiasNode->output, hiddenBiasNode->output, ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::TanhActivation<ElementType>()), ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::SigmoidActivation<ElementType>()));
+    model::InputNode<ElementType>* inputNode = nullptr;
+    model::PortElements<ElementType> frame, inputWeightsElements, hiddenWeightsElements, inputBiasElements, hiddenBiasElements;
+    if (constantWeights)
+    {
+        inputNode = model.AddNode<model::InputNode<ElementType>>(inputSize);
+        frame = { inputNode->output };
+        inputWeightsElements = { model.AddNode<nodes::ConstantNode<ElementType>>(inputWeights.ToArray())->output };
+        hiddenWeightsElements = { model.AddNode<nodes::ConstantNode<ElementType>>(hiddenWeights.ToArray())->output };
+        inputBiasElements = { model.AddNode<nodes::ConstantNode<ElementType>>(inputBias.ToArray())->output };
+        hiddenBiasElements = { model.AddNode<nodes::ConstantNode<ElementType>>(hiddenBias.ToArray())->output };
+    }
+    else
+    {
+        // Route the weights and biases from the input, so the node can't pack them at compile time
+        for (auto values : { inputWeights, hiddenWeights, inputBias, hiddenBias })
+        {
+            input.insert(input.end(), values.GetConstDataPointer(), values.GetConstDataPointer() + values.Size());
+        }
+        inputNode = model.AddNode<model::InputNode<ElementType>>(input.size());
+        size_t offset = 0;
+        auto nextRange = [&](size_t size) {
+            model::PortElements<ElementType> elements(inputNode->output, offset, size);
+            offset += size;
+            return elements;
+        };
+        frame = nextRange(inputSize);
+        inputWeightsElements = nextRange(inputWeights.Size());
+        hiddenWeightsElements = nextRange(hiddenWeights.Size());
+        inputBiasElements = nextRange(inputBias.Size());
+        hiddenBiasElements = nextRange(hiddenBias.Size());
+    }
+    auto lstmNode = model.AddNode<nodes::LSTMNode<ElementType>>(frame, resetTriggerNode->output, hiddenSize, inputWeightsElements, hiddenWeightsElements, inputBiasElements, hiddenBiasElements, ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::TanhActivation<ElementType>()), ell::predictors::neural::Activation<ElementType>(new ell::predictors::neural::SigmoidActivation<ElementType>()), true, sequenceLength);
     auto map = model::Map(model, { { "input", inputNode } }, { { "output", lstmNode->output } });
 
     TestWithSerialization(map, "TestLSTMNode", [&](model::Map& map, int iteration) {
@@ -891,7 +1025,7 @@ void TestLSTMNode()
         auto compiledMap = compiler.Compile(map);
         auto name = lstmNode->GetRuntimeTypeName();
 
-        std::vector<std::vector<ElementType>> signal = { input.ToArray() };
+        std::vector<std::vector<ElementType>> signal = { input };
         map.SetInputValue(0, signal[0]);
         std::vector<ElementType> computedResult = map.ComputeOutput<ElementType>(0);
         if (IsEqual(computedResult, std::vector<ElementType>(computedResult.size()), static_cast<double>(epsilon)))
@@ -906,14 +1040,18 @@ void TestLSTMNode()
         }
 
         // test statefulness of the LSTM node
-        for (size_t i = 0; i < 3; i++)
+        for (size_t i = 0; i < 3; i += sequenceLength)
         {
-            ConstVectorReference expectedOutput(h_t[i], sizeof(h_1) / sizeof(double));
+            std::vector<ElementType> expectedOutput;
+            for (size_t step = i; step < i + sequenceLength; ++step)
+            {
+                expectedOutput.insert(expectedOutput.end(), h_t[step], h_t[step] + sizeof(h_1) / sizeof(double));
+            }
 
-            std::string message = name + utilities::FormatString(" iteration %d row %d", iteration, i);
+            std::string message = name + utilities::FormatString(" iteration %d row %d sequence length %d", iteration, i, sequenceLength) + (constantWeights ? "" : " with input weights");
 
             // compare computed vs. compiled output
-            VerifyCompiledOutputAndResult<ElementType, ElementType>(map, compiledMap, signal, { expectedOutput.ToArray() }, message);
+            VerifyCompiledOutputAndResult<ElementType, ElementType>(map, compiledMap, signal, { expectedOutput }, message);
         }
     });
 }
@@ -924,8 +1062,14 @@ void TestLSTMNode()
 void TestDSPNodes(const std::string& path)
 {
     TestRNNNode();
-    TestGRUNode();
-    TestLSTMNode();
+    TestGRUNode(1, true);
+    TestGRUNode(3, true);
+    TestGRUNode(1, false);
+    TestGRUNode(3, false);
+    TestLSTMNode(1, true);
+    TestLSTMNode(3, true);
+    TestLSTMNode(1, false);
+    TestLSTMNode(3, false);
 
     //
     // Compute tests
@@ -954,6 +1098,8 @@ void TestDSPNodes(const std::string& path)
     // TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::diagonal); // ERROR: diagonal test currently broken
     TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::unrolled);
     TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::winograd);
+    TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::depthwise);
 
     // Test simple convolution
     TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple);
@@ -995,6 +1141,20 @@ void TestDSPNodes(const std::string& path)
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled);
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::unrolled);
 
+    // Test blocked convolution
+    TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 3, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 1 }, { 2, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 7, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 8, 8, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeCompileVsReference<float>({ 16, 16, 3 }, { 5, 5, 5, 0 }, 2, dsp::ConvolutionMethodOption::blocked);
+    TestConvolutionNodeRejectsUnpaddedInput<float>(dsp::ConvolutionMethodOption::blocked);
+
     // Test Winograd convolution with tile size 2
     TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     TestConvolutionNodeCompileVsReference<float>({ 2, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
@@ -1071,6 +1231,44 @@ void TestDSPNodes(const std::string& path)
     TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 4, dsp::WinogradFilterOrder::filtersFirst });
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 4, dsp::WinogradFilterOrder::filtersFirst });
 
+    // Test Winograd convolution with tile size 6
+    TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 2, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 3, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 3, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 1 }, { 2, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 5, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 4, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 1 }, { 2, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 7, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 8, 8, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::tilesFirst });
+    // TestConvolutionNodeCompileVsReference<float>({120, 80, 8}, {16, 3, 3, 0}, 2, dsp::ConvolutionMethodOption::winograd, {6, dsp::WinogradFilterOrder::tilesFirst}); // Commented-out because Winograd doesn't support non-1 stride
+
+    TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 2, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 3, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 3, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 1 }, { 2, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 4, 5, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 4, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 1 }, { 2, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 7, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 8, 8, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 6, dsp::WinogradFilterOrder::filtersFirst });
+
     //
     // Depthwise-separable convolution tests
     //
@@ -1126,4 +1324,15 @@ void TestDSPNodes(const std::string& path)
     TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::winograd, { 4, dsp::WinogradFilterOrder::filtersFirst });
     TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::winograd, { 4, dsp::WinogradFilterOrder::filtersFirst });
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 8, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::winograd, { 4, dsp::WinogradFilterOrder::filtersFirst });
+
+    // Test depthwise convolution
+    TestConvolutionNodeCompileVsReference<float>({ 2, 2, 2 }, { 2, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 4, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 8, 8, 8 }, { 8, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 10 }, { 10, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 64, 64, 8 }, { 8, 3, 3, 1 }, 2, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 16 }, { 16, 3, 3, 1 }, 2, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 16, 16, 12 }, { 12, 5, 5, 1 }, 1, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeCompileVsReference<float>({ 16, 16, 12 }, { 12, 5, 5, 1 }, 2, dsp::ConvolutionMethodOption::depthwise);
+    TestConvolutionNodeRejectsUnpaddedInput<float>(dsp::ConvolutionMethodOption::depthwise);
 }
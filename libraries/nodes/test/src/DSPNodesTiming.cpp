@@ -20,6 +20,8 @@
 #include <model/include/Model.h>
 #include <model/include/Node.h>
 
+#include <nodes/include/BlockedConvolutionNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
 #include <nodes/include/DiagonalConvolutionNode.h>
 #include <nodes/include/SimpleConvolutionNode.h>
 #include <nodes/include/UnrolledConvolutionNode.h>
@@ -101,6 +103,10 @@ std::string GetConvAlgName(dsp::ConvolutionMethodOption alg)
         return "diagonal";
     case dsp::ConvolutionMethodOption::winograd:
         return "winograd";
+    case dsp::ConvolutionMethodOption::blocked:
+        return "blocked";
+    case dsp::ConvolutionMethodOption::depthwise:
+        return "depthwise";
     }
     return "";
 }
@@ -138,6 +144,13 @@ auto TimeReferenceConvolution(const math::ChannelColumnRowTensor<ValueType>& sig
             volatile auto result = Convolve2DWinogradPretransformed(signal, transformedFilters, numFilters, tileSize, filterSize, order);
         }
     }
+    else if (algorithm == dsp::ConvolutionMethodOption::depthwise)
+    {
+        for (int iter = 0; iter < numIterations; ++iter)
+        {
+            volatile auto result = Convolve2DDepthwiseSeparable(signal, filters, static_cast<int>(numFilters), algorithm);
+        }
+    }
     else
     {
         for (int iter = 0; iter < numIterations; ++iter)
@@ -202,6 +215,12 @@ static void TimeConvolutionNode(ImageShape inputShape, FiltersShape filterShape,
     case dsp::ConvolutionMethodOption::winograd:
         outputNode = model.AddNode<nodes::WinogradConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride, options.winogradOptions.tileSize, options.winogradOptions.filterOrder);
         break;
+    case dsp::ConvolutionMethodOption::blocked:
+        outputNode = model.AddNode<nodes::BlockedConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        break;
+    case dsp::ConvolutionMethodOption::depthwise:
+        outputNode = model.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(inputNode->output, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        break;
     }
 
     auto map = model::Map(model, { { "input", inputNode } }, { { "output", model::PortElementsBase(*(outputNode->GetOutputPort(0))) } });
@@ -220,6 +239,7 @@ static void TimeConvolutionNode(ImageShape inputShape, FiltersShape filterShape,
     settings.compilerSettings.optimize = true;
     settings.compilerSettings.useBlas = true;
     settings.compilerSettings.parallelize = false;
+    settings.compilerSettings.allowVectorInstructions = (convolutionMethod == dsp::ConvolutionMethodOption::blocked) || (convolutionMethod == dsp::ConvolutionMethodOption::depthwise);
     settings.verifyJittedModule = true;
     model::ModelOptimizerOptions optimizerOptions;
     model::IRMapCompiler compiler(settings, optimizerOptions);
@@ -245,6 +265,69 @@ static void TimeConvolutionNode(ImageShape inputShape, FiltersShape filterShape,
               << "(reference: " << referenceTime << " ms)\n";
 }
 
+// Times a stack of convolution layers from compilation to the first result, and then in steady state
+template <typename ValueType>
+void TimeConvolutionStackJit(int size, int numLayers, int numIterations, bool lazyJit, int optimizerThreads = 1)
+{
+    using Tensor = math::ChannelColumnRowTensor<ValueType>;
+    const int filterSize = 3;
+    const int padding = 1;
+    const int stride = 1;
+    const int inputChannels = 4;
+
+    // Each layer has a different number of filters, so each one is compiled into its own node function
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>((size + 2 * padding) * (size + 2 * padding) * inputChannels);
+    const model::OutputPort<ValueType>* layerOutput = &inputNode->output;
+    int numChannels = inputChannels;
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+        int numFilters = inputChannels + layer;
+        auto inputMemoryLayout = CalculateMemoryLayout(size, size, numChannels, padding);
+        auto outputMemoryLayout = CalculateMemoryLayout(size, size, numFilters, layer + 1 < numLayers ? padding : 0);
+        auto filter = std::vector<ValueType>(numFilters * filterSize * filterSize * numChannels);
+        FillRandomVector(filter);
+        auto filterWeights = Tensor(numFilters * filterSize, filterSize, numChannels, filter);
+        auto convolutionNode = model.AddNode<nodes::UnrolledConvolutionNode<ValueType>>(*layerOutput, inputMemoryLayout, outputMemoryLayout, filterWeights, stride);
+        layerOutput = &convolutionNode->output;
+        numChannels = numFilters;
+    }
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", *layerOutput } });
+
+    auto data = std::vector<ValueType>(inputNode->Size());
+    FillRandomVector(data);
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimize = true;
+    settings.compilerSettings.useBlas = true;
+    settings.compilerSettings.parallelize = false;
+    settings.compilerSettings.optimizerThreads = optimizerThreads;
+    settings.lazyJit = lazyJit;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+
+    utilities::MillisecondTimer timer;
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue(0, data);
+    volatile auto firstResult = compiledMap.ComputeOutput<ValueType>(0);
+    auto firstResultTime = timer.Elapsed();
+
+    // Don't let background compilation slow down the steady-state timing
+    compiledMap.GetJitter().CompileLazyFunctions();
+
+    timer.Reset();
+    for (int index = 0; index < numIterations; ++index)
+    {
+        compiledMap.SetInputValue(0, data);
+        volatile auto compiledResult = compiledMap.ComputeOutput<ValueType>(0);
+    }
+    auto compiledTime = timer.Elapsed();
+
+    std::cout << (lazyJit ? "Lazy" : "Eager") << " JIT of " << numLayers << " convolution layers on " << size << " x " << size << " inputs, optimized on " << optimizerThreads << " threads (0: one per core): "
+              << "time to first result: " << firstResultTime << " ms\t"
+              << "total time for " << numIterations << " iterations: " << compiledTime << " ms\n";
+}
+
 //
 // Main driver function to call all the timing functions
 //
@@ -255,36 +338,43 @@ void TimeDSPNodes()
     //
     TimeConvolutionNode<float>({ 240, 240, 3 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 240, 240, 3 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 240, 240, 3 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 240, 240, 3 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 100, 100, 16 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 100, 100, 16 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 100, 100, 16 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 100, 100, 16 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 32, 48, 64 }, { 256, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 32, 48, 64 }, { 256, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 32, 48, 64 }, { 256, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 32, 48, 64 }, { 256, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 64, 64, 64 }, { 64, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 64, 64, 64 }, { 64, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 64, 64, 64 }, { 64, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 64, 64, 64 }, { 64, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
     TimeConvolutionNode<float>({ 64, 64, 128 }, { 128, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::simple);
     TimeConvolutionNode<float>({ 64, 64, 128 }, { 128, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::unrolled);
+    TimeConvolutionNode<float>({ 64, 64, 128 }, { 128, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::blocked);
     TimeConvolutionNode<float>({ 64, 64, 128 }, { 128, 3, 3, 0 }, 10, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     std::cout << std::endl;
 
@@ -334,4 +424,18 @@ void TimeDSPNodes()
     TimeConvolutionNode<float>({ 127, 127, 8 }, { 8, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::filtersFirst });
     TimeConvolutionNode<float>({ 127, 127, 16 }, { 16, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::filtersFirst });
     TimeConvolutionNode<float>({ 127, 127, 32 }, { 32, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::filtersFirst });
+
+    std::cout << "Direct\n";
+    TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::simple);
+    TimeConvolutionNode<float>({ 64, 64, 16 }, { 16, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::depthwise);
+    TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::simple);
+    TimeConvolutionNode<float>({ 64, 64, 32 }, { 32, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::depthwise);
+    TimeConvolutionNode<float>({ 127, 127, 32 }, { 32, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::simple);
+    TimeConvolutionNode<float>({ 127, 127, 32 }, { 32, 3, 3, 1 }, 100, dsp::ConvolutionMethodOption::depthwise);
+
+    std::cout << "\n";
+    std::cout << "Eager vs. lazy JIT compilation\n";
+    TimeConvolutionStackJit<float>(64, 12, 100, false);
+    TimeConvolutionStackJit<float>(64, 12, 100, true);
+    TimeConvolutionStackJit<float>(64, 12, 100, false, 0);
 }
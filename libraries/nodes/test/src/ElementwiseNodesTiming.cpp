@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ElementwiseNodesTiming.cpp (nodes_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ElementwiseNodesTiming.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
+#include <model/include/Model.h>
+
+#include <nodes/include/ActivationLayerNode.h>
+#include <nodes/include/BinaryOperationNode.h>
+#include <nodes/include/BinaryPredicateNode.h>
+#include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <predictors/neural/include/ActivationLayer.h>
+#include <predictors/neural/include/ReLUActivation.h>
+
+#include <utilities/include/MillisecondTimer.h>
+#include <utilities/include/RandomEngines.h>
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace nodes;
+
+namespace
+{
+using ElementType = float;
+
+// The innermost dimension isn't a multiple of the vector widths, so the remainder loops are included in the timings
+const int c_rows = 64;
+const int c_columns = 64;
+const int c_channels = 17;
+
+// Adds the node being timed to a model, and returns its output
+using AddNodeFunction = std::function<model::PortElementsBase(model::Model& model, const model::OutputPort<ElementType>& input)>;
+
+std::vector<ElementType> GetRandomVector(size_t size)
+{
+    auto randomEngine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<ElementType> uniform(-2, 2);
+    std::vector<ElementType> result(size);
+    for (auto& value : result)
+    {
+        value = uniform(randomEngine);
+    }
+    return result;
+}
+
+model::MemoryShape GetShape()
+{
+    return { c_rows, c_columns, c_channels };
+}
+
+template <typename OutputType>
+void TimeElementwiseNode(const std::string& name, AddNodeFunction addNode, int numIterations)
+{
+    auto input = GetRandomVector(c_rows * c_columns * c_channels);
+    for (int vectorWidth : { 1, 4, 8, 16 })
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(GetShape());
+        auto output = addNode(model, inputNode->output);
+        auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.optimize = true;
+        settings.compilerSettings.parallelize = false;
+        settings.compilerSettings.allowVectorInstructions = vectorWidth > 1;
+        settings.compilerSettings.vectorWidth = vectorWidth;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+
+        // Warm up
+        compiledMap.SetInputValue(0, input);
+        volatile auto warmupResult = compiledMap.ComputeOutput<OutputType>(0);
+
+        utilities::MillisecondTimer timer;
+        for (int iteration = 0; iteration < numIterations; ++iteration)
+        {
+            compiledMap.SetInputValue(0, input);
+            volatile auto compiledResult = compiledMap.ComputeOutput<OutputType>(0);
+        }
+        auto duration = timer.Elapsed();
+
+        auto widthName = vectorWidth == 1 ? std::string("scalar") : "vector width " + std::to_string(vectorWidth);
+        std::cout << "Total time for " << numIterations << " iterations of " << name << " (" << widthName << "): " << duration << " ms\n";
+    }
+}
+} // namespace
+
+void TimeElementwiseNodes()
+{
+    const int numIterations = 200;
+    const auto constantValues = GetRandomVector(c_rows * c_columns * c_channels);
+
+    for (auto operation : { UnaryOperationType::abs, UnaryOperationType::sigmoid, UnaryOperationType::tanh })
+    {
+        auto addUnaryOperationNode = [operation](model::Model& model, const model::OutputPort<ElementType>& input) {
+            return model::PortElementsBase(model.AddNode<UnaryOperationNode<ElementType>>(input, operation)->output);
+        };
+        TimeElementwiseNode<ElementType>("UnaryOperationNode<" + ToString(operation) + ">", addUnaryOperationNode, numIterations);
+    }
+
+    auto addBinaryOperationNode = [&constantValues](model::Model& model, const model::OutputPort<ElementType>& input) {
+        auto constantNode = model.AddNode<ConstantNode<ElementType>>(constantValues, GetShape());
+        return model::PortElementsBase(model.AddNode<BinaryOperationNode<ElementType>>(input, constantNode->output, BinaryOperationType::multiply)->output);
+    };
+    TimeElementwiseNode<ElementType>("BinaryOperationNode<multiply>", addBinaryOperationNode, numIterations);
+
+    auto addBinaryPredicateNode = [&constantValues](model::Model& model, const model::OutputPort<ElementType>& input) {
+        auto constantNode = model.AddNode<ConstantNode<ElementType>>(constantValues, GetShape());
+        return model::PortElementsBase(model.AddNode<BinaryPredicateNode<ElementType>>(input, constantNode->output, BinaryPredicateType::greater)->output);
+    };
+    TimeElementwiseNode<bool>("BinaryPredicateNode<greater>", addBinaryPredicateNode, numIterations);
+
+    auto addBroadcastLinearFunctionNode = [](model::Model& model, const model::OutputPort<ElementType>& input) {
+        const size_t channelDimension = 2;
+        auto scaleNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(c_channels));
+        auto biasNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(c_channels));
+        return model::PortElementsBase(model.AddNode<BroadcastLinearFunctionNode<ElementType>>(input, input.GetMemoryLayout(), scaleNode->output, biasNode->output, channelDimension, input.GetMemoryLayout())->output);
+    };
+    TimeElementwiseNode<ElementType>("BroadcastLinearFunctionNode", addBroadcastLinearFunctionNode, numIterations);
+
+    auto addActivationLayerNode = [](model::Model& model, const model::OutputPort<ElementType>& input) {
+        using namespace predictors::neural;
+        typename Layer<ElementType>::TensorType layerInput(c_rows, c_columns, c_channels);
+        typename Layer<ElementType>::LayerParameters layerParameters{ layerInput, NoPadding(), { c_rows, c_columns, c_channels }, NoPadding() };
+        ActivationLayer<ElementType> layer(layerParameters, new ReLUActivation<ElementType>());
+        return model::PortElementsBase(model.AddNode<ActivationLayerNode<ElementType>>(input, layer)->output);
+    };
+    TimeElementwiseNode<ElementType>("ActivationLayerNode<ReLU>", addActivationLayerNode, numIterations);
+}
@@ -648,7 +648,7 @@ static void TestProtoNNPredictorNode()
 {
     size_t dim = 5, projectedDim = 4, numPrototypes = 3, numLabels = 2;
     double gamma = 0.3;
-    predictors::ProtoNNPredictor protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
+    predictors::ProtoNNPredictor<double> protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
 
     // projectedDim * dim
     auto W = protonnPredictor.GetProjectionMatrix().GetReference();
@@ -704,7 +704,7 @@ static void TestProtoNNPredictorNode()
 
     inputNode->SetInput(input);
 
-    auto protonnPredictorNode = model.AddNode<nodes::ProtoNNPredictorNode>(inputNode->output, protonnPredictor);
+    auto protonnPredictorNode = model.AddNode<nodes::ProtoNNPredictorNode<double>>(inputNode->output, protonnPredictor);
 
     model::ModelTransformer transformer;
     auto refinedModel = RefineModel(model, transformer);
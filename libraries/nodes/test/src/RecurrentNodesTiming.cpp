@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     RecurrentNodesTiming.cpp (nodes_test)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "RecurrentNodesTiming.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
+#include <model/include/Model.h>
+
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/GRUNode.h>
+#include <nodes/include/LSTMNode.h>
+
+#include <predictors/neural/include/SigmoidActivation.h>
+#include <predictors/neural/include/TanhActivation.h>
+
+#include <utilities/include/MillisecondTimer.h>
+#include <utilities/include/RandomEngines.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace nodes;
+
+namespace
+{
+using ElementType = float;
+
+// Sizes typical of streaming keyword spotting: one frame of 40 filter bank features per step
+const int c_inputSize = 40;
+const int c_hiddenUnits = 128;
+
+std::vector<ElementType> GetRandomVector(size_t size)
+{
+    auto randomEngine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<ElementType> uniform(-0.5, 0.5);
+    std::vector<ElementType> result(size);
+    for (auto& value : result)
+    {
+        value = uniform(randomEngine);
+    }
+    return result;
+}
+
+// Times the compiled node, and prints the average time per frame
+template <typename NodeType>
+void TimeRecurrentNode(const std::string& name, int numGates, int sequenceLength, bool useBlas, int numFrames)
+{
+    using ActivationType = predictors::neural::Activation<ElementType>;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(c_inputSize * sequenceLength);
+    auto resetTriggerNode = model.AddNode<ConstantNode<int>>(0);
+    auto inputWeightsNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(numGates * c_hiddenUnits * c_inputSize));
+    auto hiddenWeightsNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(numGates * c_hiddenUnits * c_hiddenUnits));
+    auto inputBiasNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(numGates * c_hiddenUnits));
+    auto hiddenBiasNode = model.AddNode<ConstantNode<ElementType>>(GetRandomVector(numGates * c_hiddenUnits));
+    auto activation = ActivationType(new predictors::neural::TanhActivation<ElementType>());
+    auto recurrentActivation = ActivationType(new predictors::neural::SigmoidActivation<ElementType>());
+    auto recurrentNode = model.AddNode<NodeType>(inputNode->output, resetTriggerNode->output, c_hiddenUnits, inputWeightsNode->output, hiddenWeightsNode->output, inputBiasNode->output, hiddenBiasNode->output, activation, recurrentActivation, true, sequenceLength);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", recurrentNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimize = true;
+    settings.compilerSettings.useBlas = useBlas;
+    settings.compilerSettings.parallelize = false;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    auto input = GetRandomVector(c_inputSize * sequenceLength);
+
+    // Warm up
+    compiledMap.SetInputValue(0, input);
+    volatile auto warmupResult = compiledMap.ComputeOutput<ElementType>(0);
+
+    const int numIterations = numFrames / sequenceLength;
+    utilities::MillisecondTimer timer;
+    for (int iteration = 0; iteration < numIterations; ++iteration)
+    {
+        compiledMap.SetInputValue(0, input);
+        volatile auto compiledResult = compiledMap.ComputeOutput<ElementType>(0);
+    }
+    auto duration = timer.Elapsed();
+
+    std::cout << name << " with " << c_hiddenUnits << " hidden units, " << sequenceLength << (sequenceLength == 1 ? " frame" : " frames") << " per call, " << (useBlas ? "BLAS" : "no BLAS") << ": "
+              << "total time for " << numIterations * sequenceLength << " frames: " << duration << " ms\t"
+              << "(" << 1000.0 * duration / (numIterations * sequenceLength) << " us per frame)\n";
+}
+} // namespace
+
+void TimeRecurrentNodes()
+{
+    const int numFrames = 4096;
+    for (bool useBlas : { false, true })
+    {
+        for (int sequenceLength : { 1, 8, 32 })
+        {
+            TimeRecurrentNode<LSTMNode<ElementType>>("LSTMNode", 4, sequenceLength, useBlas, numFrames);
+            TimeRecurrentNode<GRUNode<ElementType>>("GRUNode", 3, sequenceLength, useBlas, numFrames);
+        }
+        std::cout << std::endl;
+    }
+}
@@ -6,7 +6,10 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "BinaryConvolutionTiming.h"
 #include "DSPNodesTiming.h"
+#include "ElementwiseNodesTiming.h"
+#include "RecurrentNodesTiming.h"
 
 #include <testing/include/testing.h>
 
@@ -26,6 +29,9 @@ int main(int argc, char** argv)
     try
     {
         TimeDSPNodes();
+        TimeElementwiseNodes();
+        TimeRecurrentNodes();
+        TimeBinaryConvolutionNodes();
     }
     catch (const utilities::Exception& exception)
     {
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AssignMemoryLayoutsTransformation.h (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/Model.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+#include <cstddef>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> A transformation that chooses the dimension order of the data flowing through groups of
+    /// layout-agnostic nodes (elementwise nodes and `ReorderDataNode`s that only permute dimensions), so that as few
+    /// bytes as possible are copied by `ReorderDataNode`s.
+    ///
+    /// Each connected group of such nodes is assigned the single dimension order that minimizes the bytes reordered at
+    /// the group's boundary. The group's elementwise nodes are rewritten as `FusedElementwiseNode`s that work in that
+    /// order, its permuting reorders are removed, and reorders are inserted only where a node outside the group needs
+    /// the data in a different order. Groups are rewritten only if that reduces the total number of bytes reordered.
+    ///
+    /// Only elementwise nodes and permuting reorders are treated as layout-agnostic. Every other node reads and writes
+    /// the order it was built with, so it's a fixed boundary of the groups around it: the pass never changes the order
+    /// such a node consumes or produces, it only avoids reordering data on the way to or from it. For instance, a
+    /// refined `BinaryConvolutionalLayerNode` writes channel-major (f x h x w) output and then permutes it to row-major
+    /// order; if the nodes after it can work in channel-major order, that permutation is removed. </summary>
+    class AssignMemoryLayoutsTransformation : public ell::model::Transformation
+    {
+    public:
+        /// <summary> Assign memory layouts to the layout-agnostic nodes in the submodel. </summary>
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "AssignMemoryLayoutsTransformation"; }
+    };
+
+    /// <summary> Returns the number of bytes read and written by all the `ReorderDataNode`s in a model. </summary>
+    ///
+    /// <param name="model"> The model. </param>
+    /// <returns> The total size, in bytes, of the inputs and outputs of the model's `ReorderDataNode`s. </returns>
+    size_t GetReorderDataNodeBytes(const ell::model::Model& model);
+} // namespace passes
+} // namespace ell
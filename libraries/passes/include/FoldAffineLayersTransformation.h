@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldAffineLayersTransformation.h (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> A transformation that folds chains of batch normalization, scaling and bias layers into the weights of the
+    /// convolutional or fully-connected layer that precedes them. Any remaining per-channel offset is applied by a single
+    /// `BiasLayerNode`. </summary>
+    class FoldAffineLayersTransformation : public ell::model::Transformation
+    {
+    public:
+        /// <summary> Fold the affine layers following `ConvolutionalLayerNode`s and `FullyConnectedLayerNode`s, if possible. </summary>
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "FoldAffineLayersTransformation"; }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseElementwiseOperationsTransformation.h (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> A transformation that replaces chains of elementwise nodes (broadcast linear and activation functions,
+    /// unary operations, binary operations with a constant operand, and type casts) with a single `FusedElementwiseNode`,
+    /// so the intermediate results are never written to memory. </summary>
+    class FuseElementwiseOperationsTransformation : public ell::model::Transformation
+    {
+    public:
+        /// <summary> Fuse the chains of elementwise nodes in the submodel. </summary>
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseElementwiseOperationsTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
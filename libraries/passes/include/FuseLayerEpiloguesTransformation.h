@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseLayerEpiloguesTransformation.h (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> A transformation that fuses a bias layer and/or an activation layer (ReLU, leaky ReLU, parametric ReLU
+    /// or hard sigmoid) into the epilogue of the convolutional or fully-connected layer that precedes them, so the bias
+    /// and activation are applied as the layer writes its output instead of in separate passes over it. </summary>
+    class FuseLayerEpiloguesTransformation : public ell::model::Transformation
+    {
+    public:
+        /// <summary> Fuse the bias and activation layers following `ConvolutionalLayerNode`s and `FullyConnectedLayerNode`s, if possible. </summary>
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "FuseLayerEpiloguesTransformation"; }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TuneConvolutionMethodTransformation.h (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/MapCompilerOptions.h>
+#include <model/include/ModelOptimizerOptions.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> A transformation that chooses the convolution method for each `ConvolutionalLayerNode` empirically.
+    ///
+    /// Each convolutional layer is JIT-compiled on its own with every convolution method it's compatible with, and
+    /// timed on the host. The fastest method whose result matches the layer's reference output is recorded in the
+    /// node's "compileOptions" metadata as its "preferredConvolutionMethod", where `SetConvolutionMethodTransformation`
+    /// picks it up. Because the choice lives in the model, it's reused by later compiles of the model, including
+    /// cross-compiles for other targets. Layers that already have a preferred method in their metadata are left alone.
+    ///
+    /// This transformation isn't part of the standard set, because it compiles models itself: apply it to a map
+    /// before compiling the map. </summary>
+    class TuneConvolutionMethodTransformation : public model::Transformation
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="settings"> The compiler settings to tune the layers with. The layers are always compiled for the host. </param>
+        /// <param name="optimizerOptions"> The optimizer options to tune the layers with. </param>
+        /// <param name="numIterations"> The number of times to evaluate each layer with each method. </param>
+        TuneConvolutionMethodTransformation(const model::MapCompilerOptions& settings, const model::ModelOptimizerOptions& optimizerOptions, int numIterations = 10);
+
+        /// <summary> Record the fastest convolution method for the `ConvolutionalLayerNode`s in the submodel. </summary>
+        model::Submodel Transform(const model::Submodel& submodel, model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return { "TuneConvolutionMethodTransformation" }; };
+
+    private:
+        model::MapCompilerOptions _settings;
+        model::ModelOptimizerOptions _optimizerOptions;
+        int _numIterations;
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,603 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AssignMemoryLayoutsTransformation.cpp (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AssignMemoryLayoutsTransformation.h"
+
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/FusedElementwiseNode.h>
+#include <nodes/include/ReorderDataNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+//
+// Implementation
+//
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+template <typename Container, typename Value>
+bool Contains(const Container& container, const Value& value)
+{
+    return std::find(container.begin(), container.end(), value) != container.end();
+}
+
+size_t GetElementSize(const OutputPortBase& port)
+{
+    return port.GetType() == Port::PortType::smallReal ? sizeof(float) : sizeof(double);
+}
+
+// The number of bytes read and written by a reorder of `port` that keeps its memory size
+size_t GetReorderBytes(const OutputPortBase& port)
+{
+    return 2 * port.GetMemoryLayout().GetMemorySize() * GetElementSize(port);
+}
+
+template <typename ValueType>
+bool TryAddReorderDataNodeBytes(const Node& node, size_t& bytes)
+{
+    if (auto reorderNode = dynamic_cast<const nodes::ReorderDataNode<ValueType>*>(&node))
+    {
+        bytes += (reorderNode->GetInputMemoryLayout().GetMemorySize() + reorderNode->GetOutputMemoryLayout().GetMemorySize()) * sizeof(ValueType);
+        return true;
+    }
+    return false;
+}
+
+enum class LayoutNodeKind
+{
+    fixed, // a node that requires its input and output in the order they're in now
+    elementwise, // an elementwise node, which can work in any order
+    permutation, // a ReorderDataNode that only changes the order of its input's dimensions
+    conversion // any other ReorderDataNode, which can read and write any order
+};
+
+struct LayoutNode
+{
+    LayoutNodeKind kind = LayoutNodeKind::fixed;
+    const OutputPortBase* input = nullptr;
+    const OutputPortBase* output = nullptr;
+    int region = -1;
+};
+
+// A connected group of elementwise and permutation nodes, all of which will work in the same order
+struct LayoutRegion
+{
+    std::vector<const Node*> members;
+    DimensionOrder order;
+    bool rewrite = false;
+};
+
+// Classifies the nodes a region can be made of. Any other node (a convolution layer, say) keeps the layout it was
+// built with, and only bounds the regions next to it.
+template <typename ValueType>
+bool TryGetLayoutNode(const Node& node, LayoutNode& layoutNode)
+{
+    if (auto reorderNode = dynamic_cast<const nodes::ReorderDataNode<ValueType>*>(&node))
+    {
+        const auto& input = reorderNode->input.GetReferencedPort();
+        auto inputLayout = reorderNode->GetInputMemoryLayout();
+        auto outputLayout = reorderNode->GetOutputMemoryLayout();
+        if (inputLayout == input.GetMemoryLayout())
+        {
+            auto isPermutation = outputLayout == inputLayout.ReorderedCopy(outputLayout.GetLogicalDimensionOrder());
+            layoutNode.kind = isPermutation ? LayoutNodeKind::permutation : LayoutNodeKind::conversion;
+            layoutNode.input = &input;
+            layoutNode.output = &reorderNode->output;
+        }
+        return true;
+    }
+
+    nodes::ElementwiseNodeInfo<ValueType> info;
+    if (nodes::TryGetElementwiseNodeInfo(node, info))
+    {
+        // The node must read and write its ports' own layouts, and visit its input and output in the same order
+        const auto& inputLayout = info.inputLayout;
+        const auto& outputLayout = info.outputLayout;
+        if (inputLayout.NumDimensions() > 1 &&
+            inputLayout == info.input->GetMemoryLayout() &&
+            outputLayout == info.output->GetMemoryLayout() &&
+            inputLayout.GetLogicalDimensionOrder() == outputLayout.GetLogicalDimensionOrder())
+        {
+            layoutNode.kind = LayoutNodeKind::elementwise;
+            layoutNode.input = info.input;
+            layoutNode.output = info.output;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+LayoutNode ClassifyNode(const Node& node)
+{
+    LayoutNode layoutNode;
+    if (!TryGetLayoutNode<float>(node, layoutNode))
+    {
+        TryGetLayoutNode<double>(node, layoutNode);
+    }
+    return layoutNode;
+}
+
+bool IsMember(const LayoutNode& node)
+{
+    return node.kind == LayoutNodeKind::elementwise || node.kind == LayoutNodeKind::permutation;
+}
+
+int FindRoot(std::vector<int>& parents, int index)
+{
+    while (parents[index] != index)
+    {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+
+// Returns the index of the active entry at `physicalCoordinates` when the active area of `layout` is visited in physical order
+int GetActiveEntryIndex(const PortMemoryLayout& layout, const MemoryCoordinates& physicalCoordinates)
+{
+    const auto& activeSize = layout.GetActiveSize();
+    int index = 0;
+    for (int dimension = 0; dimension < activeSize.NumDimensions(); ++dimension)
+    {
+        index = (index * activeSize[dimension]) + physicalCoordinates[dimension];
+    }
+    return index;
+}
+
+// Rewrites the steps of an elementwise node that reads `oldLayout` so they can be applied to `newLayout`, which has the
+// same logical shape in a different order
+template <typename ValueType>
+std::vector<nodes::ElementwiseStep<ValueType>> PermuteSteps(const std::vector<nodes::ElementwiseStep<ValueType>>& steps, const PortMemoryLayout& oldLayout, const PortMemoryLayout& newLayout)
+{
+    auto result = steps;
+    for (size_t stepIndex = 0; stepIndex < result.size(); ++stepIndex)
+    {
+        auto& step = result[stepIndex];
+        if (step.type != nodes::ElementwiseStepType::binaryOperation || step.operand.size() == 1)
+        {
+            continue;
+        }
+
+        if (step.operandDimension != nodes::ElementwiseStep<ValueType>::allDimensions)
+        {
+            step.operandDimension = newLayout.GetPhysicalDimension(oldLayout.GetLogicalDimension(step.operandDimension));
+            continue;
+        }
+
+        // Visit the active entries in the new physical order, and find where each one was in the old order
+        const auto& activeSize = newLayout.GetActiveSize();
+        const int numDimensions = activeSize.NumDimensions();
+        std::vector<int> coordinates(numDimensions, 0);
+        for (size_t entryIndex = 0; entryIndex < step.operand.size(); ++entryIndex)
+        {
+            auto logicalCoordinates = newLayout.GetLogicalCoordinates(coordinates);
+            step.operand[entryIndex] = steps[stepIndex].operand[GetActiveEntryIndex(oldLayout, oldLayout.GetPhysicalCoordinates(logicalCoordinates))];
+            for (int dimension = numDimensions - 1; dimension >= 0; --dimension)
+            {
+                if (++coordinates[dimension] < activeSize[dimension])
+                {
+                    break;
+                }
+                coordinates[dimension] = 0;
+            }
+        }
+    }
+    return result;
+}
+
+class LayoutAssignment
+{
+public:
+    LayoutAssignment(const Submodel& submodel, const MapCompiler* compiler) :
+        _submodelOutputs(submodel.GetOutputs())
+    {
+        FindNodes(submodel, compiler);
+        FindRegions();
+        for (auto& region : _regions)
+        {
+            ChooseOrder(region);
+        }
+    }
+
+    void TransformNode(const Node& node, ModelTransformer& transformer)
+    {
+        if (TryTransformNode<float>(node, transformer) || TryTransformNode<double>(node, transformer))
+        {
+            return;
+        }
+        transformer.CopyNode(node);
+    }
+
+private:
+    void FindNodes(const Submodel& submodel, const MapCompiler* compiler)
+    {
+        submodel.Visit([this, compiler](const Node& node) {
+            auto canAssignLayout = compiler == nullptr || compiler->GetModelOptimizerOptions(node).GetEntry<bool>("assignMemoryLayouts", true);
+            _nodes[&node] = canAssignLayout ? ClassifyNode(node) : LayoutNode{};
+        });
+    }
+
+    const LayoutNode* GetLayoutNode(const Node* node) const
+    {
+        auto it = _nodes.find(node);
+        return it == _nodes.end() ? nullptr : &it->second;
+    }
+
+    const LayoutNode* GetProducer(const OutputPortBase& port) const
+    {
+        return GetLayoutNode(port.GetNode());
+    }
+
+    void FindRegions()
+    {
+        std::vector<const Node*> members;
+        std::unordered_map<const Node*, int> memberIndices;
+        for (const auto& entry : _nodes)
+        {
+            if (IsMember(entry.second))
+            {
+                memberIndices[entry.first] = static_cast<int>(members.size());
+                members.push_back(entry.first);
+            }
+        }
+
+        std::vector<int> parents(members.size());
+        std::iota(parents.begin(), parents.end(), 0);
+        for (auto member : members)
+        {
+            auto producer = _nodes[member].input->GetNode();
+            auto it = memberIndices.find(producer);
+            if (it != memberIndices.end())
+            {
+                parents[FindRoot(parents, memberIndices[member])] = FindRoot(parents, it->second);
+            }
+        }
+
+        // Number the regions in the order their members were visited, so the transformation is deterministic
+        std::vector<const Node*> orderedMembers = members;
+        std::sort(orderedMembers.begin(), orderedMembers.end(), [](const Node* a, const Node* b) { return a->GetId() < b->GetId(); });
+        std::unordered_map<int, int> regionIndices;
+        for (auto member : orderedMembers)
+        {
+            auto root = FindRoot(parents, memberIndices[member]);
+            if (regionIndices.find(root) == regionIndices.end())
+            {
+                regionIndices[root] = static_cast<int>(_regions.size());
+                _regions.emplace_back();
+            }
+            auto regionIndex = regionIndices[root];
+            _nodes[member].region = regionIndex;
+            _regions[regionIndex].members.push_back(member);
+        }
+    }
+
+    bool IsSubmodelOutput(const OutputPortBase& port) const
+    {
+        return Contains(_submodelOutputs, &port);
+    }
+
+    // Returns true if the node producing `port` is a conversion that only feeds the given region, and so can write its
+    // output in whatever order the region uses
+    bool IsFlexibleSource(const OutputPortBase& port, int region) const
+    {
+        auto producer = GetProducer(port);
+        if (producer == nullptr || producer->kind != LayoutNodeKind::conversion || IsSubmodelOutput(port))
+        {
+            return false;
+        }
+
+        for (auto reference : port.GetReferences())
+        {
+            auto consumer = GetLayoutNode(reference->GetNode());
+            if (consumer == nullptr || !IsMember(*consumer) || consumer->region != region)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns true if `port`, the output of a region member, is read by something that needs it in its current order
+    bool IsNeededOutsideRegion(const OutputPortBase& port, int region) const
+    {
+        if (IsSubmodelOutput(port))
+        {
+            return true;
+        }
+
+        for (auto reference : port.GetReferences())
+        {
+            auto consumer = GetLayoutNode(reference->GetNode());
+            if (consumer == nullptr || consumer->kind == LayoutNodeKind::fixed || (IsMember(*consumer) && consumer->region != region))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsRegionInput(const OutputPortBase& port, int region) const
+    {
+        auto producer = GetProducer(port);
+        return producer == nullptr || !IsMember(*producer) || producer->region != region;
+    }
+
+    void ChooseOrder(LayoutRegion& region)
+    {
+        auto regionIndex = _nodes[region.members[0]].region;
+
+        size_t bytesBefore = 0;
+        std::set<const OutputPortBase*> inputs;
+        std::vector<const OutputPortBase*> outputs;
+        std::vector<DimensionOrder> candidates;
+        for (auto member : region.members)
+        {
+            const auto& node = _nodes[member];
+            if (node.kind == LayoutNodeKind::permutation)
+            {
+                bytesBefore += (node.input->GetMemoryLayout().GetMemorySize() + node.output->GetMemoryLayout().GetMemorySize()) * GetElementSize(*node.output);
+            }
+
+            if (IsRegionInput(*node.input, regionIndex) && !IsFlexibleSource(*node.input, regionIndex))
+            {
+                inputs.insert(node.input);
+            }
+
+            if (IsNeededOutsideRegion(*node.output, regionIndex))
+            {
+                outputs.push_back(node.output);
+            }
+
+            for (auto port : { node.input, node.output })
+            {
+                auto order = port->GetMemoryLayout().GetLogicalDimensionOrder();
+                if (!Contains(candidates, order))
+                {
+                    candidates.push_back(order);
+                }
+            }
+        }
+
+        if (bytesBefore == 0)
+        {
+            return;
+        }
+
+        auto bestBytes = std::numeric_limits<size_t>::max();
+        for (const auto& order : candidates)
+        {
+            size_t bytes = 0;
+            for (auto port : inputs)
+            {
+                bytes += port->GetMemoryLayout().GetLogicalDimensionOrder() == order ? 0 : GetReorderBytes(*port);
+            }
+            for (auto port : outputs)
+            {
+                bytes += port->GetMemoryLayout().GetLogicalDimensionOrder() == order ? 0 : GetReorderBytes(*port);
+            }
+
+            if (bytes < bestBytes)
+            {
+                bestBytes = bytes;
+                region.order = order;
+            }
+        }
+
+        region.rewrite = bestBytes < bytesBefore;
+        if (region.rewrite)
+        {
+            Log() << "Assigning a common memory layout to " << region.members.size() << " nodes, reducing the bytes reordered from " << bytesBefore << " to " << bestBytes << EOL;
+        }
+    }
+
+    const LayoutRegion* GetRewrittenRegion(const Node& node) const
+    {
+        auto layoutNode = GetLayoutNode(&node);
+        if (layoutNode == nullptr || !IsMember(*layoutNode) || !_regions[layoutNode->region].rewrite)
+        {
+            return nullptr;
+        }
+        return &_regions[layoutNode->region];
+    }
+
+    // Returns the new version of `port`, with its dimensions in the given order
+    template <typename ValueType>
+    const OutputPort<ValueType>& GetRegionInput(const OutputPort<ValueType>& port, const DimensionOrder& order, ModelTransformer& transformer)
+    {
+        auto it = _regionPorts.find(&port);
+        if (it != _regionPorts.end())
+        {
+            return static_cast<const OutputPort<ValueType>&>(*it->second);
+        }
+
+        const auto& newPort = transformer.GetCorrespondingOutputs(port);
+        auto layout = newPort.GetMemoryLayout();
+        if (layout.GetLogicalDimensionOrder() == order)
+        {
+            return newPort;
+        }
+
+        auto key = std::make_pair(static_cast<const OutputPortBase*>(&newPort), order.ToVector());
+        auto reorderIt = _inputReorders.find(key);
+        if (reorderIt != _inputReorders.end())
+        {
+            return static_cast<const OutputPort<ValueType>&>(*reorderIt->second);
+        }
+
+        auto reorderNode = transformer.AddNode<nodes::ReorderDataNode<ValueType>>(newPort, layout, layout.ReorderedCopy(order));
+        _inputReorders[key] = &reorderNode->output;
+        return reorderNode->output;
+    }
+
+    // Maps `oldPort`, a region member's output, to its new version `newPort`, restoring its old layout if anything
+    // outside the region needs it
+    template <typename ValueType>
+    void MapRegionOutput(const OutputPort<ValueType>& oldPort, const OutputPort<ValueType>& newPort, ValueType padding, int region, ModelTransformer& transformer)
+    {
+        _regionPorts[&oldPort] = &newPort;
+        auto oldLayout = oldPort.GetMemoryLayout();
+        auto newLayout = newPort.GetMemoryLayout();
+        if (oldLayout == newLayout)
+        {
+            transformer.MapNodeOutput(oldPort, newPort);
+        }
+        else if (IsNeededOutsideRegion(oldPort, region))
+        {
+            auto restoreNode = transformer.AddNode<nodes::ReorderDataNode<ValueType>>(newPort, newLayout, oldLayout, padding);
+            transformer.MapNodeOutput(oldPort, restoreNode->output);
+        }
+    }
+
+    template <typename ValueType>
+    bool TryTransformNode(const Node& node, ModelTransformer& transformer)
+    {
+        if (auto region = GetRewrittenRegion(node))
+        {
+            auto regionIndex = _nodes[&node].region;
+            if (auto reorderNode = dynamic_cast<const nodes::ReorderDataNode<ValueType>*>(&node))
+            {
+                // A permutation inside the region isn't needed: its output is its input, in the region's order
+                const auto& newInput = GetRegionInput(reorderNode->input.GetReferencedPort(), region->order, transformer);
+                MapRegionOutput(reorderNode->output, newInput, reorderNode->GetPaddingValue(), regionIndex, transformer);
+                return true;
+            }
+
+            nodes::ElementwiseNodeInfo<ValueType> info;
+            if (nodes::TryGetElementwiseNodeInfo(node, info))
+            {
+                const auto& newInput = GetRegionInput(*info.input, region->order, transformer);
+                auto newInputLayout = newInput.GetMemoryLayout();
+                auto newOutputLayout = info.outputLayout.ReorderedCopy(region->order);
+                auto steps = PermuteSteps(info.steps, info.inputLayout, newInputLayout);
+                auto newNode = transformer.AddNode<nodes::FusedElementwiseNode<ValueType>>(newInput, newInputLayout, newOutputLayout, steps, info.padding);
+                newNode->GetMetadata() = node.GetMetadata();
+                MapRegionOutput(*info.output, newNode->output, info.padding, regionIndex, transformer);
+                return true;
+            }
+            return false;
+        }
+
+        if (auto reorderNode = dynamic_cast<const nodes::ReorderDataNode<ValueType>*>(&node))
+        {
+            // A conversion that reads a rewritten region, or that feeds one, reads and writes the region's order
+            const auto& input = reorderNode->input.GetReferencedPort();
+            auto regionInput = _regionPorts.find(&input);
+            const LayoutRegion* outputRegion = nullptr;
+            const auto& layoutNode = _nodes[&node];
+            if (layoutNode.kind == LayoutNodeKind::conversion && reorderNode->output.IsReferenced())
+            {
+                auto consumer = GetLayoutNode(reorderNode->output.GetReferences()[0]->GetNode());
+                if (consumer != nullptr && IsMember(*consumer) && _regions[consumer->region].rewrite && IsFlexibleSource(reorderNode->output, consumer->region))
+                {
+                    outputRegion = &_regions[consumer->region];
+                }
+            }
+
+            if (layoutNode.kind != LayoutNodeKind::conversion || (regionInput == _regionPorts.end() && outputRegion == nullptr))
+            {
+                transformer.CopyNode(node);
+                return true;
+            }
+
+            const auto& newInput = regionInput == _regionPorts.end() ? transformer.GetCorrespondingOutputs(input) : static_cast<const OutputPort<ValueType>&>(*regionInput->second);
+            auto newInputLayout = newInput.GetMemoryLayout();
+            auto outputLayout = reorderNode->GetOutputMemoryLayout();
+            if (outputRegion != nullptr)
+            {
+                outputLayout = outputLayout.ReorderedCopy(outputRegion->order);
+            }
+
+            const OutputPort<ValueType>* newOutput = &newInput;
+            if (newInputLayout != outputLayout)
+            {
+                newOutput = &transformer.AddNode<nodes::ReorderDataNode<ValueType>>(newInput, newInputLayout, outputLayout, reorderNode->GetPaddingValue())->output;
+            }
+
+            if (outputRegion != nullptr)
+            {
+                _regionPorts[&reorderNode->output] = newOutput;
+            }
+            else
+            {
+                transformer.MapNodeOutput(reorderNode->output, *newOutput);
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    std::vector<const OutputPortBase*> _submodelOutputs;
+    std::unordered_map<const Node*, LayoutNode> _nodes;
+    std::vector<LayoutRegion> _regions;
+
+    // The new versions of region ports, in their region's order
+    std::unordered_map<const OutputPortBase*, const OutputPortBase*> _regionPorts;
+
+    // The reorders we've added to bring region inputs into a region's order, keyed by the port and order
+    std::map<std::pair<const OutputPortBase*, std::vector<int>>, const OutputPortBase*> _inputReorders;
+};
+} // namespace
+
+//
+// AssignMemoryLayoutsTransformation methods
+//
+namespace ell
+{
+namespace passes
+{
+    Submodel AssignMemoryLayoutsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        LayoutAssignment layoutAssignment(submodel, context.GetCompiler());
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto result = transformer.TransformSubmodelOnto(submodel, onto, context, [&layoutAssignment](const Node& node, ModelTransformer& transformer) {
+            layoutAssignment.TransformNode(node, transformer);
+        });
+
+        return result;
+    }
+
+    size_t GetReorderDataNodeBytes(const Model& model)
+    {
+        size_t bytes = 0;
+        model.Visit([&bytes](const Node& node) {
+            if (!TryAddReorderDataNodeBytes<float>(node, bytes))
+            {
+                TryAddReorderDataNodeBytes<double>(node, bytes);
+            }
+        });
+        return bytes;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,330 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldAffineLayersTransformation.cpp (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FoldAffineLayersTransformation.h"
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/RefineTransformation.h>
+
+#include <nodes/include/BatchNormalizationLayerNode.h>
+#include <nodes/include/BiasLayerNode.h>
+#include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/ScalingLayerNode.h>
+
+#include <predictors/neural/include/BiasLayer.h>
+#include <predictors/neural/include/ConvolutionalLayer.h>
+#include <predictors/neural/include/FullyConnectedLayer.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+//
+// Implementation
+//
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool IsNeuralNetworkPredictorNode(const Node& node)
+{
+    return (node.GetRuntimeTypeName().find("NeuralNetworkPredictorNode") == 0);
+}
+
+//
+// Data structures
+//
+
+// The per-channel function f(x) = scale*x + bias computed by an affine layer
+template <typename ValueType>
+struct AffineCoefficients
+{
+    std::vector<ValueType> scale;
+    std::vector<ValueType> bias;
+};
+
+//
+// Functions
+//
+template <typename ValueType>
+bool TryGetAffineCoefficients(const Node& node, AffineCoefficients<ValueType>& coefficients)
+{
+    if (auto batchNormNode = dynamic_cast<const nodes::BatchNormalizationLayerNode<ValueType>*>(&node))
+    {
+        coefficients.scale = batchNormNode->GetLayer().GetScale().ToArray();
+        coefficients.bias = batchNormNode->GetLayer().GetBias().ToArray();
+        return true;
+    }
+
+    if (auto scalingNode = dynamic_cast<const nodes::ScalingLayerNode<ValueType>*>(&node))
+    {
+        coefficients.scale = scalingNode->GetLayer().GetScale().ToArray();
+        coefficients.bias = std::vector<ValueType>(coefficients.scale.size(), 0);
+        return true;
+    }
+
+    if (auto biasNode = dynamic_cast<const nodes::BiasLayerNode<ValueType>*>(&node))
+    {
+        coefficients.bias = biasNode->GetLayer().GetBias().ToArray();
+        coefficients.scale = std::vector<ValueType>(coefficients.bias.size(), 1);
+        return true;
+    }
+
+    return false;
+}
+
+// Here, we have two affine functions, f1(x) = s1*x + b1; f2(x) = s2*x + b2, and we want their composition
+// f2(f1(x)) = s2*s1*x + (s2*b1 + b2)
+template <typename ValueType>
+AffineCoefficients<ValueType> ComposeAffineCoefficients(const AffineCoefficients<ValueType>& first, const AffineCoefficients<ValueType>& second)
+{
+    AffineCoefficients<ValueType> result = first;
+    for (size_t index = 0; index < result.scale.size(); ++index)
+    {
+        result.scale[index] *= second.scale[index];
+        result.bias[index] = result.bias[index] * second.scale[index] + second.bias[index];
+    }
+    return result;
+}
+
+// Returns true if the node producing `port` may be rewritten: `port` must not be visible outside the submodel, and the
+// node's only consumer must be the layer we're folding into it
+bool IsFoldableOutput(const OutputPortBase& port, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts)
+{
+    const auto& outputs = submodel.GetOutputs();
+    if (std::find(outputs.begin(), outputs.end(), &port) != outputs.end() || std::find(boundaryPorts.begin(), boundaryPorts.end(), &port) != boundaryPorts.end())
+    {
+        return false;
+    }
+
+    return port.GetNode()->GetDependentNodes().size() == 1;
+}
+
+// Returns the layer parameters for the folded version of `layerNode`. If there's no bias left to add, the folded layer
+// writes its output directly with the output padding of `lastNode`, the last affine layer in the chain.
+template <typename ValueType>
+typename predictors::neural::Layer<ValueType>::LayerParameters GetFoldedLayerParameters(const nodes::NeuralNetworkLayerNodeBase<ValueType>& layerNode, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, bool hasBias)
+{
+    auto layerParameters = layerNode.GetLayerParameters();
+    if (!hasBias)
+    {
+        layerParameters.outputShape = lastNode.GetLayerParameters().outputShape;
+        layerParameters.outputPaddingParameters = lastNode.GetRequestedOutputPadding();
+    }
+    return layerParameters;
+}
+
+template <typename ValueType>
+bool HasNonzeroBias(const AffineCoefficients<ValueType>& coefficients)
+{
+    return std::any_of(coefficients.bias.begin(), coefficients.bias.end(), [](ValueType value) { return value != 0; });
+}
+
+// Adds the bias left over after folding the scale into `foldedNode`, and maps the output of `lastNode` to the result
+template <typename ValueType>
+void MapFoldedOutput(const nodes::NeuralNetworkLayerNodeBase<ValueType>& foldedNode, const AffineCoefficients<ValueType>& coefficients, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, ModelTransformer& transformer)
+{
+    if (!HasNonzeroBias(coefficients))
+    {
+        transformer.MapNodeOutput(lastNode.output, foldedNode.output);
+        return;
+    }
+
+    typename predictors::neural::Layer<ValueType>::LayerParameters biasParameters{ foldedNode.GetBaseLayer().GetOutput(),
+                                                                                  foldedNode.GetRequestedOutputPadding(),
+                                                                                  lastNode.GetLayerParameters().outputShape,
+                                                                                  lastNode.GetRequestedOutputPadding() };
+    predictors::neural::BiasLayer<ValueType> biasLayer(biasParameters, coefficients.bias);
+    auto biasNode = transformer.AddNode<nodes::BiasLayerNode<ValueType>>(foldedNode.output, biasLayer);
+    transformer.MapNodeOutput(lastNode.output, biasNode->output);
+}
+
+template <typename ValueType>
+bool TryFoldIntoConvolutionalLayer(const Node& node, const AffineCoefficients<ValueType>& coefficients, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, ModelTransformer& transformer)
+{
+    auto convNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+    // A fused epilogue is applied after the weights, so we can't fold an affine layer past it
+    if (convNode == nullptr || convNode->GetRequestedOutputPadding().paddingSize != 0 || !convNode->GetEpilogue().IsEmpty())
+    {
+        return false;
+    }
+
+    // The weights tensor stacks the filters along the row dimension, one block of `receptiveField` rows per filter
+    const auto& layer = convNode->GetLayer();
+    auto weights = layer.GetWeights();
+    const auto numFilters = coefficients.scale.size();
+    const auto rowsPerFilter = weights.NumRows() / numFilters;
+    for (size_t filter = 0; filter < numFilters; ++filter)
+    {
+        const auto scale = coefficients.scale[filter];
+        for (size_t row = filter * rowsPerFilter; row < (filter + 1) * rowsPerFilter; ++row)
+        {
+            for (size_t column = 0; column < weights.NumColumns(); ++column)
+            {
+                for (size_t channel = 0; channel < weights.NumChannels(); ++channel)
+                {
+                    weights(row, column, channel) *= scale;
+                }
+            }
+        }
+    }
+
+    auto layerParameters = GetFoldedLayerParameters(*convNode, lastNode, HasNonzeroBias(coefficients));
+    predictors::neural::ConvolutionalLayer<ValueType> newLayer(layerParameters, layer.GetConvolutionalParameters(), weights);
+    const auto& newInput = transformer.GetCorrespondingInputs(convNode->input);
+    auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(newInput, newLayer);
+    newNode->GetMetadata() = convNode->GetMetadata();
+
+    MapFoldedOutput(*newNode, coefficients, lastNode, transformer);
+    return true;
+}
+
+template <typename ValueType>
+bool TryFoldIntoFullyConnectedLayer(const Node& node, const AffineCoefficients<ValueType>& coefficients, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, ModelTransformer& transformer)
+{
+    auto fullyConnectedNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node);
+    if (fullyConnectedNode == nullptr || fullyConnectedNode->GetRequestedOutputPadding().paddingSize != 0 || !fullyConnectedNode->GetEpilogue().IsEmpty())
+    {
+        return false;
+    }
+
+    // Each row of the weights matrix computes one output, in logical (row, column, channel) order
+    const auto& layer = fullyConnectedNode->GetLayer();
+    auto weights = layer.GetWeights();
+    const auto numChannels = coefficients.scale.size();
+    for (size_t row = 0; row < weights.NumRows(); ++row)
+    {
+        const auto scale = coefficients.scale[row % numChannels];
+        for (size_t column = 0; column < weights.NumColumns(); ++column)
+        {
+            weights(row, column) *= scale;
+        }
+    }
+
+    auto layerParameters = GetFoldedLayerParameters(*fullyConnectedNode, lastNode, HasNonzeroBias(coefficients));
+    predictors::neural::FullyConnectedLayer<ValueType> newLayer(layerParameters, weights);
+    const auto& newInput = transformer.GetCorrespondingInputs(fullyConnectedNode->input);
+    auto newNode = transformer.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(newInput, newLayer);
+    newNode->GetMetadata() = fullyConnectedNode->GetMetadata();
+
+    MapFoldedOutput(*newNode, coefficients, lastNode, transformer);
+    return true;
+}
+
+// returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes
+template <typename ValueType>
+bool TryFoldAffineLayers(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    AffineCoefficients<ValueType> coefficients;
+    if (!TryGetAffineCoefficients(node, coefficients))
+    {
+        return false;
+    }
+
+    // Walk back through the chain of affine layers ending at this node, composing their functions, until we reach
+    // the layer they can be folded into. The nodes we've already rewritten for the earlier affine layers in the chain
+    // are left without consumers, and get removed when the model is pruned.
+    const auto& lastNode = static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>&>(node);
+    const nodes::NeuralNetworkLayerNodeBase<ValueType>* currentNode = &lastNode;
+    while (true)
+    {
+        const auto& inputPort = currentNode->input.GetReferencedPort();
+        if (!IsFoldableOutput(inputPort, submodel, boundaryPorts))
+        {
+            break;
+        }
+
+        const auto& inputNode = *inputPort.GetNode();
+        AffineCoefficients<ValueType> inputCoefficients;
+        if (TryGetAffineCoefficients(inputNode, inputCoefficients))
+        {
+            coefficients = ComposeAffineCoefficients(inputCoefficients, coefficients);
+            currentNode = static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>*>(&inputNode);
+            continue;
+        }
+
+        if (TryFoldIntoConvolutionalLayer(inputNode, coefficients, lastNode, transformer) ||
+            TryFoldIntoFullyConnectedLayer(inputNode, coefficients, lastNode, transformer))
+        {
+            Log() << "Folding affine layer " << node.GetId() << " into layer " << inputNode.GetId() << std::endl;
+            return true;
+        }
+        break;
+    }
+
+    transformer.CopyNode(node);
+    return true;
+}
+
+void FoldAffineLayers(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    if (TryFoldAffineLayers<float>(node, submodel, boundaryPorts, transformer) ||
+        TryFoldAffineLayers<double>(node, submodel, boundaryPorts, transformer))
+    {
+        return;
+    }
+    transformer.CopyNode(node);
+}
+} // namespace
+
+//
+// FoldAffineLayersTransformation methods
+//
+namespace ell
+{
+namespace passes
+{
+    Submodel FoldAffineLayersTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        // First refine any NeuralNetworkPredictorNodes, so we can see their layers
+        auto refineNNPredictorFn = [](const model::Node& node) {
+            return IsNeuralNetworkPredictorNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
+        };
+        model::TransformContext refineNNPredictorContext{ refineNNPredictorFn };
+        RefineTransformation refineTransformation;
+        auto refinedSubmodel = refineTransformation.Transform(submodel, transformer, refineNNPredictorContext);
+
+        auto onto = GetReferencedPorts(refinedSubmodel.GetInputs());
+        auto result = transformer.TransformSubmodelOnto(refinedSubmodel, onto, context, [compiler, &refinedSubmodel, &onto](const Node& node, ModelTransformer& transformer) {
+            bool canFoldLayers = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("foldAffineLayers", true);
+
+            if (canFoldLayers)
+            {
+                FoldAffineLayers(node, refinedSubmodel, onto, transformer);
+            }
+            else
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseElementwiseOperationsTransformation.cpp (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseElementwiseOperationsTransformation.h"
+
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/FusedElementwiseNode.h>
+#include <nodes/include/TypeCastNode.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+
+using namespace ell;
+using namespace ell::model;
+
+//
+// Implementation
+//
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+using nodes::ElementwiseNodeInfo;
+using nodes::TryGetElementwiseNodeInfo;
+
+//
+// Functions
+//
+
+// Returns true if the node's function doesn't depend on the position of the entries, other than through an
+// operand with a value per entry (which also works for any unpadded layout with the same number of entries)
+template <typename ValueType>
+bool IsLayoutIndependent(const ElementwiseNodeInfo<ValueType>& info)
+{
+    return std::all_of(info.steps.begin(), info.steps.end(), [](const auto& step) {
+        return step.operand.size() <= 1 || step.operandDimension == nodes::ElementwiseStep<ValueType>::allDimensions;
+    });
+}
+
+// Returns true if the node can be treated as if it computed on unpadded data with the given layout
+template <typename ValueType>
+bool CanReinterpretLayout(const ElementwiseNodeInfo<ValueType>& info, const PortMemoryLayout& layout)
+{
+    return IsLayoutIndependent(info) &&
+           info.inputLayout == info.outputLayout &&
+           !info.inputLayout.HasPadding() &&
+           !layout.HasPadding() &&
+           info.inputLayout.NumElements() == layout.NumElements();
+}
+
+// Combines the functions of two nodes, where the second one's input is the first one's output
+template <typename ValueType>
+bool TryMergeNodeInfo(ElementwiseNodeInfo<ValueType> first, ElementwiseNodeInfo<ValueType> second, ElementwiseNodeInfo<ValueType>& merged)
+{
+    if (second.inputLayout != first.outputLayout)
+    {
+        if (CanReinterpretLayout(second, first.outputLayout))
+        {
+            second.inputLayout = first.outputLayout;
+            second.outputLayout = first.outputLayout;
+        }
+        else if (CanReinterpretLayout(first, second.inputLayout))
+        {
+            first.inputLayout = second.inputLayout;
+            first.outputLayout = second.inputLayout;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (first.inputLayout.GetActiveSize() != second.outputLayout.GetActiveSize())
+    {
+        return false;
+    }
+
+    merged.input = first.input;
+    merged.output = second.output;
+    merged.inputLayout = first.inputLayout;
+    merged.outputLayout = second.outputLayout;
+    merged.steps = first.steps;
+    merged.steps.insert(merged.steps.end(), second.steps.begin(), second.steps.end());
+    merged.padding = second.padding;
+    return true;
+}
+
+// Gets the function computed by the (new) node producing `input`, if it can be fused into its consumer: the
+// producer must be an elementwise node whose output is used only by the consumer
+template <typename ValueType>
+bool TryGetFusablePredecessorInfo(const OutputPort<ValueType>& input, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, const ModelTransformer& transformer, ElementwiseNodeInfo<ValueType>& info)
+{
+    const auto& outputs = submodel.GetOutputs();
+    if (std::find(outputs.begin(), outputs.end(), &input) != outputs.end() || std::find(boundaryPorts.begin(), boundaryPorts.end(), &input) != boundaryPorts.end())
+    {
+        return false;
+    }
+
+    if (input.GetNode()->GetDependentNodes().size() != 1)
+    {
+        return false;
+    }
+
+    const auto& newInput = transformer.GetCorrespondingOutputs(input);
+    return TryGetElementwiseNodeInfo(*newInput.GetNode(), info) && info.output == &newInput;
+}
+
+// returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes
+template <typename ValueType>
+bool TryFuseElementwiseNodes(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    ElementwiseNodeInfo<ValueType> info;
+    if (!TryGetElementwiseNodeInfo(node, info))
+    {
+        return false;
+    }
+
+    ElementwiseNodeInfo<ValueType> prevInfo;
+    ElementwiseNodeInfo<ValueType> merged;
+    if (!TryGetFusablePredecessorInfo(*info.input, submodel, boundaryPorts, transformer, prevInfo) || !TryMergeNodeInfo(prevInfo, info, merged))
+    {
+        transformer.CopyNode(node);
+        return true;
+    }
+
+    auto newNode = transformer.AddNode<nodes::FusedElementwiseNode<ValueType>>(*merged.input, merged.inputLayout, merged.outputLayout, merged.steps, merged.padding);
+    transformer.MapNodeOutput(*info.output, newNode->output);
+    return true;
+}
+
+// A type cast ends a fused chain: it's folded into its predecessor if that one writes unpadded output
+template <typename ValueType, typename OutputValueType>
+bool TryFuseTypeCastNode(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    auto thisNode = dynamic_cast<const nodes::TypeCastNode<ValueType, OutputValueType>*>(&node);
+    if (thisNode == nullptr)
+    {
+        return false;
+    }
+
+    ElementwiseNodeInfo<ValueType> prevInfo;
+    if (!TryGetFusablePredecessorInfo(thisNode->input.GetReferencedPort(), submodel, boundaryPorts, transformer, prevInfo) || prevInfo.outputLayout.HasPadding())
+    {
+        transformer.CopyNode(node);
+        return true;
+    }
+
+    auto newNode = transformer.AddNode<nodes::FusedElementwiseNode<ValueType, OutputValueType>>(*prevInfo.input, prevInfo.inputLayout, prevInfo.outputLayout, prevInfo.steps, static_cast<OutputValueType>(prevInfo.padding));
+    transformer.MapNodeOutput(thisNode->output, newNode->output);
+    return true;
+}
+
+void FuseElementwiseNodes(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    if (TryFuseElementwiseNodes<float>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseElementwiseNodes<double>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseTypeCastNode<float, double>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseTypeCastNode<float, int>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseTypeCastNode<double, float>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseTypeCastNode<double, int>(node, submodel, boundaryPorts, transformer))
+    {
+        return;
+    }
+    transformer.CopyNode(node);
+}
+} // namespace
+
+//
+// FuseElementwiseOperationsTransformation methods
+//
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseElementwiseOperationsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto result = transformer.TransformSubmodelOnto(submodel, onto, context, [compiler, &submodel, &onto](const Node& node, ModelTransformer& transformer) {
+            bool canFuseNodes = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("fuseElementwiseNodes", true);
+
+            if (canFuseNodes)
+            {
+                FuseElementwiseNodes(node, submodel, onto, transformer);
+            }
+            else
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseLayerEpiloguesTransformation.cpp (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseLayerEpiloguesTransformation.h"
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/RefineTransformation.h>
+
+#include <nodes/include/ActivationLayerNode.h>
+#include <nodes/include/BiasLayerNode.h>
+#include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/FusedEpilogue.h>
+
+#include <predictors/neural/include/ConvolutionalLayer.h>
+#include <predictors/neural/include/FullyConnectedLayer.h>
+#include <predictors/neural/include/HardSigmoidActivation.h>
+#include <predictors/neural/include/LeakyReLUActivation.h>
+#include <predictors/neural/include/ParametricReLUActivation.h>
+#include <predictors/neural/include/ReLUActivation.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+//
+// Implementation
+//
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool IsNeuralNetworkPredictorNode(const Node& node)
+{
+    return (node.GetRuntimeTypeName().find("NeuralNetworkPredictorNode") == 0);
+}
+
+// Returns true if the node producing `port` may be bypassed: `port` must not be visible outside the submodel, and the
+// node's only consumer must be the layer we're fusing into it
+bool IsFusableOutput(const OutputPortBase& port, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts)
+{
+    const auto& outputs = submodel.GetOutputs();
+    if (std::find(outputs.begin(), outputs.end(), &port) != outputs.end() || std::find(boundaryPorts.begin(), boundaryPorts.end(), &port) != boundaryPorts.end())
+    {
+        return false;
+    }
+
+    return port.GetNode()->GetDependentNodes().size() == 1;
+}
+
+template <typename ValueType>
+bool TryGetActivation(const Node& node, nodes::FusedEpilogue<ValueType>& epilogue)
+{
+    if (auto activationNode = dynamic_cast<const nodes::ActivationLayerNode<ValueType>*>(&node))
+    {
+        auto activation = activationNode->GetLayer().GetActivationFunction().GetImpl();
+        if (dynamic_cast<const predictors::neural::ReLUActivation<ValueType>*>(activation))
+        {
+            epilogue.activation = nodes::EpilogueActivationType::reLU;
+            return true;
+        }
+
+        if (auto leakyReLU = dynamic_cast<const predictors::neural::LeakyReLUActivation<ValueType>*>(activation))
+        {
+            epilogue.activation = nodes::EpilogueActivationType::leakyReLU;
+            epilogue.leakyFactor = leakyReLU->GetLeakyFactor();
+            return true;
+        }
+
+        if (dynamic_cast<const predictors::neural::HardSigmoidActivation<ValueType>*>(activation))
+        {
+            epilogue.activation = nodes::EpilogueActivationType::hardSigmoid;
+            return true;
+        }
+        return false;
+    }
+
+    // The alpha tensor is indexed like the layer's input, so it's only in logical order when the input has no padding
+    auto preluNode = dynamic_cast<const nodes::ParametricReLUActivationLayerNode<ValueType>*>(&node);
+    if (preluNode != nullptr && preluNode->GetRequestedInputPadding().paddingSize == 0)
+    {
+        auto prelu = static_cast<const predictors::neural::ParametricReLUActivation<ValueType>*>(preluNode->GetLayer().GetActivationFunction().GetImpl());
+        epilogue.activation = nodes::EpilogueActivationType::parametricReLU;
+        epilogue.alpha = prelu->GetAlpha().ToArray();
+        return true;
+    }
+
+    return false;
+}
+
+template <typename ValueType>
+bool TryGetBias(const Node& node, nodes::FusedEpilogue<ValueType>& epilogue)
+{
+    if (auto biasNode = dynamic_cast<const nodes::BiasLayerNode<ValueType>*>(&node))
+    {
+        epilogue.bias = biasNode->GetLayer().GetBias().ToArray();
+        return true;
+    }
+    return false;
+}
+
+// Returns the layer parameters for the fused version of `layerNode`, which writes its output directly with the output
+// shape and padding of `lastNode`, the last layer in the fused chain
+template <typename ValueType>
+typename predictors::neural::Layer<ValueType>::LayerParameters GetFusedLayerParameters(const nodes::NeuralNetworkLayerNodeBase<ValueType>& layerNode, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode)
+{
+    auto layerParameters = layerNode.GetLayerParameters();
+    layerParameters.outputShape = lastNode.GetLayerParameters().outputShape;
+    layerParameters.outputPaddingParameters = lastNode.GetRequestedOutputPadding();
+    return layerParameters;
+}
+
+template <typename ValueType>
+bool TryFuseIntoConvolutionalLayer(const Node& node, const nodes::FusedEpilogue<ValueType>& epilogue, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, ModelTransformer& transformer)
+{
+    auto convNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+    if (convNode == nullptr || convNode->GetRequestedOutputPadding().paddingSize != 0 || !convNode->GetEpilogue().IsEmpty())
+    {
+        return false;
+    }
+
+    const auto& layer = convNode->GetLayer();
+    predictors::neural::ConvolutionalLayer<ValueType> newLayer(GetFusedLayerParameters(*convNode, lastNode), layer.GetConvolutionalParameters(), layer.GetWeights());
+    const auto& newInput = transformer.GetCorrespondingInputs(convNode->input);
+    auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(newInput, newLayer, epilogue);
+    newNode->GetMetadata() = convNode->GetMetadata();
+    transformer.MapNodeOutput(lastNode.output, newNode->output);
+    return true;
+}
+
+template <typename ValueType>
+bool TryFuseIntoFullyConnectedLayer(const Node& node, const nodes::FusedEpilogue<ValueType>& epilogue, const nodes::NeuralNetworkLayerNodeBase<ValueType>& lastNode, ModelTransformer& transformer)
+{
+    // FullyConnectedLayerNode doesn't support output padding
+    auto fullyConnectedNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node);
+    if (fullyConnectedNode == nullptr || fullyConnectedNode->GetRequestedOutputPadding().paddingSize != 0 || lastNode.GetRequestedOutputPadding().paddingSize != 0 || !fullyConnectedNode->GetEpilogue().IsEmpty())
+    {
+        return false;
+    }
+
+    auto weights = fullyConnectedNode->GetLayer().GetWeights();
+    predictors::neural::FullyConnectedLayer<ValueType> newLayer(GetFusedLayerParameters(*fullyConnectedNode, lastNode), weights);
+    const auto& newInput = transformer.GetCorrespondingInputs(fullyConnectedNode->input);
+    auto newNode = transformer.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(newInput, newLayer, epilogue);
+    newNode->GetMetadata() = fullyConnectedNode->GetMetadata();
+    transformer.MapNodeOutput(lastNode.output, newNode->output);
+    return true;
+}
+
+// returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes
+template <typename ValueType>
+bool TryFuseLayerEpilogue(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    // `node` is the last layer of the chain: either an activation layer, optionally preceded by a bias layer, or a
+    // bias layer on its own. The nodes we've already copied for the earlier layers in the chain are left without
+    // consumers, and get removed when the model is pruned.
+    nodes::FusedEpilogue<ValueType> epilogue;
+    const auto& lastNode = static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>&>(node);
+    const nodes::NeuralNetworkLayerNodeBase<ValueType>* currentNode = &lastNode;
+    if (TryGetActivation(node, epilogue))
+    {
+        const auto& inputPort = currentNode->input.GetReferencedPort();
+        if (IsFusableOutput(inputPort, submodel, boundaryPorts) && TryGetBias(*inputPort.GetNode(), epilogue))
+        {
+            currentNode = static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>*>(inputPort.GetNode());
+        }
+    }
+    else if (TryGetBias(node, epilogue))
+    {
+        // A bias layer followed by an activation layer gets fused when we reach the activation layer
+        const auto& dependents = lastNode.output.GetReferences();
+        nodes::FusedEpilogue<ValueType> activationEpilogue;
+        if (IsFusableOutput(lastNode.output, submodel, boundaryPorts) && dependents.size() == 1 && TryGetActivation(*dependents[0]->GetNode(), activationEpilogue))
+        {
+            transformer.CopyNode(node);
+            return true;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    const auto& inputPort = currentNode->input.GetReferencedPort();
+    if (IsFusableOutput(inputPort, submodel, boundaryPorts))
+    {
+        const auto& inputNode = *inputPort.GetNode();
+        if (TryFuseIntoConvolutionalLayer(inputNode, epilogue, lastNode, transformer) ||
+            TryFuseIntoFullyConnectedLayer(inputNode, epilogue, lastNode, transformer))
+        {
+            Log() << "Fusing layer " << node.GetId() << " into the epilogue of layer " << inputNode.GetId() << std::endl;
+            return true;
+        }
+    }
+
+    transformer.CopyNode(node);
+    return true;
+}
+
+void FuseLayerEpilogue(const Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, ModelTransformer& transformer)
+{
+    if (TryFuseLayerEpilogue<float>(node, submodel, boundaryPorts, transformer) ||
+        TryFuseLayerEpilogue<double>(node, submodel, boundaryPorts, transformer))
+    {
+        return;
+    }
+    transformer.CopyNode(node);
+}
+} // namespace
+
+//
+// FuseLayerEpiloguesTransformation methods
+//
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseLayerEpiloguesTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        // First refine any NeuralNetworkPredictorNodes, so we can see their layers
+        auto refineNNPredictorFn = [](const model::Node& node) {
+            return IsNeuralNetworkPredictorNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
+        };
+        model::TransformContext refineNNPredictorContext{ refineNNPredictorFn };
+        RefineTransformation refineTransformation;
+        auto refinedSubmodel = refineTransformation.Transform(submodel, transformer, refineNNPredictorContext);
+
+        auto onto = GetReferencedPorts(refinedSubmodel.GetInputs());
+        auto result = transformer.TransformSubmodelOnto(refinedSubmodel, onto, context, [compiler, &refinedSubmodel, &onto](const Node& node, ModelTransformer& transformer) {
+            bool canFuseEpilogues = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("fuseLayerEpilogues", true);
+
+            if (canFuseEpilogues)
+            {
+                FuseLayerEpilogue(node, refinedSubmodel, onto, transformer);
+            }
+            else
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
@@ -12,6 +12,8 @@
 #include <model/include/RefineTransformation.h>
 
 #include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
+#include <nodes/include/ReorderDataNode.h>
 
 #include <predictors/neural/include/ConvolutionalLayer.h>
 
@@ -19,6 +21,7 @@
 #include <utilities/include/Logger.h>
 #include <utilities/include/StlVectorUtil.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace ell
@@ -64,6 +67,10 @@ namespace passes
                 return predictors::neural::ConvolutionMethod::diagonal;
             case model::PreferredConvolutionMethod::winograd:
                 return predictors::neural::ConvolutionMethod::winograd;
+            case model::PreferredConvolutionMethod::blocked:
+                return predictors::neural::ConvolutionMethod::blocked;
+            case model::PreferredConvolutionMethod::depthwise:
+                return predictors::neural::ConvolutionMethod::depthwise;
             default:
                 throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
             }
@@ -111,7 +118,7 @@ namespace passes
             predictors::neural::ConvolutionalLayer<ValueType> newLayer = { layerParameters, convolutionalParameters, layer.GetWeights() };
 
             // TODO: just copy the node and modify its layer
-            auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(newInput, newLayer);
+            auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(newInput, newLayer, thisNode->GetEpilogue());
             newNode->GetMetadata() = node.GetMetadata();
 
             Log() << "Setting convolution method to " << static_cast<int>(method) << " for node " << thisNode->GetId() << std::endl;
@@ -119,8 +126,28 @@ namespace passes
             return true;
         }
 
+        // Depthwise-separable layers that don't ask for a particular method get the depthwise method, whose node
+        // vectorizes over the channels instead of over the (tiny) single-channel filters
+        template <typename ValueType>
+        bool IsAutomaticDepthwiseLayer(const model::Node& node)
+        {
+            auto thisNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            const auto& layer = thisNode->GetLayer();
+            return layer.IsDepthwiseSeparable() && layer.GetRequestedConvolutionMethod() == predictors::neural::ConvolutionMethod::automatic;
+        }
+
         void SetConvolutionMethod(const model::Node& node, model::ModelTransformer& transformer, model::PreferredConvolutionMethod preferredMethod)
         {
+            if (preferredMethod == model::PreferredConvolutionMethod::automatic && (IsAutomaticDepthwiseLayer<float>(node) || IsAutomaticDepthwiseLayer<double>(node)))
+            {
+                preferredMethod = model::PreferredConvolutionMethod::depthwise;
+            }
+
             if (preferredMethod != model::PreferredConvolutionMethod::automatic)
             {
                 if (TrySetConvolutionMethod<float>(node, transformer, preferredMethod))
@@ -135,6 +162,100 @@ namespace passes
 
             transformer.CopyNode(node);
         }
+
+        // Returns true if the node producing `port` may be bypassed: `port` must not be visible outside the submodel, and the
+        // node's only consumer must be the layer we're fusing it with
+        bool IsFusableOutput(const OutputPortBase& port, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts)
+        {
+            const auto& outputs = submodel.GetOutputs();
+            if (std::find(outputs.begin(), outputs.end(), &port) != outputs.end() || std::find(boundaryPorts.begin(), boundaryPorts.end(), &port) != boundaryPorts.end())
+            {
+                return false;
+            }
+
+            return port.GetNode()->GetDependentNodes().size() == 1;
+        }
+
+        // returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes.
+        template <typename ValueType>
+        bool TryFuseDepthwisePointwiseConvolution(const model::Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, model::ModelTransformer& transformer)
+        {
+            // `node` is the pointwise layer. The depthwise layer we've already copied is left without consumers, and gets
+            // removed when the model is pruned.
+            auto pointwiseNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (pointwiseNode == nullptr)
+            {
+                return false;
+            }
+
+            const auto& pointwiseLayer = pointwiseNode->GetLayer();
+            const auto& pointwiseParameters = pointwiseLayer.GetConvolutionalParameters();
+            if (pointwiseParameters.receptiveField != 1 || pointwiseParameters.stride != 1 || pointwiseLayer.IsDepthwiseSeparable())
+            {
+                return false;
+            }
+
+            // The fused node writes the pointwise output straight from the depthwise output, without any padding in between
+            if (predictors::neural::HasPadding(pointwiseLayer.GetLayerParameters().inputPaddingParameters))
+            {
+                return false;
+            }
+
+            const auto& inputPort = pointwiseNode->input.GetReferencedPort();
+            auto depthwiseNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(inputPort.GetNode());
+            if (depthwiseNode == nullptr || depthwiseNode->GetLayer().GetConvolutionalParameters().method != predictors::neural::ConvolutionMethod::depthwise || !IsFusableOutput(inputPort, submodel, boundaryPorts))
+            {
+                return false;
+            }
+
+            // The same reorders `ConvolutionalLayerNode::Refine` adds around the depthwise node, but with the pointwise layer's output
+            const auto& depthwiseLayer = depthwiseNode->GetLayer();
+            const auto& originalInputLayout = depthwiseNode->GetInputMemoryLayout();
+            const auto originalOutputLayout = pointwiseNode->GetOutputMemoryLayout();
+            auto convInputLayout = originalInputLayout.ReorderedCopy({ utilities::RowMajorTensorOrder });
+            auto convOutputLayout = originalOutputLayout.ReorderedCopy({ utilities::RowMajorTensorOrder });
+
+            const auto& newInput = transformer.GetCorrespondingInputs(depthwiseNode->input);
+            auto preConvReorderNode = transformer.AddNode<nodes::ReorderDataNode<ValueType>>(newInput, originalInputLayout, convInputLayout);
+            auto convNode = transformer.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(preConvReorderNode->output, convInputLayout, convOutputLayout, depthwiseLayer.GetWeights(), depthwiseLayer.GetConvolutionalParameters().stride, depthwiseNode->GetEpilogue(), pointwiseLayer.GetWeights(), pointwiseNode->GetEpilogue());
+            convNode->GetMetadata() = depthwiseNode->GetMetadata();
+            auto postConvReorderNode = transformer.AddNode<nodes::ReorderDataNode<ValueType>>(convNode->output, convOutputLayout, originalOutputLayout);
+
+            Log() << "Fusing pointwise convolution " << pointwiseNode->GetId() << " into depthwise convolution " << depthwiseNode->GetId() << std::endl;
+            transformer.MapNodeOutput(pointwiseNode->output, postConvReorderNode->output);
+            return true;
+        }
+
+        void FuseDepthwisePointwiseConvolution(const model::Node& node, const Submodel& submodel, const std::vector<const OutputPortBase*>& boundaryPorts, model::ModelTransformer& transformer)
+        {
+            if (TryFuseDepthwisePointwiseConvolution<float>(node, submodel, boundaryPorts, transformer) ||
+                TryFuseDepthwisePointwiseConvolution<double>(node, submodel, boundaryPorts, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        }
+
+        Submodel FuseDepthwisePointwiseConvolutions(const Submodel& submodel, model::ModelTransformer& transformer, const TransformContext& context)
+        {
+            auto compiler = context.GetCompiler();
+            if (!compiler)
+            {
+                return submodel;
+            }
+
+            auto onto = GetReferencedPorts(submodel.GetInputs());
+            return transformer.TransformSubmodelOnto(submodel, onto, context, [compiler, &submodel, &onto](const Node& node, ModelTransformer& transformer) {
+                if (compiler->GetModelOptimizerOptions(node).GetEntry<bool>("fuseDepthwisePointwiseConvolutions", true))
+                {
+                    FuseDepthwisePointwiseConvolution(node, submodel, onto, transformer);
+                }
+                else
+                {
+                    transformer.CopyNode(node);
+                }
+            });
+        }
     } // namespace
 
     //
@@ -168,13 +289,16 @@ namespace passes
             SetConvolutionMethod(node, transformer, preferredMethod);
         });
 
+        // Then fuse depthwise layers with the pointwise (1x1) layers that follow them, so the depthwise output is never written out
+        auto result3 = FuseDepthwisePointwiseConvolutions(result2, transformer, context);
+
         // Finally, refine any ConvolutionalLayerNodes
         auto refineConvLayerFn = [](const model::Node& node) {
             return IsConvolutionalLayerNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
         };
-        model::TransformContext refineConvLayerContext{ refineConvLayerFn };
-        auto result3 = refineTransformation.Transform(result2, transformer, refineConvLayerContext);
-        return result3;
+        model::TransformContext refineConvLayerContext{ context.GetCompiler(), refineConvLayerFn };
+        auto result4 = refineTransformation.Transform(result3, transformer, refineConvLayerContext);
+        return result4;
     }
 } // namespace passes
 } // namespace ell
@@ -7,6 +7,10 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "StandardTransformations.h"
+#include "AssignMemoryLayoutsTransformation.h"
+#include "FoldAffineLayersTransformation.h"
+#include "FuseElementwiseOperationsTransformation.h"
+#include "FuseLayerEpiloguesTransformation.h"
 #include "FuseLinearOperationsTransformation.h"
 #include "OptimizeReorderDataNodesTransformation.h"
 #include "SetConvolutionMethodTransformation.h"
@@ -32,9 +36,13 @@ namespace passes
         static bool done = false;
         if (!done)
         {
+            registry.AddTransformation<FoldAffineLayersTransformation>();
+            registry.AddTransformation<FuseLayerEpiloguesTransformation>();
             registry.AddTransformation<SetConvolutionMethodTransformation>();
             registry.AddTransformation<model::RefineTransformation>();
             registry.AddTransformation<FuseLinearOperationsTransformation>();
+            registry.AddTransformation<AssignMemoryLayoutsTransformation>();
+            registry.AddTransformation<FuseElementwiseOperationsTransformation>();
             registry.AddTransformation<OptimizeReorderDataNodesTransformation>();
             done = true;
         }
@@ -0,0 +1,331 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TuneConvolutionMethodTransformation.cpp (passes)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "TuneConvolutionMethodTransformation.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/RefineTransformation.h>
+
+#include <nodes/include/ConvolutionalLayerNode.h>
+
+#include <predictors/neural/include/ConvolutionalLayer.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace passes
+{
+    using namespace model;
+    using namespace utilities::logging;
+    using utilities::logging::Log;
+
+    namespace
+    {
+        const std::vector<PreferredConvolutionMethod> candidateMethods = {
+            PreferredConvolutionMethod::unrolled,
+            PreferredConvolutionMethod::simple,
+            PreferredConvolutionMethod::diagonal,
+            PreferredConvolutionMethod::winograd,
+            PreferredConvolutionMethod::blocked,
+            PreferredConvolutionMethod::depthwise
+        };
+
+        // The Winograd method is tried with each tile size the node supports
+        const std::vector<int> candidateWinogradTileSizes = { 2, 4, 6 };
+
+        // A method to try, with its tile size if it's the Winograd method
+        struct CandidateMethod
+        {
+            PreferredConvolutionMethod method;
+            int winogradTileSize;
+        };
+
+        std::vector<CandidateMethod> GetCandidates()
+        {
+            std::vector<CandidateMethod> candidates;
+            for (auto method : candidateMethods)
+            {
+                if (method == PreferredConvolutionMethod::winograd)
+                {
+                    for (auto tileSize : candidateWinogradTileSizes)
+                    {
+                        candidates.push_back({ method, tileSize });
+                    }
+                }
+                else
+                {
+                    candidates.push_back({ method, 0 });
+                }
+            }
+            return candidates;
+        }
+
+        std::string ToString(const CandidateMethod& candidate)
+        {
+            auto name = model::ToString(candidate.method);
+            return candidate.method == PreferredConvolutionMethod::winograd ? name + " (tile size " + std::to_string(candidate.winogradTileSize) + ")" : name;
+        }
+
+        template <typename Container, typename Function>
+        auto Transform(const Container& container, Function fn)
+        {
+            return utilities::TransformVector(container.begin(), container.end(), fn);
+        }
+
+        std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+        {
+            return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+        }
+
+        bool IsNeuralNetworkPredictorNode(const Node& node)
+        {
+            return (node.GetRuntimeTypeName().find("NeuralNetworkPredictorNode") == 0);
+        }
+
+        bool HasPreferredConvolutionMethod(const Node& node)
+        {
+            const auto& metadata = node.GetMetadata();
+            return metadata.HasEntry("compileOptions") && metadata.GetEntry<utilities::PropertyBag>("compileOptions").HasEntry("preferredConvolutionMethod");
+        }
+
+        // Returns a copy of the node's layer that uses the given method, or the method the layer falls back to
+        template <typename ValueType>
+        predictors::neural::ConvolutionalLayer<ValueType> GetLayerWithMethod(const nodes::ConvolutionalLayerNode<ValueType>& node, predictors::neural::ConvolutionMethod method)
+        {
+            const auto& layer = node.GetLayer();
+            auto convolutionalParameters = layer.GetConvolutionalParameters();
+            convolutionalParameters.method = method;
+            return { layer.GetLayerParameters(), convolutionalParameters, layer.GetWeights() };
+        }
+
+        // Returns a map that just evaluates a copy of the given layer
+        template <typename ValueType>
+        Map GetLayerMap(const nodes::ConvolutionalLayerNode<ValueType>& node)
+        {
+            Model model;
+            auto inputNode = model.AddNode<InputNode<ValueType>>(node.GetInputMemoryLayout());
+            auto layerNode = model.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(inputNode->output, node.GetLayer(), node.GetEpilogue());
+            return Map(model, { { "input", inputNode } }, { { "output", PortElementsBase(layerNode->output) } });
+        }
+
+        // Returns an input with values in its active area, and zeros in its padding (the convolutions read the padding
+        // as zeros, so nonzero padding would make the methods' results differ)
+        template <typename ValueType>
+        std::vector<ValueType> GetTestInput(const PortMemoryLayout& layout)
+        {
+            std::vector<ValueType> input(layout.GetMemorySize());
+            const auto& activeSize = layout.GetActiveSize();
+            const int numDimensions = activeSize.NumDimensions();
+            const int numElements = static_cast<int>(layout.NumElements());
+            std::vector<int> coordinates(numDimensions);
+            for (int index = 0; index < numElements; ++index)
+            {
+                auto remainder = index;
+                for (int dimension = numDimensions - 1; dimension >= 0; --dimension)
+                {
+                    coordinates[dimension] = remainder % activeSize[dimension];
+                    remainder /= activeSize[dimension];
+                }
+                input[layout.GetEntryOffset(coordinates)] = static_cast<ValueType>(index % 17) / 17;
+            }
+            return input;
+        }
+
+        template <typename ValueType>
+        bool IsClose(const std::vector<ValueType>& result, const std::vector<ValueType>& reference)
+        {
+            if (result.size() != reference.size())
+            {
+                return false;
+            }
+
+            // The methods sum the products in different orders, so allow for some rounding error relative to the output's range
+            ValueType maxValue = 0;
+            for (auto value : reference)
+            {
+                maxValue = std::max(maxValue, std::abs(value));
+            }
+            const auto tolerance = static_cast<ValueType>(1e-3) * (1 + maxValue);
+            for (size_t index = 0; index < result.size(); ++index)
+            {
+                if (!(std::abs(result[index] - reference[index]) <= tolerance))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Returns the fastest method for the layer, or `automatic` if no method could be timed
+        template <typename ValueType>
+        CandidateMethod TuneConvolutionMethod(const nodes::ConvolutionalLayerNode<ValueType>& node, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions, int numIterations)
+        {
+            Map map = GetLayerMap(node);
+            auto input = GetTestInput<ValueType>(node.GetInputMemoryLayout());
+            map.SetInputValue(0, input);
+            auto reference = map.ComputeOutput<ValueType>(0);
+
+            CandidateMethod bestCandidate = { PreferredConvolutionMethod::automatic, 0 };
+            auto bestTime = std::numeric_limits<double>::max();
+            for (const auto& candidate : GetCandidates())
+            {
+                // The layer falls back to another method if it can't use the one we ask for. (The two enums have the
+                // same values.)
+                auto layerMethod = static_cast<predictors::neural::ConvolutionMethod>(candidate.method);
+                if (GetLayerWithMethod(node, layerMethod).GetConvolutionalParameters().method != layerMethod)
+                {
+                    continue;
+                }
+
+                auto candidateOptions = optimizerOptions;
+                candidateOptions["preferredConvolutionMethod"] = model::ToString(candidate.method);
+                if (candidate.method == PreferredConvolutionMethod::winograd)
+                {
+                    candidateOptions["winogradTileSize"] = candidate.winogradTileSize;
+                }
+                try
+                {
+                    IRMapCompiler compiler(settings, candidateOptions);
+                    IRCompiledMap compiledMap = compiler.Compile(map);
+
+                    // The first evaluation also checks the result, and warms up the caches. (Larger Winograd tiles
+                    // lose some precision, so this also rules out tile sizes that are too inaccurate for the layer.)
+                    compiledMap.SetInputValue(0, input);
+                    auto result = compiledMap.ComputeOutput<ValueType>(0);
+                    if (!IsClose(result, reference))
+                    {
+                        Log() << "Convolution method " << ToString(candidate) << " gave the wrong result for node " << node.GetId() << std::endl;
+                        continue;
+                    }
+
+                    // Layers can be fast enough that a millisecond timer can't tell the methods apart
+                    auto start = std::chrono::steady_clock::now();
+                    for (int iteration = 0; iteration < numIterations; ++iteration)
+                    {
+                        compiledMap.SetInputValue(0, input);
+                        compiledMap.ComputeOutput<ValueType>(0);
+                    }
+                    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                    Log() << "Convolution method " << ToString(candidate) << " took " << (elapsed.count() / numIterations) << " ms for node " << node.GetId() << std::endl;
+                    if (elapsed.count() < bestTime)
+                    {
+                        bestTime = elapsed.count();
+                        bestCandidate = candidate;
+                    }
+                }
+                catch (const std::exception& exception)
+                {
+                    Log() << "Couldn't compile convolution method " << ToString(candidate) << " for node " << node.GetId() << ": " << exception.what() << std::endl;
+                }
+            }
+            return bestCandidate;
+        }
+
+        // returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes.
+        template <typename ValueType>
+        bool TryTuneConvolutionMethod(const Node& node, ModelTransformer& transformer, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions, int numIterations)
+        {
+            auto thisNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            auto best = TuneConvolutionMethod(*thisNode, settings, optimizerOptions, numIterations);
+            if (best.method == PreferredConvolutionMethod::automatic)
+            {
+                transformer.CopyNode(node);
+                return true;
+            }
+
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+            auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(newInput, thisNode->GetLayer(), thisNode->GetEpilogue());
+            auto metadata = node.GetMetadata();
+            utilities::PropertyBag compileOptions;
+            if (metadata.HasEntry("compileOptions"))
+            {
+                compileOptions = metadata.GetEntry<utilities::PropertyBag>("compileOptions");
+            }
+            compileOptions["preferredConvolutionMethod"] = model::ToString(best.method);
+            if (best.method == PreferredConvolutionMethod::winograd)
+            {
+                compileOptions["winogradTileSize"] = best.winogradTileSize;
+            }
+            metadata["compileOptions"] = compileOptions;
+            newNode->GetMetadata() = metadata;
+
+            Log() << "Tuned convolution method to " << ToString(best) << " for node " << thisNode->GetId() << std::endl;
+            transformer.MapNodeOutput(thisNode->output, newNode->output);
+            return true;
+        }
+
+        void TuneConvolutionMethod(const Node& node, ModelTransformer& transformer, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions, int numIterations)
+        {
+            if (!HasPreferredConvolutionMethod(node))
+            {
+                if (TryTuneConvolutionMethod<float>(node, transformer, settings, optimizerOptions, numIterations))
+                {
+                    return;
+                }
+                if (TryTuneConvolutionMethod<double>(node, transformer, settings, optimizerOptions, numIterations))
+                {
+                    return;
+                }
+            }
+
+            transformer.CopyNode(node);
+        }
+    } // namespace
+
+    //
+    // TuneConvolutionMethodTransformation methods
+    //
+    TuneConvolutionMethodTransformation::TuneConvolutionMethodTransformation(const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions, int numIterations) :
+        _settings(settings),
+        _optimizerOptions(optimizerOptions),
+        _numIterations(numIterations)
+    {
+        // We time the layers on the machine we're running on
+        _settings.compilerSettings.targetDevice = { "host" };
+        _settings.objectCacheDirectory = "";
+        _settings.profile = false;
+        _settings.predictBatch = false;
+        _settings.lazyJit = false;
+    }
+
+    Submodel TuneConvolutionMethodTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        // First refine any NeuralNetworkPredictorNodes, so we can see their layers
+        auto refineNNPredictorFn = [](const model::Node& node) {
+            return IsNeuralNetworkPredictorNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
+        };
+        model::TransformContext refineNNPredictorContext{ refineNNPredictorFn };
+        RefineTransformation refineTransformation;
+        auto refinedSubmodel = refineTransformation.Transform(submodel, transformer, refineNNPredictorContext);
+
+        auto onto = transformer.GetCorrespondingOutputs(GetReferencedPorts(refinedSubmodel.GetInputs()));
+        model::Model destModel = refinedSubmodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(refinedSubmodel, destModel, onto, context, [this](const Node& node, ModelTransformer& transformer) {
+            TuneConvolutionMethod(node, transformer, _settings, _optimizerOptions, _numIterations);
+        });
+    }
+} // namespace passes
+} // namespace ell
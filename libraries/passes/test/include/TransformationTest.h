@@ -15,5 +15,10 @@
 void TestTransformations();
 
 void TestFuseLinearOperationsTransformation();
+void TestFuseElementwiseOperationsTransformation();
+void TestFoldAffineLayersTransformation();
+void TestFuseLayerEpiloguesTransformation();
+void TestAssignMemoryLayoutsTransformation();
 void TestSetConvolutionMethodTransformation();
+void TestTuneConvolutionMethodTransformation();
 void TestOptimizeReorderDataNodesTransformation();
@@ -490,5 +490,5 @@ void TestSetConvolutionMethodPass()
     TestSetConvolutionMethodPass(model::PreferredConvolutionMethod::diagonal, "DiagonalConvolutionComputeNode<float>");
     TestSetConvolutionMethodPass(model::PreferredConvolutionMethod::simple, "SimpleConvolutionComputeNode<float>");
     TestSetConvolutionMethodPass(model::PreferredConvolutionMethod::winograd, "WinogradConvolutionComputeNode<float>");
-    TestSetConvolutionMethodPass(model::PreferredConvolutionMethod::unrolled, "ReceptiveFieldMatrixNode<float>");
+    TestSetConvolutionMethodPass(model::PreferredConvolutionMethod::unrolled, "UnrolledConvolutionNode<float>");
 }
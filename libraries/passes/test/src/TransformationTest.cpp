@@ -8,21 +8,47 @@
 
 #include "TransformationTest.h"
 
+#include <passes/include/AssignMemoryLayoutsTransformation.h>
+#include <passes/include/FoldAffineLayersTransformation.h>
+#include <passes/include/FuseElementwiseOperationsTransformation.h>
+#include <passes/include/FuseLayerEpiloguesTransformation.h>
 #include <passes/include/FuseLinearOperationsTransformation.h>
 #include <passes/include/OptimizeReorderDataNodesTransformation.h>
 #include <passes/include/SetConvolutionMethodTransformation.h>
+#include <passes/include/TuneConvolutionMethodTransformation.h>
 
+#include <model/include/IRMapCompiler.h>
 #include <model/include/InputNode.h>
 #include <model/include/TransformContext.h>
 #include <model/include/Transformation.h>
 
+#include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/ActivationLayerNode.h>
+#include <nodes/include/BatchNormalizationLayerNode.h>
+#include <nodes/include/BiasLayerNode.h>
+#include <nodes/include/BinaryConvolutionalLayerNode.h>
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BroadcastFunctionNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/FusedElementwiseNode.h>
 #include <nodes/include/MatrixMatrixMultiplyNode.h>
 #include <nodes/include/ReorderDataNode.h>
-
+#include <nodes/include/ScalingLayerNode.h>
+#include <nodes/include/TypeCastNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <predictors/neural/include/ActivationLayer.h>
+#include <predictors/neural/include/BatchNormalizationLayer.h>
+#include <predictors/neural/include/BiasLayer.h>
+#include <predictors/neural/include/BinaryConvolutionalLayer.h>
 #include <predictors/neural/include/ConvolutionalLayer.h>
+#include <predictors/neural/include/FullyConnectedLayer.h>
+#include <predictors/neural/include/LeakyReLUActivation.h>
+#include <predictors/neural/include/ParametricReLUActivation.h>
+#include <predictors/neural/include/ReLUActivation.h>
+#include <predictors/neural/include/ScalingLayer.h>
 
 #include <testing/include/testing.h>
 
@@ -130,7 +156,12 @@ model::Map GenerateLinearOpsTestModel(const model::PortMemoryLayout& inputLayout
 void TestTransformations()
 {
     TestFuseLinearOperationsTransformation();
+    TestFuseElementwiseOperationsTransformation();
+    TestFoldAffineLayersTransformation();
+    TestFuseLayerEpiloguesTransformation();
+    TestAssignMemoryLayoutsTransformation();
     TestSetConvolutionMethodTransformation();
+    TestTuneConvolutionMethodTransformation();
     TestOptimizeReorderDataNodesTransformation();
 }
 
@@ -230,6 +261,614 @@ void TestFuseLinearOperationsTransformation()
     TestFuseLinearOperationsTransformation({ linear, bias, bias });
 }
 
+void TestFuseElementwiseOperationsTransformation()
+{
+    using ValueType = float;
+
+    int numRows = 3;
+    int numColumns = 4;
+    int numChannels = 5;
+    int size = numRows * numColumns * numChannels;
+    model::PortMemoryLayout layout({ numRows, numColumns, numChannels });
+
+    // Create a chain of elementwise nodes: bias, scale, ReLU, sqrt, multiply by a constant, and cast to int
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(layout.GetActiveSize());
+    std::vector<ValueType> biasValues(numChannels);
+    std::generate(biasValues.begin(), biasValues.end(), Increment<ValueType>(-2.0f));
+    std::vector<ValueType> scaleValues(numChannels);
+    std::generate(scaleValues.begin(), scaleValues.end(), Increment<ValueType>(1.0f, 0.5f));
+    std::vector<ValueType> multiplierValues(size);
+    std::generate(multiplierValues.begin(), multiplierValues.end(), Increment<ValueType>(10.0f, 3.0f));
+
+    auto biasNode = model.AddNode<nodes::ConstantNode<ValueType>>(biasValues);
+    auto scaleNode = model.AddNode<nodes::ConstantNode<ValueType>>(scaleValues);
+    auto emptyNode = model.AddNode<nodes::ConstantNode<ValueType>>();
+    auto multiplierNode = model.AddNode<nodes::ConstantNode<ValueType>>(multiplierValues);
+    auto biasFunctionNode = model.AddNode<nodes::BroadcastLinearFunctionNode<ValueType>>(inputNode->output, layout, emptyNode->output, biasNode->output, 2, layout);
+    auto scaleFunctionNode = model.AddNode<nodes::BroadcastLinearFunctionNode<ValueType>>(biasFunctionNode->output, layout, scaleNode->output, emptyNode->output, 2, layout);
+    auto reluNode = model.AddNode<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>>(scaleFunctionNode->output, layout, layout);
+    auto sqrtNode = model.AddNode<nodes::UnaryOperationNode<ValueType>>(reluNode->output, nodes::UnaryOperationType::sqrt);
+    auto multiplyNode = model.AddNode<nodes::BinaryOperationNode<ValueType>>(sqrtNode->output, multiplierNode->output, nodes::BinaryOperationType::multiply);
+    auto castNode = model.AddNode<nodes::TypeCastNode<ValueType, int>>(multiplyNode->output);
+    model::Map map(model, { { "input", inputNode } }, { { "output", castNode->output } });
+
+    // Generate test data
+    std::vector<ValueType> testInput(size);
+    std::generate(testInput.begin(), testInput.end(), Increment<ValueType>(-10.0f, 0.25f));
+
+    // Evaluate it pre-optimization
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.ComputeOutput<int>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["fuseElementwiseNodes"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseElementwiseOperationsTransformation fuseOps;
+    map.GetModel().GetMetadata().SetEntry("compileOptions", optimizerOptions.AsPropertyBag());
+    map.Transform(fuseOps, context);
+    map.Refine();
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    // Only the input node and one fused node should be left
+    testing::ProcessTest("Testing fused elementwise node count", map.GetModel().Size() == 2);
+    testing::ProcessTest("Testing fused elementwise node type", HasNodeWithTypeName(map.GetModel(), nodes::FusedElementwiseNode<ValueType, int>::GetTypeName()));
+
+    // Evaluate model post-optimization
+    map.SetInputValue("input", testInput);
+    auto optimizedOutput = map.ComputeOutput<int>("output");
+    testing::ProcessTest("Testing fused elementwise result", testing::IsEqual(referenceOutput, optimizedOutput));
+
+    // Evaluate the compiled model
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", testInput);
+    auto compiledOutput = compiledMap.ComputeOutput<int>("output");
+    testing::ProcessTest("Testing compiled fused elementwise result", testing::IsEqual(referenceOutput, compiledOutput));
+}
+
+template <typename ElementType>
+std::vector<ElementType> GenerateValues(size_t size, ElementType start, ElementType inc)
+{
+    std::vector<ElementType> result(size);
+    std::generate(result.begin(), result.end(), Increment<ElementType>(start, inc));
+    return result;
+}
+
+// Checks that folding the affine layers in `map` removes them and leaves the output unchanged, both when computed
+// on the host and when compiled
+template <typename ElementType>
+void TestFoldAffineLayersTransformation(model::Map& map, const std::vector<ElementType>& testInput, bool hasBias, const std::string& testName)
+{
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.template ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["foldAffineLayers"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    passes::FoldAffineLayersTransformation foldLayers;
+    map.Transform(foldLayers, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    bool foldedLayers = !HasNodeWithTypeName(newModel, nodes::BatchNormalizationLayerNode<ElementType>::GetTypeName()) &&
+                        !HasNodeWithTypeName(newModel, nodes::ScalingLayerNode<ElementType>::GetTypeName()) &&
+                        HasNodeWithTypeName(newModel, nodes::BiasLayerNode<ElementType>::GetTypeName()) == hasBias;
+    testing::ProcessTest("Testing FoldAffineLayersTransformation node types for " + testName, foldedLayers);
+
+    map.SetInputValue("input", testInput);
+    auto foldedOutput = map.template ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing FoldAffineLayersTransformation result for " + testName, testing::IsEqual(referenceOutput, foldedOutput, static_cast<ElementType>(1e-4)));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", testInput);
+    auto compiledOutput = compiledMap.template ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled FoldAffineLayersTransformation result for " + testName, testing::IsEqual(referenceOutput, compiledOutput, static_cast<ElementType>(1e-4)));
+}
+
+void TestFoldAffineLayersIntoConvolutionTransformation(predictors::neural::ConvolutionMethod method, bool hasBias)
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using VectorType = typename Layer<ElementType>::VectorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const size_t numRows = 4;
+    const size_t numColumns = 5;
+    const size_t numChannels = 3;
+    const size_t numFilters = 4;
+    const size_t receptiveField = 3;
+    const size_t inputPaddingSize = 1;
+    const size_t outputPaddingSize = 1;
+
+    // Convolution -> batch normalization -> scaling (-> bias), where the last layer writes padded output
+    TensorType inputWithPadding(numRows + 2 * inputPaddingSize, numColumns + 2 * inputPaddingSize, numChannels);
+    LayerParameters convParameters{ inputWithPadding, ZeroPadding(inputPaddingSize), { numRows, numColumns, numFilters }, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ receptiveField, 1, method, 2 };
+    TensorType weights(receptiveField * numFilters, receptiveField, numChannels);
+    weights.Generate(Increment<ElementType>(-1.0f, 0.0625f));
+    ConvolutionalLayer<ElementType> convLayer(convParameters, convolutionalParams, weights);
+
+    auto mean = hasBias ? GenerateValues<ElementType>(numFilters, -1.0f, 0.75f) : std::vector<ElementType>(numFilters, 0);
+    auto variance = GenerateValues<ElementType>(numFilters, 0.5f, 0.25f);
+    LayerParameters batchNormParameters{ convLayer.GetOutput(), NoPadding(), { numRows, numColumns, numFilters }, NoPadding() };
+    BatchNormalizationLayer<ElementType> batchNormLayer(batchNormParameters, VectorType(mean), VectorType(variance), 1.0e-5f, EpsilonSummand::Variance);
+
+    Shape paddedOutputShape = { numRows + 2 * outputPaddingSize, numColumns + 2 * outputPaddingSize, numFilters };
+    Shape scalingOutputShape = hasBias ? Shape{ numRows, numColumns, numFilters } : paddedOutputShape;
+    LayerParameters scalingParameters{ batchNormLayer.GetOutput(), NoPadding(), scalingOutputShape, hasBias ? NoPadding() : ZeroPadding(outputPaddingSize) };
+    ScalingLayer<ElementType> scalingLayer(scalingParameters, VectorType(GenerateValues<ElementType>(numFilters, 2.0f, -0.5f)));
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto convNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, convLayer);
+    auto batchNormNode = model.AddNode<nodes::BatchNormalizationLayerNode<ElementType>>(convNode->output, batchNormLayer);
+    auto scalingNode = model.AddNode<nodes::ScalingLayerNode<ElementType>>(batchNormNode->output, scalingLayer);
+    const model::OutputPort<ElementType>* output = &scalingNode->output;
+    if (hasBias)
+    {
+        LayerParameters biasParameters{ scalingLayer.GetOutput(), NoPadding(), paddedOutputShape, ZeroPadding(outputPaddingSize) };
+        BiasLayer<ElementType> biasLayer(biasParameters, VectorType(GenerateValues<ElementType>(numFilters, 0.25f, 0.5f)));
+        output = &model.AddNode<nodes::BiasLayerNode<ElementType>>(*output, biasLayer)->output;
+    }
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", *output } });
+
+    // Generate input data, with zeros in the padding
+    std::vector<ElementType> testInput = GenerateValues<ElementType>(inputWithPadding.Size(), -2.0f, 0.03125f);
+    const size_t paddedRows = numRows + 2 * inputPaddingSize;
+    const size_t paddedColumns = numColumns + 2 * inputPaddingSize;
+    for (size_t row = 0; row < paddedRows; ++row)
+    {
+        for (size_t column = 0; column < paddedColumns; ++column)
+        {
+            if (row < inputPaddingSize || row >= paddedRows - inputPaddingSize || column < inputPaddingSize || column >= paddedColumns - inputPaddingSize)
+            {
+                std::fill_n(testInput.begin() + (row * paddedColumns + column) * numChannels, numChannels, 0.0f);
+            }
+        }
+    }
+
+    std::string testName = "convolution method " + std::to_string(static_cast<int>(method)) + (hasBias ? " with bias" : " without bias");
+    TestFoldAffineLayersTransformation(map, testInput, hasBias, testName);
+}
+
+void TestFoldAffineLayersIntoFullyConnectedTransformation()
+{
+    using namespace predictors::neural;
+
+    using ElementType = double;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using MatrixType = typename Layer<ElementType>::MatrixType;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using VectorType = typename Layer<ElementType>::VectorType;
+
+    const size_t numOutputs = 6;
+    TensorType input(2, 2, 3);
+    LayerParameters fullyConnectedParameters{ input, NoPadding(), { 1, 1, numOutputs }, NoPadding() };
+    MatrixType weights(numOutputs, input.Size());
+    auto weightValues = GenerateValues<ElementType>(weights.NumRows() * weights.NumColumns(), -1.0, 0.03125);
+    for (size_t row = 0; row < weights.NumRows(); ++row)
+    {
+        for (size_t column = 0; column < weights.NumColumns(); ++column)
+        {
+            weights(row, column) = weightValues[row * weights.NumColumns() + column];
+        }
+    }
+    FullyConnectedLayer<ElementType> fullyConnectedLayer(fullyConnectedParameters, weights);
+
+    LayerParameters batchNormParameters{ fullyConnectedLayer.GetOutput(), NoPadding(), { 1, 1, numOutputs }, NoPadding() };
+    BatchNormalizationLayer<ElementType> batchNormLayer(batchNormParameters, VectorType(GenerateValues<ElementType>(numOutputs, 1.0, -0.5)), VectorType(GenerateValues<ElementType>(numOutputs, 0.25, 0.5)), 1.0e-3, EpsilonSummand::SqrtVariance);
+    LayerParameters biasParameters{ batchNormLayer.GetOutput(), NoPadding(), { 1, 1, numOutputs }, NoPadding() };
+    BiasLayer<ElementType> biasLayer(biasParameters, VectorType(GenerateValues<ElementType>(numOutputs, -0.5, 0.25)));
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(input.Size());
+    auto fullyConnectedNode = model.AddNode<nodes::FullyConnectedLayerNode<ElementType>>(inputNode->output, fullyConnectedLayer);
+    auto batchNormNode = model.AddNode<nodes::BatchNormalizationLayerNode<ElementType>>(fullyConnectedNode->output, batchNormLayer);
+    auto biasNode = model.AddNode<nodes::BiasLayerNode<ElementType>>(batchNormNode->output, biasLayer);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", biasNode->output } });
+
+    auto testInput = GenerateValues<ElementType>(input.Size(), -1.0, 0.25);
+    TestFoldAffineLayersTransformation(map, testInput, true, "fully-connected layer");
+}
+
+void TestFoldAffineLayersTransformation()
+{
+    using predictors::neural::ConvolutionMethod;
+    for (auto method : { ConvolutionMethod::diagonal, ConvolutionMethod::simple, ConvolutionMethod::unrolled, ConvolutionMethod::winograd })
+    {
+        TestFoldAffineLayersIntoConvolutionTransformation(method, true);
+        TestFoldAffineLayersIntoConvolutionTransformation(method, false);
+    }
+    TestFoldAffineLayersIntoFullyConnectedTransformation();
+}
+
+// Checks that fusing the layer epilogues in `map` removes the bias and activation layers and leaves the output
+// unchanged, both when computed on the host and when compiled
+template <typename ElementType>
+void TestFuseLayerEpiloguesTransformation(model::Map& map, const std::vector<ElementType>& testInput, const std::string& testName, bool useBlas = true)
+{
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.template ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.useBlas = useBlas;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["fuseLayerEpilogues"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    passes::FuseLayerEpiloguesTransformation fuseEpilogues;
+    map.Transform(fuseEpilogues, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    bool fusedLayers = !HasNodeWithTypeName(newModel, nodes::BiasLayerNode<ElementType>::GetTypeName()) &&
+                       !HasNodeWithTypeName(newModel, nodes::ActivationLayerNode<ElementType>::GetTypeName()) &&
+                       !HasNodeWithTypeName(newModel, nodes::ParametricReLUActivationLayerNode<ElementType>::GetTypeName());
+    testing::ProcessTest("Testing FuseLayerEpiloguesTransformation node types for " + testName, fusedLayers);
+
+    map.SetInputValue("input", testInput);
+    auto fusedOutput = map.template ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing FuseLayerEpiloguesTransformation result for " + testName, testing::IsEqual(referenceOutput, fusedOutput, static_cast<ElementType>(1e-4)));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", testInput);
+    auto compiledOutput = compiledMap.template ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled FuseLayerEpiloguesTransformation result for " + testName, testing::IsEqual(referenceOutput, compiledOutput, static_cast<ElementType>(1e-4)));
+}
+
+enum class TestEpilogueActivation
+{
+    none,
+    reLU,
+    leakyReLU,
+    parametricReLU
+};
+
+std::string GetTestEpilogueActivationName(TestEpilogueActivation activation)
+{
+    switch (activation)
+    {
+    case TestEpilogueActivation::none:
+        return "no activation";
+    case TestEpilogueActivation::reLU:
+        return "ReLU";
+    case TestEpilogueActivation::leakyReLU:
+        return "leaky ReLU";
+    case TestEpilogueActivation::parametricReLU:
+        return "parametric ReLU";
+    }
+    return "";
+}
+
+// Appends an optional bias layer and an activation layer to `layerNode`, the last of which writes output with the given padding
+template <typename ElementType>
+const model::OutputPort<ElementType>& AddEpilogueLayers(model::Model& model, const nodes::NeuralNetworkLayerNodeBase<ElementType>& layerNode, bool hasBias, TestEpilogueActivation activation, size_t outputPaddingSize)
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using VectorType = typename Layer<ElementType>::VectorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const auto& layer = layerNode.GetBaseLayer();
+    const auto activeShape = layer.GetOutputShapeMinusPadding();
+    const Shape paddedOutputShape = { activeShape.NumRows() + 2 * outputPaddingSize, activeShape.NumColumns() + 2 * outputPaddingSize, activeShape.NumChannels() };
+
+    const model::OutputPort<ElementType>* output = &layerNode.output;
+    auto input = layer.GetOutput();
+    if (hasBias)
+    {
+        bool isLast = activation == TestEpilogueActivation::none;
+        LayerParameters biasParameters{ input, NoPadding(), isLast ? paddedOutputShape : activeShape, isLast ? ZeroPadding(outputPaddingSize) : NoPadding() };
+        BiasLayer<ElementType> biasLayer(biasParameters, VectorType(GenerateValues<ElementType>(activeShape.NumChannels(), -0.5, 0.25)));
+        auto biasNode = model.AddNode<nodes::BiasLayerNode<ElementType>>(*output, biasLayer);
+        output = &biasNode->output;
+        input = biasNode->GetLayer().GetOutput();
+    }
+
+    LayerParameters activationParameters{ input, NoPadding(), paddedOutputShape, ZeroPadding(outputPaddingSize) };
+    switch (activation)
+    {
+    case TestEpilogueActivation::none:
+        break;
+    case TestEpilogueActivation::reLU:
+    {
+        ActivationLayer<ElementType> activationLayer(activationParameters, new ReLUActivation<ElementType>());
+        output = &model.AddNode<nodes::ActivationLayerNode<ElementType>>(*output, activationLayer)->output;
+        break;
+    }
+    case TestEpilogueActivation::leakyReLU:
+    {
+        ActivationLayer<ElementType> activationLayer(activationParameters, new LeakyReLUActivation<ElementType>(static_cast<ElementType>(0.125)));
+        output = &model.AddNode<nodes::ActivationLayerNode<ElementType>>(*output, activationLayer)->output;
+        break;
+    }
+    case TestEpilogueActivation::parametricReLU:
+    {
+        TensorType alpha(activeShape);
+        alpha.Generate(Increment<ElementType>(0.0625, 0.03125));
+        ActivationLayer<ElementType> activationLayer(activationParameters, new ParametricReLUActivation<ElementType>(alpha));
+        output = &model.AddNode<nodes::ParametricReLUActivationLayerNode<ElementType>>(*output, activationLayer)->output;
+        break;
+    }
+    }
+    return *output;
+}
+
+void TestFuseLayerEpiloguesIntoConvolutionTransformation(predictors::neural::ConvolutionMethod method, bool hasBias, TestEpilogueActivation activation, bool useBlas = true)
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+
+    const size_t numRows = 4;
+    const size_t numColumns = 5;
+    const size_t numChannels = 3;
+    const size_t numFilters = 4;
+    const size_t receptiveField = 3;
+    const size_t inputPaddingSize = 1;
+    const size_t outputPaddingSize = 1;
+
+    TensorType inputWithPadding(numRows + 2 * inputPaddingSize, numColumns + 2 * inputPaddingSize, numChannels);
+    LayerParameters convParameters{ inputWithPadding, ZeroPadding(inputPaddingSize), { numRows, numColumns, numFilters }, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ receptiveField, 1, method, 2 };
+    TensorType weights(receptiveField * numFilters, receptiveField, numChannels);
+    weights.Generate(Increment<ElementType>(-1.0f, 0.0625f));
+    ConvolutionalLayer<ElementType> convLayer(convParameters, convolutionalParams, weights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto convNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, convLayer);
+    const auto& output = AddEpilogueLayers<ElementType>(model, *convNode, hasBias, activation, outputPaddingSize);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+
+    // Generate input data, with zeros in the padding
+    std::vector<ElementType> testInput = GenerateValues<ElementType>(inputWithPadding.Size(), -2.0f, 0.03125f);
+    const size_t paddedRows = numRows + 2 * inputPaddingSize;
+    const size_t paddedColumns = numColumns + 2 * inputPaddingSize;
+    for (size_t row = 0; row < paddedRows; ++row)
+    {
+        for (size_t column = 0; column < paddedColumns; ++column)
+        {
+            if (row < inputPaddingSize || row >= paddedRows - inputPaddingSize || column < inputPaddingSize || column >= paddedColumns - inputPaddingSize)
+            {
+                std::fill_n(testInput.begin() + (row * paddedColumns + column) * numChannels, numChannels, 0.0f);
+            }
+        }
+    }
+
+    std::string testName = "convolution method " + std::to_string(static_cast<int>(method)) + (hasBias ? " with bias and " : " with ") + GetTestEpilogueActivationName(activation) + (useBlas ? "" : " without BLAS");
+    TestFuseLayerEpiloguesTransformation(map, testInput, testName, useBlas);
+}
+
+void TestFuseLayerEpiloguesIntoFullyConnectedTransformation(bool hasBias, TestEpilogueActivation activation)
+{
+    using namespace predictors::neural;
+
+    using ElementType = double;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using MatrixType = typename Layer<ElementType>::MatrixType;
+    using TensorType = typename Layer<ElementType>::TensorType;
+
+    const size_t numOutputs = 6;
+    TensorType input(2, 2, 3);
+    LayerParameters fullyConnectedParameters{ input, NoPadding(), { 1, 1, numOutputs }, NoPadding() };
+    MatrixType weights(numOutputs, input.Size());
+    auto weightValues = GenerateValues<ElementType>(weights.NumRows() * weights.NumColumns(), -1.0, 0.03125);
+    for (size_t row = 0; row < weights.NumRows(); ++row)
+    {
+        for (size_t column = 0; column < weights.NumColumns(); ++column)
+        {
+            weights(row, column) = weightValues[row * weights.NumColumns() + column];
+        }
+    }
+    FullyConnectedLayer<ElementType> fullyConnectedLayer(fullyConnectedParameters, weights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(input.Size());
+    auto fullyConnectedNode = model.AddNode<nodes::FullyConnectedLayerNode<ElementType>>(inputNode->output, fullyConnectedLayer);
+    const auto& output = AddEpilogueLayers<ElementType>(model, *fullyConnectedNode, hasBias, activation, 0);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+
+    auto testInput = GenerateValues<ElementType>(input.Size(), -1.0, 0.25);
+    TestFuseLayerEpiloguesTransformation(map, testInput, std::string("fully-connected layer") + (hasBias ? " with bias and " : " with ") + GetTestEpilogueActivationName(activation));
+}
+
+void TestFuseLayerEpiloguesTransformation()
+{
+    using predictors::neural::ConvolutionMethod;
+    for (auto method : { ConvolutionMethod::diagonal, ConvolutionMethod::simple, ConvolutionMethod::unrolled, ConvolutionMethod::winograd })
+    {
+        TestFuseLayerEpiloguesIntoConvolutionTransformation(method, true, TestEpilogueActivation::none);
+        TestFuseLayerEpiloguesIntoConvolutionTransformation(method, true, TestEpilogueActivation::reLU);
+        TestFuseLayerEpiloguesIntoConvolutionTransformation(method, false, TestEpilogueActivation::leakyReLU);
+        TestFuseLayerEpiloguesIntoConvolutionTransformation(method, true, TestEpilogueActivation::parametricReLU);
+    }
+
+    // Without BLAS, the unrolled method's matrix multiply applies the epilogue in the native GEMM's micro-kernel
+    TestFuseLayerEpiloguesIntoConvolutionTransformation(ConvolutionMethod::unrolled, true, TestEpilogueActivation::reLU, false);
+    TestFuseLayerEpiloguesIntoConvolutionTransformation(ConvolutionMethod::unrolled, true, TestEpilogueActivation::parametricReLU, false);
+    TestFuseLayerEpiloguesIntoFullyConnectedTransformation(true, TestEpilogueActivation::reLU);
+    TestFuseLayerEpiloguesIntoFullyConnectedTransformation(true, TestEpilogueActivation::parametricReLU);
+}
+
+// Builds a model that computes a per-channel bias and a ReLU on a 3D input in channel-major order. If `reorderOutput`
+// is true, the result is reordered back to the input's row-major order.
+model::Map GetChannelMajorElementwiseModel(int numRows, int numColumns, int numChannels, bool reorderInput, bool reorderOutput)
+{
+    using ValueType = float;
+    model::PortMemoryLayout rowMajorLayout({ numRows, numColumns, numChannels });
+    auto channelMajorLayout = rowMajorLayout.ReorderedCopy({ 2, 0, 1 });
+    auto elementwiseLayout = reorderInput ? channelMajorLayout : rowMajorLayout;
+    auto channelDimension = elementwiseLayout.GetPhysicalDimension(2);
+
+    std::vector<ValueType> biasValues(numChannels);
+    std::generate(biasValues.begin(), biasValues.end(), Increment<ValueType>(-2.0f));
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(rowMajorLayout.GetActiveSize());
+    const model::OutputPort<ValueType>* input = &inputNode->output;
+    if (reorderInput)
+    {
+        input = &model.AddNode<nodes::ReorderDataNode<ValueType>>(*input, model::DimensionOrder{ 2, 0, 1 })->output;
+    }
+    auto biasNode = model.AddNode<nodes::ConstantNode<ValueType>>(biasValues);
+    auto emptyNode = model.AddNode<nodes::ConstantNode<ValueType>>();
+    auto biasFunctionNode = model.AddNode<nodes::BroadcastLinearFunctionNode<ValueType>>(*input, elementwiseLayout, emptyNode->output, biasNode->output, channelDimension, elementwiseLayout);
+    auto reluNode = model.AddNode<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>>(biasFunctionNode->output, elementwiseLayout, elementwiseLayout);
+    const model::OutputPort<ValueType>* output = &reluNode->output;
+    if (reorderOutput)
+    {
+        auto outputOrder = reorderInput ? model::DimensionOrder{ 0, 1, 2 } : model::DimensionOrder{ 2, 0, 1 };
+        output = &model.AddNode<nodes::ReorderDataNode<ValueType>>(*output, outputOrder)->output;
+    }
+    return model::Map(model, { { "input", inputNode } }, { { "output", *output } });
+}
+
+void TestAssignMemoryLayoutsTransformation(bool reorderInput, bool reorderOutput, bool expectImprovement)
+{
+    using ValueType = float;
+    int numRows = 3;
+    int numColumns = 4;
+    int numChannels = 5;
+    auto map = GetChannelMajorElementwiseModel(numRows, numColumns, numChannels, reorderInput, reorderOutput);
+    std::string testName = std::string("elementwise nodes with ") + (reorderInput ? "reordered input" : "row-major input") + (reorderOutput ? " and reordered output" : "");
+
+    std::vector<ValueType> testInput(numRows * numColumns * numChannels);
+    std::generate(testInput.begin(), testInput.end(), Increment<ValueType>(-10.0f, 0.25f));
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+    auto oldBytes = passes::GetReorderDataNodeBytes(map.GetModel());
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["assignMemoryLayouts"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    passes::AssignMemoryLayoutsTransformation assignLayouts;
+    map.Transform(assignLayouts, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    auto newBytes = passes::GetReorderDataNodeBytes(map.GetModel());
+    if (expectImprovement)
+    {
+        testing::ProcessTest("Testing reordered bytes after AssignMemoryLayoutsTransformation for " + testName, oldBytes > 0 && newBytes == 0);
+    }
+    else
+    {
+        testing::ProcessTest("Testing reordered bytes are unchanged by AssignMemoryLayoutsTransformation for " + testName, newBytes == oldBytes);
+    }
+
+    map.SetInputValue("input", testInput);
+    auto optimizedOutput = map.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing AssignMemoryLayoutsTransformation result for " + testName, testing::IsEqual(referenceOutput, optimizedOutput));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", testInput);
+    auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing compiled AssignMemoryLayoutsTransformation result for " + testName, testing::IsEqual(referenceOutput, compiledOutput));
+}
+
+// A refined binary convolution writes channel-major output and permutes it to row-major order. If the layers after it
+// can work in channel-major order, the permutation isn't needed.
+void TestAssignMemoryLayoutsToBinaryConvolution()
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+
+    const size_t numRows = 4;
+    const size_t numColumns = 5;
+    const size_t numChannels = 3;
+    const size_t numFilters = 4;
+    const size_t receptiveField = 3;
+    const size_t inputPaddingSize = 1;
+
+    TensorType inputWithPadding(numRows + 2 * inputPaddingSize, numColumns + 2 * inputPaddingSize, numChannels);
+    LayerParameters convParameters{ inputWithPadding, ZeroPadding(inputPaddingSize), { numRows, numColumns, numFilters }, NoPadding() };
+    BinaryConvolutionalParameters convolutionalParams{ receptiveField, 1, BinaryConvolutionMethod::bitwise, BinaryWeightsScale::mean };
+    TensorType weights(receptiveField * numFilters, receptiveField, numChannels);
+    weights.Generate(Increment<ElementType>(-1.0f, 0.0625f));
+    BinaryConvolutionalLayer<ElementType> convLayer(convParameters, convolutionalParams, weights);
+
+    // The binary convolution is followed by a ReLU, and the result is wanted in channel-major order
+    model::PortMemoryLayout rowMajorLayout({ static_cast<int>(numRows), static_cast<int>(numColumns), static_cast<int>(numFilters) });
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto convNode = model.AddNode<nodes::BinaryConvolutionalLayerNode<ElementType>>(inputNode->output, convLayer);
+    auto reluNode = model.AddNode<nodes::BroadcastUnaryFunctionNode<ElementType, nodes::ReLUActivationFunction<ElementType>>>(convNode->output, rowMajorLayout, rowMajorLayout);
+    auto reorderNode = model.AddNode<nodes::ReorderDataNode<ElementType>>(reluNode->output, model::DimensionOrder{ 2, 0, 1 });
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", reorderNode->output } });
+
+    std::vector<ElementType> testInput(inputWithPadding.Size());
+    std::generate(testInput.begin(), testInput.end(), Increment<ElementType>(-2.0f, 0.03125f));
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["assignMemoryLayouts"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    map.Refine();
+    auto oldBytes = passes::GetReorderDataNodeBytes(map.GetModel());
+    passes::AssignMemoryLayoutsTransformation assignLayouts;
+    map.Transform(assignLayouts, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    auto newBytes = passes::GetReorderDataNodeBytes(map.GetModel());
+    testing::ProcessTest("Testing reordered bytes after AssignMemoryLayoutsTransformation for binary convolution", oldBytes > 0 && newBytes == 0);
+
+    // The refined binary convolution can only be compiled
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", testInput);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled AssignMemoryLayoutsTransformation result for binary convolution", testing::IsEqual(referenceOutput, compiledOutput, 1.0e-5f));
+}
+
+void TestAssignMemoryLayoutsTransformation()
+{
+    // Reordering into channel-major order and back can be skipped entirely
+    TestAssignMemoryLayoutsTransformation(true, true, true);
+
+    // The channel-major result is required, so one reorder remains, wherever it goes
+    TestAssignMemoryLayoutsTransformation(true, false, false);
+    TestAssignMemoryLayoutsTransformation(false, true, false);
+
+    TestAssignMemoryLayoutsToBinaryConvolution();
+}
+
 void TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod convolutionMethod, std::string expectedNodeTypeName)
 {
     using namespace predictors::neural;
@@ -285,12 +924,189 @@ void TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod co
     testing::ProcessTest("Testing SetConvolutionMethodTransformation for " + expectedNodeTypeName, HasNodeWithTypeName(map.GetModel(), expectedNodeTypeName));
 }
 
+void TestFuseDepthwisePointwiseConvolutions(bool fuse, bool padPointwiseInput)
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const size_t inputPaddingSize = 1;
+    const size_t pointwisePaddingSize = padPointwiseInput ? 1 : 0;
+    const int size = 8;
+    const int numChannels = 12;
+    const int numFilters = 6;
+    TensorType inputWithPadding(size + 2 * inputPaddingSize, size + 2 * inputPaddingSize, numChannels);
+
+    // A 3x3 depthwise convolution followed by a 1x1 convolution, as in a MobileNet block. If the 1x1 convolution's input
+    // is padded, its output is bigger than its input, which the fused node can't produce.
+    Shape depthwiseOutputShape = { size + 2 * pointwisePaddingSize, size + 2 * pointwisePaddingSize, numChannels };
+    LayerParameters depthwiseParameters{ inputWithPadding, ZeroPadding(inputPaddingSize), depthwiseOutputShape, ZeroPadding(pointwisePaddingSize) };
+    ConvolutionalParameters depthwiseConvolutionalParams{ 3, 1, ConvolutionMethod::automatic, 1 };
+    TensorType depthwiseWeights(depthwiseConvolutionalParams.receptiveField * numChannels, depthwiseConvolutionalParams.receptiveField, 1);
+    int weightIndex = 0;
+    depthwiseWeights.Generate([&weightIndex]() { return static_cast<ElementType>((weightIndex++ % 11) - 5) / 5; });
+    ConvolutionalLayer<ElementType> depthwiseLayer(depthwiseParameters, depthwiseConvolutionalParams, depthwiseWeights);
+
+    TensorType depthwiseOutput(size + 2 * pointwisePaddingSize, size + 2 * pointwisePaddingSize, numChannels);
+    Shape pointwiseOutputShape = { size + 2 * pointwisePaddingSize, size + 2 * pointwisePaddingSize, numFilters };
+    LayerParameters pointwiseParameters{ depthwiseOutput, ZeroPadding(pointwisePaddingSize), pointwiseOutputShape, NoPadding() };
+    ConvolutionalParameters pointwiseConvolutionalParams{ 1, 1, ConvolutionMethod::automatic, 1 };
+    TensorType pointwiseWeights(numFilters, 1, numChannels);
+    pointwiseWeights.Generate([&weightIndex]() { return static_cast<ElementType>((weightIndex++ % 7) - 3) / 3; });
+    ConvolutionalLayer<ElementType> pointwiseLayer(pointwiseParameters, pointwiseConvolutionalParams, pointwiseWeights);
+
+    nodes::FusedEpilogue<ElementType> depthwiseEpilogue;
+    depthwiseEpilogue.activation = nodes::EpilogueActivationType::reLU;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto depthwiseNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, depthwiseLayer, depthwiseEpilogue);
+    auto pointwiseNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(depthwiseNode->output, pointwiseLayer);
+
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", pointwiseNode->output } });
+    std::vector<ElementType> input(inputWithPadding.Size());
+    for (size_t index = 0; index < input.size(); ++index)
+    {
+        input[index] = static_cast<ElementType>(index % 7) / 7;
+    }
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["fuseDepthwisePointwiseConvolutions"] = fuse;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    passes::SetConvolutionMethodTransformation setConvMethod;
+    map.Transform(setConvMethod, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const bool expectFused = fuse && !padPointwiseInput;
+    std::string testName = expectFused ? "fused depthwise and pointwise convolutions" : "separate depthwise and pointwise convolutions";
+    if (padPointwiseInput)
+    {
+        testName += " with a padded pointwise input";
+    }
+    bool hasDepthwiseNode = HasNodeWithTypeName(map.GetModel(), "DepthwiseConvolutionNode<float>");
+    bool hasPointwiseNode = HasNodeWithTypeName(map.GetModel(), "UnrolledConvolutionNode<float>");
+    testing::ProcessTest("Testing SetConvolutionMethodTransformation node types for " + testName, hasDepthwiseNode && (hasPointwiseNode != expectFused));
+
+    map.SetInputValue("input", input);
+    auto transformedOutput = map.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing SetConvolutionMethodTransformation result for " + testName, testing::IsEqual(referenceOutput, transformedOutput, static_cast<ElementType>(1e-4)));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled SetConvolutionMethodTransformation result for " + testName, testing::IsEqual(referenceOutput, compiledOutput, static_cast<ElementType>(1e-4)));
+}
+
 void TestSetConvolutionMethodTransformation()
 {
     TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::diagonal, "DiagonalConvolutionNode<float>");
     TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::simple, "SimpleConvolutionNode<float>");
     TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::winograd, "WinogradConvolutionNode<float>");
     TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::unrolled, "UnrolledConvolutionNode<float>");
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::blocked, "BlockedConvolutionNode<float>");
+
+    // Depthwise-separable layers use the depthwise method unless another one is asked for
+    TestFuseDepthwisePointwiseConvolutions(false, false);
+    TestFuseDepthwisePointwiseConvolutions(true, false);
+
+    // The fusion is rejected if the pointwise layer pads its input
+    TestFuseDepthwisePointwiseConvolutions(true, true);
+}
+
+void TestTuneConvolutionMethodTransformation()
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const size_t inputPaddingSize = 1;
+    const size_t outputPaddingSize = 0;
+    const int size = 8;
+    const int numChannels = 4;
+    const int numFilters = 6;
+    TensorType inputWithPadding(size + 2 * inputPaddingSize, size + 2 * inputPaddingSize, numChannels);
+    Shape outputShape = { size + 2 * outputPaddingSize, size + 2 * outputPaddingSize, numFilters };
+
+    LayerParameters parameters{ inputWithPadding, ZeroPadding(inputPaddingSize), outputShape, ZeroPadding(outputPaddingSize) };
+    ConvolutionalParameters convolutionalParams{ 3, 1, ConvolutionMethod::automatic, 2 };
+
+    TensorType weights(convolutionalParams.receptiveField * numFilters, convolutionalParams.receptiveField, numChannels);
+    int weightIndex = 0;
+    weights.Generate([&weightIndex]() { return static_cast<ElementType>((weightIndex++ % 11) - 5) / 5; });
+    ConvolutionalLayer<ElementType> layer(parameters, convolutionalParams, weights);
+
+    // Two identical layers, one of which already has a preferred method
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto tunedNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, layer);
+    auto presetNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, layer);
+    utilities::PropertyBag presetOptions;
+    presetOptions["preferredConvolutionMethod"] = std::string("simple");
+    presetNode->GetMetadata()["compileOptions"] = presetOptions;
+    auto outputNode = model.AddNode<nodes::BinaryOperationNode<ElementType>>(tunedNode->output, presetNode->output, nodes::BinaryOperationType::add);
+
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", outputNode->output } });
+    std::vector<ElementType> input(inputWithPadding.Size());
+    for (size_t index = 0; index < input.size(); ++index)
+    {
+        input[index] = static_cast<ElementType>(index % 7) / 7;
+    }
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    passes::TuneConvolutionMethodTransformation tuneConvMethod(settings, optimizerOptions, 2);
+    map.Transform(tuneConvMethod);
+
+    std::vector<std::string> methods;
+    bool hasWinogradTileSizes = true;
+    map.GetModel().Visit([&methods, &hasWinogradTileSizes](const model::Node& node) {
+        if (dynamic_cast<const nodes::ConvolutionalLayerNode<ElementType>*>(&node) != nullptr)
+        {
+            const auto& metadata = node.GetMetadata();
+            std::string method;
+            if (metadata.HasEntry("compileOptions") && metadata.GetEntry<utilities::PropertyBag>("compileOptions").HasEntry("preferredConvolutionMethod"))
+            {
+                const auto& compileOptions = metadata.GetEntry<utilities::PropertyBag>("compileOptions");
+                method = compileOptions.GetEntry<std::string>("preferredConvolutionMethod");
+
+                // A tuned Winograd method comes with the tile size it was timed with
+                if (method == "winograd")
+                {
+                    auto tileSize = compileOptions.HasEntry("winogradTileSize") ? compileOptions.GetEntry<int>("winogradTileSize") : 0;
+                    hasWinogradTileSizes = hasWinogradTileSizes && (tileSize == 2 || tileSize == 4 || tileSize == 6);
+                }
+            }
+            methods.push_back(method);
+        }
+    });
+
+    auto isTuned = [](const std::string& method) { return !method.empty() && method != "automatic"; };
+    testing::ProcessTest("Testing TuneConvolutionMethodTransformation records a method for each layer", methods.size() == 2 && isTuned(methods[0]) && isTuned(methods[1]));
+    testing::ProcessTest("Testing TuneConvolutionMethodTransformation records the Winograd tile size", hasWinogradTileSizes);
+    testing::ProcessTest("Testing TuneConvolutionMethodTransformation keeps existing methods", std::count(methods.begin(), methods.end(), "simple") >= 1);
+
+    // The tuned choice is used by later compiles
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled result of tuned convolution methods", testing::IsEqual(referenceOutput, compiledOutput, 1e-4f));
 }
 
 void TestOptimizeReorderDataNodesTransformation1()
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictor.h (predictors)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ForestPredictor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ell
+{
+namespace predictors
+{
+    /// <summary> An immutable snapshot of a `SimpleForestPredictor`, laid out for fast evaluation. The interior nodes of
+    /// each tree are stored contiguously in separate arrays of feature indices, thresholds and children, and the edge
+    /// values along each path are folded into the leaf at its end, so evaluating a tree only touches a few small arrays.
+    /// `PredictBatch` evaluates a block of examples one tree at a time, so each tree stays in the cache while the whole
+    /// block goes through it, and can split the blocks among threads.
+    ///
+    /// The snapshot gives exactly the same outputs as the forest it was made from, but doesn't change when the forest
+    /// does, so make a new one after splitting the forest. </summary>
+    class FlatForestPredictor
+    {
+    public:
+        /// <summary> Type of the data vector expected by this predictor type. </summary>
+        using DataVectorType = SimpleForestPredictor::DataVectorType;
+
+        /// <summary> Constructs a snapshot of a forest. </summary>
+        ///
+        /// <param name="forest"> The forest. </param>
+        FlatForestPredictor(const SimpleForestPredictor& forest);
+
+        /// <summary> Gets the number of trees in the forest. </summary>
+        ///
+        /// <returns> The number of trees. </returns>
+        size_t NumTrees() const { return _treeRoots.size(); }
+
+        /// <summary> Gets the bias value. </summary>
+        ///
+        /// <returns> The bias. </returns>
+        double GetBias() const { return _bias; }
+
+        /// <summary> Returns the output of the forest (including all trees and the bias term) for a given input. </summary>
+        ///
+        /// <param name="input"> The input vector. </param>
+        ///
+        /// <returns> The prediction. </returns>
+        double Predict(const DataVectorType& input) const;
+
+        /// <summary> Returns the outputs of the forest for a set of inputs. </summary>
+        ///
+        /// <param name="inputs"> The input vectors. </param>
+        /// <param name="numThreads"> The number of threads to use, or 0 to use one per hardware thread. </param>
+        ///
+        /// <returns> The predictions, one per input. </returns>
+        std::vector<double> PredictBatch(const std::vector<DataVectorType>& inputs, size_t numThreads = 1) const;
+
+        /// <summary> Returns the outputs of the forest for a set of inputs. </summary>
+        ///
+        /// <param name="numExamples"> The number of inputs. </param>
+        /// <param name="getInput"> A function that returns the input vector with a given index. It may be called from several threads at once. </param>
+        /// <param name="numThreads"> The number of threads to use, or 0 to use one per hardware thread. </param>
+        ///
+        /// <returns> The predictions, one per input. </returns>
+        std::vector<double> PredictBatch(size_t numExamples, const std::function<const DataVectorType&(size_t)>& getInput, size_t numThreads = 1) const;
+
+    private:
+        void AddTree(const SimpleForestPredictor& forest, size_t rootIndex);
+        void PredictBlock(const std::vector<const DataVectorType*>& inputs, double* outputs) const;
+
+        // One entry per interior node, with the nodes of each tree stored together
+        std::vector<int32_t> _featureIndices;
+        std::vector<float> _thresholds; // the largest float that's not above the split rule's threshold
+        std::vector<int32_t> _children; // two per node: the index of an interior node, or the bitwise complement of a leaf's index
+
+        // One entry per leaf: the sum of the edge values on the path to the leaf
+        std::vector<double> _leafValues;
+
+        // One entry per tree
+        std::vector<int32_t> _treeRoots;
+
+        double _bias = 0.0;
+    };
+} // namespace predictors
+} // namespace ell
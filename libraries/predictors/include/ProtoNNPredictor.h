@@ -18,6 +18,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace ell
 {
@@ -25,7 +27,9 @@ namespace predictors
 {
     /// <summary> A ProtoNN predictor. </summary>
     ///
-    class ProtoNNPredictor : public IPredictor<double>
+    /// <typeparam name="ElementType"> The fundamental type used by this predictor. </typeparam>
+    template <typename ElementType>
+    class ProtoNNPredictor : public IPredictor<ElementType>
         , public utilities::IArchivable
     {
     public:
@@ -42,47 +46,55 @@ namespace predictors
         /// <param name="numPrototypes"> Number of prototypes. </param>
         /// <param name="numLabels"> Number of labels. </param>
         /// <param name="gamma"> The Gamma value. </param>
-        ProtoNNPredictor(size_t dim, size_t projectedDim, size_t numPrototypes, size_t numLabels, double gamma);
+        ProtoNNPredictor(size_t dim, size_t projectedDim, size_t numPrototypes, size_t numLabels, ElementType gamma);
+
+        /// <summary> Constructs an instance of a ProtoNNPredictor from an existing one. </summary>
+        ///
+        /// <param name="other"> The predictor to copy. </param>
+        /// <typeparam name="OtherElementType"> The fundamental type used by the other predictor. Since the ProtoNN trainer
+        /// outputs a predictor of type double, this can be used to create the same predictor using float. </typeparam>
+        template <typename OtherElementType>
+        ProtoNNPredictor(const ProtoNNPredictor<OtherElementType>& other);
 
         /// <summary> Returns the underlying projection matrix. </summary>
         ///
         /// <returns> The projection matrix. </returns>
-        math::ColumnMatrix<double>& GetProjectionMatrix() { return _W; }
+        math::ColumnMatrix<ElementType>& GetProjectionMatrix() { return _W; }
 
         /// <summary> Returns the underlying projection matrix. </summary>
         ///
         /// <returns> The underlying projection matrix. </returns>
-        const math::ColumnMatrix<double>& GetProjectionMatrix() const { return _W; }
+        const math::ColumnMatrix<ElementType>& GetProjectionMatrix() const { return _W; }
 
         /// <summary> Returns the underlying prototype matrix. </summary>
         ///
         /// <returns> The underlying prototype matrix. </returns>
-        math::ColumnMatrix<double>& GetPrototypes() { return _B; }
+        math::ColumnMatrix<ElementType>& GetPrototypes() { return _B; }
 
         /// <summary> Returns the underlying prototype matrix. </summary>
         ///
         /// <returns> The underlying prototype matrix. </returns>
-        const math::ColumnMatrix<double>& GetPrototypes() const { return _B; }
+        const math::ColumnMatrix<ElementType>& GetPrototypes() const { return _B; }
 
         /// <summary> Returns the underlying label embeddings. </summary>
         ///
         /// <returns> The label embeddings. </returns>
-        math::ColumnMatrix<double>& GetLabelEmbeddings() { return _Z; }
+        math::ColumnMatrix<ElementType>& GetLabelEmbeddings() { return _Z; }
 
         /// <summary> Returns the underlying label embeddings. </summary>
         ///
         /// <returns> The label embeddings. </returns>
-        const math::ColumnMatrix<double>& GetLabelEmbeddings() const { return _Z; }
+        const math::ColumnMatrix<ElementType>& GetLabelEmbeddings() const { return _Z; }
 
         /// <summary> Returns the underlying gamma. </summary>
         ///
         /// <returns> Gamma constant. </returns>
-        double& GetGamma() { return _gamma; }
+        ElementType& GetGamma() { return _gamma; }
 
         /// <summary> Returns the underlying gamma. </summary>
         ///
         /// <returns> Gamma constant. </returns>
-        double GetGamma() const { return _gamma; }
+        ElementType GetGamma() const { return _gamma; }
 
         /// <summary> Gets the dimension of the ProtoNN predictor. </summary>
         ///
@@ -109,14 +121,14 @@ namespace predictors
         /// <param name="inputVector"> The data vector. </param>
         ///
         /// <returns> The predicted label scores. </returns>
-        math::ColumnVector<double> Predict(const DataVectorType& inputVector) const;
+        math::ColumnVector<ElementType> Predict(const DataVectorType& inputVector) const;
 
         /// <summary> Returns the label scores. </summary>
         ///
         /// <param name="inputVector"> The data vector. </param>
         ///
         /// <returns> The predicted label scores. </returns>
-        math::ColumnVector<double> Predict(const std::vector<double>& inputVector) const;
+        math::ColumnVector<ElementType> Predict(const std::vector<ElementType>& inputVector) const;
 
         /// <summary> Resets the projection predictor to the zero projection matrix. </summary>
         void Reset();
@@ -124,7 +136,7 @@ namespace predictors
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
-        static std::string GetTypeName() { return "ProtoNNPredictor"; }
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ElementType>("ProtoNNPredictor"); }
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -136,22 +148,55 @@ namespace predictors
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
     private:
-        math::ColumnVector<double> GetLabelScores(const std::vector<double>& inputVector) const;
+        math::ColumnVector<ElementType> GetLabelScores(const std::vector<ElementType>& inputVector) const;
 
         // Input dimension
         size_t _dimension;
 
         // Projection matrix
-        math::ColumnMatrix<double> _W;
+        math::ColumnMatrix<ElementType> _W;
 
         // Prototypes matrix
-        math::ColumnMatrix<double> _B;
+        math::ColumnMatrix<ElementType> _B;
 
         // Label embedding matrix
-        math::ColumnMatrix<double> _Z;
+        math::ColumnMatrix<ElementType> _Z;
 
         // Gamma constant
-        double _gamma;
+        ElementType _gamma;
     };
 } // namespace predictors
 } // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace predictors
+{
+    template <typename ElementType>
+    template <typename OtherElementType>
+    ProtoNNPredictor<ElementType>::ProtoNNPredictor(const ProtoNNPredictor<OtherElementType>& other) :
+        _dimension(other.GetDimension()),
+        _W(other.GetProjectionMatrix().NumRows(), other.GetProjectionMatrix().NumColumns()),
+        _B(other.GetPrototypes().NumRows(), other.GetPrototypes().NumColumns()),
+        _Z(other.GetLabelEmbeddings().NumRows(), other.GetLabelEmbeddings().NumColumns()),
+        _gamma(static_cast<ElementType>(other.GetGamma()))
+    {
+        auto copyMatrix = [](const math::ColumnMatrix<OtherElementType>& from, math::ColumnMatrix<ElementType>& to) {
+            for (size_t i = 0; i < from.NumRows(); ++i)
+            {
+                for (size_t j = 0; j < from.NumColumns(); ++j)
+                {
+                    to(i, j) = static_cast<ElementType>(from(i, j));
+                }
+            }
+        };
+        copyMatrix(other.GetProjectionMatrix(), _W);
+        copyMatrix(other.GetPrototypes(), _B);
+        copyMatrix(other.GetLabelEmbeddings(), _Z);
+    }
+} // namespace predictors
+} // namespace ell
+
+#pragma endregion implementation
@@ -54,7 +54,7 @@ namespace predictors
         /// <returns> The threshold value. </returns>
         double GetThreshold() const { return _threshold; }
 
-        /// <summary> Evaluates the split rule. </summary>
+        /// <summary> Evaluates the split rule. If the input is shorter than the feature index, the feature is 0. </summary>
         ///
         /// <param name="dataVector"> The input vector. </param>
         ///
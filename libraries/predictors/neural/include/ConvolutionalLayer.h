@@ -31,7 +31,11 @@ namespace predictors
             /// <summary> An implementation that performs convolution with fewer arithmetic operations. </summary>
             winograd,
             /// <summary> Normal method of doing convolution via reshaping input into columns and performing a gemm operation. </summary>
-            unrolled
+            unrolled,
+            /// <summary> A direct convolution that computes blocks of output channels at a time in vector registers. </summary>
+            blocked,
+            /// <summary> A direct convolution for depthwise-separable layers that computes blocks of channels at a time in vector registers. </summary>
+            depthwise
         };
 
         /// <summary> Specifies the hyper parameters of the convolutional layer. </summary>
@@ -90,6 +94,16 @@ namespace predictors
             /// <returns> A ConvolutionalParameters struct. </returns>
             const ConvolutionalParameters& GetConvolutionalParameters() const { return _convolutionalParameters; }
 
+            /// <summary> Get the convolution method the layer was created with, before it was checked against the layer's shape. </summary>
+            ///
+            /// <returns> The requested convolution method. </returns>
+            ConvolutionMethod GetRequestedConvolutionMethod() const { return _originalConvolutionMethod; }
+
+            /// <summary> Indicates if the layer is depthwise-separable, meaning each filter is applied to a single input channel. </summary>
+            ///
+            /// <returns> true if the layer is depthwise-separable. </returns>
+            bool IsDepthwiseSeparable() const;
+
             /// <summary> Get the weights for the convolution filters. </summary>
             ///
             /// <returns> The weights, packed into a Tensor. </returns>
@@ -117,7 +131,6 @@ namespace predictors
             void InitializeIOMatrices();
             void Validate() const;
             void CalculateConvolutionMethod();
-            bool IsDepthwiseSeparable() const;
             void ComputeSimpleMethod();
             void ComputeUnrolledMethod();
             void ComputeWinogradMethod();
@@ -171,6 +184,7 @@ namespace predictors
                 switch (_convolutionalParameters.method)
                 {
                 case ConvolutionMethod::simple:
+                case ConvolutionMethod::blocked: // fallthrough
                     ComputeSimpleMethod();
                     break;
 
@@ -300,6 +314,7 @@ namespace predictors
                 switch (_convolutionalParameters.method)
                 {
                 case ConvolutionMethod::simple:
+                case ConvolutionMethod::depthwise: // fallthrough
                 {
                     auto result = dsp::Convolve2DSimpleDepthwiseSeparable(inputChannelTensor, weights, numFilters, stride);
                     outputChannelTensor.CopyFrom(result);
@@ -393,6 +408,13 @@ namespace predictors
             case ConvolutionMethod::unrolled: // fallthrough
                 // do nothing
                 break;
+            case ConvolutionMethod::blocked:
+                // The blocked method needs the input padded by half the filter size
+                if (_layerParameters.inputPaddingParameters.paddingSize != _convolutionalParameters.receptiveField / 2)
+                {
+                    _convolutionalParameters.method = IsDepthwiseSeparable() ? ConvolutionMethod::simple : ConvolutionMethod::unrolled;
+                }
+                break;
             case ConvolutionMethod::diagonal:
                 // Verify that we meet the criteria for doing Diagonal method. If not,
                 // choose the normal method.
@@ -409,11 +431,22 @@ namespace predictors
                     _convolutionalParameters.method = IsDepthwiseSeparable() ? ConvolutionMethod::simple : ConvolutionMethod::unrolled;
                 }
                 break;
+            case ConvolutionMethod::depthwise:
+                // The depthwise method only applies to depthwise separable convolutions, and needs the input padded by half the filter size
+                if (!IsDepthwiseSeparable())
+                {
+                    _convolutionalParameters.method = ConvolutionMethod::unrolled;
+                }
+                else if (_layerParameters.inputPaddingParameters.paddingSize != _convolutionalParameters.receptiveField / 2)
+                {
+                    _convolutionalParameters.method = ConvolutionMethod::simple;
+                }
+                break;
             }
             if (IsDepthwiseSeparable())
             {
                 // Verify we can use a workable method for depthwise separable convolutions.
-                if ((_convolutionalParameters.method != ConvolutionMethod::unrolled) && (_convolutionalParameters.method != ConvolutionMethod::simple) && (_convolutionalParameters.method != ConvolutionMethod::winograd))
+                if ((_convolutionalParameters.method != ConvolutionMethod::unrolled) && (_convolutionalParameters.method != ConvolutionMethod::simple) && (_convolutionalParameters.method != ConvolutionMethod::winograd) && (_convolutionalParameters.method != ConvolutionMethod::depthwise))
                 {
                     _convolutionalParameters.method = ConvolutionMethod::simple;
                 }
@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictor.cpp (predictors)
+//  Authors:  agent
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FlatForestPredictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+namespace ell
+{
+namespace predictors
+{
+    namespace
+    {
+        // The number of examples that go through each tree together
+        const size_t exampleBlockSize = 64;
+
+        // Returns the largest float that's not above the threshold. For any float x, (double)x > threshold exactly
+        // when x > GetFloatThreshold(threshold).
+        float GetFloatThreshold(double threshold)
+        {
+            if (std::isnan(threshold) || std::isinf(threshold))
+            {
+                return static_cast<float>(threshold);
+            }
+            if (threshold > std::numeric_limits<float>::max())
+            {
+                return std::numeric_limits<float>::max();
+            }
+            if (threshold < std::numeric_limits<float>::lowest())
+            {
+                return -std::numeric_limits<float>::infinity();
+            }
+
+            auto result = static_cast<float>(threshold);
+            if (static_cast<double>(result) > threshold)
+            {
+                result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+            }
+            return result;
+        }
+    } // namespace
+
+    FlatForestPredictor::FlatForestPredictor(const SimpleForestPredictor& forest) :
+        _bias(forest.GetBias())
+    {
+        for (auto rootIndex : forest.GetRootIndices())
+        {
+            AddTree(forest, rootIndex);
+        }
+    }
+
+    void FlatForestPredictor::AddTree(const SimpleForestPredictor& forest, size_t rootIndex)
+    {
+        const auto& interiorNodes = forest.GetInteriorNodes();
+        _treeRoots.push_back(static_cast<int32_t>(_featureIndices.size()));
+
+        // Visit the tree depth-first, without recursion, since boosted trees can be very deep. Each entry is an interior
+        // node of the forest, the sum of the edge values on the path to it, and the entry of `_children` that points to it.
+        std::vector<std::tuple<size_t, double, int>> stack = { { rootIndex, 0.0, -1 } };
+        while (!stack.empty())
+        {
+            size_t nodeIndex;
+            double pathValue;
+            int parentSlot;
+            std::tie(nodeIndex, pathValue, parentSlot) = stack.back();
+            stack.pop_back();
+
+            const auto& interiorNode = interiorNodes[nodeIndex];
+            const auto& splitRule = interiorNode.GetSplitRule();
+            const auto flatIndex = static_cast<int32_t>(_featureIndices.size());
+            _featureIndices.push_back(static_cast<int32_t>(splitRule.GetElementIndex()));
+            _thresholds.push_back(GetFloatThreshold(splitRule.GetThreshold()));
+            _children.resize(_children.size() + 2);
+            if (parentSlot >= 0)
+            {
+                _children[parentSlot] = flatIndex;
+            }
+
+            const auto& edges = interiorNode.GetOutgoingEdges();
+            for (size_t position = 0; position < edges.size(); ++position)
+            {
+                // Sum in the same order as `ForestPredictor::Predict`, so the results are identical
+                const double value = pathValue + edges[position].GetPredictor().GetValue();
+                const int slot = 2 * flatIndex + static_cast<int>(position);
+                if (edges[position].IsTargetInterior())
+                {
+                    stack.emplace_back(edges[position].GetTargetNodeIndex(), value, slot);
+                }
+                else
+                {
+                    _children[slot] = ~static_cast<int32_t>(_leafValues.size());
+                    _leafValues.push_back(value);
+                }
+            }
+        }
+    }
+
+    double FlatForestPredictor::Predict(const DataVectorType& input) const
+    {
+        double output;
+        PredictBlock({ &input }, &output);
+        return output;
+    }
+
+    std::vector<double> FlatForestPredictor::PredictBatch(const std::vector<DataVectorType>& inputs, size_t numThreads) const
+    {
+        return PredictBatch(
+            inputs.size(), [&inputs](size_t index) -> const DataVectorType& { return inputs[index]; }, numThreads);
+    }
+
+    std::vector<double> FlatForestPredictor::PredictBatch(size_t numExamples, const std::function<const DataVectorType&(size_t)>& getInput, size_t numThreads) const
+    {
+        std::vector<double> outputs(numExamples);
+        const size_t numBlocks = (numExamples + exampleBlockSize - 1) / exampleBlockSize;
+
+        // Each task predicts a contiguous range of blocks
+        auto predictBlocks = [&](size_t beginBlock, size_t endBlock) {
+            std::vector<const DataVectorType*> blockInputs;
+            blockInputs.reserve(exampleBlockSize);
+            for (size_t block = beginBlock; block < endBlock; ++block)
+            {
+                const size_t beginExample = block * exampleBlockSize;
+                const size_t endExample = std::min(beginExample + exampleBlockSize, numExamples);
+                blockInputs.clear();
+                for (size_t example = beginExample; example < endExample; ++example)
+                {
+                    blockInputs.push_back(&getInput(example));
+                }
+                PredictBlock(blockInputs, outputs.data() + beginExample);
+            }
+        };
+
+        if (numThreads == 0)
+        {
+            numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        numThreads = std::min(numThreads, numBlocks);
+        if (numThreads <= 1)
+        {
+            predictBlocks(0, numBlocks);
+            return outputs;
+        }
+
+        std::vector<std::future<void>> tasks;
+        for (size_t thread = 0; thread < numThreads; ++thread)
+        {
+            tasks.push_back(std::async(std::launch::async, predictBlocks, thread * numBlocks / numThreads, (thread + 1) * numBlocks / numThreads));
+        }
+        for (auto& task : tasks)
+        {
+            task.get();
+        }
+        return outputs;
+    }
+
+    void FlatForestPredictor::PredictBlock(const std::vector<const DataVectorType*>& inputs, double* outputs) const
+    {
+        for (size_t example = 0; example < inputs.size(); ++example)
+        {
+            outputs[example] = _bias;
+        }
+
+        for (auto root : _treeRoots)
+        {
+            for (size_t example = 0; example < inputs.size(); ++example)
+            {
+                const auto& input = *inputs[example];
+                auto node = root;
+                while (node >= 0)
+                {
+                    // The data vector stores floats, so comparing as floats gives the same result as the split rule. Like
+                    // the forest, this reads features past the end of the input as 0.
+                    const bool goRight = static_cast<float>(input[_featureIndices[node]]) > _thresholds[node];
+                    node = _children[2 * node + (goRight ? 1 : 0)];
+                }
+                outputs[example] += _leafValues[~node];
+            }
+        }
+    }
+} // namespace predictors
+} // namespace ell
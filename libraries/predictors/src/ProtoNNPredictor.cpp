@@ -10,13 +10,16 @@
 
 #include <math/include/MatrixOperations.h>
 
+#include <cmath>
 #include <memory>
+#include <vector>
 
 namespace ell
 {
 namespace predictors
 {
-    ProtoNNPredictor::ProtoNNPredictor() :
+    template <typename ElementType>
+    ProtoNNPredictor<ElementType>::ProtoNNPredictor() :
         _dimension(0),
         _W(0, 0),
         _B(0, 0),
@@ -25,7 +28,8 @@ namespace predictors
     {
     }
 
-    ProtoNNPredictor::ProtoNNPredictor(size_t dimension, size_t projectedDimension, size_t numPrototypes, size_t numLabels, double gamma) :
+    template <typename ElementType>
+    ProtoNNPredictor<ElementType>::ProtoNNPredictor(size_t dimension, size_t projectedDimension, size_t numPrototypes, size_t numLabels, ElementType gamma) :
         _dimension(dimension),
         _W(projectedDimension, dimension),
         _B(projectedDimension, numPrototypes),
@@ -34,33 +38,35 @@ namespace predictors
     {
     }
 
-    void ProtoNNPredictor::Reset()
+    template <typename ElementType>
+    void ProtoNNPredictor<ElementType>::Reset()
     {
         _dimension = 0;
         _W.Reset();
         _B.Reset();
         _Z.Reset();
-        _gamma = 0.0;
+        _gamma = 0;
     }
 
-    math::ColumnVector<double> ProtoNNPredictor::GetLabelScores(const std::vector<double>& inputVector) const
+    template <typename ElementType>
+    math::ColumnVector<ElementType> ProtoNNPredictor<ElementType>::GetLabelScores(const std::vector<ElementType>& inputVector) const
     {
         // Projection
-        math::ColumnVector<double> data(inputVector);
+        math::ColumnVector<ElementType> data(inputVector);
         auto dimension = GetDimension();
         data.Resize(dimension);
-        math::ColumnVector<double> projectedInput(GetProjectedDimension());
-        math::MultiplyScaleAddUpdate(1.0, _W, data, 0.0, projectedInput);
+        math::ColumnVector<ElementType> projectedInput(GetProjectedDimension());
+        math::MultiplyScaleAddUpdate(static_cast<ElementType>(1), _W, data, static_cast<ElementType>(0), projectedInput);
 
         // Similarity to each prototype
         auto numPrototypes = GetNumPrototypes();
-        math::ColumnVector<double> similarityToPrototypes(numPrototypes);
+        math::ColumnVector<ElementType> similarityToPrototypes(numPrototypes);
         auto prototypes = GetPrototypes();
         auto gammaVal = GetGamma();
 
         for (size_t i = 0; i < numPrototypes; i++)
         {
-            math::ColumnVector<double> prototype(prototypes.GetColumn(i).ToArray());
+            math::ColumnVector<ElementType> prototype(prototypes.GetColumn(i).ToArray());
             prototype -= projectedInput;
             auto prototypeDistance = prototype.Norm2();
             auto similarity = std::exp(-1 * gammaVal * gammaVal * prototypeDistance * prototypeDistance);
@@ -68,25 +74,29 @@ namespace predictors
         }
 
         // Get the prediction label
-        math::ColumnVector<double> labels(GetNumLabels());
-        math::MultiplyScaleAddUpdate(1.0, GetLabelEmbeddings(), similarityToPrototypes, 0.0, labels); // TODO due to the zero, there is a more appropriate operation
+        math::ColumnVector<ElementType> labels(GetNumLabels());
+        math::MultiplyScaleAddUpdate(static_cast<ElementType>(1), GetLabelEmbeddings(), similarityToPrototypes, static_cast<ElementType>(0), labels); // TODO due to the zero, there is a more appropriate operation
 
         return labels;
     }
 
-    math::ColumnVector<double> ProtoNNPredictor::Predict(const DataVectorType& inputVector) const
+    template <typename ElementType>
+    math::ColumnVector<ElementType> ProtoNNPredictor<ElementType>::Predict(const DataVectorType& inputVector) const
     {
-        auto labels = GetLabelScores(inputVector.ToArray());
+        auto data = inputVector.ToArray();
+        auto labels = GetLabelScores(std::vector<ElementType>(data.begin(), data.end()));
         return labels;
     }
 
-    math::ColumnVector<double> ProtoNNPredictor::Predict(const std::vector<double>& inputVector) const
+    template <typename ElementType>
+    math::ColumnVector<ElementType> ProtoNNPredictor<ElementType>::Predict(const std::vector<ElementType>& inputVector) const
     {
         auto labels = GetLabelScores(inputVector);
         return labels;
     }
 
-    void ProtoNNPredictor::WriteToArchive(utilities::Archiver& archiver) const
+    template <typename ElementType>
+    void ProtoNNPredictor<ElementType>::WriteToArchive(utilities::Archiver& archiver) const
     {
         archiver["dim"] << _dimension;
         archiver["gamma"] << _gamma;
@@ -95,7 +105,8 @@ namespace predictors
         math::MatrixArchiver::Write(_Z, "z", archiver);
     }
 
-    void ProtoNNPredictor::ReadFromArchive(utilities::Unarchiver& archiver)
+    template <typename ElementType>
+    void ProtoNNPredictor<ElementType>::ReadFromArchive(utilities::Unarchiver& archiver)
     {
         archiver["dim"] >> _dimension;
         archiver["gamma"] >> _gamma;
@@ -103,5 +114,9 @@ namespace predictors
         math::MatrixArchiver::Read(_B, "b", archiver);
         math::MatrixArchiver::Read(_Z, "z", archiver);
     }
+
+    // Explicit instantiations
+    template class ProtoNNPredictor<float>;
+    template class ProtoNNPredictor<double>;
 } // namespace predictors
 } // namespace ell
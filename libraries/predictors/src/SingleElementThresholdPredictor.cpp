@@ -32,11 +32,7 @@ namespace predictors
 
     bool SingleElementThresholdPredictor::Predict(const DataVectorType& inputVector) const
     {
-        if (inputVector.PrefixLength() <= _index)
-        {
-            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange);
-        }
-
+        // Features past the end of the input are 0, as in a sparse data vector
         return inputVector[_index] > _threshold;
     }
 
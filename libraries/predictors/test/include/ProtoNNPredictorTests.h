@@ -8,4 +8,5 @@
 
 #pragma once
 
+template <typename ElementType>
 void ProtoNNPredictorTest();
@@ -6,10 +6,17 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <predictors/include/FlatForestPredictor.h>
 #include <predictors/include/ForestPredictor.h>
 
 #include <testing/include/testing.h>
 
+#include <utilities/include/RandomEngines.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
 using namespace ell;
 
 void ForestPredictorTest()
@@ -65,3 +72,83 @@ void ForestPredictorTest()
     auto edgeIndicator = forest.GetEdgeIndicatorVector(ExampleType{ 0.25, 0.7, 0.0 });
     testing::ProcessTest("Testing ForestPredictor, SetEdgeIndicatorVector()", testing::IsEqual(edgeIndicator, std::vector<bool>{ 1, 0, 0, 1, 0, 0, 0, 1 }));
 }
+
+void FlatForestPredictorTest()
+{
+    using SplitAction = predictors::SimpleForestPredictor::SplitAction;
+    using SplitRule = predictors::SingleElementThresholdPredictor;
+    using EdgePredictorVector = std::vector<predictors::ConstantPredictor>;
+    using ExampleType = predictors::SimpleForestPredictor::DataVectorType;
+
+    const size_t numFeatures = 10;
+    auto engine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<double> valueDistribution(-1.0, 1.0);
+    std::uniform_int_distribution<size_t> featureDistribution(0, numFeatures - 1);
+
+    // grow a few unbalanced trees by splitting random leaves
+    predictors::SimpleForestPredictor forest;
+    forest.AddToBias(0.25);
+    for (int tree = 0; tree < 5; ++tree)
+    {
+        auto root = forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ featureDistribution(engine), valueDistribution(engine) }, EdgePredictorVector{ valueDistribution(engine), valueDistribution(engine) } });
+        std::vector<std::pair<size_t, size_t>> leaves = { { root, 0 }, { root, 1 } };
+        for (int split = 0; split < 20; ++split)
+        {
+            auto leafIndex = std::uniform_int_distribution<size_t>(0, leaves.size() - 1)(engine);
+            auto leaf = leaves[leafIndex];
+            leaves.erase(leaves.begin() + leafIndex);
+            auto node = forest.Split(SplitAction{ forest.GetChildId(leaf.first, leaf.second), SplitRule{ featureDistribution(engine), valueDistribution(engine) }, EdgePredictorVector{ valueDistribution(engine), valueDistribution(engine) } });
+            leaves.push_back({ node, 0 });
+            leaves.push_back({ node, 1 });
+        }
+    }
+
+    // enough examples for several blocks, and a partial block at the end
+    std::vector<ExampleType> inputs;
+    std::vector<double> expected;
+    for (int example = 0; example < 300; ++example)
+    {
+        std::vector<double> values(numFeatures);
+        for (auto& value : values)
+        {
+            value = valueDistribution(engine);
+        }
+        inputs.emplace_back(values);
+        expected.push_back(forest.Predict(inputs.back()));
+    }
+
+    predictors::FlatForestPredictor flatForest(forest);
+    testing::ProcessTest("Testing FlatForestPredictor, NumTrees()", flatForest.NumTrees() == forest.NumTrees());
+
+    bool predictOk = true;
+    for (size_t example = 0; example < inputs.size(); ++example)
+    {
+        predictOk = predictOk && flatForest.Predict(inputs[example]) == expected[example];
+    }
+    testing::ProcessTest("Testing FlatForestPredictor, Predict()", predictOk);
+
+    testing::ProcessTest("Testing FlatForestPredictor, PredictBatch()", flatForest.PredictBatch(inputs) == expected);
+    testing::ProcessTest("Testing FlatForestPredictor, PredictBatch() with 4 threads", flatForest.PredictBatch(inputs, 4) == expected);
+
+    // inputs shorter than the largest split feature index read the missing features as 0, like the forest does
+    std::vector<ExampleType> shortInputs;
+    std::vector<double> shortExpected;
+    for (size_t example = 0; example < 100; ++example)
+    {
+        std::vector<double> values(example % numFeatures);
+        for (auto& value : values)
+        {
+            value = valueDistribution(engine);
+        }
+        shortInputs.emplace_back(values);
+        shortExpected.push_back(forest.Predict(shortInputs.back()));
+    }
+
+    bool predictShortOk = true;
+    for (size_t example = 0; example < shortInputs.size(); ++example)
+    {
+        predictShortOk = predictShortOk && flatForest.Predict(shortInputs[example]) == shortExpected[example];
+    }
+    testing::ProcessTest("Testing FlatForestPredictor, Predict() with short inputs", predictShortOk);
+    testing::ProcessTest("Testing FlatForestPredictor, PredictBatch() with short inputs", flatForest.PredictBatch(shortInputs, 4) == shortExpected);
+}
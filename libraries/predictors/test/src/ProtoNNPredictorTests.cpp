@@ -6,17 +6,26 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "ProtoNNPredictorTests.h"
+
 #include <predictors/include/ProtoNNPredictor.h>
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
 using namespace ell;
 
+template <typename ElementType>
 void ProtoNNPredictorTest()
 {
     size_t dim = 5, projectedDim = 4, numPrototypes = 3, numLabels = 2;
-    double gamma = 0.3;
-    predictors::ProtoNNPredictor protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
+    ElementType gamma = static_cast<ElementType>(0.3);
+    predictors::ProtoNNPredictor<ElementType> protonnPredictor(dim, projectedDim, numPrototypes, numLabels, gamma);
 
     // projectedDim * dim
     auto W = protonnPredictor.GetProjectionMatrix().GetReference();
@@ -43,14 +52,19 @@ void ProtoNNPredictorTest()
     Z(1, 0) = 0.2; Z(1, 1) = 0.4; Z(1, 2) = 0.8;
     // clang-format on
 
-    auto prediction = protonnPredictor.Predict(std::vector<double>{ 0.2, 0.5, 0.6, 0.8, 0.1 });
+    auto prediction = protonnPredictor.Predict(std::vector<ElementType>{ 0.2, 0.5, 0.6, 0.8, 0.1 });
 
     auto maxElement = std::max_element(prediction.GetDataPointer(), prediction.GetDataPointer() + prediction.Size());
     ptrdiff_t maxLabelIndex = maxElement - prediction.GetDataPointer();
 
     ptrdiff_t R = 1;
-    double score = 1.321484;
+    ElementType score = static_cast<ElementType>(1.321484);
+    const double tolerance = std::is_same<ElementType, float>::value ? 1e-5 : 1e-6;
+    const std::string testName = std::string("ProtoNNPredictorTest<") + typeid(ElementType).name() + ">";
 
-    testing::ProcessTest("ProtoNNPredictorTest", testing::IsEqual(maxLabelIndex, R));
-    testing::ProcessTest("ProtoNNPredictorTest", testing::IsEqual(*maxElement, score, 1e-6));
+    testing::ProcessTest(testName, testing::IsEqual(maxLabelIndex, R));
+    testing::ProcessTest(testName, testing::IsEqual(*maxElement, score, static_cast<ElementType>(tolerance)));
 }
+
+template void ProtoNNPredictorTest<float>();
+template void ProtoNNPredictorTest<double>();
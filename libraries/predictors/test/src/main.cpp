@@ -19,6 +19,7 @@ int main()
 {
     // ForestPredictor
     ForestPredictorTest();
+    FlatForestPredictorTest();
 
     // LinearPredictor
     LinearPredictorTest<double>();
@@ -58,7 +59,8 @@ int main()
     ConvolutionalArchiveTest<float>();
     BinaryConvolutionalArchiveTest<float>();
 
-    ProtoNNPredictorTest();
+    ProtoNNPredictorTest<double>();
+    ProtoNNPredictorTest<float>();
 
     if (testing::DidTestFail())
     {
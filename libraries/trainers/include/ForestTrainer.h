@@ -13,6 +13,7 @@
 #include <data/include/Dataset.h>
 #include <data/include/DenseDataVector.h>
 
+#include <predictors/include/FlatForestPredictor.h>
 #include <predictors/include/ForestPredictor.h>
 
 #include <utilities/include/OutputStreamImpostor.h>
@@ -20,6 +21,8 @@
 #include <iostream> // For std::cout in VERBOSE_MODE
 #include <memory>
 #include <queue>
+#include <type_traits>
+#include <vector>
 
 namespace ell
 {
@@ -230,11 +233,27 @@ namespace trainers
         // materialize a dataset of dense DataVectors with metadata that contains both strong and weak weight and lables for each example
         _dataset = data::Dataset<TrainerExampleType>(anyDataset);
 
+        // the forest may already have trees, so predict the whole dataset, using all the cores if the forest can be flattened
+        std::vector<double> predictions;
+        if constexpr (std::is_same_v<PredictorType, predictors::SimpleForestPredictor>)
+        {
+            const auto& dataset = _dataset;
+            predictions = predictors::FlatForestPredictor(_forest).PredictBatch(
+                dataset.NumExamples(), [&dataset](size_t rowIndex) -> const DataVectorType& { return dataset[rowIndex].GetDataVector(); }, 0);
+        }
+        else
+        {
+            for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
+            {
+                predictions.push_back(_forest.Predict(_dataset[rowIndex].GetDataVector()));
+            }
+        }
+
         // initalizes the special fields in the dataset metadata: weak weight and label, currentOutput
         for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
         {
             auto& example = _dataset[rowIndex];
-            auto prediction = _forest.Predict(example.GetDataVector());
+            auto prediction = predictions[rowIndex];
             auto& metadata = example.GetMetadata();
             metadata.currentOutput = prediction;
             metadata.weak = _booster.GetWeakWeightLabel(metadata.strong, prediction);
@@ -44,7 +44,7 @@ namespace trainers
     /// <summary>
     /// Implements the ProtoNN trainer
     /// </summary>
-    class ProtoNNTrainer : public ITrainer<predictors::ProtoNNPredictor>
+    class ProtoNNTrainer : public ITrainer<predictors::ProtoNNPredictor<double>>
     {
     public:
         /// <summary> Constructs the ProtoNN trainer. </summary>
@@ -63,7 +63,7 @@ namespace trainers
         /// <summary> Returns The ProtoNN predictor. </summary>
         ///
         /// <returns> A shared pointer to the current predictor. </returns>
-        const predictors::ProtoNNPredictor& GetPredictor() const override { return _protoNNPredictor; }
+        const predictors::ProtoNNPredictor<double>& GetPredictor() const override { return _protoNNPredictor; }
 
     private:
         // Initalize parameters in the first iteration
@@ -103,7 +103,7 @@ namespace trainers
 
         ProtoNNTrainerParameters _parameters;
 
-        predictors::ProtoNNPredictor _protoNNPredictor;
+        predictors::ProtoNNPredictor<double> _protoNNPredictor;
 
         // Map holding the model parameters
         ProtoNNModelMap _modelMap;
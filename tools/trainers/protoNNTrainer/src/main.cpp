@@ -45,7 +45,7 @@
 
 using namespace ell;
 
-void CreateMap(predictors::ProtoNNPredictor& predictor, ell::model::Map& map)
+void CreateMap(predictors::ProtoNNPredictor<double>& predictor, ell::model::Map& map)
 {
     auto numFeatures = predictor.GetDimension();
 
@@ -56,7 +56,7 @@ void CreateMap(predictors::ProtoNNPredictor& predictor, ell::model::Map& map)
 
     // add the predictor node, taking input from the input node
     model::PortElements<double> inputElements(inputNode->output);
-    auto predictorNode = model.AddNode<nodes::ProtoNNPredictorNode>(inputElements, predictor);
+    auto predictorNode = model.AddNode<nodes::ProtoNNPredictorNode<double>>(inputElements, predictor);
 
     // add an output node taking input from the predictor node.
     auto outputNode = model.AddNode<model::OutputNode<double>>(predictorNode->output);
@@ -123,7 +123,7 @@ int main(int argc, char* argv[])
         for (size_t i = 0; i < protoNNTrainerArguments.numIterations; i++)
             trainer->Update();
 
-        predictors::ProtoNNPredictor predictor(trainer->GetPredictor());
+        predictors::ProtoNNPredictor<double> predictor(trainer->GetPredictor());
 
         if (protoNNTrainerArguments.verbose)
         {
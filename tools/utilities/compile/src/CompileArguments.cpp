@@ -100,6 +100,13 @@ void ParsedCompileArguments::AddArgs(utilities::CommandLineParser& parser)
         "The maximal number of refinement iterations (only valid if outputType is 'refinedMap')",
         10);
 
+    parser.AddOption(
+        tuneConvolutionMethods,
+        "tuneConvolutionMethods",
+        "",
+        "Time each convolutional layer with every method it supports on this machine, and record the fastest in the map (write it out with 'mapWithOptions' to reuse it)",
+        false);
+
     parser.AddOption(
         verbose,
         "verbose",
@@ -21,6 +21,7 @@
 #include <model/include/SetCompilerOptionsTransformation.h>
 
 #include <passes/include/StandardTransformations.h>
+#include <passes/include/TuneConvolutionMethodTransformation.h>
 
 #include <utilities/include/CommandLineParser.h>
 #include <utilities/include/Exception.h>
@@ -121,6 +122,15 @@ void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMa
         map.Transform(setOptionsTranformation);
     }
 
+    auto optimizerOptions = mapCompilerArguments.GetModelOptimizerOptions();
+
+    if (compileArguments.tuneConvolutionMethods)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to tune convolution methods", compileArguments.verbose);
+        passes::TuneConvolutionMethodTransformation tuneTransformation(settings, optimizerOptions);
+        map.Transform(tuneTransformation);
+    }
+
     if (compileArguments.outputMapWithOptions)
     {
         common::SaveMap(map, baseFilename + "_options.ell");
@@ -134,14 +144,18 @@ void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMa
         common::SaveMap(map, baseFilename + "_refined.ell");
     }
 
-    auto optimizerOptions = mapCompilerArguments.GetModelOptimizerOptions();
-
     model::IRMapCompiler compiler(settings, optimizerOptions);
     TimingOutputCollector timer(timingOutput, "Time to compile map", compileArguments.verbose);
 
     auto compiledMap = compiler.Compile(map);
     timer.Stop();
 
+    if (compileArguments.verbose && settings.planPortMemory)
+    {
+        const auto& plan = compiler.GetPortMemoryPlan();
+        timingOutput << "Port buffer memory: " << plan.arenaSize << " bytes planned, " << plan.naiveSize << " bytes naive (" << plan.offsets.size() << " buffers)" << std::endl;
+    }
+
     if (compileArguments.outputCompiledMap)
     {
         TimingOutputCollector timer(timingOutput, "Time to save compiled map", compileArguments.verbose);